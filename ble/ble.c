@@ -29,13 +29,13 @@
 #include "esp_gattc_api.h"
 #include "esp_bt_main.h"
 #include "esp_gatt_common_api.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "ble_gatt_cache.h"
+#include "scan_cache.h"
 
 #define TAG "BLE"
 
-/* Target device name */
-/* 目标设备名称 */
-static char s_remote_device_name[ESP_BLE_ADV_NAME_LEN_MAX] = {0};
-
 /* Flags indicating whether a connection has been initiated and whether the target service has been found, for demonstration only */
 /* 是否已发起连接、是否已找到目标服务等标记，仅作演示 */
 static bool s_connecting = false;
@@ -48,32 +48,50 @@ static ble_notify_callback_t s_notify_cb = NULL;
 /* 设置逻辑层断开连接状态回调 */
 static connect_logic_state_callback_t s_state_cb = NULL;
 
-/* Attempt to connect when the target device is scanned */
-/* 扫描到目标设备，尝试连接 */
+/* Per-link state private to the BLE layer */
+/* BLE 层内部的每条链路状态 */
+typedef struct {
+    esp_bd_addr_t addr;                           // Camera address, kept for reconnection
+    char name[ESP_BLE_ADV_NAME_LEN_MAX];          // Camera name
+    EventGroupHandle_t events;                    // Link events for the connection logic
+    ble_gatt_cache_t gatt_cache;                  // Handles cached for this camera, discovery is skipped when they verify
+    bool gatt_cache_used;                         // Whether this connection uses the cached handles
+    int64_t connect_time_us;                      // Time of the connect event, for the notify enable time
+    uint16_t mtu;                                 // Negotiated ATT MTU, 0 while down
+    uint16_t tx_octets;                           // Requested LL data length, 0 until requested on this connection
+    SemaphoreHandle_t tx_credits;                 // Free write credits, taken per write and returned on WRITE_CHAR_EVT
+    volatile int64_t tx_progress_us;              // Last time a credit came back, or a write started on an idle link
+    volatile bool congested;                      // Set by CONGEST_EVT, no writes until it clears
+} ble_link_t;
+
+static ble_link_t s_links[BLE_MAX_LINKS];
+
+/* Every credit in flight and none back for this long: the completion events were lost, take the credits back */
+/* 额度全部在途且这么长时间没有归还：完成事件已丢失，收回额度 */
+#define TX_CREDIT_STALL_US (1000 * 1000)
+
+/* Attempt to connect when the target device is scanned, one scan at a time for s_scan_link */
+/* 扫描到目标设备，尝试连接，同一时间只为 s_scan_link 扫描 */
 #define MIN_RSSI_THRESHOLD -80          // Set minimum signal strength threshold, adjust as needed
-static esp_bd_addr_t best_addr = {0};   // Store the address of the device with the strongest signal
-static int8_t best_rssi = -128;         // Store the RSSI value of the device with the strongest signal, initialized to the weakest signal strength
+#define EARLY_CONNECT_RSSI -60          // A new camera this strong is connected before the scan window ends, see scan_cache_connect_early()
+#define EARLY_CONNECT_MARGIN 10         // Lead over the runner-up that lets a new camera connect on its first report
+#define SCAN_CACHE_MAX_AGE_MS 60000     // Cameras not heard for this long are dropped from the scan cache
+static int s_scan_link = 0;             // Link the running scan is for
+static esp_bd_addr_t best_addr = {0};   // Address of the camera to connect, chosen early or at the end of the window
+static char best_name[ESP_BLE_ADV_NAME_LEN_MAX] = {0};  // Name of that device
 static bool s_is_reconnecting = false;  // Whether in reconnection mode
 static bool s_found_previous_device = false;  // Whether the original device was found in reconnection mode
+static scan_cache_t s_scan_cache;       // Cameras heard in this and earlier scans, with smoothed RSSI
+static int64_t s_scan_start_ms = 0;     // Start of the running scan, only cameras heard since then are picked
+static volatile bool s_scan_stopping = false;  // Stop requested, later reports are ignored
 
-/* Only one profile is stored */
-/* 仅存一个 profile */
-ble_profile_t s_ble_profile = {
-    .conn_id = 0,
-    .gattc_if = ESP_GATT_IF_NONE,
-    .notify_char_handle = 0,
-    .write_char_handle = 0,
-    .read_char_handle = 0,
-    .service_start_handle = 0,
-    .service_end_handle = 0,
-    .connection_status = {
-        .is_connected = false,
-    },
-    .handle_discovery = {
-        .notify_char_handle_found = false,
-        .write_char_handle_found = false,
-    },
-};
+/* REG_FOR_NOTIFY_EVT carries no conn_id, the link is remembered at the request */
+/* REG_FOR_NOTIFY_EVT 不带 conn_id，在发起请求时记录链路 */
+static int s_register_link = -1;
+
+/* One profile per camera link */
+/* 每条相机链路一个 profile */
+ble_profile_t s_ble_profiles[BLE_MAX_LINKS];
 
 /* Define the Service/Characteristic UUIDs to filter, for search use */
 /* 这里定义想要过滤的 Service/Characteristic UUID，供搜索使用 */
@@ -81,6 +99,10 @@ ble_profile_t s_ble_profile = {
 #define REMOTE_NOTIFY_CHAR_UUID      0xFFF4
 #define REMOTE_WRITE_CHAR_UUID       0xFFF5
 
+/* Characteristic declaration value: properties (1) + value handle (2) + 16-bit UUID (2) */
+/* 特征声明的值：属性 (1) + 值句柄 (2) + 16 位 UUID (2) */
+#define CHAR_DECLARATION_LENGTH      5
+
 static esp_bt_uuid_t s_filter_notify_char_uuid = {
     .len = ESP_UUID_LEN_16,
     .uuid.uuid16 = REMOTE_NOTIFY_CHAR_UUID,
@@ -103,8 +125,8 @@ static esp_ble_scan_params_t s_ble_scan_params = {
     .own_addr_type      = BLE_ADDR_TYPE_PUBLIC,
     .scan_filter_policy = BLE_SCAN_FILTER_ALLOW_ALL,
     .scan_interval      = 0x50,
-    .scan_window        = 0x30,
-    .scan_duplicate     = BLE_SCAN_DUPLICATE_DISABLE
+    .scan_window        = 0x50,  // Scan continuously, a scan only lasts until the camera is found
+    .scan_duplicate     = BLE_SCAN_DUPLICATE_DISABLE  // Every advertisement is reported, the scan cache smooths the RSSI over them
 };
 
 /* Callback function declarations */
@@ -117,18 +139,165 @@ static void gattc_event_handler(esp_gattc_cb_event_t event,
 static TimerHandle_t scan_timer;
 
 void scan_stop_timer_callback(TimerHandle_t xTimer) {
+    if (s_scan_stopping) {
+        return;
+    }
+    s_scan_stopping = true;
     esp_ble_gap_stop_scanning();
     ESP_LOGI(TAG, "Scan stopped after timeout");
 }
 
+/**
+ * @brief Stop the scan before the window ends, the camera to connect is already chosen
+ * 在扫描窗口结束前停止扫描，要连接的相机已经选定
+ */
+static void scan_stop_early(void) {
+    if (s_scan_stopping) {
+        return;
+    }
+    s_scan_stopping = true;
+    if (scan_timer != NULL) {
+        xTimerStop(scan_timer, 0);
+    }
+    esp_ble_gap_stop_scanning();
+}
+
 static void trigger_scan_task(void) {
+    s_scan_start_ms = esp_timer_get_time() / 1000;
+    s_scan_stopping = false;
+    scan_cache_expire(&s_scan_cache, s_scan_start_ms, SCAN_CACHE_MAX_AGE_MS);
     esp_ble_gap_start_scanning(10);
     // Start a timer to stop scanning after 3 seconds
     // 启动定时器，在3秒后停止扫描
-    scan_timer = xTimerCreate("scan_timer", pdMS_TO_TICKS(3000), pdFALSE, (void *)0, scan_stop_timer_callback);
+    // The timer is reused, reconnect attempts scan repeatedly
+    // 定时器复用，重连尝试会多次扫描
+    if (scan_timer == NULL) {
+        scan_timer = xTimerCreate("scan_timer", pdMS_TO_TICKS(3000), pdFALSE, (void *)0, scan_stop_timer_callback);
+    }
     if (scan_timer != NULL) {
-        xTimerStart(scan_timer, 0);
+        xTimerReset(scan_timer, 0);
+    }
+}
+
+static bool is_addr_valid(const esp_bd_addr_t addr) {
+    for (int i = 0; i < ESP_BD_ADDR_LEN; i++) {
+        if (addr[i] != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_link_valid(int link) {
+    return link >= 0 && link < BLE_MAX_LINKS;
+}
+
+/**
+ * @brief Find the link of a connected camera by connection ID
+ * 根据连接 ID 查找已连接相机的链路
+ *
+ * @return int Link index, -1 if none
+ *             链路序号，未找到时为 -1
+ */
+static int link_by_conn_id(uint16_t conn_id) {
+    for (int i = 0; i < BLE_MAX_LINKS; i++) {
+        if (s_ble_profiles[i].connection_status.is_connected && s_ble_profiles[i].conn_id == conn_id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Find the link a camera address belongs to
+ * 查找相机地址所属的链路
+ *
+ * @return int Link index, -1 if none
+ *             链路序号，未找到时为 -1
+ */
+static int link_by_bda(const esp_bd_addr_t bda) {
+    for (int i = 0; i < BLE_MAX_LINKS; i++) {
+        if (is_addr_valid(s_links[i].addr) && memcmp(s_links[i].addr, bda, sizeof(esp_bd_addr_t)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool is_held_by_link(const scan_cache_entry_t *entry, void *context) {
+    return link_by_bda(entry->addr) >= 0;
+}
+
+/**
+ * @brief Choose the camera the scan connects to
+ * 选定扫描要连接的相机
+ */
+static void select_scan_target(const scan_cache_entry_t *entry) {
+    memcpy(best_addr, entry->addr, sizeof(esp_bd_addr_t));
+    memset(best_name, 0, sizeof(best_name));
+    strncpy(best_name, entry->name, sizeof(best_name) - 1);
+}
+
+static void set_link_events(int link, EventBits_t bits) {
+    if (is_link_valid(link)) {
+        xEventGroupSetBits(s_links[link].events, bits);
+    }
+}
+
+/**
+ * @brief Update BLE_EVENT_TX_READY from the free credits and the congestion state
+ * 根据剩余额度与拥塞状态更新 BLE_EVENT_TX_READY
+ */
+static void update_tx_ready(int link) {
+    if (s_ble_profiles[link].connection_status.is_connected && !s_links[link].congested &&
+        uxSemaphoreGetCount(s_links[link].tx_credits) > 0) {
+        xEventGroupSetBits(s_links[link].events, BLE_EVENT_TX_READY);
+    } else {
+        xEventGroupClearBits(s_links[link].events, BLE_EVENT_TX_READY);
+    }
+}
+
+/**
+ * @brief Take a write credit, fails at once when the link is congested or every credit is in flight
+ * 获取一个写入额度，链路拥塞或额度全部在途时立即失败
+ */
+static esp_err_t take_tx_credit(int link) {
+    ble_link_t *l = &s_links[link];
+    int64_t now = esp_timer_get_time();
+
+    if (l->congested) {
+        update_tx_ready(link);
+        return ESP_ERR_NO_MEM;
+    }
+    if (uxSemaphoreGetCount(l->tx_credits) == BLE_TX_CREDITS) {
+        l->tx_progress_us = now;
+    }
+    if (xSemaphoreTake(l->tx_credits, 0) != pdTRUE) {
+        // WRITE_CHAR_EVT 是额度的唯一归还途径，若协议栈未上报，避免链路永久停写
+        // WRITE_CHAR_EVT is the only way credits come back, do not let a missing one stop the link for good
+        if (now - l->tx_progress_us < TX_CREDIT_STALL_US) {
+            update_tx_ready(link);
+            return ESP_ERR_NO_MEM;
+        }
+        ESP_LOGW(TAG, "Link %d: no write completed for %lld ms, reclaiming credits", link,
+                 (long long)((now - l->tx_progress_us) / 1000));
+        while (uxSemaphoreGetCount(l->tx_credits) < BLE_TX_CREDITS - 1) {
+            xSemaphoreGive(l->tx_credits);
+        }
+        l->tx_progress_us = now;
     }
+    update_tx_ready(link);
+    return ESP_OK;
+}
+
+/**
+ * @brief Return a write credit, when a write completed or could not be queued
+ * 归还写入额度，用于写入完成或未能入队时
+ */
+static void give_tx_credit(int link) {
+    s_links[link].tx_progress_us = esp_timer_get_time();
+    xSemaphoreGive(s_links[link].tx_credits);
+    update_tx_ready(link);
 }
 
 /* -------------------------
@@ -145,14 +314,18 @@ static void trigger_scan_task(void) {
  *         - Others on failure
  */
 esp_err_t ble_init() {
-    /* Initialize NVS */
-    /* 初始化 NVS */
-    esp_err_t ret = nvs_flash_init();
-    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
-        ESP_ERROR_CHECK(nvs_flash_erase());
-        ret = nvs_flash_init();
+    /* NVS is initialized in app_main before any module uses it */
+    /* NVS 已在 app_main 中初始化，供各模块使用 */
+
+    for (int i = 0; i < BLE_MAX_LINKS; i++) {
+        s_ble_profiles[i].gattc_if = ESP_GATT_IF_NONE;
+        s_links[i].events = xEventGroupCreate();
+        s_links[i].tx_credits = xSemaphoreCreateCounting(BLE_TX_CREDITS, BLE_TX_CREDITS);
+        if (s_links[i].events == NULL || s_links[i].tx_credits == NULL) {
+            ESP_LOGE(TAG, "create event group failed");
+            return ESP_ERR_NO_MEM;
+        }
     }
-    ESP_ERROR_CHECK(ret);
 
     /* Release classic Bluetooth memory */
     /* 释放经典蓝牙内存 */
@@ -161,7 +334,7 @@ esp_err_t ble_init() {
     /* Configure and initialize the Bluetooth controller */
     /* 配置并初始化蓝牙控制器 */
     esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
-    ret = esp_bt_controller_init(&bt_cfg);
+    esp_err_t ret = esp_bt_controller_init(&bt_cfg);
     if (ret) {
         ESP_LOGE(TAG, "initialize controller failed: %s", esp_err_to_name(ret));
         return ret;
@@ -207,8 +380,8 @@ esp_err_t ble_init() {
         return ret;
     }
 
-    /* Register GATTC application (only one profile here, app_id = 0) */
-    /* 注册 GATTC 应用（此处只有一个 profile，app_id = 0） */
+    /* Register GATTC application (one application for all links, app_id = 0) */
+    /* 注册 GATTC 应用（所有链路共用一个应用，app_id = 0） */
     ret = esp_ble_gattc_app_register(0);
     if (ret) {
         ESP_LOGE(TAG, "gattc app register error, err code = %x", ret);
@@ -228,15 +401,26 @@ esp_err_t ble_init() {
  * 连接到指定名称的设备（若已在扫描中，会自动在扫描到该设备时连接）
  *
  * @note  This interface is for demonstration only. If you want to actively specify an address to connect, you can extend the interface yourself.
+ *        Cameras already held by another link are skipped, so calling this for each link connects different cameras.
  *        本接口仅作为演示，如果想主动指定地址连接，可自行扩展接口
+ *        已被其他链路占用的相机会被跳过，因此对每条链路调用即可连接不同的相机
+ *
+ * @param link  Link to connect, 0 to BLE_MAX_LINKS - 1
+ *              要连接的链路，0 到 BLE_MAX_LINKS - 1
  * @return esp_err_t
  */
-esp_err_t ble_start_scanning_and_connect(void) {
+esp_err_t ble_start_scanning_and_connect(int link) {
+    if (!is_link_valid(link)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
     /* Reset scan-related variables */
     /* 重置扫描相关变量 */
+    s_scan_link = link;
+    memset(s_links[link].addr, 0, sizeof(esp_bd_addr_t));
+    memset(s_links[link].name, 0, ESP_BLE_ADV_NAME_LEN_MAX);
     memset(best_addr, 0, sizeof(esp_bd_addr_t));
-    best_rssi = -128;
-    memset(s_remote_device_name, 0, ESP_BLE_ADV_NAME_LEN_MAX);
+    memset(best_name, 0, ESP_BLE_ADV_NAME_LEN_MAX);
     s_is_reconnecting = false;
     s_found_previous_device = false;
 
@@ -247,11 +431,11 @@ esp_err_t ble_start_scanning_and_connect(void) {
         ESP_LOGE(TAG, "set scan params error: %s", esp_err_to_name(ret));
         return ret;
     }
-    ESP_LOGI(TAG, "Starting to scan...");
+    ESP_LOGI(TAG, "Starting to scan for link %d...", link);
     return ESP_OK;
 }
 
-static void try_to_connect(esp_bd_addr_t addr) {
+static void try_to_connect(int link) {
     // Check if already connecting
     // 检查是否正在连接中
     if (s_connecting) {
@@ -261,26 +445,18 @@ static void try_to_connect(esp_bd_addr_t addr) {
 
     // Check if the address is the initial value (all zeros)
     // 检查地址是否为初始值（全0）
-    bool is_valid = false;
-    for (int i = 0; i < ESP_BD_ADDR_LEN; i++) {
-        if (addr[i] != 0) {
-            is_valid = true;
-            break;
-        }
-    }
-
-    if (!is_valid) {
+    if (!is_addr_valid(s_links[link].addr)) {
         ESP_LOGE(TAG, "Invalid device address (all zeros)");
         return;
     }
 
     s_connecting = true;
-    ESP_LOGI(TAG, "Try to connect target device name = %s", s_remote_device_name);
+    ESP_LOGI(TAG, "Try to connect target device name = %s on link %d", s_links[link].name, link);
 
     // Do not call lightly, if you connect to a non-existent device address, you will have to wait a while before you can connect again
     // 不要轻易调用，如果连接不存在的设备地址会等待一段时间后才能再次连接
-    esp_ble_gattc_open(s_ble_profile.gattc_if,
-                       addr,
+    esp_ble_gattc_open(s_ble_profiles[link].gattc_if,
+                       s_links[link].addr,
                        BLE_ADDR_TYPE_PUBLIC,
                        true);
 }
@@ -291,28 +467,24 @@ static void try_to_connect(esp_bd_addr_t addr) {
  * 
  * @note Only applicable to non-active disconnection situations, as device information is not cleared
  *       仅适用于非主动断开连接的情况，因为设备信息未被清除
+ *
+ * @param link  Link to reconnect
+ *              要重连的链路
  * @return esp_err_t
  */
-esp_err_t ble_reconnect(void) {
+esp_err_t ble_reconnect(int link) {
     // Check if there is a valid last connection address
     // 检查是否有有效的上一次连接地址
-    bool is_valid = false;
-    for (int i = 0; i < ESP_BD_ADDR_LEN; i++) {
-        if (best_addr[i] != 0) {
-            is_valid = true;
-            break;
-        }
-    }
-
-    if (!is_valid) {
+    if (!is_link_valid(link) || !is_addr_valid(s_links[link].addr)) {
         ESP_LOGE(TAG, "No valid previous device address found");
         return ESP_FAIL;
     }
 
-    ESP_LOGI(TAG, "Attempting to reconnect to previous device: %s", s_remote_device_name);
+    ESP_LOGI(TAG, "Attempting to reconnect to previous device: %s", s_links[link].name);
     
     // Set reconnection mode flag
     // 设置重连模式标记
+    s_scan_link = link;
     s_is_reconnecting = true;
     s_found_previous_device = false;  // Reset discovery flag
     
@@ -327,15 +499,46 @@ esp_err_t ble_reconnect(void) {
  * @brief Disconnect (if connected)
  * 断开连接（如果已经连接）
  *
+ * @param link  Link to disconnect
+ *              要断开的链路
  * @return esp_err_t
  */
-esp_err_t ble_disconnect(void) {
-    if (s_ble_profile.connection_status.is_connected) {
-        esp_ble_gattc_close(s_ble_profile.gattc_if, s_ble_profile.conn_id);
+esp_err_t ble_disconnect(int link) {
+    if (is_link_valid(link) && s_ble_profiles[link].connection_status.is_connected) {
+        esp_ble_gattc_close(s_ble_profiles[link].gattc_if, s_ble_profiles[link].conn_id);
     }
     return ESP_OK;
 }
 
+/**
+ * @brief Forget the camera of a link so that a new scan may pick it for another link
+ * 忘记链路上的相机，使其可在新的扫描中被其他链路选中
+ *
+ * @note  Call after an active disconnect, ble_reconnect() no longer works for the link afterwards.
+ *        在主动断开后调用，之后该链路不能再使用 ble_reconnect()
+ *
+ * @param link  Link to forget
+ *              要忘记的链路
+ */
+void ble_forget_link(int link) {
+    if (is_link_valid(link)) {
+        memset(s_links[link].addr, 0, sizeof(esp_bd_addr_t));
+    }
+}
+
+/**
+ * @brief Get the profile of a link
+ * 获取链路的 profile
+ *
+ * @param link  Link index
+ *              链路序号
+ * @return ble_profile_t* Profile, NULL for an invalid link
+ *                        profile，链路无效时为 NULL
+ */
+ble_profile_t *ble_get_profile(int link) {
+    return is_link_valid(link) ? &s_ble_profiles[link] : NULL;
+}
+
 /* -------------------------
  *  Read/Write and Notify related interfaces
  *  读写与 Notify 相关接口
@@ -351,13 +554,14 @@ esp_err_t ble_disconnect(void) {
  * @return esp_err_t
  */
 esp_err_t ble_read(uint16_t conn_id, uint16_t handle) {
-    if (!s_ble_profile.connection_status.is_connected) {
+    int link = link_by_conn_id(conn_id);
+    if (link < 0) {
         ESP_LOGW(TAG, "Not connected, skip read");
         return ESP_FAIL;
     }
     /* Initiate GATTC read request */
     /* 发起 GATTC 读请求 */
-    esp_err_t ret = esp_ble_gattc_read_char(s_ble_profile.gattc_if,
+    esp_err_t ret = esp_ble_gattc_read_char(s_ble_profiles[link].gattc_if,
                                             conn_id,
                                             handle,
                                             ESP_GATT_AUTH_REQ_NONE);
@@ -379,14 +583,19 @@ esp_err_t ble_read(uint16_t conn_id, uint16_t handle) {
  *                  要写入的数据
  * @param length    Length of the data
  *                  数据长度
- * @return esp_err_t
+ * @return esp_err_t ESP_ERR_NO_MEM when the link has no free credit, the frame is not sent
+ *                   链路没有空闲额度时返回 ESP_ERR_NO_MEM，帧未发送
  */
 esp_err_t ble_write_without_response(uint16_t conn_id, uint16_t handle, const uint8_t *data, size_t length) {
-    if (!s_ble_profile.connection_status.is_connected) {
+    int link = link_by_conn_id(conn_id);
+    if (link < 0) {
         ESP_LOGW(TAG, "Not connected, skip write_without_response");
         return ESP_FAIL;
     }
-    esp_err_t ret = esp_ble_gattc_write_char(s_ble_profile.gattc_if,
+    if (take_tx_credit(link) != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = esp_ble_gattc_write_char(s_ble_profiles[link].gattc_if,
                                              conn_id,
                                              handle,
                                              length,
@@ -395,6 +604,7 @@ esp_err_t ble_write_without_response(uint16_t conn_id, uint16_t handle, const ui
                                              ESP_GATT_AUTH_REQ_NONE);
     if (ret) {
         ESP_LOGE(TAG, "write_char NO_RSP failed: %s", esp_err_to_name(ret));
+        give_tx_credit(link);
     }
     return ret;
 }
@@ -411,14 +621,19 @@ esp_err_t ble_write_without_response(uint16_t conn_id, uint16_t handle, const ui
  *                  要写入的数据
  * @param length    Length of the data
  *                  数据长度
- * @return esp_err_t
+ * @return esp_err_t ESP_ERR_NO_MEM when the link has no free credit, the frame is not sent
+ *                   链路没有空闲额度时返回 ESP_ERR_NO_MEM，帧未发送
  */
 esp_err_t ble_write_with_response(uint16_t conn_id, uint16_t handle, const uint8_t *data, size_t length) {
-    if (!s_ble_profile.connection_status.is_connected) {
+    int link = link_by_conn_id(conn_id);
+    if (link < 0) {
         ESP_LOGW(TAG, "Not connected, skip write_with_response");
         return ESP_FAIL;
     }
-    esp_err_t ret = esp_ble_gattc_write_char(s_ble_profile.gattc_if,
+    if (take_tx_credit(link) != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = esp_ble_gattc_write_char(s_ble_profiles[link].gattc_if,
                                              conn_id,
                                              handle,
                                              length,
@@ -427,6 +642,7 @@ esp_err_t ble_write_with_response(uint16_t conn_id, uint16_t handle, const uint8
                                              ESP_GATT_AUTH_REQ_NONE);
     if (ret) {
         ESP_LOGE(TAG, "write_char RSP failed: %s", esp_err_to_name(ret));
+        give_tx_credit(link);
     }
     return ret;
 }
@@ -442,14 +658,16 @@ esp_err_t ble_write_with_response(uint16_t conn_id, uint16_t handle, const uint8
  * @return esp_err_t
  */
 esp_err_t ble_register_notify(uint16_t conn_id, uint16_t char_handle) {
-    if (!s_ble_profile.connection_status.is_connected) {
+    int link = link_by_conn_id(conn_id);
+    if (link < 0) {
         ESP_LOGW(TAG, "Not connected, skip register_notify");
         return ESP_FAIL;
     }
     /* Request to subscribe to notifications from the protocol stack */
     /* 向协议栈请求订阅通知 */
-    esp_err_t ret = esp_ble_gattc_register_for_notify(s_ble_profile.gattc_if,
-                                                      s_ble_profile.remote_bda,
+    s_register_link = link;
+    esp_err_t ret = esp_ble_gattc_register_for_notify(s_ble_profiles[link].gattc_if,
+                                                      s_ble_profiles[link].remote_bda,
                                                       char_handle);
     if (ret) {
         ESP_LOGE(TAG, "register_notify failed: %s", esp_err_to_name(ret));
@@ -503,6 +721,94 @@ void ble_set_state_callback(connect_logic_state_callback_t cb) {
     s_state_cb = cb;
 }
 
+/* -------------------------
+ *  GATT handle cache
+ *  GATT 句柄缓存
+ * ------------------------- */
+
+/**
+ * @brief Check a characteristic declaration read from the camera
+ * 检查从相机读取的特征声明
+ *
+ * @param declaration  Declaration value (CHAR_DECLARATION_LENGTH bytes)
+ *                     声明的值（CHAR_DECLARATION_LENGTH 字节）
+ * @param value_handle Expected value handle
+ *                     期望的值句柄
+ * @param uuid16       Expected characteristic UUID
+ *                     期望的特征 UUID
+ * @return bool true if the declaration matches
+ *              声明一致时返回 true
+ */
+static bool char_declaration_matches(const uint8_t *declaration, uint16_t value_handle, uint16_t uuid16) {
+    return (uint16_t)(declaration[1] | (declaration[2] << 8)) == value_handle &&
+           (uint16_t)(declaration[3] | (declaration[4] << 8)) == uuid16;
+}
+
+/**
+ * @brief Verify the cached handles with one Read Multiple of both characteristic declarations
+ * 通过一次 Read Multiple 读取两个特征声明来校验缓存句柄
+ *
+ * A declaration immediately precedes its value handle, so a changed attribute
+ * table shows up as a wrong UUID or value handle.
+ * 特征声明紧邻其值句柄之前，因此属性表变化会表现为 UUID 或值句柄不一致。
+ */
+static esp_err_t gatt_cache_verify(int link, esp_gatt_if_t gattc_if, uint16_t conn_id) {
+    esp_gattc_multi_t read_multi = {
+        .num_attr = 2,
+        .handles = {s_links[link].gatt_cache.notify_char_handle - 1, s_links[link].gatt_cache.write_char_handle - 1},
+    };
+    return esp_ble_gattc_read_multiple(gattc_if, conn_id, &read_multi, ESP_GATT_AUTH_REQ_NONE);
+}
+
+/**
+ * @brief Drop the cached handles and discover the service on this connection
+ * 丢弃缓存句柄，在当前连接上重新发现服务
+ *
+ * @param reason Reason for the log
+ *               日志中的原因
+ */
+static void gatt_cache_fallback(int link, esp_gatt_if_t gattc_if, uint16_t conn_id, const char *reason) {
+    ESP_LOGW(TAG, "Link %d: cached GATT handles rejected (%s), discovering services", link, reason);
+    ble_gatt_cache_erase(s_links[link].gatt_cache.remote_bda);
+    s_links[link].gatt_cache_used = false;
+    esp_ble_gattc_search_service(gattc_if, conn_id, NULL);
+}
+
+/**
+ * @brief Wait until any of the given link events is set
+ * 等待任一指定的链路事件被置位
+ *
+ * @param link    Link to wait on
+ *                等待的链路
+ * @param bits    BLE_EVENT_* bits to wait for
+ *                需要等待的 BLE_EVENT_* 位
+ * @param timeout Timeout in ticks
+ *                超时时钟数
+ * @return EventBits_t Event bits at return, none of bits set on timeout
+ *                     返回时的事件位，超时时不含所等待的位
+ */
+EventBits_t ble_wait_events(int link, EventBits_t bits, TickType_t timeout) {
+    if (!is_link_valid(link)) {
+        return 0;
+    }
+    return xEventGroupWaitBits(s_links[link].events, bits, pdFALSE, pdFALSE, timeout);
+}
+
+/**
+ * @brief Clear link events, used before a new connect attempt
+ * 清除链路事件，在新的连接尝试前使用
+ *
+ * @param link Link to clear
+ *             需要清除的链路
+ * @param bits BLE_EVENT_* bits to clear
+ *             需要清除的 BLE_EVENT_* 位
+ */
+void ble_clear_events(int link, EventBits_t bits) {
+    if (is_link_valid(link)) {
+        xEventGroupClearBits(s_links[link].events, bits);
+    }
+}
+
 /* ----------------------------------------------------------------
  *   GAP & GATTC callback function implementation (simplified version)
  *   GAP & GATTC 回调函数实现（精简版）
@@ -516,25 +822,43 @@ static void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param
         break;
 
     case ESP_GAP_BLE_SCAN_STOP_COMPLETE_EVT:
-        ESP_LOGI(TAG, "scan stopped");
+        if (param->scan_stop_cmpl.status != ESP_BT_STATUS_SUCCESS) {
+            ESP_LOGW(TAG, "Scan stop failed, status=%d", param->scan_stop_cmpl.status);
+            break;
+        }
+        ESP_LOGI(TAG, "scan stopped after %lld ms", esp_timer_get_time() / 1000 - s_scan_start_ms);
         // After scanning ends, decide whether to connect based on reconnection mode and device discovery status
         // 扫描结束后，根据重连模式和设备发现状态决定是否连接
-        if (best_rssi > -128) {
-            if (!s_is_reconnecting || (s_is_reconnecting && s_found_previous_device)) {
-                ESP_LOGI(TAG, "Connecting to device: %02x:%02x:%02x:%02x:%02x:%02x",
-                         best_addr[0], best_addr[1], best_addr[2], best_addr[3], best_addr[4], best_addr[5]);
-                try_to_connect(best_addr);
-            } else {
-                ESP_LOGW(TAG, "In reconnection mode but target device not found");
+        if (!s_is_reconnecting && !is_addr_valid(best_addr)) {
+            // 没有提前连接的相机时，选择本次扫描听到的平滑信号最强、未被其他链路占用的相机
+            // Without an early pick, take the camera heard in this scan with the strongest smoothed signal not held by another link
+            const scan_cache_entry_t *best = scan_cache_best(&s_scan_cache, s_scan_start_ms, MIN_RSSI_THRESHOLD,
+                                                             is_held_by_link, NULL);
+            if (best != NULL) {
+                select_scan_target(best);
+            }
+        }
+        if (s_is_reconnecting ? s_found_previous_device : is_addr_valid(best_addr)) {
+            if (!s_is_reconnecting) {
+                memcpy(s_links[s_scan_link].addr, best_addr, sizeof(esp_bd_addr_t));
+                memcpy(s_links[s_scan_link].name, best_name, sizeof(best_name));
             }
+            ESP_LOGI(TAG, "Connecting to device: %02x:%02x:%02x:%02x:%02x:%02x",
+                     s_links[s_scan_link].addr[0], s_links[s_scan_link].addr[1], s_links[s_scan_link].addr[2],
+                     s_links[s_scan_link].addr[3], s_links[s_scan_link].addr[4], s_links[s_scan_link].addr[5]);
+            try_to_connect(s_scan_link);
+        } else if (s_is_reconnecting) {
+            ESP_LOGW(TAG, "In reconnection mode but target device not found");
+            set_link_events(s_scan_link, BLE_EVENT_SCAN_FAILED);
         } else {
             ESP_LOGW(TAG, "No suitable device found with sufficient signal strength");
+            set_link_events(s_scan_link, BLE_EVENT_SCAN_FAILED);
         }
         break;
 
     case ESP_GAP_BLE_SCAN_RESULT_EVT: {
         esp_ble_gap_cb_param_t *r = param;
-        if (r->scan_rst.search_evt == ESP_GAP_SEARCH_INQ_RES_EVT) {
+        if (r->scan_rst.search_evt == ESP_GAP_SEARCH_INQ_RES_EVT && !s_scan_stopping) {
             /* Get the complete name from the advertisement/response data */
             /* 获取广播/响应数据里的完整名称 */
             uint8_t *adv_name = NULL;
@@ -554,22 +878,32 @@ static void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param
                 // If the device name starts with "Osmo"
                 // 如果设备名以"Osmo"开头
                 if (strncmp((char *)adv_name, "Osmo", 4) == 0) {
+                    scan_cache_entry_t *entry = scan_cache_update(&s_scan_cache, r->scan_rst.bda, (const char *)adv_name,
+                                                                  adv_name_len, r->scan_rst.rssi,
+                                                                  esp_timer_get_time() / 1000);
+                    // NVS 中有句柄缓存说明曾经连接过，每次报告都重新判断，缓存可能在条目存续期间写入或清除
+                    // Cached handles in NVS mean it was connected before, checked on every report as the cache may be
+                    // written or cleared while the entry lives
+                    ble_gatt_cache_t cached;
+                    entry->known = (ble_gatt_cache_load(r->scan_rst.bda, &cached) == ESP_OK);
+
                     if (s_is_reconnecting) {
-                        // In reconnection mode, compare device addresses
-                        // 在重连模式下，比对设备地址
-                        if (memcmp(best_addr, r->scan_rst.bda, sizeof(esp_bd_addr_t)) == 0) {
+                        // In reconnection mode, compare device addresses and connect at once
+                        // 在重连模式下，比对设备地址，找到后立即连接
+                        if (memcmp(s_links[s_scan_link].addr, r->scan_rst.bda, sizeof(esp_bd_addr_t)) == 0) {
                             s_found_previous_device = true;
                             ESP_LOGI(TAG, "Found previous device: %s, RSSI: %d", adv_name, r->scan_rst.rssi);
+                            scan_stop_early();
                         }
-                    } else {
-                        // In normal scan mode, record the device with the strongest signal
-                        // 正常扫描模式，记录信号最强的设备
-                        if (r->scan_rst.rssi > best_rssi && r->scan_rst.rssi >= MIN_RSSI_THRESHOLD) {
-                            best_rssi = r->scan_rst.rssi;
-                            memcpy(best_addr, r->scan_rst.bda, sizeof(esp_bd_addr_t));
-                            strncpy(s_remote_device_name, (char *)adv_name, sizeof(s_remote_device_name) - 1);
-                            s_remote_device_name[sizeof(s_remote_device_name) - 1] = '\0';
-                        }
+                    } else if (scan_cache_connect_early(&s_scan_cache, entry, s_scan_start_ms, MIN_RSSI_THRESHOLD,
+                                                        EARLY_CONNECT_RSSI, EARLY_CONNECT_MARGIN, is_held_by_link, NULL)) {
+                        // In normal scan mode, a camera connected before, or a close one confirmed by a second report
+                        // or a clear lead, is connected without waiting for the window
+                        // 正常扫描模式，曾经连接过的相机，或经第二次报告或明显领先确认的近距离相机，无需等待窗口即连接
+                        select_scan_target(entry);
+                        ESP_LOGI(TAG, "Connecting early to %s, RSSI: %d%s", entry->name, scan_cache_rssi(entry),
+                                 entry->known ? ", known camera" : "");
+                        scan_stop_early();
                     }
                 }
             }
@@ -577,6 +911,25 @@ static void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param
         break;
     }
 
+    case ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT:
+        ESP_LOGI(TAG, "Link %d connection params: status=%d, interval=%u (x1.25 ms), latency=%u, timeout=%u",
+                 link_by_bda(param->update_conn_params.bda), param->update_conn_params.status,
+                 param->update_conn_params.conn_int, param->update_conn_params.latency,
+                 param->update_conn_params.timeout);
+        break;
+
+    case ESP_GAP_BLE_SET_PKT_LENGTH_COMPLETE_EVT:
+        ESP_LOGI(TAG, "Data length: status=%d, rx=%u, tx=%u", param->pkt_data_length_cmpl.status,
+                 param->pkt_data_length_cmpl.params.rx_len, param->pkt_data_length_cmpl.params.tx_len);
+        break;
+
+#if CONFIG_BT_BLE_50_FEATURES_SUPPORTED
+    case ESP_GAP_BLE_PHY_UPDATE_COMPLETE_EVT:
+        ESP_LOGI(TAG, "Link %d PHY: status=%d, tx=%u, rx=%u", link_by_bda(param->phy_update.bda),
+                 param->phy_update.status, param->phy_update.tx_phy, param->phy_update.rx_phy);
+        break;
+#endif
+
     default:
         break;
     }
@@ -585,10 +938,12 @@ static void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param
 static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_if, esp_ble_gattc_cb_param_t *param) {
     switch (event) {
     case ESP_GATTC_REG_EVT: {
-        // Handle GATT client registration event
-        // 处理 GATT 客户端注册事件
+        // Handle GATT client registration event, all links share the interface
+        // 处理 GATT 客户端注册事件，所有链路共用该接口
         if (param->reg.status == ESP_GATT_OK) {
-            s_ble_profile.gattc_if = gattc_if;
+            for (int i = 0; i < BLE_MAX_LINKS; i++) {
+                s_ble_profiles[i].gattc_if = gattc_if;
+            }
             ESP_LOGI(TAG, "GATTC register OK, app_id=%d, gattc_if=%d",
                      param->reg.app_id, gattc_if);
         } else {
@@ -599,10 +954,29 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
     case ESP_GATTC_CONNECT_EVT: {
         // Handle connection event
         // 处理连接事件
-        s_ble_profile.conn_id = param->connect.conn_id;
-        s_ble_profile.connection_status.is_connected = true;
-        memcpy(s_ble_profile.remote_bda, param->connect.remote_bda, sizeof(esp_bd_addr_t));
-        ESP_LOGI(TAG, "Connected, conn_id=%d", s_ble_profile.conn_id);
+        int link = link_by_bda(param->connect.remote_bda);
+        if (link < 0) {
+            ESP_LOGW(TAG, "Connect from unknown device, closing");
+            esp_ble_gattc_close(gattc_if, param->connect.conn_id);
+            break;
+        }
+        ble_profile_t *profile = &s_ble_profiles[link];
+        profile->conn_id = param->connect.conn_id;
+        profile->connection_status.is_connected = true;
+        memcpy(profile->remote_bda, param->connect.remote_bda, sizeof(esp_bd_addr_t));
+        s_links[link].connect_time_us = esp_timer_get_time();
+        s_links[link].mtu = ESP_GATT_DEF_BLE_MTU_SIZE;
+        s_links[link].gatt_cache_used = (ble_gatt_cache_load(param->connect.remote_bda, &s_links[link].gatt_cache) == ESP_OK);
+        ESP_LOGI(TAG, "Link %d connected, conn_id=%d%s", link, profile->conn_id,
+                 s_links[link].gatt_cache_used ? ", GATT handles cached" : "");
+
+        // 新连接的额度全部空闲，上一连接未完成的写入已随断开丢弃
+        // A new connection starts with every credit free, writes of the previous one went with the disconnect
+        s_links[link].congested = false;
+        while (uxSemaphoreGetCount(s_links[link].tx_credits) < BLE_TX_CREDITS) {
+            xSemaphoreGive(s_links[link].tx_credits);
+        }
+        set_link_events(link, BLE_EVENT_CONNECTED | BLE_EVENT_TX_READY);
 
         // Initiate MTU request
         // 发起 MTU 请求
@@ -615,6 +989,7 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
         s_connecting = false;
         if (param->open.status != ESP_GATT_OK) {
             ESP_LOGE(TAG, "Open failed, status=%d", param->open.status);
+            set_link_events(link_by_bda(param->open.remote_bda), BLE_EVENT_OPEN_FAILED);
             break;
         }
         ESP_LOGI(TAG, "Open success, MTU=%u", param->open.mtu);
@@ -623,34 +998,82 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
     case ESP_GATTC_CFG_MTU_EVT: {
         // Handle MTU configuration event
         // 处理 MTU 配置事件
+        int link = link_by_conn_id(param->cfg_mtu.conn_id);
+        if (link < 0) {
+            break;
+        }
         if (param->cfg_mtu.status != ESP_GATT_OK) {
             ESP_LOGE(TAG, "Config MTU Error, status=%d", param->cfg_mtu.status);
+        } else {
+            s_links[link].mtu = param->cfg_mtu.mtu;
         }
-        ESP_LOGI(TAG, "MTU=%d", param->cfg_mtu.mtu);
+        ESP_LOGI(TAG, "Link %d MTU=%d", link, param->cfg_mtu.mtu);
 
-        // Start service discovery after MTU configuration
-        // MTU 配置完后开始发现服务
+        // With cached handles only verify them, otherwise start service discovery after MTU configuration
+        // 有缓存句柄时只做校验，否则在 MTU 配置完后开始发现服务
+        if (s_links[link].gatt_cache_used) {
+            if (gatt_cache_verify(link, gattc_if, param->cfg_mtu.conn_id) != ESP_OK) {
+                gatt_cache_fallback(link, gattc_if, param->cfg_mtu.conn_id, "read request failed");
+            }
+            break;
+        }
         esp_ble_gattc_search_service(gattc_if, param->cfg_mtu.conn_id, NULL);
         break;
     }
+    case ESP_GATTC_READ_MULTIPLE_EVT: {
+        // Handle the verification of the cached handles
+        // 处理缓存句柄的校验结果
+        int link = link_by_conn_id(param->read.conn_id);
+        if (link < 0 || !s_links[link].gatt_cache_used) {
+            break;
+        }
+        ble_profile_t *profile = &s_ble_profiles[link];
+        const ble_gatt_cache_t *cache = &s_links[link].gatt_cache;
+        if (param->read.status != ESP_GATT_OK || param->read.value_len != 2 * CHAR_DECLARATION_LENGTH ||
+            !char_declaration_matches(param->read.value, cache->notify_char_handle, REMOTE_NOTIFY_CHAR_UUID) ||
+            !char_declaration_matches(param->read.value + CHAR_DECLARATION_LENGTH, cache->write_char_handle,
+                                      REMOTE_WRITE_CHAR_UUID)) {
+            gatt_cache_fallback(link, gattc_if, param->read.conn_id, "declarations differ");
+            break;
+        }
+        profile->service_start_handle = cache->service_start_handle;
+        profile->service_end_handle = cache->service_end_handle;
+        profile->notify_char_handle = cache->notify_char_handle;
+        profile->write_char_handle = cache->write_char_handle;
+        profile->notify_descr_handle = cache->notify_descr_handle;
+        profile->handle_discovery.notify_char_handle_found = true;
+        profile->handle_discovery.write_char_handle_found = true;
+        ESP_LOGI(TAG, "Link %d cached GATT handles verified, notify=0x%x, write=0x%x",
+                 link, profile->notify_char_handle, profile->write_char_handle);
+        set_link_events(link, BLE_EVENT_HANDLES_READY);
+        break;
+    }
     case ESP_GATTC_SEARCH_RES_EVT: {
         // Handle service search result event
         // 处理服务搜索结果事件
-        if ((param->search_res.srvc_id.uuid.len == ESP_UUID_LEN_16) &&
+        int link = link_by_conn_id(param->search_res.conn_id);
+        if (link >= 0 &&
+            (param->search_res.srvc_id.uuid.len == ESP_UUID_LEN_16) &&
             (param->search_res.srvc_id.uuid.uuid.uuid16 == REMOTE_TARGET_SERVICE_UUID)) {
-            s_ble_profile.service_start_handle = param->search_res.start_handle;
-            s_ble_profile.service_end_handle   = param->search_res.end_handle;
+            s_ble_profiles[link].service_start_handle = param->search_res.start_handle;
+            s_ble_profiles[link].service_end_handle   = param->search_res.end_handle;
             ESP_LOGI(TAG, "Service found: start=%d, end=%d",
-                     s_ble_profile.service_start_handle,
-                     s_ble_profile.service_end_handle);
+                     s_ble_profiles[link].service_start_handle,
+                     s_ble_profiles[link].service_end_handle);
         }
         break;
     }
     case ESP_GATTC_SEARCH_CMPL_EVT: {
         // Handle service search complete event
         // 处理服务搜索完成事件
+        int link = link_by_conn_id(param->search_cmpl.conn_id);
+        if (link < 0) {
+            break;
+        }
+        ble_profile_t *profile = &s_ble_profiles[link];
         if (param->search_cmpl.status != ESP_GATT_OK) {
             ESP_LOGE(TAG, "Service search failed, status=%d", param->search_cmpl.status);
+            set_link_events(link, BLE_EVENT_GATT_FAILED);
             break;
         }
         ESP_LOGI(TAG, "Service search complete, next get char by UUID");
@@ -660,17 +1083,17 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
         uint16_t count = 1;
         esp_gattc_char_elem_t char_elem_result;
         esp_ble_gattc_get_char_by_uuid(gattc_if,
-                                       s_ble_profile.conn_id,
-                                       s_ble_profile.service_start_handle,
-                                       s_ble_profile.service_end_handle,
+                                       profile->conn_id,
+                                       profile->service_start_handle,
+                                       profile->service_end_handle,
                                        s_filter_notify_char_uuid,
                                        &char_elem_result,
                                        &count);
         if (count > 0) {
-            s_ble_profile.notify_char_handle = char_elem_result.char_handle;
-            s_ble_profile.handle_discovery.notify_char_handle_found = true;
+            profile->notify_char_handle = char_elem_result.char_handle;
+            profile->handle_discovery.notify_char_handle_found = true;
             ESP_LOGI(TAG, "Notify Char found, handle=0x%x",
-                     s_ble_profile.notify_char_handle);
+                     profile->notify_char_handle);
         }
 
         // Get write characteristic handle
@@ -678,71 +1101,173 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
         count = 1;
         esp_gattc_char_elem_t write_char_elem_result;
         esp_ble_gattc_get_char_by_uuid(gattc_if,
-                                       s_ble_profile.conn_id,
-                                       s_ble_profile.service_start_handle,
-                                       s_ble_profile.service_end_handle,
+                                       profile->conn_id,
+                                       profile->service_start_handle,
+                                       profile->service_end_handle,
                                        s_filter_write_char_uuid,
                                        &write_char_elem_result,
                                        &count);
         if (count > 0) {
-            s_ble_profile.write_char_handle = write_char_elem_result.char_handle;
-            s_ble_profile.handle_discovery.write_char_handle_found = true;
+            profile->write_char_handle = write_char_elem_result.char_handle;
+            profile->handle_discovery.write_char_handle_found = true;
             ESP_LOGI(TAG, "Write Char found, handle=0x%x",
-                     s_ble_profile.write_char_handle);
+                     profile->write_char_handle);
         }
 
+        set_link_events(link,
+                        (profile->handle_discovery.notify_char_handle_found &&
+                         profile->handle_discovery.write_char_handle_found) ?
+                        BLE_EVENT_HANDLES_READY : BLE_EVENT_GATT_FAILED);
         break;
     }
     case ESP_GATTC_REG_FOR_NOTIFY_EVT: {
         // Handle notification registration event
         // 处理通知注册事件
+        int link = s_register_link;
+        if (!is_link_valid(link) || !s_ble_profiles[link].connection_status.is_connected) {
+            break;
+        }
+        ble_profile_t *profile = &s_ble_profiles[link];
         if (param->reg_for_notify.status != ESP_GATT_OK) {
             ESP_LOGE(TAG, "Notify register failed, status=%d", param->reg_for_notify.status);
+            set_link_events(link, BLE_EVENT_GATT_FAILED);
             break;
         }
-        ESP_LOGI(TAG, "Notify register success, handle=0x%x", param->reg_for_notify.handle);
+        ESP_LOGI(TAG, "Link %d notify register success, handle=0x%x", link, param->reg_for_notify.handle);
 
-        // Find descriptor and write 0x01 to enable notification
-        // 找到对应描述符并写入 0x01 使能通知
-        uint16_t count = 1;
-        esp_gattc_descr_elem_t descr_elem;
-        esp_ble_gattc_get_descr_by_char_handle(gattc_if,
-                                               s_ble_profile.conn_id,
-                                               param->reg_for_notify.handle,
-                                               s_notify_descr_uuid,
-                                               &descr_elem,
-                                               &count);
-        if (count > 0 && descr_elem.handle) {
+        // Find descriptor (unless cached) and write 0x01 to enable notification
+        // 找到对应描述符（已缓存时跳过）并写入 0x01 使能通知
+        if (profile->notify_descr_handle == 0) {
+            uint16_t count = 1;
+            esp_gattc_descr_elem_t descr_elem;
+            esp_ble_gattc_get_descr_by_char_handle(gattc_if,
+                                                   profile->conn_id,
+                                                   param->reg_for_notify.handle,
+                                                   s_notify_descr_uuid,
+                                                   &descr_elem,
+                                                   &count);
+            if (count > 0) {
+                profile->notify_descr_handle = descr_elem.handle;
+            }
+        }
+        if (profile->notify_descr_handle) {
             uint16_t notify_en = 1;
             esp_ble_gattc_write_char_descr(gattc_if,
-                                           s_ble_profile.conn_id,
-                                           descr_elem.handle,
+                                           profile->conn_id,
+                                           profile->notify_descr_handle,
                                            sizeof(notify_en),
                                            (uint8_t *)&notify_en,
                                            ESP_GATT_WRITE_TYPE_RSP,
                                            ESP_GATT_AUTH_REQ_NONE);
+        } else {
+            ESP_LOGE(TAG, "Notify descriptor not found");
+            set_link_events(link, BLE_EVENT_GATT_FAILED);
         }
         break;
     }
+    case ESP_GATTC_WRITE_DESCR_EVT: {
+        // Handle notification enable result, cache the handles after a discovery
+        // 处理通知使能结果，发现服务后缓存句柄
+        int link = link_by_conn_id(param->write.conn_id);
+        if (link < 0 || param->write.handle != s_ble_profiles[link].notify_descr_handle) {
+            break;
+        }
+        ble_profile_t *profile = &s_ble_profiles[link];
+        if (param->write.status != ESP_GATT_OK) {
+            ESP_LOGE(TAG, "Notify enable failed, status=%d", param->write.status);
+            if (s_links[link].gatt_cache_used) {
+                ble_gatt_cache_erase(profile->remote_bda);
+            }
+            set_link_events(link, BLE_EVENT_GATT_FAILED);
+            break;
+        }
+        profile->handle_discovery.notify_enabled = true;
+        set_link_events(link, BLE_EVENT_NOTIFY_ENABLED);
+        ESP_LOGI(TAG, "Link %d notify enabled %lld ms after connect (%s handles)", link,
+                 (long long)((esp_timer_get_time() - s_links[link].connect_time_us) / 1000),
+                 s_links[link].gatt_cache_used ? "cached" : "discovered");
+
+        if (!s_links[link].gatt_cache_used) {
+            ble_gatt_cache_t entry = {
+                .service_start_handle = profile->service_start_handle,
+                .service_end_handle = profile->service_end_handle,
+                .notify_char_handle = profile->notify_char_handle,
+                .write_char_handle = profile->write_char_handle,
+                .notify_descr_handle = profile->notify_descr_handle,
+            };
+            memcpy(entry.remote_bda, profile->remote_bda, sizeof(esp_bd_addr_t));
+            ble_gatt_cache_store(&entry);
+        }
+        break;
+    }
+    case ESP_GATTC_SRVC_CHG_EVT: {
+        // The camera changed its attribute table, the cached handles are stale
+        // 相机的属性表已变化，缓存句柄失效
+        ESP_LOGI(TAG, "Service changed, dropping cached GATT handles");
+        ble_gatt_cache_erase(param->srvc_chg.remote_bda);
+        break;
+    }
+    case ESP_GATTC_WRITE_CHAR_EVT: {
+        // A write left the stack (or got its response), its credit is free again. Bluedroid reports a
+        // write-without-response here once it is handed to L2CAP, with status ESP_GATT_CONGESTED when
+        // that filled the link's buffers; take_tx_credit() covers a report that never comes.
+        // 写入已离开协议栈（或已收到应答），归还其额度。Bluedroid 在无应答写入交给 L2CAP 后即在此上报，
+        // 若因此填满链路缓冲区则状态为 ESP_GATT_CONGESTED；未上报的情况由 take_tx_credit() 兜底。
+        int link = link_by_conn_id(param->write.conn_id);
+        if (link < 0) {
+            break;
+        }
+        if (param->write.status != ESP_GATT_OK && param->write.status != ESP_GATT_CONGESTED) {
+            ESP_LOGW(TAG, "Link %d write failed, status=%d", link, param->write.status);
+        }
+        give_tx_credit(link);
+        break;
+    }
+    case ESP_GATTC_CONGEST_EVT: {
+        // The stack ran out of buffers for the link, hold writes until it drains
+        // 协议栈中该链路的缓冲区已满，暂停写入直到排空
+        int link = link_by_conn_id(param->congest.conn_id);
+        if (link < 0) {
+            break;
+        }
+        s_links[link].congested = param->congest.congested;
+        ESP_LOGD(TAG, "Link %d %s", link, param->congest.congested ? "congested" : "uncongested");
+        update_tx_ready(link);
+        break;
+    }
     case ESP_GATTC_NOTIFY_EVT: {
         // Handle notification data event
         // 处理通知数据事件
-        if (s_notify_cb) {
-            s_notify_cb(param->notify.value, param->notify.value_len);
+        int link = link_by_conn_id(param->notify.conn_id);
+        if (s_notify_cb && link >= 0) {
+            s_notify_cb(link, param->notify.value, param->notify.value_len);
         }
         break;
     }
     case ESP_GATTC_DISCONNECT_EVT: {
         // Handle disconnection event
         // 处理断开连接事件
-        s_ble_profile.connection_status.is_connected = false;
-        s_ble_profile.handle_discovery.write_char_handle_found = false;
-        s_ble_profile.handle_discovery.notify_char_handle_found = false;
+        int link = link_by_conn_id(param->disconnect.conn_id);
+        if (link < 0) {
+            break;
+        }
+        ble_profile_t *profile = &s_ble_profiles[link];
+        profile->connection_status.is_connected = false;
+        profile->handle_discovery.write_char_handle_found = false;
+        profile->handle_discovery.notify_char_handle_found = false;
+        profile->handle_discovery.notify_enabled = false;
+        profile->notify_descr_handle = 0;
+        s_links[link].gatt_cache_used = false;
+        s_links[link].mtu = 0;
+        s_links[link].tx_octets = 0;
         s_connecting = false;
-        ESP_LOGI(TAG, "Disconnected, reason=0x%x", param->disconnect.reason);
+        ESP_LOGI(TAG, "Link %d disconnected, reason=0x%x", link, param->disconnect.reason);
+        xEventGroupClearBits(s_links[link].events, BLE_EVENT_CONNECTED | BLE_EVENT_HANDLES_READY | BLE_EVENT_NOTIFY_ENABLED |
+                                                   BLE_EVENT_TX_READY);
+        xEventGroupSetBits(s_links[link].events, BLE_EVENT_DISCONNECTED);
 
         if (s_state_cb) {
-            s_state_cb();
+            s_state_cb(link);
         }
         break;
     }
@@ -750,3 +1275,122 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
         break;
     }
 }
+
+/* -------------------------
+ *  Camera link transport
+ *  相机链路传输层
+ * ------------------------- */
+
+static esp_err_t bluedroid_open(int link, bool reconnect) {
+    return reconnect ? ble_reconnect(link) : ble_start_scanning_and_connect(link);
+}
+
+/**
+ * @brief Enable notifications of the camera characteristic once its handles are known
+ * 在特征句柄已知后开启相机特征的通知
+ */
+static esp_err_t bluedroid_enable_notify(int link) {
+    if (!is_link_valid(link)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ble_register_notify(s_ble_profiles[link].conn_id, s_ble_profiles[link].notify_char_handle);
+}
+
+/**
+ * @brief Write one frame to the write characteristic of a link
+ * 向链路的写特征写入一帧
+ */
+static esp_err_t bluedroid_write(int link, const uint8_t *data, size_t length, bool with_response) {
+    if (!is_link_valid(link) || !s_ble_profiles[link].connection_status.is_connected) {
+        ESP_LOGW(TAG, "Link %d not connected, skip write", link);
+        return ESP_FAIL;
+    }
+    if (length + BLE_ATT_HEADER_LENGTH > s_links[link].mtu) {
+        ESP_LOGE(TAG, "Link %d: write of %u bytes exceeds MTU %u", link, (unsigned)length, s_links[link].mtu);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    ble_profile_t *profile = &s_ble_profiles[link];
+    return with_response ? ble_write_with_response(profile->conn_id, profile->write_char_handle, data, length)
+                         : ble_write_without_response(profile->conn_id, profile->write_char_handle, data, length);
+}
+
+static uint16_t bluedroid_get_mtu(int link) {
+    return is_link_valid(link) ? s_links[link].mtu : 0;
+}
+
+static esp_err_t bluedroid_get_peer_addr(int link, uint8_t addr[6]) {
+    if (!is_link_valid(link) || !is_addr_valid(s_links[link].addr)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    memcpy(addr, s_links[link].addr, sizeof(esp_bd_addr_t));
+    return ESP_OK;
+}
+
+/**
+ * @brief Request the connection parameters, data length and PHY of a profile
+ * 请求配置对应的连接参数、数据长度与 PHY
+ *
+ * The requests complete asynchronously, the results are logged from the GAP callback.
+ * 请求异步完成，结果在 GAP 回调中打印。
+ */
+static esp_err_t bluedroid_set_link_profile(int link, ble_link_profile_t profile) {
+    const ble_link_params_t *params = ble_transport_get_link_params(profile);
+    if (!is_link_valid(link) || params == NULL || !s_ble_profiles[link].connection_status.is_connected) {
+        return ESP_FAIL;
+    }
+    uint8_t *bda = s_ble_profiles[link].remote_bda;
+
+    esp_ble_conn_update_params_t conn_params = {
+        .min_int = params->min_interval,
+        .max_int = params->max_interval,
+        .latency = params->latency,
+        .timeout = params->timeout,
+    };
+    memcpy(conn_params.bda, bda, sizeof(esp_bd_addr_t));
+    esp_err_t ret = esp_ble_gap_update_conn_params(&conn_params);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Link %d: connection parameter update failed: %s", link, esp_err_to_name(ret));
+        return ret;
+    }
+
+    // 数据长度扩展只需协商一次，重复请求相同长度不会产生空口交互
+    // Data length extension is negotiated once, asking again for the same length causes no air traffic
+    if (s_links[link].tx_octets != params->tx_octets) {
+        ret = esp_ble_gap_set_pkt_data_len(bda, params->tx_octets);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Link %d: data length request failed: %s", link, esp_err_to_name(ret));
+        } else {
+            s_links[link].tx_octets = params->tx_octets;
+        }
+    }
+
+#if CONFIG_BT_BLE_50_FEATURES_SUPPORTED
+    esp_ble_gap_phy_mask_t phy_mask = params->phy_2m ? ESP_BLE_GAP_PHY_2M_PREF_MASK | ESP_BLE_GAP_PHY_1M_PREF_MASK
+                                                     : ESP_BLE_GAP_PHY_1M_PREF_MASK;
+    ret = esp_ble_gap_set_preferred_phy(bda, 0, phy_mask, phy_mask, ESP_BLE_GAP_PHY_OPTIONS_NO_PREF);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Link %d: PHY request failed: %s", link, esp_err_to_name(ret));
+    }
+#endif
+
+    ESP_LOGI(TAG, "Link %d: requested %s profile, interval %u-%u, latency %u", link, params->name,
+             params->min_interval, params->max_interval, params->latency);
+    return ESP_OK;
+}
+
+const ble_transport_t ble_bluedroid_transport = {
+    .name = "Bluedroid",
+    .init = ble_init,
+    .open = bluedroid_open,
+    .enable_notify = bluedroid_enable_notify,
+    .close = ble_disconnect,
+    .forget = ble_forget_link,
+    .write = bluedroid_write,
+    .get_mtu = bluedroid_get_mtu,
+    .get_peer_addr = bluedroid_get_peer_addr,
+    .wait_events = ble_wait_events,
+    .clear_events = ble_clear_events,
+    .set_notify_callback = ble_set_notify_callback,
+    .set_state_callback = ble_set_state_callback,
+    .set_link_profile = bluedroid_set_link_profile,
+};
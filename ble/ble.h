@@ -25,9 +25,12 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
 #include "esp_err.h"
 #include "esp_gatt_defs.h"
 #include "esp_gattc_api.h"
+#include "ble_transport.h"
 
 /* Connection status structure */
 /* 连接状态结构体 */
@@ -40,10 +43,11 @@ typedef struct {
 typedef struct {
     bool notify_char_handle_found; // Notify characteristic handle found
     bool write_char_handle_found;  // Write characteristic handle found
+    bool notify_enabled;           // Client Characteristic Configuration written
 } handle_discovery_t;
 
-/* Global profile structure to manage connection and characteristic information */
-/* 为了简化，做一个全局的 profile 结构体来管理连接与特征信息 */
+/* Per-link profile structure to manage connection and characteristic information */
+/* 每条链路一个 profile 结构体，用于管理连接与特征信息 */
 typedef struct {
     uint16_t conn_id;              // Connection ID
     esp_gatt_if_t gattc_if;        // GATT client interface
@@ -53,6 +57,7 @@ typedef struct {
     uint16_t notify_char_handle;   // Notify characteristic handle
     uint16_t write_char_handle;    // Write characteristic handle
     uint16_t read_char_handle;     // Read characteristic handle
+    uint16_t notify_descr_handle;  // Client Characteristic Configuration descriptor handle
 
     /* Start and end handles of the service */
     /* service 的起始和结束 handle */
@@ -67,28 +72,19 @@ typedef struct {
     handle_discovery_t handle_discovery;       // Handle discovery status
 } ble_profile_t;
 
-extern ble_profile_t s_ble_profile;
+extern ble_profile_t s_ble_profiles[BLE_MAX_LINKS];
 
-/**
- * @brief Notify callback function type for receiving data from remote
- * Notify 回调函数类型，用于接收从远端发来的数据
- *
- * @param data   Pointer to the notification data
- *               通知的数据指针
- * @param length Length of the notification data
- *               通知的数据长度
- */
-typedef void (*ble_notify_callback_t)(const uint8_t *data, size_t length);
+esp_err_t ble_init();
 
-typedef void (*connect_logic_state_callback_t)(void);
+esp_err_t ble_start_scanning_and_connect(int link);
 
-esp_err_t ble_init();
+esp_err_t ble_reconnect(int link);
 
-esp_err_t ble_start_scanning_and_connect(void);
+esp_err_t ble_disconnect(int link);
 
-esp_err_t ble_reconnect(void);
+void ble_forget_link(int link);
 
-esp_err_t ble_disconnect(void);
+ble_profile_t *ble_get_profile(int link);
 
 esp_err_t ble_read(uint16_t conn_id, uint16_t handle);
 
@@ -104,4 +100,12 @@ void ble_set_notify_callback(ble_notify_callback_t cb);
 
 void ble_set_state_callback(connect_logic_state_callback_t cb);
 
+EventBits_t ble_wait_events(int link, EventBits_t bits, TickType_t timeout);
+
+void ble_clear_events(int link, EventBits_t bits);
+
+/* Bluedroid implementation of the camera link transport */
+/* 相机链路传输层的 Bluedroid 实现 */
+extern const ble_transport_t ble_bluedroid_transport;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#include <stdio.h>
+#include <string.h>
+#include "nvs.h"
+#include "esp_log.h"
+#include "ble_gatt_cache.h"
+
+#define TAG "BLE_GATT_CACHE"
+
+#define GATT_CACHE_NVS_NAMESPACE  "gatt_cache"
+#define GATT_CACHE_VERSION        1
+
+/**
+ * @brief Build the NVS key of a camera address ("h" + 12 hex digits)
+ * 生成相机地址对应的 NVS 键（"h" + 12 位十六进制）
+ */
+static void gatt_cache_key(const esp_bd_addr_t remote_bda, char key[NVS_KEY_NAME_MAX_SIZE]) {
+    snprintf(key, NVS_KEY_NAME_MAX_SIZE, "h%02x%02x%02x%02x%02x%02x",
+             remote_bda[0], remote_bda[1], remote_bda[2], remote_bda[3], remote_bda[4], remote_bda[5]);
+}
+
+/**
+ * @brief Load the cached handles of a camera
+ * 读取某台相机的缓存句柄
+ *
+ * @param remote_bda Camera address
+ *                   相机地址
+ * @param entry      Output cache entry
+ *                   输出的缓存条目
+ * @return esp_err_t
+ *         - ESP_OK if a complete entry was found
+ *         - ESP_ERR_NOT_FOUND otherwise
+ */
+esp_err_t ble_gatt_cache_load(const esp_bd_addr_t remote_bda, ble_gatt_cache_t *entry) {
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    nvs_handle_t handle;
+    size_t length = sizeof(*entry);
+
+    if (nvs_open(GATT_CACHE_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    gatt_cache_key(remote_bda, key);
+    esp_err_t ret = nvs_get_blob(handle, key, entry, &length);
+    nvs_close(handle);
+
+    if (ret != ESP_OK || length != sizeof(*entry) || entry->version != GATT_CACHE_VERSION ||
+        memcmp(entry->remote_bda, remote_bda, sizeof(esp_bd_addr_t)) != 0 ||
+        entry->notify_char_handle < 2 || entry->write_char_handle < 2 || entry->notify_descr_handle == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Store the handles of a camera
+ * 保存某台相机的句柄
+ *
+ * @param entry Cache entry, the version is filled in here
+ *              缓存条目，版本号在此填写
+ * @return esp_err_t
+ */
+esp_err_t ble_gatt_cache_store(ble_gatt_cache_t *entry) {
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    nvs_handle_t handle;
+
+    entry->version = GATT_CACHE_VERSION;
+    esp_err_t ret = nvs_open(GATT_CACHE_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    gatt_cache_key(entry->remote_bda, key);
+    ret = nvs_set_blob(handle, key, entry, sizeof(*entry));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to store GATT handles: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * @brief Forget the cached handles of a camera
+ * 删除某台相机的缓存句柄
+ *
+ * @param remote_bda Camera address
+ *                   相机地址
+ */
+void ble_gatt_cache_erase(const esp_bd_addr_t remote_bda) {
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    nvs_handle_t handle;
+
+    if (nvs_open(GATT_CACHE_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        return;
+    }
+    gatt_cache_key(remote_bda, key);
+    if (nvs_erase_key(handle, key) == ESP_OK) {
+        nvs_commit(handle);
+    }
+    nvs_close(handle);
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __BLE_GATT_CACHE_H__
+#define __BLE_GATT_CACHE_H__
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_bt_defs.h"
+
+/* Handles of the camera service, cached per camera address in NVS */
+/* 相机服务的句柄，按相机地址缓存在 NVS 中 */
+typedef struct {
+    uint8_t version;                // Record version
+    esp_bd_addr_t remote_bda;       // Camera address
+    uint16_t service_start_handle;  // Service start handle
+    uint16_t service_end_handle;    // Service end handle
+    uint16_t notify_char_handle;    // Notify characteristic value handle
+    uint16_t write_char_handle;     // Write characteristic value handle
+    uint16_t notify_descr_handle;   // Client Characteristic Configuration descriptor of the notify characteristic
+} __attribute__((packed)) ble_gatt_cache_t;
+
+esp_err_t ble_gatt_cache_load(const esp_bd_addr_t remote_bda, ble_gatt_cache_t *entry);
+
+esp_err_t ble_gatt_cache_store(ble_gatt_cache_t *entry);
+
+void ble_gatt_cache_erase(const esp_bd_addr_t remote_bda);
+
+#endif
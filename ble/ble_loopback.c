@@ -0,0 +1,953 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "custom_crc16.h"
+#include "custom_crc32.h"
+#include "dji_protocol_data_structures.h"
+#include "ble_loopback.h"
+
+#define TAG "BLE_LOOPBACK"
+
+/* Frames in flight over all links and both directions: the host credits plus as many camera frames */
+/* 所有链路、两个方向上同时在途的帧数：主机的写入额度加上同样数量的相机帧 */
+#define LOOPBACK_QUEUE_LENGTH   (BLE_MAX_LINKS * BLE_TX_CREDITS * 2)
+
+/* Connection interval before a profile is set, 30 ms like a typical central default, in 1.25 ms units */
+/* 设置配置前的连接间隔，与常见主机默认值一样为 30 ms，单位 1.25 ms */
+#define LOOPBACK_DEFAULT_INTERVAL  24
+
+/* LL payload before data length extension */
+/* 数据长度扩展之前的链路层负载 */
+#define LOOPBACK_DEFAULT_TX_OCTETS 27
+
+/* Per LL packet: preamble, access address, header and CRC on 1M; L2CAP header per frame */
+/* 每个链路层包：1M 下的前导码、接入地址、包头与 CRC；每帧一个 L2CAP 头 */
+#define LL_PACKET_OVERHEAD      10
+#define L2CAP_HEADER_LENGTH     4
+/* Two inter frame spaces and the empty packet that acknowledges each data packet on 1M, in us */
+/* 每个数据包的两个帧间隔与 1M 下作为确认的空包，单位 us */
+#define LL_PACKET_TURNAROUND_US (150 + 150 + 80)
+
+/* 2M PHY only when the build enables the BLE 5.0 features, like the Bluetooth transport */
+/* 与蓝牙传输层一致，仅在构建启用 BLE 5.0 特性时使用 2M PHY */
+#if CONFIG_BT_BLE_50_FEATURES_SUPPORTED
+#define LOOPBACK_PHY_2M         1
+#else
+#define LOOPBACK_PHY_2M         0
+#endif
+
+/* Above the logic tasks, like the Bluetooth host task it stands in for */
+/* 高于各逻辑任务，与被替代的蓝牙主机任务一致 */
+#define LOOPBACK_TASK_PRIORITY  6
+
+/* Protocol frame: header up to CRC-16, CmdSet and CmdID, then the CRC-32 */
+/* 协议帧：到 CRC-16 为止的帧头、CmdSet 与 CmdID，最后是 CRC-32 */
+#define FRAME_HEADER_LENGTH     12
+#define FRAME_MIN_LENGTH        (FRAME_HEADER_LENGTH + 2 + 4)
+#define FRAME_MAX_LENGTH        1023
+#define FRAME_ACK_NO_RESPONSE   0x20
+#define FRAME_CMD_WAIT_RESULT   0x02
+
+/* Zero payload of a generic ACK: ret_code 0, long enough for the fixed size response parsers */
+/* 通用应答的全零负载：ret_code 为 0，长度满足定长应答解析 */
+#define CAMERA_ACK_PAYLOAD_LENGTH 32
+
+/* Largest payload the built-in camera sends */
+/* 内置相机发送的最大负载 */
+#define CAMERA_MAX_PAYLOAD_LENGTH 64
+
+typedef enum {
+    LOOPBACK_CONNECT,     // Link comes up
+    LOOPBACK_TO_CAMERA,   // Frame written by the host
+    LOOPBACK_TO_HOST,     // Notification from the camera side
+    LOOPBACK_DISCONNECT,  // Link goes down
+} loopback_kind_t;
+
+typedef struct {
+    loopback_kind_t kind;
+    int link;
+    uint32_t generation;  // Link generation at send time, frames of an older connection are dropped
+    int64_t due_us;       // Delivery time
+    bool lost;            // Lost on the way, still takes its air time and credit until due
+    uint8_t *data;
+    size_t length;
+} loopback_packet_t;
+
+typedef enum {
+    LINK_DOWN,
+    LINK_CONNECTING,
+    LINK_UP,
+} loopback_link_state_t;
+
+typedef struct {
+    EventGroupHandle_t events;
+    volatile loopback_link_state_t state;
+    volatile bool notify_enabled;
+    uint32_t generation;
+    const ble_link_params_t *params;  // Parameters in use, NULL until a profile is set
+    int64_t anchor_us;                // First connection event with the current parameters
+    int64_t closed_events;            // Connection events of earlier parameters
+    int64_t closed_camera_events;     // Events the camera attended with earlier parameters
+    int64_t extra_events;             // Events the camera woke up for to send, off its latency schedule
+    int64_t last_extra_event;         // Index of the last such event, several frames share one event
+    int64_t last_due_us[2];           // Last delivery time per direction, keeps the order
+    int64_t air_end_us;               // End of the last frame on air, frames of one link share the radio
+    int tx_in_flight;                 // Host writes holding a credit
+    uint8_t rx_buffer[FRAME_MAX_LENGTH];  // Written bytes the camera side has not framed yet
+    size_t rx_length;
+} loopback_link_t;
+
+static ble_loopback_config_t s_config = {
+    .latency_us = 1000,
+    .jitter_us = 0,
+    .loss_per_mille = 0,
+    .mtu = 247,
+};
+
+static loopback_link_t s_links[BLE_MAX_LINKS];
+static ble_loopback_stats_t s_stats = {0};
+/* Packets in flight sorted by delivery time, each link and direction waits for its own connection events */
+/* 按投递时间排序的在途数据包，每条链路、每个方向等待各自的连接事件 */
+static loopback_packet_t s_pending[LOOPBACK_QUEUE_LENGTH];
+static int s_pending_count = 0;
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_task = NULL;
+static esp_timer_handle_t s_timer = NULL;
+/* Sequence numbers of camera commands, kept away from the low numbers the host starts with */
+/* 相机命令的序列号，避开主机起始使用的小序号 */
+static uint16_t s_camera_seq = 0x8000;
+
+static ble_notify_callback_t s_notify_cb = NULL;
+static connect_logic_state_callback_t s_state_cb = NULL;
+static ble_loopback_peer_t s_peer = ble_loopback_camera_peer;
+
+/* Pairing state of the built-in camera of each link, kept across connections like a real camera */
+/* 每条链路内置相机的配对状态，与真实相机一样跨连接保留 */
+typedef struct {
+    bool paired;
+    uint32_t device_id;        // Remote that completed the pairing
+    bool approval_pending;     // First pairing waiting for the user, see approval_timer_callback()
+    uint32_t pending_device_id;
+} camera_pairing_t;
+
+static camera_pairing_t s_pairing[BLE_MAX_LINKS];
+static esp_timer_handle_t s_approval_timer = NULL;
+
+static void approval_timer_callback(void *arg);
+
+static bool is_link_valid(int link) {
+    return link >= 0 && link < BLE_MAX_LINKS;
+}
+
+static uint32_t link_interval_us(const loopback_link_t *l) {
+    return (l->params ? l->params->max_interval : LOOPBACK_DEFAULT_INTERVAL) * 1250;
+}
+
+static uint32_t link_latency(const loopback_link_t *l) {
+    return l->params ? l->params->latency : 0;
+}
+
+/**
+ * @brief Air time of one frame, split into LL packets of the negotiated length
+ * 一帧的空中时间，按协商的长度拆分为链路层包
+ */
+static uint32_t link_airtime_us(const loopback_link_t *l, size_t length) {
+    uint16_t tx_octets = l->params ? l->params->tx_octets : LOOPBACK_DEFAULT_TX_OCTETS;
+    uint32_t bits_per_us = l->params && l->params->phy_2m && LOOPBACK_PHY_2M ? 2 : 1;
+    size_t remaining = length + L2CAP_HEADER_LENGTH;
+    uint32_t airtime_us = 0;
+    while (remaining > 0) {
+        size_t octets = remaining < tx_octets ? remaining : tx_octets;
+        airtime_us += (octets + LL_PACKET_OVERHEAD) * 8 / bits_per_us + LL_PACKET_TURNAROUND_US;
+        remaining -= octets;
+    }
+    return airtime_us;
+}
+
+/**
+ * @brief Time of the connection event that carries a frame sent now
+ * 计算当前发送的帧所在连接事件的时间
+ *
+ * The host attends every event. The camera only listens every (latency + 1) events, so frames to it wait
+ * for the next listening event; a camera with data wakes up at the next event, which costs it an extra one.
+ * 主机参加每个连接事件。相机每 (latency + 1) 个事件才监听一次，发往相机的帧要等到下一个监听事件；
+ * 相机有数据时在下一个事件醒来发送，多消耗一个事件。
+ */
+static int64_t link_next_event_us(loopback_link_t *l, loopback_kind_t kind, int64_t now_us) {
+    int64_t interval_us = link_interval_us(l);
+    int64_t skip = link_latency(l) + 1;
+    int64_t event = now_us > l->anchor_us ? (now_us - l->anchor_us + interval_us - 1) / interval_us : 0;
+    if (kind == LOOPBACK_TO_CAMERA) {
+        event = (event + skip - 1) / skip * skip;
+    } else if (event % skip != 0 && event != l->last_extra_event) {
+        l->extra_events++;
+        l->last_extra_event = event;
+    }
+    return l->anchor_us + event * interval_us;
+}
+
+/**
+ * @brief Close the event count of the current parameters and start counting from now
+ * 结束当前参数下的事件计数，并从此刻重新开始
+ */
+static void link_restart_events(loopback_link_t *l, int64_t now_us) {
+    if (l->anchor_us > 0 && now_us > l->anchor_us) {
+        int64_t events = (now_us - l->anchor_us) / link_interval_us(l);
+        l->closed_events += events;
+        l->closed_camera_events += events / (link_latency(l) + 1);
+    }
+    l->anchor_us = now_us;
+    l->last_extra_event = -1;
+}
+
+/**
+ * @brief Insert a packet into the pending list, after those due at the same time
+ * 将数据包插入待投递列表，排在同一时间到期的数据包之后
+ */
+static bool pending_insert(const loopback_packet_t *packet) {
+    if (s_pending_count >= LOOPBACK_QUEUE_LENGTH) {
+        return false;
+    }
+    int index = s_pending_count;
+    while (index > 0 && s_pending[index - 1].due_us > packet->due_us) {
+        s_pending[index] = s_pending[index - 1];
+        index--;
+    }
+    s_pending[index] = *packet;
+    s_pending_count++;
+    if (index == 0) {
+        xTaskNotifyGive(s_task);
+    }
+    return true;
+}
+
+/**
+ * @brief Queue a packet for delivery at the connection event that carries it
+ * 将数据包放入队列，在承载它的连接事件投递
+ *
+ * A frame goes on air at that event, or right after the previous frame while the link is still sending,
+ * so a busy link drains at its air time rate. The processing latency comes on top. Delivery times on one link and direction never
+ * go backwards, so jitter delays frames but keeps their order like a BLE link.
+ * 帧在该事件上空口，链路仍在发送时紧接上一帧，因此繁忙的链路按空中时间的速率排空。处理延迟叠加在其后。
+ * 同一链路同一方向的投递时间不会倒退，抖动只会推迟帧，与 BLE 链路一样保持顺序。
+ */
+static esp_err_t loopback_send(loopback_kind_t kind, int link, const uint8_t *data, size_t length) {
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (kind == LOOPBACK_TO_CAMERA) {
+        s_stats.host_frames++;
+        s_stats.host_bytes += length;
+    } else if (kind == LOOPBACK_TO_HOST) {
+        s_stats.camera_frames++;
+    }
+    bool lost = (kind == LOOPBACK_TO_CAMERA || kind == LOOPBACK_TO_HOST) && s_config.loss_per_mille > 0 &&
+                esp_random() % 1000 < s_config.loss_per_mille;
+    if (lost) {
+        s_stats.dropped++;
+    }
+    xSemaphoreGive(s_lock);
+
+    loopback_packet_t packet = {
+        .kind = kind,
+        .link = link,
+        .lost = lost,
+        .length = length,
+    };
+    if (length > 0 && !lost) {
+        packet.data = malloc(length);
+        if (packet.data == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        memcpy(packet.data, data, length);
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    loopback_link_t *l = &s_links[link];
+    int64_t now_us = esp_timer_get_time();
+    packet.generation = l->generation;
+    packet.due_us = now_us + s_config.latency_us;
+    if (kind == LOOPBACK_CONNECT) {
+        packet.due_us += LOOPBACK_DEFAULT_INTERVAL * 1250;
+    } else if (kind != LOOPBACK_DISCONNECT) {
+        int dir = kind == LOOPBACK_TO_HOST;
+        // 链路仍在发送时连接事件继续（More Data），否则等待下一个连接事件
+        // While the link is still sending the connection event goes on (More Data), otherwise wait for the next one
+        int64_t air_start_us = l->air_end_us >= now_us ? l->air_end_us : link_next_event_us(l, kind, now_us);
+        l->air_end_us = air_start_us + link_airtime_us(l, length);
+        packet.due_us = l->air_end_us + s_config.latency_us;
+        if (s_config.jitter_us > 0) {
+            packet.due_us += esp_random() % (s_config.jitter_us + 1);
+        }
+        if (packet.due_us < l->last_due_us[dir]) {
+            packet.due_us = l->last_due_us[dir];
+        }
+        l->last_due_us[dir] = packet.due_us;
+    }
+    bool queued = pending_insert(&packet);
+    xSemaphoreGive(s_lock);
+
+    if (!queued) {
+        ESP_LOGW(TAG, "Link %d: queue full, frame rejected", link);
+        free(packet.data);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static void loopback_timer_callback(void *arg) {
+    xTaskNotifyGive(s_task);
+}
+
+/**
+ * @brief Check the header CRC-16 and the frame CRC-32 of a frame at the start of a buffer
+ * 校验缓冲区开头一帧的帧头 CRC-16 与整帧 CRC-32
+ *
+ * @return size_t Frame length when a whole valid frame is there, 0 while more bytes are needed,
+ *                SIZE_MAX when the buffer does not start with a frame
+ *                缓冲区开头是完整有效的帧时返回帧长，还需要更多字节时返回 0，不是帧开头时返回 SIZE_MAX
+ */
+static size_t frame_check(const uint8_t *data, size_t length) {
+    if (data[0] != 0xAA) {
+        return SIZE_MAX;
+    }
+    if (length < FRAME_HEADER_LENGTH) {
+        return 0;
+    }
+    size_t frame_length = data[1] | ((data[2] & 0x03) << 8);
+    uint16_t crc16 = data[10] | (data[11] << 8);
+    if (frame_length < FRAME_MIN_LENGTH || calculate_crc16(data, 10) != crc16) {
+        return SIZE_MAX;
+    }
+    if (length < frame_length) {
+        return 0;
+    }
+    const uint8_t *tail = &data[frame_length - 4];
+    uint32_t crc32 = tail[0] | (tail[1] << 8) | (tail[2] << 16) | ((uint32_t)tail[3] << 24);
+    return calculate_crc32(data, frame_length - 4) == crc32 ? frame_length : SIZE_MAX;
+}
+
+/**
+ * @brief Rebuild frames from the bytes the host wrote and hand each one to the camera side
+ * 从主机写入的字节中重组帧，并逐帧交给相机端
+ *
+ * Bytes before a valid header are skipped, so a frame cut by a lost write only costs that frame.
+ * 有效帧头之前的字节被跳过，因此写入丢失导致的残帧只影响该帧本身。
+ */
+static void loopback_reassemble(int link, const uint8_t *data, size_t length) {
+    loopback_link_t *l = &s_links[link];
+    uint32_t frames = 0;
+    uint32_t skipped = 0;
+    while (length > 0) {
+        size_t chunk = sizeof(l->rx_buffer) - l->rx_length;
+        if (chunk > length) {
+            chunk = length;
+        }
+        memcpy(&l->rx_buffer[l->rx_length], data, chunk);
+        l->rx_length += chunk;
+        data += chunk;
+        length -= chunk;
+
+        size_t offset = 0;
+        while (offset < l->rx_length) {
+            size_t frame_length = frame_check(&l->rx_buffer[offset], l->rx_length - offset);
+            if (frame_length == 0) {
+                break;
+            }
+            if (frame_length == SIZE_MAX) {
+                offset++;
+                skipped++;
+                continue;
+            }
+            frames++;
+            if (s_peer) {
+                s_peer(link, &l->rx_buffer[offset], frame_length);
+            }
+            offset += frame_length;
+        }
+        l->rx_length -= offset;
+        memmove(l->rx_buffer, &l->rx_buffer[offset], l->rx_length);
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_stats.peer_frames += frames;
+    s_stats.peer_skipped += skipped;
+    xSemaphoreGive(s_lock);
+}
+
+/**
+ * @brief Deliver one packet on the loopback task
+ * 在回环任务中投递一个数据包
+ */
+static void loopback_deliver(const loopback_packet_t *packet) {
+    loopback_link_t *l = &s_links[packet->link];
+    if (packet->generation != l->generation) {
+        return;
+    }
+
+    switch (packet->kind) {
+    case LOOPBACK_CONNECT:
+        if (l->state == LINK_CONNECTING) {
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            l->params = NULL;
+            l->anchor_us = esp_timer_get_time();
+            l->closed_events = 0;
+            l->closed_camera_events = 0;
+            l->extra_events = 0;
+            l->last_extra_event = -1;
+            l->last_due_us[0] = 0;
+            l->last_due_us[1] = 0;
+            l->air_end_us = 0;
+            l->tx_in_flight = 0;
+            l->rx_length = 0;
+            l->state = LINK_UP;
+            xSemaphoreGive(s_lock);
+            ESP_LOGI(TAG, "Link %d connected, MTU=%u", packet->link, s_config.mtu);
+            xEventGroupSetBits(l->events, BLE_EVENT_CONNECTED | BLE_EVENT_HANDLES_READY | BLE_EVENT_TX_READY);
+        }
+        break;
+    case LOOPBACK_TO_CAMERA:
+        // 帧已离开空口，归还额度
+        // The frame is off the air, its credit is free again
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        l->tx_in_flight--;
+        xEventGroupSetBits(l->events, BLE_EVENT_TX_READY);
+        xSemaphoreGive(s_lock);
+        if (!packet->lost && l->state == LINK_UP) {
+            loopback_reassemble(packet->link, packet->data, packet->length);
+        }
+        break;
+    case LOOPBACK_TO_HOST:
+        if (!packet->lost && l->state == LINK_UP && l->notify_enabled && s_notify_cb) {
+            s_notify_cb(packet->link, packet->data, packet->length);
+        }
+        break;
+    case LOOPBACK_DISCONNECT:
+        if (l->state == LINK_DOWN) {
+            break;
+        }
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        link_restart_events(l, esp_timer_get_time());
+        l->state = LINK_DOWN;
+        l->notify_enabled = false;
+        l->generation++;
+        xSemaphoreGive(s_lock);
+        ESP_LOGI(TAG, "Link %d disconnected", packet->link);
+        xEventGroupClearBits(l->events, BLE_EVENT_CONNECTED | BLE_EVENT_HANDLES_READY | BLE_EVENT_NOTIFY_ENABLED |
+                                        BLE_EVENT_TX_READY);
+        xEventGroupSetBits(l->events, BLE_EVENT_DISCONNECTED);
+        if (s_state_cb) {
+            s_state_cb(packet->link);
+        }
+        break;
+    }
+}
+
+/**
+ * @brief Loopback task, holds every packet until it is due
+ * 回环任务，每个数据包到期后才投递
+ */
+static void loopback_task(void *arg) {
+    loopback_packet_t packet;
+    while (1) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        int64_t wait_us = s_pending_count > 0 ? s_pending[0].due_us - esp_timer_get_time() : -1;
+        if (s_pending_count == 0 || wait_us > 0) {
+            xSemaphoreGive(s_lock);
+            // 延迟通常短于一个系统节拍，使用单次定时器唤醒；新的更早的包也会唤醒任务
+            // The wait is usually below one tick, so wake up with a one-shot timer; an earlier new packet also wakes the task
+            if (wait_us > 0) {
+                esp_timer_stop(s_timer);
+                esp_timer_start_once(s_timer, (uint64_t)wait_us);
+            }
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        packet = s_pending[0];
+        s_pending_count--;
+        memmove(&s_pending[0], &s_pending[1], s_pending_count * sizeof(s_pending[0]));
+        xSemaphoreGive(s_lock);
+
+        loopback_deliver(&packet);
+        free(packet.data);
+    }
+}
+
+/* -------------------------
+ *  Transport operations
+ *  传输层操作
+ * ------------------------- */
+
+static esp_err_t loopback_init(void) {
+    if (s_task != NULL) {
+        return ESP_OK;
+    }
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        ESP_LOGE(TAG, "Failed to create lock");
+        return ESP_ERR_NO_MEM;
+    }
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        s_links[link].events = xEventGroupCreate();
+        if (s_links[link].events == NULL) {
+            ESP_LOGE(TAG, "Failed to create link events");
+            return ESP_ERR_NO_MEM;
+        }
+        s_links[link].state = LINK_DOWN;
+    }
+    esp_timer_create_args_t timer_args = {
+        .callback = loopback_timer_callback,
+        .name = "ble_loopback",
+    };
+    if (esp_timer_create(&timer_args, &s_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create timer");
+        return ESP_FAIL;
+    }
+    esp_timer_create_args_t approval_args = {
+        .callback = approval_timer_callback,
+        .name = "ble_loopback_pair",
+    };
+    if (esp_timer_create(&approval_args, &s_approval_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create approval timer");
+        return ESP_FAIL;
+    }
+    if (xTaskCreate(loopback_task, "ble_loopback", 1024 * 3, NULL, LOOPBACK_TASK_PRIORITY, &s_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create task");
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "Loopback ready: latency %lu us, jitter %lu us, loss %u/1000, MTU %u",
+             (unsigned long)s_config.latency_us, (unsigned long)s_config.jitter_us, s_config.loss_per_mille, s_config.mtu);
+    return ESP_OK;
+}
+
+/**
+ * @brief Connect a link, there is always a camera so reconnecting is the same as connecting
+ * 连接链路，相机始终存在，因此重连与连接相同
+ */
+static esp_err_t loopback_open(int link, bool reconnect) {
+    if (!is_link_valid(link)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_links[link].state != LINK_DOWN) {
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_links[link].state = LINK_CONNECTING;
+    s_links[link].generation++;
+    xSemaphoreGive(s_lock);
+    return loopback_send(LOOPBACK_CONNECT, link, NULL, 0);
+}
+
+static esp_err_t loopback_enable_notify(int link) {
+    if (!is_link_valid(link) || s_links[link].state != LINK_UP) {
+        return ESP_FAIL;
+    }
+    s_links[link].notify_enabled = true;
+    xEventGroupSetBits(s_links[link].events, BLE_EVENT_NOTIFY_ENABLED);
+    return ESP_OK;
+}
+
+static esp_err_t loopback_close(int link) {
+    if (!is_link_valid(link)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_links[link].state == LINK_DOWN) {
+        return ESP_OK;
+    }
+    return loopback_send(LOOPBACK_DISCONNECT, link, NULL, 0);
+}
+
+static void loopback_forget(int link) {
+}
+
+static esp_err_t loopback_write(int link, const uint8_t *data, size_t length, bool with_response) {
+    if (!is_link_valid(link) || s_links[link].state != LINK_UP) {
+        ESP_LOGW(TAG, "Link %d not connected, skip write", link);
+        return ESP_FAIL;
+    }
+    if (length + BLE_ATT_HEADER_LENGTH > s_config.mtu) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // 与蓝牙传输层一样，每次写入占用一个额度，直到帧离开空口
+    // Like the Bluetooth transport, every write holds a credit until the frame is off the air
+    loopback_link_t *l = &s_links[link];
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (l->tx_in_flight >= BLE_TX_CREDITS) {
+        s_stats.refused++;
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    if (++l->tx_in_flight == BLE_TX_CREDITS) {
+        xEventGroupClearBits(l->events, BLE_EVENT_TX_READY);
+    }
+    xSemaphoreGive(s_lock);
+
+    esp_err_t ret = loopback_send(LOOPBACK_TO_CAMERA, link, data, length);
+    if (ret != ESP_OK) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        l->tx_in_flight--;
+        xEventGroupSetBits(l->events, BLE_EVENT_TX_READY);
+        xSemaphoreGive(s_lock);
+    }
+    return ret;
+}
+
+/**
+ * @brief Switch connection parameters, applied at once instead of at an update instant a few events later
+ * 切换连接参数，立即生效，而不是在几个事件之后的更新时刻
+ */
+static esp_err_t loopback_set_link_profile(int link, ble_link_profile_t profile) {
+    const ble_link_params_t *params = ble_transport_get_link_params(profile);
+    if (!is_link_valid(link) || params == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_links[link].state != LINK_UP) {
+        return ESP_FAIL;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    loopback_link_t *l = &s_links[link];
+    if (l->params != params) {
+        link_restart_events(l, esp_timer_get_time());
+        l->params = params;
+    }
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+static uint16_t loopback_get_mtu(int link) {
+    return is_link_valid(link) && s_links[link].state == LINK_UP ? s_config.mtu : 0;
+}
+
+/**
+ * @brief Address of the built-in camera of a link, one fixed camera per link
+ * 链路内置相机的地址，每条链路固定一台相机
+ */
+static esp_err_t loopback_get_peer_addr(int link, uint8_t addr[6]) {
+    if (!is_link_valid(link)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    const uint8_t camera_addr[6] = {0x60, 0x60, 0x1F, 0x00, 0x00, (uint8_t)link};
+    memcpy(addr, camera_addr, sizeof(camera_addr));
+    return ESP_OK;
+}
+
+static EventBits_t loopback_wait_events(int link, EventBits_t bits, TickType_t timeout) {
+    if (!is_link_valid(link)) {
+        return 0;
+    }
+    return xEventGroupWaitBits(s_links[link].events, bits, pdFALSE, pdFALSE, timeout);
+}
+
+static void loopback_clear_events(int link, EventBits_t bits) {
+    if (is_link_valid(link)) {
+        xEventGroupClearBits(s_links[link].events, bits);
+    }
+}
+
+static void loopback_set_notify_callback(ble_notify_callback_t cb) {
+    s_notify_cb = cb;
+}
+
+static void loopback_set_state_callback(connect_logic_state_callback_t cb) {
+    s_state_cb = cb;
+}
+
+const ble_transport_t ble_loopback_transport = {
+    .name = "loopback",
+    .init = loopback_init,
+    .open = loopback_open,
+    .enable_notify = loopback_enable_notify,
+    .close = loopback_close,
+    .forget = loopback_forget,
+    .write = loopback_write,
+    .get_mtu = loopback_get_mtu,
+    .get_peer_addr = loopback_get_peer_addr,
+    .wait_events = loopback_wait_events,
+    .clear_events = loopback_clear_events,
+    .set_notify_callback = loopback_set_notify_callback,
+    .set_state_callback = loopback_set_state_callback,
+    .set_link_profile = loopback_set_link_profile,
+};
+
+/* -------------------------
+ *  Test interface
+ *  测试接口
+ * ------------------------- */
+
+/**
+ * @brief Set latency, loss and MTU, frames already queued keep their delivery time
+ * 设置延迟、丢包率与 MTU，已在队列中的帧保持原投递时间
+ *
+ * @param config Link behaviour
+ *               链路行为参数
+ */
+void ble_loopback_set_config(const ble_loopback_config_t *config) {
+    if (config != NULL && config->mtu > BLE_ATT_HEADER_LENGTH) {
+        s_config = *config;
+    }
+}
+
+/**
+ * @brief Replace the camera side, NULL discards every written frame
+ * 替换相机端，传入 NULL 时丢弃所有写入的帧
+ *
+ * @param peer Called on the loopback task for each frame the host writes
+ *             主机每写入一帧，在回环任务中调用一次
+ */
+void ble_loopback_set_peer(ble_loopback_peer_t peer) {
+    s_peer = peer;
+}
+
+/**
+ * @brief Send a notification from the camera side to the host
+ * 从相机端向主机发送一条通知
+ *
+ * @param link   Link to notify on
+ *               发送通知的链路
+ * @param data   Notification data
+ *               通知数据
+ * @param length Notification length
+ *               通知长度
+ * @return esp_err_t ESP_OK when queued (or lost), error when the link is down or the data exceeds the MTU
+ *                   已入队（或被丢弃）返回 ESP_OK，链路未连接或超过 MTU 时返回错误
+ */
+esp_err_t ble_loopback_notify(int link, const uint8_t *data, size_t length) {
+    if (!is_link_valid(link) || s_links[link].state != LINK_UP || data == NULL || length == 0) {
+        return ESP_FAIL;
+    }
+    if (length + BLE_ATT_HEADER_LENGTH > s_config.mtu) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return loopback_send(LOOPBACK_TO_HOST, link, data, length);
+}
+
+/**
+ * @brief Simulate a lost link, the disconnect callback follows after the latency
+ * 模拟链路丢失，断连回调在延迟之后触发
+ *
+ * @param link Link to drop
+ *             要断开的链路
+ */
+esp_err_t ble_loopback_drop_link(int link) {
+    return loopback_close(link);
+}
+
+/**
+ * @brief Get the loopback counters
+ * 获取回环计数
+ */
+void ble_loopback_get_stats(ble_loopback_stats_t *stats) {
+    if (stats != NULL && s_lock != NULL) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        *stats = s_stats;
+        xSemaphoreGive(s_lock);
+    }
+}
+
+/**
+ * @brief Get the connection events of a link since it connected, the power proxy of its parameters
+ * 获取链路自连接以来的连接事件数，作为其参数的功耗指标
+ *
+ * @param link  Link to read
+ *              要读取的链路
+ * @param stats Filled with the event counts
+ *              填入事件计数
+ */
+void ble_loopback_get_link_stats(int link, ble_loopback_link_stats_t *stats) {
+    if (!is_link_valid(link) || stats == NULL || s_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    loopback_link_t *l = &s_links[link];
+    int64_t events = 0;
+    int64_t camera_events = 0;
+    if (l->state == LINK_UP) {
+        int64_t now_us = esp_timer_get_time();
+        events = (now_us - l->anchor_us) / link_interval_us(l);
+        camera_events = events / (link_latency(l) + 1);
+    }
+    stats->interval_us = link_interval_us(l);
+    stats->latency = link_latency(l);
+    stats->host_events = l->closed_events + events;
+    stats->camera_events = l->closed_camera_events + camera_events + l->extra_events;
+    xSemaphoreGive(s_lock);
+}
+
+/* -------------------------
+ *  Built-in camera
+ *  内置相机
+ * ------------------------- */
+
+/**
+ * @brief Build a protocol frame and notify it from the camera side
+ * 构建协议帧并从相机端发出通知
+ */
+static esp_err_t camera_send(int link, uint8_t cmd_type, uint16_t seq, uint8_t cmd_set, uint8_t cmd_id,
+                             const void *payload, size_t payload_length) {
+    uint8_t frame[FRAME_MIN_LENGTH + CAMERA_MAX_PAYLOAD_LENGTH];
+    size_t length = FRAME_MIN_LENGTH + payload_length;
+    if (payload_length > CAMERA_MAX_PAYLOAD_LENGTH) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    size_t offset = 0;
+    frame[offset++] = 0xAA;
+    frame[offset++] = length & 0xFF;
+    frame[offset++] = (length >> 8) & 0x03;
+    frame[offset++] = cmd_type;
+    memset(&frame[offset], 0, 4);  // ENC and RES
+    offset += 4;
+    frame[offset++] = (seq >> 8) & 0xFF;
+    frame[offset++] = seq & 0xFF;
+    uint16_t crc16 = calculate_crc16(frame, offset);
+    frame[offset++] = crc16 & 0xFF;
+    frame[offset++] = (crc16 >> 8) & 0xFF;
+    frame[offset++] = cmd_set;
+    frame[offset++] = cmd_id;
+    memcpy(&frame[offset], payload, payload_length);
+    offset += payload_length;
+    uint32_t crc32 = calculate_crc32(frame, offset);
+    frame[offset++] = crc32 & 0xFF;
+    frame[offset++] = (crc32 >> 8) & 0xFF;
+    frame[offset++] = (crc32 >> 16) & 0xFF;
+    frame[offset++] = (crc32 >> 24) & 0xFF;
+
+    return ble_loopback_notify(link, frame, offset);
+}
+
+/**
+ * @brief Send the verification result of a connection request, verify_data 0 accepts the remote
+ * 发送连接请求的验证结果，verify_data 为 0 表示接受遥控器
+ */
+static void camera_send_verify_result(int link, uint32_t device_id) {
+    connection_request_command_frame command = {
+        .device_id = device_id,
+        .verify_mode = 2,
+        .verify_data = 0,
+    };
+    camera_send(link, FRAME_CMD_WAIT_RESULT, ++s_camera_seq, 0x00, 0x19, &command, sizeof(command));
+}
+
+/**
+ * @brief The user confirmed a first pairing on the camera
+ * 用户在相机上确认了首次配对
+ */
+static void approval_timer_callback(void *arg) {
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        if (s_pairing[link].approval_pending) {
+            s_pairing[link].approval_pending = false;
+            camera_send_verify_result(link, s_pairing[link].pending_device_id);
+        }
+    }
+}
+
+/**
+ * @brief Handle a connection request like a camera that supports both verify modes
+ * 像支持两种验证模式的相机一样处理连接请求
+ *
+ * A first pairing is accepted after approval_ms, the time the user takes to confirm on the camera.
+ * A reconnection is accepted at once when the remote paired with this camera before, otherwise
+ * it is rejected with ret_code 1.
+ * 首次配对在 approval_ms（用户在相机上确认所需时间）之后接受。重连时，若遥控器之前与该相机
+ * 配对过则立即接受，否则以 ret_code 1 拒绝。
+ */
+static void camera_connection_request(int link, uint16_t seq, const connection_request_command_frame *request) {
+    camera_pairing_t *pairing = &s_pairing[link];
+    bool reconnect = request->verify_mode == 1;
+    connection_request_response_frame response = {
+        .device_id = request->device_id,
+        .ret_code = 0,
+    };
+    if (reconnect && (!pairing->paired || pairing->device_id != request->device_id)) {
+        ESP_LOGW(TAG, "Link %d: reconnection from unpaired device 0x%08lX rejected", link,
+                 (unsigned long)request->device_id);
+        response.ret_code = 1;
+        camera_send(link, FRAME_ACK_NO_RESPONSE, seq, 0x00, 0x19, &response, sizeof(response));
+        return;
+    }
+    camera_send(link, FRAME_ACK_NO_RESPONSE, seq, 0x00, 0x19, &response, sizeof(response));
+
+    if (reconnect || s_config.approval_ms == 0) {
+        camera_send_verify_result(link, request->device_id);
+        return;
+    }
+    pairing->pending_device_id = request->device_id;
+    pairing->approval_pending = true;
+    esp_timer_stop(s_approval_timer);
+    esp_timer_start_once(s_approval_timer, (uint64_t)s_config.approval_ms * 1000);
+}
+
+/**
+ * @brief Default camera side: handles the connection request and acknowledges every command that asks for a response
+ * 默认相机端：处理连接请求，并应答每个需要响应的命令
+ *
+ * The ACK payload is ret_code 0 followed by zeros. GPS pushes and other frames without a response are only counted.
+ * The remote's response to the verification result completes the pairing.
+ * 应答负载为 ret_code 0 加全零。GPS 推送等无需响应的帧只计数。遥控器对验证结果的应答完成配对。
+ */
+void ble_loopback_camera_peer(int link, const uint8_t *data, size_t length) {
+    if (length < FRAME_MIN_LENGTH || data[0] != 0xAA) {
+        return;
+    }
+    uint8_t cmd_type = data[3];
+    uint16_t seq = (data[8] << 8) | data[9];
+    uint8_t cmd_set = data[FRAME_HEADER_LENGTH];
+    uint8_t cmd_id = data[FRAME_HEADER_LENGTH + 1];
+    const uint8_t *payload = &data[FRAME_HEADER_LENGTH + 2];
+    size_t payload_length = length - FRAME_MIN_LENGTH;
+
+    // 遥控器对验证结果的应答，配对完成
+    // The remote answered the verification result, the pairing is complete
+    if ((cmd_type & 0x20) && cmd_set == 0x00 && cmd_id == 0x19 && payload_length >= sizeof(connection_request_response_frame)) {
+        connection_request_response_frame response;
+        memcpy(&response, payload, sizeof(response));
+        if (response.ret_code == 0) {
+            s_pairing[link].paired = true;
+            s_pairing[link].device_id = response.device_id;
+        }
+        return;
+    }
+
+    // 应答帧以及无需响应的命令
+    // Responses and commands that need none
+    if ((cmd_type & 0x20) || (cmd_type & 0x03) == 0) {
+        return;
+    }
+
+    if (cmd_set == 0x00 && cmd_id == 0x19 && payload_length >= sizeof(connection_request_command_frame)) {
+        connection_request_command_frame request;
+        memcpy(&request, payload, sizeof(request));
+        camera_connection_request(link, seq, &request);
+        return;
+    }
+
+    uint8_t ack[CAMERA_ACK_PAYLOAD_LENGTH] = {0};
+    camera_send(link, FRAME_ACK_NO_RESPONSE, seq, cmd_set, cmd_id, ack, sizeof(ack));
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __BLE_LOOPBACK_H__
+#define __BLE_LOOPBACK_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ble_transport.h"
+
+/* Link behaviour of the loopback, applies to both directions */
+/* 回环链路的行为参数，对两个方向都生效 */
+typedef struct {
+    uint32_t latency_us;      // Processing delay of every frame, on top of the connection event it waits for
+    uint32_t jitter_us;       // Extra random delay up to this value, order is kept
+    uint16_t loss_per_mille;  // Frames dropped per 1000
+    uint16_t mtu;             // ATT MTU reported for every link
+    uint32_t approval_ms;     // Time the user takes to confirm a first pairing on the built-in camera
+} ble_loopback_config_t;
+
+/* Counters of the loopback, see ble_loopback_get_stats() */
+/* 回环的计数，见 ble_loopback_get_stats() */
+typedef struct {
+    uint32_t host_frames;     // Writes by the host, a frame may take several or share one
+    uint32_t host_bytes;      // Bytes written by the host
+    uint32_t peer_frames;     // Whole frames the camera side rebuilt from the writes
+    uint32_t peer_skipped;    // Bytes the camera side skipped to find the next frame header
+    uint32_t camera_frames;   // Notifications sent by the camera side
+    uint32_t dropped;         // Frames lost on the way
+    uint32_t refused;         // Host writes refused for lack of a credit
+} ble_loopback_stats_t;
+
+/* Connection events of one link, see ble_loopback_get_link_stats() */
+/* 单条链路的连接事件数，见 ble_loopback_get_link_stats() */
+typedef struct {
+    uint32_t interval_us;     // Connection interval in use
+    uint16_t latency;         // Peripheral latency in use
+    uint32_t host_events;     // Connection events the host attended
+    uint32_t camera_events;   // Connection events the camera attended, including wake-ups to send
+} ble_loopback_link_stats_t;
+
+/**
+ * @brief Camera side of the loopback, receives every frame the host writes
+ * 回环的相机端，接收主机写入的每一帧
+ *
+ * Frames are rebuilt from the written bytes by their header, so a frame split over several writes
+ * or several frames in one write arrive as single frames.
+ * 按帧头从写入的字节中重组帧，因此拆分为多次写入的帧或一次写入中的多帧都逐帧到达。
+ *
+ * @param link   Link the frame was written to
+ *               帧所在的链路
+ * @param data   Frame data, only valid during the call
+ *               帧数据，仅在调用期间有效
+ * @param length Frame length
+ *               帧长度
+ */
+typedef void (*ble_loopback_peer_t)(int link, const uint8_t *data, size_t length);
+
+void ble_loopback_set_config(const ble_loopback_config_t *config);
+
+void ble_loopback_set_peer(ble_loopback_peer_t peer);
+
+esp_err_t ble_loopback_notify(int link, const uint8_t *data, size_t length);
+
+esp_err_t ble_loopback_drop_link(int link);
+
+void ble_loopback_get_stats(ble_loopback_stats_t *stats);
+
+void ble_loopback_get_link_stats(int link, ble_loopback_link_stats_t *stats);
+
+void ble_loopback_camera_peer(int link, const uint8_t *data, size_t length);
+
+/* Loopback implementation of the camera link transport */
+/* 相机链路传输层的回环实现 */
+extern const ble_transport_t ble_loopback_transport;
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "ble_transport.h"
+#if CONFIG_BLE_TRANSPORT_LOOPBACK
+#include "ble_loopback.h"
+#else
+#include "ble.h"
+#endif
+
+#define TAG "BLE_TRANSPORT"
+
+/* Link parameters of each profile
+ * Low latency: 7.5-15 ms interval, every event attended, full length LL packets on 2M
+ * Low power: 100-125 ms interval, the camera may sleep through 2 events, supervision timeout above
+ * 2 * (1 + latency) * max interval */
+/* 各配置的链路参数
+ * 低延迟：7.5-15 ms 连接间隔，不跳过连接事件，2M 上使用满长 LL 包
+ * 低功耗：100-125 ms 连接间隔，相机可休眠 2 个事件，监督超时大于 2 * (1 + latency) * 最大间隔 */
+static const ble_link_params_t s_link_params[BLE_LINK_PROFILE_COUNT] = {
+    [BLE_LINK_PROFILE_LOW_LATENCY] = {"low-latency", 6, 12, 0, 400, 251, true},
+    [BLE_LINK_PROFILE_LOW_POWER]   = {"low-power", 80, 100, 2, 600, 251, false},
+};
+
+/* Transport in use, selected by CONFIG_BLE_TRANSPORT_LOOPBACK unless replaced before init */
+/* 当前使用的传输层，由 CONFIG_BLE_TRANSPORT_LOOPBACK 选择，也可在初始化前替换 */
+#if CONFIG_BLE_TRANSPORT_LOOPBACK
+static const ble_transport_t *s_transport = &ble_loopback_transport;
+#else
+static const ble_transport_t *s_transport = &ble_bluedroid_transport;
+#endif
+
+/**
+ * @brief Replace the transport, call before ble_transport_init()
+ * 替换传输层，需在 ble_transport_init() 之前调用
+ *
+ * @param transport Transport to use
+ *                  要使用的传输层
+ */
+void ble_transport_set(const ble_transport_t *transport) {
+    if (transport != NULL) {
+        s_transport = transport;
+    }
+}
+
+/**
+ * @brief Get the transport in use
+ * 获取当前使用的传输层
+ */
+const ble_transport_t *ble_transport_get(void) {
+    return s_transport;
+}
+
+esp_err_t ble_transport_init(void) {
+    ESP_LOGI(TAG, "Using %s transport", s_transport->name);
+    return s_transport->init();
+}
+
+esp_err_t ble_transport_open(int link, bool reconnect) {
+    return s_transport->open(link, reconnect);
+}
+
+esp_err_t ble_transport_enable_notify(int link) {
+    return s_transport->enable_notify(link);
+}
+
+esp_err_t ble_transport_close(int link) {
+    return s_transport->close(link);
+}
+
+void ble_transport_forget(int link) {
+    s_transport->forget(link);
+}
+
+esp_err_t ble_transport_write(int link, const uint8_t *data, size_t length, bool with_response) {
+    return s_transport->write(link, data, length, with_response);
+}
+
+uint16_t ble_transport_get_mtu(int link) {
+    return s_transport->get_mtu(link);
+}
+
+esp_err_t ble_transport_get_peer_addr(int link, uint8_t addr[6]) {
+    return s_transport->get_peer_addr(link, addr);
+}
+
+EventBits_t ble_transport_wait_events(int link, EventBits_t bits, TickType_t timeout) {
+    return s_transport->wait_events(link, bits, timeout);
+}
+
+void ble_transport_clear_events(int link, EventBits_t bits) {
+    s_transport->clear_events(link, bits);
+}
+
+void ble_transport_set_notify_callback(ble_notify_callback_t cb) {
+    s_transport->set_notify_callback(cb);
+}
+
+void ble_transport_set_state_callback(connect_logic_state_callback_t cb) {
+    s_transport->set_state_callback(cb);
+}
+
+esp_err_t ble_transport_set_link_profile(int link, ble_link_profile_t profile) {
+    if (profile >= BLE_LINK_PROFILE_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return s_transport->set_link_profile(link, profile);
+}
+
+/**
+ * @brief Get the link parameters of a profile
+ * 获取配置对应的链路参数
+ *
+ * @param profile Link profile
+ *                链路配置
+ * @return const ble_link_params_t* Parameters, NULL for an unknown profile
+ *                                  链路参数，未知配置返回 NULL
+ */
+const ble_link_params_t *ble_transport_get_link_params(ble_link_profile_t profile) {
+    return profile < BLE_LINK_PROFILE_COUNT ? &s_link_params[profile] : NULL;
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __BLE_TRANSPORT_H__
+#define __BLE_TRANSPORT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "esp_err.h"
+
+/* Number of cameras that can be connected at the same time, one link each */
+/* 可同时连接的相机数量，每台相机一条链路 */
+#define BLE_MAX_LINKS 4
+
+/* Link events set by the transport, see ble_transport_wait_events() */
+/* 由传输层置位的链路事件，见 ble_transport_wait_events() */
+#define BLE_EVENT_CONNECTED       (1 << 0)  // Link up, cleared on disconnect
+#define BLE_EVENT_HANDLES_READY   (1 << 1)  // Notify and write handles known, cleared on disconnect
+#define BLE_EVENT_NOTIFY_ENABLED  (1 << 2)  // Notification enabled on the camera, cleared on disconnect
+#define BLE_EVENT_DISCONNECTED    (1 << 3)  // Link lost, cleared by ble_transport_clear_events()
+#define BLE_EVENT_SCAN_FAILED     (1 << 4)  // Scan ended without a connect attempt, cleared by ble_transport_clear_events()
+#define BLE_EVENT_OPEN_FAILED     (1 << 5)  // Connect attempt failed, cleared by ble_transport_clear_events()
+#define BLE_EVENT_GATT_FAILED     (1 << 6)  // Discovery or notification enable failed, cleared by ble_transport_clear_events()
+#define BLE_EVENT_TX_READY        (1 << 7)  // A write credit is free, cleared while the link is congested or down
+
+/* Writes in flight per link, each holds a credit until the stack reports it sent */
+/* 每条链路同时在途的写入数，每次写入占用一个额度，直到协议栈报告已发送 */
+#define BLE_TX_CREDITS 8
+
+/* ATT header of a write or notification, the payload is at most MTU - 3 bytes */
+/* 写或通知的 ATT 头长度，负载最多为 MTU - 3 字节 */
+#define BLE_ATT_HEADER_LENGTH 3
+
+/* Link tuning profiles, switched at runtime by the connection logic */
+/* 链路调优配置，由连接逻辑在运行时切换 */
+typedef enum {
+    BLE_LINK_PROFILE_LOW_LATENCY = 0,  // Commands, recording and GPS pushing: short interval, no latency, 2M PHY
+    BLE_LINK_PROFILE_LOW_POWER,        // Idle: long interval, the camera may skip connection events
+    BLE_LINK_PROFILE_COUNT,
+} ble_link_profile_t;
+
+/* Link parameters of a profile */
+/* 配置对应的链路参数 */
+typedef struct {
+    const char *name;
+    uint16_t min_interval;  // Connection interval, 1.25 ms units
+    uint16_t max_interval;
+    uint16_t latency;       // Peripheral latency, connection events the camera may skip
+    uint16_t timeout;       // Supervision timeout, 10 ms units
+    uint16_t tx_octets;     // LL payload per packet, 27 without data length extension
+    bool phy_2m;            // Prefer the LE 2M PHY (needs BLE 5.0 features)
+} ble_link_params_t;
+
+/**
+ * @brief Notify callback function type for receiving data from remote
+ * Notify 回调函数类型，用于接收从远端发来的数据
+ *
+ * @param link   Link the notification arrived on
+ *               通知所在的链路
+ * @param data   Pointer to the notification data
+ *               通知的数据指针
+ * @param length Length of the notification data
+ *               通知的数据长度
+ */
+typedef void (*ble_notify_callback_t)(int link, const uint8_t *data, size_t length);
+
+/**
+ * @brief Disconnect callback function type, called once per lost or closed link
+ * 断连回调函数类型，每条链路断开或关闭时调用一次
+ *
+ * @param link Link that went down
+ *             断开的链路
+ */
+typedef void (*connect_logic_state_callback_t)(int link);
+
+/**
+ * @brief Operations of a camera link transport
+ * 相机链路传输层的操作集
+ *
+ * Everything above the transport (data, protocol, command and connect logic) only uses these,
+ * so the radio can be replaced, e.g. by the loopback in ble_loopback.h.
+ * 传输层之上的各层（data、protocol、command 与连接逻辑）只使用这些接口，
+ * 因此可以替换掉射频部分，例如使用 ble_loopback.h 中的回环实现。
+ */
+typedef struct {
+    const char *name;                                                  // Name for the logs
+    esp_err_t (*init)(void);                                           // Bring the transport up
+    esp_err_t (*open)(int link, bool reconnect);                       // Start connecting, progress is reported by link events
+    esp_err_t (*enable_notify)(int link);                              // Enable notifications once BLE_EVENT_HANDLES_READY is set
+    esp_err_t (*close)(int link);                                      // Close the link, the disconnect callback follows
+    void (*forget)(int link);                                          // Forget the camera of the link
+    esp_err_t (*write)(int link, const uint8_t *data, size_t length, bool with_response);  // Write one frame, ESP_ERR_NO_MEM without a credit
+    uint16_t (*get_mtu)(int link);                                     // ATT MTU of the link, 0 when down
+    esp_err_t (*get_peer_addr)(int link, uint8_t addr[6]);             // Address of the camera of the link, ESP_ERR_NOT_FOUND before the first connect
+    EventBits_t (*wait_events)(int link, EventBits_t bits, TickType_t timeout);  // Wait for any of the link events
+    void (*clear_events)(int link, EventBits_t bits);                  // Clear link events
+    void (*set_notify_callback)(ble_notify_callback_t cb);             // Receive notifications
+    void (*set_state_callback)(connect_logic_state_callback_t cb);     // Receive disconnect events
+    esp_err_t (*set_link_profile)(int link, ble_link_profile_t profile);  // Request interval, latency, data length and PHY
+} ble_transport_t;
+
+void ble_transport_set(const ble_transport_t *transport);
+
+const ble_transport_t *ble_transport_get(void);
+
+esp_err_t ble_transport_init(void);
+
+esp_err_t ble_transport_open(int link, bool reconnect);
+
+esp_err_t ble_transport_enable_notify(int link);
+
+esp_err_t ble_transport_close(int link);
+
+void ble_transport_forget(int link);
+
+esp_err_t ble_transport_write(int link, const uint8_t *data, size_t length, bool with_response);
+
+uint16_t ble_transport_get_mtu(int link);
+
+esp_err_t ble_transport_get_peer_addr(int link, uint8_t addr[6]);
+
+EventBits_t ble_transport_wait_events(int link, EventBits_t bits, TickType_t timeout);
+
+void ble_transport_clear_events(int link, EventBits_t bits);
+
+void ble_transport_set_notify_callback(ble_notify_callback_t cb);
+
+void ble_transport_set_state_callback(connect_logic_state_callback_t cb);
+
+esp_err_t ble_transport_set_link_profile(int link, ble_link_profile_t profile);
+
+const ble_link_params_t *ble_transport_get_link_params(ble_link_profile_t profile);
+
+#endif
@@ -26,13 +26,13 @@
 #include "esp_log.h"
 
 #include "data.h"
-#include "ble.h"
+#include "ble_transport.h"
 #include "dji_protocol_parser.h"
 
 #define TAG "DATA"
 
-/* 最大并行等待的命令数量 */
-/* Maximum number of commands that can be waited in parallel */
+/* 每条链路最大并行等待的命令数量 */
+/* Maximum number of commands that can be waited in parallel on each link */
 #define MAX_SEQ_ENTRIES 10
 
 /* 定时删除的周期（单位：毫秒） */
@@ -43,6 +43,18 @@
 /* Maximum retention time in seconds, entries unused beyond this time will be cleared */
 #define MAX_ENTRY_AGE 120
 
+/* 命令等待写入额度的最长时间（毫秒），突发推送不会挤掉命令 */
+/* Longest wait of a command for a write credit (milliseconds), a push burst does not crowd it out */
+#define TX_CREDIT_WAIT_MS 200
+
+/* 协议帧长度字段为 10 位，一帧最长 1023 字节 */
+/* The frame length field has 10 bits, so a frame is at most 1023 bytes */
+#define MAX_FRAME_LENGTH 1023
+
+/* 合并写入缓冲区长度，不小于本地 MTU 500 对应的 ATT 负载 */
+/* Size of the coalescing buffer, at least the ATT payload of the local MTU of 500 */
+#define COALESCE_BUFFER_LENGTH 512
+
 static bool data_layer_initialized = false;
 
 /* 条目结构 */
@@ -85,9 +97,9 @@ typedef struct {
     TickType_t last_access_time;
 } entry_t;
 
-/* 维护 seq 到解析结果的映射 */
-/* Maintains mapping from seq to parsed results */
-static entry_t s_entries[MAX_SEQ_ENTRIES];
+/* 维护 seq 到解析结果的映射，每条链路一张表，各相机的 seq 互不干扰 */
+/* Maintains mapping from seq to parsed results, one table per link so camera seqs never collide */
+static entry_t s_entries[BLE_MAX_LINKS][MAX_SEQ_ENTRIES];
 
 /* 互斥锁，保护 s_seq_entries */
 /* Mutex to protect s_seq_entries */
@@ -97,26 +109,45 @@ static SemaphoreHandle_t s_map_mutex = NULL;
 /* Timer handle */
 static TimerHandle_t cleanup_timer = NULL;
 
+/* 每条链路的写入活动，供连接逻辑选择链路档位 */
+/* Write activity of each link, used by the connect logic to pick the link profile */
+static data_link_activity_t s_activity[BLE_MAX_LINKS];
+
+/* 每条链路的发送互斥锁，一帧的各段不会与其他帧交错 */
+/* TX mutex of each link, the pieces of one frame are never interleaved with another frame */
+static SemaphoreHandle_t s_tx_mutex[BLE_MAX_LINKS];
+
+/* 每条链路的相机是否接受一次写入多帧 */
+/* Whether the camera of each link takes several frames in one write */
+static bool s_coalesce[BLE_MAX_LINKS];
+
+/* 每条链路的合并缓冲区，持有发送互斥锁时使用 */
+/* Coalescing buffer of each link, used with the TX mutex held */
+static uint8_t s_tx_buffer[BLE_MAX_LINKS][COALESCE_BUFFER_LENGTH];
+
 /**
  * @brief Initialize seq_entries and mark all entries as unused
  *        初始化 seq_entries，将所有条目标记为未使用
  */
 static void reset_entries(void) {
-    for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
-        s_entries[i].in_use = false;
-        s_entries[i].is_seq_based = false;
-        s_entries[i].seq = 0;
-        s_entries[i].cmd_set = 0;
-        s_entries[i].cmd_id = 0;
-        s_entries[i].last_access_time = 0;
-        if (s_entries[i].parse_result) {
-            free(s_entries[i].parse_result);
-            s_entries[i].parse_result = NULL;
-        }
-        s_entries[i].parse_result_length = 0;
-        if (s_entries[i].sem) {
-            vSemaphoreDelete(s_entries[i].sem);
-            s_entries[i].sem = NULL;
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
+            entry_t *entry = &s_entries[link][i];
+            entry->in_use = false;
+            entry->is_seq_based = false;
+            entry->seq = 0;
+            entry->cmd_set = 0;
+            entry->cmd_id = 0;
+            entry->last_access_time = 0;
+            if (entry->parse_result) {
+                free(entry->parse_result);
+                entry->parse_result = NULL;
+            }
+            entry->parse_result_length = 0;
+            if (entry->sem) {
+                vSemaphoreDelete(entry->sem);
+                entry->sem = NULL;
+            }
         }
     }
 }
@@ -125,16 +156,19 @@ static void reset_entries(void) {
  * @brief Find entry by sequence number
  *        查找指定 seq 的条目
  * 
+ * @param link Link of the camera
+ *             相机所在链路
  * @param seq Sequence number to find
  *            需要查找的 seq 值
  * @return entry_t* Pointer to found entry, NULL if not found
  *                  找到的条目指针，未找到则返回 NULL
  */
-static entry_t* find_entry_by_seq(uint16_t seq) {
+static entry_t* find_entry_by_seq(int link, uint16_t seq) {
+    entry_t *entries = s_entries[link];
     for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
-        if (s_entries[i].in_use && s_entries[i].is_seq_based && s_entries[i].seq == seq) {
-            s_entries[i].last_access_time = xTaskGetTickCount();
-            return &s_entries[i];
+        if (entries[i].in_use && entries[i].is_seq_based && entries[i].seq == seq) {
+            entries[i].last_access_time = xTaskGetTickCount();
+            return &entries[i];
         }
     }
     return NULL;
@@ -144,6 +178,8 @@ static entry_t* find_entry_by_seq(uint16_t seq) {
  * @brief Find entry by command set and ID
  *        查找指定 cmd_set 和 cmd_id 的条目
  * 
+ * @param link Link of the camera
+ *             相机所在链路
  * @param cmd_set Command set
  *                命令集
  * @param cmd_id Command ID
@@ -151,12 +187,13 @@ static entry_t* find_entry_by_seq(uint16_t seq) {
  * @return entry_t* Pointer to found entry, NULL if not found
  *                  找到的条目指针，未找到则返回 NULL
  */
-static entry_t* find_entry_by_cmd_id(uint16_t cmd_set, uint16_t cmd_id) {
+static entry_t* find_entry_by_cmd_id(int link, uint16_t cmd_set, uint16_t cmd_id) {
+    entry_t *entries = s_entries[link];
     for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
-        if (s_entries[i].in_use && !s_entries[i].is_seq_based && 
-            s_entries[i].cmd_set == cmd_set && s_entries[i].cmd_id == cmd_id) {
-            s_entries[i].last_access_time = xTaskGetTickCount();
-            return &s_entries[i];
+        if (entries[i].in_use && !entries[i].is_seq_based && 
+            entries[i].cmd_set == cmd_set && entries[i].cmd_id == cmd_id) {
+            entries[i].last_access_time = xTaskGetTickCount();
+            return &entries[i];
         }
     }
     return NULL;
@@ -193,15 +230,19 @@ static void free_entry(entry_t *entry) {
  * @brief Allocate a free entry based on sequence number
  *        分配一个空闲的 entry，基于 seq
  * 
+ * @param link Link of the camera
+ *             相机所在链路
  * @param seq Frame sequence number
  *            帧序列号
  * @return entry_t* Pointer to allocated entry, NULL if failed
  *                  返回分配的条目指针，如果失败则返回 NULL
  */
-static entry_t* allocate_entry_by_seq(uint16_t seq) {
+static entry_t* allocate_entry_by_seq(int link, uint16_t seq) {
+    entry_t *entries = s_entries[link];
+
     // First check if an entry with the same seq exists
     // 首先检查是否已存在相同 seq 的条目
-    entry_t *existing_entry = find_entry_by_seq(seq);
+    entry_t *existing_entry = find_entry_by_seq(link, seq);
     if (existing_entry) {
         ESP_LOGI(TAG, "Overwriting existing entry for seq=0x%04X", seq);
         free_entry(existing_entry);
@@ -216,29 +257,29 @@ static entry_t* allocate_entry_by_seq(uint16_t seq) {
     TickType_t oldest_access_time = xTaskGetTickCount();
 
     for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
-        if (!s_entries[i].in_use) {
-            s_entries[i].in_use = true;
-            s_entries[i].is_seq_based = true;
-            s_entries[i].seq = seq;
-            s_entries[i].cmd_set = 0;
-            s_entries[i].cmd_id = 0;
-            s_entries[i].parse_result = NULL;
-            s_entries[i].parse_result_length = 0;
-            s_entries[i].sem = xSemaphoreCreateBinary();
-            if (s_entries[i].sem == NULL) {
+        if (!entries[i].in_use) {
+            entries[i].in_use = true;
+            entries[i].is_seq_based = true;
+            entries[i].seq = seq;
+            entries[i].cmd_set = 0;
+            entries[i].cmd_id = 0;
+            entries[i].parse_result = NULL;
+            entries[i].parse_result_length = 0;
+            entries[i].sem = xSemaphoreCreateBinary();
+            if (entries[i].sem == NULL) {
                 ESP_LOGE(TAG, "Failed to create semaphore for seq=0x%04X", seq);
-                s_entries[i].in_use = false;
+                entries[i].in_use = false;
                 return NULL;
             }
-            s_entries[i].last_access_time = xTaskGetTickCount();
-            return &s_entries[i];
+            entries[i].last_access_time = xTaskGetTickCount();
+            return &entries[i];
         }
 
         // Track the least recently used entry
         // 最久未使用的条目
-        if (s_entries[i].last_access_time < oldest_access_time) {
-            oldest_access_time = s_entries[i].last_access_time;
-            oldest_entry = &s_entries[i];
+        if (entries[i].last_access_time < oldest_access_time) {
+            oldest_access_time = entries[i].last_access_time;
+            oldest_entry = &entries[i];
         }
     }
 
@@ -276,6 +317,8 @@ static entry_t* allocate_entry_by_seq(uint16_t seq) {
  * @brief Allocate a free entry based on command set and ID
  *        分配一个空闲的 entry，基于 cmd_set 和 cmd_id
  * 
+ * @param link Link of the camera
+ *             相机所在链路
  * @param cmd_set Command set
  *                命令集
  * @param cmd_id Command ID
@@ -283,10 +326,12 @@ static entry_t* allocate_entry_by_seq(uint16_t seq) {
  * @return entry_t* Pointer to allocated entry, NULL if failed
  *                  返回分配的条目指针，如果失败则返回 NULL
  */
-static entry_t* allocate_entry_by_cmd(uint8_t cmd_set, uint8_t cmd_id) {
+static entry_t* allocate_entry_by_cmd(int link, uint8_t cmd_set, uint8_t cmd_id) {
+    entry_t *entries = s_entries[link];
+
     // First check if an entry with the same cmd_set and cmd_id exists
     // 首先检查是否已存在相同 cmd_set 和 cmd_id 的条目
-    entry_t *existing_entry = find_entry_by_cmd_id(cmd_set, cmd_id);
+    entry_t *existing_entry = find_entry_by_cmd_id(link, cmd_set, cmd_id);
     if (existing_entry) {
         // Entry exists, reuse it
         // 条目已存在，复用
@@ -301,31 +346,31 @@ static entry_t* allocate_entry_by_cmd(uint8_t cmd_set, uint8_t cmd_id) {
     TickType_t oldest_access_time = xTaskGetTickCount();
 
     for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
-        if (!s_entries[i].in_use) {
+        if (!entries[i].in_use) {
             // Found a free entry
             // 找到一个空闲条目
-            s_entries[i].in_use = true;
-            s_entries[i].is_seq_based = false;
-            s_entries[i].seq = 0;
-            s_entries[i].cmd_set = cmd_set;
-            s_entries[i].cmd_id = cmd_id;
-            s_entries[i].parse_result = NULL;
-            s_entries[i].parse_result_length = 0;
-            s_entries[i].sem = xSemaphoreCreateBinary();
-            if (s_entries[i].sem == NULL) {
+            entries[i].in_use = true;
+            entries[i].is_seq_based = false;
+            entries[i].seq = 0;
+            entries[i].cmd_set = cmd_set;
+            entries[i].cmd_id = cmd_id;
+            entries[i].parse_result = NULL;
+            entries[i].parse_result_length = 0;
+            entries[i].sem = xSemaphoreCreateBinary();
+            if (entries[i].sem == NULL) {
                 ESP_LOGE(TAG, "Failed to create semaphore for cmd_set=0x%04X cmd_id=0x%04X", cmd_set, cmd_id);
-                s_entries[i].in_use = false;
+                entries[i].in_use = false;
                 return NULL;
             }
-            s_entries[i].last_access_time = xTaskGetTickCount();
-            return &s_entries[i];
+            entries[i].last_access_time = xTaskGetTickCount();
+            return &entries[i];
         }
 
         // Only consider non-seq-based entries as deletion candidates
         // 仅考虑非基于 seq 的条目作为候选删除对象
-        if (!s_entries[i].is_seq_based && s_entries[i].last_access_time < oldest_access_time) {
-            oldest_access_time = s_entries[i].last_access_time;
-            oldest_entry = &s_entries[i];
+        if (!entries[i].is_seq_based && entries[i].last_access_time < oldest_access_time) {
+            oldest_access_time = entries[i].last_access_time;
+            oldest_entry = &entries[i];
         }
     }
 
@@ -382,14 +427,17 @@ static void cleanup_old_entries(TimerHandle_t xTimer) {
     }
     // Check each entry for expiration
     // 检查每个条目是否过期
-    for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
-        if (s_entries[i].in_use && (current_time - s_entries[i].last_access_time) > pdMS_TO_TICKS(MAX_ENTRY_AGE * 1000)) {
-            if (s_entries[i].is_seq_based) {
-                ESP_LOGI(TAG, "Cleaning up unused entry seq=0x%04X", s_entries[i].seq);
-            } else {
-                ESP_LOGI(TAG, "Cleaning up unused entry cmd_set=0x%04X cmd_id=0x%04X", s_entries[i].cmd_set, s_entries[i].cmd_id);
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        for (int i = 0; i < MAX_SEQ_ENTRIES; i++) {
+            entry_t *entry = &s_entries[link][i];
+            if (entry->in_use && (current_time - entry->last_access_time) > pdMS_TO_TICKS(MAX_ENTRY_AGE * 1000)) {
+                if (entry->is_seq_based) {
+                    ESP_LOGI(TAG, "Cleaning up unused entry link=%d seq=0x%04X", link, entry->seq);
+                } else {
+                    ESP_LOGI(TAG, "Cleaning up unused entry link=%d cmd_set=0x%04X cmd_id=0x%04X", link, entry->cmd_set, entry->cmd_id);
+                }
+                free_entry(entry);
             }
-            free_entry(&s_entries[i]);
         }
     }
     xSemaphoreGive(s_map_mutex);
@@ -411,6 +459,19 @@ void data_init(void) {
         return;
     }
 
+    // Create the TX mutex of each link
+    // 创建每条链路的发送互斥锁
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        s_tx_mutex[link] = xSemaphoreCreateMutex();
+        if (s_tx_mutex[link] == NULL) {
+            ESP_LOGE(TAG, "Failed to create TX mutex");
+            return;
+        }
+#if CONFIG_DATA_COALESCE_FRAMES
+        s_coalesce[link] = true;
+#endif
+    }
+
     // Clear all entries
     // 清空所有条目
     reset_entries();
@@ -441,13 +502,153 @@ bool is_data_layer_initialized(void) {
     return data_layer_initialized;
 }
 
+/**
+ * @brief Get the ATT payload of one write on the link
+ *        获取链路上一次写入的 ATT 负载长度
+ *
+ * @param link Link of the camera
+ *             相机所在链路
+ * @param length Frame length
+ *               帧长度
+ * @param out_payload_length Bytes one write carries, MTU - 3
+ *                           一次写入可携带的字节数，即 MTU - 3
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE when the link is down, ESP_ERR_INVALID_SIZE for a frame above MAX_FRAME_LENGTH
+ *                   成功返回 ESP_OK，链路未连接返回 ESP_ERR_INVALID_STATE，帧超过 MAX_FRAME_LENGTH 返回 ESP_ERR_INVALID_SIZE
+ */
+static esp_err_t data_get_payload_length(int link, size_t length, size_t *out_payload_length) {
+    uint16_t mtu = ble_transport_get_mtu(link);
+    if (mtu <= BLE_ATT_HEADER_LENGTH) {
+        ESP_LOGE(TAG, "Link %d not connected", link);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (length > MAX_FRAME_LENGTH) {
+        ESP_LOGE(TAG, "Frame of %u bytes exceeds the protocol limit", (unsigned)length);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    *out_payload_length = mtu - BLE_ATT_HEADER_LENGTH;
+    return ESP_OK;
+}
+
+/**
+ * @brief Write a buffer to the link in writes of at most payload_length bytes
+ *        以不超过 payload_length 字节的多次写入将缓冲区写往链路
+ *
+ * Called with the TX mutex of the link held, so the camera receives the pieces back to back and
+ * reassembles the frame from its header. Without a credit the first write returns ESP_ERR_NO_MEM
+ * unless wait is set. Once a piece is out the rest always waits up to TX_CREDIT_WAIT_MS per write,
+ * since the camera drops a frame that stops halfway.
+ * 调用时持有链路的发送互斥锁，相机连续收到各段并按帧头重组。没有写入额度时，除非设置 wait，
+ * 第一次写入返回 ESP_ERR_NO_MEM。一旦有一段已发出，其余各段每次最多等待 TX_CREDIT_WAIT_MS，
+ * 因为半途中断的帧会被相机丢弃。
+ *
+ * @param link Link of the camera
+ *             相机所在链路
+ * @param data Data to be sent
+ *             需要发送的数据
+ * @param length Length of data
+ *               数据长度
+ * @param payload_length Largest write, MTU - 3
+ *                       单次写入的最大长度，即 MTU - 3
+ * @param with_response Use write requests instead of write commands
+ *                      使用写请求而不是写命令
+ * @param wait Wait for a credit for the first write as well
+ *             第一次写入也等待写入额度
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM when nothing was sent, ESP_ERR_TIMEOUT when the frame was cut
+ *                   成功返回 ESP_OK，未发送任何数据返回 ESP_ERR_NO_MEM，帧被截断返回 ESP_ERR_TIMEOUT
+ */
+static esp_err_t data_write_segments(int link, const uint8_t *data, size_t length, size_t payload_length,
+                                     bool with_response, bool wait) {
+    size_t offset = 0;
+    while (offset < length) {
+        size_t chunk = length - offset < payload_length ? length - offset : payload_length;
+        TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(TX_CREDIT_WAIT_MS);
+        esp_err_t ret = ble_transport_write(link, data + offset, chunk, with_response);
+        while (ret == ESP_ERR_NO_MEM && (wait || offset > 0) && (int32_t)(deadline - xTaskGetTickCount()) > 0) {
+            data_wait_tx_ready(link, pdTICKS_TO_MS(deadline - xTaskGetTickCount()));
+            ret = ble_transport_write(link, data + offset, chunk, with_response);
+        }
+        if (ret != ESP_OK) {
+            if (offset > 0) {
+                ESP_LOGE(TAG, "Link %d: frame cut after %u of %u bytes", link, (unsigned)offset, (unsigned)length);
+                return ESP_ERR_TIMEOUT;
+            }
+            return ret;
+        }
+        s_activity[link].writes++;
+        offset += chunk;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Write frames without response, packing them into as few writes as the link allows
+ *        无响应地写入多帧，按链路允许的方式合并为尽量少的写入
+ *
+ * Called with the TX mutex of the link held. Frames above MTU - 3 are split. With coalescing on,
+ * consecutive frames that fit share one write.
+ * 调用时持有链路的发送互斥锁。超过 MTU - 3 的帧被拆分。启用合并时，能放下的连续帧共用一次写入。
+ */
+static esp_err_t data_write_frames(int link, const data_frame_t *frames, size_t count, size_t payload_length) {
+    uint8_t *buffer = s_tx_buffer[link];
+    size_t buffer_limit = payload_length < COALESCE_BUFFER_LENGTH ? payload_length : COALESCE_BUFFER_LENGTH;
+    size_t fill = 0;
+    size_t buffered = 0;
+    bool started = false;
+    esp_err_t ret = ESP_OK;
+
+    for (size_t i = 0; i <= count; i++) {
+        const data_frame_t *frame = i < count ? &frames[i] : NULL;
+        bool coalesce = frame != NULL && s_coalesce[link] && frame->length <= buffer_limit;
+
+        // 下一帧放不下或不参与合并时，先发出缓冲区
+        // Flush the buffer when the next frame does not fit or is not coalesced
+        if (fill > 0 && (!coalesce || fill + frame->length > buffer_limit)) {
+            ret = data_write_segments(link, buffer, fill, payload_length, false, started);
+            if (ret != ESP_OK) {
+                break;
+            }
+            s_activity[link].coalesced += buffered - 1;
+            started = true;
+            fill = 0;
+            buffered = 0;
+        }
+        if (frame == NULL) {
+            break;
+        }
+
+        if (coalesce) {
+            memcpy(&buffer[fill], frame->data, frame->length);
+            fill += frame->length;
+            buffered++;
+            continue;
+        }
+
+        ret = data_write_segments(link, frame->data, frame->length, payload_length, false, started);
+        if (ret != ESP_OK) {
+            break;
+        }
+        if (frame->length > payload_length) {
+            s_activity[link].segmented++;
+        }
+        started = true;
+    }
+
+    if (ret == ESP_ERR_NO_MEM && !started) {
+        s_activity[link].refused++;
+    }
+    return ret;
+}
+
 /**
  * @brief Send data frame with response
  *        发送数据帧（有响应）
  * 
- * Send data frame to device via BLE and wait for response.
- * 通过 BLE 向设备发送数据帧，并等待响应。
+ * Send data frame to device via BLE and wait for response. A frame above MTU - 3 is split into
+ * several writes.
+ * 通过 BLE 向设备发送数据帧，并等待响应。超过 MTU - 3 的帧拆分为多次写入。
  * 
+ * @param link Link of the camera
+ *             相机所在链路
  * @param seq Frame sequence number
  *            数据帧的序列号
  * @param raw_data Data to be sent
@@ -458,13 +659,18 @@ bool is_data_layer_initialized(void) {
  * @return esp_err_t ESP_OK on success, error code on failure
  *                   成功返回 ESP_OK，失败返回错误码
  */
-esp_err_t data_write_with_response(uint16_t seq, const uint8_t *raw_data, size_t raw_data_length) {
+esp_err_t data_write_with_response(int link, uint16_t seq, const uint8_t *raw_data, size_t raw_data_length) {
     // Validate input parameters
     // 验证输入参数
-    if (!raw_data || raw_data_length == 0) {
-        ESP_LOGE(TAG, "Invalid data or length");
+    if (link < 0 || link >= BLE_MAX_LINKS || !raw_data || raw_data_length == 0) {
+        ESP_LOGE(TAG, "Invalid link, data or length");
         return ESP_ERR_INVALID_ARG;
     }
+    size_t payload_length = 0;
+    esp_err_t ret = data_get_payload_length(link, raw_data_length, &payload_length);
+    if (ret != ESP_OK) {
+        return ret;
+    }
 
     // Take mutex for thread safety
     // 获取互斥锁以保证线程安全
@@ -475,7 +681,7 @@ esp_err_t data_write_with_response(uint16_t seq, const uint8_t *raw_data, size_t
 
     // Allocate an entry for this sequence
     // 为此序列号分配一个条目
-    entry_t *entry = allocate_entry_by_seq(seq);
+    entry_t *entry = allocate_entry_by_seq(link, seq);
     if (!entry) {
         ESP_LOGE(TAG, "No free entry, can't write");
         xSemaphoreGive(s_map_mutex);
@@ -484,23 +690,25 @@ esp_err_t data_write_with_response(uint16_t seq, const uint8_t *raw_data, size_t
 
     xSemaphoreGive(s_map_mutex);
 
-    // Send write command with response
-    // 发送写命令（有响应）
-    esp_err_t ret = ble_write_with_response(
-        s_ble_profile.conn_id,           // Current connection ID
-                                         // 当前连接 ID
-        s_ble_profile.write_char_handle, // Write characteristic handle
-                                         // 写特征句柄
-        raw_data,                        // Data to be sent
-                                         // 要发送的数据
-        raw_data_length                  // Length of data
-                                         // 数据长度
-    );
+    // Send write command with response, waiting for a credit while the link is busy
+    // 发送写命令（有响应），链路繁忙时等待写入额度
+    if (xSemaphoreTake(s_tx_mutex[link], pdMS_TO_TICKS(TX_CREDIT_WAIT_MS)) == pdTRUE) {
+        ret = data_write_segments(link, raw_data, raw_data_length, payload_length, true, true);
+        xSemaphoreGive(s_tx_mutex[link]);
+    } else {
+        ret = ESP_ERR_TIMEOUT;
+    }
+    if (ret == ESP_OK) {
+        s_activity[link].last_command_tick = xTaskGetTickCount();
+        if (raw_data_length > payload_length) {
+            s_activity[link].segmented++;
+        }
+    }
 
     // Handle write failure
     // 处理写入失败的情况
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "ble_write_with_response failed: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "Write with response failed on link %d: %s", link, esp_err_to_name(ret));
         // Clean up on failure
         // 失败时清理资源
         if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
@@ -517,9 +725,17 @@ esp_err_t data_write_with_response(uint16_t seq, const uint8_t *raw_data, size_t
  * @brief Send data frame without response
  *        发送数据帧（无响应）
  * 
- * Send data frame to device via BLE without waiting for response.
- * 通过 BLE 向设备发送数据帧，且不等待响应。
+ * Send data frame to device via BLE without waiting for response. No entry is allocated, so the
+ * frame cannot evict a command still waiting for its reply, and the same buffer can be written
+ * to several links. It does not wait for a credit: when every write credit of the link is in
+ * flight, or another frame is being written, the frame is refused with ESP_ERR_NO_MEM. A frame
+ * above MTU - 3 is split into several writes.
+ * 通过 BLE 向设备发送数据帧，且不等待响应。不分配条目，因此不会挤掉仍在等待应答的命令，
+ * 同一缓冲区也可写往多条链路。不等待写入额度：链路的写入额度全部在途或正在写入其他帧时
+ * 返回 ESP_ERR_NO_MEM，帧不发送。超过 MTU - 3 的帧拆分为多次写入。
  * 
+ * @param link Link of the camera
+ *             相机所在链路
  * @param seq Frame sequence number
  *            数据帧的序列号
  * @param raw_data Data to be sent
@@ -530,66 +746,154 @@ esp_err_t data_write_with_response(uint16_t seq, const uint8_t *raw_data, size_t
  * @return esp_err_t ESP_OK on success, error code on failure
  *                   成功返回 ESP_OK，失败返回错误码
  */
-esp_err_t data_write_without_response(uint16_t seq, const uint8_t *raw_data, size_t raw_data_length) {
+esp_err_t data_write_without_response(int link, uint16_t seq, const uint8_t *raw_data, size_t raw_data_length) {
     // Validate input parameters
     // 验证输入参数
-    if (!raw_data || raw_data_length == 0) {
-        ESP_LOGE(TAG, "Invalid raw_data or raw_data_length");
+    if (link < 0 || link >= BLE_MAX_LINKS || !raw_data || raw_data_length == 0) {
+        ESP_LOGE(TAG, "Invalid link, raw_data or raw_data_length");
         return ESP_ERR_INVALID_ARG;
     }
-
-    // Take mutex for thread safety
-    // 获取互斥锁以保证线程安全
-    if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
-        ESP_LOGE(TAG, "Failed to take mutex");
-        return ESP_ERR_INVALID_STATE;
-    }
-
-    // Allocate an entry for this sequence
-    // 为此序列号分配一个条目
-    entry_t *entry = allocate_entry_by_seq(seq);
-    if (!entry) {
-        ESP_LOGE(TAG, "No free entry, can't write");
-        xSemaphoreGive(s_map_mutex);
-        return ESP_ERR_NO_MEM;
+    size_t payload_length = 0;
+    esp_err_t ret = data_get_payload_length(link, raw_data_length, &payload_length);
+    if (ret != ESP_OK) {
+        return ret;
     }
 
-    xSemaphoreGive(s_map_mutex);
-
     // Send write command without response
     // 发送写命令（无响应）
-    esp_err_t ret = ble_write_without_response(
-        s_ble_profile.conn_id,           // Current connection ID
-                                         // 当前连接 ID
-        s_ble_profile.write_char_handle, // Write characteristic handle
-                                         // 写特征句柄
-        raw_data,                        // Data to be sent
-                                         // 要发送的数据
-        raw_data_length                  // Length of data
-                                         // 数据长度
-    );
+    const data_frame_t frame = {
+        .data = raw_data,
+        .length = raw_data_length,
+    };
+    if (xSemaphoreTake(s_tx_mutex[link], 0) == pdTRUE) {
+        ret = data_write_frames(link, &frame, 1, payload_length);
+        xSemaphoreGive(s_tx_mutex[link]);
+    } else {
+        s_activity[link].refused++;
+        ret = ESP_ERR_NO_MEM;
+    }
+    if (ret == ESP_ERR_NO_MEM) {
+        // 链路繁忙，交由调用者决定丢弃还是在 data_wait_tx_ready() 之后重试
+        // The link is busy, the caller drops the frame or retries after data_wait_tx_ready()
+        ESP_LOGD(TAG, "Link %d busy, seq=0x%04X not sent", link, seq);
+        return ret;
+    }
 
     // Handle write failure
     // 处理写入失败的情况
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "ble_write_without_response failed: %s", esp_err_to_name(ret));
-        // Clean up on failure
-        // 失败时清理资源
-        if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            free_entry(entry);
-            xSemaphoreGive(s_map_mutex);
-        }
+        ESP_LOGE(TAG, "Write without response failed on link %d, seq=0x%04X: %s", link, seq, esp_err_to_name(ret));
         return ret;
     }
 
-    // For write without response, release entry immediately
-    // 对于无响应写，立即释放条目
-    if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        free_entry(entry);
-        xSemaphoreGive(s_map_mutex);
+    return ESP_OK;
+}
+
+/**
+ * @brief Send several frames without response in as few writes as possible
+ *        以尽量少的写入无响应地发送多帧
+ *
+ * Frames go out in order. When the camera of the link takes several frames in one write (see
+ * data_set_link_coalescing()), consecutive frames are packed up to MTU - 3 bytes per write.
+ * Frames above MTU - 3 are split. Like data_write_without_response() the batch is refused with
+ * ESP_ERR_NO_MEM when the link is busy, but once the first write is out the rest waits for credits.
+ * 各帧按顺序发送。当链路的相机接受一次写入多帧时（见 data_set_link_coalescing()），连续的帧
+ * 按每次写入不超过 MTU - 3 字节打包。超过 MTU - 3 的帧被拆分。与 data_write_without_response()
+ * 一样，链路繁忙时整批返回 ESP_ERR_NO_MEM，但第一次写入发出后，其余写入会等待写入额度。
+ *
+ * @param link Link of the camera
+ *             相机所在链路
+ * @param frames Frames to send
+ *               需要发送的帧
+ * @param count Number of frames
+ *              帧数量
+ * @return esp_err_t ESP_OK when every frame was sent, error code on failure
+ *                   全部发送返回 ESP_OK，失败返回错误码
+ */
+esp_err_t data_write_frames_without_response(int link, const data_frame_t *frames, size_t count) {
+    if (link < 0 || link >= BLE_MAX_LINKS || !frames || count == 0) {
+        ESP_LOGE(TAG, "Invalid link, frames or count");
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t payload_length = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!frames[i].data || frames[i].length == 0) {
+            ESP_LOGE(TAG, "Invalid frame %u", (unsigned)i);
+            return ESP_ERR_INVALID_ARG;
+        }
+        esp_err_t ret = data_get_payload_length(link, frames[i].length, &payload_length);
+        if (ret != ESP_OK) {
+            return ret;
+        }
     }
 
-    return ESP_OK;
+    if (xSemaphoreTake(s_tx_mutex[link], 0) != pdTRUE) {
+        s_activity[link].refused++;
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = data_write_frames(link, frames, count, payload_length);
+    xSemaphoreGive(s_tx_mutex[link]);
+
+    if (ret != ESP_OK && ret != ESP_ERR_NO_MEM) {
+        ESP_LOGE(TAG, "Write of %u frames failed on link %d: %s", (unsigned)count, link, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * @brief Set whether the camera of a link takes several frames in one write
+ *        设置链路的相机是否接受一次写入多帧
+ *
+ * The camera must then split a write into frames by the frame header. The default comes from
+ * CONFIG_DATA_COALESCE_FRAMES.
+ * 此时相机需按帧头将一次写入拆分为多帧。默认值来自 CONFIG_DATA_COALESCE_FRAMES。
+ *
+ * @param link Link of the camera
+ *             相机所在链路
+ * @param enable true to pack frames
+ *               true 表示合并帧
+ */
+void data_set_link_coalescing(int link, bool enable) {
+    if (link >= 0 && link < BLE_MAX_LINKS) {
+        s_coalesce[link] = enable;
+    }
+}
+
+/**
+ * @brief Wait until the link can take another write
+ *        等待链路可以接受下一次写入
+ *
+ * Senders that must not lose frames pace themselves with this instead of retrying on ESP_ERR_NO_MEM.
+ * 不能丢帧的发送者用此函数控制节奏，而不是在 ESP_ERR_NO_MEM 后反复重试。
+ *
+ * @param link Link of the camera
+ *             相机所在链路
+ * @param timeout_ms Timeout in milliseconds
+ *                   等待的超时时间（毫秒）
+ * @return esp_err_t ESP_OK when a credit is free, ESP_ERR_TIMEOUT otherwise
+ *                   有空闲额度返回 ESP_OK，否则返回 ESP_ERR_TIMEOUT
+ */
+esp_err_t data_wait_tx_ready(int link, int timeout_ms) {
+    if (link < 0 || link >= BLE_MAX_LINKS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    EventBits_t bits = ble_transport_wait_events(link, BLE_EVENT_TX_READY, pdMS_TO_TICKS(timeout_ms));
+    return (bits & BLE_EVENT_TX_READY) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+/**
+ * @brief Get the write activity of a link
+ *        获取链路的写入活动
+ *
+ * @param link Link of the camera
+ *             相机所在链路
+ * @param out_activity Filled with the last command time and the number of writes and refusals so far
+ *                     填入最近一次命令的时间与累计写入、拒绝次数
+ */
+void data_get_link_activity(int link, data_link_activity_t *out_activity) {
+    if (link >= 0 && link < BLE_MAX_LINKS && out_activity) {
+        *out_activity = s_activity[link];
+    }
 }
 
 /**
@@ -599,6 +903,8 @@ esp_err_t data_write_without_response(uint16_t seq, const uint8_t *raw_data, siz
  * Wait for parsing result of a specific sequence number and return to caller.
  * 等待一个特定 seq 的解析结果，并返回给调用者。
  * 
+ * @param link Link of the camera
+ *             相机所在链路
  * @param seq Frame sequence number
  *            数据帧的序列号
  * @param timeout_ms Timeout in milliseconds
@@ -611,11 +917,11 @@ esp_err_t data_write_without_response(uint16_t seq, const uint8_t *raw_data, siz
  * @return esp_err_t ESP_OK on success, error code on failure
  *                   成功返回 ESP_OK，失败返回错误码
  */
-esp_err_t data_wait_for_result_by_seq(uint16_t seq, int timeout_ms, void **out_result, size_t *out_result_length) {
+esp_err_t data_wait_for_result_by_seq(int link, uint16_t seq, int timeout_ms, void **out_result, size_t *out_result_length) {
     // Validate input parameters
     // 验证输入参数
-    if (!out_result || !out_result_length) {
-        ESP_LOGE(TAG, "out_result or out_result_length is NULL");
+    if (link < 0 || link >= BLE_MAX_LINKS || !out_result || !out_result_length) {
+        ESP_LOGE(TAG, "Invalid link, or out_result or out_result_length is NULL");
         return ESP_ERR_INVALID_ARG;
     }
 
@@ -634,16 +940,17 @@ esp_err_t data_wait_for_result_by_seq(uint16_t seq, int timeout_ms, void **out_r
 
         // Try to find entry
         // 尝试查找条目
-        entry_t *entry = find_entry_by_seq(seq);
+        entry_t *entry = find_entry_by_seq(link, seq);
 
         if (entry) {
             // Increase reference count to prevent release during waiting
             // 增加引用计数，防止在等待期间被释放
             xSemaphoreGive(s_map_mutex);
 
-            // Wait for semaphore to be released
-            // 等待信号量被释放
-            if (xSemaphoreTake(entry->sem, timeout_ticks) != pdTRUE) {
+            // Wait for semaphore to be released, until the original deadline
+            // 等待信号量被释放，直到最初的截止时间
+            TickType_t elapsed_ticks = xTaskGetTickCount() - start_time;
+            if (xSemaphoreTake(entry->sem, elapsed_ticks < timeout_ticks ? timeout_ticks - elapsed_ticks : 0) != pdTRUE) {
                 ESP_LOGW(TAG, "Wait for seq=0x%04X timed out", seq);
                 if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
                     free_entry(entry);
@@ -715,6 +1022,8 @@ esp_err_t data_wait_for_result_by_seq(uint16_t seq, int timeout_ms, void **out_r
  * Wait for parsing result of a specific command set and ID, and return its corresponding sequence number.
  * 等待一个特定 cmd_set 和 cmd_id 的解析结果，并返回其对应的 seq 值。
  * 
+ * @param link Link of the camera
+ *             相机所在链路
  * @param cmd_set Command set
  *                命令集
  * @param cmd_id Command ID
@@ -731,11 +1040,11 @@ esp_err_t data_wait_for_result_by_seq(uint16_t seq, int timeout_ms, void **out_r
  * @return esp_err_t ESP_OK on success, error code on failure
  *                   成功返回 ESP_OK，失败返回错误码
  */
-esp_err_t data_wait_for_result_by_cmd(uint8_t cmd_set, uint8_t cmd_id, int timeout_ms, uint16_t *out_seq, void **out_result, size_t *out_result_length) {
+esp_err_t data_wait_for_result_by_cmd(int link, uint8_t cmd_set, uint8_t cmd_id, int timeout_ms, uint16_t *out_seq, void **out_result, size_t *out_result_length) {
     // Validate input parameters
     // 验证输入参数
-    if (!out_result || !out_seq || !out_result_length) {
-        ESP_LOGE(TAG, "out_result, out_seq or out_result_length is NULL");
+    if (link < 0 || link >= BLE_MAX_LINKS || !out_result || !out_seq || !out_result_length) {
+        ESP_LOGE(TAG, "Invalid link, or out_result, out_seq or out_result_length is NULL");
         return ESP_ERR_INVALID_ARG;
     }
 
@@ -754,16 +1063,17 @@ esp_err_t data_wait_for_result_by_cmd(uint8_t cmd_set, uint8_t cmd_id, int timeo
 
         // Try to find entry
         // 尝试查找条目
-        entry_t *entry = find_entry_by_cmd_id(cmd_set, cmd_id);
+        entry_t *entry = find_entry_by_cmd_id(link, cmd_set, cmd_id);
 
         if (entry) {
             // Increase reference count to prevent release during waiting
             // 增加引用计数，防止在等待期间被释放
             xSemaphoreGive(s_map_mutex);
 
-            // Wait for semaphore to be released
-            // 等待信号量被释放
-            if (xSemaphoreTake(entry->sem, timeout_ticks) != pdTRUE) {
+            // Wait for semaphore to be released, until the original deadline
+            // 等待信号量被释放，直到最初的截止时间
+            TickType_t elapsed_ticks = xTaskGetTickCount() - start_time;
+            if (xSemaphoreTake(entry->sem, elapsed_ticks < timeout_ticks ? timeout_ticks - elapsed_ticks : 0) != pdTRUE) {
                 ESP_LOGW(TAG, "Wait for cmd_set=0x%04X cmd_id=0x%04X timed out", cmd_set, cmd_id);
                 if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
                     free_entry(entry);
@@ -857,14 +1167,19 @@ void data_register_status_update_callback(camera_status_update_cb_t callback) {
  * 该函数处理从相机收到的通知数据。它首先检查通知帧是否有效（以 0xAA 开头），然后解析通知帧中的数据段。
  * 如果解析成功，会将结果保存到对应的条目中，并通过信号量唤醒等待的任务。如果没有找到对应的条目，则会创建新的条目来存储解析结果。
  * 
+ * @param link Link the notification arrived on
+ *             通知所在的链路
  * @param raw_data Raw notification data
  *                 原始通知数据
  * @param raw_data_length Data length
  *                        数据长度
  */
-void receive_camera_notify_handler(const uint8_t *raw_data, size_t raw_data_length) {
+void receive_camera_notify_handler(int link, const uint8_t *raw_data, size_t raw_data_length) {
     // Validate input parameters
     // 验证输入参数
+    if (link < 0 || link >= BLE_MAX_LINKS) {
+        return;
+    }
     if (!raw_data || raw_data_length < 2) {
         ESP_LOGW(TAG, "Notify data is too short or null, skip parse");
         return;
@@ -873,7 +1188,7 @@ void receive_camera_notify_handler(const uint8_t *raw_data, size_t raw_data_leng
     // Check frame header
     // 检查帧头
     if (raw_data[0] == 0xAA || raw_data[0] == 0xaa) {
-        ESP_LOGI(TAG, "Notification received, attempting to parse...");
+        ESP_LOGI(TAG, "Notification received on link %d, attempting to parse...", link);
         ESP_LOG_BUFFER_HEX(TAG, raw_data, raw_data_length);  // Print notification content
                                                              // 打印通知内容
         
@@ -917,7 +1232,7 @@ void receive_camera_notify_handler(const uint8_t *raw_data, size_t raw_data_leng
         // Find corresponding entry
         // 查找对应的条目
         if (xSemaphoreTake(s_map_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            entry_t *entry = find_entry_by_seq(actual_seq);
+            entry_t *entry = find_entry_by_seq(link, actual_seq);
             if (entry) {
                 // Assume parse_result is void* object returned by protocol_parse_data
                 // 假设 parse_result 是 protocol_parse_data 返回的 void* 对象
@@ -940,7 +1255,7 @@ void receive_camera_notify_handler(const uint8_t *raw_data, size_t raw_data_leng
                 ESP_LOGW(TAG, "No waiting entry found for seq=0x%04X, creating a new entry by cmd_set=0x%04X cmd_id=0x%04X", actual_seq, actual_cmd_set, actual_cmd_id);
                 // Allocate a new entry
                 // 分配一个新的条目
-                entry = allocate_entry_by_cmd(actual_cmd_set, actual_cmd_id);
+                entry = allocate_entry_by_cmd(link, actual_cmd_set, actual_cmd_id);
                 if (entry == NULL) {
                     ESP_LOGE(TAG, "Failed to allocate entry for seq=0x%04X cmd_set=0x%04X cmd_id=0x%04X", actual_seq, actual_cmd_set, actual_cmd_id);
                 } else {
@@ -967,7 +1282,7 @@ void receive_camera_notify_handler(const uint8_t *raw_data, size_t raw_data_leng
                 status_copy = malloc(parse_result_length);
                 if (status_copy != NULL) {
                     memcpy(status_copy, parse_result, parse_result_length);
-                    status_update_callback(status_copy);
+                    status_update_callback(link, status_copy);
                 } else {
                     ESP_LOGE(TAG, "Failed to allocate memory for status update callback");
                 }
@@ -26,21 +26,47 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+/* 链路的写入活动，见 data_get_link_activity() */
+/* Write activity of a link, see data_get_link_activity() */
+typedef struct {
+    TickType_t last_command_tick;  // Last write that waits for a response
+    uint32_t writes;               // Writes so far, with and without response
+    uint32_t refused;              // Writes without response refused for lack of a write credit
+    uint32_t segmented;            // Frames split over several writes because they exceed MTU - 3
+    uint32_t coalesced;            // Frames that shared a write with the frame before them
+} data_link_activity_t;
+
+/* 一帧待发送的数据，见 data_write_frames_without_response() */
+/* One frame to send, see data_write_frames_without_response() */
+typedef struct {
+    const uint8_t *data;
+    size_t length;
+} data_frame_t;
 
 void data_init(void);
 
 bool is_data_layer_initialized(void);
 
-esp_err_t data_write_with_response(uint16_t seq, const uint8_t *raw_data, size_t raw_data_length);
+esp_err_t data_write_with_response(int link, uint16_t seq, const uint8_t *raw_data, size_t raw_data_length);
+
+esp_err_t data_write_without_response(int link, uint16_t seq, const uint8_t *raw_data, size_t raw_data_length);
+
+esp_err_t data_write_frames_without_response(int link, const data_frame_t *frames, size_t count);
+
+void data_set_link_coalescing(int link, bool enable);
+
+esp_err_t data_wait_tx_ready(int link, int timeout_ms);
 
-esp_err_t data_write_without_response(uint16_t seq, const uint8_t *raw_data, size_t raw_data_length);
+void data_get_link_activity(int link, data_link_activity_t *out_activity);
 
-esp_err_t data_wait_for_result_by_seq(uint16_t seq, int timeout_ms, void **out_result, size_t *out_result_length);
+esp_err_t data_wait_for_result_by_seq(int link, uint16_t seq, int timeout_ms, void **out_result, size_t *out_result_length);
 
-esp_err_t data_wait_for_result_by_cmd(uint8_t cmd_set, uint8_t cmd_id, int timeout_ms, uint16_t *out_seq, void **out_result, size_t *out_result_length);
+esp_err_t data_wait_for_result_by_cmd(int link, uint8_t cmd_set, uint8_t cmd_id, int timeout_ms, uint16_t *out_seq, void **out_result, size_t *out_result_length);
 
-typedef void (*camera_status_update_cb_t)(void *data);
+typedef void (*camera_status_update_cb_t)(int link, void *data);
 void data_register_status_update_callback(camera_status_update_cb_t callback);
-void receive_camera_notify_handler(const uint8_t *raw_data, size_t raw_data_length);
+void receive_camera_notify_handler(int link, const uint8_t *raw_data, size_t raw_data_length);
 
 #endif
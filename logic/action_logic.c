@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+
+#include "ble_transport.h"
+#include "action_logic.h"
+#include "command_logic.h"
+#include "connect_logic.h"
+#include "status_logic.h"
+
+#define TAG "LOGIC_ACTION"
+
+typedef struct {
+    uint8_t type;           // camera_action_type_t
+    uint8_t param;
+    const char *source;     // Static name of the requester, for logging
+                            // 请求方的静态名称，用于日志
+} camera_action_t;
+
+static QueueHandle_t s_action_queue = NULL;
+
+/**
+ * @brief Name of an action
+ *        动作名称
+ */
+const char *camera_action_to_string(camera_action_type_t type) {
+    switch (type) {
+        case CAMERA_ACTION_NONE:         return "none";
+        case CAMERA_ACTION_START_RECORD: return "start record";
+        case CAMERA_ACTION_STOP_RECORD:  return "stop record";
+        case CAMERA_ACTION_SWITCH_MODE:  return "switch mode";
+        default:                         return "unknown";
+    }
+}
+
+/**
+ * @brief Request a camera action, never blocks
+ *        请求一个相机动作，不会阻塞
+ *
+ * @param type Action
+ *             动作
+ * @param param Action parameter
+ *              动作参数
+ * @param source Static name of the requester, for logging
+ *               请求方的静态名称，用于日志
+ * @return bool Returns true if the action was queued
+ *              动作已入队时返回 true
+ */
+bool action_logic_post(camera_action_type_t type, uint8_t param, const char *source) {
+    if (s_action_queue == NULL || type == CAMERA_ACTION_NONE || type >= CAMERA_ACTION_TYPE_COUNT) {
+        return false;
+    }
+
+    camera_action_t action = {
+        .type = (uint8_t)type,
+        .param = param,
+        .source = source,
+    };
+    if (xQueueSend(s_action_queue, &action, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Action queue full, %s from %s dropped", camera_action_to_string(type), source);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Execute one action on one camera, waiting for its response
+ *        在一台相机上执行一个动作并等待其应答
+ */
+static void action_execute_link(const camera_action_t *action, int link) {
+    void *response = NULL;
+
+    switch (action->type) {
+        case CAMERA_ACTION_START_RECORD:
+            if (is_link_camera_recording(link)) {
+                return;
+            }
+            response = command_logic_start_record(link);
+            break;
+        case CAMERA_ACTION_STOP_RECORD:
+            if (!is_link_camera_recording(link)) {
+                return;
+            }
+            response = command_logic_stop_record(link);
+            break;
+        case CAMERA_ACTION_SWITCH_MODE:
+            response = command_logic_switch_camera_mode(link, (camera_mode_t)action->param);
+            break;
+        default:
+            return;
+    }
+
+    if (response == NULL) {
+        ESP_LOGE(TAG, "Failed to %s on link %d", camera_action_to_string(action->type), link);
+        return;
+    }
+    free(response);
+}
+
+/**
+ * @brief Execute one action on every connected camera
+ *        在所有已连接的相机上执行一个动作
+ */
+static void action_execute(const camera_action_t *action) {
+    uint32_t links = connect_logic_get_protocol_links();
+    if (links == 0) {
+        ESP_LOGW(TAG, "Camera not connected, %s from %s skipped", camera_action_to_string(action->type), action->source);
+        return;
+    }
+
+    ESP_LOGI(TAG, "%s from %s", camera_action_to_string(action->type), action->source);
+
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        if (links & (1u << link)) {
+            action_execute_link(action, link);
+        }
+    }
+}
+
+/**
+ * @brief Action task, executes queued actions in order
+ *        动作任务，按顺序执行排队的动作
+ *
+ * @param arg 任务参数
+ *            Task parameters
+ */
+static void action_task(void *arg) {
+    camera_action_t action;
+
+    while (1) {
+        if (xQueueReceive(s_action_queue, &action, portMAX_DELAY) == pdTRUE) {
+            action_execute(&action);
+        }
+    }
+}
+
+/**
+ * @brief Initialize the camera action queue and task
+ *        初始化相机动作队列和任务
+ *
+ * @return int Returns 0 on success, -1 on failure
+ *             返回 0 表示成功，-1 表示失败
+ */
+int action_logic_init(void) {
+    s_action_queue = xQueueCreate(CAMERA_ACTION_QUEUE_LENGTH, sizeof(camera_action_t));
+    if (s_action_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create action queue");
+        return -1;
+    }
+
+    // 与按键任务同优先级，动作应及时执行
+    // Same priority as the key task, actions should run promptly
+    if (xTaskCreate(action_task, "action_task", 1024 * 3, NULL, 2, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create action task");
+        return -1;
+    }
+    return 0;
+}
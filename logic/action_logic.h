@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __ACTION_LOGIC_H__
+#define __ACTION_LOGIC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Camera actions requested by automations (geofences, rules), executed one at a time in their own
+ * task so the requester never blocks on the camera's response.
+ * 自动化功能（地理围栏、规则）请求的相机动作，在独立任务中逐个执行，请求方不会因等待相机应答而阻塞。
+ */
+
+// Pending actions; further requests are dropped while the queue is full
+// 待执行动作数量；队列满时丢弃新的请求
+#define CAMERA_ACTION_QUEUE_LENGTH  8
+
+/* Camera action, values are stored in geofence images and rule configs */
+/* 相机动作，数值保存在地理围栏镜像和规则配置中 */
+typedef enum {
+    CAMERA_ACTION_NONE = 0,
+    CAMERA_ACTION_START_RECORD = 1,     // Skipped if already recording
+                                        // 已在录制时跳过
+    CAMERA_ACTION_STOP_RECORD = 2,      // Skipped if not recording
+                                        // 未在录制时跳过
+    CAMERA_ACTION_SWITCH_MODE = 3,      // Parameter is the camera_mode_t
+                                        // 参数为 camera_mode_t
+    CAMERA_ACTION_TYPE_COUNT,
+} camera_action_type_t;
+
+int action_logic_init(void);
+
+bool action_logic_post(camera_action_type_t type, uint8_t param, const char *source);
+
+const char *camera_action_to_string(camera_action_type_t type);
+
+#endif
@@ -24,7 +24,7 @@
 #include "freertos/task.h"
 #include "esp_log.h"
 
-#include "ble.h"
+#include "ble_transport.h"
 #include "data.h"
 #include "enums_logic.h"
 #include "connect_logic.h"
@@ -35,16 +35,36 @@
 
 #define TAG "LOGIC_COMMAND"
 
-uint16_t s_current_seq = 0;
+/* Each camera has its own seq space, replies are matched per link */
+/* 每台相机有独立的 seq 空间，应答按链路匹配 */
+static uint16_t s_current_seq[BLE_MAX_LINKS];
 
-uint16_t generate_seq(void) {
-    return s_current_seq += 1;
+/* Seq of frames written to every camera at once, such as GPS pushes */
+/* 同时写往所有相机的帧（如 GPS 推送）使用的 seq */
+static uint16_t s_broadcast_seq = 0;
+
+/**
+ * @brief Generate the next sequence number of a link
+ *        生成某条链路的下一个序列号
+ *
+ * @param link Link of the camera
+ *             相机所在链路
+ * @return uint16_t Sequence number
+ *                  序列号
+ */
+uint16_t generate_seq(int link) {
+    if (link < 0 || link >= BLE_MAX_LINKS) {
+        return 0;
+    }
+    return s_current_seq[link] += 1;
 }
 
 /**
  * @brief General function for constructing data frames and sending commands
  *        构造数据帧并发送命令的通用函数
  *
+ * @param link Link of the camera
+ *             相机所在链路
  * @param cmd_set Command set, used to specify command category
  *                命令集，用于指定命令的类别
  * @param cmd_id Command ID, used to identify specific command
@@ -64,10 +84,10 @@ uint16_t generate_seq(void) {
  * @return CommandResult Returns parsed structure pointer and data length on success, NULL pointer and length 0 on failure
  *                       成功返回解析后的结构体指针及数据长度，失败返回 NULL 指针及长度 0
  */
-CommandResult send_command(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *input_raw_data, uint16_t seq, int timeout_ms) { 
+CommandResult send_command(int link, uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *input_raw_data, uint16_t seq, int timeout_ms) { 
     CommandResult result = { NULL, 0 };
 
-    if(connect_logic_get_state() <= BLE_INIT_COMPLETE){
+    if(connect_logic_get_link_state(link) <= BLE_INIT_COMPLETE){
         ESP_LOGE(TAG, "BLE not connected");
         return result;
     }
@@ -102,7 +122,7 @@ CommandResult send_command(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, co
     switch (cmd_type) {
         case CMD_NO_RESPONSE:
         case ACK_NO_RESPONSE:
-            ret = data_write_without_response(seq, protocol_frame, frame_length);
+            ret = data_write_without_response(link, seq, protocol_frame, frame_length);
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "Failed to send data frame (no response), error: %s", esp_err_to_name(ret));
                 free(protocol_frame);
@@ -113,7 +133,7 @@ CommandResult send_command(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, co
 
         case CMD_RESPONSE_OR_NOT:
         case ACK_RESPONSE_OR_NOT:
-            ret = data_write_with_response(seq, protocol_frame, frame_length);
+            ret = data_write_with_response(link, seq, protocol_frame, frame_length);
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "Failed to send data frame (with response), error: %s", esp_err_to_name(ret));
                 free(protocol_frame);
@@ -121,7 +141,7 @@ CommandResult send_command(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, co
             }
             ESP_LOGI(TAG, "Data frame sent, waiting for response...");
             
-            ret = data_wait_for_result_by_seq(seq, timeout_ms, &structure_data, &structure_data_length);
+            ret = data_wait_for_result_by_seq(link, seq, timeout_ms, &structure_data, &structure_data_length);
             if (ret != ESP_OK) {
                 ESP_LOGW(TAG, "No result received, but continuing (seq=0x%04X)", seq);
             }
@@ -130,7 +150,7 @@ CommandResult send_command(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, co
 
         case CMD_WAIT_RESULT:
         case ACK_WAIT_RESULT:
-            ret = data_write_with_response(seq, protocol_frame, frame_length);
+            ret = data_write_with_response(link, seq, protocol_frame, frame_length);
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "Failed to send data frame (wait result), error: %s", esp_err_to_name(ret));
                 free(protocol_frame);
@@ -138,7 +158,7 @@ CommandResult send_command(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, co
             }
             ESP_LOGI(TAG, "Data frame sent, waiting for result...");
 
-            ret = data_wait_for_result_by_seq(seq, timeout_ms, &structure_data, &structure_data_length);
+            ret = data_wait_for_result_by_seq(link, seq, timeout_ms, &structure_data, &structure_data_length);
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "Failed to get parse result for seq=0x%04X, error: 0x%x", seq, ret);
                 free(protocol_frame);
@@ -172,20 +192,22 @@ CommandResult send_command(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, co
  * @brief Switch camera mode
  *        切换相机模式
  *
+ * @param link Link of the camera
+ *             相机所在链路
  * @param mode Camera mode
  *             相机模式
  * 
  * @return camera_mode_switch_response_frame_t* Returns parsed structure pointer, NULL on error
  *                                              返回解析后的结构体指针，如果发生错误返回 NULL
  */
-camera_mode_switch_response_frame_t* command_logic_switch_camera_mode(camera_mode_t mode) {
+camera_mode_switch_response_frame_t* command_logic_switch_camera_mode(int link, camera_mode_t mode) {
     ESP_LOGI(TAG, "%s: Switching camera mode to: %d", __FUNCTION__, mode);
-    if (connect_logic_get_state() != PROTOCOL_CONNECTED) {
-        ESP_LOGE(TAG, "Protocol connection to the camera failed. Current connection state: %d", connect_logic_get_state());
+    if (connect_logic_get_link_state(link) != PROTOCOL_CONNECTED) {
+        ESP_LOGE(TAG, "Protocol connection to the camera failed. Current connection state: %d", connect_logic_get_link_state(link));
         return NULL;
     }
 
-    uint16_t seq = generate_seq();
+    uint16_t seq = generate_seq(link);
 
     camera_mode_switch_command_frame_t command_frame = {
         .device_id = 0x33FF0000,
@@ -197,6 +219,7 @@ camera_mode_switch_response_frame_t* command_logic_switch_camera_mode(camera_mod
     ESP_LOGI(TAG, "Constructed command frame: device_id=0x%08X, mode=%d", (unsigned int)command_frame.device_id, command_frame.mode);
 
     CommandResult result = send_command(
+        link,
         0x1D,
         0x04,
         CMD_RESPONSE_OR_NOT,
@@ -227,20 +250,23 @@ camera_mode_switch_response_frame_t* command_logic_switch_camera_mode(camera_mod
  * product ID (`product_id`) and SDK version (`sdk_version`).
  * 返回的版本号信息包括应答结果 (`ack_result`)、产品 ID (`product_id`) 和 SDK 版本号 (`sdk_version`)。
  *
+ * @param link Link of the camera
+ *             相机所在链路
  * @return version_query_response_frame_t* Returns parsed version info structure, NULL on error
  *                                         返回解析后的版本信息结构体，如果发生错误返回 NULL
  */
-version_query_response_frame_t* command_logic_get_version(void) {
+version_query_response_frame_t* command_logic_get_version(int link) {
     ESP_LOGI(TAG, "%s: Querying device version", __FUNCTION__);
     
-    if (connect_logic_get_state() != PROTOCOL_CONNECTED) {
-        ESP_LOGE(TAG, "Protocol connection to the camera failed. Current connection state: %d", connect_logic_get_state());
+    if (connect_logic_get_link_state(link) != PROTOCOL_CONNECTED) {
+        ESP_LOGE(TAG, "Protocol connection to the camera failed. Current connection state: %d", connect_logic_get_link_state(link));
         return NULL;
     }
 
-    uint16_t seq = generate_seq();
+    uint16_t seq = generate_seq(link);
 
     CommandResult result = send_command(
+        link,
         0x00,
         0x00,
         CMD_WAIT_RESULT,
@@ -264,22 +290,47 @@ version_query_response_frame_t* command_logic_get_version(void) {
     return response;
 }
 
+/**
+ * @brief Build a start or stop recording frame without sending it, for sends at a precise time
+ *        构建开始或停止录制的帧但不发送，用于在精确时刻发送
+ *
+ * @param start true to start recording, false to stop
+ *              true 为开始录制，false 为停止录制
+ * @param seq Sequence number of the frame
+ *            帧序列号
+ * @param frame_length Output frame length
+ *                     输出的帧长度
+ * @return uint8_t* Frame to send with data_write_with_response() and free, NULL on error
+ *                  需通过 data_write_with_response() 发送并释放的帧，出错返回 NULL
+ */
+uint8_t* command_logic_create_record_frame(bool start, uint16_t seq, size_t *frame_length) {
+    record_control_command_frame_t command_frame = {
+        .device_id = 0x33FF0000,
+        .record_ctrl = start ? 0x00 : 0x01,
+        .reserved = {0x00, 0x00, 0x00, 0x00}
+    };
+
+    return protocol_create_frame(0x1D, 0x03, CMD_RESPONSE_OR_NOT, &command_frame, seq, frame_length);
+}
+
 /**
  * @brief Start recording
  *        开始录制
  *
+ * @param link Link of the camera
+ *             相机所在链路
  * @return record_control_response_frame_t* Returns parsed response structure pointer, NULL on error
  *                                          返回解析后的应答结构体指针，如果发生错误返回 NULL
  */
-record_control_response_frame_t* command_logic_start_record(void) {
+record_control_response_frame_t* command_logic_start_record(int link) {
     ESP_LOGI(TAG, "%s: Starting recording", __FUNCTION__);
 
-    if (connect_logic_get_state() != PROTOCOL_CONNECTED) {
-        ESP_LOGE(TAG, "Protocol connection to the camera failed. Current connection state: %d", connect_logic_get_state());
+    if (connect_logic_get_link_state(link) != PROTOCOL_CONNECTED) {
+        ESP_LOGE(TAG, "Protocol connection to the camera failed. Current connection state: %d", connect_logic_get_link_state(link));
         return NULL;
     }
 
-    uint16_t seq = generate_seq();
+    uint16_t seq = generate_seq(link);
 
     record_control_command_frame_t command_frame = {
         .device_id = 0x33FF0000,
@@ -288,6 +339,7 @@ record_control_response_frame_t* command_logic_start_record(void) {
     };
 
     CommandResult result = send_command(
+        link,
         0x1D,
         0x03,
         CMD_RESPONSE_OR_NOT,
@@ -312,18 +364,20 @@ record_control_response_frame_t* command_logic_start_record(void) {
  * @brief Stop recording
  *        停止录制
  *
+ * @param link Link of the camera
+ *             相机所在链路
  * @return record_control_response_frame_t* Returns parsed response structure pointer, NULL on error
  *                                          返回解析后的应答结构体指针，如果发生错误返回 NULL
  */
-record_control_response_frame_t* command_logic_stop_record(void) {
+record_control_response_frame_t* command_logic_stop_record(int link) {
     ESP_LOGI(TAG, "%s: Stopping recording", __FUNCTION__);
 
-    if (connect_logic_get_state() != PROTOCOL_CONNECTED) {
-        ESP_LOGE(TAG, "Protocol connection to the camera failed. Current connection state: %d", connect_logic_get_state());
+    if (connect_logic_get_link_state(link) != PROTOCOL_CONNECTED) {
+        ESP_LOGE(TAG, "Protocol connection to the camera failed. Current connection state: %d", connect_logic_get_link_state(link));
         return NULL;
     }
 
-    uint16_t seq = generate_seq();
+    uint16_t seq = generate_seq(link);
 
     record_control_command_frame_t command_frame = {
         .device_id = 0x33FF0000,
@@ -332,6 +386,7 @@ record_control_response_frame_t* command_logic_stop_record(void) {
     };
 
     CommandResult result = send_command(
+        link,
         0x1D,
         0x03,
         CMD_RESPONSE_OR_NOT,
@@ -353,64 +408,72 @@ record_control_response_frame_t* command_logic_stop_record(void) {
 }
 
 /**
- * @brief Push GPS data
- *        推送 GPS 数据
+ * @brief Push GPS data to every protocol connected camera
+ *        向所有已完成协议连接的相机推送 GPS 数据
+ *
+ * The frame is encoded once with a shared seq and the same buffer is written to each link,
+ * so the cost per fix is one encode plus one BLE write per camera.
+ * 帧只编码一次并使用共享的 seq，同一缓冲区写往每条链路，因此每个定位的开销为一次编码加每台相机一次 BLE 写入。
  *
  * @param gps_data Pointer to structure containing GPS data
  *                 指向包含 GPS 数据的结构体
  * 
- * @return gps_data_push_response_frame* Returns parsed response structure pointer, NULL on error
- *                                       返回解析后的应答结构体指针，如果发生错误返回 NULL
+ * @return int Number of cameras the frame was written to, -1 on error
+ *             成功写入的相机数量，出错返回 -1
  */
-gps_data_push_response_frame* command_logic_push_gps_data(const gps_data_push_command_frame *gps_data) {
-    ESP_LOGI(TAG, "Pushing GPS data");
+int command_logic_push_gps_data(const gps_data_push_command_frame *gps_data) {
+    if (gps_data == NULL) {
+        ESP_LOGE(TAG, "Invalid input: gps_data is NULL");
+        return -1;
+    }
 
     // Check connection status
     // 检查连接状态
-    if (connect_logic_get_state() != PROTOCOL_CONNECTED) {
+    uint32_t links = connect_logic_get_protocol_links();
+    if (links == 0) {
         ESP_LOGE(TAG, "Protocol connection to the camera failed. Current connection state: %d", connect_logic_get_state());
-        return NULL;
+        return -1;
     }
 
-    if (gps_data == NULL) {
-        ESP_LOGE(TAG, "Invalid input: gps_data is NULL");
-        return NULL;
+    size_t frame_length = 0;
+    uint8_t *protocol_frame = protocol_create_frame(0x00, 0x17, CMD_NO_RESPONSE, gps_data, ++s_broadcast_seq, &frame_length);
+    if (protocol_frame == NULL) {
+        ESP_LOGE(TAG, "Failed to create protocol frame");
+        return -1;
     }
 
-    uint16_t seq = generate_seq();
-
-    // Send command and receive response
-    // 发送命令并接收应答
-    CommandResult result = send_command(
-        0x00,
-        0x17,
-        CMD_NO_RESPONSE,
-        gps_data,
-        seq,
-        5000
-    );
+    // 繁忙的链路拒绝写入时跳过本次定位，由下一次定位替代，不会拖慢其他相机
+    // A busy link refuses the write and skips this fix, the next one replaces it without holding up the other cameras
+    int sent = 0;
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        if ((links & (1u << link)) &&
+            data_write_without_response(link, s_broadcast_seq, protocol_frame, frame_length) == ESP_OK) {
+            sent++;
+        }
+    }
+    free(protocol_frame);
 
-    // Return response structure pointer
-    // 返回应答结构体指针
-    return (gps_data_push_response_frame *)result.structure;
+    return sent;
 }
 
 /**
  * @brief Quick switch mode key report
  *        快速切换模式按键上报
  *
+ * @param link Link of the camera
+ *             相机所在链路
  * @return key_report_response_frame_t* Returns parsed response structure pointer, NULL on error
  *                                      返回解析后的应答结构体指针，如果发生错误返回 NULL
  */
-key_report_response_frame_t* command_logic_key_report_qs(void) {
+key_report_response_frame_t* command_logic_key_report_qs(int link) {
     ESP_LOGI(TAG, "%s: Reporting key press for mode switch", __FUNCTION__);
 
-    if (connect_logic_get_state() != PROTOCOL_CONNECTED) {
-        ESP_LOGE(TAG, "Protocol connection to the camera failed. Current connection state: %d", connect_logic_get_state());
+    if (connect_logic_get_link_state(link) != PROTOCOL_CONNECTED) {
+        ESP_LOGE(TAG, "Protocol connection to the camera failed. Current connection state: %d", connect_logic_get_link_state(link));
         return NULL;
     }
 
-    uint16_t seq = generate_seq();
+    uint16_t seq = generate_seq(link);
 
     key_report_command_frame_t command_frame = {
         .key_code = 0x02,          // QS key code for mode switch
@@ -422,6 +485,7 @@ key_report_response_frame_t* command_logic_key_report_qs(void) {
     };
 
     CommandResult result = send_command(
+        link,
         0x00,
         0x11,
         CMD_RESPONSE_OR_NOT,
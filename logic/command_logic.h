@@ -26,7 +26,7 @@
 
 #include "dji_protocol_data_structures.h"
 
-uint16_t generate_seq(void);
+uint16_t generate_seq(int link);
 
 typedef struct {
     void *structure;
@@ -34,18 +34,20 @@ typedef struct {
                     // 这里的长度并不是 structure 长度，而是 DATA 段除去 CmdSet 和 CmdID 的长度
 } CommandResult;
 
-CommandResult send_command(uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *structure, uint16_t seq, int timeout_ms);
+CommandResult send_command(int link, uint8_t cmd_set, uint8_t cmd_id, uint8_t cmd_type, const void *structure, uint16_t seq, int timeout_ms);
 
-camera_mode_switch_response_frame_t* command_logic_switch_camera_mode(camera_mode_t mode);
+camera_mode_switch_response_frame_t* command_logic_switch_camera_mode(int link, camera_mode_t mode);
 
-version_query_response_frame_t* command_logic_get_version(void);
+version_query_response_frame_t* command_logic_get_version(int link);
 
-record_control_response_frame_t* command_logic_start_record(void);
+uint8_t* command_logic_create_record_frame(bool start, uint16_t seq, size_t *frame_length);
 
-record_control_response_frame_t* command_logic_stop_record(void);
+record_control_response_frame_t* command_logic_start_record(int link);
 
-gps_data_push_response_frame* command_logic_push_gps_data(const gps_data_push_command_frame *gps_data);
+record_control_response_frame_t* command_logic_stop_record(int link);
 
-key_report_response_frame_t* command_logic_key_report_qs(void);
+int command_logic_push_gps_data(const gps_data_push_command_frame *gps_data);
+
+key_report_response_frame_t* command_logic_key_report_qs(int link);
 
 #endif
@@ -22,29 +22,253 @@
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
 #include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
 
-#include "ble.h"
+#include "ble_transport.h"
 #include "data.h"
 #include "enums_logic.h"
 #include "connect_logic.h"
 #include "command_logic.h"
 #include "status_logic.h"
+#include "pairing_logic.h"
 #include "dji_protocol_data_structures.h"
 
 #define TAG "LOGIC_CONNECT"
 
-static connect_state_t connect_state = BLE_NOT_INIT;
+static bool s_ble_initialized = false;
+
+/* Background reconnection after an unexpected disconnect */
+/* 意外断开后的后台重连 */
+static TaskHandle_t s_reconnect_task = NULL;
+static SemaphoreHandle_t s_connect_mutex = NULL;   // Serializes key-driven and background connects, one scan at a time
+
+/* Periodic activity check that picks the link profile */
+/* 周期性检查活动并选择链路配置 */
+static TimerHandle_t s_profile_timer = NULL;
+
+/* Parameters of the protocol handshake */
+/* 协议握手的参数 */
+typedef struct {
+    uint32_t device_id;
+    uint8_t mac_addr_len;
+    int8_t mac_addr[16];
+    uint32_t fw_version;
+    uint8_t verify_mode;        // verify_mode_t
+    uint16_t verify_data;
+    uint8_t camera_reserved;
+} protocol_params_t;
+
+/* Connection state of each camera link */
+/* 每条相机链路的连接状态 */
+typedef struct {
+    volatile connect_state_t state;
+    volatile bool auto_reconnect;     // Armed by a protocol connect, cleared by a user disconnect
+    volatile bool reconnect_pending;  // Unexpected disconnect waiting for the reconnect task
+
+    /* Owned by the reconnect task */
+    /* 由重连任务维护 */
+    bool reconnecting;                // Backoff schedule running
+    int attempt;                      // Attempts made so far
+    TickType_t next_attempt;          // Tick of the next attempt
+    int64_t reconnect_start_us;
+
+    int64_t connect_start_us;         // Start of the current connect, for the time to PROTOCOL_CONNECTED
+
+    /* Link profile, owned by the profile timer once the link is up */
+    /* 链路配置，链路建立后由配置定时器维护 */
+    volatile bool profile_set;        // A profile was applied on the current connection
+    ble_link_profile_t profile;
+    TickType_t last_active;           // Last check that saw activity
+    uint32_t profile_writes;          // Write count of the data layer at the last check
+
+    /* Protocol connection parameters of the last successful connect, replayed on reconnect */
+    /* 最近一次成功连接的协议参数，重连时重新使用 */
+    protocol_params_t protocol_params;
+
+    /* Reconnections in a row the camera left unanswered, see connect_logic_update_pairing() */
+    /* 相机连续未应答的重连次数，见 connect_logic_update_pairing() */
+    uint8_t pairing_timeouts;
+    uint8_t pairing_timeout_addr[6];  // Camera the count belongs to
+} link_state_t;
+
+static link_state_t s_link_states[BLE_MAX_LINKS];
+
+/* Steps of bringing the BLE link up */
+/* 建立 BLE 链路的各步骤 */
+typedef enum {
+    LINK_STEP_CONNECT = 0,     // Scan and connect
+    LINK_STEP_DISCOVER,        // Characteristic handles (discovered or cached)
+    LINK_STEP_ENABLE_NOTIFY,   // Notification enabled on the camera
+    LINK_STEP_READY,
+} link_step_t;
+
+/* How a protocol handshake ended, decides what happens to the stored pairing */
+/* 协议握手的结束方式，决定已保存配对结果的去留 */
+typedef enum {
+    HANDSHAKE_ACCEPTED = 0,    // The camera approved the remote
+    HANDSHAKE_REJECTED,        // The camera answered with a reject
+    HANDSHAKE_UNEXPECTED,      // The camera answered with an unexpected verify_mode
+    HANDSHAKE_TIMEOUT,         // No answer in time, or the link was lost
+} handshake_result_t;
+
+typedef struct {
+    EventBits_t done;          // BLE event completing the step
+    int timeout_ms;            // Deadline of the step, LINK_STEP_CONNECT uses the caller's
+    const char *name;
+} link_step_info_t;
+
+static const link_step_info_t s_link_steps[LINK_STEP_READY] = {
+    [LINK_STEP_CONNECT]       = {BLE_EVENT_CONNECTED,      0,     "BLE connect"},
+    [LINK_STEP_DISCOVER]      = {BLE_EVENT_HANDLES_READY,  30000, "Handle discovery"},
+    [LINK_STEP_ENABLE_NOTIFY] = {BLE_EVENT_NOTIFY_ENABLED, 5000,  "Notify enable"},
+};
+
+static int connect_logic_close_link(int link);
+
+static bool is_link_valid(int link) {
+    return link >= 0 && link < BLE_MAX_LINKS;
+}
+
+/* Whether the transport link is up, BLE_EVENT_CONNECTED is cleared on disconnect */
+/* 传输层链路是否已连接，BLE_EVENT_CONNECTED 在断开时被清除 */
+static bool connect_logic_link_up(int link) {
+    return (ble_transport_wait_events(link, BLE_EVENT_CONNECTED, 0) & BLE_EVENT_CONNECTED) != 0;
+}
+
+/**
+ * @brief Apply a link profile when it differs from the current one
+ *        链路配置与当前不同时应用新配置
+ *
+ * @param link Link to tune
+ *             要调整的链路
+ * @param profile Profile to apply
+ *                要应用的配置
+ */
+static void connect_logic_apply_profile(int link, ble_link_profile_t profile) {
+    link_state_t *l = &s_link_states[link];
+    if (l->profile_set && l->profile == profile) {
+        return;
+    }
+    esp_err_t ret = ble_transport_set_link_profile(link, profile);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Link %d failed to apply %s profile: %s", link,
+                 ble_transport_get_link_params(profile)->name, esp_err_to_name(ret));
+        return;
+    }
+    ESP_LOGI(TAG, "Link %d switched to %s profile", link, ble_transport_get_link_params(profile)->name);
+    l->profile = profile;
+    l->profile_set = true;
+}
+
+/**
+ * @brief Profile timer, keeps busy links on the low-latency profile and lets idle ones drop to low power
+ *        配置定时器，繁忙链路保持低延迟配置，空闲链路降为低功耗配置
+ *
+ * A link is busy while its camera records, a command waits for a response or GPS data is pushed faster than
+ * the keepalive. It drops to low power after PROFILE_IDLE_MS without activity and comes back on the next check
+ * that sees some, so the first command after a quiet spell still pays the low-power latency once.
+ * 相机录像、有等待响应的命令或 GPS 推送快于保活频率时链路为繁忙。连续 PROFILE_IDLE_MS 无活动后降为低功耗，
+ * 下一次检测到活动时恢复，因此空闲后的第一条命令仍会承受一次低功耗配置的延迟。
+ *
+ * @param timer Timer handle
+ *              定时器句柄
+ */
+static void connect_logic_profile_timer(TimerHandle_t timer) {
+    TickType_t now = xTaskGetTickCount();
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        link_state_t *l = &s_link_states[link];
+        if (!l->profile_set || (l->state != BLE_CONNECTED && l->state != PROTOCOL_CONNECTED)) {
+            continue;
+        }
+
+        data_link_activity_t activity;
+        data_get_link_activity(link, &activity);
+        bool active = is_link_camera_recording(link) ||
+                      (TickType_t)(now - activity.last_command_tick) < pdMS_TO_TICKS(PROFILE_CHECK_PERIOD_MS) ||
+                      activity.writes - l->profile_writes >= PROFILE_ACTIVE_WRITES;
+        l->profile_writes = activity.writes;
+        if (active) {
+            l->last_active = now;
+        }
+
+        bool idle = (TickType_t)(now - l->last_active) >= pdMS_TO_TICKS(PROFILE_IDLE_MS);
+        connect_logic_apply_profile(link, idle ? BLE_LINK_PROFILE_LOW_POWER : BLE_LINK_PROFILE_LOW_LATENCY);
+    }
+}
+
+/**
+ * @brief Order of the states when reporting the overall state, the most advanced link wins
+ *        汇总状态时各状态的先后，取进展最靠前的链路
+ */
+static int connect_state_rank(connect_state_t state) {
+    switch (state) {
+        case PROTOCOL_CONNECTED: return 4;
+        case BLE_CONNECTED:      return 3;
+        case BLE_SEARCHING:      return 2;
+        case BLE_DISCONNECTING:  return 1;
+        default:                 return 0;
+    }
+}
 
 /**
  * @brief Get current connection state
  *        获取当前连接状态
  * 
+ * With several cameras this is the most advanced state over all links, so PROTOCOL_CONNECTED
+ * means at least one camera is ready.
+ * 连接多台相机时返回所有链路中进展最靠前的状态，因此 PROTOCOL_CONNECTED 表示至少一台相机就绪。
+ * 
  * @return connect_state_t Returns current connection state
  *                        返回当前的连接状态
  */
 connect_state_t connect_logic_get_state(void) {
-    return connect_state;
+    if (!s_ble_initialized) {
+        return BLE_NOT_INIT;
+    }
+    connect_state_t state = BLE_INIT_COMPLETE;
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        if (connect_state_rank(s_link_states[link].state) > connect_state_rank(state)) {
+            state = s_link_states[link].state;
+        }
+    }
+    return state;
+}
+
+/**
+ * @brief Get the connection state of one camera link
+ *        获取单条相机链路的连接状态
+ *
+ * @param link Link index
+ *             链路序号
+ * @return connect_state_t Connection state of the link
+ *                         链路的连接状态
+ */
+connect_state_t connect_logic_get_link_state(int link) {
+    if (!s_ble_initialized || !is_link_valid(link)) {
+        return BLE_NOT_INIT;
+    }
+    return s_link_states[link].state;
+}
+
+/**
+ * @brief Get the links whose camera is protocol connected
+ *        获取相机已完成协议连接的链路
+ *
+ * @return uint32_t Bit n set when link n is PROTOCOL_CONNECTED
+ *                  链路 n 为 PROTOCOL_CONNECTED 时第 n 位置 1
+ */
+uint32_t connect_logic_get_protocol_links(void) {
+    uint32_t links = 0;
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        if (s_link_states[link].state == PROTOCOL_CONNECTED) {
+            links |= 1u << link;
+        }
+    }
+    return links;
 }
 
 /**
@@ -52,57 +276,242 @@ connect_state_t connect_logic_get_state(void) {
  *        处理相机断开连接（回调函数）
  * 
  * Perform operations according to current connection state and reset connection state to BLE initialization complete (BLE_INIT_COMPLETE).
+ * An unexpected disconnect only wakes the reconnect task, this runs inside the GATTC callback and must not block.
  * 根据当前连接状态进行相应的操作，并将连接状态重置为 BLE 初始化完成（BLE_INIT_COMPLETE）。
+ * 意外断开时只唤醒重连任务，此函数运行在 GATTC 回调中，不能阻塞。
+ *
+ * @param link Link that was disconnected
+ *             断开的链路
  */
-void receive_camera_disconnect_handler() {
-    switch (connect_state) {
+void receive_camera_disconnect_handler(int link) {
+    if (!is_link_valid(link)) {
+        return;
+    }
+    link_state_t *l = &s_link_states[link];
+    l->profile_set = false;
+
+    switch (l->state) {
         case BLE_SEARCHING:
+            // A reconnect attempt lost its link, the attempt fails and is retried
+            // 重连尝试中链路断开，本次尝试失败后会重试
             break;
         case BLE_INIT_COMPLETE:
-            ESP_LOGI(TAG, "Already in DISCONNECTED state.");
+            ESP_LOGI(TAG, "Link %d already in DISCONNECTED state.", link);
             break;
         case BLE_DISCONNECTING: {
-            ESP_LOGI(TAG, "Normal disconnection process.");
+            ESP_LOGI(TAG, "Link %d normal disconnection process.", link);
             // Normal disconnection also needs to reset state
             // 正常断开也需要重置状态
-            connect_state = BLE_INIT_COMPLETE;
-            camera_status_initialized = false;
-            ESP_LOGI(TAG, "Current state: DISCONNECTED.");
+            l->state = BLE_INIT_COMPLETE;
+            status_logic_reset_link(link);
+            ESP_LOGI(TAG, "Link %d current state: DISCONNECTED.", link);
             break;
         }
         case BLE_CONNECTED:
         case PROTOCOL_CONNECTED:
         default: {
-            ESP_LOGW(TAG, "Unexpected disconnection from state: %d, attempting reconnection...", connect_state);
-            
-            // Try to reconnect once
-            // 尝试重连一次
-            bool reconnected = false;
-            ESP_LOGI(TAG, "Reconnection attempt...");
-            if (ble_reconnect() == ESP_OK) {
-                // Wait for reconnection result
-                // 等待重连结果
-                for (int j = 0; j < 30; j++) { // Wait for 3 seconds
-                                              // 等待3秒
-                    if (s_ble_profile.connection_status.is_connected) {
-                        ESP_LOGI(TAG, "Reconnection successful");
-                        reconnected = true;
-                        return;  // 重连成功，直接返回
-                    }
-                    vTaskDelay(pdMS_TO_TICKS(100));
+            ESP_LOGW(TAG, "Link %d unexpected disconnection from state: %d", link, l->state);
+            l->state = BLE_INIT_COMPLETE;
+            status_logic_reset_link(link);
+            if (!l->auto_reconnect) {
+                ESP_LOGI(TAG, "Link %d current state: DISCONNECTED.", link);
+                break;
+            }
+
+            // This runs in the GATTC callback, hand the reconnection to the reconnect task
+            // 此处运行在 GATTC 回调中，重连交给重连任务处理
+            ESP_LOGW(TAG, "Link %d unexpected disconnection, reconnecting in the background", link);
+            l->state = BLE_SEARCHING;
+            l->reconnect_pending = true;
+            xTaskNotifyGive(s_reconnect_task);
+            break;
+        }
+    }
+}
+
+static int connect_logic_wait_ready(int link, int connect_timeout_ms);
+
+/**
+ * @brief End the background reconnection of a link that is no longer armed
+ *        结束已不再启用的链路的后台重连
+ *
+ * An unexpected disconnect leaves the link in BLE_SEARCHING for the reconnect task. When a user
+ * disconnect or the attempt limit stops the schedule, the link goes back to BLE_INIT_COMPLETE so
+ * connect_logic_ble_connect() accepts it again. Taken under s_connect_mutex, a key-driven connect in
+ * BLE_SEARCHING holds it and is left alone.
+ * 意外断开后链路停留在 BLE_SEARCHING 等待重连任务。主动断开或达到尝试次数上限结束重连时，链路回到
+ * BLE_INIT_COMPLETE，使 connect_logic_ble_connect() 可以再次使用。在 s_connect_mutex 下进行，
+ * 处于 BLE_SEARCHING 的按键连接持有该锁，不受影响。
+ *
+ * @param link Link whose reconnection ended
+ *             结束重连的链路
+ */
+static void connect_logic_end_reconnect(int link) {
+    link_state_t *l = &s_link_states[link];
+
+    xSemaphoreTake(s_connect_mutex, portMAX_DELAY);
+    l->reconnecting = false;
+    if (!l->auto_reconnect && l->state == BLE_SEARCHING) {
+        l->state = BLE_INIT_COMPLETE;
+    }
+    xSemaphoreGive(s_connect_mutex);
+}
+
+/**
+ * @brief Backoff before a reconnect attempt, exponential with jitter
+ *        重连尝试前的退避时间，指数增长并带随机抖动
+ *
+ * The delay doubles from RECONNECT_BASE_DELAY_MS up to RECONNECT_MAX_DELAY_MS and is drawn
+ * uniformly from its upper half, so controllers dropped together do not retry in step.
+ * 延迟从 RECONNECT_BASE_DELAY_MS 起倍增至 RECONNECT_MAX_DELAY_MS，并在其上半区间内均匀取值，
+ * 避免同时掉线的多台控制器同步重试。
+ *
+ * @param attempt Attempt number, from 0
+ *                尝试次数，从 0 开始
+ * @return uint32_t Delay in milliseconds
+ *                  延迟毫秒数
+ */
+static uint32_t connect_logic_backoff_ms(int attempt) {
+    uint32_t delay_ms = RECONNECT_MAX_DELAY_MS;
+    if (attempt < 16 && ((uint32_t)RECONNECT_BASE_DELAY_MS << attempt) < RECONNECT_MAX_DELAY_MS) {
+        delay_ms = (uint32_t)RECONNECT_BASE_DELAY_MS << attempt;
+    }
+    return delay_ms / 2 + esp_random() % (delay_ms / 2 + 1);
+}
+
+/**
+ * @brief One reconnect attempt: link, handles, protocol handshake and status subscription
+ *        一次重连尝试：链路、句柄、协议握手与状态订阅
+ *
+ * @param link Link to reconnect
+ *             要重连的链路
+ * @return int Returns 0 on success, -1 on failure
+ *             成功返回 0，失败返回 -1
+ */
+static int connect_logic_reconnect_once(int link) {
+    link_state_t *l = &s_link_states[link];
+
+    xSemaphoreTake(s_connect_mutex, portMAX_DELAY);
+    if (!l->auto_reconnect) {
+        if (l->state == BLE_SEARCHING) {
+            l->state = BLE_INIT_COMPLETE;
+        }
+        xSemaphoreGive(s_connect_mutex);
+        return -1;
+    }
+
+    /* Scan for the previous camera (3 s) and connect to it */
+    /* 扫描上一次连接的相机（3 秒）并连接 */
+    l->state = BLE_SEARCHING;
+    l->connect_start_us = esp_timer_get_time();
+    ble_transport_clear_events(link, BLE_EVENT_DISCONNECTED | BLE_EVENT_SCAN_FAILED | BLE_EVENT_OPEN_FAILED | BLE_EVENT_GATT_FAILED);
+    if (ble_transport_open(link, true) != ESP_OK || connect_logic_wait_ready(link, 6000) != 0) {
+        if (connect_logic_link_up(link)) {
+            connect_logic_close_link(link);
+        }
+        // A user disconnect during the attempt ends the reconnection here
+        // 尝试期间的主动断开在此结束重连
+        l->state = l->auto_reconnect ? BLE_SEARCHING : BLE_INIT_COMPLETE;
+        xSemaphoreGive(s_connect_mutex);
+        return -1;
+    }
+    l->state = BLE_CONNECTED;
+
+    /* Redo the protocol handshake and the status subscription of the lost connection */
+    /* 重新进行协议握手并恢复状态订阅 */
+    int ret = connect_logic_protocol_connect(link, l->protocol_params.device_id, l->protocol_params.mac_addr_len,
+                                             l->protocol_params.mac_addr, l->protocol_params.fw_version,
+                                             l->protocol_params.verify_mode, l->protocol_params.verify_data,
+                                             l->protocol_params.camera_reserved);
+    if (ret == 0) {
+        ret = subscript_camera_status(link, PUSH_MODE_PERIODIC_WITH_STATE_CHANGE, PUSH_FREQ_10HZ);
+    }
+    if (ret != 0 && connect_logic_link_up(link)) {
+        connect_logic_close_link(link);
+    }
+    if (ret != 0) {
+        l->state = l->auto_reconnect ? BLE_SEARCHING : BLE_INIT_COMPLETE;
+    }
+    xSemaphoreGive(s_connect_mutex);
+    return ret;
+}
+
+/**
+ * @brief Reconnect task, recovers camera connections after unexpected disconnects
+ *        重连任务，意外断开后恢复相机连接
+ *
+ * Woken by receive_camera_disconnect_handler(). Each link keeps its own backoff schedule from
+ * connect_logic_backoff_ms(), a camera that is away does not delay the others. A link gives up
+ * after RECONNECT_MAX_ATTEMPTS or on an explicit connect_logic_ble_disconnect().
+ * 由 receive_camera_disconnect_handler() 唤醒。每条链路按 connect_logic_backoff_ms() 维护各自的退避计划，
+ * 离开的相机不会拖慢其他相机。达到 RECONNECT_MAX_ATTEMPTS 次或调用 connect_logic_ble_disconnect() 主动断开时停止。
+ *
+ * @param arg 任务参数
+ *            Task parameters
+ */
+static void connect_logic_reconnect_task(void *arg) {
+    while (1) {
+        TickType_t now = xTaskGetTickCount();
+        TickType_t wait = portMAX_DELAY;
+        int due = -1;
+
+        for (int link = 0; link < BLE_MAX_LINKS; link++) {
+            link_state_t *l = &s_link_states[link];
+
+            if (l->reconnect_pending) {
+                l->reconnect_pending = false;
+                if (!l->auto_reconnect) {
+                    connect_logic_end_reconnect(link);
+                } else if (!l->reconnecting) {
+                    l->reconnecting = true;
+                    l->attempt = 0;
+                    l->reconnect_start_us = esp_timer_get_time();
+                    uint32_t delay_ms = connect_logic_backoff_ms(0);
+                    l->next_attempt = now + pdMS_TO_TICKS(delay_ms);
+                    ESP_LOGI(TAG, "Link %d reconnect attempt 1 in %lu ms", link, (unsigned long)delay_ms);
                 }
             }
+            if (l->reconnecting && !l->auto_reconnect) {
+                // Only a user disconnect ends the schedule early
+                // 只有主动断开会提前结束重连计划
+                ESP_LOGI(TAG, "Link %d reconnection cancelled by disconnect", link);
+                connect_logic_end_reconnect(link);
+            }
+            if (!l->reconnecting) {
+                continue;
+            }
 
-            if (!reconnected) {
-                ESP_LOGE(TAG, "Reconnection failed after 1 attempts");
-                // Reconnection failed, execute disconnection logic
-                // 重连失败，执行断开逻辑
-                connect_state = BLE_INIT_COMPLETE;
-                camera_status_initialized = false;
-                ble_disconnect();
-                ESP_LOGI(TAG, "Current state: DISCONNECTED.");
+            int32_t remaining = (int32_t)(l->next_attempt - now);
+            if (remaining <= 0) {
+                due = link;
+                break;
             }
-            break;
+            if ((TickType_t)remaining < wait) {
+                wait = (TickType_t)remaining;
+            }
+        }
+
+        if (due < 0) {
+            ulTaskNotifyTake(pdTRUE, wait);
+            continue;
+        }
+
+        link_state_t *l = &s_link_states[due];
+        if (connect_logic_reconnect_once(due) == 0) {
+            ESP_LOGI(TAG, "Link %d reconnected after %d attempt(s) in %lld ms", due, l->attempt + 1,
+                     (long long)((esp_timer_get_time() - l->reconnect_start_us) / 1000));
+            l->reconnecting = false;
+        } else if (!l->auto_reconnect) {
+            ESP_LOGI(TAG, "Link %d reconnection cancelled by disconnect", due);
+            connect_logic_end_reconnect(due);
+        } else if (++l->attempt >= RECONNECT_MAX_ATTEMPTS) {
+            ESP_LOGE(TAG, "Link %d reconnection failed after %d attempts", due, l->attempt);
+            l->auto_reconnect = false;
+            connect_logic_end_reconnect(due);
+        } else {
+            uint32_t delay_ms = connect_logic_backoff_ms(l->attempt);
+            l->next_attempt = xTaskGetTickCount() + pdMS_TO_TICKS(delay_ms);
+            ESP_LOGI(TAG, "Link %d reconnect attempt %d in %lu ms", due, l->attempt + 1, (unsigned long)delay_ms);
         }
     }
 }
@@ -122,103 +531,202 @@ int connect_logic_ble_init() {
 
     /* 1. Initialize BLE (specify target device name to search and connect)
      * 1. 初始化 BLE（指定要搜索并连接的目标设备名） */
-    ret = ble_init();
+    ret = ble_transport_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize BLE, error: %s", esp_err_to_name(ret));
         return -1;
     }
 
-    connect_state = BLE_INIT_COMPLETE;
+    s_connect_mutex = xSemaphoreCreateMutex();
+    if (s_connect_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create connect mutex");
+        return -1;
+    }
+    if (xTaskCreate(connect_logic_reconnect_task, "reconnect_task", 4096, NULL, RECONNECT_TASK_PRIORITY, &s_reconnect_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create reconnect task");
+        return -1;
+    }
+    s_profile_timer = xTimerCreate("profile_timer", pdMS_TO_TICKS(PROFILE_CHECK_PERIOD_MS), pdTRUE, NULL,
+                                   connect_logic_profile_timer);
+    if (s_profile_timer == NULL || xTimerStart(s_profile_timer, 0) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start profile timer");
+        return -1;
+    }
+
+    /* Set a global Notify callback for receiving remote data and protocol parsing */
+    /* 设置一个全局 Notify 回调，用于接收远端数据并进行协议解析 */
+    ble_transport_set_notify_callback(receive_camera_notify_handler);
+    ble_transport_set_state_callback(receive_camera_disconnect_handler);
+
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        s_link_states[link].state = BLE_INIT_COMPLETE;
+    }
+    s_ble_initialized = true;
     ESP_LOGI(TAG, "BLE init successfully");
     return 0;
 }
 
+/**
+ * @brief Bring the link up step by step, each step advancing on its BLE event
+ *        逐步建立链路，每一步在其 BLE 事件到达时推进
+ *
+ * Every step has its own deadline, a failure event or a lost link ends the wait at once.
+ * Once ready the link gets the low-latency profile for the handshake that follows.
+ * 每一步都有独立的截止时间，失败事件或链路断开会立即结束等待。
+ * 就绪后链路使用低延迟配置，以完成随后的协议握手。
+ *
+ * @param link Link being brought up
+ *             正在建立的链路
+ * @param connect_timeout_ms Deadline of the connect step
+ *                           连接步骤的截止时间
+ * @return int Returns 0 on success, -1 on failure
+ *             成功返回 0，失败返回 -1
+ */
+static int connect_logic_wait_ready(int link, int connect_timeout_ms) {
+    link_step_t step = LINK_STEP_CONNECT;
+    TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(connect_timeout_ms);
+    int64_t step_start_us = esp_timer_get_time();
+
+    while (step != LINK_STEP_READY) {
+        const link_step_info_t *info = &s_link_steps[step];
+        EventBits_t fail = BLE_EVENT_GATT_FAILED |
+                           (step == LINK_STEP_CONNECT ? BLE_EVENT_SCAN_FAILED | BLE_EVENT_OPEN_FAILED : BLE_EVENT_DISCONNECTED);
+
+        TickType_t now = xTaskGetTickCount();
+        TickType_t wait = (int32_t)(deadline - now) > 0 ? deadline - now : 0;
+        EventBits_t bits = ble_transport_wait_events(link, info->done | fail, wait);
+        if (bits & fail) {
+            ESP_LOGW(TAG, "Link %d %s failed (events 0x%lx)", link, info->name, (unsigned long)bits);
+            return -1;
+        }
+        if (!(bits & info->done)) {
+            ESP_LOGW(TAG, "Link %d %s timed out", link, info->name);
+            return -1;
+        }
+
+        int64_t now_us = esp_timer_get_time();
+        ESP_LOGI(TAG, "Link %d %s done in %lld ms", link, info->name, (long long)((now_us - step_start_us) / 1000));
+        step_start_us = now_us;
+
+        if (step == LINK_STEP_DISCOVER) {
+            esp_err_t ret = ble_transport_enable_notify(link);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to register notify, error: %s", esp_err_to_name(ret));
+                return -1;
+            }
+        }
+        step++;
+        if (step != LINK_STEP_READY) {
+            deadline = xTaskGetTickCount() + pdMS_TO_TICKS(s_link_steps[step].timeout_ms);
+        }
+    }
+
+    link_state_t *l = &s_link_states[link];
+    data_link_activity_t activity;
+    data_get_link_activity(link, &activity);
+    l->profile_set = false;
+    l->last_active = xTaskGetTickCount();
+    l->profile_writes = activity.writes;
+    connect_logic_apply_profile(link, BLE_LINK_PROFILE_LOW_LATENCY);
+    return 0;
+}
+
 /**
  * @brief Connect to BLE device
  *        连接到 BLE 设备
  * 
- * Execute the following steps: set callbacks, start scanning and attempt connection, wait for connection completion and characteristic handle discovery.
- * 执行以下步骤：设置回调、启动扫描并尝试连接、等待连接完成和特征句柄发现。
+ * Execute the following steps: start scanning and attempt connection, wait for connection completion and characteristic handle discovery.
+ * Cameras already held by other links are skipped by the scan.
+ * 执行以下步骤：启动扫描并尝试连接、等待连接完成和特征句柄发现。扫描时跳过已被其他链路占用的相机。
  * 
  * If connection fails, returns error and resets connection state.
  * 如果连接失败，会返回错误并重置连接状态。
  * 
+ * @param link Link to connect, 0 to BLE_MAX_LINKS - 1
+ *             要连接的链路，0 到 BLE_MAX_LINKS - 1
  * @return int Returns 0 on success, -1 on failure
  *             成功返回 0，失败返回 -1
  */
-int connect_logic_ble_connect() {
-    connect_state = BLE_SEARCHING;
-
-    esp_err_t ret;
+int connect_logic_ble_connect(int link) {
+    if (!s_ble_initialized || !is_link_valid(link)) {
+        return -1;
+    }
+    link_state_t *l = &s_link_states[link];
 
-    /* 1. Set a global Notify callback for receiving remote data and protocol parsing */
-    /* 设置一个全局 Notify 回调，用于接收远端数据并进行协议解析 */
-    ble_set_notify_callback(receive_camera_notify_handler);
-    ble_set_state_callback(receive_camera_disconnect_handler);
+    xSemaphoreTake(s_connect_mutex, portMAX_DELAY);
+    if (l->state != BLE_INIT_COMPLETE) {
+        ESP_LOGW(TAG, "Link %d busy, state: %d", link, l->state);
+        xSemaphoreGive(s_connect_mutex);
+        return -1;
+    }
+    l->state = BLE_SEARCHING;
+    l->connect_start_us = esp_timer_get_time();
+    ble_transport_clear_events(link, BLE_EVENT_DISCONNECTED | BLE_EVENT_SCAN_FAILED | BLE_EVENT_OPEN_FAILED | BLE_EVENT_GATT_FAILED);
 
-    /* 2. Start scanning and attempt connection */
+    /* 1. Start scanning and attempt connection */
     /* 开始扫描并尝试连接 */
-    ret = ble_start_scanning_and_connect();
+    esp_err_t ret = ble_transport_open(link, false);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to start scanning and connect, error: 0x%x", ret);
-        connect_state = BLE_INIT_COMPLETE;
+        l->state = BLE_INIT_COMPLETE;
+        xSemaphoreGive(s_connect_mutex);
         return -1;
     }
 
-    /* 3. Wait up to 5 seconds to ensure BLE connection success */
-    /* 等待最多 5 秒以确保 BLE 连接成功 */
-    ESP_LOGI(TAG, "Waiting up to 5s for BLE to connect...");
-    bool connected = false;
-    for (int i = 0; i < 50; i++) { // 50 * 100ms = 5s
-        if (s_ble_profile.connection_status.is_connected) {
-            ESP_LOGI(TAG, "BLE connected successfully");
-            connected = true;
-            break;
+    /* 2. Scan (3 s) and connect within 5 seconds, then wait for the handles and notification */
+    /* 在 5 秒内完成扫描（3 秒）与连接，然后等待句柄查找与通知使能 */
+    if (connect_logic_wait_ready(link, 5000) != 0) {
+        if (connect_logic_link_up(link)) {
+            connect_logic_close_link(link);
         }
-        vTaskDelay(pdMS_TO_TICKS(100));
-    }
-    if (!connected) {
-        ESP_LOGW(TAG, "BLE connection timed out");
-        connect_state = BLE_INIT_COMPLETE;
+        l->state = BLE_INIT_COMPLETE;
+        ble_transport_forget(link);
+        xSemaphoreGive(s_connect_mutex);
         return -1;
     }
 
-    /* 4. Wait for characteristic handle discovery completion (up to 30 seconds) */
-    /* 等待特征句柄查找完成（最多等待30秒） */
-    ESP_LOGI(TAG, "Waiting up to 30s for characteristic handles discovery...");
-    bool handles_found = false;
-    for (int i = 0; i < 300; i++) { // 300 * 100ms = 30s
-        if (s_ble_profile.handle_discovery.notify_char_handle_found && 
-            s_ble_profile.handle_discovery.write_char_handle_found) {
-            ESP_LOGI(TAG, "Required characteristic handles found");
-            handles_found = true;
-            break;
-        }
-        vTaskDelay(pdMS_TO_TICKS(100));
-    }
-    if (!handles_found) {
-        ESP_LOGW(TAG, "Characteristic handles not found within timeout");
-        connect_state = BLE_INIT_COMPLETE;
-        return -1;
+    // Update state to BLE connected
+    // 更新状态为 BLE 已连接
+    l->state = BLE_CONNECTED;
+    xSemaphoreGive(s_connect_mutex);
+    ESP_LOGI(TAG, "Link %d BLE connect successfully", link);
+    return 0;
+}
+
+/**
+ * @brief Close the BLE link without cancelling background reconnection
+ *        关闭 BLE 链路，但不取消后台重连
+ *
+ * @param link Link to close
+ *             要关闭的链路
+ * @return int Returns 0 on success, -1 on failure
+ *             成功返回 0，失败返回 -1
+ */
+static int connect_logic_close_link(int link) {
+    link_state_t *l = &s_link_states[link];
+
+    // Without a link there is no disconnect event to finish the state change
+    // 没有链路时不会有断开事件来完成状态切换
+    if (!connect_logic_link_up(link)) {
+        l->state = BLE_INIT_COMPLETE;
+        return 0;
     }
 
-    /* 5. Register notification */
-    /* 注册通知 */
-    ret = ble_register_notify(s_ble_profile.conn_id, s_ble_profile.notify_char_handle);
+    connect_state_t old_state = l->state;
+    l->state = BLE_DISCONNECTING;
+    
+    ESP_LOGI(TAG, "Disconnecting camera on link %d", link);
+
+    // Close the link through the transport
+    // 通过传输层关闭链路
+    esp_err_t ret = ble_transport_close(link);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to register notify, error: %s", esp_err_to_name(ret));
-        connect_state = BLE_INIT_COMPLETE;
+        ESP_LOGE(TAG, "Failed to disconnect camera, BLE error: %s", esp_err_to_name(ret));
+        l->state = old_state;
         return -1;
     }
 
-    // Update state to BLE connected
-    // 更新状态为 BLE 已连接
-    connect_state = BLE_CONNECTED;
-
-    // Delay RGB light display
-    // 延迟展示氛围灯
-    vTaskDelay(pdMS_TO_TICKS(2000));
-    ESP_LOGI(TAG, "BLE connect successfully");
+    ESP_LOGI(TAG, "Camera disconnected successfully");
     return 0;
 }
 
@@ -226,29 +734,98 @@ int connect_logic_ble_connect() {
  * @brief Disconnect BLE connection
  *        断开 BLE 连接
  * 
- * Attempt to disconnect from BLE device.
- * 尝试断开与 BLE 设备的连接。
+ * Attempt to disconnect from BLE device. An explicit disconnect also stops background reconnection
+ * and releases the camera, so a later scan may pick it for any link.
+ * 尝试断开与 BLE 设备的连接。主动断开同时停止后台重连并释放该相机，之后的扫描可将其分配给任一链路。
  * 
+ * @param link Link to disconnect
+ *             要断开的链路
  * @return int Returns 0 on success, -1 on failure
  *             成功返回 0，失败返回 -1
  */
-int connect_logic_ble_disconnect(void) {
-    connect_state_t old_state = connect_state;
-    connect_state = BLE_DISCONNECTING;
-    
-    ESP_LOGI(TAG, "Disconnecting camera");
-
-    // Call BLE layer's ble_disconnect function
-    // 调用 BLE 层的 ble_disconnect 函数
-    esp_err_t ret = ble_disconnect();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to disconnect camera, BLE error: %s", esp_err_to_name(ret));
-        connect_state = old_state;
+int connect_logic_ble_disconnect(int link) {
+    if (!is_link_valid(link)) {
         return -1;
     }
+    s_link_states[link].auto_reconnect = false;
+    if (s_reconnect_task != NULL) {
+        xTaskNotifyGive(s_reconnect_task);
+    }
+    int ret = connect_logic_close_link(link);
+    ble_transport_forget(link);
+    return ret;
+}
 
-    ESP_LOGI(TAG, "Camera disconnected successfully");
-    return 0;
+/**
+ * @brief Store the pairing after a first pairing, or forget it when the camera refuses a reconnection
+ *        首次配对成功后保存配对结果，相机拒绝重连时删除配对结果
+ *
+ * A reconnection the camera rejects, or answers with an unexpected verify_mode, forgets the pairing at
+ * once. One that gets no answer only counts, and the pairing goes after PAIRING_MAX_TIMEOUTS in a row,
+ * so a camera that does not take the reconnection mode cannot keep failing. A timeout with the link
+ * lost is not counted, the camera may never have seen the request. Once forgotten, later background
+ * reconnects of the link pair again.
+ * 相机拒绝重连，或以意外的 verify_mode 应答时，立即删除配对结果。未应答的重连只计数，连续
+ * PAIRING_MAX_TIMEOUTS 次后删除，避免不支持重连模式的相机一直连接失败。链路已断开时的超时不计数，
+ * 相机可能根本没有收到请求。删除后，该链路之后的后台重连重新首次配对。
+ *
+ * @param link Link of the camera
+ *             相机所在链路
+ * @param params Parameters of the handshake
+ *               握手使用的参数
+ * @param result How the handshake ended
+ *               握手的结束方式
+ */
+static void connect_logic_update_pairing(int link, const protocol_params_t *params, handshake_result_t result) {
+    link_state_t *l = &s_link_states[link];
+    uint8_t camera_addr[6];
+    if (ble_transport_get_peer_addr(link, camera_addr) != ESP_OK) {
+        return;
+    }
+    if (params->verify_mode == VERIFY_MODE_FIRST_PAIRING) {
+        if (result == HANDSHAKE_ACCEPTED) {
+            pairing_record_t record = {
+                .device_id = params->device_id,
+                .mac_addr_len = params->mac_addr_len,
+                .fw_version = params->fw_version,
+                .verify_data = params->verify_data,
+                .camera_reserved = params->camera_reserved,
+            };
+            memcpy(record.camera_addr, camera_addr, sizeof(camera_addr));
+            memcpy(record.mac_addr, params->mac_addr, params->mac_addr_len);
+            if (pairing_logic_store(&record) == ESP_OK) {
+                ESP_LOGI(TAG, "Pairing with the camera on link %d stored, later connects skip confirmation", link);
+            }
+            l->pairing_timeouts = 0;
+        }
+        return;
+    }
+
+    // 以下为重连模式
+    // Reconnection mode from here on
+    if (result == HANDSHAKE_TIMEOUT) {
+        if (!connect_logic_link_up(link)) {
+            ESP_LOGW(TAG, "Link %d lost during the reconnection, pairing kept", link);
+            return;
+        }
+        if (memcmp(l->pairing_timeout_addr, camera_addr, sizeof(camera_addr)) != 0) {
+            memcpy(l->pairing_timeout_addr, camera_addr, sizeof(camera_addr));
+            l->pairing_timeouts = 0;
+        }
+        if (++l->pairing_timeouts < PAIRING_MAX_TIMEOUTS) {
+            ESP_LOGW(TAG, "Camera on link %d did not answer the reconnection (%d/%d), pairing kept", link,
+                     l->pairing_timeouts, PAIRING_MAX_TIMEOUTS);
+            return;
+        }
+    }
+    l->pairing_timeouts = 0;
+    if (result == HANDSHAKE_ACCEPTED) {
+        return;
+    }
+    ESP_LOGW(TAG, "Camera on link %d %s the reconnection, forgetting the pairing", link,
+             result == HANDSHAKE_TIMEOUT ? "keeps ignoring" : "refused");
+    pairing_logic_erase(camera_addr);
+    l->protocol_params.verify_mode = VERIFY_MODE_FIRST_PAIRING;
 }
 
 /**
@@ -267,6 +844,8 @@ int connect_logic_ble_disconnect(void) {
  * 4. Set connection state to protocol connected.
  *    设置连接状态为协议连接。
  * 
+ * @param link Link of the camera
+ *             相机所在链路
  * @param device_id Device ID
  *                  设备ID
  * @param mac_addr_len MAC address length
@@ -285,11 +864,28 @@ int connect_logic_ble_disconnect(void) {
  * @return int Returns 0 on success, -1 on failure
  *             成功返回 0，失败返回 -1
  */
-int connect_logic_protocol_connect(uint32_t device_id, uint8_t mac_addr_len, const int8_t *mac_addr,
+int connect_logic_protocol_connect(int link, uint32_t device_id, uint8_t mac_addr_len, const int8_t *mac_addr,
                                    uint32_t fw_version, uint8_t verify_mode, uint16_t verify_data,
                                    uint8_t camera_reserved) {
-    ESP_LOGI(TAG, "%s: Starting protocol connection", __FUNCTION__);
-    uint16_t seq = generate_seq();
+    ESP_LOGI(TAG, "%s: Starting protocol connection on link %d", __FUNCTION__, link);
+    if (!is_link_valid(link) || mac_addr_len > sizeof(s_link_states[link].protocol_params.mac_addr)) {
+        return -1;
+    }
+    link_state_t *l = &s_link_states[link];
+    uint16_t seq = generate_seq(link);
+    protocol_params_t params = {
+        .device_id = device_id,
+        .mac_addr_len = mac_addr_len,
+        .fw_version = fw_version,
+        .verify_mode = verify_mode,
+        .verify_data = verify_data,
+        .camera_reserved = camera_reserved,
+    };
+    memcpy(params.mac_addr, mac_addr, mac_addr_len);
+
+    // 重连无需用户确认，相机应立即给出验证结果
+    // A reconnection needs no user confirmation, the camera answers at once
+    int result_wait_ms = verify_mode == VERIFY_MODE_RECONNECT ? PAIRING_RECONNECT_WAIT_MS : PAIRING_FIRST_WAIT_MS;
 
     // 构造连接请求命令帧
     // Construct connection request command frame
@@ -305,8 +901,9 @@ int connect_logic_protocol_connect(uint32_t device_id, uint8_t mac_addr_len, con
 
     // STEP1: 相机发送连接请求命令
     // Send connection request command to camera
-    ESP_LOGI(TAG, "Sending connection request to camera...");
-    CommandResult result = send_command(0x00, 0x19, CMD_WAIT_RESULT, &connection_request, seq, 1000);
+    ESP_LOGI(TAG, "Sending connection request to camera (%s)...",
+             verify_mode == VERIFY_MODE_RECONNECT ? "reconnection" : "first pairing");
+    CommandResult result = send_command(link, 0x00, 0x19, CMD_WAIT_RESULT, &connection_request, seq, 1000);
 
     /****************** 连接问题，这里相机可能返回 应答帧 也可能返回 命令帧 ******************/
     /**** Connection issue: camera may return either response frame or command frame ****/
@@ -323,10 +920,11 @@ int connect_logic_protocol_connect(uint32_t device_id, uint8_t mac_addr_len, con
         void *parse_result = NULL;
         size_t parse_result_length = 0;
         uint16_t received_seq = 0;
-        esp_err_t ret = data_wait_for_result_by_cmd(0x00, 0x19, 1000, &received_seq, &parse_result, &parse_result_length);
+        esp_err_t ret = data_wait_for_result_by_cmd(link, 0x00, 0x19, 1000, &received_seq, &parse_result, &parse_result_length);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "Timeout or error waiting for camera connection command, GOTO Failed.");
-            connect_logic_ble_disconnect();
+            connect_logic_update_pairing(link, &params, HANDSHAKE_TIMEOUT);
+            connect_logic_close_link(link);
             return -1;
         } else {
             // 如果能收到数据，跳过解析相机返回响应，直接进入STEP2
@@ -341,7 +939,8 @@ int connect_logic_protocol_connect(uint32_t device_id, uint8_t mac_addr_len, con
     if (response->ret_code != 0) {
         ESP_LOGE(TAG, "Connection request rejected by camera, ret_code: %d", response->ret_code);
         free(response);
-        connect_logic_ble_disconnect();
+        connect_logic_update_pairing(link, &params, HANDSHAKE_REJECTED);
+        connect_logic_close_link(link);
         return -1;
     }
 
@@ -354,11 +953,12 @@ wait_for_camera_command:
     void *parse_result = NULL;
     size_t parse_result_length = 0;
     uint16_t received_seq = 0;
-    esp_err_t ret = data_wait_for_result_by_cmd(0x00, 0x19, 30000, &received_seq, &parse_result, &parse_result_length);
+    esp_err_t ret = data_wait_for_result_by_cmd(link, 0x00, 0x19, result_wait_ms, &received_seq, &parse_result, &parse_result_length);
 
     if (ret != ESP_OK || parse_result == NULL) {
         ESP_LOGE(TAG, "Timeout or error waiting for camera connection command");
-        connect_logic_ble_disconnect();
+        connect_logic_update_pairing(link, &params, HANDSHAKE_TIMEOUT);
+        connect_logic_close_link(link);
         return -1;
     }
 
@@ -366,10 +966,11 @@ wait_for_camera_command:
     // Parse the connection request command sent by camera
     connection_request_command_frame *camera_request = (connection_request_command_frame *)parse_result;
 
-    if (camera_request->verify_mode != 2) {
+    if (camera_request->verify_mode != VERIFY_MODE_RESULT) {
         ESP_LOGE(TAG, "Unexpected verify_mode from camera: %d", camera_request->verify_mode);
         free(parse_result);
-        connect_logic_ble_disconnect();
+        connect_logic_update_pairing(link, &params, HANDSHAKE_UNEXPECTED);
+        connect_logic_close_link(link);
         return -1;
     }
 
@@ -389,19 +990,28 @@ wait_for_camera_command:
 
         // STEP3: 发送连接应答帧
         // Send connection response frame
-        send_command(0x00, 0x19, ACK_NO_RESPONSE, &connection_response, received_seq, 5000);
+        send_command(link, 0x00, 0x19, ACK_NO_RESPONSE, &connection_response, received_seq, 5000);
 
         // 设置连接状态为协议连接
         // Set connection state to protocol connected
-        connect_state = PROTOCOL_CONNECTED;
+        l->state = PROTOCOL_CONNECTED;
+
+        // 保存配对结果与参数并启用后台重连，后台重连使用重连模式
+        // Keep the pairing and the parameters and arm background reconnection, which uses the reconnection mode
+        connect_logic_update_pairing(link, &params, HANDSHAKE_ACCEPTED);
+        l->protocol_params = params;
+        l->protocol_params.verify_mode = VERIFY_MODE_RECONNECT;
+        l->auto_reconnect = true;
 
-        ESP_LOGI(TAG, "Connection successfully established with camera.");
+        ESP_LOGI(TAG, "Connection successfully established with camera on link %d, %lld ms after connect start.",
+                 link, (long long)((esp_timer_get_time() - l->connect_start_us) / 1000));
         free(parse_result);
         return 0;
     } else {
         ESP_LOGW(TAG, "Camera rejected the connection, closing Bluetooth link...");
         free(parse_result);
-        connect_logic_ble_disconnect();
+        connect_logic_update_pairing(link, &params, HANDSHAKE_REJECTED);
+        connect_logic_close_link(link);
         return -1;
     }
 }
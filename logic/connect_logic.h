@@ -22,6 +22,21 @@
 #ifndef __CONNECT_LOGIC_H__
 #define __CONNECT_LOGIC_H__
 
+#include <stdint.h>
+
+/* Background reconnection after an unexpected disconnect */
+/* 意外断开后的后台重连 */
+#define RECONNECT_BASE_DELAY_MS   500     // Backoff of the first attempt
+#define RECONNECT_MAX_DELAY_MS    30000   // Backoff cap
+#define RECONNECT_MAX_ATTEMPTS    10      // Attempts before giving up
+#define RECONNECT_TASK_PRIORITY   2
+
+/* Link profile switching, see ble_link_profile_t */
+/* 链路配置切换，见 ble_link_profile_t */
+#define PROFILE_CHECK_PERIOD_MS   1000    // Activity check period
+#define PROFILE_IDLE_MS           5000    // Quiet time before dropping to the low-power profile
+#define PROFILE_ACTIVE_WRITES     3       // Writes per check that count as activity, above the 1 Hz GPS keepalive
+
 typedef enum {
     BLE_NOT_INIT = -1,
     BLE_INIT_COMPLETE = 0,
@@ -34,13 +49,17 @@ typedef enum {
 
 connect_state_t connect_logic_get_state(void);
 
+connect_state_t connect_logic_get_link_state(int link);
+
+uint32_t connect_logic_get_protocol_links(void);
+
 int connect_logic_ble_init();
 
-int connect_logic_ble_connect();
+int connect_logic_ble_connect(int link);
 
-int connect_logic_ble_disconnect(void);
+int connect_logic_ble_disconnect(int link);
 
-int connect_logic_protocol_connect(uint32_t device_id, uint8_t mac_addr_len, const int8_t *mac_addr,
+int connect_logic_protocol_connect(int link, uint32_t device_id, uint8_t mac_addr_len, const int8_t *mac_addr,
                                     uint32_t fw_version, uint8_t verify_mode, uint16_t verify_data,
                                     uint8_t camera_reserved);
 
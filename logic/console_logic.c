@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include "esp_log.h"
+
+#include "console_logic.h"
+
+#define TAG "LOGIC_CONSOLE"
+
+typedef struct {
+    const char *keyword;
+    size_t keyword_length;
+    console_command_handler_t handler;
+} console_command_t;
+
+static console_command_t s_commands[CONSOLE_MAX_COMMANDS];
+static uint8_t s_command_count = 0;
+
+// Console line being received
+// 正在接收的控制台行
+static char s_line[CONSOLE_LINE_SIZE];
+static size_t s_line_length = 0;
+
+/**
+ * @brief Register a command keyword, call before console_logic_init()
+ *        注册命令关键字，需在 console_logic_init() 之前调用
+ *
+ * @param keyword First word of the command line, must stay valid
+ *                命令行的第一个单词，需保持有效
+ * @param handler Handler called with the whole line
+ *                以整行调用的处理函数
+ * @return int Returns 0 on success, -1 when the table is full
+ *             成功返回 0，表已满返回 -1
+ */
+int console_register_command(const char *keyword, console_command_handler_t handler) {
+    if (s_command_count >= CONSOLE_MAX_COMMANDS) {
+        ESP_LOGE(TAG, "Too many console commands, %s not registered", keyword);
+        return -1;
+    }
+    s_commands[s_command_count++] = (console_command_t){
+        .keyword = keyword,
+        .keyword_length = strlen(keyword),
+        .handler = handler,
+    };
+    return 0;
+}
+
+/**
+ * @brief Read one line from the console
+ *        从控制台读取一行
+ *
+ * @param timeout_ms Maximum time to wait
+ *                   最长等待时间
+ * @return const char* Complete line without line ending, NULL on timeout
+ *                     不含换行符的完整行，超时返回 NULL
+ */
+const char *console_read_line(uint32_t timeout_ms) {
+    TickType_t start = xTaskGetTickCount();
+    uint8_t c;
+
+    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(timeout_ms)) {
+        if (uart_read_bytes(CONSOLE_UART_PORT, &c, 1, pdMS_TO_TICKS(20)) != 1) {
+            continue;
+        }
+        if (c == '\r' || c == '\n') {
+            if (s_line_length == 0) {
+                continue;
+            }
+            s_line[s_line_length] = '\0';
+            s_line_length = 0;
+            return s_line;
+        }
+        if (s_line_length < sizeof(s_line) - 1) {
+            s_line[s_line_length++] = (char)c;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Write raw bytes to the console
+ *        向控制台写入原始数据
+ */
+void console_write(const void *data, size_t length) {
+    uart_write_bytes(CONSOLE_UART_PORT, data, length);
+}
+
+/**
+ * @brief Write a formatted reply to the console
+ *        向控制台写入格式化的回复
+ */
+void console_printf(const char *format, ...) {
+    char text[CONSOLE_LINE_SIZE];
+    va_list args;
+
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    if (length > 0) {
+        console_write(text, (size_t)length < sizeof(text) ? (size_t)length : sizeof(text) - 1);
+    }
+}
+
+/**
+ * @brief Console task, dispatches command lines to their handlers
+ *        控制台任务，将命令行分发给处理函数
+ *
+ * @param arg 任务参数
+ *            Task parameters
+ */
+static void console_task(void *arg) {
+    while (1) {
+        const char *line = console_read_line(1000);
+        if (line == NULL) {
+            continue;
+        }
+
+        for (uint8_t i = 0; i < s_command_count; i++) {
+            const console_command_t *command = &s_commands[i];
+            if (strncmp(line, command->keyword, command->keyword_length) == 0 &&
+                (line[command->keyword_length] == '\0' || line[command->keyword_length] == ' ')) {
+                command->handler(line);
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Initialize the command console
+ *        初始化命令控制台
+ *
+ * @return int Returns 0 on success, -1 on failure
+ *             返回 0 表示成功，-1 表示失败
+ */
+int console_logic_init(void) {
+    // 控制台串口已由启动代码配置，这里只安装驱动以接收命令
+    // The console UART is configured by the startup code, only the driver is installed to receive commands
+    esp_err_t ret = uart_driver_install(CONSOLE_UART_PORT, 256, CONSOLE_TX_BUFFER_SIZE, 0, NULL, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to install console UART driver: %s", esp_err_to_name(ret));
+        return -1;
+    }
+
+    // 与 GPS 任务同为最低优先级，大部分时间阻塞在串口收发上
+    // Same lowest priority as the GPS tasks, spends most of its time blocked on the UART
+    if (xTaskCreate(console_task, "console_task", 1024 * 4, NULL, 0, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create console task");
+        return -1;
+    }
+    return 0;
+}
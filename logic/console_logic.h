@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __CONSOLE_LOGIC_H__
+#define __CONSOLE_LOGIC_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+
+/*
+ * Line based command console on the console UART. A command is a line starting with a registered
+ * keyword; its handler runs in the console task and may keep reading lines (e.g. for ACKs) until it
+ * returns.
+ * 控制台串口上基于文本行的命令控制台。以已注册关键字开头的行即为命令；处理函数在控制台任务中运行，
+ * 返回前可继续读取后续行（例如等待 ACK）。
+ */
+
+#define CONSOLE_UART_PORT       CONFIG_ESP_CONSOLE_UART_NUM
+#define CONSOLE_LINE_SIZE       128
+#define CONSOLE_TX_BUFFER_SIZE  1024
+#define CONSOLE_MAX_COMMANDS    8
+
+/**
+ * @brief Console command handler
+ *        控制台命令处理函数
+ *
+ * @param line Complete command line without line ending, only valid until the next console_read_line()
+ *             不含换行符的完整命令行，仅在下一次 console_read_line() 之前有效
+ */
+typedef void (*console_command_handler_t)(const char *line);
+
+int console_logic_init(void);
+
+int console_register_command(const char *keyword, console_command_handler_t handler);
+
+const char *console_read_line(uint32_t timeout_ms);
+
+void console_write(const void *data, size_t length);
+
+void console_printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+#endif
@@ -38,6 +38,15 @@ typedef enum {
                                  // 应答帧 - 需要应答，没收到结果会报错 (00100010)
 } cmd_type_t;
 
+typedef enum {
+    VERIFY_MODE_FIRST_PAIRING = 0,  // First pairing, the user confirms on the camera
+                                    // 首次配对，需在相机上确认
+    VERIFY_MODE_RECONNECT = 1,      // Reconnection of a paired remote, no confirmation
+                                    // 已配对遥控器重连，无需确认
+    VERIFY_MODE_RESULT = 2          // Verification result, sent by the camera
+                                    // 验证结果，由相机发送
+} verify_mode_t;
+
 typedef enum {
     CAMERA_MODE_SLOW_MOTION = 0x00,       // Slow Motion Mode
                                           // 慢动作模式
@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <stdarg.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+
+#include "export_logic.h"
+#include "console_logic.h"
+#include "track_logic.h"
+
+#define TAG "LOGIC_EXPORT"
+
+#define EXPORT_LINE_SIZE        128
+
+typedef enum {
+    EXPORT_ACK_OK = 0,
+    EXPORT_ACK_TIMEOUT,
+    EXPORT_ACK_ABORT,
+} export_ack_t;
+
+static volatile bool s_busy = false;
+
+// Chunk being filled, sent as soon as the next line does not fit
+// 正在填充的块，下一行放不下时立即发送
+static char s_chunk[EXPORT_CHUNK_SIZE];
+static size_t s_chunk_length = 0;
+static uint32_t s_chunk_number = 0;
+
+static track_page_t s_page;
+
+/**
+ * @brief Log output while exporting: dropped, so no log line lands inside a chunk
+ *        导出期间的日志输出：丢弃，避免日志插入到数据块中
+ */
+static int export_log_discard(const char *format, va_list args) {
+    return 0;
+}
+
+/**
+ * @brief Wait for the host to acknowledge a chunk
+ *        等待主机确认数据块
+ */
+static export_ack_t export_wait_ack(uint32_t chunk_number) {
+    TickType_t start = xTaskGetTickCount();
+
+    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(EXPORT_ACK_TIMEOUT_MS)) {
+        const char *line = console_read_line(EXPORT_ACK_TIMEOUT_MS);
+        if (line == NULL) {
+            break;
+        }
+        if (strcmp(line, "ABORT") == 0) {
+            return EXPORT_ACK_ABORT;
+        }
+        if (strncmp(line, "ACK ", 4) == 0 && strtoul(line + 4, NULL, 10) == chunk_number) {
+            return EXPORT_ACK_OK;
+        }
+        // 旧块的重复确认，忽略
+        // Duplicate acknowledgement of an older chunk, ignore
+    }
+    return EXPORT_ACK_TIMEOUT;
+}
+
+/**
+ * @brief Send the filled chunk and wait until it is acknowledged
+ *        发送已填充的块并等待确认
+ *
+ * @param next Position of the first point not contained in this chunk
+ *             本块之后第一个点的位置
+ * @return int Returns 0 on success, -1 if the host aborted or stopped answering
+ *             成功返回 0，主机中止或无响应返回 -1
+ */
+static int export_send_chunk(const export_position_t *next) {
+    char header[80];
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)s_chunk, s_chunk_length);
+    int header_length = snprintf(header, sizeof(header), "#CHUNK %lu %u %08lx %lu %u\n",
+                                 (unsigned long)s_chunk_number, (unsigned)s_chunk_length, (unsigned long)crc,
+                                 (unsigned long)next->page_sequence, (unsigned)next->point_index);
+
+    for (int attempt = 0; attempt <= EXPORT_MAX_RETRIES; attempt++) {
+        console_write(header, header_length);
+        console_write(s_chunk, s_chunk_length);
+
+        export_ack_t ack = export_wait_ack(s_chunk_number);
+        if (ack == EXPORT_ACK_OK) {
+            s_chunk_number++;
+            s_chunk_length = 0;
+            return 0;
+        }
+        if (ack == EXPORT_ACK_ABORT) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Append data to the chunk, sending the chunk first if it does not fit
+ *        向块追加数据，放不下时先发送当前块
+ *
+ * @param data Data to append, at most EXPORT_CHUNK_SIZE bytes
+ *             要追加的数据，最多 EXPORT_CHUNK_SIZE 字节
+ * @param length Data length
+ *               数据长度
+ * @param position Position of the point this data belongs to, where a resume would restart
+ *                 该数据所属点的位置，即续传时的起点
+ * @return int Returns 0 on success, -1 on failure
+ *             成功返回 0，失败返回 -1
+ */
+static int export_append(const void *data, size_t length, const export_position_t *position) {
+    if (s_chunk_length + length > sizeof(s_chunk)) {
+        if (export_send_chunk(position) != 0) {
+            return -1;
+        }
+    }
+    memcpy(s_chunk + s_chunk_length, data, length);
+    s_chunk_length += length;
+    return 0;
+}
+
+/**
+ * @brief Format one point as a CSV row or GPX track point
+ *        将一个点格式化为 CSV 行或 GPX 轨迹点
+ */
+static int export_format_point(export_format_t format, const track_point_t *point, char *out, size_t out_size) {
+    time_t seconds = (time_t)(point->time_ms / 1000);
+    struct tm utc;
+    char time_text[48];
+
+    gmtime_r(&seconds, &utc);
+    snprintf(time_text, sizeof(time_text), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+             utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday, utc.tm_hour, utc.tm_min, utc.tm_sec,
+             (int)(point->time_ms % 1000));
+
+    // 整数运算输出，避免浮点格式化的开销
+    // Printed with integer arithmetic to avoid the cost of float formatting
+    const char *lat_sign = point->latitude < 0 ? "-" : "";
+    const char *lon_sign = point->longitude < 0 ? "-" : "";
+    const char *alt_sign = point->altitude < 0 ? "-" : "";
+    unsigned long lat = labs(point->latitude), lon = labs(point->longitude), alt = labs(point->altitude);
+
+    if (format == EXPORT_FORMAT_GPX) {
+        return snprintf(out, out_size, "<trkpt lat=\"%s%lu.%06lu\" lon=\"%s%lu.%06lu\"><ele>%s%lu.%lu</ele><time>%s</time></trkpt>\n",
+                        lat_sign, lat / TRACK_COORD_SCALE, lat % TRACK_COORD_SCALE,
+                        lon_sign, lon / TRACK_COORD_SCALE, lon % TRACK_COORD_SCALE,
+                        alt_sign, alt / 10, alt % 10, time_text);
+    }
+    return snprintf(out, out_size, "%s,%s%lu.%06lu,%s%lu.%06lu,%s%lu.%lu\n", time_text,
+                    lat_sign, lat / TRACK_COORD_SCALE, lat % TRACK_COORD_SCALE,
+                    lon_sign, lon / TRACK_COORD_SCALE, lon % TRACK_COORD_SCALE,
+                    alt_sign, alt / 10, alt % 10);
+}
+
+/**
+ * @brief Stream the track store from a position onwards
+ *        从指定位置起流式导出轨迹存储
+ *
+ * Pages are visited oldest first and only up to the newest page that existed when the export
+ * started, so pages written meanwhile do not make the export chase the writer.
+ * 按从旧到新的顺序访问页，且只到导出开始时已存在的最新页，导出过程中新写入的页不会使导出追赶写入。
+ *
+ * @return int Returns the number of exported points (pages for RAW), -1 on failure
+ *             返回导出的点数（RAW 格式为页数），失败返回 -1
+ */
+static int export_run(export_format_t format, export_position_t start) {
+    static const char csv_header[] = "time,latitude,longitude,altitude_m\n";
+    static const char gpx_header[] = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                                     "<gpx version=\"1.1\" creator=\"Osmo-GPS-Controller\" xmlns=\"http://www.topografix.com/GPX/1/1\">\n"
+                                     "<trk><trkseg>\n";
+    static const char gpx_footer[] = "</trkseg></trk>\n</gpx>\n";
+    char line[EXPORT_LINE_SIZE];
+    track_info_t info;
+    int points = 0;
+
+    // 先写入记录任务中未满的页
+    // Get the logger's partial page onto flash first
+    track_logic_flush();
+    vTaskDelay(pdMS_TO_TICKS(200));
+    track_logic_get_info(&info);
+    if (info.page_count == 0) {
+        return -1;
+    }
+
+    bool fresh = (start.page_sequence == 0 && start.point_index == 0);
+    if (fresh && format == EXPORT_FORMAT_CSV && export_append(csv_header, strlen(csv_header), &start) != 0) {
+        return -1;
+    }
+    if (fresh && format == EXPORT_FORMAT_GPX && export_append(gpx_header, strlen(gpx_header), &start) != 0) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < info.page_count; i++) {
+        uint32_t index = (info.write_index + i) % info.page_count;
+        if (!track_logic_read_page(index, &s_page)) {
+            continue;
+        }
+        uint32_t sequence = s_page.header.sequence;
+        if (sequence < start.page_sequence || sequence >= info.next_sequence) {
+            continue;
+        }
+
+        export_position_t position = { .page_sequence = sequence, .point_index = 0 };
+
+        if (format == EXPORT_FORMAT_RAW) {
+            if (export_append(&s_page, sizeof(s_page), &position) != 0) {
+                return -1;
+            }
+            points++;
+            continue;
+        }
+
+        track_decoder_t decoder;
+        track_point_t point;
+        track_decoder_begin(&decoder, s_page.payload, s_page.header.length);
+        for (; track_decoder_next(&decoder, &point); position.point_index++) {
+            if (sequence == start.page_sequence && position.point_index < start.point_index) {
+                continue;
+            }
+            int length = export_format_point(format, &point, line, sizeof(line));
+            if (export_append(line, length, &position) != 0) {
+                return -1;
+            }
+            points++;
+        }
+
+        // 让出 CPU，导出不影响同优先级的 GPS 任务
+        // Yield so the export never holds off the GPS tasks of the same priority
+        taskYIELD();
+    }
+
+    export_position_t end = { .page_sequence = info.next_sequence, .point_index = 0 };
+    if (format == EXPORT_FORMAT_GPX && export_append(gpx_footer, strlen(gpx_footer), &end) != 0) {
+        return -1;
+    }
+    if (s_chunk_length > 0 && export_send_chunk(&end) != 0) {
+        return -1;
+    }
+    return points;
+}
+
+/**
+ * @brief Parse an EXPORT command
+ *        解析 EXPORT 命令
+ *
+ * @return bool Returns true if the line is a valid EXPORT command
+ *              是有效的 EXPORT 命令时返回 true
+ */
+static bool export_parse_command(const char *line, export_format_t *format, export_position_t *start) {
+    char name[8];
+    unsigned long sequence = 0;
+    unsigned index = 0;
+
+    int fields = sscanf(line, "EXPORT %7s %lu %u", name, &sequence, &index);
+    if (fields != 1 && fields != 3) {
+        return false;
+    }
+    if (strcmp(name, "CSV") == 0) {
+        *format = EXPORT_FORMAT_CSV;
+    } else if (strcmp(name, "GPX") == 0) {
+        *format = EXPORT_FORMAT_GPX;
+    } else if (strcmp(name, "RAW") == 0) {
+        *format = EXPORT_FORMAT_RAW;
+    } else {
+        return false;
+    }
+    start->page_sequence = (uint32_t)sequence;
+    start->point_index = (uint16_t)index;
+    return true;
+}
+
+/**
+ * @brief EXPORT console command, runs the whole export in the console task
+ *        EXPORT 控制台命令，在控制台任务中完成整个导出
+ *
+ * @param line Command line
+ *             命令行
+ */
+static void export_command(const char *line) {
+    char reply[48];
+    export_format_t format;
+    export_position_t start;
+
+    if (!export_parse_command(line, &format, &start)) {
+        console_printf("#ERR syntax\n");
+        return;
+    }
+
+    ESP_LOGI(TAG, "Export started, format %d from %lu/%u", format, (unsigned long)start.page_sequence, start.point_index);
+
+    // 导出期间丢弃日志输出，避免日志插入到数据块中；不修改日志级别，各标签单独设置的级别得以保留
+    // Drop log output while exporting so no log line lands inside a chunk. Log levels are left alone,
+    // so levels set per tag survive the export
+    vprintf_like_t log_vprintf = esp_log_set_vprintf(export_log_discard);
+    s_busy = true;
+    s_chunk_length = 0;
+    s_chunk_number = 0;
+
+    int points = export_run(format, start);
+
+    int length = (points >= 0) ? snprintf(reply, sizeof(reply), "#END %d\n", points)
+                               : snprintf(reply, sizeof(reply), "#ERR aborted\n");
+    console_write(reply, length);
+    uart_wait_tx_done(CONSOLE_UART_PORT, pdMS_TO_TICKS(1000));
+
+    s_busy = false;
+    esp_log_set_vprintf(log_vprintf);
+    ESP_LOGI(TAG, "Export finished, %d points in %lu chunks", points, (unsigned long)s_chunk_number);
+}
+
+/**
+ * @brief Check whether an export is running
+ *        检查是否正在导出
+ */
+bool export_logic_is_busy(void) {
+    return s_busy;
+}
+
+/**
+ * @brief Initialize track export over the console UART
+ *        初始化通过控制台串口的轨迹导出
+ *
+ * @return int Returns 0 on success, -1 on failure
+ *             返回 0 表示成功，-1 表示失败
+ */
+int export_logic_init(void) {
+    return console_register_command("EXPORT", export_command);
+}
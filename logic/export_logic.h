@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __EXPORT_LOGIC_H__
+#define __EXPORT_LOGIC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Track export over the console UART, line based and driven by the host:
+ * 通过控制台串口导出轨迹，基于文本行，由主机驱动：
+ *
+ *   host   -> EXPORT CSV|GPX|RAW [<page sequence> <point index>]
+ *   device -> #CHUNK <n> <length> <crc32> <next page sequence> <next point index>\n<length bytes>
+ *   host   -> ACK <n>                  (next chunk is only sent after this, otherwise resent)
+ *                                      （收到后才发送下一块，否则重发）
+ *   device -> #END <points>  or  #ERR <reason>
+ *   host   -> ABORT                    (any time / 任意时刻)
+ *
+ * The position after the last acknowledged chunk resumes an interrupted export.
+ * 使用最后一个已确认块之后的位置可续传中断的导出。
+ */
+
+#define EXPORT_CHUNK_SIZE       512
+#define EXPORT_ACK_TIMEOUT_MS   2000
+#define EXPORT_MAX_RETRIES      3
+
+/* Export output format */
+/* 导出格式 */
+typedef enum {
+    EXPORT_FORMAT_CSV = 0,
+    EXPORT_FORMAT_GPX,
+    EXPORT_FORMAT_RAW,      // Whole flash pages, about 20x smaller, for tools/track_decoder.py
+                            // 原始 Flash 页，体积约小 20 倍，供 tools/track_decoder.py 解码
+} export_format_t;
+
+/* Position in the track store, page sequence plus point index inside that page */
+/* 轨迹存储中的位置，页序号加页内点索引 */
+typedef struct {
+    uint32_t page_sequence;
+    uint16_t point_index;
+} export_position_t;
+
+int export_logic_init(void);
+
+bool export_logic_is_busy(void);
+
+#endif
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+#include "geofence_logic.h"
+#include "geofence_index.h"
+#include "action_logic.h"
+
+#define TAG "LOGIC_GEOFENCE"
+
+static geofence_index_t s_index = {0};
+static esp_partition_mmap_handle_t s_mmap_handle;
+
+// One bit per fence, set while inside
+// 每个围栏一位，处于围栏内时置位
+static uint8_t *s_inside_bits = NULL;
+
+// Fences currently inside, so leaving is noticed even when the fix is no longer in their grid cells
+// 当前所在的围栏，即使定位已不在其网格单元中也能发现离开
+static uint16_t s_inside[GEOFENCE_MAX_INSIDE];
+static uint8_t s_inside_count = 0;
+static bool s_overflow_logged = false;
+
+static geofence_stats_t s_stats = {0};
+
+/**
+ * @brief Record entering or leaving a fence and post its action
+ *        记录进入或离开围栏并提交对应动作
+ *
+ * @param id Fence id
+ *           围栏编号
+ * @param entered true when entering, false when leaving
+ *                进入为 true，离开为 false
+ */
+static void geofence_transition(uint16_t id, bool entered) {
+    const geofence_record_t *fence = &s_index.fences[id];
+    uint8_t action = entered ? fence->enter_action : fence->exit_action;
+
+    if (entered) {
+        s_inside_bits[id / 8] |= (uint8_t)(1 << (id % 8));
+        s_inside[s_inside_count++] = id;
+        s_stats.enter_count++;
+    } else {
+        s_inside_bits[id / 8] &= (uint8_t)~(1 << (id % 8));
+        for (uint8_t i = 0; i < s_inside_count; i++) {
+            if (s_inside[i] == id) {
+                s_inside[i] = s_inside[--s_inside_count];
+                s_overflow_logged = false;
+                break;
+            }
+        }
+        s_stats.exit_count++;
+    }
+
+    ESP_LOGI(TAG, "%s fence %u, action %s", entered ? "Entered" : "Left", id, camera_action_to_string(action));
+    action_logic_post((camera_action_type_t)action, fence->action_param, "geofence");
+}
+
+/**
+ * @brief Evaluate the geofences for a new fix, called from the GPS receive task
+ *        对新的定位判断地理围栏，在 GPS 接收任务中调用
+ *
+ * Only the fences of the fix's grid cell are tested, plus a bounding box check of the fences
+ * currently inside. Within the hysteresis of a border the state is kept.
+ * 只测试定位所在网格单元的围栏，以及对当前所在围栏做包围盒检查。在边界滞回距离内保持原状态。
+ *
+ * @param gps Valid fix
+ *            有效定位
+ */
+void geofence_logic_on_fix(const GPS_Data_t *gps) {
+    if (s_index.header == NULL) {
+        return;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    int32_t lat = (int32_t)lround(gps->Latitude * 1e7);
+    int32_t lon = (int32_t)lround(gps->Longitude * 1e7);
+
+    // 定位已离开包围盒的围栏肯定已离开，且不会出现在当前单元中
+    // A fence whose bounding box no longer holds the fix has been left, and is not in the current cell
+    for (uint8_t i = s_inside_count; i > 0; i--) {
+        const geofence_record_t *fence = &s_index.fences[s_inside[i - 1]];
+        if (lat < fence->min_lat || lat > fence->max_lat || lon < fence->min_lon || lon > fence->max_lon) {
+            geofence_transition(s_inside[i - 1], false);
+        }
+    }
+
+    const uint16_t *ids = NULL;
+    size_t count = geofence_index_candidates(&s_index, lat, lon, &ids);
+    for (size_t i = 0; i < count; i++) {
+        uint16_t id = ids[i];
+        bool inside = (s_inside_bits[id / 8] >> (id % 8)) & 1;
+        geofence_position_t position = geofence_index_test(&s_index, id, lat, lon);
+
+        if (position == GEOFENCE_INSIDE && !inside) {
+            if (s_inside_count >= GEOFENCE_MAX_INSIDE) {
+                if (!s_overflow_logged) {
+                    ESP_LOGW(TAG, "Inside more than %d fences, further fences ignored", GEOFENCE_MAX_INSIDE);
+                    s_overflow_logged = true;
+                }
+                continue;
+            }
+            geofence_transition(id, true);
+        } else if (position == GEOFENCE_OUTSIDE && inside) {
+            geofence_transition(id, false);
+        }
+    }
+
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+    s_stats.evaluations++;
+    s_stats.tests += count;
+    if (elapsed_us > s_stats.max_evaluation_us) {
+        s_stats.max_evaluation_us = elapsed_us;
+    }
+}
+
+/**
+ * @brief Get the geofence counters
+ *        获取地理围栏统计
+ */
+void geofence_logic_get_stats(geofence_stats_t *out) {
+    *out = s_stats;
+    out->inside_count = s_inside_count;
+}
+
+/**
+ * @brief Map the geofence image from flash
+ *        从 Flash 映射地理围栏镜像
+ *
+ * Without a partition or a valid image the device works as before, with no fences. Must be called
+ * before the GPS tasks start.
+ * 没有分区或镜像无效时设备照常工作，只是没有围栏。必须在 GPS 任务启动之前调用。
+ *
+ * @return int Returns 0 on success, -1 on failure
+ *             返回 0 表示成功，-1 表示失败
+ */
+int geofence_logic_init(void) {
+    geofence_header_t header;
+    geofence_index_t index;
+    const void *image = NULL;
+
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, GEOFENCE_PARTITION_LABEL);
+    if (partition == NULL) {
+        ESP_LOGE(TAG, "Geofence partition not found");
+        return -1;
+    }
+
+    if (esp_partition_read(partition, 0, &header, sizeof(header)) != ESP_OK || header.magic != GEOFENCE_MAGIC) {
+        ESP_LOGI(TAG, "No geofence image");
+        return -1;
+    }
+    if (header.total_size < sizeof(header) || header.total_size > partition->size) {
+        ESP_LOGE(TAG, "Geofence image size %lu invalid", (unsigned long)header.total_size);
+        return -1;
+    }
+
+    esp_err_t ret = esp_partition_mmap(partition, 0, header.total_size, ESP_PARTITION_MMAP_DATA, &image, &s_mmap_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to map geofence image: %s", esp_err_to_name(ret));
+        return -1;
+    }
+
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)image + sizeof(header), header.total_size - sizeof(header));
+    if (crc != header.crc32 || geofence_index_open(&index, image, header.total_size) != 0) {
+        ESP_LOGE(TAG, "Geofence image corrupted");
+        esp_partition_munmap(s_mmap_handle);
+        return -1;
+    }
+
+    s_inside_bits = calloc((header.fence_count + 7) / 8 + 1, 1);
+    if (s_inside_bits == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate geofence state");
+        esp_partition_munmap(s_mmap_handle);
+        return -1;
+    }
+
+    s_index = index;
+    s_stats.fence_count = header.fence_count;
+    ESP_LOGI(TAG, "%u geofences loaded, grid %ux%u, %lu cell entries", header.fence_count, header.rows, header.cols,
+             (unsigned long)header.cell_entry_count);
+    return 0;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __GEOFENCE_LOGIC_H__
+#define __GEOFENCE_LOGIC_H__
+
+#include <stdint.h>
+#include "gps_logic.h"
+
+/*
+ * Geofences evaluated on every valid fix, entering or leaving a fence posts its camera action.
+ * The fence image lives in the "geofence" partition, built and flashed from the host:
+ * 每个有效定位都会判断地理围栏，进入或离开围栏时提交对应的相机动作。
+ * 围栏镜像存放在 "geofence" 分区中，由主机端生成并烧录：
+ *
+ *   python3 tools/geofence_builder.py fences.json -o geofence.bin
+ *   esptool.py write_flash 0x1D0000 geofence.bin
+ *
+ * Image layout: utils/geofence/geofence_index.h
+ * 镜像格式见 utils/geofence/geofence_index.h
+ */
+
+#define GEOFENCE_PARTITION_LABEL    "geofence"
+
+// Fences the device can be inside at the same time
+// 设备可同时处于其中的围栏数量
+#define GEOFENCE_MAX_INSIDE         32
+
+/* Geofence counters */
+/* 地理围栏统计 */
+typedef struct {
+    uint16_t fence_count;       // Fences loaded, 0 if none
+                                // 已加载的围栏数，没有时为 0
+    uint8_t inside_count;       // Fences currently inside
+                                // 当前处于其中的围栏数
+    uint32_t evaluations;       // Fixes evaluated
+                                // 已判断的定位数
+    uint32_t tests;             // Fence tests over all fixes
+                                // 所有定位的围栏测试次数
+    uint32_t enter_count;
+    uint32_t exit_count;
+    uint32_t max_evaluation_us; // Longest evaluation of one fix
+                                // 单个定位的最长判断时间
+} geofence_stats_t;
+
+int geofence_logic_init(void);
+
+void geofence_logic_on_fix(const GPS_Data_t *gps);
+
+void geofence_logic_get_stats(geofence_stats_t *out);
+
+#endif
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <sys/time.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+
+#include "gps_aiding_logic.h"
+#include "gps_receiver_logic.h"
+
+#define TAG "LOGIC_GPS_AIDING"
+
+#define GPS_AIDING_NVS_NAMESPACE    "gps_aiding"
+#define GPS_AIDING_NVS_KEY          "last_fix"
+#define GPS_AIDING_RECORD_VERSION   1
+
+/* Last good fix as stored in NVS */
+/* 存储在 NVS 中的最近一次有效定位 */
+typedef struct __attribute__((packed)) {
+    uint8_t version;
+    int32_t latitude;       // Degrees * 1e7
+                            // 度 * 1e7
+    int32_t longitude;      // Degrees * 1e7
+                            // 度 * 1e7
+    int32_t altitude;       // mm
+    int64_t unix_time;      // UTC seconds of the fix
+                            // 定位时刻的 UTC 秒
+} gps_aiding_record_t;
+
+static gps_aiding_record_t s_saved_record = {0};
+static bool s_has_saved_record = false;
+
+// Local time of the last NVS write and receiver backup, and of the first fix (us)
+// 最近一次写 NVS、接收机备份以及首次定位的本地时间 (微秒)
+static int64_t s_last_save_us = 0;
+static int64_t s_last_backup_us = 0;
+static int64_t s_first_fix_us = 0;
+static bool s_system_time_set = false;
+
+/**
+ * @brief Approximate distance between two points (m), equirectangular
+ *        两点间的近似距离（米），等距圆柱投影
+ */
+static double distance_m(double lat1, double lon1, double lat2, double lon2) {
+    const double deg_to_m = 6378137.0 * M_PI / 180.0;
+    double dy = (lat2 - lat1) * deg_to_m;
+    double dx = (lon2 - lon1) * deg_to_m * cos((lat1 + lat2) * 0.5 * M_PI / 180.0);
+    return sqrt(dx * dx + dy * dy);
+}
+
+/**
+ * @brief Load the stored fix from NVS
+ *        从 NVS 读取存储的定位
+ *
+ * @return bool Returns true if a valid record was found
+ *              找到有效记录时返回 true
+ */
+static bool gps_aiding_load(void) {
+    nvs_handle_t handle;
+    size_t length = sizeof(s_saved_record);
+
+    if (nvs_open(GPS_AIDING_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+    esp_err_t ret = nvs_get_blob(handle, GPS_AIDING_NVS_KEY, &s_saved_record, &length);
+    nvs_close(handle);
+
+    return (ret == ESP_OK && length == sizeof(s_saved_record) && s_saved_record.version == GPS_AIDING_RECORD_VERSION);
+}
+
+/**
+ * @brief Write the fix to NVS as one blob
+ *        将定位作为一个 blob 写入 NVS
+ *
+ * @param record Record to store
+ *               要存储的记录
+ */
+static void gps_aiding_save(const gps_aiding_record_t *record) {
+    nvs_handle_t handle;
+
+    esp_err_t ret = nvs_open(GPS_AIDING_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return;
+    }
+    ret = nvs_set_blob(handle, GPS_AIDING_NVS_KEY, record, sizeof(*record));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save last fix: %s", esp_err_to_name(ret));
+        return;
+    }
+    s_saved_record = *record;
+    s_has_saved_record = true;
+}
+
+/**
+ * @brief Inject stored time and position into the receiver at boot
+ *        启动时向接收机注入存储的时间和位置
+ *
+ * Time is only injected when the system clock survived the reset (RTC still running), a stale time
+ * from NVS would mislead the receiver more than no time at all. Must be called after the receiver
+ * command engine has been initialized.
+ * 仅当系统时钟在复位后仍然有效（RTC 持续运行）时才注入时间，NVS 中的过期时间比没有时间更具误导性。
+ * 必须在接收机命令引擎初始化之后调用。
+ */
+void gps_aiding_inject(void) {
+    char body[96];
+    time_t now = time(NULL);
+
+    if ((int64_t)now >= GPS_AIDING_MIN_VALID_UNIX_TIME) {
+        struct tm utc;
+        gmtime_r(&now, &utc);
+        snprintf(body, sizeof(body), "PAIR590,%04d,%02d,%02d,%02d,%02d,%02d",
+                 utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday, utc.tm_hour, utc.tm_min, utc.tm_sec);
+        gps_receiver_send_command(body, NULL, NULL);
+        ESP_LOGI(TAG, "Time aiding injected");
+    } else {
+        ESP_LOGI(TAG, "System time not set, skipping time aiding");
+    }
+
+    s_has_saved_record = gps_aiding_load();
+    if (!s_has_saved_record) {
+        ESP_LOGI(TAG, "No stored fix, receiver will cold start");
+        return;
+    }
+
+    // PAIR600: 纬度, 经度, 高度, 长半轴精度, 短半轴精度, 方位, 垂直精度
+    // PAIR600: latitude, longitude, height, major accuracy, minor accuracy, bearing, vertical accuracy
+    snprintf(body, sizeof(body), "PAIR600,%.6f,%.6f,%.1f,%d.0,%d.0,0.0,%d.0",
+             s_saved_record.latitude * 1e-7, s_saved_record.longitude * 1e-7, s_saved_record.altitude / 1000.0,
+             GPS_AIDING_POSITION_ACCURACY_M, GPS_AIDING_POSITION_ACCURACY_M, GPS_AIDING_POSITION_ACCURACY_M);
+    gps_receiver_send_command(body, NULL, NULL);
+    ESP_LOGI(TAG, "Position aiding injected (%.4f, %.4f)",
+             s_saved_record.latitude * 1e-7, s_saved_record.longitude * 1e-7);
+}
+
+/**
+ * @brief Handle a valid fix: keep the system clock and stored fix up to date
+ *        处理一次有效定位：更新系统时钟和存储的定位
+ *
+ * NVS writes are rate limited and skipped while the position barely changes, so a day of
+ * driving costs at most a few hundred writes and a day parked costs none.
+ * NVS 写入有频率限制，且位置基本不变时跳过，因此一天的行驶最多写入数百次，静止则不写入。
+ *
+ * @param gps Valid fix
+ *            有效定位
+ */
+void gps_aiding_on_fix(const GPS_Data_t *gps) {
+    int64_t now_us = esp_timer_get_time();
+    int64_t unix_time = gps_data_to_unix_time(gps);
+
+    if (s_first_fix_us == 0) {
+        s_first_fix_us = now_us;
+        ESP_LOGI(TAG, "First valid fix %lld ms after boot", (long long)(now_us / 1000));
+    }
+
+    // 用 GPS 时间校准系统时钟，复位后可用于时间辅助
+    // Discipline the system clock from GPS, it is used for time aiding after a reset
+    if (!s_system_time_set) {
+        struct timeval tv = {
+            .tv_sec = (time_t)unix_time,
+            .tv_usec = (suseconds_t)((gps->Second - (int)gps->Second) * 1e6),
+        };
+        settimeofday(&tv, NULL);
+        s_system_time_set = true;
+    }
+
+    // 星历下载完成后请求接收机将导航数据保存到其 Flash（PAIR 命令，仅 NMEA 接收机支持）
+    // Once ephemeris has been downloaded, ask the receiver to save navigation data to its flash
+    // (a PAIR command, only the NMEA receiver takes it)
+    int64_t backup_due_us = (s_last_backup_us == 0)
+                                ? s_first_fix_us + GPS_AIDING_BACKUP_FIRST_S * 1000000LL
+                                : s_last_backup_us + GPS_AIDING_BACKUP_INTERVAL_S * 1000000LL;
+    if (GPS_INPUT_PROTOCOL == GPS_INPUT_PROTOCOL_NMEA && now_us >= backup_due_us) {
+        gps_receiver_send_command("PAIR511", NULL, NULL);
+        s_last_backup_us = now_us;
+    }
+
+    if (s_last_save_us != 0 && now_us - s_last_save_us < GPS_AIDING_SAVE_INTERVAL_S * 1000000LL) {
+        return;
+    }
+    if (s_has_saved_record &&
+        distance_m(s_saved_record.latitude * 1e-7, s_saved_record.longitude * 1e-7,
+                   gps->Latitude, gps->Longitude) < GPS_AIDING_SAVE_DISTANCE_M) {
+        return;
+    }
+
+    gps_aiding_record_t record = {
+        .version = GPS_AIDING_RECORD_VERSION,
+        .latitude = (int32_t)(gps->Latitude * 1e7),
+        .longitude = (int32_t)(gps->Longitude * 1e7),
+        .altitude = (int32_t)(gps->Altitude * 1000),
+        .unix_time = unix_time,
+    };
+    gps_aiding_save(&record);
+    s_last_save_us = now_us;
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __GPS_AIDING_LOGIC_H__
+#define __GPS_AIDING_LOGIC_H__
+
+#include <stdint.h>
+#include "gps_logic.h"
+
+// Minimum time between two NVS writes of the last fix (s)
+// 两次写入 NVS 的最小间隔 (秒)
+#define GPS_AIDING_SAVE_INTERVAL_S      600
+
+// Only rewrite the stored fix once we moved further than this (m), position aiding needs km accuracy at best
+// 移动超过该距离（米）才重写存储的位置，位置辅助最多只需要千米级精度
+#define GPS_AIDING_SAVE_DISTANCE_M      1000
+
+// Accuracy reported to the receiver with the stored position (m)
+// 注入存储位置时告知接收机的精度 (米)
+#define GPS_AIDING_POSITION_ACCURACY_M  5000
+
+// Ask the receiver to back up its ephemeris this long after the first fix, then periodically (s)
+// 首次定位后多久请求接收机备份星历，此后周期性备份 (秒)
+#define GPS_AIDING_BACKUP_FIRST_S       60
+#define GPS_AIDING_BACKUP_INTERVAL_S    1800
+
+// System time earlier than this is treated as unset (2024-01-01 00:00:00 UTC)
+// 早于该时间的系统时间视为未设置（2024-01-01 00:00:00 UTC）
+#define GPS_AIDING_MIN_VALID_UNIX_TIME  1704067200LL
+
+void gps_aiding_inject(void);
+
+void gps_aiding_on_fix(const GPS_Data_t *gps);
+
+#endif
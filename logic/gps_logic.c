@@ -19,6 +19,7 @@
  * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <stddef.h>
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
@@ -28,6 +29,18 @@
 #include "connect_logic.h"
 #include "command_logic.h"
 #include "dji_protocol_data_structures.h"
+#include "ubx_parser.h"
+#include "gps_kalman.h"
+#include "gps_receiver_logic.h"
+#include "gps_aiding_logic.h"
+#include "track_logic.h"
+#include "geofence_logic.h"
+#include "rule_logic.h"
+#include "gps_push_logic.h"
+#include "gps_time_logic.h"
+#include "time_zone_logic.h"
+#include "civil_time.h"
+#include "esp_timer.h"
 
 #define TAG "LOGIC_GPS"
 
@@ -35,14 +48,48 @@
 // 定义缓冲区用于存储接收到的数据
 static char buff_t[RX_BUF_SIZE]={0};
 
-// Initialize GPS data structure
-// 初始化 GPS 数据结构
+// Working GPS data, only touched by the GPS receiving task; other tasks use gps_get_latest_fix()
+// 工作中的 GPS 数据，仅由 GPS 接收任务访问；其他任务使用 gps_get_latest_fix()
 static GPS_Data_t GPS_Data;
 
 // Counter for consecutive invalid GPS readings
 // GPS连续无效次数计数器
 static uint8_t gps_invalid_count = 0;
 
+// Position/velocity filter, owned by the GPS receiving task
+// 位置/速度滤波器，由 GPS 接收任务持有
+static gps_kalman_t s_kalman;
+
+// Filter update cost, for profiling on target
+// 滤波器更新耗时，用于在目标板上评估开销
+static int64_t s_kalman_time_total_us = 0;
+static int64_t s_kalman_time_max_us = 0;
+#define GPS_KALMAN_STATS_INTERVAL 3000
+
+// Published fix snapshots together with the filter state they came from. The writer fills the slot
+// readers are not pointed at and then publishes it by bumping the counter, slot = counter & 1. The
+// publish after that already rewrites the slot just published, before the counter moves again
+// 已发布的定位快照及其对应的滤波器状态。写入方填写读取方未指向的槽位，然后递增计数器完成发布，槽位 = 计数器 & 1。
+// 再下一次发布在计数器再次变化之前就已开始改写刚发布的槽位
+typedef struct {
+    gps_fix_t fix;
+    gps_kalman_t filter;
+} gps_snapshot_t;
+
+static uint32_t s_fix_published = 0;
+static gps_snapshot_t s_snapshots[2];
+
+// GPS UART event queue and current baud rate, used to work out when bytes arrived
+// GPS 串口事件队列与当前波特率，用于推算字节到达时间
+static QueueHandle_t s_gps_uart_queue = NULL;
+static uint32_t s_gps_baud_rate = GPS_UART_BAUD_RATE;
+
+// Push stage latency, owned by the push task
+// 推送各阶段时延，由推送任务持有
+static gps_latency_stats_t s_latency;
+static int64_t s_latency_sum_us[5];
+static uint32_t s_push_cost_avg_us = 0;
+
 /**
  * @brief Initialize GPS data structure
  *        初始化 GPS 数据结构
@@ -67,11 +114,16 @@ static void init_gps_data(void) {
     GPS_Data.Course = 0.0;
     GPS_Data.Altitude = 0.0;
     GPS_Data.Num_Satellites = 0;
+    GPS_Data.HDOP = 0.0;
 
     GPS_Data.Velocity_North = 0.0;
     GPS_Data.Velocity_East = 0.0;
     GPS_Data.Velocity_Descend = 0.0;
 
+    GPS_Data.Horizontal_Accuracy = GPS_DEFAULT_HORIZONTAL_ACCURACY_MM;
+    GPS_Data.Vertical_Accuracy = GPS_DEFAULT_VERTICAL_ACCURACY_MM;
+    GPS_Data.Speed_Accuracy = GPS_DEFAULT_SPEED_ACCURACY_CM_S;
+
     // GPS_Data.Status = 0;
     GPS_Data.RMC_Valid = 0;
     GPS_Data.GGA_Valid = 0;
@@ -89,7 +141,9 @@ static void init_gps_data(void) {
  *              如果 GPS 连续无效次数小于10，返回 true；否则返回 false
  */
 bool is_gps_found(void) {
-    return (gps_invalid_count < 10);
+    gps_fix_t fix;
+    gps_get_latest_fix(&fix);
+    return (fix.invalid_count < 10);
 }
 
 /**
@@ -100,21 +154,222 @@ bool is_gps_found(void) {
  *              如果 GPS 状态为有效，返回 true；否则返回 false
  */
 bool is_current_gps_data_valid(void) {
-    if (GPS_Data.Status == 1) {
-        return true;
+    gps_fix_t fix;
+    gps_get_latest_fix(&fix);
+    return (fix.generation != 0 && fix.data.Status == 1);
+}
+
+/**
+ * @brief Publish the working GPS data as the latest fix
+ *        将当前工作中的 GPS 数据发布为最新定位
+ *
+ * Only called from the GPS receiving task, so there is a single writer. It only writes the slot that is
+ * not published, so a reader that preempts it always finds a complete snapshot.
+ * 仅由 GPS 接收任务调用，因此只有一个写入方。写入方只写未发布的槽位，因此抢占它的读取方总能读到完整快照。
+ */
+static void gps_publish_fix(int64_t timestamp_us, int64_t first_byte_us, int64_t received_us) {
+    uint32_t published = __atomic_load_n(&s_fix_published, __ATOMIC_RELAXED);
+    gps_snapshot_t *snapshot = &s_snapshots[(published + 1) & 1];
+
+    snapshot->fix.generation = s_snapshots[published & 1].fix.generation + 1;
+    snapshot->fix.invalid_count = gps_invalid_count;
+    snapshot->fix.timestamp_us = timestamp_us;
+    snapshot->fix.first_byte_us = first_byte_us;
+    snapshot->fix.received_us = received_us;
+    snapshot->fix.published_us = esp_timer_get_time();
+    snapshot->fix.data = GPS_Data;
+    snapshot->filter = s_kalman;
+
+    __atomic_store_n(&s_fix_published, published + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Copy part of the published snapshot
+ *        拷贝已发布快照的一部分
+ *
+ * Never waits for the writer. The copy is taken again whenever a publish completed while copying:
+ * the next publish may already be rewriting the slot being copied, and the counter does not show
+ * that until it ends.
+ * 从不等待写入方。拷贝期间只要有一次发布完成就重新拷贝：下一次发布可能已在改写正在拷贝的槽位，
+ * 而计数器要到该次发布结束才会体现。
+ *
+ * @param out Output buffer
+ *            输出缓冲区
+ * @param offset Offset of the part in gps_snapshot_t
+ *               该部分在 gps_snapshot_t 中的偏移
+ * @param length Length of the part
+ *               该部分的长度
+ */
+static void gps_copy_snapshot(void *out, size_t offset, size_t length) {
+    uint32_t published;
+    do {
+        published = __atomic_load_n(&s_fix_published, __ATOMIC_ACQUIRE);
+        memcpy(out, (const uint8_t *)&s_snapshots[published & 1] + offset, length);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (__atomic_load_n(&s_fix_published, __ATOMIC_RELAXED) != published);
+}
+
+/**
+ * @brief Take a consistent copy of the published snapshot
+ *        获取已发布快照的一致性副本
+ *
+ * @param out Output snapshot
+ *            输出的快照
+ */
+static void gps_read_snapshot(gps_snapshot_t *out) {
+    gps_copy_snapshot(out, 0, sizeof(*out));
+}
+
+/**
+ * @brief Get a consistent copy of the latest published fix
+ *        获取最新发布定位的一致性副本
+ *
+ * Never blocks the GPS task and never waits for it, see gps_copy_snapshot().
+ * 不会阻塞 GPS 任务，也不会等待它，见 gps_copy_snapshot()。
+ *
+ * @param out Output fix, generation is 0 if nothing has been published yet
+ *            输出的定位数据，尚未发布任何数据时 generation 为 0
+ * @return bool Returns true if the fix is valid, false otherwise
+ *              如果定位有效返回 true；否则返回 false
+ */
+bool gps_get_latest_fix(gps_fix_t *out) {
+    if (out == NULL) {
+        return false;
     }
-    return false;
+
+    gps_copy_snapshot(out, offsetof(gps_snapshot_t, fix), sizeof(*out));
+    return (out->generation != 0 && out->data.Status == 1);
 }
 
-// Store previous altitude and time for velocity calculation
-// 用于存储前一时刻的高度和时间，用于计算速度
-static double Previous_Altitude = 0.0;
-static double Previous_Time = 0.0;
+/**
+ * @brief Convert the UTC date and time of GPS data to Unix time
+ *        将 GPS 数据中的 UTC 日期时间转换为 Unix 时间
+ *
+ * @param gps GPS data, Year is years since 2000
+ *            GPS 数据，Year 为 2000 年以来的年数
+ * @return int64_t Seconds since 1970-01-01 00:00:00 UTC
+ *                 自 1970-01-01 00:00:00 UTC 以来的秒数
+ */
+int64_t gps_data_to_unix_time(const GPS_Data_t *gps) {
+    int64_t days = civil_days_from_date(gps->Year + 2000, gps->Month, gps->Day);
+    return days * 86400 + gps->Hour * 3600 + gps->Minute * 60 + (int64_t)gps->Second;
+}
 
-// Used to store the previous latitude and longitude for outlier removal
-// 用于存储前一时刻的纬度和经度，用于剔除异常值
-static double Previous_Latitude = 0.0;
-static double Previous_Longitude = 0.0;
+/**
+ * @brief Convert the UTC date and time of GPS data to Unix time in microseconds
+ *        将 GPS 数据中的 UTC 日期时间转换为微秒级 Unix 时间
+ *
+ * @param gps GPS data
+ *            GPS 数据
+ * @return int64_t Microseconds since 1970-01-01 00:00:00 UTC
+ *                 自 1970-01-01 00:00:00 UTC 以来的微秒数
+ */
+int64_t gps_data_to_unix_time_us(const GPS_Data_t *gps) {
+    return gps_data_to_unix_time(gps) * 1000000 + llround((gps->Second - (int)gps->Second) * 1e6);
+}
+
+/**
+ * @brief Set the UTC date and time of GPS data from Unix time in microseconds
+ *        使用微秒级 Unix 时间设置 GPS 数据中的 UTC 日期时间
+ *
+ * @param gps GPS data to modify
+ *            要修改的 GPS 数据
+ * @param utc_us Microseconds since 1970-01-01 00:00:00 UTC
+ *               自 1970-01-01 00:00:00 UTC 以来的微秒数
+ */
+static void gps_data_set_unix_time_us(GPS_Data_t *gps, int64_t utc_us) {
+    int64_t seconds = utc_us / 1000000;
+    int32_t second_of_day = (int32_t)(seconds % 86400);
+    civil_date_t date = civil_date_from_days(seconds / 86400);
+
+    gps->Year = (uint8_t)(date.year - 2000);
+    gps->Month = date.month;
+    gps->Day = date.day;
+    gps->Hour = (uint8_t)(second_of_day / 3600);
+    gps->Minute = (uint8_t)(second_of_day / 60 % 60);
+    gps->Second = second_of_day % 60 + (utc_us % 1000000) / 1e6;
+}
+
+/**
+ * @brief Advance the UTC time fields of GPS data
+ *        推进 GPS 数据中的 UTC 时间字段
+ *
+ * Goes through Unix time, so day, month and year rollover come from civil_time.
+ * 经由 Unix 时间换算，日、月、年的进位由 civil_time 处理。
+ *
+ * @param gps GPS data to modify
+ *            要修改的 GPS 数据
+ * @param seconds Seconds to add, must be non-negative
+ *                要增加的秒数，必须非负
+ */
+static void gps_time_add(GPS_Data_t *gps, double seconds) {
+    gps_data_set_unix_time_us(gps, gps_data_to_unix_time_us(gps) + llround(seconds * 1e6));
+}
+
+/**
+ * @brief Predict the latest fix forward to a given time
+ *        将最新定位预测到指定时刻
+ *
+ * Runs the Kalman prediction on a copy of the published filter state, so the camera can be fed
+ * at a steady rate between receiver epochs without touching the GPS task.
+ * 在已发布的滤波器状态副本上进行卡尔曼预测，使相机可以在接收机历元之间以稳定的频率获得数据，
+ * 且不影响 GPS 任务。
+ *
+ * @param time_us Target time (esp_timer, us)
+ *                目标时间（esp_timer，微秒）
+ * @param out Predicted fix
+ *            预测的定位数据
+ *
+ * @return bool Returns true if the prediction is valid, false if there is no recent valid fix
+ *              预测有效返回 true；没有近期有效定位时返回 false
+ */
+bool gps_predict_fix(int64_t time_us, gps_fix_t *out) {
+    static gps_snapshot_t snapshot;  // 仅推送任务调用，避免占用栈空间
+                                     // Only called from the push task, kept off the stack
+    gps_kalman_state_t state;
+
+    if (out == NULL) {
+        return false;
+    }
+
+    gps_read_snapshot(&snapshot);
+    *out = snapshot.fix;
+
+    if (out->generation == 0 || out->data.Status != 1) {
+        return false;
+    }
+
+    // 低更新率时允许预测跨过两个历元
+    // At low update rates allow prediction to span two epochs
+    int64_t max_age_ms = 2 * gps_get_update_interval();
+    if (max_age_ms < GPS_PUSH_MAX_PREDICT_MS) {
+        max_age_ms = GPS_PUSH_MAX_PREDICT_MS;
+    }
+
+    int64_t age_us = time_us - out->timestamp_us;
+    if (age_us < 0 || age_us > max_age_ms * 1000) {
+        return false;
+    }
+    if (!gps_kalman_predict(&snapshot.filter, time_us, &state)) {
+        return false;
+    }
+
+    GPS_Data_t *gps = &out->data;
+    gps->Latitude = state.latitude;
+    gps->Lat_Indicator = (state.latitude < 0) ? 'S' : 'N';
+    gps->Longitude = state.longitude;
+    gps->Lon_Indicator = (state.longitude < 0) ? 'W' : 'E';
+    gps->Altitude = state.altitude;
+    gps->Velocity_North = state.vel_north;
+    gps->Velocity_East = state.vel_east;
+    gps->Velocity_Descend = state.vel_down;
+    gps->Horizontal_Accuracy = (uint32_t)(state.horizontal_accuracy * 1000);
+    gps->Vertical_Accuracy = (uint32_t)(state.vertical_accuracy * 1000);
+    gps->Speed_Accuracy = (uint32_t)ceilf(state.speed_accuracy * 100);
+    gps_time_add(gps, age_us * 1e-6);
+    out->timestamp_us = time_us;
+    return true;
+}
 
 /**
  * @brief Convert NMEA format coordinates to decimal degrees
@@ -350,44 +605,16 @@ void Parse_GNGGA(char *sentence) {
                 GPS_Data.Num_Satellites = (uint8_t) atoi(token);
                 break;
             case 9:
-                // HDOP，可根据需要解析
-                // HDOP, can be parsed if needed
+                // HDOP，用于估计测量精度
+                // HDOP, used to estimate measurement accuracy
+                GPS_Data.HDOP = atof(token);
                 break;
             case 10:
                 // 海拔高度 (米)
                 // Altitude (meters)
                 GPS_Data.Altitude = atof(token);
-                // 计算下降速度 (需要上一高度和时间)
-                // Calculate descent velocity (needs previous altitude and time)
-                if (Previous_Time > 0.0) {
-                    double current_time = GPS_Data.Hour * 3600 + GPS_Data.Minute * 60 + GPS_Data.Second;
-                    double delta_time = current_time - Previous_Time;
-                    
-                    // 处理跨天情况
-                    // Handle day crossover
-                    if (delta_time < -43200) {  // 如果时间差小于-12小时，说明跨天了
-                                                // If time difference is less than -12 hours, day has changed
-                        delta_time += 86400;    // 加上24小时
-                                                // Add 24 hours
-                    } else if (delta_time > 43200) {  // 如果时间差大于12小时，说明是前一天的数据
-                                                      // If time difference is more than 12 hours, it's previous day's data
-                        delta_time -= 86400;
-                    }
-                    
-                    if (delta_time > 0 && delta_time < 10) {  // 只处理合理的时间差（比如小于10秒）
-                                                              // Only process reasonable time differences (e.g., less than 10 seconds)
-                        double delta_altitude = GPS_Data.Altitude - Previous_Altitude;
-                        // 过滤异常值（比如高度差太大）
-                        // Filter abnormal values (e.g., too large altitude differences)
-                        if (fabs(delta_altitude) < 100) {  // 假设最大垂直速度不超过100m/s
-                                                           // Assume maximum vertical speed doesn't exceed 100m/s
-                            GPS_Data.Velocity_Descend = -delta_altitude / delta_time;  // 注意符号：上升为负，下降为正
-                                                                                       // Note: negative for ascent, positive for descent
-                        }
-                    }
-                }
-                Previous_Altitude = GPS_Data.Altitude;
-                Previous_Time = GPS_Data.Hour * 3600 + GPS_Data.Minute * 60 + GPS_Data.Second;
+                // 下降速度由卡尔曼滤波器估计
+                // Descent velocity is estimated by the Kalman filter
                 break;
             // 其他字段可根据需要解析
             // Other fields can be parsed as needed
@@ -407,8 +634,13 @@ void Parse_GNGGA(char *sentence) {
  * 
  * @param buffer 包含 NMEA 语句的缓冲区
  *               Buffer containing NMEA sentences
+ *
+ * @return bool 缓冲区包含 RMC 或 GGA 语句时返回 true
+ *              Returns true if the buffer contained an RMC or GGA sentence
  */
-void Parse_NMEA_Buffer(char *buffer) {
+bool Parse_NMEA_Buffer(char *buffer) {
+    int fix_sentences = 0;
+
     init_gps_data();
 
     char *start = buffer; // 指向字符串的开始
@@ -428,12 +660,17 @@ void Parse_NMEA_Buffer(char *buffer) {
             line[line_length] = '\0'; // 确保以空字符结尾
                                       // Ensure null-terminated string
 
-            // 解析该行
-            // Parse the line
-            if (strncmp(line, "$GNRMC", 6) == 0 || strncmp(line, "$GPRMC", 6) == 0) {
+            // 解析该行，接收机命令应答交给命令引擎
+            // Parse the line, receiver command ACKs go to the command engine
+            if (gps_receiver_handle_line(line)) {
+                // ACK 已处理
+                // ACK consumed
+            } else if (strncmp(line, "$GNRMC", 6) == 0 || strncmp(line, "$GPRMC", 6) == 0) {
                 Parse_GNRMC(line);
+                fix_sentences++;
             } else if (strncmp(line, "$GNGGA", 6) == 0 || strncmp(line, "$GPGGA", 6) == 0) {
                 Parse_GNGGA(line);
+                fix_sentences++;
             }
         }
 
@@ -444,13 +681,24 @@ void Parse_NMEA_Buffer(char *buffer) {
     // 处理最后一行（如果没有以换行符结尾）
     // Process the last line (if not ending with newline)
     if (*start != '\0') {
-        if (strncmp(start, "$GNRMC", 6) == 0 || strncmp(start, "$GPRMC", 6) == 0) {
+        if (gps_receiver_handle_line(start)) {
+            // ACK 已处理
+            // ACK consumed
+        } else if (strncmp(start, "$GNRMC", 6) == 0 || strncmp(start, "$GPRMC", 6) == 0) {
             Parse_GNRMC(start);
+            fix_sentences++;
         } else if (strncmp(start, "$GNGGA", 6) == 0 || strncmp(start, "$GPGGA", 6) == 0) {
             Parse_GNGGA(start);
+            fix_sentences++;
         }
     }
 
+    // 只有命令应答或其他语句时不算作一个历元
+    // A chunk with only ACKs or other sentences is not an epoch
+    if (fix_sentences == 0) {
+        return false;
+    }
+
     // 在所有语句解析完成后，更新最终状态和位置数据
     // After parsing all sentences, update final status and position data
     if (GPS_Data.RMC_Valid && GPS_Data.GGA_Valid) {
@@ -462,18 +710,12 @@ void Parse_NMEA_Buffer(char *buffer) {
         GPS_Data.Latitude = (GPS_Data.RMC_Latitude + GPS_Data.GGA_Latitude) / 2.0;
         GPS_Data.Longitude = (GPS_Data.RMC_Longitude + GPS_Data.GGA_Longitude) / 2.0;
 
-        // 与前一时刻的纬度和经度做对比
-        // Compare with previous latitude and longitude
-        if (fabs(GPS_Data.Latitude - Previous_Latitude) > 0.009 || fabs(GPS_Data.Longitude - Previous_Longitude) > 0.0127) {
-            // 超过阈值，剔除异常值并更新前一时刻经纬度
-            // If the change exceeds threshold, set status to 0 and update the previous latitude and longitude
-            GPS_Data.Status = 0;
+        // NMEA 不直接给出精度，用 HDOP 乘以测距误差估计；异常值剔除交给卡尔曼滤波器
+        // NMEA has no accuracy fields, estimate them from HDOP times the ranging error; outliers are left to the Kalman filter
+        if (GPS_Data.HDOP > 0.0) {
+            GPS_Data.Horizontal_Accuracy = (uint32_t)(GPS_Data.HDOP * GPS_NMEA_UERE_M * 1000);
+            GPS_Data.Vertical_Accuracy = GPS_Data.Horizontal_Accuracy * 3 / 2;
         }
-
-        // 更新前一时刻的经纬度
-        // Update the previous latitude and longitude
-        Previous_Latitude = GPS_Data.Latitude;
-        Previous_Longitude = GPS_Data.Longitude;
     } else {
         GPS_Data.Status = 0;
         if (gps_invalid_count < UINT8_MAX) {  // 防止溢出
@@ -481,6 +723,364 @@ void Parse_NMEA_Buffer(char *buffer) {
             gps_invalid_count++;
         }
     }
+
+    return true;
+}
+
+/**
+ * @brief Fill GPS data from a UBX-NAV-PVT solution
+ *        使用 UBX-NAV-PVT 解填充 GPS 数据
+ *
+ * All fields come straight from the binary packet, including the accuracy estimates and NED velocity,
+ * so no text parsing or finite differencing is needed.
+ * 所有字段直接取自二进制包，包括精度估计和 NED 速度，无需文本解析或差分计算。
+ *
+ * @param pvt Decoded NAV-PVT payload
+ *            解码后的 NAV-PVT 载荷
+ */
+static void Parse_UBX_NAV_PVT(const ubx_nav_pvt_t *pvt) {
+    GPS_Data.Year = (uint8_t)(pvt->year % 100);
+    GPS_Data.Month = pvt->month;
+    GPS_Data.Day = pvt->day;
+    GPS_Data.Hour = pvt->hour;
+    GPS_Data.Minute = pvt->min;
+    GPS_Data.Second = pvt->sec + pvt->nano * 1e-9;
+
+    GPS_Data.Latitude = pvt->lat * 1e-7;
+    GPS_Data.Lat_Indicator = (pvt->lat < 0) ? 'S' : 'N';
+    GPS_Data.Longitude = pvt->lon * 1e-7;
+    GPS_Data.Lon_Indicator = (pvt->lon < 0) ? 'W' : 'E';
+
+    GPS_Data.Speed_knots = pvt->g_speed / 1000.0 / 0.514444;
+    GPS_Data.Course = pvt->head_mot * 1e-5;
+    GPS_Data.Altitude = pvt->h_msl / 1000.0;
+    GPS_Data.Num_Satellites = pvt->num_sv;
+
+    // NED velocity in mm/s, down is positive which matches Velocity_Descend
+    // NED 速度单位为 毫米/秒，向下为正，与 Velocity_Descend 一致
+    GPS_Data.Velocity_North = pvt->vel_n / 1000.0;
+    GPS_Data.Velocity_East = pvt->vel_e / 1000.0;
+    GPS_Data.Velocity_Descend = pvt->vel_d / 1000.0;
+
+    GPS_Data.Horizontal_Accuracy = pvt->h_acc;
+    GPS_Data.Vertical_Accuracy = pvt->v_acc;
+    GPS_Data.Speed_Accuracy = (pvt->s_acc + 9) / 10;  // mm/s 转换为 cm/s，向上取整
+                                                       // Convert mm/s to cm/s, round up
+
+    bool fix_ok = (pvt->flags & UBX_NAV_PVT_FLAGS_FIX_OK) &&
+                  (pvt->fix_type == UBX_FIX_TYPE_3D || pvt->fix_type == UBX_FIX_TYPE_GNSS_DR);
+    bool time_ok = (pvt->valid & (UBX_NAV_PVT_VALID_DATE | UBX_NAV_PVT_VALID_TIME)) ==
+                   (UBX_NAV_PVT_VALID_DATE | UBX_NAV_PVT_VALID_TIME);
+
+    GPS_Data.RMC_Valid = time_ok;
+    GPS_Data.GGA_Valid = fix_ok;
+    if (fix_ok && time_ok) {
+        GPS_Data.Status = 1;
+        gps_invalid_count = 0;
+    } else {
+        GPS_Data.Status = 0;
+        if (gps_invalid_count < UINT8_MAX) {
+            gps_invalid_count++;
+        }
+    }
+}
+
+/* -------------------------
+ *  GNSS input layer
+ *  GNSS 输入层
+ * ------------------------- */
+
+/**
+ * Each input protocol configures the receiver and consumes raw UART bytes.
+ * process() returns true when a new navigation epoch has been parsed into GPS_Data.
+ * 每种输入协议负责配置接收机并处理原始 UART 字节。
+ * 当新的导航历元被解析到 GPS_Data 中时，process() 返回 true。
+ */
+typedef struct {
+    const char *name;
+    bool has_vertical_velocity;   // Receiver reports vertical velocity
+                                  // 接收机是否输出垂直速度
+    void (*configure)(void);
+    void (*set_rate)(uint16_t interval_ms);
+    bool (*process)(const uint8_t *data, size_t length);
+} gps_input_t;
+
+// Current receiver update interval and camera push interval (ms)
+// 当前接收机更新间隔与相机推送间隔 (毫秒)
+static uint16_t s_update_interval_ms = GPS_UPDATE_INTERVAL_MS;
+static uint32_t s_push_interval_ms = GPS_PUSH_INTERVAL_MS;
+
+/**
+ * @brief Build a complete NMEA/PAIR sentence with checksum
+ *        构建带校验和的完整 NMEA/PAIR 语句
+ *
+ * The checksum is the XOR of all characters between '$' and '*'.
+ * 校验和为 '$' 与 '*' 之间所有字符的异或值。
+ *
+ * @param out Output buffer
+ *            输出缓冲区
+ * @param out_size Output buffer size
+ *                 输出缓冲区大小
+ * @param body Sentence body without '$', '*' and checksum, e.g. "PAIR050,100"
+ *             不含 '$'、'*' 和校验和的语句主体，例如 "PAIR050,100"
+ *
+ * @return int Sentence length on success, -1 if the buffer is too small
+ *             成功返回语句长度，缓冲区不足返回 -1
+ */
+int gps_build_nmea_sentence(char *out, size_t out_size, const char *body) {
+    uint8_t checksum = 0;
+    for (const char *p = body; *p != '\0'; p++) {
+        checksum ^= (uint8_t)*p;
+    }
+
+    int length = snprintf(out, out_size, "$%s*%02X\r\n", body, checksum);
+    if (length < 0 || (size_t)length >= out_size) {
+        return -1;
+    }
+    return length;
+}
+
+static void nmea_input_set_rate(uint16_t interval_ms) {
+    // PAIR050 设置定位间隔，>1Hz 仅 RMC 和 GGA 支持
+    // PAIR050 sets the fix interval, >1Hz only RMC and GGA supported
+    char body[24];
+    snprintf(body, sizeof(body), "PAIR050,%u", interval_ms);
+    gps_receiver_send_command(body, NULL, NULL);
+}
+
+static void nmea_baud_rate_done(const char *body, gps_receiver_result_t result, void *ctx) {
+    if (result != GPS_RECEIVER_RESULT_OK) {
+        ESP_LOGW(TAG, "Receiver kept %d baud", GPS_UART_BAUD_RATE);
+        return;
+    }
+    // 接收机确认后再切换本地波特率
+    // Switch the local baud rate only after the receiver confirmed
+    uart_set_baudrate(UART_GPS_PORT, GPS_UART_TARGET_BAUD_RATE);
+    s_gps_baud_rate = GPS_UART_TARGET_BAUD_RATE;
+    ESP_LOGI(TAG, "GPS UART switched to %d baud", GPS_UART_TARGET_BAUD_RATE);
+}
+
+static void nmea_input_configure(void) {
+    // PAIR062 语句类型：0 GGA, 1 GLL, 2 GSA, 3 GSV, 4 RMC, 5 VTG；只保留解析用到的 GGA 和 RMC
+    // PAIR062 sentence types: 0 GGA, 1 GLL, 2 GSA, 3 GSV, 4 RMC, 5 VTG; keep only GGA and RMC which we parse
+    static const struct {
+        uint8_t type;
+        uint8_t rate;
+    } sentences[] = {
+        { 0, 1 }, { 1, 0 }, { 2, 0 }, { 3, 0 }, { 4, 1 }, { 5, 0 },
+    };
+    char body[24];
+
+    for (size_t i = 0; i < sizeof(sentences) / sizeof(sentences[0]); i++) {
+        snprintf(body, sizeof(body), "PAIR062,%u,%u", sentences[i].type, sentences[i].rate);
+        gps_receiver_send_command(body, NULL, NULL);
+    }
+
+    // 导航模式（动态模型）
+    // Navigation mode (dynamic model)
+    snprintf(body, sizeof(body), "PAIR080,%d", GPS_NAV_MODE);
+    gps_receiver_send_command(body, NULL, NULL);
+
+    nmea_input_set_rate(s_update_interval_ms);
+
+    if (GPS_UART_TARGET_BAUD_RATE != GPS_UART_BAUD_RATE) {
+        snprintf(body, sizeof(body), "PAIR864,0,0,%d", GPS_UART_TARGET_BAUD_RATE);
+        gps_receiver_send_command(body, nmea_baud_rate_done, NULL);
+    }
+}
+
+static bool nmea_input_process(const uint8_t *data, size_t length) {
+    // 将读取到的数据存储到全局缓冲区 buff_t 中
+    // Store the read data into global buffer buff_t
+    memcpy(buff_t, data, length);
+    buff_t[length] = '\0'; // 确保缓冲区结束
+                           // Ensure buffer termination
+
+    // 解析数据
+    // Parse data
+    return Parse_NMEA_Buffer(buff_t);
+}
+
+static ubx_parser_t s_ubx_parser;
+
+static void ubx_input_send(uint8_t msg_class, uint8_t msg_id, const void *payload, uint16_t payload_length) {
+    uint8_t frame[UBX_HEADER_LENGTH + sizeof(ubx_cfg_prt_uart_t) + UBX_CHECKSUM_LENGTH];
+    size_t frame_length = ubx_build_message(msg_class, msg_id, payload, payload_length, frame, sizeof(frame));
+    if (frame_length > 0) {
+        uart_write_bytes(UART_GPS_PORT, (const char *)frame, frame_length);
+    }
+}
+
+static void ubx_input_set_rate(uint16_t interval_ms) {
+    // Navigation rate, UTC aligned
+    // 导航频率，对齐 UTC
+    ubx_cfg_rate_t rate = {
+        .meas_rate = interval_ms,
+        .nav_rate = 1,
+        .time_ref = 0,
+    };
+    ubx_input_send(UBX_CLASS_CFG, UBX_ID_CFG_RATE, &rate, sizeof(rate));
+}
+
+static void ubx_input_configure(void) {
+    ubx_parser_init(&s_ubx_parser);
+
+    // UART1: keep accepting NMEA/UBX input, output UBX only to free UART bandwidth
+    // UART1：保持接收 NMEA/UBX 输入，仅输出 UBX 以节省 UART 带宽
+    ubx_cfg_prt_uart_t prt = {
+        .port_id = UBX_CFG_PRT_UART_PORT_ID,
+        .mode = UBX_CFG_PRT_MODE_8N1,
+        .baud_rate = GPS_UART_BAUD_RATE,
+        .in_proto_mask = UBX_PROTO_MASK_UBX | UBX_PROTO_MASK_NMEA,
+        .out_proto_mask = UBX_PROTO_MASK_UBX,
+    };
+    ubx_input_send(UBX_CLASS_CFG, UBX_ID_CFG_PRT, &prt, sizeof(prt));
+
+    ubx_input_set_rate(s_update_interval_ms);
+
+    // One NAV-PVT per navigation solution
+    // 每个导航解输出一包 NAV-PVT
+    ubx_cfg_msg_t msg = {
+        .msg_class = UBX_CLASS_NAV,
+        .msg_id = UBX_ID_NAV_PVT,
+        .rate = 1,
+    };
+    ubx_input_send(UBX_CLASS_CFG, UBX_ID_CFG_MSG, &msg, sizeof(msg));
+}
+
+static bool ubx_input_process(const uint8_t *data, size_t length) {
+    bool new_epoch = false;
+    for (size_t i = 0; i < length; i++) {
+        if (!ubx_parser_feed(&s_ubx_parser, data[i])) {
+            continue;
+        }
+        ubx_nav_pvt_t pvt;
+        if (ubx_decode_nav_pvt(&s_ubx_parser, &pvt)) {
+            Parse_UBX_NAV_PVT(&pvt);
+            new_epoch = true;
+        } else if (s_ubx_parser.msg_class == UBX_CLASS_ACK && s_ubx_parser.msg_id == UBX_ID_ACK_NAK) {
+            ESP_LOGW(TAG, "Receiver rejected UBX message class=0x%02X id=0x%02X",
+                     s_ubx_parser.payload[0], s_ubx_parser.payload[1]);
+        }
+    }
+    return new_epoch;
+}
+
+static const gps_input_t s_gps_inputs[] = {
+    [GPS_INPUT_PROTOCOL_NMEA] = { "NMEA", false, nmea_input_configure, nmea_input_set_rate, nmea_input_process },
+    [GPS_INPUT_PROTOCOL_UBX]  = { "UBX",  true,  ubx_input_configure,  ubx_input_set_rate,  ubx_input_process },
+};
+
+static const gps_input_t *s_gps_input = &s_gps_inputs[GPS_INPUT_PROTOCOL];
+
+/**
+ * @brief Change the receiver navigation update interval
+ *        修改接收机导航更新间隔
+ *
+ * @param interval_ms Update interval (ms), 100/200/1000 for 10/5/1 Hz
+ *                    更新间隔 (毫秒)，100/200/1000 对应 10/5/1 Hz
+ */
+void gps_set_update_interval(uint16_t interval_ms) {
+    if (interval_ms == __atomic_load_n(&s_update_interval_ms, __ATOMIC_RELAXED)) {
+        return;
+    }
+    __atomic_store_n(&s_update_interval_ms, interval_ms, __ATOMIC_RELAXED);
+    s_gps_input->set_rate(interval_ms);
+    ESP_LOGI(TAG, "Receiver update interval set to %u ms", interval_ms);
+}
+
+/**
+ * @brief Get the receiver navigation update interval
+ *        获取接收机导航更新间隔
+ *
+ * @return uint16_t Update interval (ms)
+ *                  更新间隔 (毫秒)
+ */
+uint16_t gps_get_update_interval(void) {
+    return __atomic_load_n(&s_update_interval_ms, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Change the camera push interval, takes effect on the next push
+ *        修改相机推送间隔，下一次推送生效
+ *
+ * @param interval_ms Push interval (ms)
+ *                    推送间隔 (毫秒)
+ */
+void gps_set_push_interval(uint32_t interval_ms) {
+    __atomic_store_n(&s_push_interval_ms, interval_ms, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Run the Kalman filter on the epoch just parsed
+ *        对刚解析完成的历元运行卡尔曼滤波
+ *
+ * Replaces position, velocity and accuracy in GPS_Data with the filtered estimate. A fix that fails
+ * the innovation gate is marked invalid instead of being pushed.
+ * 使用滤波估计替换 GPS_Data 中的位置、速度和精度。未通过新息门限的定位会被标记为无效，不会推送。
+ *
+ * @param timestamp_us Local time of the epoch (us)
+ *                     历元对应的本地时间 (微秒)
+ */
+static void gps_filter_epoch(int64_t timestamp_us) {
+    if (GPS_Data.Status != 1) {
+        return;
+    }
+
+    double speed_m_s = GPS_Data.Speed_knots * 0.514444;
+    gps_kalman_measurement_t meas = {
+        .latitude = GPS_Data.Latitude,
+        .longitude = GPS_Data.Longitude,
+        .altitude = GPS_Data.Altitude,
+        .vel_north = GPS_Data.Velocity_North,
+        .vel_east = GPS_Data.Velocity_East,
+        .vel_down = GPS_Data.Velocity_Descend,
+        .pos_sigma_h = GPS_Data.Horizontal_Accuracy / 1000.0f,
+        .pos_sigma_v = GPS_Data.Vertical_Accuracy / 1000.0f,
+        .vel_sigma_h = GPS_Data.Speed_Accuracy / 100.0f,
+        .vel_sigma_v = s_gps_input->has_vertical_velocity ? GPS_Data.Speed_Accuracy / 100.0f : 0.0f,
+    };
+    // NMEA 航向在低速时不可靠，此时放宽水平速度测量
+    // NMEA course is unreliable at low speed, loosen the horizontal velocity measurement there
+    if (!s_gps_input->has_vertical_velocity && speed_m_s < 0.5) {
+        meas.vel_sigma_h += 0.5f;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    gps_kalman_result_t result = gps_kalman_update(&s_kalman, &meas, timestamp_us);
+    int64_t cost_us = esp_timer_get_time() - start_us;
+
+    s_kalman_time_total_us += cost_us;
+    if (cost_us > s_kalman_time_max_us) {
+        s_kalman_time_max_us = cost_us;
+    }
+    uint32_t runs = s_kalman.update_count + s_kalman.reject_count + s_kalman.reset_count;
+    if (runs % GPS_KALMAN_STATS_INTERVAL == 0) {
+        ESP_LOGI(TAG, "Kalman: %lu updates, %lu rejected, %lu resets, avg %lld us, max %lld us",
+                 (unsigned long)s_kalman.update_count, (unsigned long)s_kalman.reject_count,
+                 (unsigned long)s_kalman.reset_count, (long long)(s_kalman_time_total_us / runs), (long long)s_kalman_time_max_us);
+        s_kalman_time_total_us = 0;
+        s_kalman_time_max_us = 0;
+    }
+
+    if (result == GPS_KALMAN_REJECTED) {
+        // 新息过大，视为异常值
+        // Innovation too large, treat as outlier
+        GPS_Data.Status = 0;
+        return;
+    }
+
+    gps_kalman_state_t state;
+    gps_kalman_predict(&s_kalman, timestamp_us, &state);
+    GPS_Data.Latitude = state.latitude;
+    GPS_Data.Longitude = state.longitude;
+    GPS_Data.Altitude = state.altitude;
+    GPS_Data.Velocity_North = state.vel_north;
+    GPS_Data.Velocity_East = state.vel_east;
+    GPS_Data.Velocity_Descend = state.vel_down;
+    GPS_Data.Horizontal_Accuracy = (uint32_t)(state.horizontal_accuracy * 1000);
+    GPS_Data.Vertical_Accuracy = (uint32_t)(state.vertical_accuracy * 1000);
+    GPS_Data.Speed_Accuracy = (uint32_t)ceilf(state.speed_accuracy * 100);
 }
 
 /**
@@ -489,20 +1089,23 @@ void Parse_NMEA_Buffer(char *buffer) {
  * 
  * 将当前的 GPS 数据以日志的形式输出。
  * Output current GPS data in log format.
+ *
+ * @param gps GPS data to print
+ *            要打印的 GPS 数据
  */
-void print_gps_data() {
+void print_gps_data(const GPS_Data_t *gps) {
     ESP_LOGI(TAG, 
         "GPS Data: Time=%02d:%02d:%06.3f, Date=%02d-%02d-20%02d, "
         "Lat=%f %c, Lon=%f %c, Speed=%.2f knots, Course=%.2f deg, "
         "Altitude=%.2f m, Satellites=%d, V_North=%.2f m/s, V_East=%.2f m/s, V_Descend=%.2f m/s",
-        GPS_Data.Hour, GPS_Data.Minute, GPS_Data.Second,
-        GPS_Data.Day, GPS_Data.Month, GPS_Data.Year,
-        GPS_Data.Latitude, GPS_Data.Lat_Indicator,
-        GPS_Data.Longitude, GPS_Data.Lon_Indicator,
-        GPS_Data.Speed_knots, GPS_Data.Course,
-        GPS_Data.Altitude, GPS_Data.Num_Satellites,
-        GPS_Data.Velocity_North, GPS_Data.Velocity_East,
-        GPS_Data.Velocity_Descend
+        gps->Hour, gps->Minute, gps->Second,
+        gps->Day, gps->Month, gps->Year,
+        gps->Latitude, gps->Lat_Indicator,
+        gps->Longitude, gps->Lon_Indicator,
+        gps->Speed_knots, gps->Course,
+        gps->Altitude, gps->Num_Satellites,
+        gps->Velocity_North, gps->Velocity_East,
+        gps->Velocity_Descend
     );
 }
 
@@ -512,40 +1115,44 @@ void print_gps_data() {
  * 
  * 将当前的 GPS 数据转换为指定格式，并通过命令逻辑推送到相机。
  * Convert current GPS data to specified format and push to camera through command logic.
+ *
+ * @param gps GPS data to push, taken from the published snapshot
+ *            要推送的 GPS 数据，取自已发布的快照
  */
-void gps_push_data() {
-    // 时间转换
-    // Time conversion
-    int32_t year_month_day = (GPS_Data.Year + 2000) * 10000 + GPS_Data.Month * 100 + GPS_Data.Day;
-    int32_t hour_minute_second = (GPS_Data.Hour + 8) * 10000 + GPS_Data.Minute * 100 + (int32_t)GPS_Data.Second;
+void gps_push_data(const GPS_Data_t *gps) {
+    // 时间转换，UTC 转为配置的本地时间，跨日时日期随之进位；相机只接收整秒，小数部分向下取整
+    // Time conversion, UTC to the configured local time with the date rolling over accordingly; the
+    // camera only takes whole seconds, so the fraction is floored
+    uint32_t year_month_day, hour_minute_second;
+    time_zone_logic_to_local(gps_data_to_unix_time(gps), &year_month_day, &hour_minute_second);
 
     // 经纬度转换
     // Longitude and latitude conversion
-    int32_t gps_longitude = (int32_t)(GPS_Data.Longitude * 1e7);
-    int32_t gps_latitude = (int32_t)(GPS_Data.Latitude * 1e7);
+    int32_t gps_longitude = (int32_t)(gps->Longitude * 1e7);
+    int32_t gps_latitude = (int32_t)(gps->Latitude * 1e7);
 
     // 高度转换
     // Height conversion
-    int32_t height = (int32_t)(GPS_Data.Altitude * 1000);    // 单位 mm
+    int32_t height = (int32_t)(gps->Altitude * 1000);    // 单位 mm
                                                              // Unit: mm
 
     // 速度转换
     // Speed conversion
-    float speed_to_north = GPS_Data.Velocity_North * 100;    // m/s 转换为 cm/s
+    float speed_to_north = gps->Velocity_North * 100;    // m/s 转换为 cm/s
                                                              // Convert m/s to cm/s
-    float speed_to_east = GPS_Data.Velocity_East * 100;      // m/s 转换为 cm/s
+    float speed_to_east = gps->Velocity_East * 100;      // m/s 转换为 cm/s
                                                              // Convert m/s to cm/s
-    float speed_to_wnward = GPS_Data.Velocity_Descend * 100; // m/s 转换为 cm/s
+    float speed_to_wnward = gps->Velocity_Descend * 100; // m/s 转换为 cm/s
                                                              // Convert m/s to cm/s
 
     // 卫星数量
     // Number of satellites
-    uint32_t satellite_number = GPS_Data.Num_Satellites;
+    uint32_t satellite_number = gps->Num_Satellites;
 
     // 打印数据
     // ESP_LOGI(TAG, "GPS Data:");
     // ESP_LOGI(TAG, "  YearMonthDay (uint32_t): %lu", (unsigned long)year_month_day);
-    // ESP_LOGI(TAG, "  HourMinuteSecond (uint32_t, UTC+8): %lu", (unsigned long)hour_minute_second);
+    // ESP_LOGI(TAG, "  HourMinuteSecond (uint32_t, local): %lu", (unsigned long)hour_minute_second);
     // ESP_LOGI(TAG, "  Longitude (uint32_t, scaled): %lu", (unsigned long)gps_longitude);
     // ESP_LOGI(TAG, "  Latitude (uint32_t, scaled): %lu", (unsigned long)gps_latitude);
     // ESP_LOGI(TAG, "  Height (uint32_t, mm): %lu", (unsigned long)height);
@@ -557,29 +1164,26 @@ void gps_push_data() {
     // 创建 GPS 数据帧
     // Create GPS data frame
     gps_data_push_command_frame gps_frame = {
-        .year_month_day = year_month_day,
-        .hour_minute_second = hour_minute_second,
+        .year_month_day = (int32_t)year_month_day,
+        .hour_minute_second = (int32_t)hour_minute_second,
         .gps_longitude = gps_longitude,
         .gps_latitude = gps_latitude,
         .height = height,
         .speed_to_north = speed_to_north,
         .speed_to_east = speed_to_east,
         .speed_to_wnward = speed_to_wnward,
-        .vertical_accuracy = 1000,    // 垂直默认精度为 1000 mm
-                                      // Default vertical accuracy is 1000 mm
-        .horizontal_accuracy = 1000,  // 水平精度为 1000 mm
-                                      // Horizontal accuracy is 1000 mm
-        .speed_accuracy = 10,         // 速度精度为 10 cm/s
-                                      // Speed accuracy is 10 cm/s
+        .vertical_accuracy = gps->Vertical_Accuracy,      // 垂直精度 mm
+                                                              // Vertical accuracy in mm
+        .horizontal_accuracy = gps->Horizontal_Accuracy,  // 水平精度 mm
+                                                              // Horizontal accuracy in mm
+        .speed_accuracy = gps->Speed_Accuracy,            // 速度精度 cm/s
+                                                              // Speed accuracy in cm/s
         .satellite_number = satellite_number
     };
 
-    // 推送 GPS 数据到相机，无应答，默认返回 NULL
-    // Push GPS data to camera, no response, returns NULL by default
-    gps_data_push_response_frame *response = command_logic_push_gps_data(&gps_frame);
-    if (response != NULL) {
-        free(response);
-    }
+    // 推送 GPS 数据到所有已连接的相机，帧只构建一次，无应答
+    // Push GPS data to every connected camera, the frame is built once, no response
+    command_logic_push_gps_data(&gps_frame);
 }
 
 /**
@@ -592,7 +1196,7 @@ void gps_push_data() {
 static void initUartGps(void)
 {
     const uart_config_t uart_config = {
-        .baud_rate = 115200,
+        .baud_rate = GPS_UART_BAUD_RATE,
         .data_bits = UART_DATA_8_BITS,
         .parity = UART_PARITY_DISABLE,
         .stop_bits = UART_STOP_BITS_1,
@@ -601,9 +1205,25 @@ static void initUartGps(void)
         .source_clk = LP_UART_SCLK_DEFAULT,     //LP UART
     };
     // We won't use a buffer for sending data.
-    uart_driver_install(UART_GPS_PORT, RX_BUF_SIZE * 2, 0, 0, NULL, 0);
+    // The event queue wakes the receiving task as soon as a burst ends, instead of polling.
+    // 事件队列在一批数据结束时立即唤醒接收任务，无需轮询。
+    uart_driver_install(UART_GPS_PORT, RX_BUF_SIZE * 2, 0, 20, &s_gps_uart_queue, 0);
     uart_param_config(UART_GPS_PORT, &uart_config);
     uart_set_pin(UART_GPS_PORT, UART_GPS_TXD_PIN, UART_GPS_RXD_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    uart_set_rx_timeout(UART_GPS_PORT, GPS_UART_RX_TIMEOUT_SYMBOLS);
+}
+
+/**
+ * @brief 向 GPS UART 写入数据
+ *        Write data to GPS UART
+ *
+ * @param data 待写入的数据
+ *             Data to write
+ * @param length 数据长度
+ *               Data length
+ */
+static void gps_uart_write(const char *data, size_t length) {
+    uart_write_bytes(UART_GPS_PORT, data, length);
 }
 
 /**
@@ -621,46 +1241,220 @@ static void rx_task_GPS(void *arg)
     static const char *RX_TASK_TAG = "RX_TASK_GPS";
     esp_log_level_set(RX_TASK_TAG, ESP_LOG_INFO);
     uint8_t* data = (uint8_t*) malloc(RX_BUF_SIZE + 1);
+    size_t burst_length = 0;
+    int64_t first_byte_us = 0;
+    uart_event_t event;
 
     while (1) {
-        const int rxBytes = uart_read_bytes(UART_GPS_PORT, data, RX_BUF_SIZE, 20 / portTICK_PERIOD_MS);
-        if (rxBytes > 0) {
-            // 给看门狗喂狗的机会
-            // Give watchdog a chance to reset
-            vTaskDelay(pdMS_TO_TICKS(5));
+        // 发送排队的接收机命令并处理 ACK 超时
+        // Send queued receiver commands and handle ACK timeouts
+        gps_receiver_poll((uint32_t)(esp_timer_get_time() / 1000));
 
-            data[rxBytes] = '\0';
+        if (xQueueReceive(s_gps_uart_queue, &event, pdMS_TO_TICKS(20)) != pdTRUE) {
+            continue;
+        }
+        int64_t event_us = esp_timer_get_time();
+
+        if (event.type == UART_FIFO_OVF || event.type == UART_BUFFER_FULL) {
+            ESP_LOGW(RX_TASK_TAG, "GPS UART overflow, input flushed");
+            uart_flush_input(UART_GPS_PORT);
+            xQueueReset(s_gps_uart_queue);
+            burst_length = 0;
+            continue;
+        }
+        if (event.type != UART_DATA) {
+            continue;
+        }
+
+        size_t space = RX_BUF_SIZE - burst_length;
+        const int rxBytes = uart_read_bytes(UART_GPS_PORT, data + burst_length, (event.size < space) ? event.size : space, 0);
+        if (rxBytes <= 0) {
+            continue;
+        }
+
+        if (burst_length == 0) {
+            // 由字节时间反推第一个字节的到达时间：超时事件在最后一个字节之后空闲一段时间才触发
+            // Work back to the arrival of the first byte from the byte time: a timeout event fires
+            // only after the line has been idle for a while following the last byte
+            int64_t byte_us = 10 * 1000000LL / s_gps_baud_rate;
+            int64_t last_byte_us = event_us - (event.timeout_flag ? GPS_UART_RX_TIMEOUT_SYMBOLS * byte_us : 0);
+            first_byte_us = last_byte_us - (rxBytes - 1) * byte_us;
+        }
+        burst_length += rxBytes;
+
+        // 一批输出以接收超时结束，之前的事件只是 FIFO 满
+        // A burst ends with the RX timeout, earlier events only mean the FIFO filled up
+        if (!event.timeout_flag && burst_length < RX_BUF_SIZE) {
+            continue;
+        }
 
-            // ESP_LOGI(RX_TASK_TAG, "Read %d bytes: '%s'", rxBytes, data);
+        data[burst_length] = '\0';
 
-            // 将读取到的数据存储到全局缓冲区 buff_t 中
-            // Store the read data into global buffer buff_t
-            memcpy(buff_t, data, rxBytes);
-            buff_t[rxBytes] = '\0'; // 确保缓冲区结束
-                                    // Ensure buffer termination
+        // ESP_LOGI(RX_TASK_TAG, "Read %d bytes: '%s'", (int)burst_length, data);
 
-            // 解析数据
-            // Parse data
-            Parse_NMEA_Buffer(buff_t);
+        // 交给当前输入协议解析
+        // Hand over to the selected input protocol
+        bool new_epoch = s_gps_input->process(data, burst_length);
+        burst_length = 0;
 
-            // 给看门狗喂狗的机会
-            // Give watchdog a chance to reset
-            vTaskDelay(pdMS_TO_TICKS(5));
+        if (new_epoch) {
+            int64_t epoch_time_us = first_byte_us - GPS_RECEIVER_OUTPUT_DELAY_US;
+            if (GPS_Data.Status == 1) {
+                int64_t utc_us = gps_data_to_unix_time_us(&GPS_Data);
+                gps_time_logic_on_epoch(utc_us, first_byte_us, epoch_time_us);
+
+                // PPS 校准后，历元时刻直接由其 UTC 换算，不再受串口与接收机输出延迟影响
+                // Once PPS disciplined, the epoch's local time follows from its UTC, free of UART
+                // and receiver output delay
+                gps_time_utc_to_local(utc_us, &epoch_time_us);
+            }
+            gps_filter_epoch(epoch_time_us);
+
+            // 解析完成后一次性发布，读取方不会看到半解析的数据
+            // Publish once parsing is complete so readers never see a half-parsed epoch
+            gps_publish_fix(epoch_time_us, first_byte_us, event_us);
+
+            if (GPS_Data.Status == 1) {
+                gps_aiding_on_fix(&GPS_Data);
+                track_logic_log_fix(&GPS_Data);
+                geofence_logic_on_fix(&GPS_Data);
+                rule_logic_set_input(RULE_INPUT_SPEED, (int32_t)lround(hypot(GPS_Data.Velocity_North, GPS_Data.Velocity_East) * 36.0));
+                rule_logic_set_input(RULE_INPUT_ALTITUDE, (int32_t)lround(GPS_Data.Altitude));
+                rule_logic_set_input(RULE_INPUT_SATELLITES, GPS_Data.Num_Satellites);
+            }
 
             // 打印解析后的GPS数据
             // Print parsed GPS data
-            // print_gps_data();
+            // print_gps_data(&GPS_Data);
+        }
+    }
+    free(data);
+}
+
+/**
+ * @brief Account one push in the latency statistics
+ *        将一次推送计入时延统计
+ *
+ * @param fix Pushed fix
+ *            推送的定位
+ * @param push_start_us Time the push started
+ *                      推送开始时间
+ * @param push_done_us Time the BLE write returned
+ *                     BLE 写入返回时间
+ */
+static void gps_latency_account(const gps_fix_t *fix, int64_t push_start_us, int64_t push_done_us) {
+    int64_t stages[5] = {
+        fix->received_us - fix->first_byte_us,
+        fix->published_us - fix->received_us,
+        push_start_us - fix->published_us,
+        push_done_us - push_start_us,
+        push_done_us - fix->first_byte_us,
+    };
+    for (int i = 0; i < 5; i++) {
+        s_latency_sum_us[i] += stages[i];
+    }
+
+    // 推送耗时的滑动平均，用于外推到实际发送时刻
+    // Running average of the push cost, used to extrapolate to the actual transmission time
+    s_push_cost_avg_us = (s_push_cost_avg_us * 7 + (uint32_t)stages[3]) / 8;
+
+    int64_t age_us = stages[4];
+    if (age_us > s_latency.age_max_us) {
+        s_latency.age_max_us = (uint32_t)age_us;
+    }
+    int bucket = (int)(age_us / (GPS_LATENCY_BUCKET_MS * 1000));
+    if (bucket >= GPS_LATENCY_BUCKETS) {
+        bucket = GPS_LATENCY_BUCKETS - 1;
+    }
+    s_latency.age_histogram[bucket < 0 ? 0 : bucket]++;
+    s_latency.count++;
+
+    uint32_t *averages[5] = { &s_latency.rx_avg_us, &s_latency.parse_avg_us, &s_latency.hold_avg_us,
+                              &s_latency.push_avg_us, &s_latency.age_avg_us };
+    for (int i = 0; i < 5; i++) {
+        *averages[i] = (uint32_t)(s_latency_sum_us[i] / s_latency.count);
+    }
+
+    if (s_latency.count < GPS_LATENCY_LOG_INTERVAL) {
+        return;
+    }
 
-            if(connect_logic_get_state() == PROTOCOL_CONNECTED && is_current_gps_data_valid()){
-                gps_push_data();
+    // 固定格式，便于 tools/latency_report.py 离线统计
+    // Fixed format so tools/latency_report.py can build an offline report
+    char histogram[GPS_LATENCY_BUCKETS * 6];
+    int length = 0;
+    for (int i = 0; i < GPS_LATENCY_BUCKETS; i++) {
+        length += snprintf(histogram + length, sizeof(histogram) - length, " %lu", (unsigned long)s_latency.age_histogram[i]);
+    }
+    ESP_LOGI(TAG, "GPS latency n=%lu rx=%lu parse=%lu hold=%lu push=%lu age=%lu max=%lu us",
+             (unsigned long)s_latency.count, (unsigned long)s_latency.rx_avg_us, (unsigned long)s_latency.parse_avg_us,
+             (unsigned long)s_latency.hold_avg_us, (unsigned long)s_latency.push_avg_us,
+             (unsigned long)s_latency.age_avg_us, (unsigned long)s_latency.age_max_us);
+    ESP_LOGI(TAG, "GPS age histogram %dms:%s", GPS_LATENCY_BUCKET_MS, histogram);
+
+    memset(&s_latency, 0, sizeof(s_latency));
+    memset(s_latency_sum_us, 0, sizeof(s_latency_sum_us));
+}
+
+/**
+ * @brief Get push latency statistics since the last log line
+ *        获取自上次打印以来的推送时延统计
+ *
+ * @param out Output statistics
+ *            输出的统计信息
+ */
+void gps_get_latency_stats(gps_latency_stats_t *out) {
+    if (out != NULL) {
+        *out = s_latency;
+    }
+}
 
+/**
+ * @brief GPS 数据推送任务
+ *        GPS data push task
+ *
+ * 以固定频率将滤波预测后的定位推送到相机，与接收机更新率解耦；静止或未变化时由推送策略降低频率。
+ * Push the filter-predicted fix to the camera at a fixed rate, decoupled from the receiver rate;
+ * the push policy thins this out while the fix is stationary or unchanged.
+ *
+ * @param arg 任务参数
+ *            Task parameters
+ */
+static void push_task_GPS(void *arg)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+    bool first_push_done = false;
+
+    while (1) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(__atomic_load_n(&s_push_interval_ms, __ATOMIC_RELAXED)));
+
+        if (connect_logic_get_state() != PROTOCOL_CONNECTED) {
+            // 重新连接后立即推送第一个定位
+            // Push the first fix right away after reconnecting
+            gps_push_logic_reset();
+            continue;
+        }
+
+        // 外推到帧真正写入 BLE 的时刻，而不是开始构建帧的时刻
+        // Extrapolate to when the frame actually goes out over BLE, not when building it starts
+        gps_fix_t fix;
+        int64_t now_us = esp_timer_get_time();
+        if (gps_predict_fix(now_us + s_push_cost_avg_us, &fix) && gps_push_logic_should_push(&fix.data, now_us)) {
+            // 有 PPS 时使用校准后的时钟给推送打时间戳
+            // With PPS, timestamp the push from the disciplined clock
+            int64_t utc_us;
+            if (gps_time_local_to_utc(fix.timestamp_us, &utc_us) == GPS_TIME_SOURCE_PPS) {
+                gps_data_set_unix_time_us(&fix.data, utc_us);
+            }
+
+            if (!first_push_done) {
+                ESP_LOGI(TAG, "First GPS push %lld ms after boot", (long long)(now_us / 1000));
+                first_push_done = true;
             }
+            gps_push_data(&fix.data);
+            gps_latency_account(&fix, now_us, esp_timer_get_time());
         }
-        // 如果没有数据读取，休眠一小段时间，避免任务占用 CPU
-        // If no data is read, sleep for a short time to avoid CPU occupation
-        vTaskDelay(pdMS_TO_TICKS(10));
     }
-    free(data);
 }
 
 /**
@@ -672,16 +1466,25 @@ static void rx_task_GPS(void *arg)
  */
 void initSendGpsDataToCameraTask(void) {
     initUartGps();
-    // "$PAIR050,1000*12\r\n" 为 1Hz 更新率
-    // "$PAIR050,1000*12\r\n" for 1Hz update rate
-    // "$PAIR050,500*26\r\n" 为 5Hz 更新率
-    // "$PAIR050,500*26\r\n" for 5Hz update rate
-    // "$PAIR050,100*22\r\n" 为 10Hz 更新率
-    // "$PAIR050,100*22\r\n" for 10Hz update rate
-    char* gps_command = "$PAIR050,100*22\r\n";  // （>1Hz 仅 RMC 和 GGA 支持）
-                                                // (>1Hz only RMC and GGA supported)
-    uart_write_bytes(UART_GPS_PORT, gps_command, strlen(gps_command));
-    
+    init_gps_data();
+    gps_receiver_init(gps_uart_write);
+
+    // 配置接收机输出协议与更新率
+    // Configure receiver output protocol and update rate
+    ESP_LOGI(TAG, "GNSS input protocol: %s", s_gps_input->name);
+    s_gps_input->configure();
+
+    // 注入上次的位置和时间以加快首次定位（辅助命令为 PAIR 格式）
+    // Inject the last position and time to speed up the first fix (aiding commands are PAIR)
+    if (GPS_INPUT_PROTOCOL == GPS_INPUT_PROTOCOL_NMEA) {
+        gps_aiding_inject();
+    }
+
+    gps_kalman_init(&s_kalman, GPS_KALMAN_ACCEL_NOISE_H, GPS_KALMAN_ACCEL_NOISE_V);
+    gps_push_logic_init();
+    gps_time_logic_init();
+
     xTaskCreate(rx_task_GPS, "uart_rx_task_GPS", 1024 * 4, NULL, 0, NULL);
+    xTaskCreate(push_task_GPS, "push_task_GPS", 1024 * 3, NULL, 0, NULL);
     ESP_LOGI(TAG, "uart_rx_task_GPS are running\n");
 }
@@ -37,6 +37,75 @@
 #define UART_GPS_PORT LP_UART_NUM_0
 #define RX_BUF_SIZE 800
 
+// Receiver UART baud rate at power-up, and the rate requested with PAIR864 at boot
+// (set to 460800 or 921600 to cut transfer time; equal values keep the power-up rate)
+// 接收机上电默认波特率，以及启动时通过 PAIR864 请求的波特率
+//（设为 460800 或 921600 可缩短传输时间；两者相同则保持上电波特率）
+#define GPS_UART_BAUD_RATE        115200
+#ifndef GPS_UART_TARGET_BAUD_RATE
+#define GPS_UART_TARGET_BAUD_RATE GPS_UART_BAUD_RATE
+#endif
+
+// Idle time that ends a burst of receiver output, in byte times (RX timeout interrupt)
+// 结束一批接收机输出的空闲时间，以字节时间为单位（接收超时中断）
+#define GPS_UART_RX_TIMEOUT_SYMBOLS 20
+
+// Receiver delay from the measurement epoch to the first output byte (us), 0 if not calibrated
+// 接收机从测量历元到输出第一个字节的延迟 (微秒)，未标定时为 0
+#ifndef GPS_RECEIVER_OUTPUT_DELAY_US
+#define GPS_RECEIVER_OUTPUT_DELAY_US 0
+#endif
+
+// Receiver navigation mode set with PAIR080: 0 normal, 1 fitness, 2 aviation, 3 balloon, 4 stationary
+// 通过 PAIR080 设置的接收机导航模式：0 普通，1 运动，2 航空，3 气球，4 静止
+#ifndef GPS_NAV_MODE
+#define GPS_NAV_MODE 0
+#endif
+
+// GNSS input protocol selection
+// GNSS 输入协议选择
+#define GPS_INPUT_PROTOCOL_NMEA 0   // NMEA text (RMC + GGA), default for the PAIR receiver
+                                    // NMEA 文本（RMC + GGA），PAIR 接收机默认使用
+#define GPS_INPUT_PROTOCOL_UBX  1   // u-blox binary UBX-NAV-PVT, one packet per epoch
+                                    // u-blox 二进制 UBX-NAV-PVT，每个历元一包
+#ifndef GPS_INPUT_PROTOCOL
+#define GPS_INPUT_PROTOCOL GPS_INPUT_PROTOCOL_NMEA
+#endif
+
+// Receiver navigation update interval at boot (ms), changed at runtime by the rate governor
+// 启动时的接收机导航更新间隔 (毫秒)，运行时由频率调节器修改
+#define GPS_UPDATE_INTERVAL_MS 100
+
+// Default accuracy estimates when the receiver does not report them (NMEA)
+// 接收机未上报精度时使用的默认值（NMEA）
+#define GPS_DEFAULT_HORIZONTAL_ACCURACY_MM 1000
+#define GPS_DEFAULT_VERTICAL_ACCURACY_MM   1000
+#define GPS_DEFAULT_SPEED_ACCURACY_CM_S    10
+
+// Ranging error used to turn NMEA HDOP into a position accuracy (m)
+// 将 NMEA HDOP 转换为位置精度时使用的测距误差 (米)
+#define GPS_NMEA_UERE_M 2.5
+
+// Kalman filter process noise, how hard the platform is expected to accelerate (m/s^2)
+// 卡尔曼滤波过程噪声，即载体预期的加速度 (米/秒^2)
+#define GPS_KALMAN_ACCEL_NOISE_H 2.0f
+#define GPS_KALMAN_ACCEL_NOISE_V 1.0f
+
+// Camera push interval at boot, independent of the receiver rate (ms)
+// 启动时的相机推送周期，与接收机更新率无关 (毫秒)
+#define GPS_PUSH_INTERVAL_MS 100
+
+// Stop pushing when the last accepted fix is older than this (ms)
+// 最近一次有效定位超过该时长后停止推送 (毫秒)
+#define GPS_PUSH_MAX_PREDICT_MS 1000
+
+// End-to-end age histogram of pushed fixes, logged every GPS_LATENCY_LOG_INTERVAL pushes
+// 推送定位的端到端时延直方图，每 GPS_LATENCY_LOG_INTERVAL 次推送打印一次
+#define GPS_LATENCY_BUCKET_MS     10
+#define GPS_LATENCY_BUCKETS       20      // Last bucket also counts everything older
+                                          // 最后一个桶也统计所有更大的值
+#define GPS_LATENCY_LOG_INTERVAL  600
+
 typedef struct {
     // Time
     // 时间
@@ -72,9 +141,11 @@ typedef struct {
                               // 海拔高度 (米)
     uint8_t Num_Satellites;   // Number of Visible Satellites
                               // 可见卫星数量
+    double HDOP;              // Horizontal dilution of precision
+                              // 水平精度因子
 
-    // Calculated Velocity Components
-    // 计算后的速度分量
+    // Velocity Components (Kalman filtered)
+    // 速度分量（卡尔曼滤波后）
     double Velocity_North;    // Northward Velocity (m/s)
                               // 向北速度 (米/秒)
     double Velocity_East;     // Eastward Velocity (m/s)
@@ -82,6 +153,15 @@ typedef struct {
     double Velocity_Descend;  // Descent Velocity (m/s)
                               // 下降速度 (米/秒)
 
+    // Accuracy Estimates
+    // 精度估计
+    uint32_t Horizontal_Accuracy;  // Horizontal accuracy (mm)
+                                   // 水平精度 (毫米)
+    uint32_t Vertical_Accuracy;    // Vertical accuracy (mm)
+                                   // 垂直精度 (毫米)
+    uint32_t Speed_Accuracy;       // Speed accuracy (cm/s)
+                                   // 速度精度 (厘米/秒)
+
     // Status
     // 状态
     uint8_t Status;          // 1: Both RMC and GGA valid, 0: Other cases
@@ -100,8 +180,64 @@ typedef struct {
                              // GGA 的经度
 } GPS_Data_t;
 
+/* Snapshot of the latest published fix */
+/* 最新发布的定位快照 */
+typedef struct {
+    uint32_t generation;      // Increases by one for every published epoch, 0 means none yet
+                              // 每发布一个历元加一，0 表示尚未发布
+    uint8_t invalid_count;    // Consecutive invalid epochs at publish time
+                              // 发布时的连续无效次数
+    int64_t timestamp_us;     // Local time the data refers to (esp_timer, us), the prediction time after gps_predict_fix()
+                              // 数据对应的本地时间（esp_timer，微秒），gps_predict_fix() 之后为预测时间
+    int64_t first_byte_us;    // Arrival of the first byte of the epoch's output
+                              // 该历元输出的第一个字节到达时间
+    int64_t received_us;      // Output completely received
+                              // 输出接收完成时间
+    int64_t published_us;     // Parsed, filtered and published
+                              // 解析、滤波并发布的时间
+    GPS_Data_t data;          // GPS data of this epoch
+                              // 该历元的 GPS 数据
+} gps_fix_t;
+
+/* Per-stage latency of pushed fixes since the last log line, averages in us */
+/* 自上次打印以来推送定位各阶段的时延，平均值单位为微秒 */
+typedef struct {
+    uint32_t count;           // Pushed fixes
+                              // 推送的定位数
+    uint32_t rx_avg_us;       // First byte to output received
+                              // 第一个字节到接收完成
+    uint32_t parse_avg_us;    // Received to published (parsing and filter)
+                              // 接收完成到发布（解析与滤波）
+    uint32_t hold_avg_us;     // Published to push start (waiting for the push tick)
+                              // 发布到开始推送（等待推送周期）
+    uint32_t push_avg_us;     // Frame build and BLE write
+                              // 帧构建与 BLE 写入
+    uint32_t age_avg_us;      // First byte to BLE write done, what the extrapolation covers
+                              // 第一个字节到 BLE 写入完成，即外推所覆盖的时间
+    uint32_t age_max_us;
+    uint32_t age_histogram[GPS_LATENCY_BUCKETS];
+} gps_latency_stats_t;
+
 void initSendGpsDataToCameraTask(void);
 
+bool gps_get_latest_fix(gps_fix_t *out);
+
+bool gps_predict_fix(int64_t time_us, gps_fix_t *out);
+
+int64_t gps_data_to_unix_time(const GPS_Data_t *gps);
+
+int64_t gps_data_to_unix_time_us(const GPS_Data_t *gps);
+
+int gps_build_nmea_sentence(char *out, size_t out_size, const char *body);
+
+void gps_set_update_interval(uint16_t interval_ms);
+
+uint16_t gps_get_update_interval(void);
+
+void gps_set_push_interval(uint32_t interval_ms);
+
+void gps_get_latency_stats(gps_latency_stats_t *out);
+
 bool is_gps_found(void);
 
 bool is_current_gps_data_valid(void);
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+
+#include "gps_push_logic.h"
+
+#define TAG "LOGIC_GPS_PUSH"
+
+#define EARTH_RADIUS_M 6371000.0
+
+// Log the counters every this many decisions
+// 每判断该次数后打印一次计数
+#define GPS_PUSH_STATS_LOG_INTERVAL 3000
+
+/* 互斥锁，保护 s_config */
+/* Mutex to protect s_config */
+static SemaphoreHandle_t s_config_mutex = NULL;
+static gps_push_config_t s_config = {
+    .position_threshold_m = GPS_PUSH_POSITION_THRESHOLD_M,
+    .altitude_threshold_m = GPS_PUSH_ALTITUDE_THRESHOLD_M,
+    .velocity_threshold_m_s = GPS_PUSH_VELOCITY_THRESHOLD_M_S,
+    .keepalive_ms = GPS_PUSH_KEEPALIVE_MS,
+    .burst_ms = GPS_PUSH_BURST_MS,
+};
+
+// Last pushed fix, only touched by the push task
+// 上次推送的定位，仅由推送任务访问
+static bool s_has_last = false;
+static GPS_Data_t s_last;
+static int64_t s_last_push_us = 0;
+static int64_t s_burst_until_us = 0;
+
+static gps_push_stats_t s_stats = {0};
+
+/**
+ * @brief Check whether the platform is moving
+ *        检查载体是否在运动
+ */
+static bool gps_push_moving(const gps_push_config_t *config, const GPS_Data_t *gps) {
+    // 只用水平速度，NMEA 没有垂直速度，其估计值受高度噪声影响较大；爬升由高度门限判断
+    // Horizontal only, NMEA has no vertical velocity and its estimate follows altitude noise;
+    // climbing is caught by the altitude threshold
+    double speed2 = gps->Velocity_North * gps->Velocity_North + gps->Velocity_East * gps->Velocity_East;
+    return speed2 > (double)config->velocity_threshold_m_s * config->velocity_threshold_m_s;
+}
+
+/**
+ * @brief Check whether a fix differs from the last pushed one by more than the thresholds
+ *        检查定位与上次推送的定位相比是否超过门限
+ */
+static bool gps_push_changed(const gps_push_config_t *config, const GPS_Data_t *gps) {
+    // 短距离使用等距圆柱近似即可
+    // An equirectangular approximation is plenty over these distances
+    double lat_rad = gps->Latitude * M_PI / 180.0;
+    double north_m = (gps->Latitude - s_last.Latitude) * M_PI / 180.0 * EARTH_RADIUS_M;
+    double east_m = (gps->Longitude - s_last.Longitude) * M_PI / 180.0 * EARTH_RADIUS_M * cos(lat_rad);
+    if (north_m * north_m + east_m * east_m > (double)config->position_threshold_m * config->position_threshold_m) {
+        return true;
+    }
+
+    if (fabs(gps->Altitude - s_last.Altitude) > config->altitude_threshold_m) {
+        return true;
+    }
+
+    double dvn = gps->Velocity_North - s_last.Velocity_North;
+    double dve = gps->Velocity_East - s_last.Velocity_East;
+    double threshold = config->velocity_threshold_m_s;
+    return dvn * dvn + dve * dve > threshold * threshold;
+}
+
+/**
+ * @brief Decide whether a fix should be pushed to the camera
+ *        判断定位是否需要推送到相机
+ *
+ * While moving, and for burst_ms after the last moving fix, every fix is pushed. When stationary a
+ * fix is only pushed if it drifted beyond the thresholds from the last pushed one, and at least every
+ * keepalive_ms otherwise. The caller must push the fix when true is returned.
+ * 运动时以及最后一个运动定位之后的 burst_ms 内推送每个定位。静止时仅当定位相对上次推送的定位
+ * 超过门限时推送，其余情况至少每 keepalive_ms 推送一次。返回 true 时调用方必须推送该定位。
+ *
+ * @param gps Fix about to be pushed
+ *            即将推送的定位
+ * @param now_us Current time (esp_timer, us)
+ *               当前时间（esp_timer，微秒）
+ * @return bool Returns true if the fix should be pushed
+ *              需要推送时返回 true
+ */
+bool gps_push_logic_should_push(const GPS_Data_t *gps, int64_t now_us) {
+    gps_push_config_t config;
+    gps_push_logic_get_config(&config);
+
+    bool push = false;
+    s_stats.evaluated++;
+
+    if (gps_push_moving(&config, gps)) {
+        s_burst_until_us = now_us + (int64_t)config.burst_ms * 1000;
+        push = true;
+        s_stats.pushed++;
+    } else if (!s_has_last || now_us < s_burst_until_us || gps_push_changed(&config, gps)) {
+        push = true;
+        s_stats.pushed++;
+    } else if (now_us - s_last_push_us >= (int64_t)config.keepalive_ms * 1000) {
+        push = true;
+        s_stats.keepalive++;
+    } else {
+        s_stats.suppressed++;
+    }
+
+    if (push) {
+        s_last = *gps;
+        s_last_push_us = now_us;
+        s_has_last = true;
+    }
+
+    if (s_stats.evaluated % GPS_PUSH_STATS_LOG_INTERVAL == 0) {
+        ESP_LOGI(TAG, "Push policy: %lu evaluated, %lu pushed, %lu keep-alive, %lu suppressed",
+                 (unsigned long)s_stats.evaluated, (unsigned long)s_stats.pushed,
+                 (unsigned long)s_stats.keepalive, (unsigned long)s_stats.suppressed);
+    }
+    return push;
+}
+
+/**
+ * @brief Forget the last pushed fix, the next fix is pushed immediately (e.g. after reconnecting)
+ *        清除上次推送的定位，下一个定位立即推送（例如重新连接后）
+ */
+void gps_push_logic_reset(void) {
+    s_has_last = false;
+    s_burst_until_us = 0;
+}
+
+/**
+ * @brief Change the push policy thresholds
+ *        修改推送策略门限
+ *
+ * @param config New configuration
+ *               新的配置
+ */
+void gps_push_logic_set_config(const gps_push_config_t *config) {
+    if (config == NULL || s_config_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_config_mutex, portMAX_DELAY);
+    s_config = *config;
+    xSemaphoreGive(s_config_mutex);
+}
+
+/**
+ * @brief Get the push policy thresholds
+ *        获取推送策略门限
+ *
+ * @param out Output configuration
+ *            输出的配置
+ */
+void gps_push_logic_get_config(gps_push_config_t *out) {
+    if (s_config_mutex == NULL) {
+        *out = s_config;
+        return;
+    }
+    xSemaphoreTake(s_config_mutex, portMAX_DELAY);
+    *out = s_config;
+    xSemaphoreGive(s_config_mutex);
+}
+
+/**
+ * @brief Get push policy counters
+ *        获取推送策略计数
+ *
+ * @param out Output counters
+ *            输出的计数
+ */
+void gps_push_logic_get_stats(gps_push_stats_t *out) {
+    if (out != NULL) {
+        *out = s_stats;
+    }
+}
+
+/**
+ * @brief Initialize the push policy
+ *        初始化推送策略
+ *
+ * @return int Returns 0 on success, -1 on failure
+ *             返回 0 表示成功，-1 表示失败
+ */
+int gps_push_logic_init(void) {
+    s_config_mutex = xSemaphoreCreateMutex();
+    if (s_config_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create push policy mutex");
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __GPS_PUSH_LOGIC_H__
+#define __GPS_PUSH_LOGIC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "gps_logic.h"
+
+// Changes below these thresholds, compared with the last pushed fix, count as "unchanged"
+// 与上次推送的定位相比，低于以下门限的变化视为 "未变化"
+#define GPS_PUSH_POSITION_THRESHOLD_M   1.0f    // Horizontal distance (m)
+                                                // 水平距离 (米)
+#define GPS_PUSH_ALTITUDE_THRESHOLD_M   2.0f    // Altitude (m)
+                                                // 高度 (米)
+#define GPS_PUSH_VELOCITY_THRESHOLD_M_S 0.3f    // Horizontal velocity difference, also the "moving" speed (m/s)
+                                                // 水平速度差，同时也是 "运动" 判定速度 (米/秒)
+
+// Unchanged fixes are still pushed this often so the camera keeps its GPS state (ms)
+// 未变化的定位仍按该周期推送，使相机保持 GPS 状态 (毫秒)
+#define GPS_PUSH_KEEPALIVE_MS           1000
+
+// After the last moving fix every fix is still pushed for this long, covers stopping and starting (ms)
+// 最后一个运动定位之后仍在该时长内推送每个定位，覆盖停止与起步过程 (毫秒)
+#define GPS_PUSH_BURST_MS               3000
+
+/* Push policy configuration */
+/* 推送策略配置 */
+typedef struct {
+    float position_threshold_m;
+    float altitude_threshold_m;
+    float velocity_threshold_m_s;
+    uint32_t keepalive_ms;
+    uint32_t burst_ms;
+} gps_push_config_t;
+
+/* Push policy counters since boot */
+/* 启动以来的推送策略计数 */
+typedef struct {
+    uint32_t evaluated;     // Fixes offered to the policy
+                            // 交给策略判断的定位数
+    uint32_t pushed;        // Fixes pushed because of motion, a burst or a change
+                            // 因运动、突发期或变化而推送的定位数
+    uint32_t keepalive;     // Unchanged fixes pushed as keep-alive
+                            // 作为保活推送的未变化定位数
+    uint32_t suppressed;    // Fixes not pushed
+                            // 未推送的定位数
+} gps_push_stats_t;
+
+int gps_push_logic_init(void);
+
+void gps_push_logic_set_config(const gps_push_config_t *config);
+
+void gps_push_logic_get_config(gps_push_config_t *out);
+
+bool gps_push_logic_should_push(const GPS_Data_t *gps, int64_t now_us);
+
+void gps_push_logic_reset(void);
+
+void gps_push_logic_get_stats(gps_push_stats_t *out);
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+#include "esp_log.h"
+
+#include "gps_rate_logic.h"
+#include "gps_logic.h"
+#include "connect_logic.h"
+#include "status_logic.h"
+
+#define TAG "LOGIC_GPS_RATE"
+
+/* Receiver and push interval of each level */
+/* 各档位的接收机与推送间隔 */
+typedef struct {
+    const char *name;
+    uint16_t update_interval_ms;
+    uint32_t push_interval_ms;
+} gps_rate_profile_t;
+
+static const gps_rate_profile_t s_profiles[GPS_RATE_LEVEL_COUNT] = {
+    [GPS_RATE_LEVEL_LOW]    = { "LOW (1 Hz)",     1000, 1000 },
+    [GPS_RATE_LEVEL_MEDIUM] = { "MEDIUM (5 Hz)",  200,  200 },
+    [GPS_RATE_LEVEL_HIGH]   = { "HIGH (10 Hz)",   100,  100 },
+};
+
+// Level currently applied, matches the boot configuration of gps_logic
+// 当前生效的档位，与 gps_logic 启动配置一致
+static gps_rate_level_t s_current_level = GPS_RATE_LEVEL_HIGH;
+
+// How long a lower level has been wanted (ms)
+// 较低档位已持续被需要的时长 (毫秒)
+static uint32_t s_downgrade_pending_ms = 0;
+
+// Latched battery states, with hysteresis
+// 带迟滞的电量状态
+static bool s_battery_low = false;
+static bool s_battery_critical = false;
+
+static gps_rate_stats_t s_stats = {0};
+
+/**
+ * @brief Update a latched threshold flag with hysteresis
+ *        带迟滞地更新门限标志
+ *
+ * @param flag Current flag value
+ *             当前标志值
+ * @param value Measured value
+ *              测量值
+ * @param threshold Set below this value
+ *                  低于该值时置位
+ * @return bool New flag value
+ *              新的标志值
+ */
+static bool update_threshold(bool flag, uint8_t value, uint8_t threshold) {
+    if (!flag && value < threshold) {
+        return true;
+    }
+    if (flag && value >= threshold + GPS_RATE_BATTERY_HYSTERESIS) {
+        return false;
+    }
+    return flag;
+}
+
+/**
+ * @brief Work out the level the current camera state asks for
+ *        根据当前相机状态计算所需档位
+ *
+ * @return gps_rate_level_t Wanted level
+ *                          所需档位
+ */
+static gps_rate_level_t gps_rate_wanted_level(void) {
+    s_battery_low = update_threshold(s_battery_low, current_camera_bat_percentage, GPS_RATE_BATTERY_LOW);
+    s_battery_critical = update_threshold(s_battery_critical, current_camera_bat_percentage, GPS_RATE_BATTERY_CRITICAL);
+
+    // 未连接或未录制时，1 Hz 足以保持定位并驱动指示灯
+    // When not connected or not recording, 1 Hz is enough to keep the fix and drive the LED
+    if (connect_logic_get_state() != PROTOCOL_CONNECTED || !is_camera_recording()) {
+        return GPS_RATE_LEVEL_LOW;
+    }
+
+    if (s_battery_critical) {
+        return GPS_RATE_LEVEL_LOW;
+    }
+    if (s_battery_low || current_temp_over != 0) {
+        return GPS_RATE_LEVEL_MEDIUM;
+    }
+    return GPS_RATE_LEVEL_HIGH;
+}
+
+/**
+ * @brief Apply a level to the receiver and the push task
+ *        将档位应用到接收机和推送任务
+ *
+ * @param level Level to apply
+ *              要应用的档位
+ */
+static void gps_rate_apply(gps_rate_level_t level) {
+    const gps_rate_profile_t *profile = &s_profiles[level];
+
+    gps_set_update_interval(profile->update_interval_ms);
+    gps_set_push_interval(profile->push_interval_ms);
+
+    s_current_level = level;
+    s_stats.change_count++;
+    ESP_LOGI(TAG, "GPS rate -> %s, changes: %lu, time LOW/MEDIUM/HIGH: %lu/%lu/%lu s",
+             profile->name, (unsigned long)s_stats.change_count,
+             (unsigned long)s_stats.level_time_s[GPS_RATE_LEVEL_LOW],
+             (unsigned long)s_stats.level_time_s[GPS_RATE_LEVEL_MEDIUM],
+             (unsigned long)s_stats.level_time_s[GPS_RATE_LEVEL_HIGH]);
+}
+
+// 定时器回调函数，定期评估是否需要调整 GPS 频率
+// Timer callback function to periodically decide whether the GPS rate should change
+static void gps_rate_timer_callback(TimerHandle_t xTimer) {
+    static uint32_t elapsed_ms = 0;
+
+    elapsed_ms += GPS_RATE_EVAL_INTERVAL_MS;
+    if (elapsed_ms >= 1000) {
+        s_stats.level_time_s[s_current_level] += elapsed_ms / 1000;
+        elapsed_ms %= 1000;
+    }
+
+    gps_rate_level_t wanted = gps_rate_wanted_level();
+
+    if (wanted > s_current_level) {
+        // 提高频率立即生效，例如开始录制
+        // Raising the rate is immediate, e.g. recording started
+        s_downgrade_pending_ms = 0;
+        gps_rate_apply(wanted);
+    } else if (wanted < s_current_level) {
+        // 降低频率需持续一段时间，避免短暂状态变化导致反复切换
+        // Lowering the rate has to persist for a while so short blips do not cause flapping
+        s_downgrade_pending_ms += GPS_RATE_EVAL_INTERVAL_MS;
+        if (s_downgrade_pending_ms >= GPS_RATE_DOWNGRADE_DELAY_MS) {
+            s_downgrade_pending_ms = 0;
+            gps_rate_apply(wanted);
+        }
+    } else {
+        s_downgrade_pending_ms = 0;
+    }
+}
+
+/**
+ * @brief Get the level currently applied
+ *        获取当前生效的档位
+ *
+ * @return gps_rate_level_t Current level
+ *                          当前档位
+ */
+gps_rate_level_t gps_rate_logic_get_level(void) {
+    return s_current_level;
+}
+
+/**
+ * @brief Get governor statistics
+ *        获取调节器统计信息
+ *
+ * @param out Output statistics
+ *            输出的统计信息
+ */
+void gps_rate_logic_get_stats(gps_rate_stats_t *out) {
+    if (out != NULL) {
+        *out = s_stats;
+    }
+}
+
+/**
+ * @brief Start the GPS rate governor
+ *        启动 GPS 频率调节器
+ *
+ * Must be called after the GPS task has been initialized.
+ * 必须在 GPS 任务初始化之后调用。
+ *
+ * @return int Returns 0 on success, -1 on failure
+ *             返回 0 表示成功，-1 表示失败
+ */
+int gps_rate_logic_init(void) {
+    TimerHandle_t gps_rate_timer = xTimerCreate("gps_rate_timer", pdMS_TO_TICKS(GPS_RATE_EVAL_INTERVAL_MS), pdTRUE, (void *)0, gps_rate_timer_callback);
+
+    if (gps_rate_timer == NULL) {
+        ESP_LOGE(TAG, "Failed to create GPS rate timer");
+        return -1;
+    }
+
+    xTimerStart(gps_rate_timer, 0);
+    ESP_LOGI(TAG, "GPS rate governor started");
+    return 0;
+}
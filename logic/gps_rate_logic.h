@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __GPS_RATE_LOGIC_H__
+#define __GPS_RATE_LOGIC_H__
+
+#include <stdint.h>
+
+// How often the governor re-evaluates camera state (ms)
+// 调节器重新评估相机状态的周期 (毫秒)
+#define GPS_RATE_EVAL_INTERVAL_MS     1000
+
+// A lower rate must be wanted this long before it is applied (ms), raising the rate is immediate
+// 降低频率前需持续满足条件的时长 (毫秒)，提高频率立即生效
+#define GPS_RATE_DOWNGRADE_DELAY_MS   10000
+
+// Camera battery thresholds (%), cleared again once the battery is HYSTERESIS above them
+// 相机电量门限 (%)，电量回升超过门限 HYSTERESIS 后才解除
+#define GPS_RATE_BATTERY_LOW          20
+#define GPS_RATE_BATTERY_CRITICAL     10
+#define GPS_RATE_BATTERY_HYSTERESIS   5
+
+typedef enum {
+    GPS_RATE_LEVEL_LOW = 0,      // 1 Hz receiver, 1 Hz push
+                                 // 接收机 1 Hz，推送 1 Hz
+    GPS_RATE_LEVEL_MEDIUM,       // 5 Hz receiver, 5 Hz push
+                                 // 接收机 5 Hz，推送 5 Hz
+    GPS_RATE_LEVEL_HIGH,         // 10 Hz receiver, 10 Hz push
+                                 // 接收机 10 Hz，推送 10 Hz
+    GPS_RATE_LEVEL_COUNT,
+} gps_rate_level_t;
+
+/* Time spent per level and number of changes since boot */
+/* 启动以来各档位持续时间与切换次数 */
+typedef struct {
+    uint32_t level_time_s[GPS_RATE_LEVEL_COUNT];
+    uint32_t change_count;
+} gps_rate_stats_t;
+
+int gps_rate_logic_init(void);
+
+gps_rate_level_t gps_rate_logic_get_level(void);
+
+void gps_rate_logic_get_stats(gps_rate_stats_t *out);
+
+#endif
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+
+#include "gps_receiver_logic.h"
+#include "gps_logic.h"
+
+#define TAG "LOGIC_GPS_RECEIVER"
+
+/* 命令族，决定 ACK 的格式 */
+/* Command family, decides the ACK format */
+typedef enum {
+    GPS_COMMAND_FAMILY_PAIR = 0,    // ACK: $PAIR001,<id>,<result>  result 0 = OK, 1 = processing
+    GPS_COMMAND_FAMILY_PMTK,        // ACK: $PMTK001,<id>,<flag>    flag 3 = OK
+} gps_command_family_t;
+
+/* 队列中的一条命令 */
+/* One queued command */
+typedef struct {
+    char body[GPS_RECEIVER_SENTENCE_MAX];
+    char sentence[GPS_RECEIVER_SENTENCE_MAX];
+    size_t length;
+    gps_command_family_t family;
+    uint16_t id;
+    uint8_t retries_left;
+    bool sent;
+    uint32_t deadline_ms;
+    gps_receiver_done_cb_t cb;
+    void *ctx;
+} gps_receiver_command_t;
+
+/* 命令环形队列，仅队首命令在等待 ACK */
+/* Ring buffer of commands, only the head is waiting for its ACK */
+static gps_receiver_command_t s_queue[GPS_RECEIVER_QUEUE_SIZE];
+static uint8_t s_queue_head = 0;
+static uint8_t s_queue_count = 0;
+
+/* 互斥锁，保护 s_queue */
+/* Mutex to protect s_queue */
+static SemaphoreHandle_t s_queue_mutex = NULL;
+
+static gps_receiver_write_fn_t s_write_fn = NULL;
+
+// Last time seen by gps_receiver_poll, used for ACK deadlines extended outside of it
+// gps_receiver_poll 最近一次看到的时间，用于在其外部延长 ACK 截止时间
+static uint32_t s_now_ms = 0;
+
+/**
+ * @brief Verify the checksum of a received NMEA line
+ *        校验接收到的 NMEA 语句的校验和
+ *
+ * @param line Line starting with '$'
+ *             以 '$' 开头的语句
+ * @return bool Returns true if the checksum is present and correct
+ *              校验和存在且正确时返回 true
+ */
+static bool nmea_checksum_ok(const char *line) {
+    uint8_t checksum = 0;
+    const char *p = line + 1;
+
+    while (*p != '\0' && *p != '*') {
+        checksum ^= (uint8_t)*p++;
+    }
+    if (*p != '*') {
+        return false;
+    }
+    return (uint8_t)strtoul(p + 1, NULL, 16) == checksum;
+}
+
+/**
+ * @brief Remove the head command, must be called with the mutex held
+ *        移除队首命令，调用时必须持有互斥锁
+ *
+ * @param out Copy of the removed command
+ *            被移除命令的副本
+ */
+static void queue_pop_locked(gps_receiver_command_t *out) {
+    *out = s_queue[s_queue_head];
+    s_queue_head = (s_queue_head + 1) % GPS_RECEIVER_QUEUE_SIZE;
+    s_queue_count--;
+}
+
+/**
+ * @brief Initialize the receiver command engine
+ *        初始化接收机命令引擎
+ *
+ * @param write_fn Function used to write sentences to the receiver
+ *                 用于向接收机写入语句的函数
+ * @return int Returns 0 on success, -1 on failure
+ *             返回 0 表示成功，-1 表示失败
+ */
+int gps_receiver_init(gps_receiver_write_fn_t write_fn) {
+    if (write_fn == NULL) {
+        return -1;
+    }
+
+    if (s_queue_mutex == NULL) {
+        s_queue_mutex = xSemaphoreCreateMutex();
+        if (s_queue_mutex == NULL) {
+            ESP_LOGE(TAG, "Failed to create receiver queue mutex");
+            return -1;
+        }
+    }
+
+    s_write_fn = write_fn;
+    s_queue_head = 0;
+    s_queue_count = 0;
+    return 0;
+}
+
+/**
+ * @brief Queue a PAIR/PMTK command, the checksum is added here
+ *        将 PAIR/PMTK 命令加入队列，校验和在此计算
+ *
+ * Commands are sent one at a time in order; the next one goes out once the previous one has
+ * been acknowledged, failed or timed out.
+ * 命令按顺序逐条发送；前一条被确认、失败或超时后再发送下一条。
+ *
+ * @param body Sentence body without '$' and checksum, e.g. "PAIR062,3,0"
+ *             不含 '$' 和校验和的语句主体，例如 "PAIR062,3,0"
+ * @param cb Completion callback, may be NULL
+ *           完成回调，可为 NULL
+ * @param ctx User context passed to the callback
+ *            传递给回调的用户上下文
+ * @return int Returns 0 on success, -1 if the command is invalid or the queue is full
+ *             返回 0 表示成功，命令无效或队列已满返回 -1
+ */
+int gps_receiver_send_command(const char *body, gps_receiver_done_cb_t cb, void *ctx) {
+    gps_receiver_command_t command = {0};
+
+    if (s_queue_mutex == NULL || body == NULL) {
+        ESP_LOGE(TAG, "Receiver command engine not initialized");
+        return -1;
+    }
+
+    if (strncmp(body, "PAIR", 4) == 0) {
+        command.family = GPS_COMMAND_FAMILY_PAIR;
+    } else if (strncmp(body, "PMTK", 4) == 0) {
+        command.family = GPS_COMMAND_FAMILY_PMTK;
+    } else {
+        ESP_LOGE(TAG, "Unsupported receiver command: %s", body);
+        return -1;
+    }
+    command.id = (uint16_t)strtoul(body + 4, NULL, 10);
+
+    if (strlen(body) >= sizeof(command.body)) {
+        ESP_LOGE(TAG, "Receiver command too long: %s", body);
+        return -1;
+    }
+    strcpy(command.body, body);
+
+    int length = gps_build_nmea_sentence(command.sentence, sizeof(command.sentence), body);
+    if (length < 0) {
+        ESP_LOGE(TAG, "Receiver command too long: %s", body);
+        return -1;
+    }
+    command.length = (size_t)length;
+    command.retries_left = GPS_RECEIVER_MAX_RETRIES;
+    command.cb = cb;
+    command.ctx = ctx;
+
+    xSemaphoreTake(s_queue_mutex, portMAX_DELAY);
+    if (s_queue_count >= GPS_RECEIVER_QUEUE_SIZE) {
+        xSemaphoreGive(s_queue_mutex);
+        ESP_LOGE(TAG, "Receiver command queue full, dropping %s", body);
+        return -1;
+    }
+    s_queue[(s_queue_head + s_queue_count) % GPS_RECEIVER_QUEUE_SIZE] = command;
+    s_queue_count++;
+    xSemaphoreGive(s_queue_mutex);
+
+    return 0;
+}
+
+/**
+ * @brief Offer one received line to the engine
+ *        将接收到的一行交给命令引擎
+ *
+ * Only $PAIR001 and $PMTK001 lines are consumed, everything else is left to the fix parser.
+ * 只处理 $PAIR001 和 $PMTK001 语句，其余语句留给定位解析。
+ *
+ * @param line Received line starting with '$', CR/LF may be present
+ *             以 '$' 开头的接收语句，可包含 CR/LF
+ * @return bool Returns true if the line was an ACK and has been consumed
+ *              如果该行为 ACK 并已被处理，返回 true
+ */
+bool gps_receiver_handle_line(const char *line) {
+    gps_command_family_t family;
+
+    if (strncmp(line, "$PAIR001,", 9) == 0) {
+        family = GPS_COMMAND_FAMILY_PAIR;
+    } else if (strncmp(line, "$PMTK001,", 9) == 0) {
+        family = GPS_COMMAND_FAMILY_PMTK;
+    } else {
+        return false;
+    }
+
+    if (s_queue_mutex == NULL || !nmea_checksum_ok(line)) {
+        return true;
+    }
+
+    char *next = NULL;
+    uint16_t id = (uint16_t)strtoul(line + 9, &next, 10);
+    if (next == NULL || *next != ',') {
+        return true;
+    }
+    long code = strtol(next + 1, NULL, 10);
+
+    xSemaphoreTake(s_queue_mutex, portMAX_DELAY);
+    gps_receiver_command_t *head = &s_queue[s_queue_head];
+    if (s_queue_count == 0 || !head->sent || head->family != family || head->id != id) {
+        // 迟到的重复 ACK 或非本引擎发出的命令
+        // Late duplicate ACK or a command not sent by this engine
+        xSemaphoreGive(s_queue_mutex);
+        return true;
+    }
+
+    if (family == GPS_COMMAND_FAMILY_PAIR && code == 1) {
+        // 接收机仍在处理，延长等待时间
+        // Receiver is still processing, wait longer
+        head->deadline_ms = s_now_ms + GPS_RECEIVER_ACK_TIMEOUT_MS;
+        xSemaphoreGive(s_queue_mutex);
+        return true;
+    }
+
+    bool ok = (family == GPS_COMMAND_FAMILY_PAIR) ? (code == 0) : (code == 3);
+    gps_receiver_command_t done;
+    queue_pop_locked(&done);
+    xSemaphoreGive(s_queue_mutex);
+
+    if (!ok) {
+        ESP_LOGW(TAG, "Receiver rejected %s (code %ld)", done.body, code);
+    }
+    if (done.cb) {
+        done.cb(done.body, ok ? GPS_RECEIVER_RESULT_OK : GPS_RECEIVER_RESULT_FAILED, done.ctx);
+    }
+    return true;
+}
+
+/**
+ * @brief Send the next command and handle ACK timeouts
+ *        发送下一条命令并处理 ACK 超时
+ *
+ * Called periodically from the GPS receiving task.
+ * 由 GPS 接收任务周期性调用。
+ *
+ * @param now_ms Current time (ms)
+ *               当前时间 (毫秒)
+ */
+void gps_receiver_poll(uint32_t now_ms) {
+    if (s_queue_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_queue_mutex, portMAX_DELAY);
+    s_now_ms = now_ms;
+
+    if (s_queue_count == 0) {
+        xSemaphoreGive(s_queue_mutex);
+        return;
+    }
+
+    gps_receiver_command_t *head = &s_queue[s_queue_head];
+    if (!head->sent) {
+        s_write_fn(head->sentence, head->length);
+        head->sent = true;
+        head->deadline_ms = now_ms + GPS_RECEIVER_ACK_TIMEOUT_MS;
+        xSemaphoreGive(s_queue_mutex);
+        return;
+    }
+
+    if ((int32_t)(now_ms - head->deadline_ms) < 0) {
+        xSemaphoreGive(s_queue_mutex);
+        return;
+    }
+
+    if (head->retries_left > 0) {
+        head->retries_left--;
+        ESP_LOGW(TAG, "No ACK for %s, retrying", head->body);
+        s_write_fn(head->sentence, head->length);
+        head->deadline_ms = now_ms + GPS_RECEIVER_ACK_TIMEOUT_MS;
+        xSemaphoreGive(s_queue_mutex);
+        return;
+    }
+
+    gps_receiver_command_t done;
+    queue_pop_locked(&done);
+    xSemaphoreGive(s_queue_mutex);
+
+    ESP_LOGE(TAG, "No ACK for %s after %d retries", done.body, GPS_RECEIVER_MAX_RETRIES);
+    if (done.cb) {
+        done.cb(done.body, GPS_RECEIVER_RESULT_TIMEOUT, done.ctx);
+    }
+}
+
+/**
+ * @brief Check whether all queued commands have completed
+ *        检查所有排队命令是否已完成
+ *
+ * @return bool Returns true if the queue is empty
+ *              队列为空时返回 true
+ */
+bool gps_receiver_is_idle(void) {
+    return __atomic_load_n(&s_queue_count, __ATOMIC_RELAXED) == 0;
+}
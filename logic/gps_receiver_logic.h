@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __GPS_RECEIVER_LOGIC_H__
+#define __GPS_RECEIVER_LOGIC_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* 等待中的接收机命令最大数量 */
+/* Maximum number of queued receiver commands */
+#define GPS_RECEIVER_QUEUE_SIZE         12
+
+/* 单条语句最大长度（含 $、校验和与 CRLF） */
+/* Maximum sentence length including '$', checksum and CRLF */
+#define GPS_RECEIVER_SENTENCE_MAX       64
+
+/* 等待 ACK 的超时时间（毫秒）与重试次数 */
+/* ACK timeout (ms) and number of retries */
+#define GPS_RECEIVER_ACK_TIMEOUT_MS     1000
+#define GPS_RECEIVER_MAX_RETRIES        3
+
+/* Outcome of a queued command */
+/* 排队命令的执行结果 */
+typedef enum {
+    GPS_RECEIVER_RESULT_OK = 0,           // Receiver acknowledged success
+                                          // 接收机确认成功
+    GPS_RECEIVER_RESULT_FAILED,           // Receiver replied failed/unsupported/parameter error
+                                          // 接收机回复失败、不支持或参数错误
+    GPS_RECEIVER_RESULT_TIMEOUT,          // No ACK after all retries
+                                          // 重试后仍未收到 ACK
+} gps_receiver_result_t;
+
+/**
+ * @brief Completion callback, called from the GPS receiving task
+ *        完成回调，在 GPS 接收任务中调用
+ *
+ * @param body   Sentence body that was sent, e.g. "PAIR864,0,0,460800"
+ *               已发送的语句主体，例如 "PAIR864,0,0,460800"
+ * @param result Command result
+ *               命令执行结果
+ * @param ctx    User context given at enqueue time
+ *               入队时传入的用户上下文
+ */
+typedef void (*gps_receiver_done_cb_t)(const char *body, gps_receiver_result_t result, void *ctx);
+
+/**
+ * @brief Raw write function towards the receiver
+ *        向接收机写入原始数据的函数
+ */
+typedef void (*gps_receiver_write_fn_t)(const char *data, size_t length);
+
+int gps_receiver_init(gps_receiver_write_fn_t write_fn);
+
+int gps_receiver_send_command(const char *body, gps_receiver_done_cb_t cb, void *ctx);
+
+bool gps_receiver_handle_line(const char *line);
+
+void gps_receiver_poll(uint32_t now_ms);
+
+bool gps_receiver_is_idle(void);
+
+#endif
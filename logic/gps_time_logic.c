@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "gps_time_logic.h"
+#include "clock_discipline.h"
+
+#define TAG "LOGIC_GPS_TIME"
+
+/* 互斥锁，保护时间映射 */
+/* Mutex to protect the time mappings */
+static SemaphoreHandle_t s_time_mutex = NULL;
+
+// PPS mapping, fitted over labelled edges
+// PPS 映射，由已标记秒的边沿拟合
+static clock_discipline_t s_discipline;
+
+// NMEA fallback mapping, the last valid epoch
+// NMEA 备用映射，即最近一个有效历元
+static bool s_nmea_valid = false;
+static int64_t s_nmea_local_us = 0;
+static int64_t s_nmea_utc_us = 0;
+
+// Latest PPS edge, written from the ISR (queue of length one, overwritten)
+// 最新的 PPS 边沿，由中断写入（长度为一的队列，覆盖写入）
+static QueueHandle_t s_pps_queue = NULL;
+static volatile uint32_t s_pps_edge_count = 0;
+
+#if GPS_PPS_GPIO >= 0
+/**
+ * @brief PPS edge interrupt, captures the local time of the rising edge
+ *        PPS 边沿中断，捕获上升沿的本地时间
+ */
+static void IRAM_ATTR gps_pps_isr(void *arg) {
+    int64_t now_us = esp_timer_get_time();
+    BaseType_t woken = pdFALSE;
+
+    xQueueOverwriteFromISR(s_pps_queue, &now_us, &woken);
+    s_pps_edge_count++;
+    portYIELD_FROM_ISR(woken);
+}
+#endif
+
+/**
+ * @brief Feed a valid epoch: labels pending PPS edges and updates the NMEA fallback
+ *        输入一个有效历元：为待处理的 PPS 边沿标记秒，并更新 NMEA 备用映射
+ *
+ * Before lock an edge is labelled with the whole-second epoch whose output follows it; once locked
+ * edges are labelled by rounding the predicted UTC, and the NMEA time only serves as a sanity check.
+ * Called from the GPS receiving task.
+ * 锁定前，边沿以其后输出的整秒历元标记；锁定后，边沿按预测的 UTC 取整标记，NMEA 时间仅用于校验。
+ * 由 GPS 接收任务调用。
+ *
+ * @param utc_us UTC of the epoch (us since 1970)
+ *               历元的 UTC (自 1970 年起的微秒数)
+ * @param first_byte_us Arrival of the first byte of the epoch's output
+ *                      该历元输出第一个字节的到达时间
+ * @param epoch_local_us Local time estimated for the epoch from the UART timing
+ *                       根据串口时序估计的历元本地时间
+ */
+void gps_time_logic_on_epoch(int64_t utc_us, int64_t first_byte_us, int64_t epoch_local_us) {
+    if (s_time_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_time_mutex, portMAX_DELAY);
+    s_nmea_valid = true;
+    s_nmea_local_us = epoch_local_us;
+    s_nmea_utc_us = utc_us;
+
+    int64_t edge_us;
+    if (s_pps_queue != NULL && xQueuePeek(s_pps_queue, &edge_us, 0) == pdTRUE) {
+        int64_t predicted_us;
+        if (clock_discipline_to_utc(&s_discipline, edge_us, &predicted_us)) {
+            int64_t label_us = (predicted_us + 500000) / 1000000 * 1000000;
+            clock_discipline_add(&s_discipline, edge_us, label_us);
+            xQueueReset(s_pps_queue);
+        } else if (utc_us % 1000000 == 0 && first_byte_us >= edge_us &&
+                   first_byte_us - edge_us <= GPS_PPS_MAX_NMEA_DELAY_US) {
+            clock_discipline_add(&s_discipline, edge_us, utc_us);
+            xQueueReset(s_pps_queue);
+        } else if (first_byte_us - edge_us > GPS_PPS_MAX_NMEA_DELAY_US) {
+            // 找不到对应的整秒历元，丢弃
+            // No matching whole-second epoch, drop it
+            xQueueReset(s_pps_queue);
+        }
+    }
+
+    // PPS 时间与 NMEA 时间差得太多，说明秒标记错误
+    // PPS and NMEA time disagree by too much, a second was mislabelled
+    int64_t pps_utc_us;
+    if (clock_discipline_to_utc(&s_discipline, epoch_local_us, &pps_utc_us) &&
+        llabs(pps_utc_us - utc_us) > GPS_PPS_NMEA_TOLERANCE_US) {
+        ESP_LOGW(TAG, "PPS time off NMEA time by %lld ms, restarting discipline", (long long)((pps_utc_us - utc_us) / 1000));
+        clock_discipline_init(&s_discipline);
+        s_discipline.reset_count++;
+    }
+    xSemaphoreGive(s_time_mutex);
+}
+
+/**
+ * @brief Convert local time (esp_timer) to UTC
+ *        将本地时间（esp_timer）转换为 UTC
+ *
+ * @param local_us Local time (us)
+ *                 本地时间 (微秒)
+ * @param utc_us Output UTC (us since 1970)
+ *               输出的 UTC (自 1970 年起的微秒数)
+ * @return gps_time_source_t Source of the result, GPS_TIME_SOURCE_NONE if no time is known
+ *                           结果的来源，尚无时间时为 GPS_TIME_SOURCE_NONE
+ */
+gps_time_source_t gps_time_local_to_utc(int64_t local_us, int64_t *utc_us) {
+    gps_time_source_t source = GPS_TIME_SOURCE_NONE;
+
+    if (s_time_mutex == NULL) {
+        return source;
+    }
+
+    xSemaphoreTake(s_time_mutex, portMAX_DELAY);
+    if (clock_discipline_to_utc(&s_discipline, local_us, utc_us)) {
+        source = GPS_TIME_SOURCE_PPS;
+    } else if (s_nmea_valid && local_us - s_nmea_local_us <= CLOCK_DISCIPLINE_HOLDOVER_US) {
+        *utc_us = s_nmea_utc_us + (local_us - s_nmea_local_us);
+        source = GPS_TIME_SOURCE_NMEA;
+    }
+    xSemaphoreGive(s_time_mutex);
+    return source;
+}
+
+/**
+ * @brief Convert UTC to local time (esp_timer), only while PPS disciplined
+ *        将 UTC 转换为本地时间（esp_timer），仅在 PPS 校准时可用
+ *
+ * @param utc_us UTC (us since 1970)
+ *               UTC (自 1970 年起的微秒数)
+ * @param local_us Output local time (us), left untouched on failure
+ *                 输出的本地时间 (微秒)，失败时不修改
+ * @return bool Returns true if PPS disciplined
+ *              处于 PPS 校准时返回 true
+ */
+bool gps_time_utc_to_local(int64_t utc_us, int64_t *local_us) {
+    bool ok = false;
+    int64_t result;
+
+    if (s_time_mutex == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(s_time_mutex, portMAX_DELAY);
+    ok = clock_discipline_to_local(&s_discipline, utc_us, &result);
+    xSemaphoreGive(s_time_mutex);
+    if (ok) {
+        *local_us = result;
+    }
+    return ok;
+}
+
+/**
+ * @brief Get the current UTC time
+ *        获取当前 UTC 时间
+ *
+ * @param utc_us Output UTC (us since 1970)
+ *               输出的 UTC (自 1970 年起的微秒数)
+ * @return gps_time_source_t Source of the result, sub-ms only for GPS_TIME_SOURCE_PPS
+ *                           结果的来源，仅 GPS_TIME_SOURCE_PPS 达到亚毫秒精度
+ */
+gps_time_source_t gps_time_now(int64_t *utc_us) {
+    return gps_time_local_to_utc(esp_timer_get_time(), utc_us);
+}
+
+/**
+ * @brief Get PPS discipline state
+ *        获取 PPS 校准状态
+ *
+ * @param out Output state
+ *            输出的状态
+ */
+void gps_time_logic_get_stats(gps_time_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->pps_enabled = (s_pps_queue != NULL);
+    out->edge_count = s_pps_edge_count;
+    if (s_time_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_time_mutex, portMAX_DELAY);
+    out->pps_locked = s_discipline.locked;
+    out->accepted_count = s_discipline.accepted_count;
+    out->reject_count = s_discipline.reject_count;
+    out->reset_count = s_discipline.reset_count;
+    out->drift_ppm = (float)(-s_discipline.drift * 1e6);
+    out->jitter_us = s_discipline.residual_rms_us;
+    xSemaphoreGive(s_time_mutex);
+}
+
+/**
+ * @brief Initialize GPS time, with PPS capture if GPS_PPS_GPIO is set
+ *        初始化 GPS 时间，设置了 GPS_PPS_GPIO 时启用 PPS 捕获
+ *
+ * @return int Returns 0 on success, -1 on failure
+ *             返回 0 表示成功，-1 表示失败
+ */
+int gps_time_logic_init(void) {
+    s_time_mutex = xSemaphoreCreateMutex();
+    if (s_time_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create time mutex");
+        return -1;
+    }
+    memset(&s_discipline, 0, sizeof(s_discipline));
+    clock_discipline_init(&s_discipline);
+
+#if GPS_PPS_GPIO < 0
+    ESP_LOGI(TAG, "PPS not configured, using NMEA time");
+    return 0;
+#else
+    s_pps_queue = xQueueCreate(1, sizeof(int64_t));
+    if (s_pps_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create PPS queue");
+        return -1;
+    }
+
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << GPS_PPS_GPIO),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_ENABLE,
+        .intr_type = GPIO_INTR_POSEDGE,
+    };
+    gpio_config(&io_conf);
+
+    // 中断服务可能已由其他模块安装
+    // The ISR service may already have been installed by another module
+    esp_err_t ret = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "Failed to install GPIO ISR service: %s", esp_err_to_name(ret));
+        return -1;
+    }
+    ret = gpio_isr_handler_add(GPS_PPS_GPIO, gps_pps_isr, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add PPS handler: %s", esp_err_to_name(ret));
+        return -1;
+    }
+
+    ESP_LOGI(TAG, "PPS capture on GPIO %d", GPS_PPS_GPIO);
+    return 0;
+#endif
+}
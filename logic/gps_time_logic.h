@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __GPS_TIME_LOGIC_H__
+#define __GPS_TIME_LOGIC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/gpio.h"
+
+// Receiver PPS output GPIO number, -1 when not wired; time then comes from NMEA only
+// 接收机 PPS 输出的 GPIO 编号，未连接时为 -1，此时仅使用 NMEA 时间
+#ifndef GPS_PPS_GPIO
+#define GPS_PPS_GPIO -1
+#endif
+
+// Longest delay from a PPS edge to the first byte of the NMEA output for that second (us)
+// PPS 边沿到该秒 NMEA 输出第一个字节的最长延迟 (微秒)
+#define GPS_PPS_MAX_NMEA_DELAY_US 900000
+
+// PPS time further than this from the NMEA time restarts the discipline, e.g. a mislabelled second (us)
+// PPS 时间与 NMEA 时间相差超过该值时重新校准，例如秒标记错误 (微秒)
+#define GPS_PPS_NMEA_TOLERANCE_US 500000
+
+/* Where a UTC time came from */
+/* UTC 时间的来源 */
+typedef enum {
+    GPS_TIME_SOURCE_NONE = 0,     // No time yet
+                                  // 尚无时间
+    GPS_TIME_SOURCE_NMEA,         // Last NMEA epoch plus local time, tens of ms
+                                  // 最近 NMEA 历元加本地时间，精度为数十毫秒
+    GPS_TIME_SOURCE_PPS,          // PPS disciplined, a few us
+                                  // PPS 校准，精度为数微秒
+} gps_time_source_t;
+
+/* PPS discipline state */
+/* PPS 校准状态 */
+typedef struct {
+    bool pps_enabled;
+    bool pps_locked;
+    uint32_t edge_count;          // Edges captured
+                                  // 捕获的边沿数
+    uint32_t accepted_count;      // Edges used for the fit
+                                  // 用于拟合的边沿数
+    uint32_t reject_count;
+    uint32_t reset_count;
+    float drift_ppm;              // Local clock rate error, positive when fast
+                                  // 本地时钟频率误差，偏快为正
+    float jitter_us;              // RMS residual of the fit
+                                  // 拟合残差均方根
+} gps_time_stats_t;
+
+int gps_time_logic_init(void);
+
+void gps_time_logic_on_epoch(int64_t utc_us, int64_t first_byte_us, int64_t epoch_local_us);
+
+gps_time_source_t gps_time_local_to_utc(int64_t local_us, int64_t *utc_us);
+
+bool gps_time_utc_to_local(int64_t utc_us, int64_t *local_us);
+
+gps_time_source_t gps_time_now(int64_t *utc_us);
+
+void gps_time_logic_get_stats(gps_time_stats_t *out);
+
+#endif
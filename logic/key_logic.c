@@ -20,13 +20,16 @@
  */
 
 #include <time.h>
+#include <string.h>
 #include "key_logic.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
 
+#include "ble_transport.h"
 #include "data.h"
 #include "enums_logic.h"
 #include "connect_logic.h"
+#include "pairing_logic.h"
 #include "command_logic.h"
 #include "status_logic.h"
 #include "dji_protocol_data_structures.h"
@@ -54,51 +57,20 @@ static TickType_t key_press_start_time = 0;
 #define KEY_SCAN_INTERVAL pdMS_TO_TICKS(50)
 
 /**
- * @brief 处理长按事件
- *        Handle long press event
- * 
- * 当按键被长时间按下时（超过长按阈值），执行相关的逻辑操作：
- * When the key is pressed for a long time (exceeding the threshold), execute the following operations:
- * 1. 初始化数据层。
- * Initialize data layer.
- * 2. 重新连接 BLE。
- * Reconnect BLE.
- * 3. 建立与相机的协议连接。
- * Establish protocol connection with camera.
- * 4. 获取设备版本信息并订阅相机状态。
- * Get device version info and subscribe to camera status.
+ * @brief 连接一台相机：BLE 连接、协议连接、版本查询与状态订阅
+ *        Connect one camera: BLE connect, protocol connect, version query and status subscription
+ *
+ * @param link 使用的链路
+ *             Link to use
+ * @return int BLE 连接失败（未找到新相机）返回 -1，否则返回 0
+ *             Returns -1 when the BLE connect fails (no new camera found), 0 otherwise
  */
-static void handle_boot_long_press() {
-    /* 初始化数据层 */
-    /* Initialize data layer */
-    if (!is_data_layer_initialized()) {
-        ESP_LOGI(TAG, "Data layer not initialized, initializing now...");
-        data_init(); 
-        data_register_status_update_callback(update_camera_state_handler);
-        if (!is_data_layer_initialized()) {
-            ESP_LOGE(TAG, "Failed to initialize data layer");
-            return;
-        }
-    }
-
-    /* 重新连接 BLE */
-    /* Reconnect BLE */
-    connect_state_t current_state = connect_logic_get_state();
-
-    if (current_state >= BLE_INIT_COMPLETE) {
-        ESP_LOGI(TAG, "Current state is %d, disconnecting Bluetooth...", current_state);
-        int res = connect_logic_ble_disconnect();
-        if (res == -1) {
-            ESP_LOGE(TAG, "Failed to disconnect Bluetooth.");
-            return;
-        }
-    }
-
-    ESP_LOGI(TAG, "Attempting to connect Bluetooth...");
-    int res = connect_logic_ble_connect();
+static int connect_camera(int link) {
+    ESP_LOGI(TAG, "Attempting to connect Bluetooth on link %d...", link);
+    int res = connect_logic_ble_connect(link);
     if (res == -1) {
         ESP_LOGE(TAG, "Failed to connect Bluetooth.");
-        return;
+        return -1;
     } else {
         ESP_LOGI(TAG, "Successfully connected Bluetooth.");
     }
@@ -107,15 +79,31 @@ static void handle_boot_long_press() {
     /* Camera protocol connection */
     uint32_t g_device_id = 0x12345703;                           // 示例设备ID / Example device ID
     uint8_t g_mac_addr_len = 6;                                  // MAC地址长度 / MAC address length
-    int8_t g_mac_addr[6] = {0x38, 0x34, 0x56, 0x78, 0x9A, 0xBC}; // 示例MAC地址 / Example MAC address
+    int8_t g_mac_addr[16] = {0x38, 0x34, 0x56, 0x78, 0x9A, 0xBC}; // 示例MAC地址 / Example MAC address
     uint32_t g_fw_version = 0x00;                                // 示例固件版本 / Example firmware version
-    uint8_t g_verify_mode = 0;                                   // 首次配对 / First pairing
+    uint8_t g_verify_mode = VERIFY_MODE_FIRST_PAIRING;           // 首次配对 / First pairing
     uint16_t g_verify_data = 0;                                  // 随机校验码 / Random verification code
     uint8_t g_camera_reserved = 0;                               // 相机编号 / Camera number
 
-    srand((unsigned int)time(NULL));
     g_verify_data = (uint16_t)(rand() % 10000);
+
+    /* 已配对的相机使用配对时的参数与重连模式，无需用户再次确认 */
+    /* A paired camera gets the parameters of the pairing and the reconnection mode, no confirmation again */
+    uint8_t camera_addr[6];
+    pairing_record_t record;
+    if (ble_transport_get_peer_addr(link, camera_addr) == ESP_OK &&
+        pairing_logic_load(camera_addr, &record) == ESP_OK) {
+        g_device_id = record.device_id;
+        g_mac_addr_len = record.mac_addr_len;
+        memcpy(g_mac_addr, record.mac_addr, record.mac_addr_len);
+        g_fw_version = record.fw_version;
+        g_verify_mode = VERIFY_MODE_RECONNECT;
+        g_verify_data = record.verify_data;
+        g_camera_reserved = record.camera_reserved;
+    }
+
     res = connect_logic_protocol_connect(
+        link,
         g_device_id,
         g_mac_addr_len,
         g_mac_addr,
@@ -125,28 +113,89 @@ static void handle_boot_long_press() {
         g_camera_reserved
     );
     if (res == -1) {
+        // 重连被拒绝或超时时配对结果已被删除，下次按键重新首次配对
+        // A reconnection that was rejected or timed out has already dropped the pairing, the next press pairs from scratch
         ESP_LOGE(TAG, "Failed to connect to camera.");
-        return;
+        return 0;
     } else {
         ESP_LOGI(TAG, "Successfully connected to camera.");
     }
 
     /* 获取设备版本信息并打印 */
     /* Get and print device version information */
-    version_query_response_frame_t *version_response = command_logic_get_version();
+    version_query_response_frame_t *version_response = command_logic_get_version(link);
     if (version_response != NULL) {
         free(version_response);
     }
 
     /* 订阅相机状态 */
     /* Subscribe to camera status */
-    res = subscript_camera_status(PUSH_MODE_PERIODIC_WITH_STATE_CHANGE, PUSH_FREQ_10HZ);
+    res = subscript_camera_status(link, PUSH_MODE_PERIODIC_WITH_STATE_CHANGE, PUSH_FREQ_10HZ);
     if (res == -1) {
         ESP_LOGE(TAG, "Failed to subscribe to camera status.");
-        return;
     } else {
         ESP_LOGI(TAG, "Successfully subscribed to camera status.");
     }
+    return 0;
+}
+
+/**
+ * @brief 处理长按事件
+ *        Handle long press event
+ * 
+ * 当按键被长时间按下时（超过长按阈值），执行相关的逻辑操作：
+ * When the key is pressed for a long time (exceeding the threshold), execute the following operations:
+ * 1. 初始化数据层。
+ * Initialize data layer.
+ * 2. 断开所有相机，然后逐条链路连接，直到扫描不到新的相机。
+ * Disconnect all cameras, then connect link by link until the scan finds no new camera.
+ * 3. 对每台相机建立协议连接、获取设备版本信息并订阅相机状态。
+ * For each camera establish the protocol connection, get device version info and subscribe to camera status.
+ */
+static void handle_boot_long_press() {
+    /* 初始化数据层 */
+    /* Initialize data layer */
+    if (!is_data_layer_initialized()) {
+        ESP_LOGI(TAG, "Data layer not initialized, initializing now...");
+        data_init(); 
+        data_register_status_update_callback(update_camera_state_handler);
+        if (!is_data_layer_initialized()) {
+            ESP_LOGE(TAG, "Failed to initialize data layer");
+            return;
+        }
+    }
+
+    /* 断开所有相机 */
+    /* Disconnect all cameras */
+    connect_state_t current_state = connect_logic_get_state();
+
+    if (current_state >= BLE_INIT_COMPLETE) {
+        ESP_LOGI(TAG, "Current state is %d, disconnecting Bluetooth...", current_state);
+        for (int link = 0; link < BLE_MAX_LINKS; link++) {
+            if (connect_logic_ble_disconnect(link) == -1) {
+                ESP_LOGE(TAG, "Failed to disconnect Bluetooth on link %d.", link);
+                return;
+            }
+        }
+
+        // 等待断开事件，最多 3 秒
+        // Wait for the disconnect events, at most 3 seconds
+        for (int i = 0; i < 60 && connect_logic_get_state() != BLE_INIT_COMPLETE; i++) {
+            vTaskDelay(pdMS_TO_TICKS(50));
+        }
+    }
+
+    /* 逐条链路连接相机 */
+    /* Connect cameras link by link */
+    srand((unsigned int)time(NULL));
+    int connected = 0;
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        if (connect_camera(link) == -1) {
+            break;
+        }
+        connected++;
+    }
+    ESP_LOGI(TAG, "%d camera(s) connected.", connected);
 }
 /**
  * @brief 处理单击事件
@@ -154,12 +203,12 @@ static void handle_boot_long_press() {
  * 
  * 当按键被单击时，执行以下操作：
  * When the key is single pressed, perform the following operations:
- * 1. 获取当前相机模式。
- * Get current camera mode.
- * 2. 如果相机正在直播，则启动录制。
- * If camera is live streaming, start recording.
- * 3. 如果相机正在录制，则停止录制。
- * If camera is recording, stop recording.
+ * 1. 获取当前相机（主相机）模式。
+ * Get current (primary) camera mode.
+ * 2. 如果相机正在直播，则在所有相机上启动录制。
+ * If camera is live streaming, start recording on all cameras.
+ * 3. 如果相机正在录制，则在所有相机上停止录制。
+ * If camera is recording, stop recording on all cameras.
  */
 static void handle_boot_single_press() {
     // 获取当前相机模式
@@ -173,23 +222,33 @@ static void handle_boot_single_press() {
         // 如果当前模式是拍照、直播，开始录制
         // If current mode is photo or live streaming, start recording
         ESP_LOGI(TAG, "Camera is live streaming. Starting recording...");
-        record_control_response_frame_t *start_record_response = command_logic_start_record();
-        if (start_record_response != NULL) {
-            ESP_LOGI(TAG, "Recording started successfully.");
-            free(start_record_response);
-        } else {
-            ESP_LOGE(TAG, "Failed to start recording.");
+        for (int link = 0; link < BLE_MAX_LINKS; link++) {
+            if (connect_logic_get_link_state(link) != PROTOCOL_CONNECTED || is_link_camera_recording(link)) {
+                continue;
+            }
+            record_control_response_frame_t *start_record_response = command_logic_start_record(link);
+            if (start_record_response != NULL) {
+                ESP_LOGI(TAG, "Recording started successfully on link %d.", link);
+                free(start_record_response);
+            } else {
+                ESP_LOGE(TAG, "Failed to start recording on link %d.", link);
+            }
         }
     } else if (is_camera_recording()) {
         // 如果当前模式是拍照或录制中，停止录制
         // If current mode is photo or recording, stop recording
         ESP_LOGI(TAG, "Camera is recording or pre-recording. Stopping recording...");
-        record_control_response_frame_t *stop_record_response = command_logic_stop_record();
-        if (stop_record_response != NULL) {
-            ESP_LOGI(TAG, "Recording stopped successfully.");
-            free(stop_record_response);
-        } else {
-            ESP_LOGE(TAG, "Failed to stop recording.");
+        for (int link = 0; link < BLE_MAX_LINKS; link++) {
+            if (!is_link_camera_recording(link)) {
+                continue;
+            }
+            record_control_response_frame_t *stop_record_response = command_logic_stop_record(link);
+            if (stop_record_response != NULL) {
+                ESP_LOGI(TAG, "Recording stopped successfully on link %d.", link);
+                free(stop_record_response);
+            } else {
+                ESP_LOGE(TAG, "Failed to stop recording on link %d.", link);
+            }
         }
     } else {
         ESP_LOGI(TAG, "Camera is in an unsupported mode for recording.");
@@ -197,7 +256,7 @@ static void handle_boot_single_press() {
 
     /* QS 快速切换模式（可放入其他按键） */
     /* QS quick switch mode (can be assigned to other keys) */
-    // key_report_response_frame_t *key_report_response = command_logic_key_report_qs();
+    // key_report_response_frame_t *key_report_response = command_logic_key_report_qs(0);
     // if (key_report_response != NULL) {
     //     free(key_report_response);
     // }
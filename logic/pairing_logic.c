@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "nvs.h"
+
+#include "pairing_logic.h"
+
+#define TAG "LOGIC_PAIRING"
+
+#define PAIRING_NVS_NAMESPACE       "pairing"
+#define PAIRING_RECORD_VERSION      1
+
+/**
+ * @brief Build the NVS key of a camera address ("p" + 12 hex digits)
+ *        生成相机地址对应的 NVS 键（"p" + 12 位十六进制）
+ */
+static void pairing_key(const uint8_t camera_addr[6], char key[NVS_KEY_NAME_MAX_SIZE]) {
+    snprintf(key, NVS_KEY_NAME_MAX_SIZE, "p%02x%02x%02x%02x%02x%02x",
+             camera_addr[0], camera_addr[1], camera_addr[2], camera_addr[3], camera_addr[4], camera_addr[5]);
+}
+
+/**
+ * @brief Load the pairing with a camera
+ *        读取与某台相机的配对结果
+ *
+ * @param camera_addr Camera address
+ *                    相机地址
+ * @param record Output pairing record
+ *               输出的配对记录
+ * @return esp_err_t ESP_OK if the camera was paired before, ESP_ERR_NOT_FOUND otherwise
+ *                   之前配对过返回 ESP_OK，否则返回 ESP_ERR_NOT_FOUND
+ */
+esp_err_t pairing_logic_load(const uint8_t camera_addr[6], pairing_record_t *record) {
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    nvs_handle_t handle;
+    size_t length = sizeof(*record);
+
+    if (nvs_open(PAIRING_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    pairing_key(camera_addr, key);
+    esp_err_t ret = nvs_get_blob(handle, key, record, &length);
+    nvs_close(handle);
+
+    if (ret != ESP_OK || length != sizeof(*record) || record->version != PAIRING_RECORD_VERSION ||
+        memcmp(record->camera_addr, camera_addr, sizeof(record->camera_addr)) != 0 ||
+        record->mac_addr_len > sizeof(record->mac_addr)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Store the pairing with a camera
+ *        保存与某台相机的配对结果
+ *
+ * @param record Pairing record, the version is filled in here
+ *               配对记录，版本号在此填写
+ * @return esp_err_t ESP_OK on success, error code on failure
+ *                   成功返回 ESP_OK，失败返回错误码
+ */
+esp_err_t pairing_logic_store(pairing_record_t *record) {
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    nvs_handle_t handle;
+
+    record->version = PAIRING_RECORD_VERSION;
+    esp_err_t ret = nvs_open(PAIRING_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    pairing_key(record->camera_addr, key);
+    ret = nvs_set_blob(handle, key, record, sizeof(*record));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to store pairing: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * @brief Forget the pairing with a camera, the next connect pairs again
+ *        删除与某台相机的配对结果，下次连接重新配对
+ *
+ * @param camera_addr Camera address
+ *                    相机地址
+ */
+void pairing_logic_erase(const uint8_t camera_addr[6]) {
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    nvs_handle_t handle;
+
+    if (nvs_open(PAIRING_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        return;
+    }
+    pairing_key(camera_addr, key);
+    if (nvs_erase_key(handle, key) == ESP_OK) {
+        nvs_commit(handle);
+    }
+    nvs_close(handle);
+}
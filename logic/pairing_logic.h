@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __PAIRING_LOGIC_H__
+#define __PAIRING_LOGIC_H__
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Wait for the camera's verification result on a reconnection, no user confirmation is involved (ms)
+// 重连时等待相机验证结果的时间，无需用户确认 (毫秒)
+#define PAIRING_RECONNECT_WAIT_MS   3000
+
+// Wait for the camera's verification result on a first pairing, the user confirms on the camera (ms)
+// 首次配对时等待相机验证结果的时间，需用户在相机上确认 (毫秒)
+#define PAIRING_FIRST_WAIT_MS       30000
+
+// Reconnections in a row that get no verification result while the link stays up before the pairing is forgotten
+// 链路保持连接但连续收不到验证结果的重连次数，达到后删除配对结果
+#define PAIRING_MAX_TIMEOUTS        3
+
+/* Result of a first pairing with a camera, stored per camera address in NVS */
+/* 与相机首次配对的结果，按相机地址存储在 NVS 中 */
+typedef struct __attribute__((packed)) {
+    uint8_t version;
+    uint8_t camera_addr[6];     // BLE address of the camera
+                                // 相机的 BLE 地址
+    uint32_t device_id;         // Device ID the remote paired with
+                                // 配对时使用的遥控器设备 ID
+    uint8_t mac_addr_len;
+    int8_t mac_addr[16];        // MAC address the remote paired with
+                                // 配对时使用的遥控器 MAC 地址
+    uint32_t fw_version;
+    uint16_t verify_data;       // Verification code of the pairing
+                                // 配对时的校验码
+    uint8_t camera_reserved;    // Camera number
+                                // 相机编号
+} pairing_record_t;
+
+esp_err_t pairing_logic_load(const uint8_t camera_addr[6], pairing_record_t *record);
+
+esp_err_t pairing_logic_store(pairing_record_t *record);
+
+void pairing_logic_erase(const uint8_t camera_addr[6]);
+
+#endif
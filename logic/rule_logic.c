@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+
+#include "rule_logic.h"
+#include "action_logic.h"
+#include "console_logic.h"
+
+#define TAG "LOGIC_RULE"
+
+#define RULE_NVS_NAMESPACE  "rule"
+#define RULE_NVS_KEY        "rules"
+
+typedef struct {
+    uint8_t input;          // rule_input_t, RULE_INPUT_COUNT only wakes the task
+                            // rule_input_t，RULE_INPUT_COUNT 仅用于唤醒任务
+    int32_t value;
+} rule_input_update_t;
+
+static rule_engine_t s_engine = {0};
+static rule_engine_t s_next_engine;     // Recompiled rules until they are stored, guarded by s_rule_mutex
+                                        // 保存成功前的新编译规则，受 s_rule_mutex 保护
+static char s_rule_text[RULE_TEXT_MAX] = "";
+static SemaphoreHandle_t s_rule_mutex = NULL;
+static QueueHandle_t s_input_queue = NULL;
+
+// Last value posted per input, unchanged values are not queued; written by the GPS task and the
+// camera status callback, guarded by s_posted_mutex
+// 每个输入最近提交的数值，未变化的数值不入队；由 GPS 任务与相机状态回调写入，受 s_posted_mutex 保护
+static SemaphoreHandle_t s_posted_mutex = NULL;
+static int32_t s_posted_values[RULE_INPUT_COUNT];
+static uint8_t s_posted_inputs = 0;
+
+/**
+ * @brief Current time in ms
+ *        当前时间 (毫秒)
+ */
+static int64_t rule_now_ms(void) {
+    return esp_timer_get_time() / 1000;
+}
+
+/**
+ * @brief Rule fired, post its camera action
+ *        规则触发，提交对应的相机动作
+ */
+static void rule_fire(const rule_engine_t *engine, uint8_t index, void *context) {
+    const rule_t *rule = &engine->rules[index];
+    ESP_LOGI(TAG, "Rule %u fired, action %s", index, camera_action_to_string((camera_action_type_t)rule->action));
+    action_logic_post((camera_action_type_t)rule->action, rule->action_param, "rule");
+}
+
+/**
+ * @brief Update a rule input, never waits for the rule task
+ *        更新规则输入，不会等待规则任务
+ *
+ * Called from the GPS and camera status paths at their own rate; only changed values reach the rule task.
+ * The posted-value cache is only held for the check and a non-blocking queue send.
+ * 由 GPS 与相机状态路径按各自频率调用；只有变化的数值才会送到规则任务。
+ * 已提交数值的缓存只在比较与非阻塞入队期间持有。
+ *
+ * @param input Input to update
+ *              要更新的输入
+ * @param value Value in the input's unit
+ *              输入单位下的数值
+ */
+void rule_logic_set_input(rule_input_t input, int32_t value) {
+    uint8_t bit = (uint8_t)(1 << input);
+
+    if (s_input_queue == NULL || input >= RULE_INPUT_COUNT) {
+        return;
+    }
+
+    rule_input_update_t update = {
+        .input = (uint8_t)input,
+        .value = value,
+    };
+    xSemaphoreTake(s_posted_mutex, portMAX_DELAY);
+    if (!((s_posted_inputs & bit) && s_posted_values[input] == value) &&
+        xQueueSend(s_input_queue, &update, 0) == pdTRUE) {
+        s_posted_values[input] = value;
+        s_posted_inputs |= bit;
+    }
+    xSemaphoreGive(s_posted_mutex);
+}
+
+/**
+ * @brief Number of rule conditions evaluated since boot
+ *        启动以来评估的规则条件数
+ */
+uint32_t rule_logic_get_evaluations(void) {
+    return s_engine.evaluations;
+}
+
+/**
+ * @brief Store the rule text in NVS
+ *        将规则文本保存到 NVS
+ */
+static int rule_save(const char *text) {
+    nvs_handle_t handle;
+
+    esp_err_t ret = nvs_open(RULE_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return -1;
+    }
+    ret = nvs_set_str(handle, RULE_NVS_KEY, text);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save rules: %s", esp_err_to_name(ret));
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Compile and store a new rule text
+ *        编译并保存新的规则文本
+ *
+ * The rules are compiled into s_next_engine and only replace s_engine once stored, so a storage
+ * error leaves the running rules and their fired state untouched.
+ * 规则先编译到 s_next_engine，保存成功后才替换 s_engine，存储失败时运行中的规则及其触发状态不受影响。
+ *
+ * @return int Number of rules, -1 on a syntax or storage error
+ *             规则数量，语法或存储错误返回 -1
+ */
+static int rule_apply(const char *text, char *error, size_t error_size) {
+    rule_input_update_t wake = {
+        .input = RULE_INPUT_COUNT,
+    };
+
+    xSemaphoreTake(s_rule_mutex, portMAX_DELAY);
+    s_next_engine = s_engine;
+    int count = rule_engine_compile(&s_next_engine, text, error, error_size);
+    if (count >= 0) {
+        if (rule_save(text) != 0) {
+            snprintf(error, error_size, "storage");
+            count = -1;
+        } else {
+            s_engine = s_next_engine;
+            snprintf(s_rule_text, sizeof(s_rule_text), "%s", text);
+        }
+    }
+
+    // 用当前输入评估新增的规则（未变化的规则保留状态，不会再次触发），再唤醒规则任务以采用新的截止时刻
+    // Evaluate the added rules against the current inputs (unchanged rules keep their state and do not
+    // fire again), then wake the rule task for the new deadline
+    int64_t now_ms = rule_now_ms();
+    for (int input = 0; input < RULE_INPUT_COUNT; input++) {
+        if (s_engine.known_inputs & (1 << input)) {
+            rule_engine_set_input(&s_engine, (rule_input_t)input, s_engine.values[input], now_ms, rule_fire, NULL);
+        }
+    }
+    xSemaphoreGive(s_rule_mutex);
+    xQueueSend(s_input_queue, &wake, 0);
+    return count;
+}
+
+/**
+ * @brief RULE console command
+ *        RULE 控制台命令
+ *
+ * @param line Command line
+ *             命令行
+ */
+static void rule_command(const char *line) {
+    static char text[RULE_TEXT_MAX];
+    char error[48] = "";
+    int count = 0;
+
+    if (strncmp(line, "RULE ADD ", 9) == 0) {
+        snprintf(text, sizeof(text), "%s%s%s", s_rule_text, s_rule_text[0] != '\0' ? ";" : "", line + 9);
+        count = rule_apply(text, error, sizeof(error));
+    } else if (strncmp(line, "RULE DEL ", 9) == 0) {
+        // 跳过第 n 条规则，重新拼接其余规则
+        // Rebuild the text without rule n
+        char *end = NULL;
+        long target = strtol(line + 9, &end, 10);
+        const char *p = s_rule_text;
+        size_t length = 0;
+        long rules = 0;
+        text[0] = '\0';
+        for (; *p != '\0'; rules++) {
+            const char *separator = strchr(p, ';');
+            size_t item_length = separator ? (size_t)(separator - p) : strlen(p);
+            if (rules != target) {
+                length += snprintf(text + length, sizeof(text) - length, "%s%.*s", length ? ";" : "", (int)item_length, p);
+            }
+            p += item_length + (separator ? 1 : 0);
+        }
+        if (end == line + 9 || *end != '\0') {
+            snprintf(error, sizeof(error), "syntax");
+            count = -1;
+        } else if (target < 0 || target >= rules) {
+            snprintf(error, sizeof(error), "no rule %ld", target);
+            count = -1;
+        } else {
+            count = rule_apply(text, error, sizeof(error));
+        }
+    } else if (strcmp(line, "RULE CLEAR") == 0) {
+        count = rule_apply("", error, sizeof(error));
+    } else if (strcmp(line, "RULE") != 0) {
+        snprintf(error, sizeof(error), "syntax");
+        count = -1;
+    }
+
+    if (count < 0) {
+        console_printf("#ERR %s\n", error);
+        return;
+    }
+
+    const char *p = s_rule_text;
+    for (int i = 0; *p != '\0'; i++) {
+        const char *separator = strchr(p, ';');
+        size_t item_length = separator ? (size_t)(separator - p) : strlen(p);
+        console_printf("#RULE %d %.*s\n", i, (int)item_length, p);
+        p += item_length + (separator ? 1 : 0);
+    }
+    console_printf("#END %d\n", s_engine.count);
+}
+
+/**
+ * @brief Rule task, sleeps until an input changes or a hold time expires
+ *        规则任务，休眠直到输入变化或保持时间到期
+ *
+ * @param arg 任务参数
+ *            Task parameters
+ */
+static void rule_task(void *arg) {
+    rule_input_update_t update;
+
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+        xSemaphoreTake(s_rule_mutex, portMAX_DELAY);
+        int64_t deadline_ms = s_engine.next_deadline_ms;
+        xSemaphoreGive(s_rule_mutex);
+        if (deadline_ms != INT64_MAX) {
+            int64_t remaining_ms = deadline_ms - rule_now_ms();
+            wait = remaining_ms > 0 ? pdMS_TO_TICKS(remaining_ms) + 1 : 0;
+        }
+
+        bool received = xQueueReceive(s_input_queue, &update, wait) == pdTRUE;
+
+        xSemaphoreTake(s_rule_mutex, portMAX_DELAY);
+        int64_t now_ms = rule_now_ms();
+        if (received && update.input < RULE_INPUT_COUNT) {
+            rule_engine_set_input(&s_engine, (rule_input_t)update.input, update.value, now_ms, rule_fire, NULL);
+        }
+        rule_engine_poll(&s_engine, now_ms, rule_fire, NULL);
+        xSemaphoreGive(s_rule_mutex);
+    }
+}
+
+/**
+ * @brief Load the rules and start the rule task
+ *        读取规则并启动规则任务
+ *
+ * Must be called after NVS is initialized and before console_logic_init().
+ * 必须在 NVS 初始化之后、console_logic_init() 之前调用。
+ *
+ * @return int Returns 0 on success, -1 on failure
+ *             返回 0 表示成功，-1 表示失败
+ */
+int rule_logic_init(void) {
+    nvs_handle_t handle;
+    char error[48];
+
+    s_rule_mutex = xSemaphoreCreateMutex();
+    s_posted_mutex = xSemaphoreCreateMutex();
+    s_input_queue = xQueueCreate(RULE_INPUT_QUEUE_LENGTH, sizeof(rule_input_update_t));
+    if (s_rule_mutex == NULL || s_posted_mutex == NULL || s_input_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create rule queue");
+        return -1;
+    }
+
+    if (nvs_open(RULE_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        size_t length = sizeof(s_rule_text);
+        if (nvs_get_str(handle, RULE_NVS_KEY, s_rule_text, &length) != ESP_OK) {
+            s_rule_text[0] = '\0';
+        }
+        nvs_close(handle);
+    }
+
+    int count = rule_engine_compile(&s_engine, s_rule_text, error, sizeof(error));
+    if (count < 0) {
+        ESP_LOGE(TAG, "Stored rule \"%s\" invalid, rules disabled", error);
+        s_rule_text[0] = '\0';
+        rule_engine_compile(&s_engine, "", NULL, 0);
+        count = 0;
+    }
+    ESP_LOGI(TAG, "%d rules loaded", count);
+
+    if (xTaskCreate(rule_task, "rule_task", 1024 * 3, NULL, 1, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create rule task");
+        return -1;
+    }
+    return console_register_command("RULE", rule_command);
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __RULE_LOGIC_H__
+#define __RULE_LOGIC_H__
+
+#include <stdint.h>
+#include "rule_engine.h"
+
+/*
+ * Automatic camera actions from GPS and camera status, rules are stored in NVS and edited on the
+ * console (syntax: utils/rule/rule_engine.h):
+ * 基于 GPS 与相机状态的自动相机动作，规则保存在 NVS 中并通过控制台编辑（语法见 utils/rule/rule_engine.h）：
+ *
+ *   RULE                 list the rules / 列出规则
+ *   RULE ADD <rule>      append a rule / 追加一条规则
+ *   RULE DEL <n>         delete rule n (from 0), #ERR if there is none / 删除第 n 条规则（从 0 起），不存在时回复 #ERR
+ *   RULE CLEAR           delete all rules / 删除所有规则
+ */
+
+// Input updates waiting for the rule task
+// 等待规则任务处理的输入更新数
+#define RULE_INPUT_QUEUE_LENGTH 16
+
+int rule_logic_init(void);
+
+void rule_logic_set_input(rule_input_t input, int32_t value);
+
+uint32_t rule_logic_get_evaluations(void);
+
+#endif
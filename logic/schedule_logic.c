@@ -0,0 +1,502 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "ble_transport.h"
+#include "schedule_logic.h"
+#include "command_logic.h"
+#include "connect_logic.h"
+#include "console_logic.h"
+#include "gps_time_logic.h"
+#include "data.h"
+
+#define TAG "LOGIC_SCHEDULE"
+
+typedef struct {
+    bool used;
+    bool start_record;
+    int id;
+    int64_t utc_us;
+} schedule_entry_t;
+
+/* Record commands written at a target, their responses are collected off the timing path */
+/* 在目标时刻写出的录制命令，其应答在时序路径之外收集 */
+typedef struct {
+    int id;
+    bool start_record;
+    bool sent[BLE_MAX_LINKS];
+    uint16_t seqs[BLE_MAX_LINKS];
+} schedule_pending_t;
+
+static schedule_entry_t s_entries[SCHEDULE_MAX_ENTRIES];
+static int s_next_id = 1;
+static schedule_stats_t s_stats = {0};
+static SemaphoreHandle_t s_schedule_mutex = NULL;
+static TaskHandle_t s_schedule_task = NULL;
+static esp_timer_handle_t s_send_timer = NULL;
+static QueueHandle_t s_response_queue = NULL;
+
+/**
+ * @brief Map a UTC time to local time (esp_timer)
+ *        将 UTC 时间换算为本地时间（esp_timer）
+ *
+ * @param utc_us UTC (us since 1970)
+ *               UTC (自 1970 年起的微秒数)
+ * @param local_us Output local time (us)
+ *                 输出的本地时间 (微秒)
+ * @param pps Output, true if mapped with the PPS disciplined clock
+ *            输出，使用 PPS 校准时钟换算时为 true
+ * @return bool Returns false while there is no GPS time
+ *              尚无 GPS 时间时返回 false
+ */
+static bool schedule_to_local(int64_t utc_us, int64_t *local_us, bool *pps) {
+    int64_t now_us = esp_timer_get_time();
+    int64_t now_utc_us;
+
+    if (gps_time_utc_to_local(utc_us, local_us)) {
+        *pps = true;
+        return true;
+    }
+    if (gps_time_local_to_utc(now_us, &now_utc_us) == GPS_TIME_SOURCE_NONE) {
+        return false;
+    }
+    *local_us = now_us + (utc_us - now_utc_us);
+    *pps = false;
+    return true;
+}
+
+/**
+ * @brief Check whether an entry is still pending
+ *        检查条目是否仍在等待执行
+ */
+static bool schedule_is_pending(int id) {
+    bool pending = false;
+
+    xSemaphoreTake(s_schedule_mutex, portMAX_DELAY);
+    for (int i = 0; i < SCHEDULE_MAX_ENTRIES; i++) {
+        if (s_entries[i].used && s_entries[i].id == id) {
+            pending = true;
+        }
+    }
+    xSemaphoreGive(s_schedule_mutex);
+    return pending;
+}
+
+/**
+ * @brief Schedule a recording start or stop at a UTC time
+ *        在某 UTC 时刻安排开始或停止录制
+ *
+ * @param start_record true to start recording, false to stop
+ *                     true 为开始录制，false 为停止录制
+ * @param utc_us Target UTC (us since 1970)
+ *               目标 UTC (自 1970 年起的微秒数)
+ * @return int Id of the entry, -1 if the table is full
+ *             条目编号，表已满返回 -1
+ */
+int schedule_logic_add(bool start_record, int64_t utc_us) {
+    int id = -1;
+
+    xSemaphoreTake(s_schedule_mutex, portMAX_DELAY);
+    for (int i = 0; i < SCHEDULE_MAX_ENTRIES; i++) {
+        if (!s_entries[i].used) {
+            id = s_next_id++;
+            s_entries[i] = (schedule_entry_t){
+                .used = true,
+                .start_record = start_record,
+                .id = id,
+                .utc_us = utc_us,
+            };
+            break;
+        }
+    }
+    xSemaphoreGive(s_schedule_mutex);
+
+    if (id < 0) {
+        ESP_LOGE(TAG, "Schedule full");
+        return -1;
+    }
+    xTaskNotifyGive(s_schedule_task);
+    return id;
+}
+
+/**
+ * @brief Cancel a scheduled command
+ *        取消已安排的命令
+ *
+ * @param id Entry id
+ *           条目编号
+ * @return int Returns 0 on success, -1 if not pending
+ *             成功返回 0，未在等待时返回 -1
+ */
+int schedule_logic_cancel(int id) {
+    int ret = -1;
+
+    xSemaphoreTake(s_schedule_mutex, portMAX_DELAY);
+    for (int i = 0; i < SCHEDULE_MAX_ENTRIES; i++) {
+        if (s_entries[i].used && s_entries[i].id == id) {
+            s_entries[i].used = false;
+            ret = 0;
+        }
+    }
+    xSemaphoreGive(s_schedule_mutex);
+
+    xTaskNotifyGive(s_schedule_task);
+    return ret;
+}
+
+/**
+ * @brief Get the result of the last scheduled send
+ *        获取最近一次定时发送的结果
+ */
+void schedule_logic_get_stats(schedule_stats_t *out) {
+    xSemaphoreTake(s_schedule_mutex, portMAX_DELAY);
+    *out = s_stats;
+    xSemaphoreGive(s_schedule_mutex);
+}
+
+/**
+ * @brief Remove an entry, counting it as sent or dropped
+ *        移除条目，计为已发送或已丢弃
+ */
+static void schedule_finish(int id, bool sent) {
+    xSemaphoreTake(s_schedule_mutex, portMAX_DELAY);
+    for (int i = 0; i < SCHEDULE_MAX_ENTRIES; i++) {
+        if (s_entries[i].used && s_entries[i].id == id) {
+            s_entries[i].used = false;
+        }
+    }
+    if (sent) {
+        s_stats.sent_count++;
+    } else {
+        s_stats.dropped_count++;
+    }
+    xSemaphoreGive(s_schedule_mutex);
+}
+
+static void schedule_free_frames(uint8_t *frames[BLE_MAX_LINKS]) {
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        free(frames[link]);
+        frames[link] = NULL;
+    }
+}
+
+/**
+ * @brief Send one entry at its target time
+ *        在目标时刻发送一个条目
+ *
+ * Called SCHEDULE_PREPARE_MS before the target. Frames for every connected camera are built
+ * beforehand, at the target they are written back to back.
+ * 在目标时刻前 SCHEDULE_PREPARE_MS 调用。所有已连接相机的帧预先构建，到达目标时刻后依次连续写入。
+ */
+static void schedule_send(const schedule_entry_t *entry) {
+    const char *name = entry->start_record ? "start record" : "stop record";
+    int64_t local_us;
+    bool pps;
+    uint8_t *frames[BLE_MAX_LINKS] = {NULL};
+    size_t frame_lengths[BLE_MAX_LINKS] = {0};
+    schedule_pending_t pending = {
+        .id = entry->id,
+        .start_record = entry->start_record,
+    };
+
+    uint32_t links = connect_logic_get_protocol_links();
+    if (links == 0) {
+        ESP_LOGE(TAG, "Camera not connected, scheduled %s %d dropped", name, entry->id);
+        schedule_finish(entry->id, false);
+        return;
+    }
+
+    // 每台相机使用自己的 seq，应答按链路匹配
+    // Each camera uses its own seq, responses are matched per link
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        if (!(links & (1u << link))) {
+            continue;
+        }
+        pending.seqs[link] = generate_seq(link);
+        frames[link] = command_logic_create_record_frame(entry->start_record, pending.seqs[link], &frame_lengths[link]);
+        if (frames[link] == NULL) {
+            ESP_LOGE(TAG, "Failed to create frame for link %d", link);
+        }
+    }
+
+    // 使用最新的时间映射，并用单次定时器在目标时刻前唤醒
+    // Use the freshest time mapping and wake shortly before the target with a one-shot timer
+    if (!schedule_to_local(entry->utc_us, &local_us, &pps)) {
+        ESP_LOGE(TAG, "GPS time lost, scheduled %s %d dropped", name, entry->id);
+        schedule_free_frames(frames);
+        schedule_finish(entry->id, false);
+        return;
+    }
+    ulTaskNotifyTake(pdTRUE, 0);
+    int64_t remaining_us = local_us - esp_timer_get_time();
+    if (remaining_us > SCHEDULE_SPIN_US) {
+        esp_timer_start_once(s_send_timer, (uint64_t)(remaining_us - SCHEDULE_SPIN_US));
+    }
+    while (esp_timer_get_time() < local_us - SCHEDULE_SPIN_US) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SCHEDULE_PREPARE_MS + 100));
+        if (!schedule_is_pending(entry->id)) {
+            ESP_LOGI(TAG, "Scheduled %s %d cancelled", name, entry->id);
+            esp_timer_stop(s_send_timer);
+            schedule_free_frames(frames);
+            return;
+        }
+    }
+
+    // 剩余时间自旋等待，避免调度延迟
+    // Spin the rest to avoid scheduling latency
+    while (esp_timer_get_time() < local_us) {
+    }
+
+    int64_t call_us = esp_timer_get_time();
+    uint8_t cameras = 0;
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        if (frames[link] == NULL) {
+            continue;
+        }
+        esp_err_t ret = data_write_with_response(link, pending.seqs[link], frames[link], frame_lengths[link]);
+        if (ret == ESP_OK) {
+            pending.sent[link] = true;
+            cameras++;
+        } else {
+            ESP_LOGE(TAG, "Scheduled %s %d write failed on link %d: %s", name, entry->id, link, esp_err_to_name(ret));
+        }
+    }
+    int64_t done_us = esp_timer_get_time();
+    schedule_free_frames(frames);
+
+    if (cameras == 0) {
+        schedule_finish(entry->id, false);
+        return;
+    }
+
+    xSemaphoreTake(s_schedule_mutex, portMAX_DELAY);
+    s_stats.last_target_utc_us = entry->utc_us;
+    s_stats.last_error_us = (int32_t)(call_us - local_us);
+    s_stats.last_call_us = (int32_t)(done_us - call_us);
+    s_stats.last_cameras = cameras;
+    s_stats.last_pps = pps;
+    xSemaphoreGive(s_schedule_mutex);
+    schedule_finish(entry->id, true);
+
+    ESP_LOGI(TAG, "Scheduled %s %d sent to %u camera(s) %+ld us from target, write calls %ld us, %s time", name,
+             entry->id, cameras, (long)(call_us - local_us), (long)(done_us - call_us), pps ? "PPS" : "NMEA");
+
+    // 应答交给收集任务等待，调度任务立即去准备下一个条目
+    // The responses are waited for by the collector, the scheduler moves on to the next entry at once
+    if (xQueueSend(s_response_queue, &pending, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Scheduled %s %d responses not collected, queue full", name, entry->id);
+    }
+}
+
+/**
+ * @brief Response collector task, logs the camera responses of scheduled commands
+ *        应答收集任务，记录定时命令的相机应答
+ *
+ * Waiting up to 5 s per camera happens here, so a slow or missing camera never holds up the
+ * scheduler task and the next target.
+ * 每台相机最多 5 秒的等待在此进行，慢速或不在线的相机不会拖住调度任务与下一个目标时刻。
+ *
+ * @param arg 任务参数
+ *            Task parameters
+ */
+static void schedule_response_task(void *arg) {
+    schedule_pending_t pending;
+
+    while (1) {
+        if (xQueueReceive(s_response_queue, &pending, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        const char *name = pending.start_record ? "start record" : "stop record";
+        for (int link = 0; link < BLE_MAX_LINKS; link++) {
+            void *response = NULL;
+            size_t response_length = 0;
+            if (pending.sent[link] &&
+                data_wait_for_result_by_seq(link, pending.seqs[link], 5000, &response, &response_length) == ESP_OK &&
+                response != NULL) {
+                ESP_LOGI(TAG, "Scheduled %s %d response on link %d: ret_code=%d", name, pending.id, link,
+                         ((record_control_response_frame_t *)response)->ret_code);
+                free(response);
+            }
+        }
+    }
+}
+
+/**
+ * @brief One-shot timer shortly before a target, wakes the scheduler task
+ *        目标时刻前不久的单次定时器，唤醒调度任务
+ */
+static void schedule_timer_callback(void *arg) {
+    xTaskNotifyGive(s_schedule_task);
+}
+
+/**
+ * @brief Scheduler task, sleeps until the earliest entry is due for preparation
+ *        调度任务，休眠直到最早的条目需要准备
+ *
+ * @param arg 任务参数
+ *            Task parameters
+ */
+static void schedule_task(void *arg) {
+    while (1) {
+        schedule_entry_t entry = {0};
+
+        xSemaphoreTake(s_schedule_mutex, portMAX_DELAY);
+        for (int i = 0; i < SCHEDULE_MAX_ENTRIES; i++) {
+            if (s_entries[i].used && (!entry.used || s_entries[i].utc_us < entry.utc_us)) {
+                entry = s_entries[i];
+            }
+        }
+        xSemaphoreGive(s_schedule_mutex);
+
+        if (!entry.used) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        int64_t local_us;
+        bool pps;
+        if (!schedule_to_local(entry.utc_us, &local_us, &pps)) {
+            // 尚无 GPS 时间，稍后再试
+            // No GPS time yet, try again later
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+            continue;
+        }
+
+        int64_t remaining_us = local_us - esp_timer_get_time();
+        if (remaining_us < -SCHEDULE_LATE_LIMIT_US) {
+            ESP_LOGE(TAG, "Scheduled command %d missed its target by %lld ms, dropped", entry.id, (long long)(-remaining_us / 1000));
+            schedule_finish(entry.id, false);
+            continue;
+        }
+        if (remaining_us > SCHEDULE_PREPARE_MS * 1000LL) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((remaining_us / 1000) - SCHEDULE_PREPARE_MS));
+            continue;
+        }
+        schedule_send(&entry);
+    }
+}
+
+/**
+ * @brief AT console command
+ *        AT 控制台命令
+ *
+ * @param line Command line
+ *             命令行
+ */
+static void schedule_command(const char *line) {
+    char time_text[32];
+    char action[8];
+    int id;
+
+    if (sscanf(line, "AT CANCEL %d", &id) == 1) {
+        if (schedule_logic_cancel(id) != 0) {
+            console_printf("#ERR no entry %d\n", id);
+            return;
+        }
+    } else if (strcmp(line, "AT") != 0) {
+        if (sscanf(line, "AT %31s %7s", time_text, action) != 2 ||
+            (strcmp(action, "START") != 0 && strcmp(action, "STOP") != 0)) {
+            console_printf("#ERR AT <utc s>|+<s> START|STOP\n");
+            return;
+        }
+
+        int64_t utc_us = (int64_t)(strtod(time_text + (time_text[0] == '+'), NULL) * 1e6);
+        if (time_text[0] == '+') {
+            int64_t now_utc_us;
+            if (gps_time_now(&now_utc_us) == GPS_TIME_SOURCE_NONE) {
+                console_printf("#ERR no GPS time\n");
+                return;
+            }
+            utc_us += now_utc_us;
+        }
+        if (schedule_logic_add(strcmp(action, "START") == 0, utc_us) < 0) {
+            console_printf("#ERR schedule full\n");
+            return;
+        }
+    }
+
+    xSemaphoreTake(s_schedule_mutex, portMAX_DELAY);
+    schedule_entry_t entries[SCHEDULE_MAX_ENTRIES];
+    memcpy(entries, s_entries, sizeof(entries));
+    xSemaphoreGive(s_schedule_mutex);
+
+    for (int i = 0; i < SCHEDULE_MAX_ENTRIES; i++) {
+        if (entries[i].used) {
+            console_printf("#AT %d %s %lld.%06lld\n", entries[i].id, entries[i].start_record ? "START" : "STOP",
+                           (long long)(entries[i].utc_us / 1000000), (long long)(entries[i].utc_us % 1000000));
+        }
+    }
+    console_printf("#END\n");
+}
+
+/**
+ * @brief Initialize the command scheduler
+ *        初始化命令调度器
+ *
+ * Must be called before console_logic_init().
+ * 必须在 console_logic_init() 之前调用。
+ *
+ * @return int Returns 0 on success, -1 on failure
+ *             返回 0 表示成功，-1 表示失败
+ */
+int schedule_logic_init(void) {
+    s_schedule_mutex = xSemaphoreCreateMutex();
+    if (s_schedule_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create schedule mutex");
+        return -1;
+    }
+
+    s_response_queue = xQueueCreate(SCHEDULE_MAX_ENTRIES, sizeof(schedule_pending_t));
+    if (s_response_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create response queue");
+        return -1;
+    }
+
+    if (xTaskCreate(schedule_task, "schedule_task", 1024 * 3, NULL, SCHEDULE_TASK_PRIORITY, &s_schedule_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create schedule task");
+        return -1;
+    }
+    if (xTaskCreate(schedule_response_task, "schedule_resp", 1024 * 3, NULL, SCHEDULE_RESPONSE_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create schedule response task");
+        return -1;
+    }
+
+    esp_timer_create_args_t timer_args = {
+        .callback = schedule_timer_callback,
+        .name = "schedule",
+    };
+    if (esp_timer_create(&timer_args, &s_send_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create schedule timer");
+        return -1;
+    }
+    return console_register_command("AT", schedule_command);
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __SCHEDULE_LOGIC_H__
+#define __SCHEDULE_LOGIC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Recording start/stop at an absolute UTC time, so several controllers fed by GPS start their cameras
+ * together. Console commands:
+ * 在绝对 UTC 时刻开始/停止录制，使多个由 GPS 授时的控制器同时启动相机。控制台命令：
+ *
+ *   AT <utc s>[.frac] START|STOP     schedule at a Unix time / 在 Unix 时间执行
+ *   AT +<s> START|STOP               schedule relative to the current GPS time / 相对当前 GPS 时间执行
+ *   AT                               list pending commands / 列出待执行命令
+ *   AT CANCEL <id>                   cancel a command / 取消命令
+ *
+ * The frame is built SCHEDULE_PREPARE_MS ahead, a one-shot esp_timer wakes the scheduler task
+ * SCHEDULE_SPIN_US before the target and the rest is spun, so the write call starts within a few us
+ * of the target. The frame then goes out at the next BLE connection event.
+ * 帧提前 SCHEDULE_PREPARE_MS 构建，单次 esp_timer 在目标时刻前 SCHEDULE_SPIN_US 唤醒调度任务，
+ * 剩余时间自旋等待，使写调用在目标时刻后数微秒内开始。帧随后在下一个 BLE 连接事件发出。
+ */
+
+#define SCHEDULE_MAX_ENTRIES    4
+#define SCHEDULE_PREPARE_MS     500
+#define SCHEDULE_SPIN_US        300
+
+// A command whose target passed by more than this before it could be sent is dropped (us)
+// 目标时刻已过去超过该值仍未发送的命令将被丢弃 (微秒)
+#define SCHEDULE_LATE_LIMIT_US  20000
+
+// Above every application task so nothing delays the send
+// 高于所有应用任务，避免发送被延迟
+#define SCHEDULE_TASK_PRIORITY  5
+
+// Collects the camera responses after a send, only logs them
+// 发送后收集相机应答，仅记录日志
+#define SCHEDULE_RESPONSE_TASK_PRIORITY 1
+
+/* Result of the last scheduled send */
+/* 最近一次定时发送的结果 */
+typedef struct {
+    uint32_t sent_count;
+    uint32_t dropped_count;
+    int64_t last_target_utc_us;
+    int32_t last_error_us;       // Write call start minus target
+                                 // 写调用开始时刻减去目标时刻
+    int32_t last_call_us;        // Duration of the write calls to all cameras
+                                 // 写往所有相机的写调用总耗时
+    uint8_t last_cameras;        // Cameras the frame was written to
+                                 // 成功写入的相机数量
+    bool last_pps;               // Target mapped with the PPS disciplined clock
+                                 // 目标时刻由 PPS 校准时钟换算
+} schedule_stats_t;
+
+int schedule_logic_init(void);
+
+int schedule_logic_add(bool start_record, int64_t utc_us);
+
+int schedule_logic_cancel(int id);
+
+void schedule_logic_get_stats(schedule_stats_t *out);
+
+#endif
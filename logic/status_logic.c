@@ -25,20 +25,30 @@
 #include <string.h>
 #include "esp_log.h"
 
+#include "ble_transport.h"
 #include "enums_logic.h"
 #include "connect_logic.h"
 #include "command_logic.h"
+#include "rule_logic.h"
 #include "dji_protocol_data_structures.h"
+#include "status_logic.h"
 
 static const char *TAG = "LOGIC_STATUS";
 
-// Global variables to store various camera status information
-// 全局变量，保存相机的各种状态信息
+// Status mirror of each camera link
+// 每条相机链路的状态镜像
+static camera_link_status_t s_link_status[BLE_MAX_LINKS];
+
+// Global variables to store various camera status information, mirroring the primary camera
+// (the lowest link with a status) for the light, rules and GPS rate logic
+// 全局变量，保存相机的各种状态信息，镜像主相机（有状态的最小链路），供灯光、规则与 GPS 频率逻辑使用
 uint8_t current_camera_mode = 0;
 uint8_t current_camera_status = 0;
 uint8_t current_video_resolution = 0;
 uint8_t current_fps_idx = 0;
 uint8_t current_eis_mode = 0;
+uint8_t current_temp_over = 0;
+uint8_t current_camera_bat_percentage = 100;
 bool camera_status_initialized = false;
 
 /**
@@ -58,6 +68,77 @@ bool is_camera_recording() {
     return false;
 }
 
+/**
+ * @brief Check if the camera on a link is recording
+ *        检查某条链路上的相机是否正在录制
+ *
+ * @param link Link of the camera
+ *             相机所在链路
+ * @return bool Returns true if the camera is recording, false otherwise
+ *              如果相机正在录制，则返回 true，否则返回 false
+ */
+bool is_link_camera_recording(int link) {
+    if (link < 0 || link >= BLE_MAX_LINKS || !s_link_status[link].initialized) {
+        return false;
+    }
+    return s_link_status[link].camera_status == CAMERA_STATUS_PHOTO_OR_RECORDING ||
+           s_link_status[link].camera_status == CAMERA_STATUS_PRE_RECORDING;
+}
+
+/**
+ * @brief Get the status mirror of a link
+ *        获取某条链路的状态镜像
+ *
+ * @param link Link of the camera
+ *             相机所在链路
+ * @return const camera_link_status_t* Status mirror, NULL for an invalid link
+ *                                     状态镜像，链路无效时为 NULL
+ */
+const camera_link_status_t *status_logic_get_link_status(int link) {
+    if (link < 0 || link >= BLE_MAX_LINKS) {
+        return NULL;
+    }
+    return &s_link_status[link];
+}
+
+/**
+ * @brief Copy the primary camera into the global status variables
+ *        将主相机状态复制到全局状态变量
+ */
+static void status_logic_update_primary(void) {
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        const camera_link_status_t *status = &s_link_status[link];
+        if (!status->initialized) {
+            continue;
+        }
+        current_camera_mode = status->camera_mode;
+        current_camera_status = status->camera_status;
+        current_video_resolution = status->video_resolution;
+        current_fps_idx = status->fps_idx;
+        current_eis_mode = status->eis_mode;
+        current_temp_over = status->temp_over;
+        current_camera_bat_percentage = status->camera_bat_percentage;
+        camera_status_initialized = true;
+        return;
+    }
+    camera_status_initialized = false;
+}
+
+/**
+ * @brief Forget the status of a disconnected camera
+ *        清除已断开相机的状态
+ *
+ * @param link Link of the camera
+ *             相机所在链路
+ */
+void status_logic_reset_link(int link) {
+    if (link < 0 || link >= BLE_MAX_LINKS) {
+        return;
+    }
+    s_link_status[link].initialized = false;
+    status_logic_update_primary();
+}
+
 /**
  * @brief Print current camera status (partial status, other status can be printed as needed)
  *        打印当前相机状态（部分状态，后续可自行打印其它状态）
@@ -65,19 +146,20 @@ bool is_camera_recording() {
  * Print camera mode, status, resolution, frame rate and electronic image stabilization mode.
  * 打印相机的模式、状态、分辨率、帧率和电子防抖模式等信息。
  */
-void print_camera_status() {
-    if (!camera_status_initialized) {
+void print_camera_status(int link) {
+    const camera_link_status_t *status = status_logic_get_link_status(link);
+    if (status == NULL || !status->initialized) {
         ESP_LOGW(TAG, "Camera status has not been initialized.");
         return;
     }
 
-    const char *mode_str = camera_mode_to_string((camera_mode_t)current_camera_mode);
-    const char *status_str = camera_status_to_string((camera_status_t)current_camera_status);
-    const char *resolution_str = video_resolution_to_string((video_resolution_t)current_video_resolution);
-    const char *fps_str = fps_idx_to_string((fps_idx_t)current_fps_idx);
-    const char *eis_str = eis_mode_to_string((eis_mode_t)current_eis_mode);
+    const char *mode_str = camera_mode_to_string((camera_mode_t)status->camera_mode);
+    const char *status_str = camera_status_to_string((camera_status_t)status->camera_status);
+    const char *resolution_str = video_resolution_to_string((video_resolution_t)status->video_resolution);
+    const char *fps_str = fps_idx_to_string((fps_idx_t)status->fps_idx);
+    const char *eis_str = eis_mode_to_string((eis_mode_t)status->eis_mode);
 
-    ESP_LOGI(TAG, "Current camera status has changed:");
+    ESP_LOGI(TAG, "Current camera status on link %d has changed:", link);
     ESP_LOGI(TAG, "  Mode: %s", mode_str);
     ESP_LOGI(TAG, "  Status: %s", status_str);
     ESP_LOGI(TAG, "  Resolution: %s", resolution_str);
@@ -89,6 +171,8 @@ void print_camera_status() {
  * @brief Subscribe to camera status
  *        订阅相机状态
  * 
+ * @param link Link of the camera
+ *             相机所在链路
  * @param push_mode Subscription mode
  *                  订阅模式
  * @param push_freq Subscription frequency
@@ -96,15 +180,15 @@ void print_camera_status() {
  * @return int Returns 0 on success, -1 on failure
  *             返回 0 表示成功，-1 表示失败
  */
-int subscript_camera_status(uint8_t push_mode, uint8_t push_freq) {
-    ESP_LOGI(TAG, "Subscribing to Camera Status with push_mode: %d, push_freq: %d", push_mode, push_freq);
+int subscript_camera_status(int link, uint8_t push_mode, uint8_t push_freq) {
+    ESP_LOGI(TAG, "Subscribing to Camera Status on link %d with push_mode: %d, push_freq: %d", link, push_mode, push_freq);
 
-    if (connect_logic_get_state() != PROTOCOL_CONNECTED) {
-        ESP_LOGE(TAG, "Protocol connection to the camera failed. Current connection state: %d", connect_logic_get_state());
+    if (connect_logic_get_link_state(link) != PROTOCOL_CONNECTED) {
+        ESP_LOGE(TAG, "Protocol connection to the camera failed. Current connection state: %d", connect_logic_get_link_state(link));
         return -1;
     }
 
-    uint16_t seq = generate_seq();
+    uint16_t seq = generate_seq(link);
 
     camera_status_subscription_command_frame command_frame = {
         .push_mode = push_mode,
@@ -112,7 +196,7 @@ int subscript_camera_status(uint8_t push_mode, uint8_t push_freq) {
         .reserved = {0, 0, 0, 0}
     };
 
-    send_command(0x1D, 0x05, CMD_NO_RESPONSE, &command_frame, seq, 5000);
+    send_command(link, 0x1D, 0x05, CMD_NO_RESPONSE, &command_frame, seq, 5000);
 
     return 0;
 }
@@ -124,72 +208,98 @@ int subscript_camera_status(uint8_t push_mode, uint8_t push_freq) {
  * Process and update various camera states, check for state changes and print updated information.
  * 处理并更新相机的各项状态，检查状态是否发生变化并打印更新后的信息。
  * 
+ * @param link Link the status was pushed on
+ *             推送状态的链路
  * @param data Input camera status data
  *             传入的相机状态数据
  */
-void update_camera_state_handler(void *data) {
+void update_camera_state_handler(int link, void *data) {
     if (!data) {
         ESP_LOGE(TAG, "logic_update_camera_state: Received NULL data.");
         return;
     }
+    if (link < 0 || link >= BLE_MAX_LINKS) {
+        free(data);
+        return;
+    }
 
     const camera_status_push_command_frame *parsed_data = (const camera_status_push_command_frame *)data;
+    camera_link_status_t *status = &s_link_status[link];
 
     bool state_changed = false;
 
     // Check and update camera mode
     // 检查并更新相机模式
-    if (current_camera_mode != parsed_data->camera_mode) {
-        current_camera_mode = parsed_data->camera_mode;
-        ESP_LOGI(TAG, "Camera mode updated to: %d", current_camera_mode);
+    if (status->camera_mode != parsed_data->camera_mode) {
+        status->camera_mode = parsed_data->camera_mode;
+        ESP_LOGI(TAG, "Link %d camera mode updated to: %d", link, status->camera_mode);
         state_changed = true;
     }
 
     // Check and update camera status
     // 检查并更新相机状态
-    if (current_camera_status != parsed_data->camera_status) {
-        current_camera_status = parsed_data->camera_status;
-        ESP_LOGI(TAG, "Camera status updated to: %d", current_camera_status);
+    if (status->camera_status != parsed_data->camera_status) {
+        status->camera_status = parsed_data->camera_status;
+        ESP_LOGI(TAG, "Link %d camera status updated to: %d", link, status->camera_status);
         state_changed = true;
     }
 
     // Check and update video resolution
     // 检查并更新视频分辨率
-    if (current_video_resolution != parsed_data->video_resolution) {
-        current_video_resolution = parsed_data->video_resolution;
-        ESP_LOGI(TAG, "Video resolution updated to: %d", current_video_resolution);
+    if (status->video_resolution != parsed_data->video_resolution) {
+        status->video_resolution = parsed_data->video_resolution;
+        ESP_LOGI(TAG, "Link %d video resolution updated to: %d", link, status->video_resolution);
         state_changed = true;
     }
 
     // Check and update frame rate
     // 检查并更新帧率
-    if (current_fps_idx != parsed_data->fps_idx) {
-        current_fps_idx = parsed_data->fps_idx;
-        ESP_LOGI(TAG, "FPS index updated to: %d", current_fps_idx);
+    if (status->fps_idx != parsed_data->fps_idx) {
+        status->fps_idx = parsed_data->fps_idx;
+        ESP_LOGI(TAG, "Link %d FPS index updated to: %d", link, status->fps_idx);
         state_changed = true;
     }
 
     // Check and update electronic image stabilization mode
     // 检查并更新电子防抖模式
-    if (current_eis_mode != parsed_data->eis_mode) {
-        current_eis_mode = parsed_data->eis_mode;
-        ESP_LOGI(TAG, "EIS mode updated to: %d", current_eis_mode);
+    if (status->eis_mode != parsed_data->eis_mode) {
+        status->eis_mode = parsed_data->eis_mode;
+        ESP_LOGI(TAG, "Link %d EIS mode updated to: %d", link, status->eis_mode);
         state_changed = true;
     }
 
+    // Check and update temperature status
+    // 检查并更新温度状态
+    if (status->temp_over != parsed_data->temp_over) {
+        status->temp_over = parsed_data->temp_over;
+        ESP_LOGI(TAG, "Link %d temperature status updated to: %d", link, status->temp_over);
+    }
+
+    // Update battery percentage, changes too often to be logged
+    // 更新电池电量，变化频繁因此不打印
+    status->camera_bat_percentage = parsed_data->camera_bat_percentage;
+
     // If status not initialized, mark as initialized
     // 如果状态尚未初始化，标记为已初始化
-    if (!camera_status_initialized) {
-        camera_status_initialized = true;
-        ESP_LOGI(TAG, "Camera state fully updated and marked as initialized.");
+    if (!status->initialized) {
+        status->initialized = true;
+        ESP_LOGI(TAG, "Link %d camera state fully updated and marked as initialized.", link);
         state_changed = true;  // Force status print as this is initialization
                                // 强制打印状态，因为这是初始化
     }
 
+    status_logic_update_primary();
+
+    // 更新规则输入，未变化的数值不会触发评估
+    // Update the rule inputs, unchanged values do not trigger an evaluation
+    rule_logic_set_input(RULE_INPUT_BATTERY, current_camera_bat_percentage);
+    rule_logic_set_input(RULE_INPUT_CAMERA_MODE, current_camera_mode);
+    rule_logic_set_input(RULE_INPUT_RECORDING, is_camera_recording());
+
     // If state changed or first initialization, print current camera status
     // 如果状态变更或第一次初始化，打印当前相机状态
     if (state_changed) {
-        print_camera_status();
+        print_camera_status(link);
     }
 
     free(data);
@@ -23,6 +23,20 @@
 #define STATUS_LOGIC_H
 
 #include <stdint.h>
+#include <stdbool.h>
+
+// 单台相机的状态镜像
+// Status mirror of one camera
+typedef struct {
+    uint8_t camera_mode;
+    uint8_t camera_status;
+    uint8_t video_resolution;
+    uint8_t fps_idx;
+    uint8_t eis_mode;
+    uint8_t temp_over;
+    uint8_t camera_bat_percentage;
+    bool initialized;
+} camera_link_status_t;
 
 // 相机状态全局变量声明（其他的后续可补充）
 // Declaration of global variables for camera status (more can be added later)
@@ -31,14 +45,22 @@ extern uint8_t current_camera_status;
 extern uint8_t current_video_resolution;
 extern uint8_t current_fps_idx;
 extern uint8_t current_eis_mode;
+extern uint8_t current_temp_over;
+extern uint8_t current_camera_bat_percentage;
 extern bool camera_status_initialized;
 
 bool is_camera_recording();
 
-void print_camera_status();
+bool is_link_camera_recording(int link);
+
+const camera_link_status_t *status_logic_get_link_status(int link);
+
+void status_logic_reset_link(int link);
+
+void print_camera_status(int link);
 
-int subscript_camera_status(uint8_t push_mode, uint8_t push_freq);
+int subscript_camera_status(int link, uint8_t push_mode, uint8_t push_freq);
 
-void update_camera_state_handler(void *data);
+void update_camera_state_handler(int link, void *data);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "nvs.h"
+
+#include "time_zone_logic.h"
+#include "console_logic.h"
+
+#define TAG "LOGIC_TIME_ZONE"
+
+#define TIME_ZONE_NVS_NAMESPACE     "time_zone"
+#define TIME_ZONE_NVS_KEY           "config"
+#define TIME_ZONE_RECORD_VERSION    1
+
+/* Time zone as stored in NVS */
+/* 存储在 NVS 中的时区 */
+typedef struct __attribute__((packed)) {
+    uint8_t version;
+    int16_t offset_min;     // Standard offset from UTC
+                            // 相对 UTC 的标准偏移
+    uint8_t dst_rule;       // civil_dst_rule_t
+} time_zone_record_t;
+
+/* Local date of the current day, valid for one UTC interval */
+/* 当天的本地日期，在一段 UTC 区间内有效 */
+typedef struct {
+    uint32_t generation;        // Config generation the entry was built with
+                                // 构建该缓存时的配置版本
+    int64_t valid_from_s;
+    int64_t valid_until_s;      // Next local midnight or offset change, whichever is first
+                                // 下一个本地零点或偏移变化，取较早者
+    int64_t day_start_s;        // UTC time of local midnight
+                                // 本地零点对应的 UTC 时间
+    uint32_t year_month_day;
+} time_zone_cache_t;
+
+static SemaphoreHandle_t s_time_zone_mutex = NULL;
+static time_zone_record_t s_config = {
+    .version = TIME_ZONE_RECORD_VERSION,
+    .offset_min = TIME_ZONE_DEFAULT_OFFSET_MIN,
+    .dst_rule = CIVIL_DST_NONE,
+};
+static volatile uint32_t s_config_generation = 1;
+static time_zone_cache_t s_cache = {0};
+
+static const char *const s_dst_rule_names[CIVIL_DST_RULE_COUNT] = {"NONE", "EU", "US"};
+
+/**
+ * @brief Load the time zone from NVS
+ *        从 NVS 读取时区
+ *
+ * @return bool Returns true if a valid record was found
+ *              找到有效记录时返回 true
+ */
+static bool time_zone_load(void) {
+    nvs_handle_t handle;
+    time_zone_record_t record;
+    size_t length = sizeof(record);
+
+    if (nvs_open(TIME_ZONE_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+    esp_err_t ret = nvs_get_blob(handle, TIME_ZONE_NVS_KEY, &record, &length);
+    nvs_close(handle);
+
+    if (ret != ESP_OK || length != sizeof(record) || record.version != TIME_ZONE_RECORD_VERSION ||
+        record.offset_min > TIME_ZONE_MAX_OFFSET_MIN || record.offset_min < -TIME_ZONE_MAX_OFFSET_MIN ||
+        record.dst_rule >= CIVIL_DST_RULE_COUNT) {
+        return false;
+    }
+    s_config = record;
+    return true;
+}
+
+/**
+ * @brief Write the time zone to NVS as one blob
+ *        将时区作为一个 blob 写入 NVS
+ *
+ * @return int Returns 0 on success, -1 on failure
+ *             返回 0 表示成功，-1 表示失败
+ */
+static int time_zone_save(const time_zone_record_t *record) {
+    nvs_handle_t handle;
+
+    esp_err_t ret = nvs_open(TIME_ZONE_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return -1;
+    }
+    ret = nvs_set_blob(handle, TIME_ZONE_NVS_KEY, record, sizeof(*record));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save time zone: %s", esp_err_to_name(ret));
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Set and persist the time zone
+ *        设置并保存时区
+ *
+ * @param offset_min Standard offset from UTC (min)
+ *                   相对 UTC 的标准偏移 (分钟)
+ * @param dst_rule Daylight saving rule
+ *                 夏令时规则
+ * @return int Returns 0 on success, -1 on invalid arguments or NVS failure
+ *             成功返回 0，参数无效或 NVS 失败返回 -1
+ */
+int time_zone_logic_set(int16_t offset_min, civil_dst_rule_t dst_rule) {
+    if (offset_min > TIME_ZONE_MAX_OFFSET_MIN || offset_min < -TIME_ZONE_MAX_OFFSET_MIN || dst_rule >= CIVIL_DST_RULE_COUNT) {
+        ESP_LOGE(TAG, "Invalid time zone %d min, rule %d", offset_min, dst_rule);
+        return -1;
+    }
+
+    time_zone_record_t record = {
+        .version = TIME_ZONE_RECORD_VERSION,
+        .offset_min = offset_min,
+        .dst_rule = (uint8_t)dst_rule,
+    };
+    if (time_zone_save(&record) != 0) {
+        return -1;
+    }
+
+    xSemaphoreTake(s_time_zone_mutex, portMAX_DELAY);
+    s_config = record;
+    s_config_generation++;
+    xSemaphoreGive(s_time_zone_mutex);
+
+    ESP_LOGI(TAG, "Time zone set to %+d min, DST %s", offset_min, s_dst_rule_names[dst_rule]);
+    return 0;
+}
+
+/**
+ * @brief Get the configured time zone
+ *        获取已配置的时区
+ */
+void time_zone_logic_get(int16_t *offset_min, civil_dst_rule_t *dst_rule) {
+    xSemaphoreTake(s_time_zone_mutex, portMAX_DELAY);
+    *offset_min = s_config.offset_min;
+    *dst_rule = (civil_dst_rule_t)s_config.dst_rule;
+    xSemaphoreGive(s_time_zone_mutex);
+}
+
+/**
+ * @brief Rebuild the date cache for a UTC time
+ *        为某 UTC 时间重建日期缓存
+ */
+static void time_zone_refresh_cache(int64_t utc_s) {
+    int64_t next_change_s;
+
+    xSemaphoreTake(s_time_zone_mutex, portMAX_DELAY);
+    uint32_t generation = s_config_generation;
+    int32_t offset_s = civil_dst_offset_s((civil_dst_rule_t)s_config.dst_rule, s_config.offset_min * 60, utc_s, &next_change_s);
+    xSemaphoreGive(s_time_zone_mutex);
+
+    int64_t days = civil_floor_div(utc_s + offset_s, 86400);
+    civil_date_t date = civil_date_from_days(days);
+
+    s_cache.day_start_s = days * 86400 - offset_s;
+    s_cache.valid_from_s = utc_s;
+    s_cache.valid_until_s = s_cache.day_start_s + 86400 < next_change_s ? s_cache.day_start_s + 86400 : next_change_s;
+    s_cache.year_month_day = (uint32_t)date.year * 10000 + date.month * 100 + date.day;
+    s_cache.generation = generation;
+}
+
+/**
+ * @brief Convert UTC to local date and time in the camera's packed decimal form
+ *        将 UTC 转换为相机使用的十进制压缩格式的本地日期和时间
+ *
+ * The date is only recomputed when the local day, the offset or the configuration changes, the
+ * usual path is a range check and a few integer divisions. Not thread safe, called from the push task.
+ * 仅在本地日期、偏移或配置变化时重新计算日期，通常只需一次范围检查和几次整数除法。非线程安全，由推送任务调用。
+ *
+ * @param utc_s Unix time (s)
+ *              Unix 时间 (秒)
+ * @param year_month_day Receives YYYYMMDD
+ *                       接收 YYYYMMDD
+ * @param hour_minute_second Receives HHMMSS
+ *                           接收 HHMMSS
+ */
+void time_zone_logic_to_local(int64_t utc_s, uint32_t *year_month_day, uint32_t *hour_minute_second) {
+    if (s_cache.generation != s_config_generation || utc_s < s_cache.valid_from_s || utc_s >= s_cache.valid_until_s) {
+        time_zone_refresh_cache(utc_s);
+    }
+
+    uint32_t second_of_day = (uint32_t)(utc_s - s_cache.day_start_s);
+    *year_month_day = s_cache.year_month_day;
+    *hour_minute_second = second_of_day / 3600 * 10000 + second_of_day / 60 % 60 * 100 + second_of_day % 60;
+}
+
+/**
+ * @brief TZ console command
+ *        TZ 控制台命令
+ *
+ * @param line Command line
+ *             命令行
+ */
+static void time_zone_command(const char *line) {
+    char sign = 0;
+    unsigned hours = 0, minutes = 0;
+    char rule_name[8] = "NONE";
+    int16_t offset_min;
+    civil_dst_rule_t dst_rule;
+
+    if (strcmp(line, "TZ") != 0) {
+        int fields = sscanf(line, "TZ %c%u:%u %7s", &sign, &hours, &minutes, rule_name);
+        int rule = -1;
+        for (int i = 0; i < CIVIL_DST_RULE_COUNT; i++) {
+            if (strcmp(rule_name, s_dst_rule_names[i]) == 0) {
+                rule = i;
+            }
+        }
+        if (fields < 3 || (sign != '+' && sign != '-') || minutes >= 60 || hours > 14 || rule < 0 ||
+            time_zone_logic_set((int16_t)((sign == '-' ? -1 : 1) * (int)(hours * 60 + minutes)), (civil_dst_rule_t)rule) != 0) {
+            console_printf("#ERR TZ <+|-HH:MM> [NONE|EU|US]\n");
+            return;
+        }
+    }
+
+    time_zone_logic_get(&offset_min, &dst_rule);
+    console_printf("#TZ %c%02d:%02d %s\n", offset_min < 0 ? '-' : '+', abs(offset_min) / 60, abs(offset_min) % 60,
+                   s_dst_rule_names[dst_rule]);
+}
+
+/**
+ * @brief Load the time zone and register the TZ console command
+ *        读取时区并注册 TZ 控制台命令
+ *
+ * Must be called after NVS is initialized and before console_logic_init().
+ * 必须在 NVS 初始化之后、console_logic_init() 之前调用。
+ *
+ * @return int Returns 0 on success, -1 on failure
+ *             返回 0 表示成功，-1 表示失败
+ */
+int time_zone_logic_init(void) {
+    s_time_zone_mutex = xSemaphoreCreateMutex();
+    if (s_time_zone_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create time zone mutex");
+        return -1;
+    }
+
+    if (time_zone_load()) {
+        ESP_LOGI(TAG, "Time zone %+d min, DST %s", s_config.offset_min, s_dst_rule_names[s_config.dst_rule]);
+    } else {
+        ESP_LOGI(TAG, "No stored time zone, using %+d min", s_config.offset_min);
+    }
+    return console_register_command("TZ", time_zone_command);
+}
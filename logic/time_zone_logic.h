@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __TIME_ZONE_LOGIC_H__
+#define __TIME_ZONE_LOGIC_H__
+
+#include <stdint.h>
+#include "civil_time.h"
+
+/*
+ * Local civil time for the camera, a standard UTC offset plus an optional daylight saving rule,
+ * persisted in NVS and set with the console command:
+ * 相机使用的本地民用时间，由标准 UTC 偏移加可选的夏令时规则组成，保存在 NVS 中，通过控制台命令设置：
+ *
+ *   TZ                             show the current setting / 显示当前设置
+ *   TZ <+|-HH:MM> [NONE|EU|US]     set offset and daylight saving rule / 设置偏移和夏令时规则
+ */
+
+// Offset used until one is configured, UTC+8 as the camera expected before (min)
+// 未配置时使用的偏移，即之前相机默认的 UTC+8 (分钟)
+#define TIME_ZONE_DEFAULT_OFFSET_MIN  480
+
+// Largest accepted offset either side of UTC (min)
+// 允许的最大 UTC 偏移 (分钟)
+#define TIME_ZONE_MAX_OFFSET_MIN      (14 * 60)
+
+int time_zone_logic_init(void);
+
+int time_zone_logic_set(int16_t offset_min, civil_dst_rule_t dst_rule);
+
+void time_zone_logic_get(int16_t *offset_min, civil_dst_rule_t *dst_rule);
+
+void time_zone_logic_to_local(int64_t utc_s, uint32_t *year_month_day, uint32_t *hour_minute_second);
+
+#endif
@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+#include "track_logic.h"
+
+#define TAG "LOGIC_TRACK"
+
+#define TRACK_QUEUE_LENGTH      32
+#define TRACK_PAGES_PER_SECTOR  (TRACK_SECTOR_SIZE / TRACK_PAGE_SIZE)
+
+_Static_assert(sizeof(track_page_t) == TRACK_PAGE_SIZE, "track page must be exactly one flash page");
+
+/* Message to the logger task */
+/* 发送给记录任务的消息 */
+typedef struct {
+    bool flush;             // Write the partial page now
+                            // 立即写入未满的页
+    track_point_t point;
+} track_message_t;
+
+static const esp_partition_t *s_partition = NULL;
+static QueueHandle_t s_track_queue = NULL;
+
+/* 互斥锁，保护 s_info */
+/* Mutex to protect s_info */
+static SemaphoreHandle_t s_info_mutex = NULL;
+static track_info_t s_info = {0};
+
+// Page being filled by the logger task
+// 记录任务正在填充的页
+static track_page_t s_page;
+static track_encoder_t s_encoder;
+static int64_t s_page_started_us = 0;
+
+/**
+ * @brief CRC32 of a page, covering header and payload
+ *        页的 CRC32，覆盖页头和数据
+ */
+static uint32_t track_page_crc(const track_page_t *page) {
+    return esp_rom_crc32_le(0, (const uint8_t *)page, offsetof(track_page_t, crc));
+}
+
+/**
+ * @brief Check whether a page is still erased
+ *        检查页是否仍处于擦除状态
+ */
+static bool track_page_is_blank(const track_page_t *page) {
+    const uint8_t *bytes = (const uint8_t *)page;
+    for (size_t i = 0; i < sizeof(*page); i++) {
+        if (bytes[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Read one page from the partition and validate it
+ *        从分区读取一页并校验
+ *
+ * @param index Page index
+ *              页索引
+ * @param out Page content
+ *            页内容
+ * @return bool Returns true if the page holds valid track data
+ *              页中包含有效轨迹数据时返回 true
+ */
+bool track_logic_read_page(uint32_t index, track_page_t *out) {
+    if (s_partition == NULL || index >= s_info.page_count) {
+        return false;
+    }
+    if (esp_partition_read(s_partition, (size_t)index * TRACK_PAGE_SIZE, out, sizeof(*out)) != ESP_OK) {
+        return false;
+    }
+    return out->header.magic == TRACK_PAGE_MAGIC &&
+           out->header.version == TRACK_PAGE_VERSION &&
+           out->header.length <= TRACK_PAGE_PAYLOAD_SIZE &&
+           out->crc == track_page_crc(out);
+}
+
+/**
+ * @brief Find where to continue writing after a reset
+ *        复位后确定继续写入的位置
+ *
+ * The newest valid page is found from the sequence numbers. A torn page left by a power loss fails
+ * its CRC and is ignored; if the rest of its sector is not blank, writing resumes at the next sector.
+ * 通过序号找到最新的有效页。掉电导致的残缺页 CRC 校验失败，被忽略；若其所在扇区剩余部分不是空白，
+ * 则从下一个扇区继续写入。
+ */
+static void track_recover(void) {
+    bool found = false;
+    uint32_t newest_index = 0;
+    uint32_t newest_sequence = 0;
+
+    for (uint32_t i = 0; i < s_info.page_count; i++) {
+        if (track_logic_read_page(i, &s_page) && (!found || s_page.header.sequence > newest_sequence)) {
+            found = true;
+            newest_index = i;
+            newest_sequence = s_page.header.sequence;
+        }
+    }
+
+    if (!found) {
+        s_info.write_index = 0;
+        s_info.next_sequence = 1;
+        ESP_LOGI(TAG, "Track partition empty");
+        return;
+    }
+
+    uint32_t write_index = (newest_index + 1) % s_info.page_count;
+    if (write_index % TRACK_PAGES_PER_SECTOR != 0) {
+        uint32_t sector_end = (write_index / TRACK_PAGES_PER_SECTOR + 1) * TRACK_PAGES_PER_SECTOR;
+        for (uint32_t i = write_index; i < sector_end; i++) {
+            esp_partition_read(s_partition, (size_t)i * TRACK_PAGE_SIZE, &s_page, sizeof(s_page));
+            if (!track_page_is_blank(&s_page)) {
+                write_index = sector_end % s_info.page_count;
+                break;
+            }
+        }
+    }
+
+    s_info.write_index = write_index;
+    s_info.next_sequence = newest_sequence + 1;
+    ESP_LOGI(TAG, "Track recovered, newest page %lu (seq %lu), writing at %lu",
+             (unsigned long)newest_index, (unsigned long)newest_sequence, (unsigned long)write_index);
+}
+
+/**
+ * @brief Write the page being filled to flash and start a new one
+ *        将正在填充的页写入 Flash 并开始新页
+ *
+ * Pages are written in ring order and a sector is erased right before its first page is written,
+ * so every sector is erased once per lap of the ring.
+ * 页按环形顺序写入，扇区在写入其第一页之前擦除，因此每个扇区每轮只擦除一次。
+ */
+static void track_write_page(void) {
+    if (s_encoder.length == 0) {
+        return;
+    }
+
+    xSemaphoreTake(s_info_mutex, portMAX_DELAY);
+    uint32_t index = s_info.write_index;
+    uint32_t sequence = s_info.next_sequence;
+    xSemaphoreGive(s_info_mutex);
+
+    s_page.header.magic = TRACK_PAGE_MAGIC;
+    s_page.header.sequence = sequence;
+    s_page.header.length = (uint8_t)s_encoder.length;
+    s_page.header.version = TRACK_PAGE_VERSION;
+    memset(s_page.payload + s_encoder.length, 0xFF, TRACK_PAGE_PAYLOAD_SIZE - s_encoder.length);
+    s_page.crc = track_page_crc(&s_page);
+
+    esp_err_t ret = ESP_OK;
+    if (index % TRACK_PAGES_PER_SECTOR == 0) {
+        ret = esp_partition_erase_range(s_partition, (size_t)index * TRACK_PAGE_SIZE, TRACK_SECTOR_SIZE);
+    }
+    if (ret == ESP_OK) {
+        ret = esp_partition_write(s_partition, (size_t)index * TRACK_PAGE_SIZE, &s_page, sizeof(s_page));
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write track page %lu: %s", (unsigned long)index, esp_err_to_name(ret));
+    }
+
+    xSemaphoreTake(s_info_mutex, portMAX_DELAY);
+    s_info.write_index = (index + 1) % s_info.page_count;
+    s_info.next_sequence = sequence + 1;
+    xSemaphoreGive(s_info_mutex);
+
+    track_encoder_begin(&s_encoder, s_page.payload, TRACK_PAGE_PAYLOAD_SIZE);
+}
+
+/**
+ * @brief Track logger task
+ *        轨迹记录任务
+ *
+ * Runs at priority 0 like the GPS receiving and push tasks, so a sector erase only takes its time
+ * slices and never preempts them.
+ * 与 GPS 接收、推送任务同为优先级 0，扇区擦除只占用自身的时间片，不会抢占它们。
+ *
+ * @param arg 任务参数
+ *            Task parameters
+ */
+static void track_task(void *arg) {
+    track_message_t message;
+
+    while (1) {
+        if (xQueueReceive(s_track_queue, &message, pdMS_TO_TICKS(1000)) != pdTRUE) {
+            // 超时未写满的页也要写入
+            // Write a page that has been open for too long
+            if (s_encoder.length > 0 &&
+                esp_timer_get_time() - s_page_started_us > TRACK_PAGE_MAX_AGE_S * 1000000LL) {
+                track_write_page();
+            }
+            continue;
+        }
+
+        if (message.flush) {
+            track_write_page();
+            continue;
+        }
+
+        if (s_encoder.length == 0) {
+            s_page_started_us = esp_timer_get_time();
+        }
+        if (!track_encoder_add(&s_encoder, &message.point)) {
+            track_write_page();
+            s_page_started_us = esp_timer_get_time();
+            track_encoder_add(&s_encoder, &message.point);
+        }
+    }
+}
+
+/**
+ * @brief Queue a valid fix for logging, never blocks
+ *        将有效定位加入记录队列，不会阻塞
+ *
+ * @param gps Valid fix
+ *            有效定位
+ */
+void track_logic_log_fix(const GPS_Data_t *gps) {
+    if (s_track_queue == NULL) {
+        return;
+    }
+
+    track_message_t message = {
+        .flush = false,
+        .point = {
+            .time_ms = gps_data_to_unix_time_us(gps) / 1000,
+            .latitude = (int32_t)lround(gps->Latitude * TRACK_COORD_SCALE),
+            .longitude = (int32_t)lround(gps->Longitude * TRACK_COORD_SCALE),
+            .altitude = (int32_t)lround(gps->Altitude * 10),
+        },
+    };
+
+    if (xQueueSend(s_track_queue, &message, 0) != pdTRUE) {
+        s_info.dropped_points++;
+    }
+}
+
+/**
+ * @brief Ask the logger to write its partial page, e.g. before reading the track back
+ *        请求记录任务写入未满的页，例如在读取轨迹之前
+ */
+void track_logic_flush(void) {
+    if (s_track_queue == NULL) {
+        return;
+    }
+    track_message_t message = { .flush = true };
+    xQueueSend(s_track_queue, &message, pdMS_TO_TICKS(100));
+}
+
+/**
+ * @brief Get track store state
+ *        获取轨迹存储状态
+ *
+ * @param out Output state
+ *            输出的状态
+ */
+void track_logic_get_info(track_info_t *out) {
+    if (s_info_mutex == NULL) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    xSemaphoreTake(s_info_mutex, portMAX_DELAY);
+    *out = s_info;
+    xSemaphoreGive(s_info_mutex);
+}
+
+/**
+ * @brief Initialize the track logger
+ *        初始化轨迹记录
+ *
+ * @return int Returns 0 on success, -1 on failure
+ *             返回 0 表示成功，-1 表示失败
+ */
+int track_logic_init(void) {
+    s_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, TRACK_PARTITION_LABEL);
+    if (s_partition == NULL) {
+        ESP_LOGE(TAG, "Track partition \"%s\" not found", TRACK_PARTITION_LABEL);
+        return -1;
+    }
+
+    s_info_mutex = xSemaphoreCreateMutex();
+    s_track_queue = xQueueCreate(TRACK_QUEUE_LENGTH, sizeof(track_message_t));
+    if (s_info_mutex == NULL || s_track_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create track queue");
+        return -1;
+    }
+
+    s_info.page_count = s_partition->size / TRACK_PAGE_SIZE;
+    track_recover();
+    track_encoder_begin(&s_encoder, s_page.payload, TRACK_PAGE_PAYLOAD_SIZE);
+
+    if (xTaskCreate(track_task, "track_task", 1024 * 3, NULL, 0, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create track task");
+        return -1;
+    }
+
+    ESP_LOGI(TAG, "Track logger started, %lu pages", (unsigned long)s_info.page_count);
+    return 0;
+}
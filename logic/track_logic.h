@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __TRACK_LOGIC_H__
+#define __TRACK_LOGIC_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "gps_logic.h"
+#include "track_codec.h"
+
+/* Track partition layout: fixed size pages, each one independently decodable and CRC protected.
+ * Retention of the 768 KB partition: about 2 bytes per 10 Hz fix while moving, so the ring keeps the
+ * last ~11 h of continuous motion. Parked at 10 Hz the filtered position still jitters and costs about
+ * 0.5-0.6 bytes per fix, so a day at 10 Hz does not fit even when mostly parked (test/host/bench/bench_track.c). */
+/* 轨迹分区布局：固定大小的页，每页可独立解码并带 CRC 保护。
+ * 768 KB 分区的保存时长：运动时每个 10 Hz 定位约 2 字节，环形缓冲保留最近约 11 小时的连续运动。
+ * 10 Hz 下静止时滤波后位置仍有抖动，每个定位约 0.5-0.6 字节，因此即使大部分时间静止，10 Hz 下的一天也无法完整保存
+ * （test/host/bench/bench_track.c）。 */
+#define TRACK_PARTITION_LABEL   "track"
+#define TRACK_PAGE_SIZE         256
+#define TRACK_SECTOR_SIZE       4096
+#define TRACK_PAGE_MAGIC        0x4B54      // "TK"
+#define TRACK_PAGE_VERSION      1
+
+// A partially filled page is written anyway after this long, bounds what a power loss can lose (s)
+// 未写满的页超过该时长后也会写入，限制掉电时丢失的数据量 (秒)
+#define TRACK_PAGE_MAX_AGE_S    300
+
+/* Page header, followed by the payload and a CRC32 of header + payload */
+/* 页头，其后为数据和 页头+数据 的 CRC32 */
+typedef struct __attribute__((packed)) {
+    uint16_t magic;
+    uint32_t sequence;      // Increases by one for every written page
+                            // 每写入一页加一
+    uint8_t length;         // Payload bytes used
+                            // 已使用的数据字节数
+    uint8_t version;
+} track_page_header_t;
+
+#define TRACK_PAGE_PAYLOAD_SIZE (TRACK_PAGE_SIZE - sizeof(track_page_header_t) - sizeof(uint32_t))
+
+/* One page read back from flash */
+/* 从 Flash 读回的一页 */
+typedef struct __attribute__((packed)) {
+    track_page_header_t header;
+    uint8_t payload[TRACK_PAGE_PAYLOAD_SIZE];
+    uint32_t crc;
+} track_page_t;
+
+/* Track store state */
+/* 轨迹存储状态 */
+typedef struct {
+    uint32_t page_count;        // Pages in the partition
+                                // 分区中的页数
+    uint32_t write_index;       // Next page to be written, pages after it are the oldest
+                                // 下一个要写入的页，其后的页为最旧的数据
+    uint32_t next_sequence;     // Sequence number of the next page
+                                // 下一页的序号
+    uint32_t dropped_points;    // Points lost because the queue was full
+                                // 因队列满而丢失的点数
+} track_info_t;
+
+int track_logic_init(void);
+
+void track_logic_log_fix(const GPS_Data_t *gps);
+
+void track_logic_flush(void);
+
+void track_logic_get_info(track_info_t *out);
+
+bool track_logic_read_page(uint32_t index, track_page_t *out);
+
+#endif
@@ -20,11 +20,21 @@
  */
 
 #include "freertos/FreeRTOS.h"
+#include "nvs_flash.h"
 
 #include "connect_logic.h"
+#include "console_logic.h"
+#include "export_logic.h"
+#include "action_logic.h"
+#include "geofence_logic.h"
+#include "rule_logic.h"
+#include "schedule_logic.h"
 #include "gps_logic.h"
+#include "gps_rate_logic.h"
 #include "key_logic.h"
 #include "light_logic.h"
+#include "time_zone_logic.h"
+#include "track_logic.h"
 
 /**
  * @brief Main application function, performs initialization and task loop
@@ -40,6 +50,15 @@ void app_main(void) {
 
     int res = 0;
 
+    /* Initialize NVS, used by GPS aiding and Bluetooth */
+    /* 初始化 NVS，供 GPS 辅助数据和蓝牙使用 */
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(ret);
+
     /* Initialize RGB light */
     /* 初始化氛围灯 */
     res = init_light_logic();
@@ -47,11 +66,45 @@ void app_main(void) {
         return;
     }
 
+    /* Load the camera time zone, needed before GPS data is pushed */
+    /* 读取相机时区，推送 GPS 数据之前需要 */
+    time_zone_logic_init();
+
+    /* Camera actions for automations, then the geofences and rules that trigger them (optional) */
+    /* 自动化使用的相机动作，以及触发它们的地理围栏和规则（可选） */
+    res = action_logic_init();
+    if (res != 0) {
+        return;
+    }
+    geofence_logic_init();
+    rule_logic_init();
+
     /* Initialize GPS module */
     /* 初始化 GPS 模块 */
     initSendGpsDataToCameraTask();
 
-    vTaskDelay(pdMS_TO_TICKS(2000));
+    /* Start the flash track log, the device keeps working without it */
+    /* 启动 Flash 轨迹记录，即使失败设备也能继续工作 */
+    track_logic_init();
+
+    /* Serve track export requests on the console */
+    /* 在控制台上响应轨迹导出请求 */
+    export_logic_init();
+
+    /* Send record commands at absolute GPS times (AT command) */
+    /* 在指定的 GPS 绝对时刻发送录制命令（AT 命令） */
+    schedule_logic_init();
+
+    /* Start the console once all commands are registered */
+    /* 所有命令注册完成后启动控制台 */
+    console_logic_init();
+
+    /* Adapt GPS rate to camera state */
+    /* 根据相机状态调节 GPS 频率 */
+    res = gps_rate_logic_init();
+    if (res != 0) {
+        return;
+    }
 
     /* Initialize Bluetooth */
     /* 初始化蓝牙 */
@@ -66,7 +119,7 @@ void app_main(void) {
 
     /* Switch camera to normal video mode */
     /* 切换相机至普通视频模式 */
-    // camera_mode_switch_response_frame_t *switch_response = command_logic_switch_camera_mode(CAMERA_MODE_NORMAL);
+    // camera_mode_switch_response_frame_t *switch_response = command_logic_switch_camera_mode(0, CAMERA_MODE_NORMAL);
     // if (switch_response != NULL) {
     //     free(switch_response);
     // }
@@ -68,10 +68,10 @@ typedef struct __attribute__((packed)) {
 } record_control_response_frame_t;
 
 typedef struct __attribute__((packed)) {
-    int32_t year_month_day;        // Date (year*10000 + month*100 + day)
-                                   // 年月日 (year*10000 + month*100 + day)
-    int32_t hour_minute_second;    // Time ((hour+8)*10000 + minute*100 + second)
-                                   // 时分秒 ((hour+8)*10000 + minute*100 + second)
+    int32_t year_month_day;        // Local date (year*10000 + month*100 + day)
+                                   // 本地年月日 (year*10000 + month*100 + day)
+    int32_t hour_minute_second;    // Local time (hour*10000 + minute*100 + second)
+                                   // 本地时分秒 (hour*10000 + minute*100 + second)
     int32_t gps_longitude;         // Longitude (value = actual value * 10^7)
                                    // 经度 (value = 实际值 * 10^7)
     int32_t gps_latitude;          // Latitude (value = actual value * 10^7)
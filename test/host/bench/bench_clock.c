@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * PPS discipline on a simulated clock: 2 h of edges with the local clock 25 ppm fast and its
+ * frequency wandering (random walk, 0.005 ppm per second), edges timestamped 2-6 us late by the ISR,
+ * and 1% of the edges labelled with the wrong UTC second. Then the PPS is lost for 60 s. Reports the
+ * UTC conversion error at random instants, how well the drift is tracked, the bad edges gated and
+ * the holdover error. The ISR latency itself is a bias no fit can see; it stays in the errors below.
+ *
+ * 模拟时钟上的 PPS 校准：2 小时的边沿，本地时钟快 25 ppm 且频率漂移（随机游走，每秒 0.005 ppm），ISR 记录的边沿
+ * 时间晚 2-6 微秒，1% 的边沿被标记为错误的 UTC 秒。之后 PPS 丢失 60 秒。输出随机时刻的 UTC 转换误差、漂移跟踪
+ * 精度、被门限拒绝的坏边沿数以及保持期误差。ISR 延迟本身是拟合无法察觉的偏差，计入以下误差。
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+#include "test_common.h"
+#include "clock_discipline.h"
+
+#define EDGES               7200
+#define HOLDOVER_S          60
+#define PPM_FAST            25.0
+#define WANDER_PPM_PER_S    0.005
+#define ISR_LATENCY_MIN_US  2.0
+#define ISR_LATENCY_MAX_US  6.0
+#define BAD_EDGE_PERCENT    1
+#define UTC_START_US        1751328000000000LL
+#define LOCAL_START_US      12345678LL
+
+static uint64_t s_rng = 1;
+
+static double uniform(void) {
+    s_rng = s_rng * 6364136223846793005ULL + 1442695040888963407ULL;
+    return ((s_rng >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static double gauss(void) {
+    return sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform());
+}
+
+/* True local clock: local time of every UTC second, frequency wandering */
+/* 真实本地时钟：每个 UTC 整秒对应的本地时间，频率随机漂移 */
+static double s_edge_local_us[EDGES + HOLDOVER_S + 1];
+static double s_ppm[EDGES + HOLDOVER_S + 1];
+
+// Local time at UTC second n plus a fraction, interpolated inside the second
+// UTC 第 n 秒加小数部分对应的本地时间，在该秒内插值
+static double local_at(int n, double fraction) {
+    return s_edge_local_us[n] + fraction * (s_edge_local_us[n + 1] - s_edge_local_us[n]);
+}
+
+static double abs_error_us(const clock_discipline_t *cd, int n, double fraction) {
+    int64_t utc;
+    if (!clock_discipline_to_utc(cd, (int64_t)llround(local_at(n, fraction)), &utc)) {
+        return -1;
+    }
+    return fabs((double)(utc - UTC_START_US) - (n + fraction) * 1e6);
+}
+
+int main(void) {
+    double ppm = PPM_FAST;
+    s_edge_local_us[0] = LOCAL_START_US;
+    for (int n = 0; n < EDGES + HOLDOVER_S; n++) {
+        s_ppm[n] = ppm;
+        s_edge_local_us[n + 1] = s_edge_local_us[n] + 1e6 * (1.0 + ppm * 1e-6);
+        ppm += WANDER_PPM_PER_S * gauss();
+    }
+
+    clock_discipline_t cd;
+    clock_discipline_init(&cd);
+    int bad_edges = 0, bad_gated = 0, conversions = 0, lost_lock = 0;
+    double error_sum = 0, error_max = 0, drift_error_max = 0;
+
+    for (int n = 0; n < EDGES; n++) {
+        int64_t local = (int64_t)llround(s_edge_local_us[n] +
+                                         ISR_LATENCY_MIN_US + (ISR_LATENCY_MAX_US - ISR_LATENCY_MIN_US) * uniform());
+        int64_t utc = UTC_START_US + n * 1000000LL;
+        bool bad = n > CLOCK_DISCIPLINE_WINDOW && uniform() * 100 < BAD_EDGE_PERCENT;
+        if (bad) {
+            utc += (uniform() < 0.5) ? -1000000 : 1000000;
+            bad_edges++;
+        }
+        clock_discipline_result_t result = clock_discipline_add(&cd, local, utc);
+        bad_gated += bad && result == CLOCK_DISCIPLINE_REJECTED;
+
+        // Conversions at a random instant before the next edge, once the fit has a full window
+        // 拟合窗口填满后，在下一个边沿之前的随机时刻做转换
+        if (n < CLOCK_DISCIPLINE_WINDOW) {
+            continue;
+        }
+        double error = abs_error_us(&cd, n, uniform());
+        if (error < 0) {
+            lost_lock++;
+            continue;
+        }
+        error_sum += error;
+        error_max = error > error_max ? error : error_max;
+        conversions++;
+        // drift is UTC rate relative to local minus one, about -ppm
+        // drift 为 UTC 相对本地时钟的速率减一，约为 -ppm
+        double drift_error = fabs(cd.drift * 1e6 + s_ppm[n]);
+        drift_error_max = drift_error > drift_error_max ? drift_error : drift_error_max;
+    }
+
+    // PPS lost: conversions keep working on the last fit until the holdover runs out
+    // PPS 丢失：转换沿用最后一次拟合，直到保持期结束
+    double holdover_max = 0;
+    for (int s = 1; s < HOLDOVER_S; s++) {
+        double error = abs_error_us(&cd, EDGES - 1 + s, 0.0);
+        TEST_CHECK(error >= 0);
+        holdover_max = error > holdover_max ? error : holdover_max;
+    }
+    bool expired = abs_error_us(&cd, EDGES - 1 + HOLDOVER_S, 0.5) < 0;
+
+    printf("clock discipline: %d edges, %.0f ppm fast, wander %.3f ppm/s, ISR latency %.0f-%.0f us, %d%% bad edges\n",
+           EDGES, PPM_FAST, WANDER_PPM_PER_S, ISR_LATENCY_MIN_US, ISR_LATENCY_MAX_US, BAD_EDGE_PERCENT);
+    printf("  UTC error       %.1f us mean, %.1f us max over %d conversions\n", error_sum / conversions, error_max,
+           conversions);
+    printf("  drift error     %.2f ppm max\n", drift_error_max);
+    printf("  bad edges       %d of %d gated, %lu resets\n", bad_gated, bad_edges, (unsigned long)cd.reset_count);
+    printf("  holdover        %.1f us max over %d s, %s after\n", holdover_max, HOLDOVER_S,
+           expired ? "expired" : "still valid");
+
+    TEST_CHECK(lost_lock == 0);
+    TEST_CHECK(bad_gated == bad_edges);
+    TEST_CHECK(error_max < 50);
+    TEST_CHECK(expired);
+    return TEST_EXIT_CODE();
+}
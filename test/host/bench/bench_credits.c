@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * TX credits on the loopback: one link, 66-byte GPS frames written without response for 2 s per run.
+ * A paced sender waits for data_wait_tx_ready() and must never be refused, an unpaced one sees the
+ * refusals. Every accepted frame must reach the camera.
+ *
+ * 回环上的发送额度：单条链路，每次运行 2 秒，以无应答写入发送 66 字节的 GPS 帧。有节奏的发送方等待
+ * data_wait_tx_ready()，不应被拒绝；无节奏的发送方会看到拒绝。每个被接受的帧都必须到达相机。
+ */
+
+#include <stdlib.h>
+
+#include "test_common.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#include "loopback_common.h"
+#include "ble_loopback.h"
+#include "data.h"
+#include "dji_protocol_parser.h"
+#include "dji_protocol_data_structures.h"
+#include "enums_logic.h"
+
+int main(void) {
+    static const struct {
+        const char *name;
+        bool set_profile;
+        bool paced;
+    } runs[] = {
+        {"default", false, true},
+        {"low-latency", true, true},
+        {"low-latency", true, false},
+    };
+    gps_data_push_command_frame gps = {0};
+    size_t length = 0;
+
+    if (loopback_init() != 0) {
+        return 1;
+    }
+    uint8_t *frame = protocol_create_frame(0x00, 0x17, CMD_NO_RESPONSE, &gps, 0x200, &length);
+
+    fprintf(stderr, "credits: one link, %u-byte GPS frames, 2 s per run\n", (unsigned)length);
+    fprintf(stderr, "  %-12s %-6s %9s %8s %5s %9s\n", "profile", "sender", "frames/s", "refused", "lost", "received");
+    for (int i = 0; i < 3; i++) {
+        if (!loopback_open_raw_link(0, runs[i].set_profile, BLE_LINK_PROFILE_LOW_LATENCY)) {
+            free(frame);
+            return 1;
+        }
+        data_link_activity_t activity_before, activity_after;
+        ble_loopback_stats_t stats_before, stats_after;
+        data_get_link_activity(0, &activity_before);
+        ble_loopback_get_stats(&stats_before);
+        uint32_t received_before = g_peer_frames[0];
+
+        int sent = 0;
+        int64_t start = esp_timer_get_time();
+        while (esp_timer_get_time() - start < 2000000) {
+            if (runs[i].paced) {
+                data_wait_tx_ready(0, 100);
+            }
+            if (data_write_without_response(0, 0x200, frame, length) == ESP_OK) {
+                sent++;
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(300));
+
+        data_get_link_activity(0, &activity_after);
+        ble_loopback_get_stats(&stats_after);
+        uint32_t refused = activity_after.refused - activity_before.refused;
+        uint32_t received = g_peer_frames[0] - received_before;
+        fprintf(stderr, "  %-12s %-6s %9d %8u %5u %4s %4u\n", runs[i].name, runs[i].paced ? "paced" : "blast", sent / 2,
+                (unsigned)refused, (unsigned)(stats_after.dropped - stats_before.dropped),
+                received == (uint32_t)sent ? "all" : "of", (unsigned)received);
+        TEST_CHECK(received == (uint32_t)sent);
+        TEST_CHECK(runs[i].paced ? refused == 0 : refused > 0);
+        loopback_close_raw_link(0);
+    }
+
+    free(frame);
+    return TEST_EXIT_CODE();
+}
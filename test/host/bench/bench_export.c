@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Track export on the host shim: export_logic.c streams 200k synthetic points (5.5 h at 10 Hz) out of
+ * a mocked track store to a mocked console whose host ACKs every chunk at once. Reports the
+ * transcoding cost and output size per point for each format, the time the output needs on the
+ * 115200 baud console, and the longest CPU stretch between two console calls, which bounds how long
+ * the export can keep a task of the same priority waiting on the single core of the board (host CPU
+ * times, not scaled to the board). Also checks that logging is held back during the export without
+ * losing the per-tag log levels.
+ *
+ * 在主机适配层上导出轨迹：export_logic.c 从模拟的轨迹存储中读取 20 万个合成点（10 Hz 下 5.5 小时），输出到模拟的
+ * 控制台，主机端立即确认每个数据块。输出各格式每个点的转码耗时与输出大小、在 115200 波特率控制台上的传输时间，
+ * 以及两次控制台调用之间的最长 CPU 连续占用时间，即导出在板上单核中最多让同优先级任务等待多久（主机 CPU 时间，
+ * 未换算到板上）。同时检查导出期间日志被拦下且各标签的日志级别不丢失。
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "test_common.h"
+#include "export_logic.h"
+#include "console_logic.h"
+#include "track_logic.h"
+
+#define POINTS              200000
+#define CONSOLE_BAUD_RATE   115200
+#define OTHER_TAG           "OTHER_TAG"
+
+// CPU time of the calling thread, so neither the logger task nor the host scheduler count
+// 调用线程的 CPU 时间，日志任务与主机调度均不计入
+static int64_t now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/* Mocked track store: the synthetic drive encoded into pages like track_task() does */
+/* 模拟的轨迹存储：与 track_task() 一样将合成轨迹编码为页 */
+
+static track_page_t s_pages[3072];
+static uint32_t s_page_count;
+
+static void build_track_store(void) {
+    track_encoder_t enc;
+    track_point_t point = { .time_ms = 1741938420000LL, .latitude = 22543321, .longitude = 113951234, .altitude = 350 };
+    uint32_t rng = 7;
+
+    track_encoder_begin(&enc, s_pages[0].payload, TRACK_PAGE_PAYLOAD_SIZE);
+    for (int i = 0; i < POINTS; i++) {
+        rng = rng * 1103515245u + 12345u;
+        point.time_ms += 100;
+        point.latitude += 9 + (int32_t)(rng >> 30) - 1;
+        point.longitude += 11 + (int32_t)((rng >> 28) & 3) - 1;
+        point.altitude += (int32_t)((rng >> 8) & 3) - 1;
+        if (!track_encoder_add(&enc, &point)) {
+            s_pages[s_page_count].header.length = (uint8_t)enc.length;
+            s_pages[s_page_count].header.sequence = s_page_count + 1;
+            s_page_count++;
+            track_encoder_begin(&enc, s_pages[s_page_count].payload, TRACK_PAGE_PAYLOAD_SIZE);
+            track_encoder_add(&enc, &point);
+        }
+    }
+    s_pages[s_page_count].header.length = (uint8_t)enc.length;
+    s_pages[s_page_count].header.sequence = s_page_count + 1;
+    s_page_count++;
+}
+
+void track_logic_flush(void) {
+}
+
+void track_logic_get_info(track_info_t *out) {
+    *out = (track_info_t) {
+        .page_count = sizeof(s_pages) / sizeof(s_pages[0]),
+        .write_index = s_page_count,
+        .next_sequence = s_page_count + 1,
+    };
+}
+
+bool track_logic_read_page(uint32_t index, track_page_t *out) {
+    if (index >= s_page_count) {
+        return false;
+    }
+    *out = s_pages[index];
+    return true;
+}
+
+/* Mocked console, the host side ACKs every chunk at once */
+/* 模拟的控制台，主机端立即确认每个数据块 */
+
+static console_command_handler_t s_export_handler;
+static unsigned long s_last_chunk;
+static uint64_t s_bytes_written;
+static uint32_t s_lines_written;
+static char s_last_reply[48];
+static int64_t s_last_call_ns;
+static int64_t s_longest_stretch_ns;
+
+static void console_call(void) {
+    int64_t now = now_ns();
+    if (s_last_call_ns != 0 && now - s_last_call_ns > s_longest_stretch_ns) {
+        s_longest_stretch_ns = now - s_last_call_ns;
+    }
+    s_last_call_ns = now;
+}
+
+int console_register_command(const char *keyword, console_command_handler_t handler) {
+    if (strcmp(keyword, "EXPORT") == 0) {
+        s_export_handler = handler;
+    }
+    return 0;
+}
+
+const char *console_read_line(uint32_t timeout_ms) {
+    static char line[CONSOLE_LINE_SIZE];
+    console_call();
+    snprintf(line, sizeof(line), "ACK %lu", s_last_chunk);
+    return line;
+}
+
+void console_write(const void *data, size_t length) {
+    console_call();
+    if (length > 7 && memcmp(data, "#CHUNK ", 7) == 0) {
+        s_last_chunk = strtoul((const char *)data + 7, NULL, 10);
+    } else if (length > 0 && ((const char *)data)[0] == '#') {
+        snprintf(s_last_reply, sizeof(s_last_reply), "%.*s", (int)length, (const char *)data);
+    } else {
+        s_bytes_written += length;
+        for (size_t i = 0; i < length; i++) {
+            s_lines_written += ((const char *)data)[i] == '\n';
+        }
+    }
+}
+
+void console_printf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+/* A task logging all the time, its lines must not get out during an export */
+/* 持续输出日志的任务，导出期间其日志不得输出 */
+
+static volatile bool s_logging = true;
+static volatile uint32_t s_log_lines_during_export;
+
+static int count_log_line(const char *format, va_list args) {
+    if (export_logic_is_busy()) {
+        s_log_lines_during_export++;
+    }
+    return 0;
+}
+
+static void *logger_task(void *arg) {
+    while (s_logging) {
+        ESP_LOGE(OTHER_TAG, "still running");
+        vTaskDelay(1);
+    }
+    return NULL;
+}
+
+static void run_export(const char *command, const char *name) {
+    s_bytes_written = 0;
+    s_lines_written = 0;
+    s_last_call_ns = 0;
+    s_longest_stretch_ns = 0;
+
+    int64_t start_ns = now_ns();
+    s_export_handler(command);
+    double cpu_us = (now_ns() - start_ns) / 1000.0;
+
+    uint32_t units = strtoul(s_last_reply + 5, NULL, 10);
+    double bytes_per_point = (double)s_bytes_written / POINTS;
+    printf("  %s  %6.2f us/pt  %6.1f B/pt  %6.1f min at %d baud  longest stretch %.0f us\n", name,
+           cpu_us / POINTS, bytes_per_point, s_bytes_written * 10.0 / CONSOLE_BAUD_RATE / 60, CONSOLE_BAUD_RATE,
+           s_longest_stretch_ns / 1000.0);
+
+    // Every point (every page for RAW) reached the host
+    // 所有点（RAW 为所有页）都送达主机
+    TEST_CHECK(strncmp(s_last_reply, "#END ", 5) == 0);
+    TEST_CHECK(units == (strcmp(name, "RAW") == 0 ? s_page_count : POINTS));
+}
+
+int main(void) {
+    build_track_store();
+    export_logic_init();
+
+    esp_log_level_set(OTHER_TAG, ESP_LOG_DEBUG);
+    esp_log_set_vprintf(count_log_line);
+    pthread_t logger;
+    pthread_create(&logger, NULL, logger_task, NULL);
+
+    printf("export: %d points in %lu pages, chunks of %d bytes\n", POINTS, (unsigned long)s_page_count,
+           EXPORT_CHUNK_SIZE);
+    run_export("EXPORT CSV", "CSV");
+    TEST_CHECK(s_lines_written == POINTS + 1);
+    run_export("EXPORT GPX", "GPX");
+    run_export("EXPORT RAW", "RAW");
+    TEST_CHECK(s_bytes_written == s_page_count * sizeof(track_page_t));
+
+    s_logging = false;
+    pthread_join(logger, NULL);
+
+    // Log output was held back, and the levels set per tag are still there
+    // 日志输出被拦下，且按标签设置的级别仍然存在
+    TEST_CHECK(s_log_lines_during_export == 0);
+    TEST_CHECK(esp_log_level_get(OTHER_TAG) == ESP_LOG_DEBUG);
+    return TEST_EXIT_CODE();
+}
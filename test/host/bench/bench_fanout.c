@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * GPS push fan-out to several cameras on the loopback: the CPU cost per fix of encoding the frame once
+ * against once per camera (protocol_create_frame plus a copy per link standing in for the write), then
+ * command_logic_push_gps_data() to four cameras connected through connect_logic, every camera must
+ * receive every fix.
+ *
+ * 回环上向多台相机扇出 GPS 推送：每次定位只编码一次与每台相机各编码一次的 CPU 开销（protocol_create_frame
+ * 加上每条链路一次代替写入的拷贝），然后通过 command_logic_push_gps_data() 推送到经 connect_logic 连接的
+ * 四台相机，每台相机都必须收到每一次定位。
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "test_common.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "loopback_common.h"
+#include "connect_logic.h"
+#include "command_logic.h"
+#include "dji_protocol_parser.h"
+#include "dji_protocol_data_structures.h"
+
+#define FIXES   200000
+#define PUSHES  50
+
+static int64_t now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+int main(void) {
+    gps_data_push_command_frame gps = {.gps_latitude = 225431000, .gps_longitude = 1139510000, .satellite_number = 12};
+    static uint8_t link_buffers[BLE_MAX_LINKS][128];
+    double per_link_ns[BLE_MAX_LINKS], once_ns[BLE_MAX_LINKS];
+
+    if (loopback_init() != 0) {
+        return 1;
+    }
+
+    fprintf(stderr, "fanout: CPU cost per fix over %d fixes\n", FIXES);
+    fprintf(stderr, "  %-8s %16s %14s\n", "cameras", "encode per link", "encode once");
+    for (int cameras = 1; cameras <= BLE_MAX_LINKS; cameras++) {
+        size_t length = 0;
+        int64_t start = now_ns();
+        for (int i = 0; i < FIXES; i++) {
+            for (int link = 0; link < cameras; link++) {
+                uint8_t *frame = protocol_create_frame(0x00, 0x17, CMD_NO_RESPONSE, &gps, (uint16_t)i, &length);
+                memcpy(link_buffers[link], frame, length);
+                free(frame);
+            }
+        }
+        per_link_ns[cameras - 1] = (double)(now_ns() - start) / FIXES;
+
+        start = now_ns();
+        for (int i = 0; i < FIXES; i++) {
+            uint8_t *frame = protocol_create_frame(0x00, 0x17, CMD_NO_RESPONSE, &gps, (uint16_t)i, &length);
+            for (int link = 0; link < cameras; link++) {
+                memcpy(link_buffers[link], frame, length);
+            }
+            free(frame);
+        }
+        once_ns[cameras - 1] = (double)(now_ns() - start) / FIXES;
+        fprintf(stderr, "  %-8d %13.0f ns %11.0f ns\n", cameras, per_link_ns[cameras - 1], once_ns[cameras - 1]);
+    }
+    TEST_CHECK(once_ns[BLE_MAX_LINKS - 1] < per_link_ns[BLE_MAX_LINKS - 1]);
+
+    // Every connected camera gets every fix through command_logic_push_gps_data()
+    // 每台已连接的相机都通过 command_logic_push_gps_data() 收到每一次定位
+    int connected = 0;
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        uint8_t mode;
+        double ms;
+        connected += loopback_connect_camera(link, false, &mode, &ms) == 0;
+    }
+    TEST_CHECK(connected == BLE_MAX_LINKS);
+    TEST_CHECK(connect_logic_get_protocol_links() == (1u << BLE_MAX_LINKS) - 1);
+
+    uint32_t gps_before[BLE_MAX_LINKS];
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        gps_before[link] = g_peer_gps_frames[link];
+    }
+    int written = 0;
+    for (int i = 0; i < PUSHES; i++) {
+        written += command_logic_push_gps_data(&gps);
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+    vTaskDelay(pdMS_TO_TICKS(200));
+
+    fprintf(stderr, "  %d pushes to %d cameras, %d writes, received:", PUSHES, connected, written);
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        uint32_t received = g_peer_gps_frames[link] - gps_before[link];
+        fprintf(stderr, " %u", (unsigned)received);
+        TEST_CHECK(received == PUSHES);
+    }
+    fprintf(stderr, "\n");
+    TEST_CHECK(written == PUSHES * BLE_MAX_LINKS);
+
+    for (int link = 0; link < BLE_MAX_LINKS; link++) {
+        loopback_disconnect_camera(link);
+    }
+    return TEST_EXIT_CODE();
+}
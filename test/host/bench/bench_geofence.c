@@ -0,0 +1,324 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Geofence index on 1000 fences from bench/make_geofence_bench.py, built by tools/geofence_builder.py
+ * with 100, 200 and 400 m cells plus a pileup image where every fence shares one centre. For each
+ * grid: a 10 h drive at 10 Hz over the fenced area (cost per fix and fences tested per fix), the
+ * fullest cell, and a check of every fence against a double precision reference at random points,
+ * including that no fence which contains a point is missing from the point's cell. Host CPU times.
+ *
+ * 使用 bench/make_geofence_bench.py 生成的 1000 个围栏，由 tools/geofence_builder.py 以 100、200、400 米单元构建，
+ * 另有所有围栏共用一个中心的堆叠镜像。对每种网格：在围栏区域内以 10 Hz 行驶 10 小时（每个定位的开销与测试的
+ * 围栏数）、最满的单元，以及在随机点上将每个围栏与双精度参考实现对比，并检查包含该点的围栏都登记在该点所在单元中。
+ * 主机 CPU 时间。
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "test_common.h"
+#include "geofence_index.h"
+
+#define FIXES               360000      // 10 h at 10 Hz
+                                        // 10 Hz 下 10 小时
+#define INTERVAL_S          0.1
+#define SPEED_M_S           15.0
+#define REFERENCE_POINTS    5000
+#define IMAGE_WORDS         (0x30000 / 4)   // Size of the "geofence" partition
+                                            // "geofence" 分区的大小
+// Disagreements closer than this to a threshold are rounding, not errors (latitude units, ~3 cm)
+// 与门限相差小于该值的不一致属于舍入误差，而非错误（纬度单位，约 3 厘米）
+#define TOLERANCE           3.0
+
+static uint32_t s_image[IMAGE_WORDS];
+static volatile uint32_t s_sink;
+
+static uint64_t s_rng = 1;
+
+static double uniform(void) {
+    s_rng = s_rng * 6364136223846793005ULL + 1442695040888963407ULL;
+    return ((s_rng >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static int64_t now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static bool load_image(const char *path, geofence_index_t *index) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    size_t size = fread(s_image, 1, sizeof(s_image), file);
+    fclose(file);
+    return geofence_index_open(index, s_image, size) == 0;
+}
+
+/* Double precision reference, with its own bounding boxes rather than the builder's */
+/* 双精度参考实现，使用自行计算而非生成工具给出的包围盒 */
+
+static struct {
+    double cos_lat;
+    double min_lat, min_lon, max_lat, max_lon;
+} s_reference[1000];
+
+static void reference_prepare(const geofence_index_t *index) {
+    for (uint16_t id = 0; id < index->header->fence_count; id++) {
+        const geofence_record_t *fence = &index->fences[id];
+        double cos_lat = cos(fence->lat * 1e-7 * M_PI / 180.0);
+        double reach = fence->hysteresis + 2.0;
+        double min_lat = fence->lat, max_lat = fence->lat, min_lon = fence->lon, max_lon = fence->lon;
+        if (fence->shape == GEOFENCE_SHAPE_CIRCLE) {
+            reach += fence->radius;
+        }
+        for (uint16_t i = 0; fence->shape == GEOFENCE_SHAPE_POLYGON && i < fence->vertex_count; i++) {
+            const geofence_vertex_t *vertex = &index->vertices[fence->first_vertex + i];
+            min_lat = fmin(min_lat, vertex->lat);
+            max_lat = fmax(max_lat, vertex->lat);
+            min_lon = fmin(min_lon, vertex->lon);
+            max_lon = fmax(max_lon, vertex->lon);
+        }
+        s_reference[id].cos_lat = cos_lat;
+        s_reference[id].min_lat = min_lat - reach;
+        s_reference[id].max_lat = max_lat + reach;
+        s_reference[id].min_lon = min_lon - reach / cos_lat;
+        s_reference[id].max_lon = max_lon + reach / cos_lat;
+    }
+}
+
+// Point relative to the fence reference in latitude units, longitude scaled by the exact cosine
+// 相对围栏参考点的坐标（纬度单位），经度按精确余弦缩放
+static void reference_xy(const geofence_record_t *fence, double cos_lat, double lat, double lon, double *x, double *y) {
+    *x = (lon - fence->lon) * cos_lat;
+    *y = lat - fence->lat;
+}
+
+static double segment_distance(double px, double py, double ax, double ay, double bx, double by) {
+    double ex = bx - ax, ey = by - ay;
+    double t = ((px - ax) * ex + (py - ay) * ey) / (ex * ex + ey * ey);
+    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+    return hypot(px - ax - t * ex, py - ay - t * ey);
+}
+
+/**
+ * @brief Reference position, and how far the point is from the nearest decision threshold
+ *        参考位置，以及该点与最近判定门限的距离
+ */
+static geofence_position_t reference_test(const geofence_index_t *index, uint16_t id, int32_t lat, int32_t lon,
+                                          double *margin) {
+    const geofence_record_t *fence = &index->fences[id];
+    double cos_lat = s_reference[id].cos_lat;
+    if (lat < s_reference[id].min_lat || lat > s_reference[id].max_lat ||
+        lon < s_reference[id].min_lon || lon > s_reference[id].max_lon) {
+        *margin = INFINITY;
+        return GEOFENCE_OUTSIDE;
+    }
+    double px, py;
+    reference_xy(fence, cos_lat, lat, lon, &px, &py);
+    double h = fence->hysteresis;
+
+    if (fence->shape == GEOFENCE_SHAPE_CIRCLE) {
+        double distance = hypot(px, py);
+        double inner = fence->radius > fence->hysteresis ? (double)fence->radius - h : 0;
+        double outer = (double)fence->radius + h;
+        *margin = fmin(fabs(distance - inner), fabs(distance - outer));
+        return distance < inner ? GEOFENCE_INSIDE : (distance > outer ? GEOFENCE_OUTSIDE : GEOFENCE_BORDER);
+    }
+
+    const geofence_vertex_t *vertex = &index->vertices[fence->first_vertex];
+    bool inside = false;
+    double nearest = INFINITY;
+    double ax, ay;
+    reference_xy(fence, cos_lat, vertex[fence->vertex_count - 1].lat, vertex[fence->vertex_count - 1].lon, &ax, &ay);
+    for (uint16_t i = 0; i < fence->vertex_count; i++) {
+        double bx, by;
+        reference_xy(fence, cos_lat, vertex[i].lat, vertex[i].lon, &bx, &by);
+        if ((ay > py) != (by > py) && px < ax + (py - ay) * (bx - ax) / (by - ay)) {
+            inside = !inside;
+        }
+        nearest = fmin(nearest, segment_distance(px, py, ax, ay, bx, by));
+        ax = bx;
+        ay = by;
+    }
+    *margin = fmin(fabs(nearest - h), nearest);
+    if (h > 0 && nearest <= h) {
+        return GEOFENCE_BORDER;
+    }
+    return inside ? GEOFENCE_INSIDE : GEOFENCE_OUTSIDE;
+}
+
+static bool is_candidate(const uint16_t *ids, size_t count, uint16_t id) {
+    for (size_t i = 0; i < count; i++) {
+        if (ids[i] == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* One grid */
+/* 一种网格 */
+
+typedef struct {
+    double ns_per_fix;
+    double tests_per_fix;
+    uint32_t fullest_cell;
+    double fullest_cell_us;
+    uint32_t checks;
+    uint32_t mismatches;
+    uint32_t rounding;          // Disagreements within TOLERANCE of a threshold
+                                // 与门限相差在 TOLERANCE 以内的不一致
+    uint32_t missing;
+} grid_result_t;
+
+static grid_result_t run_grid(const geofence_index_t *index) {
+    const geofence_header_t *header = index->header;
+    grid_result_t result = {0};
+    int32_t top_lat = header->origin_lat + header->rows * header->cell_lat;
+    int32_t top_lon = header->origin_lon + header->cols * header->cell_lon;
+    double lon_per_lat = (double)header->cell_lon / header->cell_lat;
+    const double units_per_m = 1e7 / (6378137.0 * M_PI / 180.0);
+
+    // The drive: heading turning slowly, turned back at the edge of the grid
+    // 行驶：航向缓慢变化，在网格边缘折返
+    static int32_t lats[FIXES], lons[FIXES];
+    double lat = ((double)header->origin_lat + top_lat) / 2, lon = ((double)header->origin_lon + top_lon) / 2;
+    double heading = 0;
+    for (int i = 0; i < FIXES; i++) {
+        heading += 0.02 * (uniform() - 0.5);
+        double step = SPEED_M_S * INTERVAL_S * units_per_m;
+        double next_lat = lat + step * cos(heading), next_lon = lon + step * sin(heading) * lon_per_lat;
+        if (next_lat < header->origin_lat || next_lat >= top_lat || next_lon < header->origin_lon || next_lon >= top_lon) {
+            heading += M_PI;
+            next_lat = lat;
+            next_lon = lon;
+        }
+        lat = next_lat;
+        lon = next_lon;
+        lats[i] = (int32_t)lat;
+        lons[i] = (int32_t)lon;
+    }
+
+    // geofence_logic_check() does this per fix: the candidates of the cell, each tested
+    // geofence_logic_check() 对每个定位执行的操作：取单元的候选围栏并逐一测试
+    uint64_t tests = 0;
+    uint32_t inside = 0;
+    int64_t start_ns = now_ns();
+    for (int i = 0; i < FIXES; i++) {
+        const uint16_t *ids;
+        size_t count = geofence_index_candidates(index, lats[i], lons[i], &ids);
+        for (size_t c = 0; c < count; c++) {
+            inside += geofence_index_test(index, ids[c], lats[i], lons[i]) == GEOFENCE_INSIDE;
+        }
+        tests += count;
+    }
+    result.ns_per_fix = (double)(now_ns() - start_ns) / FIXES;
+    result.tests_per_fix = (double)tests / FIXES;
+
+    // The fullest cell, fixes spread over it
+    // 最满的单元，定位均匀分布于其中
+    size_t fullest = 0;
+    for (size_t cell = 0; cell < (size_t)header->rows * header->cols; cell++) {
+        if (index->cell_start[cell + 1] - index->cell_start[cell] >
+            index->cell_start[fullest + 1] - index->cell_start[fullest]) {
+            fullest = cell;
+        }
+    }
+    result.fullest_cell = index->cell_start[fullest + 1] - index->cell_start[fullest];
+    int32_t cell_lat = header->origin_lat + (int32_t)(fullest / header->cols) * header->cell_lat;
+    int32_t cell_lon = header->origin_lon + (int32_t)(fullest % header->cols) * header->cell_lon;
+    start_ns = now_ns();
+    for (int i = 0; i < 10000; i++) {
+        int32_t fix_lat = cell_lat + (int32_t)(uniform() * header->cell_lat);
+        int32_t fix_lon = cell_lon + (int32_t)(uniform() * header->cell_lon);
+        const uint16_t *ids;
+        size_t count = geofence_index_candidates(index, fix_lat, fix_lon, &ids);
+        for (size_t c = 0; c < count; c++) {
+            inside += geofence_index_test(index, ids[c], fix_lat, fix_lon) == GEOFENCE_INSIDE;
+        }
+    }
+    result.fullest_cell_us = (now_ns() - start_ns) / 10000 / 1000.0;
+
+    s_sink = inside;
+
+    // Every fence against the reference, at random points of the grid and near the fences
+    // 在网格内随机点及围栏附近，将每个围栏与参考实现对比
+    reference_prepare(index);
+    for (int p = 0; p < REFERENCE_POINTS; p++) {
+        int32_t point_lat, point_lon;
+        if (p % 2 == 0) {
+            point_lat = header->origin_lat + (int32_t)(uniform() * (top_lat - header->origin_lat));
+            point_lon = header->origin_lon + (int32_t)(uniform() * (top_lon - header->origin_lon));
+        } else {
+            const geofence_record_t *fence = &index->fences[(size_t)(uniform() * header->fence_count)];
+            point_lat = fence->min_lat + (int32_t)(uniform() * (fence->max_lat - fence->min_lat));
+            point_lon = fence->min_lon + (int32_t)(uniform() * (fence->max_lon - fence->min_lon));
+        }
+        const uint16_t *ids;
+        size_t count = geofence_index_candidates(index, point_lat, point_lon, &ids);
+        for (uint16_t id = 0; id < header->fence_count; id++) {
+            double margin;
+            geofence_position_t expected = reference_test(index, id, point_lat, point_lon, &margin);
+            geofence_position_t actual = geofence_index_test(index, id, point_lat, point_lon);
+            result.checks++;
+            if (actual != expected) {
+                result.mismatches += margin > TOLERANCE;
+                result.rounding += margin <= TOLERANCE;
+            }
+            if (expected != GEOFENCE_OUTSIDE && !is_candidate(ids, count, id)) {
+                result.missing++;
+            }
+        }
+    }
+    return result;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        printf("usage: %s <image>...\n", argv[0]);
+        return 1;
+    }
+
+    printf("geofence: 1000 fences, %d fixes at %.0f m/s per grid\n", FIXES, SPEED_M_S);
+    for (int i = 1; i < argc; i++) {
+        geofence_index_t index;
+        TEST_CHECK(load_image(argv[i], &index));
+        if (index.header == NULL) {
+            continue;
+        }
+        grid_result_t result = run_grid(&index);
+        printf("  %-24s %3ux%-3u cells  %5.0f ns/fix  %4.2f tests/fix  fullest cell %4u fences %6.2f us/fix  "
+               "reference %u checks, %u mismatches (%u rounding), %u missing\n",
+               strrchr(argv[i], '/') != NULL ? strrchr(argv[i], '/') + 1 : argv[i], index.header->rows,
+               index.header->cols, result.ns_per_fix, result.tests_per_fix, result.fullest_cell,
+               result.fullest_cell_us, result.checks, result.mismatches, result.rounding, result.missing);
+        TEST_CHECK(result.mismatches == 0);
+        TEST_CHECK(result.missing == 0);
+    }
+    return TEST_EXIT_CODE();
+}
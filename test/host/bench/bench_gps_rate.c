@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * One simulated day of camera state run through gps_rate_logic.c in virtual time: the bench owns the
+ * governor's timer and calls it once per simulated second. Counts receiver epochs and camera pushes
+ * against the old fixed 10 Hz, before the push policy of gps_push_logic thins the pushes further.
+ *
+ * 以虚拟时间将模拟一天的相机状态送入 gps_rate_logic.c：基准程序接管调节器的定时器，每模拟一秒调用一次。
+ * 统计接收机历元数与相机推送数，并与原先固定的 10 Hz 比较；未计入 gps_push_logic 推送策略的进一步削减。
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+
+#include "test_common.h"
+#include "gps_rate_logic.h"
+#include "gps_logic.h"
+#include "connect_logic.h"
+#include "status_logic.h"
+
+/* Stubs: the camera state and the rate setters of gps_logic */
+/* 桩：相机状态以及 gps_logic 的频率设置接口 */
+
+int host_log_level = 1;
+
+int host_log_write(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vprintf(format, args);
+    va_end(args);
+    return length;
+}
+
+uint8_t current_temp_over = 0;
+uint8_t current_camera_bat_percentage = 100;
+
+static connect_state_t s_state = BLE_INIT_COMPLETE;
+static bool s_recording = false;
+static uint16_t s_update_interval_ms = GPS_UPDATE_INTERVAL_MS;
+static uint32_t s_push_interval_ms = GPS_PUSH_INTERVAL_MS;
+static TimerCallbackFunction_t s_timer_callback;
+
+connect_state_t connect_logic_get_state(void) {
+    return s_state;
+}
+
+bool is_camera_recording() {
+    return s_recording;
+}
+
+void gps_set_update_interval(uint16_t interval_ms) {
+    s_update_interval_ms = interval_ms;
+}
+
+void gps_set_push_interval(uint32_t interval_ms) {
+    s_push_interval_ms = interval_ms;
+}
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload, void *id,
+                           TimerCallbackFunction_t callback) {
+    (void)name;
+    (void)period;
+    (void)auto_reload;
+    (void)id;
+    s_timer_callback = callback;
+    return (TimerHandle_t)&s_timer_callback;
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t wait) {
+    (void)timer;
+    (void)wait;
+    return pdPASS;
+}
+
+/* The day: 16 h disconnected, 5 h connected idle, 3 h recording of which 1 h with temp_over and 0.5 h
+ * below 20% battery */
+/* 一天：16 小时未连接，5 小时连接空闲，3 小时录制，其中 1 小时 temp_over、0.5 小时电量低于 20% */
+
+typedef struct {
+    const char *name;
+    uint32_t hours_x2;          // Duration in half hours
+                                // 时长，单位半小时
+    connect_state_t state;
+    bool recording;
+    uint8_t temp_over;
+    uint8_t battery;
+} day_phase_t;
+
+static const day_phase_t s_day[] = {
+    { "night, disconnected",      16, BLE_INIT_COMPLETE,  false, 0, 90 },
+    { "connected idle",            4, PROTOCOL_CONNECTED, false, 0, 90 },
+    { "recording",                 3, PROTOCOL_CONNECTED, true,  0, 80 },
+    { "recording, temp_over",      2, PROTOCOL_CONNECTED, true,  1, 60 },
+    { "connected idle",            4, PROTOCOL_CONNECTED, false, 0, 40 },
+    { "recording, battery 15%",    1, PROTOCOL_CONNECTED, true,  0, 15 },
+    { "connected idle",            2, PROTOCOL_CONNECTED, false, 0, 15 },
+    { "evening, disconnected",    16, BLE_INIT_COMPLETE,  false, 0, 15 },
+};
+
+int main(void) {
+    gps_rate_logic_init();
+    TEST_CHECK(s_timer_callback != NULL);
+
+    uint64_t epochs = 0, pushes = 0, old_epochs = 0, old_pushes = 0;
+    uint32_t seconds = 0;
+    for (size_t p = 0; p < sizeof(s_day) / sizeof(s_day[0]); p++) {
+        s_state = s_day[p].state;
+        s_recording = s_day[p].recording;
+        current_temp_over = s_day[p].temp_over;
+        current_camera_bat_percentage = s_day[p].battery;
+        for (uint32_t s = 0; s < s_day[p].hours_x2 * 1800; s++, seconds++) {
+            s_timer_callback(NULL);
+            // One second at the intervals in force after this evaluation
+            // 按本次评估后生效的间隔运行一秒
+            epochs += 1000 / s_update_interval_ms;
+            old_epochs += 1000 / GPS_UPDATE_INTERVAL_MS;
+            if (s_state == PROTOCOL_CONNECTED) {
+                pushes += 1000 / s_push_interval_ms;
+                old_pushes += 1000 / GPS_PUSH_INTERVAL_MS;
+            }
+        }
+    }
+
+    gps_rate_stats_t stats;
+    gps_rate_logic_get_stats(&stats);
+    printf("gps rate: simulated day of %lu s\n", (unsigned long)seconds);
+    printf("  time LOW/MEDIUM/HIGH   %lu / %lu / %lu s, %lu changes\n",
+           (unsigned long)stats.level_time_s[GPS_RATE_LEVEL_LOW], (unsigned long)stats.level_time_s[GPS_RATE_LEVEL_MEDIUM],
+           (unsigned long)stats.level_time_s[GPS_RATE_LEVEL_HIGH], (unsigned long)stats.change_count);
+    printf("  receiver epochs        %llu, fixed 10 Hz %llu (%+.0f%%)\n", (unsigned long long)epochs,
+           (unsigned long long)old_epochs, 100.0 * ((double)epochs / old_epochs - 1));
+    printf("  camera pushes          %llu, fixed 10 Hz %llu (%+.0f%%)\n", (unsigned long long)pushes,
+           (unsigned long long)old_pushes, 100.0 * ((double)pushes / old_pushes - 1));
+
+    // HIGH only while recording normally, plus the 10 s downgrade delays
+    // 仅在正常录制时处于 HIGH，另加 10 秒的降档延迟
+    TEST_CHECK(seconds == 86400);
+    TEST_CHECK(stats.level_time_s[GPS_RATE_LEVEL_HIGH] <= 1.5 * 3600 + 3 * GPS_RATE_DOWNGRADE_DELAY_MS / 1000 + 1);
+    TEST_CHECK(stats.level_time_s[GPS_RATE_LEVEL_MEDIUM] >= 3600);
+    TEST_CHECK(epochs < old_epochs / 4);
+    TEST_CHECK(pushes < old_pushes / 2);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Link profiles on the loopback: record command round trips and connection events per second at the
+ * default 30 ms interval, the low-latency and the low-power profile (30 commands each at random times),
+ * then connect_logic's switching on a camera it connected: low-latency once ready,
+ * low-power after PROFILE_IDLE_MS without activity, low-latency again when commands flow.
+ *
+ * 回环上的链路配置：默认 30 ms 连接间隔、低时延与低功耗配置下的拍录命令往返时间与每秒连接事件数（每种在随机时刻
+ * 发送 30 条命令），然后是 connect_logic 对其连接的相机的切换：就绪后为低时延，无活动
+ * PROFILE_IDLE_MS 后切到低功耗，命令恢复后回到低时延。
+ */
+
+#include "test_common.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+
+#include "loopback_common.h"
+#include "ble_loopback.h"
+#include "connect_logic.h"
+
+typedef struct {
+    double mean_ms;
+    double max_ms;
+    int answered;
+} rtt_result_t;
+
+static rtt_result_t run_record_commands(int link, int count, int max_gap_ms, int timeout_ms,
+                                        double *host_events_per_s, double *camera_events_per_s) {
+    rtt_result_t r = {0};
+    ble_loopback_link_stats_t before, after;
+    ble_loopback_get_link_stats(link, &before);
+    int64_t start = esp_timer_get_time();
+
+    for (int i = 0; i < count; i++) {
+        // Commands come at random times, not aligned to the connection events
+        // 命令在随机时刻发出，与连接事件不对齐
+        if (max_gap_ms > 0) {
+            vTaskDelay(pdMS_TO_TICKS(esp_random() % max_gap_ms));
+        }
+        double rtt_ms;
+        if (loopback_record_round_trip(link, timeout_ms, &rtt_ms)) {
+            r.answered++;
+            r.mean_ms += rtt_ms;
+            if (rtt_ms > r.max_ms) {
+                r.max_ms = rtt_ms;
+            }
+        }
+    }
+
+    double elapsed_s = (esp_timer_get_time() - start) / 1e6;
+    ble_loopback_get_link_stats(link, &after);
+    if (r.answered > 0) {
+        r.mean_ms /= r.answered;
+    }
+    *host_events_per_s = (after.host_events - before.host_events) / elapsed_s;
+    *camera_events_per_s = (after.camera_events - before.camera_events) / elapsed_s;
+    return r;
+}
+
+static uint32_t link_interval_us(int link) {
+    ble_loopback_link_stats_t stats;
+    ble_loopback_get_link_stats(link, &stats);
+    return stats.interval_us;
+}
+
+int main(void) {
+    static const struct {
+        const char *name;
+        bool set_profile;
+        ble_link_profile_t profile;
+    } runs[] = {
+        {"default (30 ms)", false, BLE_LINK_PROFILE_LOW_LATENCY},
+        {"low-latency", true, BLE_LINK_PROFILE_LOW_LATENCY},
+        {"low-power", true, BLE_LINK_PROFILE_LOW_POWER},
+    };
+    const int count = 30;
+    double mean_ms[3] = {0};
+    double host_eps, camera_eps;
+
+    if (loopback_init() != 0) {
+        return 1;
+    }
+
+    fprintf(stderr, "link profiles: %d record commands at random times, 1 ms processing delay\n", count);
+    for (int i = 0; i < 3; i++) {
+        if (!loopback_open_raw_link(0, runs[i].set_profile, runs[i].profile)) {
+            return 1;
+        }
+        rtt_result_t r = run_record_commands(0, count, 100, 1000, &host_eps, &camera_eps);
+        fprintf(stderr, "  %-16s RTT %6.1f ms mean %6.1f max, %d/%d answered, events/s host %5.1f camera %5.1f\n",
+                runs[i].name, r.mean_ms, r.max_ms, r.answered, count, host_eps, camera_eps);
+        TEST_CHECK(r.answered == count);
+        mean_ms[i] = r.mean_ms;
+        loopback_close_raw_link(0);
+    }
+    TEST_CHECK(mean_ms[1] < mean_ms[0]);
+    TEST_CHECK(mean_ms[0] < mean_ms[2]);
+
+    // connect_logic switches the profile of the cameras it connects on their activity
+    // connect_logic 根据活动切换其连接的相机的链路配置
+    const ble_link_params_t *low_latency = ble_transport_get_link_params(BLE_LINK_PROFILE_LOW_LATENCY);
+    const ble_link_params_t *low_power = ble_transport_get_link_params(BLE_LINK_PROFILE_LOW_POWER);
+    uint8_t mode;
+    double ms;
+    TEST_CHECK(loopback_connect_camera(0, false, &mode, &ms) == 0);
+    vTaskDelay(pdMS_TO_TICKS(300));
+    uint32_t ready_us = link_interval_us(0);
+    vTaskDelay(pdMS_TO_TICKS(PROFILE_IDLE_MS + 2 * PROFILE_CHECK_PERIOD_MS + 300));
+    uint32_t idle_us = link_interval_us(0);
+    double idle_rtt_ms = 0;
+    loopback_record_round_trip(0, 1000, &idle_rtt_ms);
+    for (int i = 0; i < 10; i++) {
+        loopback_record_round_trip(0, 1000, &ms);
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    vTaskDelay(pdMS_TO_TICKS(PROFILE_CHECK_PERIOD_MS + 300));
+    uint32_t active_us = link_interval_us(0);
+    fprintf(stderr, "  connect_logic: interval %.2f ms when ready, %.2f ms after %d s idle, %.2f ms with commands, "
+            "first command after idle %.1f ms\n", ready_us / 1000.0, idle_us / 1000.0, PROFILE_IDLE_MS / 1000,
+            active_us / 1000.0, idle_rtt_ms);
+    TEST_CHECK(ready_us <= low_latency->max_interval * 1250u);
+    TEST_CHECK(idle_us >= low_power->min_interval * 1250u);
+    TEST_CHECK(active_us <= low_latency->max_interval * 1250u);
+    loopback_disconnect_camera(0);
+
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * The camera link transport on the loopback: protocol connect on two links, record command round
+ * trips with latency, jitter and loss, the frame size limit and a dropped link. Built on
+ * loopback_common.c.
+ *
+ * 回环上的相机链路传输层：两条链路上的协议连接，带时延、抖动与丢包的拍录命令往返，帧长上限以及链路掉线。
+ * 基于 loopback_common.c。
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_common.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "loopback_common.h"
+#include "ble_loopback.h"
+#include "data.h"
+#include "connect_logic.h"
+
+typedef struct {
+    double mean_ms;
+    double max_ms;
+    int answered;
+} rtt_result_t;
+
+static rtt_result_t run_record_commands(int link, int count, int timeout_ms) {
+    rtt_result_t r = {0};
+    for (int i = 0; i < count; i++) {
+        double rtt_ms;
+        if (loopback_record_round_trip(link, timeout_ms, &rtt_ms)) {
+            r.answered++;
+            r.mean_ms += rtt_ms;
+            if (rtt_ms > r.max_ms) {
+                r.max_ms = rtt_ms;
+            }
+        }
+    }
+    if (r.answered > 0) {
+        r.mean_ms /= r.answered;
+    }
+    return r;
+}
+
+int main(void) {
+    if (loopback_init() != 0) {
+        return 1;
+    }
+
+    // Protocol connect on two links through connect_logic
+    // 通过 connect_logic 在两条链路上完成协议连接
+    uint8_t mode;
+    double connect_ms[2];
+    int ret0 = loopback_connect_camera(0, false, &mode, &connect_ms[0]);
+    int ret1 = loopback_connect_camera(1, false, &mode, &connect_ms[1]);
+    fprintf(stderr, "loopback: protocol connect on links 0 and 1: %d %d in %.1f %.1f ms, links 0x%X\n", ret0, ret1,
+            connect_ms[0], connect_ms[1], (unsigned)connect_logic_get_protocol_links());
+    TEST_CHECK(ret0 == 0 && ret1 == 0);
+    TEST_CHECK(connect_logic_get_protocol_links() == 0x3);
+    loopback_disconnect_camera(0);
+    loopback_disconnect_camera(1);
+    TEST_CHECK(connect_logic_get_protocol_links() == 0);
+
+    // Record command round trips on a raw low-latency link (7.5-15 ms interval), one-way latency on top
+    // 低时延原始链路（7.5-15 ms 连接间隔）上的拍录命令往返，另加单向时延
+    static const struct {
+        uint32_t latency_us;
+        uint32_t jitter_us;
+        uint16_t loss_per_mille;
+        int count;
+    } runs[] = {
+        {7500, 0, 0, 100},
+        {7500, 5000, 0, 100},
+        {30000, 0, 50, 200},
+    };
+    rtt_result_t results[3];
+    for (int i = 0; i < 3; i++) {
+        loopback_configure(runs[i].latency_us, runs[i].jitter_us, runs[i].loss_per_mille, 247, 0);
+        if (!loopback_open_raw_link(0, true, BLE_LINK_PROFILE_LOW_LATENCY)) {
+            return 1;
+        }
+        results[i] = run_record_commands(0, runs[i].count, 300);
+        fprintf(stderr, "  latency %4.1f ms jitter %3.1f ms loss %2u%%: RTT %5.1f ms mean %5.1f max, %d/%d answered\n",
+                runs[i].latency_us / 1000.0, runs[i].jitter_us / 1000.0, runs[i].loss_per_mille / 10,
+                results[i].mean_ms, results[i].max_ms, results[i].answered, runs[i].count);
+        loopback_close_raw_link(0);
+    }
+    TEST_CHECK(results[0].answered == runs[0].count && results[1].answered == runs[1].count);
+    // Two one-way latencies at least, the jitter is mostly absorbed by the wait for the next connection event
+    // 至少两个单向时延，抖动大多被等待下一个连接事件所吸收
+    TEST_CHECK(results[0].mean_ms >= 15.0 && results[1].mean_ms >= 15.0);
+    TEST_CHECK(results[2].answered < runs[2].count && results[2].answered > runs[2].count * 3 / 4);
+    loopback_configure(1000, 0, 0, 247, 0);
+
+    // A frame above the 10-bit length field is refused before it reaches the link
+    // 超过 10 位长度字段的帧在到达链路之前被拒绝
+    if (!loopback_open_raw_link(0, false, BLE_LINK_PROFILE_LOW_LATENCY)) {
+        return 1;
+    }
+    static uint8_t oversize[1100];
+    oversize[0] = 0xAA;
+    ble_loopback_stats_t before, after;
+    ble_loopback_get_stats(&before);
+    esp_err_t size_ret = data_write_with_response(0, 0x0100, oversize, sizeof(oversize));
+    ble_loopback_get_stats(&after);
+    fprintf(stderr, "  %u-byte frame: %s, %u writes\n", (unsigned)sizeof(oversize), esp_err_to_name(size_ret),
+            (unsigned)(after.host_frames - before.host_frames));
+    TEST_CHECK(size_ret == ESP_ERR_INVALID_SIZE);
+    TEST_CHECK(after.host_frames == before.host_frames);
+
+    // A link the camera drops reports the disconnect and can be opened again
+    // 相机断开的链路会报告断开，并可以重新打开
+    ble_loopback_drop_link(0);
+    vTaskDelay(pdMS_TO_TICKS(100));
+    bool down = !(ble_transport_wait_events(0, BLE_EVENT_CONNECTED, 0) & BLE_EVENT_CONNECTED);
+    double rtt_ms;
+    bool refused = !loopback_record_round_trip(0, 100, &rtt_ms);
+    bool reopened = loopback_open_raw_link(0, false, BLE_LINK_PROFILE_LOW_LATENCY);
+    bool answered = reopened && loopback_record_round_trip(0, 500, &rtt_ms);
+    fprintf(stderr, "  dropped link: %s, command %s, reopened %s, command %s\n", down ? "down" : "still up",
+            refused ? "refused" : "sent", reopened ? "yes" : "no", answered ? "answered" : "lost");
+    TEST_CHECK(down && refused && reopened && answered);
+    loopback_close_raw_link(0);
+
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Stored pairings on the loopback, through connect_logic:
+ * - connect time of a first pairing and of a reconnection with the stored pairing, with the camera
+ *   approving at once and after 2 s of user confirmation;
+ * - a reconnection towards a camera that never paired with us is rejected and forgets the pairing;
+ * - a camera that ignores the reconnection mode keeps the pairing until PAIRING_MAX_TIMEOUTS attempts
+ *   in a row went unanswered, the next connect then pairs again;
+ * - a reconnection cut by a lost link never counts and keeps the pairing.
+ *
+ * 回环上经 connect_logic 的配对保存：
+ * - 首次配对与使用已保存配对重连的连接时间，相机立即批准或经 2 秒用户确认后批准；
+ * - 对从未与本机配对的相机使用重连模式会被拒绝，并删除配对结果；
+ * - 不应答重连模式的相机在连续 PAIRING_MAX_TIMEOUTS 次未应答之前保留配对结果，之后的连接重新配对；
+ * - 因链路断开而中断的重连从不计数，配对结果保留。
+ */
+
+#include "test_common.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "loopback_common.h"
+#include "ble_transport.h"
+#include "pairing_logic.h"
+#include "enums_logic.h"
+
+#define APPROVAL_MS  2000
+
+static void run_pairing(const char *name, uint32_t approval_ms, bool use_pairing, int count, double *out_first_ms,
+                        double *out_reconnect_ms) {
+    loopback_configure(1000, 0, 0, 247, approval_ms);
+    double sum[2] = {0};
+    int done[2] = {0};
+    int ok = 0;
+    for (int i = 0; i < count; i++) {
+        uint8_t mode;
+        double ms;
+        if (loopback_connect_camera(0, use_pairing, &mode, &ms) == 0) {
+            ok++;
+            sum[mode == VERIFY_MODE_RECONNECT] += ms;
+            done[mode == VERIFY_MODE_RECONNECT]++;
+        }
+        vTaskDelay(pdMS_TO_TICKS(200));
+        loopback_disconnect_camera(0);
+    }
+    *out_first_ms = done[0] ? sum[0] / done[0] : 0;
+    *out_reconnect_ms = done[1] ? sum[1] / done[1] : 0;
+    fprintf(stderr, "  %-22s approval %4u ms: %d/%d ok, first pairing %d x %6.1f ms, reconnect %d x %6.1f ms\n", name,
+            (unsigned)approval_ms, ok, count, done[0], *out_first_ms, done[1], *out_reconnect_ms);
+    TEST_CHECK(ok == count);
+}
+
+static const char *mode_name(uint8_t mode) {
+    return mode == VERIFY_MODE_RECONNECT ? "reconnection" : "first pairing";
+}
+
+int main(void) {
+    double first_ms, reconnect_ms;
+    uint8_t camera_addr[6];
+    pairing_record_t record;
+    uint8_t mode;
+    double ms;
+    int ret;
+    bool kept;
+
+    if (loopback_init() != 0) {
+        return 1;
+    }
+
+    fprintf(stderr, "pairing: connect_logic_protocol_connect() time, 1 ms link latency, MTU 247\n");
+    run_pairing("always first pairing", 0, false, 10, &first_ms, &reconnect_ms);
+    run_pairing("always first pairing", APPROVAL_MS, false, 2, &first_ms, &reconnect_ms);
+    TEST_CHECK(first_ms >= APPROVAL_MS);
+
+    // The first connect pairs and stores the record, the following ones reconnect
+    // 第一次连接完成配对并保存记录，之后的连接走重连
+    ble_transport_get_peer_addr(0, camera_addr);
+    pairing_logic_erase(camera_addr);
+    run_pairing("stored pairing", 0, true, 10, &first_ms, &reconnect_ms);
+    run_pairing("stored pairing", APPROVAL_MS, true, 3, &first_ms, &reconnect_ms);
+    TEST_CHECK(reconnect_ms > 0 && reconnect_ms < APPROVAL_MS / 10);
+    loopback_configure(1000, 0, 0, 247, 0);
+
+    // Reconnection mode towards a camera that never paired with us: rejected, record erased at once
+    // 对从未与本机配对的相机使用重连模式：被拒绝，记录立即被清除
+    pairing_record_t bogus = {.device_id = 1, .mac_addr_len = 6};
+    ble_transport_get_peer_addr(1, bogus.camera_addr);
+    pairing_logic_store(&bogus);
+    ret = loopback_connect_camera(1, true, &mode, &ms);
+    kept = pairing_logic_load(bogus.camera_addr, &record) == ESP_OK;
+    fprintf(stderr, "  unpaired reconnect: ret %d after %.1f ms, record %s\n", ret, ms, kept ? "kept" : "erased");
+    TEST_CHECK(ret != 0 && mode == VERIFY_MODE_RECONNECT && !kept);
+    loopback_disconnect_camera(1);
+    ret = loopback_connect_camera(1, true, &mode, &ms);
+    fprintf(stderr, "  next attempt: ret %d as %s after %.1f ms\n", ret, mode_name(mode), ms);
+    TEST_CHECK(ret == 0 && mode == VERIFY_MODE_FIRST_PAIRING);
+    loopback_disconnect_camera(1);
+
+    // The link drops during each reconnection: never counted, the record stays
+    // 每次重连时链路断开：从不计数，记录保留
+    g_drop_on_reconnect = true;
+    for (int i = 0; i < PAIRING_MAX_TIMEOUTS + 1; i++) {
+        ret = loopback_connect_camera(0, true, &mode, &ms);
+        kept = pairing_logic_load(camera_addr, &record) == ESP_OK;
+        fprintf(stderr, "  link lost %d: ret %d after %.1f ms, record %s\n", i + 1, ret, ms, kept ? "kept" : "erased");
+        TEST_CHECK(ret != 0 && mode == VERIFY_MODE_RECONNECT && kept);
+        loopback_disconnect_camera(0);
+    }
+    g_drop_on_reconnect = false;
+
+    // A camera that never answers the reconnection mode: the record stays until PAIRING_MAX_TIMEOUTS in a row
+    // 从不应答重连模式的相机：连续 PAIRING_MAX_TIMEOUTS 次之前记录保留
+    g_ignore_reconnect = true;
+    for (int i = 0; i < PAIRING_MAX_TIMEOUTS; i++) {
+        ret = loopback_connect_camera(0, true, &mode, &ms);
+        kept = pairing_logic_load(camera_addr, &record) == ESP_OK;
+        fprintf(stderr, "  ignored reconnect %d: ret %d after %.1f ms, record %s\n", i + 1, ret, ms,
+                kept ? "kept" : "erased");
+        TEST_CHECK(ret != 0 && mode == VERIFY_MODE_RECONNECT && kept == (i + 1 < PAIRING_MAX_TIMEOUTS));
+        loopback_disconnect_camera(0);
+    }
+    g_ignore_reconnect = false;
+    ret = loopback_connect_camera(0, true, &mode, &ms);
+    fprintf(stderr, "  next attempt: ret %d as %s after %.1f ms\n", ret, mode_name(mode), ms);
+    TEST_CHECK(ret == 0 && mode == VERIFY_MODE_FIRST_PAIRING);
+    loopback_disconnect_camera(0);
+
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Push policy on synthetic traces, no recordings: 30 min at 10 Hz per scenario, each fix run through
+ * the Kalman filter like gps_logic.c does and then offered to gps_push_logic_should_push() in virtual
+ * time. Receiver error is a slow drift (Gauss-Markov, 60 s correlation) of the given horizontal and
+ * vertical size plus 20 cm of white noise, velocity noise is 5 cm/s. Reports pushes against the fixes
+ * offered and the cost of a decision.
+ *
+ * 合成轨迹（非录制数据）上的推送策略：每个场景 10 Hz 共 30 分钟，每个定位与 gps_logic.c 一样先经过卡尔曼滤波，
+ * 再以虚拟时间交给 gps_push_logic_should_push()。接收机误差为给定水平与垂直幅度的缓慢漂移（高斯-马尔可夫，
+ * 相关时间 60 秒）加 20 厘米白噪声，速度噪声为 5 厘米/秒。输出推送数与定位数之比以及单次判断耗时。
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+#include "test_common.h"
+#include "gps_kalman.h"
+#include "gps_push_logic.h"
+
+#define EPOCHS          18000       // 30 min at 10 Hz
+                                    // 10 Hz 下 30 分钟
+#define INTERVAL_US     100000
+#define CORRELATION_S   60.0
+#define WHITE_NOISE_M   0.2
+#define VEL_NOISE_M_S   0.05
+#define START_LAT       22.5
+#define START_LON       113.9
+#define METERS_PER_DEG  (6371000.0 * M_PI / 180.0)
+
+static uint64_t s_rng = 1;
+
+static double uniform(void) {
+    s_rng = s_rng * 6364136223846793005ULL + 1442695040888963407ULL;
+    return ((s_rng >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static double gauss(void) {
+    return sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform());
+}
+
+static int64_t now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+typedef struct {
+    const char *name;
+    double error_h_m;
+    double error_v_m;
+    double speed_m_s;
+    int move_s;         // Moving this long, then stopped for stop_s, repeated; 0 stop_s moves all the time
+                        // 运动该时长后停止 stop_s，循环；stop_s 为 0 表示一直运动
+    int stop_s;
+} scenario_t;
+
+static GPS_Data_t s_fixes[EPOCHS];
+
+/**
+ * @brief Generate the filtered fixes of a scenario
+ *        生成一个场景的滤波后定位
+ */
+static void make_fixes(const scenario_t *scenario) {
+    const double meters_per_deg_lon = METERS_PER_DEG * cos(START_LAT * M_PI / 180.0);
+    const double decay = exp(-INTERVAL_US * 1e-6 / CORRELATION_S);
+    const double drive = sqrt(1 - decay * decay);
+    double north = 0, east = 0;
+    double drift_north = scenario->error_h_m * gauss(), drift_east = scenario->error_h_m * gauss();
+    double drift_down = scenario->error_v_m * gauss();
+    gps_kalman_t kf;
+
+    gps_kalman_init(&kf, 2.0f, 1.0f);
+    for (int i = 0; i < EPOCHS; i++) {
+        double time_s = i * (INTERVAL_US * 1e-6);
+        bool moving = scenario->stop_s == 0 ||
+                      (int)time_s % (scenario->move_s + scenario->stop_s) < scenario->move_s;
+        double speed = moving ? scenario->speed_m_s : 0;
+        double heading = 0.3 * time_s / 60.0 + sin(time_s / 20.0);
+        double vel_north = speed * cos(heading), vel_east = speed * sin(heading);
+        north += vel_north * INTERVAL_US * 1e-6;
+        east += vel_east * INTERVAL_US * 1e-6;
+        drift_north = decay * drift_north + drive * scenario->error_h_m * gauss();
+        drift_east = decay * drift_east + drive * scenario->error_h_m * gauss();
+        drift_down = decay * drift_down + drive * scenario->error_v_m * gauss();
+
+        gps_kalman_measurement_t meas = {
+            .latitude = START_LAT + (north + drift_north + WHITE_NOISE_M * gauss()) / METERS_PER_DEG,
+            .longitude = START_LON + (east + drift_east + WHITE_NOISE_M * gauss()) / meters_per_deg_lon,
+            .altitude = 50.0 + drift_down + WHITE_NOISE_M * gauss(),
+            .vel_north = (float)(vel_north + VEL_NOISE_M_S * gauss()),
+            .vel_east = (float)(vel_east + VEL_NOISE_M_S * gauss()),
+            .vel_down = (float)(VEL_NOISE_M_S * gauss()),
+            .pos_sigma_h = (float)scenario->error_h_m,
+            .pos_sigma_v = (float)scenario->error_v_m,
+            .vel_sigma_h = (float)VEL_NOISE_M_S,
+            .vel_sigma_v = (float)VEL_NOISE_M_S,
+        };
+        int64_t time_us = (int64_t)i * INTERVAL_US;
+        gps_kalman_state_t state;
+        gps_kalman_update(&kf, &meas, time_us);
+        gps_kalman_predict(&kf, time_us, &state);
+
+        s_fixes[i] = (GPS_Data_t) {
+            .Latitude = state.latitude,
+            .Longitude = state.longitude,
+            .Altitude = state.altitude,
+            .Velocity_North = state.vel_north,
+            .Velocity_East = state.vel_east,
+            .Velocity_Descend = state.vel_down,
+            .Status = 1,
+        };
+    }
+}
+
+int main(void) {
+    static const scenario_t scenarios[] = {
+        { "stationary, 2 m / 3 m  ", 2.0, 3.0, 0, 0, 1 },
+        { "stationary, 5 m / 8 m  ", 5.0, 8.0, 0, 0, 1 },
+        { "walk 2 min / stop 3 min", 2.0, 3.0, 1.4, 120, 180 },
+        { "driving 15 m/s         ", 2.0, 3.0, 15.0, 1, 0 },
+    };
+    uint32_t pushes[4];
+    int64_t decide_ns = 0;
+
+    gps_push_logic_init();
+    printf("push policy: %d fixes at 10 Hz per scenario, synthetic traces\n", EPOCHS);
+    for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) {
+        make_fixes(&scenarios[s]);
+        gps_push_logic_reset();
+        pushes[s] = 0;
+        int64_t start_ns = now_ns();
+        for (int i = 0; i < EPOCHS; i++) {
+            pushes[s] += gps_push_logic_should_push(&s_fixes[i], (int64_t)i * INTERVAL_US);
+        }
+        decide_ns += now_ns() - start_ns;
+        printf("  %s  %5lu of %d pushed (%.0f%%)\n", scenarios[s].name, (unsigned long)pushes[s], EPOCHS,
+               100.0 * pushes[s] / EPOCHS);
+    }
+    printf("  decision        %.0f ns\n", (double)decide_ns / (EPOCHS * 4));
+
+    // Stationary is down to about the keep-alive rate, driving pushes every fix
+    // 静止时约降至保活频率，行驶时推送每个定位
+    TEST_CHECK(pushes[0] < EPOCHS / 8);
+    TEST_CHECK(pushes[1] < EPOCHS / 8);
+    TEST_CHECK(pushes[2] > pushes[0] && pushes[2] < EPOCHS * 3 / 5);
+    TEST_CHECK(pushes[3] == EPOCHS);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Background reconnection on the loopback, connect_logic's reconnect task with its real backoff:
+ * - the camera drops the link 20 times, time until the camera is protocol connected again;
+ * - the camera answers nothing for 1, 3 and 8 s after the drop (every frame lost), so attempts fail
+ *   and back off until it is back;
+ * - a user disconnect while an attempt is running leaves the link in BLE_INIT_COMPLETE and nothing
+ *   reconnects it.
+ *
+ * 回环上的后台重连，使用 connect_logic 重连任务及其实际退避：
+ * - 相机断开链路 20 次，统计到相机重新完成协议连接的时间；
+ * - 掉线后相机在 1、3、8 秒内不应答任何帧（全部丢失），尝试失败并退避，直到相机恢复；
+ * - 尝试进行中用户主动断开，链路回到 BLE_INIT_COMPLETE 且不会再被重连。
+ */
+
+#include <stdlib.h>
+
+#include "test_common.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#include "loopback_common.h"
+#include "ble_loopback.h"
+#include "connect_logic.h"
+
+#define DROPS 20
+
+/**
+ * @brief Wait until the link is protocol connected again
+ *        等待链路重新完成协议连接
+ *
+ * @return double Time from start_us (ms), -1 on timeout
+ *                自 start_us 起的时间 (毫秒)，超时返回 -1
+ */
+static double wait_recovered(int link, int64_t start_us, int timeout_ms) {
+    while (esp_timer_get_time() - start_us < timeout_ms * 1000LL) {
+        if (connect_logic_get_protocol_links() & (1u << link)) {
+            return (esp_timer_get_time() - start_us) / 1000.0;
+        }
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    return -1;
+}
+
+static int compare_double(const void *a, const void *b) {
+    const double *x = a, *y = b;
+    return (*x > *y) - (*x < *y);
+}
+
+int main(void) {
+    static double recover_ms[DROPS];
+    uint8_t mode;
+    double ms;
+
+    if (loopback_init() != 0) {
+        return 1;
+    }
+    TEST_CHECK(loopback_connect_camera(0, false, &mode, &ms) == 0);
+
+    // The link drops and the camera is right there
+    // 链路断开，相机仍在附近
+    int recovered = 0;
+    for (int i = 0; i < DROPS; i++) {
+        int64_t start = esp_timer_get_time();
+        ble_loopback_drop_link(0);
+        vTaskDelay(pdMS_TO_TICKS(20));
+        double t = wait_recovered(0, start, 10000);
+        if (t >= 0) {
+            recover_ms[recovered++] = t;
+        }
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    qsort(recover_ms, recovered, sizeof(recover_ms[0]), compare_double);
+    fprintf(stderr, "reconnect: %d/%d drops recovered, min %.0f p50 %.0f max %.0f ms\n", recovered, DROPS,
+            recover_ms[0], recover_ms[recovered / 2], recover_ms[recovered - 1]);
+    TEST_CHECK(recovered == DROPS);
+    TEST_CHECK(recover_ms[0] >= RECONNECT_BASE_DELAY_MS / 2);
+
+    // The camera stays silent for a while after the drop
+    // 掉线后相机在一段时间内不应答
+    static const int silent_ms[] = {1000, 3000, 8000};
+    for (size_t i = 0; i < sizeof(silent_ms) / sizeof(silent_ms[0]); i++) {
+        loopback_configure(1000, 0, 1000, 247, 0);
+        int64_t start = esp_timer_get_time();
+        ble_loopback_drop_link(0);
+        vTaskDelay(pdMS_TO_TICKS(silent_ms[i]));
+        loopback_configure(1000, 0, 0, 247, 0);
+        double t = wait_recovered(0, start, 60000);
+        fprintf(stderr, "  silent %4d ms: recovered after %.0f ms\n", silent_ms[i], t);
+        TEST_CHECK(t >= silent_ms[i]);
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+
+    // A user disconnect in the middle of an attempt ends the reconnection
+    // 尝试进行中的主动断开结束重连
+    loopback_configure(1000, 0, 1000, 247, 0);
+    ble_loopback_drop_link(0);
+    vTaskDelay(pdMS_TO_TICKS(RECONNECT_BASE_DELAY_MS + 200));
+    connect_state_t during = connect_logic_get_link_state(0);
+    connect_logic_ble_disconnect(0);
+    loopback_configure(1000, 0, 0, 247, 0);
+    vTaskDelay(pdMS_TO_TICKS(4000));
+    connect_state_t after = connect_logic_get_link_state(0);
+    fprintf(stderr, "  user disconnect during an attempt: state %d -> %d, protocol links 0x%X\n", during, after,
+            (unsigned)connect_logic_get_protocol_links());
+    TEST_CHECK(during == BLE_SEARCHING || during == BLE_CONNECTED);
+    TEST_CHECK(after == BLE_INIT_COMPLETE);
+    TEST_CHECK(connect_logic_get_protocol_links() == 0);
+    TEST_CHECK(loopback_connect_camera(0, false, &mode, &ms) == 0);
+    loopback_disconnect_camera(0);
+
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Rule engine on a synthetic day: 16 rules (6 on speed), 10 Hz GPS fixes for 1M ticks (27.8 h) with
+ * the speed changing on every moving fix, camera status at 1 Hz. Reports the cost per tick and the
+ * conditions evaluated against a reference that evaluates the whole table on every tick, checks that
+ * both fire the same rules at the same ticks, and times a 16-rule recompile.
+ *
+ * 合成一天中的规则引擎：16 条规则（6 条基于速度），10 Hz GPS 定位共 100 万次（27.8 小时），移动时每次定位
+ * 速度都变化，相机状态 1 Hz。输出每次定位的耗时与评估的条件数，并与每次都评估整张规则表的参考实现比较，
+ * 检查两者在相同时刻触发相同的规则，另测 16 条规则重新编译的耗时。
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "test_common.h"
+#include "rule_engine.h"
+
+#define TICKS           1000000
+#define TICK_MS         100
+#define STATUS_TICKS    10
+#define MAX_FIRES       200000
+#define RECOMPILES      10000
+
+static const char s_rules[] =
+    "SPEED>20/3 START;SPEED<2/300 MODE:2;SPEED>80 STOP;SPEED>=50/10 MODE:1;SPEED<5/60 STOP;SPEED>100/1 MODE:3;"
+    "ALT>1500 MODE:4;ALT<0/5 STOP;SATS<4/10 STOP;SATS>=8 START;"
+    "BATTERY<10 STOP;BATTERY<20/60 MODE:5;BATTERY>=95 START;"
+    "RECORDING=0/30 START;RECORDING!=0/600 STOP;MODE=2 START";
+
+typedef struct {
+    uint32_t tick[MAX_FIRES];
+    uint8_t index[MAX_FIRES];
+    int count;
+    uint32_t now_tick;
+} fires_t;
+
+static fires_t s_engine_fires;
+static fires_t s_reference_fires;
+
+static uint64_t s_rng = 39;
+
+static double uniform(void) {
+    s_rng = s_rng * 6364136223846793005ULL + 1442695040888963407ULL;
+    return ((s_rng >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static double gauss(void) {
+    return sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform());
+}
+
+static int64_t now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void record_fire(fires_t *fires, uint8_t index) {
+    if (fires->count < MAX_FIRES) {
+        fires->tick[fires->count] = fires->now_tick;
+        fires->index[fires->count] = index;
+        fires->count++;
+    }
+}
+
+static void on_fire(const rule_engine_t *engine, uint8_t index, void *context) {
+    (void)engine;
+    record_fire(context, index);
+}
+
+/* Reference: every rule on every tick, same fire-once and hold semantics */
+/* 参考实现：每次都评估全部规则，触发一次与保持时间的语义相同 */
+typedef struct {
+    bool active[RULE_MAX_RULES];
+    bool fired[RULE_MAX_RULES];
+    int64_t since_ms[RULE_MAX_RULES];
+} reference_t;
+
+static void reference_tick(reference_t *reference, const rule_engine_t *table, const int32_t *values, int64_t now_ms) {
+    for (uint8_t i = 0; i < table->count; i++) {
+        const rule_t *rule = &table->rules[i];
+        int32_t value = values[rule->input];
+        bool condition;
+        switch (rule->op) {
+            case RULE_OP_LT: condition = value < rule->threshold; break;
+            case RULE_OP_LE: condition = value <= rule->threshold; break;
+            case RULE_OP_GT: condition = value > rule->threshold; break;
+            case RULE_OP_GE: condition = value >= rule->threshold; break;
+            case RULE_OP_EQ: condition = value == rule->threshold; break;
+            default:         condition = value != rule->threshold; break;
+        }
+        if (!condition) {
+            reference->active[i] = false;
+            reference->fired[i] = false;
+            continue;
+        }
+        if (!reference->active[i]) {
+            reference->active[i] = true;
+            reference->since_ms[i] = now_ms;
+        }
+        if (!reference->fired[i] && now_ms - reference->since_ms[i] >= rule->hold_ms) {
+            reference->fired[i] = true;
+            record_fire(&s_reference_fires, i);
+        }
+    }
+}
+
+static int compare_fires(const void *a, const void *b) {
+    const uint64_t *x = a, *y = b;
+    return (*x > *y) - (*x < *y);
+}
+
+// Fires as (tick, index) keys, sorted, since the order within a tick differs
+// 触发记录转为 (时刻, 序号) 键并排序，同一时刻内的顺序可以不同
+static uint64_t *sorted_keys(const fires_t *fires) {
+    uint64_t *keys = malloc(sizeof(uint64_t) * (fires->count + 1));
+    for (int i = 0; i < fires->count; i++) {
+        keys[i] = (uint64_t)fires->tick[i] << 8 | fires->index[i];
+    }
+    qsort(keys, fires->count, sizeof(uint64_t), compare_fires);
+    return keys;
+}
+
+int main(void) {
+    static int32_t inputs[TICKS][RULE_INPUT_COUNT];
+
+    // Stop-and-go drive with parking, camera status stepping slowly
+    // 走走停停并有停车的行驶，相机状态缓慢变化
+    double speed = 0, target = 0, altitude = 40;
+    int satellites = 10, battery = 100, recording = 0, mode = 0;
+    int moving_ticks = 0;
+    for (int t = 0; t < TICKS; t++) {
+        if (uniform() < 1.0 / 600) {
+            double phase = uniform();
+            target = phase < 0.3 ? 0 : phase < 0.7 ? 30 + 30 * uniform() : 60 + 60 * uniform();
+        }
+        speed += (target - speed) * 0.02;
+        double reported = target == 0 && speed < 0.5 ? 0 : fmax(0, speed + 0.3 * gauss());
+        moving_ticks += reported > 0;
+        altitude += 0.05 * gauss() + (altitude > 1600 ? -0.05 : 0.02);
+        if (uniform() < 1.0 / 3000) {
+            satellites = 2 + (int)(uniform() * 14);
+        }
+        if (t % STATUS_TICKS == 0) {
+            if (t % 1800 == 0) {
+                battery = battery <= 5 ? 100 : battery - 1;
+            }
+            if (uniform() < 1.0 / 200) {
+                recording = !recording;
+            }
+            if (uniform() < 1.0 / 500) {
+                mode = (int)(uniform() * 6);
+            }
+        }
+        inputs[t][RULE_INPUT_SPEED] = (int32_t)lround(reported * 10);
+        inputs[t][RULE_INPUT_ALTITUDE] = (int32_t)lround(altitude);
+        inputs[t][RULE_INPUT_SATELLITES] = satellites;
+        inputs[t][RULE_INPUT_BATTERY] = battery;
+        inputs[t][RULE_INPUT_RECORDING] = recording;
+        inputs[t][RULE_INPUT_CAMERA_MODE] = mode;
+    }
+
+    static rule_engine_t engine;
+    char error[48] = "";
+    int count = rule_engine_compile(&engine, s_rules, error, sizeof(error));
+    TEST_CHECK(count == RULE_MAX_RULES);
+
+    // Engine as the rule task drives it: three GPS inputs per fix, status inputs at 1 Hz, then a poll
+    // 按规则任务的方式驱动引擎：每次定位三个 GPS 输入，状态输入 1 Hz，然后轮询
+    int64_t start = now_ns();
+    for (int t = 0; t < TICKS; t++) {
+        int64_t now_ms = (int64_t)t * TICK_MS;
+        s_engine_fires.now_tick = (uint32_t)t;
+        for (int input = RULE_INPUT_SPEED; input <= RULE_INPUT_SATELLITES; input++) {
+            rule_engine_set_input(&engine, (rule_input_t)input, inputs[t][input], now_ms, on_fire, &s_engine_fires);
+        }
+        if (t % STATUS_TICKS == 0) {
+            for (int input = RULE_INPUT_BATTERY; input < RULE_INPUT_COUNT; input++) {
+                rule_engine_set_input(&engine, (rule_input_t)input, inputs[t][input], now_ms, on_fire, &s_engine_fires);
+            }
+        }
+        rule_engine_poll(&engine, now_ms, on_fire, &s_engine_fires);
+    }
+    double engine_ns = (double)(now_ns() - start) / TICKS;
+
+    // Status inputs hold their last value between status updates, as the engine keeps them
+    // 状态输入在两次更新之间保持上次的数值，与引擎保存的一致
+    static reference_t reference;
+    int32_t values[RULE_INPUT_COUNT];
+    start = now_ns();
+    for (int t = 0; t < TICKS; t++) {
+        s_reference_fires.now_tick = (uint32_t)t;
+        for (int input = 0; input < RULE_INPUT_COUNT; input++) {
+            if (input <= RULE_INPUT_SATELLITES || t % STATUS_TICKS == 0) {
+                values[input] = inputs[t][input];
+            }
+        }
+        reference_tick(&reference, &engine, values, (int64_t)t * TICK_MS);
+    }
+    double reference_ns = (double)(now_ns() - start) / TICKS;
+
+    uint64_t *engine_keys = sorted_keys(&s_engine_fires);
+    uint64_t *reference_keys = sorted_keys(&s_reference_fires);
+    int mismatches = s_engine_fires.count != s_reference_fires.count;
+    for (int i = 0; !mismatches && i < s_engine_fires.count; i++) {
+        mismatches += engine_keys[i] != reference_keys[i];
+    }
+    free(engine_keys);
+    free(reference_keys);
+
+    // Recompiling the same text is the most matching work: every rule keeps the state of an old one
+    // 重新编译相同文本的比对工作量最大：每条规则都沿用一条旧规则的状态
+    start = now_ns();
+    for (int i = 0; i < RECOMPILES; i++) {
+        rule_engine_compile(&engine, s_rules, NULL, 0);
+    }
+    double recompile_us = (double)(now_ns() - start) / RECOMPILES / 1000;
+
+    printf("rules: %d rules, %d ticks at %d ms (%.1f h), moving %.0f%% of the ticks\n", count, TICKS, TICK_MS,
+           TICKS * (TICK_MS / 3600000.0), 100.0 * moving_ticks / TICKS);
+    printf("  incremental  %6.1f ns/tick  %5.2f conditions/tick  %d fires\n", engine_ns,
+           (double)engine.evaluations / TICKS, s_engine_fires.count);
+    printf("  full table   %6.1f ns/tick  %5.2f conditions/tick  %d fires\n", reference_ns, (double)count,
+           s_reference_fires.count);
+    printf("  fires differing from the full table: %d\n", mismatches);
+    printf("  recompile of %d rules: %.2f us\n", count, recompile_us);
+
+    TEST_CHECK(mismatches == 0);
+    TEST_CHECK(s_engine_fires.count > 100 && s_engine_fires.count < MAX_FIRES);
+    TEST_CHECK(engine.evaluations < (uint32_t)TICKS * 8);
+    return TEST_EXIT_CODE();
+}
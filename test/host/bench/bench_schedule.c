@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Scheduled record start/stop on the loopback: two cameras connected through connect_logic, 40 targets
+ * 700 ms apart at random sub-interval offsets. Reports how far the write call starts from the target
+ * and when the frame reaches each camera. GPS time is stubbed as a locked PPS clock with a fixed offset,
+ * so the figures cover the scheduler and the link, not the time mapping. A last run repeats the case of
+ * a camera that never answers: START at +1 s and STOP at +2 s must both go out.
+ *
+ * 回环上的定时开始/停止录制：两台相机经 connect_logic 连接，40 个目标时刻间隔 700 ms，并带有随机的非整周期偏移。
+ * 输出写调用开始时刻与目标的偏差，以及帧到达每台相机的时刻。GPS 时间以固定偏移的已锁定 PPS 时钟代替，
+ * 因此数据只涵盖调度器与链路，不含时间换算。最后重复相机不应答的情形：+1 秒的 START 与 +2 秒的 STOP 都必须发出。
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_common.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+
+#include "loopback_common.h"
+#include "connect_logic.h"
+#include "console_logic.h"
+#include "gps_time_logic.h"
+#include "schedule_logic.h"
+
+#define TARGETS         40
+#define SPACING_US      700000
+#define UTC_OFFSET_US   1741938420000000LL
+
+/* GPS time: a locked PPS clock, UTC is esp_timer time plus a fixed offset */
+/* GPS 时间：已锁定的 PPS 时钟，UTC 为 esp_timer 时间加固定偏移 */
+bool gps_time_utc_to_local(int64_t utc_us, int64_t *local_us) {
+    *local_us = utc_us - UTC_OFFSET_US;
+    return true;
+}
+
+gps_time_source_t gps_time_local_to_utc(int64_t local_us, int64_t *utc_us) {
+    *utc_us = local_us + UTC_OFFSET_US;
+    return GPS_TIME_SOURCE_PPS;
+}
+
+gps_time_source_t gps_time_now(int64_t *utc_us) {
+    return gps_time_local_to_utc(esp_timer_get_time(), utc_us);
+}
+
+/* The AT command is not driven here */
+/* 此处不使用 AT 命令 */
+int console_register_command(const char *keyword, console_command_handler_t handler) {
+    return 0;
+}
+
+void console_printf(const char *format, ...) {
+}
+
+static int compare_int64(const void *a, const void *b) {
+    const int64_t *x = a, *y = b;
+    return (*x > *y) - (*x < *y);
+}
+
+static void print_distribution(const char *name, int64_t *values, int count) {
+    qsort(values, count, sizeof(values[0]), compare_int64);
+    double mean = 0;
+    for (int i = 0; i < count; i++) {
+        mean += values[i];
+    }
+    mean /= count;
+    fprintf(stderr, "  %-24s mean %8.1f  min %6lld  p50 %6lld  p90 %6lld  max %6lld us\n", name, mean,
+            (long long)values[0], (long long)values[count / 2], (long long)values[count * 9 / 10],
+            (long long)values[count - 1]);
+}
+
+/**
+ * @brief Wait until the scheduler has sent or dropped this many entries in total
+ *        等待调度器累计发送或丢弃的条目达到该数量
+ */
+static bool wait_finished(uint32_t total, int timeout_ms) {
+    schedule_stats_t stats;
+    for (int waited = 0; waited < timeout_ms; waited += 10) {
+        schedule_logic_get_stats(&stats);
+        if (stats.sent_count + stats.dropped_count >= total) {
+            return true;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return false;
+}
+
+int main(void) {
+    static int64_t call_error_us[TARGETS];
+    static int64_t call_duration_us[TARGETS];
+    static int64_t arrival_us[2][TARGETS];
+    static int64_t spread_us[TARGETS];
+    schedule_stats_t stats;
+
+    if (loopback_init() != 0 || schedule_logic_init() != 0) {
+        return 1;
+    }
+    uint8_t mode;
+    double ms;
+    TEST_CHECK(loopback_connect_camera(0, false, &mode, &ms) == 0);
+    TEST_CHECK(loopback_connect_camera(1, false, &mode, &ms) == 0);
+    TEST_CHECK(connect_logic_get_protocol_links() == 0x3);
+
+    int measured = 0;
+    for (int i = 0; i < TARGETS; i++) {
+        int64_t now_utc_us;
+        gps_time_now(&now_utc_us);
+        int64_t target_utc_us = now_utc_us + SPACING_US + esp_random() % 30000;
+        int64_t target_local_us;
+        gps_time_utc_to_local(target_utc_us, &target_local_us);
+        g_peer_record_us[0] = g_peer_record_us[1] = 0;
+
+        if (schedule_logic_add(i % 2 == 0, target_utc_us) < 0 || !wait_finished((uint32_t)i + 1, 2000)) {
+            fprintf(stderr, "target %d not finished\n", i);
+            break;
+        }
+        // Let both frames arrive before reading the camera side
+        // 读取相机端之前等待两帧都到达
+        vTaskDelay(pdMS_TO_TICKS(100));
+        schedule_logic_get_stats(&stats);
+        call_error_us[measured] = stats.last_error_us;
+        call_duration_us[measured] = stats.last_call_us;
+        arrival_us[0][measured] = g_peer_record_us[0] - target_local_us;
+        arrival_us[1][measured] = g_peer_record_us[1] - target_local_us;
+        spread_us[measured] = llabs(arrival_us[0][measured] - arrival_us[1][measured]);
+        TEST_CHECK(stats.last_cameras == 2);
+        TEST_CHECK(g_peer_record_us[0] != 0 && g_peer_record_us[1] != 0);
+        measured++;
+    }
+
+    schedule_logic_get_stats(&stats);
+    fprintf(stderr, "schedule: %d targets to 2 cameras, %u sent, %u dropped\n", TARGETS, (unsigned)stats.sent_count,
+            (unsigned)stats.dropped_count);
+    TEST_CHECK(measured == TARGETS && stats.sent_count == TARGETS && stats.dropped_count == 0);
+    if (measured > 0) {
+        print_distribution("write call start", call_error_us, measured);
+        print_distribution("write calls, 2 cameras", call_duration_us, measured);
+        print_distribution("arrival at camera 0", arrival_us[0], measured);
+        print_distribution("arrival at camera 1", arrival_us[1], measured);
+        print_distribution("camera 0 vs camera 1", spread_us, measured);
+        TEST_CHECK(call_error_us[0] >= 0 && call_error_us[measured - 1] < SCHEDULE_LATE_LIMIT_US);
+        TEST_CHECK(arrival_us[0][0] >= 0 && arrival_us[1][0] >= 0);
+    }
+
+    // A camera that never answers: the STOP one second after the START still goes out on time
+    // 不应答的相机：START 之后一秒的 STOP 仍按时发出
+    g_ignore_record = true;
+    int64_t now_utc_us;
+    gps_time_now(&now_utc_us);
+    uint32_t before = stats.sent_count + stats.dropped_count;
+    schedule_logic_add(true, now_utc_us + 1000000);
+    schedule_logic_add(false, now_utc_us + 2000000);
+    bool finished = wait_finished(before + 2, 4000);
+    schedule_logic_get_stats(&stats);
+    fprintf(stderr, "  silent camera: START +1 s, STOP +2 s: %s, %u sent, %u dropped, STOP %+ld us from target\n",
+            finished ? "finished" : "pending", (unsigned)stats.sent_count - TARGETS, (unsigned)stats.dropped_count,
+            (long)stats.last_error_us);
+    TEST_CHECK(finished && stats.sent_count == TARGETS + 2 && stats.dropped_count == 0);
+    g_ignore_record = false;
+
+    loopback_disconnect_camera(0);
+    loopback_disconnect_camera(1);
+    return TEST_EXIT_CODE();
+}
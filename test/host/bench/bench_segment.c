@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Segmented and coalesced writes on the loopback: 20 GPS commands with response over MTU 64, each one
+ * above MTU - 3 and sent in two writes, must all be answered. Then GPS frames in batches of 4 for 2 s
+ * at MTU 247 and MTU 23, coalescing off and on; every frame must reach the camera and the camera must
+ * never skip a broken one.
+ *
+ * 回环上的分段与合并写入：MTU 64 下发送 20 条带应答的 GPS 命令，每条都超过 MTU - 3、分两次写入，
+ * 必须全部得到应答。然后在 MTU 247 与 MTU 23 下、合并关闭与开启时，以每批 4 帧发送 GPS 帧 2 秒；
+ * 每帧都必须到达相机，相机不得跳过任何损坏的帧。
+ */
+
+#include <stdlib.h>
+
+#include "test_common.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include "esp_timer.h"
+
+#include "loopback_common.h"
+#include "ble_loopback.h"
+#include "data.h"
+#include "enums_logic.h"
+#include "dji_protocol_parser.h"
+#include "dji_protocol_data_structures.h"
+
+#define SEGMENTED_COMMANDS  20
+#define BATCH               4
+
+static void segmented_commands(void) {
+    gps_data_push_command_frame gps = {0};
+    size_t length = 0;
+
+    // A 66-byte command over MTU 64 needs 2 writes
+    // 66 字节的命令在 MTU 64 下需要 2 次写入
+    loopback_configure(1000, 0, 0, 64, 0);
+    if (!loopback_open_raw_link(0, true, BLE_LINK_PROFILE_LOW_LATENCY)) {
+        TEST_CHECK(false);
+        return;
+    }
+    data_link_activity_t activity_before, activity_after;
+    data_get_link_activity(0, &activity_before);
+    int answered = 0;
+    for (uint16_t seq = 0x2000; seq < 0x2000 + SEGMENTED_COMMANDS; seq++) {
+        uint8_t *frame = protocol_create_frame(0x00, 0x17, CMD_RESPONSE_OR_NOT, &gps, seq, &length);
+        void *result = NULL;
+        size_t result_length = 0;
+        if (data_write_with_response(0, seq, frame, length) == ESP_OK &&
+            data_wait_for_result_by_seq(0, seq, 1000, &result, &result_length) == ESP_OK) {
+            answered++;
+            free(result);
+        }
+        free(frame);
+    }
+    data_get_link_activity(0, &activity_after);
+    fprintf(stderr, "segment: MTU 64, %d/%d %u-byte commands answered, %u writes, %u segmented\n", answered,
+            SEGMENTED_COMMANDS, (unsigned)length, (unsigned)(activity_after.writes - activity_before.writes),
+            (unsigned)(activity_after.segmented - activity_before.segmented));
+    TEST_CHECK(answered == SEGMENTED_COMMANDS);
+    TEST_CHECK(activity_after.segmented - activity_before.segmented == SEGMENTED_COMMANDS);
+    loopback_close_raw_link(0);
+}
+
+static void batched_frames(uint16_t mtu, bool coalesce) {
+    gps_data_push_command_frame gps = {0};
+    size_t length = 0;
+
+    loopback_configure(1000, 0, 0, mtu, 0);
+    if (!loopback_open_raw_link(0, true, BLE_LINK_PROFILE_LOW_LATENCY)) {
+        TEST_CHECK(false);
+        return;
+    }
+    data_set_link_coalescing(0, coalesce);
+
+    uint8_t *frames[BATCH];
+    data_frame_t batch[BATCH];
+    for (int i = 0; i < BATCH; i++) {
+        frames[i] = protocol_create_frame(0x00, 0x17, CMD_NO_RESPONSE, &gps, 0x300 + i, &length);
+        batch[i].data = frames[i];
+        batch[i].length = length;
+    }
+    data_link_activity_t activity_before, activity_after;
+    ble_loopback_stats_t stats_before, stats_after;
+    data_get_link_activity(0, &activity_before);
+    ble_loopback_get_stats(&stats_before);
+    uint32_t received_before = g_peer_frames[0];
+
+    int sent = 0;
+    int64_t start = esp_timer_get_time();
+    while (esp_timer_get_time() - start < 2000000) {
+        data_wait_tx_ready(0, 100);
+        if (data_write_frames_without_response(0, batch, BATCH) == ESP_OK) {
+            sent += BATCH;
+        }
+    }
+    vTaskDelay(pdMS_TO_TICKS(300));
+
+    data_get_link_activity(0, &activity_after);
+    ble_loopback_get_stats(&stats_after);
+    uint32_t writes = activity_after.writes - activity_before.writes;
+    uint32_t received = g_peer_frames[0] - received_before;
+    fprintf(stderr, "  %-4u %-8s %9d %12.2f %10u %4s %4u\n", mtu, coalesce ? "on" : "off", sent / 2,
+            sent ? (double)writes / sent : 0.0, (unsigned)(activity_after.segmented - activity_before.segmented),
+            received == (uint32_t)sent ? "all" : "of", (unsigned)received);
+    TEST_CHECK(received == (uint32_t)sent);
+    TEST_CHECK(stats_after.peer_skipped == stats_before.peer_skipped);
+    if (coalesce && mtu == 247) {
+        TEST_CHECK(activity_after.coalesced > activity_before.coalesced);
+    }
+
+    for (int i = 0; i < BATCH; i++) {
+        free(frames[i]);
+    }
+    data_set_link_coalescing(0, CONFIG_DATA_COALESCE_FRAMES);
+    loopback_close_raw_link(0);
+}
+
+int main(void) {
+    static const uint16_t mtus[] = {247, 23};
+
+    if (loopback_init() != 0) {
+        return 1;
+    }
+
+    segmented_commands();
+
+    fprintf(stderr, "  %-4s %-8s %9s %12s %10s %9s\n", "MTU", "coalesce", "frames/s", "writes/frame", "segmented",
+            "received");
+    for (int m = 0; m < 2; m++) {
+        batched_frames(mtus[m], false);
+        batched_frames(mtus[m], true);
+    }
+    return TEST_EXIT_CODE();
+}
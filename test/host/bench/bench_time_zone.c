@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Camera local time of time_zone_logic.c against glibc localtime for Shanghai, Berlin (EU rule),
+ * New York (US rule) and Kolkata (+05:30), 2007 to 2030. UTC is walked forward in steps of 997 s
+ * (an argument changes the step) like the push task does, so the date cache is exercised, and every
+ * second around each offset change is compared. Also reports the cost of a conversion at 10 Hz.
+ *
+ * 将 time_zone_logic.c 生成的相机本地时间与 glibc localtime 比较：上海、柏林（EU 规则）、纽约（US 规则）和
+ * 加尔各答（+05:30），2007 至 2030 年。UTC 与推送任务一样按 997 秒步长（可由参数修改）向前推进，以覆盖日期缓存，
+ * 并逐秒比较每次偏移变化前后。同时输出 10 Hz 下单次转换的耗时。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+#include "test_common.h"
+#include "time_zone_logic.h"
+#include "console_logic.h"
+
+#define START_UTC_S     1167609600LL    // 2007-01-01 00:00:00
+#define END_UTC_S       1924992000LL    // 2031-01-01 00:00:00
+#define TIMED_FIXES     10000000
+
+/* Console stub: the TZ command is called directly */
+/* 控制台桩：直接调用 TZ 命令 */
+
+static console_command_handler_t s_tz_command;
+static char s_reply[64];
+
+int console_register_command(const char *keyword, console_command_handler_t handler) {
+    s_tz_command = handler;
+    return 0;
+}
+
+void console_printf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(s_reply, sizeof(s_reply), format, args);
+    va_end(args);
+}
+
+static int64_t now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static uint32_t s_mismatches;
+
+static void compare(int64_t utc_s, long *gmtoff) {
+    time_t t = (time_t)utc_s;
+    struct tm local;
+    uint32_t year_month_day, hour_minute_second;
+
+    localtime_r(&t, &local);
+    time_zone_logic_to_local(utc_s, &year_month_day, &hour_minute_second);
+    if (year_month_day != (uint32_t)((local.tm_year + 1900) * 10000 + (local.tm_mon + 1) * 100 + local.tm_mday) ||
+        hour_minute_second != (uint32_t)(local.tm_hour * 10000 + local.tm_min * 100 + local.tm_sec)) {
+        if (s_mismatches++ < 5) {
+            fprintf(stderr, "mismatch at %lld: %08u %06u\n", (long long)utc_s, year_month_day, hour_minute_second);
+        }
+    }
+    *gmtoff = local.tm_gmtoff;
+}
+
+int main(int argc, char **argv) {
+    static const struct {
+        const char *tz;
+        const char *command;
+    } zones[] = {
+        { "Asia/Shanghai", "TZ +08:00 NONE" },
+        { "Europe/Berlin", "TZ +01:00 EU" },
+        { "America/New_York", "TZ -05:00 US" },
+        { "Asia/Kolkata", "TZ +05:30" },
+    };
+    int64_t step_s = argc > 1 ? atoll(argv[1]) : 997;
+    uint64_t compared = 0;
+    uint32_t changes = 0;
+
+    time_zone_logic_init();
+    for (size_t z = 0; z < sizeof(zones) / sizeof(zones[0]); z++) {
+        setenv("TZ", zones[z].tz, 1);
+        tzset();
+        s_tz_command(zones[z].command);
+        TEST_CHECK(strncmp(s_reply, "#TZ ", 4) == 0);
+
+        long gmtoff, previous_gmtoff;
+        compare(START_UTC_S, &previous_gmtoff);
+        for (int64_t utc_s = START_UTC_S + step_s; utc_s < END_UTC_S; utc_s += step_s) {
+            compare(utc_s, &gmtoff);
+            compared++;
+            if (gmtoff != previous_gmtoff) {
+                // Every second of the step that crossed the change, and a bit beyond
+                // 逐秒比较跨过偏移变化的这一步，并多比较一段
+                for (int64_t s = utc_s - step_s; s < utc_s + step_s; s++) {
+                    compare(s, &gmtoff);
+                    compared++;
+                }
+                changes++;
+                previous_gmtoff = gmtoff;
+            }
+        }
+    }
+
+    // The per-fix path at 10 Hz in the last zone, as the push task calls it
+    // 以推送任务的调用方式，在最后一个时区中测量 10 Hz 下每个定位的转换耗时
+    uint32_t year_month_day, hour_minute_second, sink = 0;
+    int64_t start_ns = now_ns();
+    for (int i = 0; i < TIMED_FIXES; i++) {
+        time_zone_logic_to_local(START_UTC_S + i / 10, &year_month_day, &hour_minute_second);
+        sink += hour_minute_second;
+    }
+    double per_fix_ns = (double)(now_ns() - start_ns) / TIMED_FIXES;
+
+    printf("time zone: 4 zones, 2007-2030, step %lld s\n", (long long)step_s);
+    printf("  compared        %llu instants, %u offset changes, %u mismatches\n", (unsigned long long)compared,
+           changes, s_mismatches);
+    printf("  conversion      %.1f ns per fix (%u)\n", per_fix_ns, sink % 10);
+
+    // Berlin and New York change twice a year
+    // 柏林与纽约每年变化两次
+    TEST_CHECK(changes == 2 * 24 * 2);
+    TEST_CHECK(s_mismatches == 0);
+    return TEST_EXIT_CODE();
+}
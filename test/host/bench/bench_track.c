@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Track log size on synthetic fixes: one hour at 10 Hz while driving and one while parked, passed
+ * through the Kalman filter like the firmware does before logging, then encoded into pages exactly as
+ * logic/track_logic.c fills them. Receiver error is modelled as a slow random walk (Gauss-Markov,
+ * 20 s correlation) of a given size plus 5 cm of white noise, at three sizes since it dominates the
+ * result. Reports bytes per fix and how long the track partition lasts.
+ *
+ * 合成定位下的轨迹日志大小：10 Hz 下行驶一小时、停放一小时，与固件一样先经过卡尔曼滤波再记录，并按
+ * logic/track_logic.c 的方式编码为页。接收机误差建模为给定幅度的缓慢随机游走（高斯-马尔可夫，相关时间 20 秒）
+ * 加 5 厘米白噪声，因其决定结果，取三种幅度。输出每个定位的字节数以及轨迹分区可保存的时长。
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "test_common.h"
+#include "gps_kalman.h"
+#include "track_codec.h"
+#include "track_logic.h"
+
+#define EPOCHS              36000       // One hour at 10 Hz
+                                        // 10 Hz 下一小时
+#define INTERVAL_US         100000
+#define SPEED_M_S           15.0
+#define CORRELATION_S       20.0
+#define WHITE_NOISE_M       0.05
+#define START_LAT           22.5
+#define START_LON           113.9
+#define START_TIME_MS       1741938420000LL
+#define METERS_PER_DEG      (6371000.0 * M_PI / 180.0)
+// Size of the "track" partition in partitions.csv
+// partitions.csv 中 "track" 分区的大小
+#define PARTITION_SIZE      0xC0000
+
+static uint64_t s_rng = 1;
+
+static double uniform(void) {
+    s_rng = s_rng * 6364136223846793005ULL + 1442695040888963407ULL;
+    return ((s_rng >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static double gauss(void) {
+    return sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform());
+}
+
+/* Pages as track_task() fills them: a full page or one older than TRACK_PAGE_MAX_AGE_S is written */
+/* 与 track_task() 相同的填页方式：页写满或超过 TRACK_PAGE_MAX_AGE_S 即写入 */
+typedef struct {
+    uint8_t payload[TRACK_PAGE_PAYLOAD_SIZE];
+    track_encoder_t enc;
+    int64_t page_started_ms;
+    uint32_t pages;
+} page_writer_t;
+
+static void page_writer_add(page_writer_t *writer, const track_point_t *point) {
+    if (writer->enc.length > 0 && point->time_ms - writer->page_started_ms > TRACK_PAGE_MAX_AGE_S * 1000LL) {
+        writer->pages++;
+        track_encoder_begin(&writer->enc, writer->payload, sizeof(writer->payload));
+    }
+    if (writer->enc.length == 0) {
+        writer->page_started_ms = point->time_ms;
+    }
+    if (!track_encoder_add(&writer->enc, point)) {
+        writer->pages++;
+        track_encoder_begin(&writer->enc, writer->payload, sizeof(writer->payload));
+        writer->page_started_ms = point->time_ms;
+        track_encoder_add(&writer->enc, point);
+    }
+}
+
+/**
+ * @brief Log one hour of fixes, returns flash bytes per fix including page headers and CRCs
+ *        记录一小时的定位，返回每个定位占用的 Flash 字节数（含页头与 CRC）
+ */
+static double bytes_per_fix(double speed_m_s, double error_m) {
+    const double meters_per_deg_lon = METERS_PER_DEG * cos(START_LAT * M_PI / 180.0);
+    const double decay = exp(-INTERVAL_US * 1e-6 / CORRELATION_S);
+    const double drive = error_m * sqrt(1 - decay * decay);
+    double north = 0, east = 0, error_north = error_m * gauss(), error_east = error_m * gauss(),
+           error_down = error_m * 1.5 * gauss();
+    static page_writer_t writer;
+    gps_kalman_t kf;
+
+    gps_kalman_init(&kf, 2.0f, 1.0f);
+    writer.pages = 0;
+    track_encoder_begin(&writer.enc, writer.payload, sizeof(writer.payload));
+    for (int i = 0; i < EPOCHS; i++) {
+        double time_s = i * (INTERVAL_US * 1e-6);
+        double heading = 0.3 * time_s / 60.0 + sin(time_s / 20.0);
+        double vel_north = speed_m_s * cos(heading), vel_east = speed_m_s * sin(heading);
+        north += vel_north * INTERVAL_US * 1e-6;
+        east += vel_east * INTERVAL_US * 1e-6;
+        error_north = decay * error_north + drive * gauss();
+        error_east = decay * error_east + drive * gauss();
+        error_down = decay * error_down + drive * 1.5 * gauss();
+
+        gps_kalman_measurement_t meas = {
+            .latitude = START_LAT + (north + error_north + WHITE_NOISE_M * gauss()) / METERS_PER_DEG,
+            .longitude = START_LON + (east + error_east + WHITE_NOISE_M * gauss()) / meters_per_deg_lon,
+            .altitude = 50.0 + error_down + WHITE_NOISE_M * gauss(),
+            .vel_north = (float)(vel_north + 0.05 * gauss()),
+            .vel_east = (float)(vel_east + 0.05 * gauss()),
+            .vel_down = (float)(0.05 * gauss()),
+            .pos_sigma_h = (float)(error_m + WHITE_NOISE_M),
+            .pos_sigma_v = (float)((error_m + WHITE_NOISE_M) * 1.5),
+            .vel_sigma_h = 0.05f,
+            .vel_sigma_v = 0.05f,
+        };
+        int64_t time_us = (int64_t)i * INTERVAL_US;
+        gps_kalman_state_t state;
+        gps_kalman_update(&kf, &meas, time_us);
+        gps_kalman_predict(&kf, time_us, &state);
+
+        // Conversion of track_logic_log_fix()
+        // 与 track_logic_log_fix() 相同的转换
+        track_point_t point = {
+            .time_ms = START_TIME_MS + time_us / 1000,
+            .latitude = (int32_t)lround(state.latitude * TRACK_COORD_SCALE),
+            .longitude = (int32_t)lround(state.longitude * TRACK_COORD_SCALE),
+            .altitude = (int32_t)lround(state.altitude * 10),
+        };
+        page_writer_add(&writer, &point);
+    }
+    return (writer.pages * (double)TRACK_PAGE_SIZE + writer.enc.length) / EPOCHS;
+}
+
+int main(void) {
+    static const double errors_m[] = { 0.5, 1.5, 3.0 };
+    const double partition_pages = PARTITION_SIZE / TRACK_PAGE_SIZE;
+
+    printf("track: 10 Hz, %u-byte pages, %u KB partition\n", TRACK_PAGE_SIZE, PARTITION_SIZE / 1024);
+    printf("  receiver error   moving B/fix   parked B/fix   motion kept   day with 25%% moving\n");
+    for (size_t i = 0; i < sizeof(errors_m) / sizeof(errors_m[0]); i++) {
+        double moving = bytes_per_fix(SPEED_M_S, errors_m[i]);
+        double parked = bytes_per_fix(0, errors_m[i]);
+        double motion_hours = partition_pages * TRACK_PAGE_SIZE / (moving * 36000);
+        double day_kb = (0.25 * moving + 0.75 * parked) * 864000 / 1024;
+        printf("  %5.1f m          %6.2f         %6.2f         %5.1f h       %5.0f KB\n", errors_m[i], moving,
+               parked, motion_hours, day_kb);
+
+        // Far below the 20 bytes of a raw point, parked costs less than moving
+        // 远小于原始点的 20 字节，停放的开销低于行驶
+        TEST_CHECK(moving < 5.0);
+        TEST_CHECK(parked < moving);
+    }
+    return TEST_EXIT_CODE();
+}
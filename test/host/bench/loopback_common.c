@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+
+#include "loopback_common.h"
+#include "ble_loopback.h"
+#include "data.h"
+#include "connect_logic.h"
+#include "command_logic.h"
+#include "pairing_logic.h"
+#include "enums_logic.h"
+#include "rule_logic.h"
+#include "dji_protocol_data_structures.h"
+
+volatile uint32_t g_peer_frames[BLE_MAX_LINKS];
+volatile uint32_t g_peer_gps_frames[BLE_MAX_LINKS];
+volatile int64_t g_peer_record_us[BLE_MAX_LINKS];
+volatile bool g_ignore_reconnect;
+volatile bool g_drop_on_reconnect;
+volatile bool g_ignore_record;
+
+/* The rule engine is not part of these benches, status_logic.c only feeds it */
+/* 规则引擎不在这些基准范围内，status_logic.c 只是向它输入数据 */
+void rule_logic_set_input(rule_input_t input, int32_t value) {
+    (void)input;
+    (void)value;
+}
+
+static bool is_frame_cmd(const uint8_t *data, size_t length, uint8_t cmd_set, uint8_t cmd_id) {
+    // CmdType bit 5 marks a response, CmdSet and CmdID follow the 12-byte header
+    // CmdType 第 5 位表示应答，CmdSet 与 CmdID 紧跟 12 字节帧头
+    return length > 14 && !(data[3] & 0x20) && data[12] == cmd_set && data[13] == cmd_id;
+}
+
+/**
+ * @brief Camera side of the benches, counts the frames and passes them to the built-in camera
+ *        基准使用的相机端，统计帧数后交给内置相机
+ */
+static void bench_peer(int link, const uint8_t *data, size_t length) {
+    g_peer_frames[link]++;
+    if (is_frame_cmd(data, length, 0x00, 0x17)) {
+        g_peer_gps_frames[link]++;
+    }
+    if (is_frame_cmd(data, length, 0x1D, 0x03)) {
+        g_peer_record_us[link] = esp_timer_get_time();
+        if (g_ignore_record) {
+            return;
+        }
+    }
+    // verify_mode sits after device_id, mac_addr_len, mac_addr, fw_version and reserved
+    // verify_mode 位于 device_id、mac_addr_len、mac_addr、fw_version 和 reserved 之后
+    if ((g_ignore_reconnect || g_drop_on_reconnect) && is_frame_cmd(data, length, 0x00, 0x19) &&
+        length > 14 + 4 + 1 + 16 + 4 + 1 && data[14 + 4 + 1 + 16 + 4 + 1] == VERIFY_MODE_RECONNECT) {
+        if (g_drop_on_reconnect) {
+            ble_loopback_drop_link(link);
+        }
+        return;
+    }
+    ble_loopback_camera_peer(link, data, length);
+}
+
+/**
+ * @brief Start the data layer and connect_logic on the loopback
+ *        在回环上启动数据层与 connect_logic
+ *
+ * @return int Returns 0 on success, -1 on failure
+ *             返回 0 表示成功，-1 表示失败
+ */
+int loopback_init(void) {
+    // protocol_create_frame() prints every frame length, the benches report on stderr instead
+    // protocol_create_frame() 会打印每帧长度，基准结果改为输出到 stderr
+    if (freopen("/dev/null", "w", stdout) == NULL) {
+        return -1;
+    }
+
+    ble_loopback_set_peer(bench_peer);
+    loopback_configure(1000, 0, 0, 247, 0);
+    data_init();
+    if (connect_logic_ble_init() != 0) {
+        fprintf(stderr, "connect_logic_ble_init failed\n");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Set the link behaviour of the loopback
+ *        设置回环的链路行为
+ */
+void loopback_configure(uint32_t latency_us, uint32_t jitter_us, uint16_t loss_per_mille, uint16_t mtu,
+                        uint32_t approval_ms) {
+    ble_loopback_config_t config = {
+        .latency_us = latency_us,
+        .jitter_us = jitter_us,
+        .loss_per_mille = loss_per_mille,
+        .mtu = mtu,
+        .approval_ms = approval_ms,
+    };
+    ble_loopback_set_config(&config);
+}
+
+/**
+ * @brief Open a link connect_logic does not manage, without a profile the link keeps the default 30 ms interval
+ *        打开一条不由 connect_logic 管理的链路，未设置配置时保持默认的 30 ms 连接间隔
+ */
+bool loopback_open_raw_link(int link, bool set_profile, ble_link_profile_t profile) {
+    if (ble_transport_open(link, true) != ESP_OK ||
+        !(ble_transport_wait_events(link, BLE_EVENT_HANDLES_READY, pdMS_TO_TICKS(1000)) & BLE_EVENT_HANDLES_READY) ||
+        ble_transport_enable_notify(link) != ESP_OK) {
+        fprintf(stderr, "link %d: open failed\n", link);
+        return false;
+    }
+    if (set_profile) {
+        ble_transport_set_link_profile(link, profile);
+    }
+    // Let the parameter update reach the camera before measuring
+    // 测量前等待连接参数更新生效
+    vTaskDelay(pdMS_TO_TICKS(300));
+    return true;
+}
+
+void loopback_close_raw_link(int link) {
+    ble_transport_close(link);
+    vTaskDelay(pdMS_TO_TICKS(100));
+}
+
+static uint16_t s_seq = 0x1000;
+
+/**
+ * @brief Send one record command and wait for its response
+ *        发送一条拍录命令并等待应答
+ */
+bool loopback_record_round_trip(int link, int timeout_ms, double *rtt_ms) {
+    uint16_t seq = s_seq++;
+    size_t length = 0;
+    uint8_t *frame = command_logic_create_record_frame(true, seq, &length);
+    if (frame == NULL) {
+        return false;
+    }
+
+    int64_t start = esp_timer_get_time();
+    bool ok = false;
+    if (data_write_with_response(link, seq, frame, length) == ESP_OK) {
+        void *result = NULL;
+        size_t result_length = 0;
+        if (data_wait_for_result_by_seq(link, seq, timeout_ms, &result, &result_length) == ESP_OK) {
+            ok = true;
+            free(result);
+        }
+    }
+    *rtt_ms = (esp_timer_get_time() - start) / 1000.0;
+    free(frame);
+    return ok;
+}
+
+/**
+ * @brief Connect a camera through connect_logic, as key_logic.c connect_camera() does
+ *        通过 connect_logic 连接相机，与 key_logic.c 的 connect_camera() 相同
+ *
+ * @param use_pairing Use the stored pairing of the camera when there is one
+ *                    存在保存的配对时使用该配对
+ * @param out_mode Receives the verify_mode used
+ *                 接收所用的 verify_mode
+ * @param out_ms Receives the time connect_logic_protocol_connect() took
+ *               接收 connect_logic_protocol_connect() 的耗时
+ * @return int 0 on success, -2 when the link did not come up, else the connect_logic_protocol_connect() result
+ *             成功返回 0，链路未建立返回 -2，否则为 connect_logic_protocol_connect() 的返回值
+ */
+int loopback_connect_camera(int link, bool use_pairing, uint8_t *out_mode, double *out_ms) {
+    *out_mode = VERIFY_MODE_FIRST_PAIRING;
+    *out_ms = 0;
+    if (connect_logic_ble_connect(link) != 0) {
+        return -2;
+    }
+
+    uint32_t device_id = 0x12345703;
+    uint8_t mac_addr_len = 6;
+    int8_t mac_addr[16] = {0x38, 0x34, 0x56, 0x78, 0x9A, 0xBC};
+    uint32_t fw_version = 0;
+    uint8_t verify_mode = VERIFY_MODE_FIRST_PAIRING;
+    uint16_t verify_data = (uint16_t)(esp_random() % 10000);
+    uint8_t camera_reserved = 0;
+
+    uint8_t camera_addr[6];
+    pairing_record_t record;
+    if (use_pairing && ble_transport_get_peer_addr(link, camera_addr) == ESP_OK &&
+        pairing_logic_load(camera_addr, &record) == ESP_OK) {
+        device_id = record.device_id;
+        mac_addr_len = record.mac_addr_len;
+        memcpy(mac_addr, record.mac_addr, mac_addr_len);
+        fw_version = record.fw_version;
+        verify_mode = VERIFY_MODE_RECONNECT;
+        verify_data = record.verify_data;
+        camera_reserved = record.camera_reserved;
+    }
+
+    int64_t start = esp_timer_get_time();
+    int ret = connect_logic_protocol_connect(link, device_id, mac_addr_len, mac_addr, fw_version, verify_mode,
+                                             verify_data, camera_reserved);
+    *out_ms = (esp_timer_get_time() - start) / 1000.0;
+    *out_mode = verify_mode;
+    return ret;
+}
+
+void loopback_disconnect_camera(int link) {
+    connect_logic_ble_disconnect(link);
+    vTaskDelay(pdMS_TO_TICKS(50));
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __LOOPBACK_COMMON_H__
+#define __LOOPBACK_COMMON_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ble_transport.h"
+
+/*
+ * Shared harness of the loopback benches: data.c, the protocol layer and the connect, command and
+ * pairing logic run unchanged on the pthread shim, with the camera of ble_loopback.c on the other end.
+ * The numbers depend on the host, the checks only on behaviour.
+ *
+ * 回环基准的公共部分：data.c、协议层以及连接、命令和配对逻辑原样运行在 pthread 适配层上，
+ * 另一端是 ble_loopback.c 的相机。数值随主机而变，检查只针对行为。
+ */
+
+/* Frames the camera side rebuilt per link, GPS pushes counted apart */
+/* 相机端按链路重组出的帧数，GPS 推送单独计数 */
+extern volatile uint32_t g_peer_frames[BLE_MAX_LINKS];
+extern volatile uint32_t g_peer_gps_frames[BLE_MAX_LINKS];
+
+/* esp_timer time the camera side last received a record command per link */
+/* 相机端每条链路最近一次收到拍录命令的 esp_timer 时间 */
+extern volatile int64_t g_peer_record_us[BLE_MAX_LINKS];
+
+/* When set, the camera never answers a connection request in reconnection mode */
+/* 置位时相机不应答重连模式的连接请求 */
+extern volatile bool g_ignore_reconnect;
+
+/* When set, the camera drops the link instead of answering a connection request in reconnection mode */
+/* 置位时相机不应答重连模式的连接请求，而是断开链路 */
+extern volatile bool g_drop_on_reconnect;
+
+/* When set, the camera never answers a record command */
+/* 置位时相机不应答拍录命令 */
+extern volatile bool g_ignore_record;
+
+int loopback_init(void);
+
+void loopback_configure(uint32_t latency_us, uint32_t jitter_us, uint16_t loss_per_mille, uint16_t mtu,
+                        uint32_t approval_ms);
+
+bool loopback_open_raw_link(int link, bool set_profile, ble_link_profile_t profile);
+
+void loopback_close_raw_link(int link);
+
+bool loopback_record_round_trip(int link, int timeout_ms, double *rtt_ms);
+
+int loopback_connect_camera(int link, bool use_pairing, uint8_t *out_mode, double *out_ms);
+
+void loopback_disconnect_camera(int link);
+
+#endif
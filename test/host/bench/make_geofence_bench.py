@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 DJI
+# SPDX-License-Identifier: MIT
+"""
+Generate the fence descriptions of bench_geofence for tools/geofence_builder.py.
+生成 bench_geofence 使用的围栏描述，供 tools/geofence_builder.py 使用。
+
+    python3 test/host/bench/make_geofence_bench.py --cell-m 200 -o fences_200.json
+    python3 test/host/bench/make_geofence_bench.py --pileup -o fences_pileup.json
+
+1000 fences with a fixed seed, half circles (radius 20-150 m) and half star-shaped polygons with
+4-32 vertices (30-150 m), spread over 10 km x 10 km around Shenzhen. With --pileup they all share
+one centre instead, the worst case for a single cell.
+固定种子生成 1000 个围栏，一半为圆形（半径 20-150 米），一半为 4-32 个顶点的星形多边形（30-150 米），分布在深圳附近
+10 千米 x 10 千米范围内。使用 --pileup 时所有围栏共用同一中心，即单个网格单元的最坏情况。
+"""
+
+import argparse
+import json
+import math
+import random
+
+CENTER_LAT = 22.54
+CENTER_LON = 113.95
+AREA_M = 10000.0
+FENCES = 1000
+METERS_PER_DEGREE = 6378137.0 * math.pi / 180.0
+
+
+def offset(lat, lon, north_m, east_m):
+    return [lat + north_m / METERS_PER_DEGREE,
+            lon + east_m / (METERS_PER_DEGREE * math.cos(math.radians(lat)))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--cell-m", type=float, default=200.0, help="grid cell size (m)")
+    parser.add_argument("--pileup", action="store_true", help="all fences on one centre")
+    parser.add_argument("-o", "--output", required=True, help="JSON file to write")
+    args = parser.parse_args()
+
+    rng = random.Random(38)
+    fences = []
+    for i in range(FENCES):
+        if args.pileup:
+            lat, lon = CENTER_LAT, CENTER_LON
+        else:
+            lat, lon = offset(CENTER_LAT, CENTER_LON, rng.uniform(-AREA_M / 2, AREA_M / 2),
+                              rng.uniform(-AREA_M / 2, AREA_M / 2))
+        fence = {"enter": "start_record", "exit": "stop_record", "hysteresis_m": rng.uniform(2.0, 10.0)}
+        if i % 2 == 0:
+            fence["circle"] = [lat, lon, rng.uniform(20.0, 150.0)]
+        else:
+            radius = rng.uniform(30.0, 150.0)
+            angles = sorted(rng.uniform(0, 2 * math.pi) for _ in range(rng.randint(4, 32)))
+            fence["polygon"] = [offset(lat, lon, r * math.cos(a), r * math.sin(a))
+                                for a, r in ((a, radius * rng.uniform(0.6, 1.0)) for a in angles)]
+        fences.append(fence)
+
+    with open(args.output, "w") as f:
+        json.dump({"cell_m": args.cell_m, "fences": fences}, f)
+
+
+if __name__ == "__main__":
+    main()
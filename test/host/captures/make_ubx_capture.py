@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 DJI
+# SPDX-License-Identifier: MIT
+"""
+Generate ubx_nav_pvt_walk.ubx, the UBX replay input of test_gps_replay.
+生成 ubx_nav_pvt_walk.ubx，即 test_gps_replay 的 UBX 回放输入。
+
+    python3 test/host/captures/make_ubx_capture.py -o test/host/captures/ubx_nav_pvt_walk.ubx
+
+No UBX receiver recording is available for this board, so the stream is generated: it continues the
+real NMEA epoch of nmea_readme_epoch.nmea (README_CN.md) at 10 Hz, with the byte layout a u-blox
+receiver sends on UART1 after CFG-PRT/CFG-RATE/CFG-MSG: the NMEA epoch still queued from before the
+switch, an ACK-ACK per configuration message, then one NAV-PVT per epoch.
+Replace it with a real capture (same name, raw UART bytes) when one is taken.
+本板没有 UBX 接收机的录制数据，因此该数据流为生成数据：以 10 Hz 延续 nmea_readme_epoch.nmea（README_CN.md）中
+的真实 NMEA 历元，字节排列与 u-blox 接收机在 CFG-PRT/CFG-RATE/CFG-MSG 之后从 UART1 输出的一致：切换前尚在队列中的
+NMEA 历元、每条配置消息一个 ACK-ACK，之后每个历元一包 NAV-PVT。
+录得真实数据（同名文件，原始串口字节）后直接替换。
+"""
+
+import argparse
+import math
+import os
+import struct
+
+EPOCHS = 20
+INTERVAL_MS = 100
+
+# The README epoch: 2025-01-15 07:47:00 UTC, 1.67 kn towards 285.57 deg
+# README 中的历元：2025-01-15 07:47:00 UTC，1.67 节，航向 285.57 度
+START_LAT = 22 + 34.732734 / 60
+START_LON = 113 + 56.317512 / 60
+H_MSL_MM = 47379
+GEOID_MM = -2657
+SPEED_MM_S = round(1.67 * 514.444)
+COURSE_DEG = 285.57
+I_TOW_START_MS = 3 * 86400000 + (7 * 3600 + 47 * 60 + 18) * 1000   # Wednesday, 18 leap seconds
+                                                                      # 周三，18 个闰秒
+EARTH_RADIUS_M = 6378137.0
+
+
+def ubx_frame(msg_class, msg_id, payload):
+    body = struct.pack('<BBH', msg_class, msg_id, len(payload)) + payload
+    ck_a = ck_b = 0
+    for byte in body:
+        ck_a = (ck_a + byte) & 0xFF
+        ck_b = (ck_b + ck_a) & 0xFF
+    return b'\xb5\x62' + body + bytes([ck_a, ck_b])
+
+
+def nav_pvt(epoch):
+    elapsed_s = epoch * INTERVAL_MS / 1000
+    vel_n = SPEED_MM_S * math.cos(math.radians(COURSE_DEG))
+    vel_e = SPEED_MM_S * math.sin(math.radians(COURSE_DEG))
+    lat = START_LAT + math.degrees(vel_n / 1000 * elapsed_s / EARTH_RADIUS_M)
+    lon = START_LON + math.degrees(vel_e / 1000 * elapsed_s / (EARTH_RADIUS_M * math.cos(math.radians(START_LAT))))
+    millis = epoch * INTERVAL_MS
+    return struct.pack(
+        '<IHBBBBBBIiBBBBiiiiIIiiiiiIIHB5sihH',
+        I_TOW_START_MS + millis,
+        2025, 1, 15, 7, 47, millis // 1000,
+        0x07,                                   # validDate | validTime | fullyResolved
+        25,
+        (millis % 1000) * 1000000,
+        3,                                      # 3D fix
+        0x01,                                   # gnssFixOK
+        0xE0,
+        7,
+        round(lon * 1e7), round(lat * 1e7),
+        H_MSL_MM + GEOID_MM, H_MSL_MM,
+        1800, 2600,                             # hAcc, vAcc (mm)
+        round(vel_n), round(vel_e), 0,
+        SPEED_MM_S, round(COURSE_DEG * 1e5),
+        350,                                    # sAcc (mm/s)
+        1200000,
+        131,
+        0, bytes(5), 0, 0, 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('-o', '--output', required=True)
+    args = parser.parse_args()
+
+    with open(os.path.join(os.path.dirname(os.path.abspath(__file__)), 'nmea_readme_epoch.nmea'), 'rb') as nmea:
+        stream = nmea.read()
+    for cfg_id in (0x00, 0x08, 0x01):           # CFG-PRT, CFG-RATE, CFG-MSG
+        stream += ubx_frame(0x05, 0x01, bytes([0x06, cfg_id]))
+    for epoch in range(1, EPOCHS + 1):
+        stream += ubx_frame(0x01, 0x07, nav_pvt(epoch))
+
+    with open(args.output, 'wb') as output:
+        output.write(stream)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __HOST_DRIVER_UART_H__
+#define __HOST_DRIVER_UART_H__
+
+#include "host_shim.h"
+#include "driver/gpio.h"
+
+/*
+ * Host UART: received bytes are injected by the test and announced on the driver event queue like
+ * the RX interrupt does, written bytes are kept for the test to read back. Line settings are ignored.
+ * 主机串口：接收的字节由测试注入，并像接收中断一样通过驱动事件队列通知；写出的字节保留给测试读取。忽略线路参数。
+ */
+
+typedef int uart_port_t;
+
+#define UART_NUM_0              0
+#define UART_NUM_1              1
+#define LP_UART_NUM_0           2
+#define UART_NUM_MAX            3
+
+#define UART_PIN_NO_CHANGE      (-1)
+
+// Bytes per UART_DATA event, the RX FIFO full threshold of the driver
+// 每个 UART_DATA 事件的字节数，即驱动的接收 FIFO 满阈值
+#define HOST_UART_FIFO_FULL     120
+
+typedef enum {
+    UART_DATA,
+    UART_BREAK,
+    UART_BUFFER_FULL,
+    UART_FIFO_OVF,
+    UART_FRAME_ERR,
+    UART_PARITY_ERR,
+    UART_DATA_BREAK,
+    UART_PATTERN_DET,
+    UART_EVENT_MAX,
+} uart_event_type_t;
+
+typedef struct {
+    uart_event_type_t type;
+    size_t size;
+    bool timeout_flag;
+} uart_event_t;
+
+typedef enum { UART_DATA_5_BITS, UART_DATA_6_BITS, UART_DATA_7_BITS, UART_DATA_8_BITS } uart_word_length_t;
+typedef enum { UART_PARITY_DISABLE, UART_PARITY_EVEN = 2, UART_PARITY_ODD } uart_parity_t;
+typedef enum { UART_STOP_BITS_1 = 1, UART_STOP_BITS_1_5, UART_STOP_BITS_2 } uart_stop_bits_t;
+typedef enum { UART_HW_FLOWCTRL_DISABLE } uart_hw_flowcontrol_t;
+typedef enum { UART_SCLK_DEFAULT, LP_UART_SCLK_DEFAULT = UART_SCLK_DEFAULT } uart_sclk_t;
+
+typedef struct {
+    int baud_rate;
+    uart_word_length_t data_bits;
+    uart_parity_t parity;
+    uart_stop_bits_t stop_bits;
+    uart_hw_flowcontrol_t flow_ctrl;
+    uint8_t rx_flow_ctrl_thresh;
+    uart_sclk_t source_clk;
+} uart_config_t;
+
+esp_err_t uart_driver_install(uart_port_t port, int rx_buffer_size, int tx_buffer_size, int queue_size,
+                              QueueHandle_t *out_queue, int intr_alloc_flags);
+esp_err_t uart_param_config(uart_port_t port, const uart_config_t *config);
+esp_err_t uart_set_pin(uart_port_t port, int tx_pin, int rx_pin, int rts_pin, int cts_pin);
+esp_err_t uart_set_rx_timeout(uart_port_t port, uint8_t timeout_symbols);
+esp_err_t uart_set_baudrate(uart_port_t port, uint32_t baud_rate);
+int uart_read_bytes(uart_port_t port, void *buffer, uint32_t length, TickType_t timeout);
+int uart_write_bytes(uart_port_t port, const void *data, size_t length);
+esp_err_t uart_wait_tx_done(uart_port_t port, TickType_t timeout);
+esp_err_t uart_flush_input(uart_port_t port);
+
+// Test side: deliver one burst of receiver output, the last event carries the RX timeout
+// 测试侧：送入一批接收机输出，最后一个事件带接收超时标志
+esp_err_t host_uart_inject(uart_port_t port, const void *data, size_t length);
+
+// Test side: take the bytes written since the last call, returns the number copied
+// 测试侧：取出自上次调用以来写出的字节，返回拷贝的字节数
+size_t host_uart_take_written(uart_port_t port, void *out, size_t size);
+
+uint32_t host_uart_get_baudrate(uart_port_t port);
+
+#endif
@@ -0,0 +1,735 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "host_shim.h"
+#include "nvs.h"
+
+int host_log_level = 1;
+
+/* Time */
+
+static int64_t monotonic_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static int64_t s_start_us;
+
+__attribute__((constructor)) static void host_shim_start(void) {
+    s_start_us = monotonic_us();
+}
+
+int64_t esp_timer_get_time(void) {
+    return monotonic_us() - s_start_us;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(esp_timer_get_time() / 1000);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    struct timespec delay = { .tv_sec = ticks / 1000, .tv_nsec = (long)(ticks % 1000) * 1000000 };
+    nanosleep(&delay, NULL);
+}
+
+void taskYIELD(void) {
+    sched_yield();
+}
+
+void vTaskDelayUntil(TickType_t *previous_wake, TickType_t period) {
+    *previous_wake += period;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*previous_wake - now) > 0) {
+        vTaskDelay(*previous_wake - now);
+    }
+}
+
+// Absolute CLOCK_REALTIME deadline for pthread_cond_timedwait
+// pthread_cond_timedwait 使用的 CLOCK_REALTIME 绝对截止时间
+static void deadline_after_us(struct timespec *deadline, int64_t timeout_us) {
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += timeout_us / 1000000;
+    deadline->tv_nsec += (long)(timeout_us % 1000000) * 1000;
+    if (deadline->tv_nsec >= 1000000000) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000;
+    }
+}
+
+/* Semaphores */
+
+struct host_semaphore {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    UBaseType_t count;
+    UBaseType_t max_count;
+};
+
+static SemaphoreHandle_t semaphore_create(UBaseType_t initial_count, UBaseType_t max_count) {
+    SemaphoreHandle_t semaphore = calloc(1, sizeof(*semaphore));
+    if (semaphore == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&semaphore->mutex, NULL);
+    pthread_cond_init(&semaphore->cond, NULL);
+    semaphore->count = initial_count;
+    semaphore->max_count = max_count;
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return semaphore_create(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return semaphore_create(0, 1);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t timeout) {
+    struct timespec deadline;
+    if (timeout != portMAX_DELAY) {
+        deadline_after_us(&deadline, (int64_t)timeout * 1000);
+    }
+    pthread_mutex_lock(&semaphore->mutex);
+    while (semaphore->count == 0) {
+        if (timeout == 0) {
+            break;
+        }
+        if (timeout == portMAX_DELAY) {
+            pthread_cond_wait(&semaphore->cond, &semaphore->mutex);
+        } else if (pthread_cond_timedwait(&semaphore->cond, &semaphore->mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    BaseType_t taken = semaphore->count > 0 ? pdTRUE : pdFALSE;
+    if (taken) {
+        semaphore->count--;
+    }
+    pthread_mutex_unlock(&semaphore->mutex);
+    return taken;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    pthread_mutex_lock(&semaphore->mutex);
+    BaseType_t given = semaphore->count < semaphore->max_count ? pdTRUE : pdFALSE;
+    if (given) {
+        semaphore->count++;
+        pthread_cond_signal(&semaphore->cond);
+    }
+    pthread_mutex_unlock(&semaphore->mutex);
+    return given;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    if (semaphore == NULL) {
+        return;
+    }
+    pthread_cond_destroy(&semaphore->cond);
+    pthread_mutex_destroy(&semaphore->mutex);
+    free(semaphore);
+}
+
+/* Queues */
+
+struct host_queue {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t count;
+    UBaseType_t head;
+    uint8_t *items;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    QueueHandle_t queue = calloc(1, sizeof(*queue));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->items = calloc(length, item_size);
+    if (queue->items == NULL) {
+        free(queue);
+        return NULL;
+    }
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->cond, NULL);
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+// Wait until the queue is not full (send) or not empty (receive), with the mutex held
+// 持有互斥锁，等待队列非满（发送）或非空（接收）
+static bool queue_wait(QueueHandle_t queue, bool send, TickType_t timeout) {
+    struct timespec deadline;
+    if (timeout != portMAX_DELAY) {
+        deadline_after_us(&deadline, (int64_t)timeout * 1000);
+    }
+    while (send ? queue->count == queue->length : queue->count == 0) {
+        if (timeout == 0) {
+            return false;
+        }
+        if (timeout == portMAX_DELAY) {
+            pthread_cond_wait(&queue->cond, &queue->mutex);
+        } else if (pthread_cond_timedwait(&queue->cond, &queue->mutex, &deadline) == ETIMEDOUT) {
+            return send ? queue->count < queue->length : queue->count > 0;
+        }
+    }
+    return true;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t timeout) {
+    pthread_mutex_lock(&queue->mutex);
+    bool sent = queue_wait(queue, true, timeout);
+    if (sent) {
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(queue->items + tail * queue->item_size, item, queue->item_size);
+        queue->count++;
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return sent ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *out_item, TickType_t timeout) {
+    pthread_mutex_lock(&queue->mutex);
+    bool received = queue_wait(queue, false, timeout);
+    if (received) {
+        memcpy(out_item, queue->items + queue->head * queue->item_size, queue->item_size);
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return received ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->mutex);
+    queue->count = 0;
+    queue->head = 0;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->mutex);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->mutex);
+    return count;
+}
+
+/* Event groups */
+
+struct host_event_group {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    EventBits_t bits;
+};
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    EventGroupHandle_t group = calloc(1, sizeof(*group));
+    if (group == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&group->mutex, NULL);
+    pthread_cond_init(&group->cond, NULL);
+    return group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    pthread_mutex_lock(&group->mutex);
+    group->bits |= bits;
+    EventBits_t result = group->bits;
+    pthread_cond_broadcast(&group->cond);
+    pthread_mutex_unlock(&group->mutex);
+    return result;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+    pthread_mutex_lock(&group->mutex);
+    EventBits_t result = group->bits;
+    group->bits &= ~bits;
+    pthread_mutex_unlock(&group->mutex);
+    return result;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+    pthread_mutex_lock(&group->mutex);
+    EventBits_t result = group->bits;
+    pthread_mutex_unlock(&group->mutex);
+    return result;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t timeout) {
+    struct timespec deadline;
+    if (timeout != portMAX_DELAY) {
+        deadline_after_us(&deadline, (int64_t)timeout * 1000);
+    }
+    pthread_mutex_lock(&group->mutex);
+    bool satisfied;
+    while (1) {
+        satisfied = wait_for_all ? (group->bits & bits) == bits : (group->bits & bits) != 0;
+        if (satisfied || timeout == 0) {
+            break;
+        }
+        if (timeout == portMAX_DELAY) {
+            pthread_cond_wait(&group->cond, &group->mutex);
+        } else if (pthread_cond_timedwait(&group->cond, &group->mutex, &deadline) == ETIMEDOUT) {
+            satisfied = wait_for_all ? (group->bits & bits) == bits : (group->bits & bits) != 0;
+            break;
+        }
+    }
+    EventBits_t result = group->bits;
+    if (satisfied && clear_on_exit) {
+        group->bits &= ~bits;
+    }
+    pthread_mutex_unlock(&group->mutex);
+    return result;
+}
+
+/* Tasks, one detached thread each, the notification value is a binary semaphore */
+/* 任务，每个为一个分离线程，通知值为二值信号量 */
+
+struct host_task {
+    pthread_t thread;
+    TaskFunction_t function;
+    void *arg;
+    SemaphoreHandle_t notification;
+};
+
+static __thread TaskHandle_t s_current_task;
+
+static void *task_entry(void *arg) {
+    s_current_task = arg;
+    s_current_task->function(s_current_task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *out_handle) {
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+    TaskHandle_t task = calloc(1, sizeof(*task));
+    if (task == NULL) {
+        return pdFAIL;
+    }
+    task->function = function;
+    task->arg = arg;
+    task->notification = xSemaphoreCreateBinary();
+    if (out_handle != NULL) {
+        *out_handle = task;
+    }
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0) {
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    return pdPASS;
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+    xSemaphoreGive(task->notification);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t timeout) {
+    (void)clear_on_exit;
+    if (s_current_task == NULL) {
+        // The main thread, not created by xTaskCreate
+        // 主线程，并非由 xTaskCreate 创建
+        s_current_task = calloc(1, sizeof(*s_current_task));
+        s_current_task->notification = xSemaphoreCreateBinary();
+    }
+    return xSemaphoreTake(s_current_task->notification, timeout) == pdTRUE ? 1 : 0;
+}
+
+/* Software timers */
+
+struct host_sw_timer {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    TickType_t period;
+    bool auto_reload;
+    bool running;
+    void *id;
+    TimerCallbackFunction_t callback;
+};
+
+static void *sw_timer_thread(void *arg) {
+    TimerHandle_t timer = arg;
+    pthread_mutex_lock(&timer->mutex);
+    while (1) {
+        if (!timer->running) {
+            pthread_cond_wait(&timer->cond, &timer->mutex);
+            continue;
+        }
+        struct timespec deadline;
+        deadline_after_us(&deadline, (int64_t)timer->period * 1000);
+        if (pthread_cond_timedwait(&timer->cond, &timer->mutex, &deadline) != ETIMEDOUT || !timer->running) {
+            continue;
+        }
+        timer->running = timer->auto_reload;
+        pthread_mutex_unlock(&timer->mutex);
+        timer->callback(timer);
+        pthread_mutex_lock(&timer->mutex);
+    }
+    return NULL;
+}
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload, void *id,
+                           TimerCallbackFunction_t callback) {
+    (void)name;
+    TimerHandle_t timer = calloc(1, sizeof(*timer));
+    if (timer == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&timer->mutex, NULL);
+    pthread_cond_init(&timer->cond, NULL);
+    timer->period = period;
+    timer->auto_reload = auto_reload != 0;
+    timer->id = id;
+    timer->callback = callback;
+    pthread_t thread;
+    pthread_create(&thread, NULL, sw_timer_thread, timer);
+    pthread_detach(thread);
+    return timer;
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t wait) {
+    (void)wait;
+    pthread_mutex_lock(&timer->mutex);
+    timer->running = true;
+    pthread_cond_signal(&timer->cond);
+    pthread_mutex_unlock(&timer->mutex);
+    return pdPASS;
+}
+
+/* esp_timer */
+
+struct esp_timer {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int64_t due_us;             // -1 when stopped
+                                // 停止时为 -1
+    void (*callback)(void *arg);
+    void *arg;
+};
+
+static void *esp_timer_thread(void *arg) {
+    esp_timer_handle_t timer = arg;
+    pthread_mutex_lock(&timer->mutex);
+    while (1) {
+        if (timer->due_us < 0) {
+            pthread_cond_wait(&timer->cond, &timer->mutex);
+            continue;
+        }
+        int64_t remaining_us = timer->due_us - esp_timer_get_time();
+        if (remaining_us > 0) {
+            struct timespec deadline;
+            deadline_after_us(&deadline, remaining_us);
+            pthread_cond_timedwait(&timer->cond, &timer->mutex, &deadline);
+            continue;
+        }
+        timer->due_us = -1;
+        pthread_mutex_unlock(&timer->mutex);
+        timer->callback(timer->arg);
+        pthread_mutex_lock(&timer->mutex);
+    }
+    return NULL;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle) {
+    esp_timer_handle_t timer = calloc(1, sizeof(*timer));
+    if (timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    pthread_mutex_init(&timer->mutex, NULL);
+    pthread_cond_init(&timer->cond, NULL);
+    timer->due_us = -1;
+    timer->callback = args->callback;
+    timer->arg = args->arg;
+    pthread_t thread;
+    pthread_create(&thread, NULL, esp_timer_thread, timer);
+    pthread_detach(thread);
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    pthread_mutex_lock(&timer->mutex);
+    timer->due_us = esp_timer_get_time() + (int64_t)timeout_us;
+    pthread_cond_signal(&timer->cond);
+    pthread_mutex_unlock(&timer->mutex);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    pthread_mutex_lock(&timer->mutex);
+    esp_err_t ret = timer->due_us >= 0 ? ESP_OK : ESP_ERR_INVALID_STATE;
+    timer->due_us = -1;
+    pthread_cond_signal(&timer->cond);
+    pthread_mutex_unlock(&timer->mutex);
+    return ret;
+}
+
+/* esp_log levels, "*" sets the default and drops every per-tag level like ESP-IDF does */
+/* esp_log 级别，"*" 设置默认级别并与 ESP-IDF 一样清除所有按标签设置的级别 */
+
+#define HOST_LOG_MAX_TAGS   16
+
+static pthread_mutex_t s_log_mutex = PTHREAD_MUTEX_INITIALIZER;
+static esp_log_level_t s_log_default_level = ESP_LOG_INFO;
+static struct {
+    const char *tag;
+    esp_log_level_t level;
+} s_log_levels[HOST_LOG_MAX_TAGS];
+
+void esp_log_level_set(const char *tag, esp_log_level_t level) {
+    pthread_mutex_lock(&s_log_mutex);
+    if (strcmp(tag, "*") == 0) {
+        s_log_default_level = level;
+        memset(s_log_levels, 0, sizeof(s_log_levels));
+    } else {
+        int free_slot = -1;
+        int i;
+        for (i = 0; i < HOST_LOG_MAX_TAGS; i++) {
+            if (s_log_levels[i].tag != NULL && strcmp(s_log_levels[i].tag, tag) == 0) {
+                break;
+            }
+            if (s_log_levels[i].tag == NULL && free_slot < 0) {
+                free_slot = i;
+            }
+        }
+        if (i == HOST_LOG_MAX_TAGS) {
+            i = free_slot;
+        }
+        if (i >= 0) {
+            s_log_levels[i].tag = tag;
+            s_log_levels[i].level = level;
+        }
+    }
+    pthread_mutex_unlock(&s_log_mutex);
+}
+
+esp_log_level_t esp_log_level_get(const char *tag) {
+    pthread_mutex_lock(&s_log_mutex);
+    esp_log_level_t level = s_log_default_level;
+    for (int i = 0; i < HOST_LOG_MAX_TAGS; i++) {
+        if (s_log_levels[i].tag != NULL && strcmp(s_log_levels[i].tag, tag) == 0) {
+            level = s_log_levels[i].level;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_log_mutex);
+    return level;
+}
+
+static vprintf_like_t s_log_vprintf = vprintf;
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func) {
+    pthread_mutex_lock(&s_log_mutex);
+    vprintf_like_t previous = s_log_vprintf;
+    s_log_vprintf = func;
+    pthread_mutex_unlock(&s_log_mutex);
+    return previous;
+}
+
+int host_log_write(const char *format, ...) {
+    pthread_mutex_lock(&s_log_mutex);
+    vprintf_like_t func = s_log_vprintf;
+    pthread_mutex_unlock(&s_log_mutex);
+
+    va_list args;
+    va_start(args, format);
+    int length = func(format, args);
+    va_end(args);
+    return length;
+}
+
+/* Misc */
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+uint32_t esp_random(void) {
+    static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    static uint64_t state = 0x853C49E6748FEA9BULL;
+    pthread_mutex_lock(&mutex);
+    // xorshift64*, fixed seed so bench runs repeat
+    // xorshift64*，固定种子使基准测试可重复
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    uint32_t value = (uint32_t)((state * 0x2545F4914F6CDD1DULL) >> 32);
+    pthread_mutex_unlock(&mutex);
+    return value;
+}
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+    case ESP_OK:                return "ESP_OK";
+    case ESP_FAIL:              return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:   return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:  return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:     return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:       return "ESP_ERR_TIMEOUT";
+    default:                    return "UNKNOWN ERROR";
+    }
+}
+
+/* NVS, one flat table, the namespace is part of the key */
+/* NVS，单一平面表，命名空间作为键的一部分 */
+
+#define HOST_NVS_MAX_HANDLES    8
+#define HOST_NVS_MAX_ENTRIES    64
+
+typedef struct {
+    bool used;
+    char name_space[NVS_KEY_NAME_MAX_SIZE];
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    void *value;
+    size_t length;
+} host_nvs_entry_t;
+
+static pthread_mutex_t s_nvs_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char s_nvs_handles[HOST_NVS_MAX_HANDLES][NVS_KEY_NAME_MAX_SIZE];
+static host_nvs_entry_t s_nvs_entries[HOST_NVS_MAX_ENTRIES];
+
+static host_nvs_entry_t *nvs_find(nvs_handle_t handle, const char *key) {
+    for (int i = 0; i < HOST_NVS_MAX_ENTRIES; i++) {
+        host_nvs_entry_t *entry = &s_nvs_entries[i];
+        if (entry->used && strcmp(entry->name_space, s_nvs_handles[handle]) == 0 && strcmp(entry->key, key) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t nvs_open(const char *name_space, nvs_open_mode_t open_mode, nvs_handle_t *out_handle) {
+    (void)open_mode;
+    if (strlen(name_space) >= NVS_KEY_NAME_MAX_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&s_nvs_mutex);
+    for (nvs_handle_t handle = 1; handle < HOST_NVS_MAX_HANDLES; handle++) {
+        if (s_nvs_handles[handle][0] == '\0') {
+            strcpy(s_nvs_handles[handle], name_space);
+            *out_handle = handle;
+            pthread_mutex_unlock(&s_nvs_mutex);
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&s_nvs_mutex);
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length) {
+    pthread_mutex_lock(&s_nvs_mutex);
+    host_nvs_entry_t *entry = nvs_find(handle, key);
+    esp_err_t ret = ESP_OK;
+    if (entry == NULL) {
+        ret = ESP_ERR_NOT_FOUND;
+    } else if (out_value == NULL) {
+        *length = entry->length;
+    } else if (*length < entry->length) {
+        ret = ESP_ERR_INVALID_SIZE;
+    } else {
+        memcpy(out_value, entry->value, entry->length);
+        *length = entry->length;
+    }
+    pthread_mutex_unlock(&s_nvs_mutex);
+    return ret;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length) {
+    if (strlen(key) >= NVS_KEY_NAME_MAX_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    void *copy = malloc(length);
+    if (copy == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(copy, value, length);
+
+    pthread_mutex_lock(&s_nvs_mutex);
+    host_nvs_entry_t *entry = nvs_find(handle, key);
+    for (int i = 0; entry == NULL && i < HOST_NVS_MAX_ENTRIES; i++) {
+        if (!s_nvs_entries[i].used) {
+            entry = &s_nvs_entries[i];
+            entry->used = true;
+            strcpy(entry->name_space, s_nvs_handles[handle]);
+            strcpy(entry->key, key);
+        }
+    }
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    if (entry != NULL) {
+        free(entry->value);
+        entry->value = copy;
+        entry->length = length;
+        ret = ESP_OK;
+    } else {
+        free(copy);
+    }
+    pthread_mutex_unlock(&s_nvs_mutex);
+    return ret;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key) {
+    pthread_mutex_lock(&s_nvs_mutex);
+    host_nvs_entry_t *entry = nvs_find(handle, key);
+    if (entry != NULL) {
+        free(entry->value);
+        memset(entry, 0, sizeof(*entry));
+    }
+    pthread_mutex_unlock(&s_nvs_mutex);
+    return entry != NULL ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    (void)handle;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {
+    pthread_mutex_lock(&s_nvs_mutex);
+    s_nvs_handles[handle][0] = '\0';
+    pthread_mutex_unlock(&s_nvs_mutex);
+}
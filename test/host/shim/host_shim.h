@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __HOST_SHIM_H__
+#define __HOST_SHIM_H__
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Host replacement of the FreeRTOS, esp_timer, esp_log and NVS calls used by the firmware modules under
+ * test, so they run as a Linux process (test/host). The GPS UART is in driver/uart.h. Tasks are threads
+ * and a tick is 1 ms. Priorities are ignored: every task really runs in parallel, unlike the single
+ * core of the board.
+ *
+ * 被测固件模块所用 FreeRTOS、esp_timer、esp_log 与 NVS 接口的主机替代，使其作为 Linux 进程运行（test/host）。
+ * GPS 串口见 driver/uart.h。任务即线程，一个 tick 为 1 毫秒。忽略优先级：所有任务真正并行运行，与板上的单核不同。
+ */
+
+/* FreeRTOS */
+typedef uint32_t TickType_t;
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t EventBits_t;
+typedef struct host_semaphore *SemaphoreHandle_t;
+typedef struct host_event_group *EventGroupHandle_t;
+typedef struct host_task *TaskHandle_t;
+typedef struct host_sw_timer *TimerHandle_t;
+typedef struct host_queue *QueueHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define pdPASS                  1
+#define pdFAIL                  0
+#define portMAX_DELAY           0xFFFFFFFFu
+#define portTICK_PERIOD_MS      1
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+#define pdTICKS_TO_MS(ticks)    ((uint32_t)(ticks))
+
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t *previous_wake, TickType_t period);
+void taskYIELD(void);
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *out_handle);
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t timeout);
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t timeout);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+// Queues copy items by value like FreeRTOS, a full queue makes the sender wait
+// 队列与 FreeRTOS 一样按值拷贝元素，队列满时发送方等待
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t timeout);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *out_item, TickType_t timeout);
+BaseType_t xQueueReset(QueueHandle_t queue);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+EventGroupHandle_t xEventGroupCreate(void);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t timeout);
+
+// Software timers run on their own thread each, the command wait argument is ignored
+// 每个软件定时器在独立线程上运行，忽略命令等待参数
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload, void *id,
+                           TimerCallbackFunction_t callback);
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t wait);
+
+/* esp_err */
+typedef int esp_err_t;
+
+#define ESP_OK                  0
+#define ESP_FAIL                -1
+#define ESP_ERR_NO_MEM          0x101
+#define ESP_ERR_INVALID_ARG     0x102
+#define ESP_ERR_INVALID_STATE   0x103
+#define ESP_ERR_INVALID_SIZE    0x104
+#define ESP_ERR_NOT_FOUND       0x105
+#define ESP_ERR_NOT_SUPPORTED   0x106
+#define ESP_ERR_TIMEOUT         0x107
+
+const char *esp_err_to_name(esp_err_t code);
+
+/* esp_log, level 1 = errors only (default), 2 = warnings, 3 = info */
+/* esp_log，级别 1 = 仅错误（默认），2 = 警告，3 = 信息 */
+extern int host_log_level;
+
+#define ESP_LOGE(tag, format, ...) do { if (host_log_level >= 1) host_log_write("E %s: " format "\n", tag, ##__VA_ARGS__); } while (0)
+#define ESP_LOGW(tag, format, ...) do { if (host_log_level >= 2) host_log_write("W %s: " format "\n", tag, ##__VA_ARGS__); } while (0)
+#define ESP_LOGI(tag, format, ...) do { if (host_log_level >= 3) host_log_write("I %s: " format "\n", tag, ##__VA_ARGS__); } while (0)
+#define ESP_LOGD(tag, format, ...) do { } while (0)
+#define ESP_LOG_BUFFER_HEX(tag, buffer, length) do { } while (0)
+
+// Per-tag levels are only stored, printing follows host_log_level
+// 仅保存各标签的级别，打印仍由 host_log_level 决定
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+void esp_log_level_set(const char *tag, esp_log_level_t level);
+esp_log_level_t esp_log_level_get(const char *tag);
+
+// Log lines go through the function set here, vprintf by default
+// 日志行经由此处设置的函数输出，默认为 vprintf
+typedef int (*vprintf_like_t)(const char *format, va_list args);
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func);
+int host_log_write(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+/* esp_timer, one-shot timers only, each on its own thread */
+/* esp_timer，仅单次定时器，每个在独立线程上运行 */
+typedef struct esp_timer *esp_timer_handle_t;
+
+typedef struct {
+    void (*callback)(void *arg);
+    void *arg;
+    int dispatch_method;
+    const char *name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+int64_t esp_timer_get_time(void);
+
+uint32_t esp_random(void);
+
+/* esp_rom_crc, CRC-32 as in zlib for crc = 0 */
+/* esp_rom_crc，crc = 0 时与 zlib 的 CRC-32 相同 */
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len);
+
+/* esp_bt_defs, the address type only */
+/* esp_bt_defs，仅地址类型 */
+typedef uint8_t esp_bd_addr_t[6];
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <pthread.h>
+
+#include "driver/uart.h"
+
+/* Host UART ports, see driver/uart.h */
+/* 主机串口端口，见 driver/uart.h */
+
+#define HOST_UART_WRITTEN_SIZE  4096
+
+typedef struct {
+    bool installed;
+    QueueHandle_t event_queue;
+    uint32_t baud_rate;
+    uint8_t *rx;                // Received bytes not read yet
+                                // 尚未读取的接收字节
+    size_t rx_size;
+    size_t rx_length;
+    uint8_t written[HOST_UART_WRITTEN_SIZE];
+    size_t written_length;
+} host_uart_t;
+
+static pthread_mutex_t s_uart_mutex = PTHREAD_MUTEX_INITIALIZER;
+static host_uart_t s_uarts[UART_NUM_MAX];
+
+static host_uart_t *uart_get(uart_port_t port) {
+    return (port >= 0 && port < UART_NUM_MAX && s_uarts[port].installed) ? &s_uarts[port] : NULL;
+}
+
+esp_err_t uart_driver_install(uart_port_t port, int rx_buffer_size, int tx_buffer_size, int queue_size,
+                              QueueHandle_t *out_queue, int intr_alloc_flags) {
+    (void)tx_buffer_size;
+    (void)intr_alloc_flags;
+    if (port < 0 || port >= UART_NUM_MAX || rx_buffer_size <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    host_uart_t *uart = &s_uarts[port];
+    uart->rx = calloc(1, rx_buffer_size);
+    if (uart->rx == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    uart->rx_size = rx_buffer_size;
+    if (out_queue != NULL && queue_size > 0) {
+        uart->event_queue = xQueueCreate(queue_size, sizeof(uart_event_t));
+        *out_queue = uart->event_queue;
+    }
+    uart->installed = true;
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t port, const uart_config_t *config) {
+    host_uart_t *uart = uart_get(port);
+    if (uart == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    uart->baud_rate = config->baud_rate;
+    return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t port, int tx_pin, int rx_pin, int rts_pin, int cts_pin) {
+    (void)tx_pin;
+    (void)rx_pin;
+    (void)rts_pin;
+    (void)cts_pin;
+    return uart_get(port) != NULL ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t uart_set_rx_timeout(uart_port_t port, uint8_t timeout_symbols) {
+    (void)timeout_symbols;
+    return uart_get(port) != NULL ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t uart_set_baudrate(uart_port_t port, uint32_t baud_rate) {
+    host_uart_t *uart = uart_get(port);
+    if (uart == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pthread_mutex_lock(&s_uart_mutex);
+    uart->baud_rate = baud_rate;
+    pthread_mutex_unlock(&s_uart_mutex);
+    return ESP_OK;
+}
+
+uint32_t host_uart_get_baudrate(uart_port_t port) {
+    host_uart_t *uart = uart_get(port);
+    if (uart == NULL) {
+        return 0;
+    }
+    pthread_mutex_lock(&s_uart_mutex);
+    uint32_t baud_rate = uart->baud_rate;
+    pthread_mutex_unlock(&s_uart_mutex);
+    return baud_rate;
+}
+
+int uart_read_bytes(uart_port_t port, void *buffer, uint32_t length, TickType_t timeout) {
+    (void)timeout;
+    host_uart_t *uart = uart_get(port);
+    if (uart == NULL) {
+        return -1;
+    }
+    pthread_mutex_lock(&s_uart_mutex);
+    size_t count = length < uart->rx_length ? length : uart->rx_length;
+    memcpy(buffer, uart->rx, count);
+    memmove(uart->rx, uart->rx + count, uart->rx_length - count);
+    uart->rx_length -= count;
+    pthread_mutex_unlock(&s_uart_mutex);
+    return (int)count;
+}
+
+int uart_write_bytes(uart_port_t port, const void *data, size_t length) {
+    host_uart_t *uart = uart_get(port);
+    if (uart == NULL) {
+        return -1;
+    }
+    pthread_mutex_lock(&s_uart_mutex);
+    // Keep the newest bytes when the test does not read them back
+    // 测试不读取时保留最新的字节
+    if (length > HOST_UART_WRITTEN_SIZE - uart->written_length) {
+        size_t drop = length - (HOST_UART_WRITTEN_SIZE - uart->written_length);
+        drop = drop < uart->written_length ? drop : uart->written_length;
+        memmove(uart->written, uart->written + drop, uart->written_length - drop);
+        uart->written_length -= drop;
+    }
+    size_t count = length < HOST_UART_WRITTEN_SIZE - uart->written_length ? length : HOST_UART_WRITTEN_SIZE - uart->written_length;
+    memcpy(uart->written + uart->written_length, data, count);
+    uart->written_length += count;
+    pthread_mutex_unlock(&s_uart_mutex);
+    return (int)length;
+}
+
+esp_err_t uart_wait_tx_done(uart_port_t port, TickType_t timeout) {
+    (void)timeout;
+    return uart_get(port) != NULL ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t uart_flush_input(uart_port_t port) {
+    host_uart_t *uart = uart_get(port);
+    if (uart == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pthread_mutex_lock(&s_uart_mutex);
+    uart->rx_length = 0;
+    pthread_mutex_unlock(&s_uart_mutex);
+    return ESP_OK;
+}
+
+esp_err_t host_uart_inject(uart_port_t port, const void *data, size_t length) {
+    host_uart_t *uart = uart_get(port);
+    if (uart == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const uint8_t *bytes = data;
+    while (length > 0) {
+        size_t chunk = length < HOST_UART_FIFO_FULL ? length : HOST_UART_FIFO_FULL;
+        uart_event_t event = { .type = UART_DATA, .size = chunk, .timeout_flag = (chunk == length) };
+
+        pthread_mutex_lock(&s_uart_mutex);
+        if (chunk > uart->rx_size - uart->rx_length) {
+            // Ring buffer full, the driver reports it instead of the data
+            // 环形缓冲区已满，驱动报告该事件而不是数据
+            event.type = UART_BUFFER_FULL;
+            event.size = 0;
+        } else {
+            memcpy(uart->rx + uart->rx_length, bytes, chunk);
+            uart->rx_length += chunk;
+        }
+        pthread_mutex_unlock(&s_uart_mutex);
+
+        if (uart->event_queue != NULL) {
+            xQueueSend(uart->event_queue, &event, portMAX_DELAY);
+        }
+        bytes += chunk;
+        length -= chunk;
+    }
+    return ESP_OK;
+}
+
+size_t host_uart_take_written(uart_port_t port, void *out, size_t size) {
+    host_uart_t *uart = uart_get(port);
+    if (uart == NULL) {
+        return 0;
+    }
+    pthread_mutex_lock(&s_uart_mutex);
+    size_t count = size < uart->written_length ? size : uart->written_length;
+    memcpy(out, uart->written, count);
+    memmove(uart->written, uart->written + count, uart->written_length - count);
+    uart->written_length -= count;
+    pthread_mutex_unlock(&s_uart_mutex);
+    return count;
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+
+#include "test_common.h"
+#include "nvs.h"
+#include "ble_gatt_cache.h"
+
+/*
+ * The GATT handle cache on the in-memory NVS of the shim: round trip per camera address, and the
+ * checks that send a connect back to discovery when a stored entry cannot be trusted.
+ * 在适配层的内存 NVS 上测试 GATT 句柄缓存：按相机地址存取，以及存储的条目不可信时让连接回退到服务发现的检查。
+ */
+
+static const esp_bd_addr_t s_camera_a = {0x60, 0x60, 0x1F, 0x12, 0x34, 0x56};
+static const esp_bd_addr_t s_camera_b = {0x60, 0x60, 0x1F, 0x65, 0x43, 0x21};
+
+static ble_gatt_cache_t make_entry(const esp_bd_addr_t addr, uint16_t notify_handle) {
+    ble_gatt_cache_t entry = {
+        .service_start_handle = 0x28,
+        .service_end_handle = 0x30,
+        .notify_char_handle = notify_handle,
+        .write_char_handle = 0x2D,
+        .notify_descr_handle = (uint16_t)(notify_handle + 1),
+    };
+    memcpy(entry.remote_bda, addr, sizeof(esp_bd_addr_t));
+    return entry;
+}
+
+static void test_round_trip_per_camera(void) {
+    ble_gatt_cache_t entry_a = make_entry(s_camera_a, 0x2A);
+    ble_gatt_cache_t entry_b = make_entry(s_camera_b, 0x12);
+    ble_gatt_cache_t loaded;
+
+    TEST_CHECK(ble_gatt_cache_load(s_camera_a, &loaded) == ESP_ERR_NOT_FOUND);
+    TEST_CHECK(ble_gatt_cache_store(&entry_a) == ESP_OK);
+    TEST_CHECK(ble_gatt_cache_store(&entry_b) == ESP_OK);
+
+    TEST_CHECK(ble_gatt_cache_load(s_camera_a, &loaded) == ESP_OK);
+    TEST_CHECK(memcmp(&loaded, &entry_a, sizeof(loaded)) == 0);
+    TEST_CHECK(ble_gatt_cache_load(s_camera_b, &loaded) == ESP_OK);
+    TEST_CHECK(loaded.notify_char_handle == 0x12 && loaded.notify_descr_handle == 0x13);
+
+    // Forgetting one camera leaves the other
+    // 删除一台相机不影响另一台
+    ble_gatt_cache_erase(s_camera_a);
+    TEST_CHECK(ble_gatt_cache_load(s_camera_a, &loaded) == ESP_ERR_NOT_FOUND);
+    TEST_CHECK(ble_gatt_cache_load(s_camera_b, &loaded) == ESP_OK);
+    ble_gatt_cache_erase(s_camera_b);
+}
+
+/**
+ * @brief Write a raw entry under the key of its address, as an older firmware or a corrupted write would
+ *        以条目地址对应的键写入原始条目，模拟旧固件或损坏的写入
+ */
+static void store_raw(const ble_gatt_cache_t *entry, size_t length, const esp_bd_addr_t key_addr) {
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    nvs_handle_t handle;
+    snprintf(key, sizeof(key), "h%02x%02x%02x%02x%02x%02x", key_addr[0], key_addr[1], key_addr[2], key_addr[3],
+             key_addr[4], key_addr[5]);
+    nvs_open("gatt_cache", NVS_READWRITE, &handle);
+    nvs_set_blob(handle, key, entry, length);
+    nvs_commit(handle);
+    nvs_close(handle);
+}
+
+static void test_untrusted_entries_fall_back(void) {
+    ble_gatt_cache_t loaded;
+    ble_gatt_cache_t good = make_entry(s_camera_a, 0x2A);
+    ble_gatt_cache_store(&good);
+
+    ble_gatt_cache_t entry = good;
+    entry.version = 0;
+    store_raw(&entry, sizeof(entry), s_camera_a);
+    TEST_CHECK(ble_gatt_cache_load(s_camera_a, &loaded) == ESP_ERR_NOT_FOUND);
+
+    store_raw(&good, sizeof(good) - 1, s_camera_a);
+    TEST_CHECK(ble_gatt_cache_load(s_camera_a, &loaded) == ESP_ERR_NOT_FOUND);
+
+    // An entry of another camera under this key
+    // 该键下存放的是另一台相机的条目
+    entry = make_entry(s_camera_b, 0x2A);
+    entry.version = good.version;
+    store_raw(&entry, sizeof(entry), s_camera_a);
+    TEST_CHECK(ble_gatt_cache_load(s_camera_a, &loaded) == ESP_ERR_NOT_FOUND);
+
+    // A value handle must follow its declaration, and the CCCD must be known
+    // 值句柄必须位于其声明之后，且 CCCD 必须已知
+    entry = good;
+    entry.write_char_handle = 1;
+    store_raw(&entry, sizeof(entry), s_camera_a);
+    TEST_CHECK(ble_gatt_cache_load(s_camera_a, &loaded) == ESP_ERR_NOT_FOUND);
+    entry = good;
+    entry.notify_descr_handle = 0;
+    store_raw(&entry, sizeof(entry), s_camera_a);
+    TEST_CHECK(ble_gatt_cache_load(s_camera_a, &loaded) == ESP_ERR_NOT_FOUND);
+
+    store_raw(&good, sizeof(good), s_camera_a);
+    TEST_CHECK(ble_gatt_cache_load(s_camera_a, &loaded) == ESP_OK);
+    ble_gatt_cache_erase(s_camera_a);
+}
+
+int main(void) {
+    TEST_RUN(test_round_trip_per_camera);
+    TEST_RUN(test_untrusted_entries_fall_back);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <stdbool.h>
+
+#include "test_common.h"
+#include "civil_time.h"
+
+static void test_known_dates(void) {
+    TEST_CHECK(civil_days_from_date(1970, 1, 1) == 0);
+    TEST_CHECK(civil_days_from_date(1969, 12, 31) == -1);
+    TEST_CHECK(civil_days_from_date(2000, 3, 1) == 11017);
+    TEST_CHECK(civil_days_from_date(2024, 2, 29) == 19782);
+    TEST_CHECK(civil_days_from_date(1600, 1, 1) == -135140);
+
+    civil_date_t date = civil_date_from_days(19782);
+    TEST_CHECK(date.year == 2024 && date.month == 2 && date.day == 29);
+    date = civil_date_from_days(-1);
+    TEST_CHECK(date.year == 1969 && date.month == 12 && date.day == 31);
+}
+
+static void test_every_day_round_trips(void) {
+    // About 5500 years around 1970, each day must follow the previous one
+    // 1970 年前后约 5500 年，每一天都必须紧接前一天
+    civil_date_t previous = civil_date_from_days(-1000001);
+    int failures = 0;
+    for (int64_t days = -1000000; days <= 1000000 && failures < 5; days++) {
+        civil_date_t date = civil_date_from_days(days);
+        bool next_day = date.year == previous.year && date.month == previous.month && date.day == previous.day + 1;
+        bool next_month = date.year == previous.year && date.month == previous.month + 1 && date.day == 1;
+        bool next_year = date.year == previous.year + 1 && date.month == 1 && previous.month == 12 && date.day == 1;
+        if (!(next_day || next_month || next_year) ||
+            civil_days_from_date(date.year, date.month, date.day) != days) {
+            printf("day %lld: %d-%02u-%02u\n", (long long)days, (int)date.year, date.month, date.day);
+            failures++;
+        }
+        previous = date;
+    }
+    TEST_CHECK(failures == 0);
+}
+
+static void test_floor_div(void) {
+    TEST_CHECK(civil_floor_div(86399, 86400) == 0);
+    TEST_CHECK(civil_floor_div(86400, 86400) == 1);
+    TEST_CHECK(civil_floor_div(-1, 86400) == -1);
+    TEST_CHECK(civil_floor_div(-86400, 86400) == -1);
+    TEST_CHECK(civil_floor_div(-86401, 86400) == -2);
+}
+
+static void test_eu_daylight_saving(void) {
+    // 2025: 30 March and 26 October, 01:00 UTC
+    // 2025 年：3 月 30 日与 10 月 26 日，UTC 01:00
+    const int64_t start = 1743296400, end = 1761440400;
+    int64_t next;
+    TEST_CHECK(civil_dst_offset_s(CIVIL_DST_EU, 3600, start - 1, &next) == 3600);
+    TEST_CHECK(next == start);
+    TEST_CHECK(civil_dst_offset_s(CIVIL_DST_EU, 3600, start, &next) == 7200);
+    TEST_CHECK(next == end);
+    TEST_CHECK(civil_dst_offset_s(CIVIL_DST_EU, 3600, end - 1, NULL) == 7200);
+    TEST_CHECK(civil_dst_offset_s(CIVIL_DST_EU, 3600, end, &next) == 3600);
+    // After the end the next change reported is the new year in standard local time
+    // 结束之后报告的下一次变化为标准本地时间的新年
+    TEST_CHECK(next == 1767222000);
+    // The switch is at the same UTC instant in every EU zone
+    // 所有欧盟时区在同一 UTC 时刻切换
+    TEST_CHECK(civil_dst_offset_s(CIVIL_DST_EU, 0, start, NULL) == 3600);
+    TEST_CHECK(civil_dst_offset_s(CIVIL_DST_EU, 7200, start - 1, NULL) == 7200);
+}
+
+static void test_us_daylight_saving(void) {
+    // 2025, US Eastern: 9 March 07:00 UTC and 2 November 06:00 UTC
+    // 2025 年美国东部：3 月 9 日 UTC 07:00 与 11 月 2 日 UTC 06:00
+    const int32_t eastern = -5 * 3600;
+    const int64_t start = 1741503600, end = 1762063200;
+    int64_t next;
+    TEST_CHECK(civil_dst_offset_s(CIVIL_DST_US, eastern, start - 1, &next) == eastern);
+    TEST_CHECK(next == start);
+    TEST_CHECK(civil_dst_offset_s(CIVIL_DST_US, eastern, start, &next) == eastern + 3600);
+    TEST_CHECK(next == end);
+    TEST_CHECK(civil_dst_offset_s(CIVIL_DST_US, eastern, end, NULL) == eastern);
+}
+
+static void test_no_daylight_saving(void) {
+    int64_t next = 0;
+    TEST_CHECK(civil_dst_offset_s(CIVIL_DST_NONE, 8 * 3600, 1751328000, &next) == 8 * 3600);
+    TEST_CHECK(next == INT64_MAX);
+}
+
+int main(void) {
+    TEST_RUN(test_known_dates);
+    TEST_RUN(test_every_day_round_trips);
+    TEST_RUN(test_floor_div);
+    TEST_RUN(test_eu_daylight_saving);
+    TEST_RUN(test_us_daylight_saving);
+    TEST_RUN(test_no_daylight_saving);
+    return TEST_EXIT_CODE();
+}
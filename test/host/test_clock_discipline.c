@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <stdint.h>
+
+#include "test_common.h"
+#include "clock_discipline.h"
+
+#define TEST_UTC_START_US   1751328000000000LL
+#define TEST_LOCAL_START_US 12345678LL
+#define TEST_PPM_FAST       25.0
+
+static uint32_t s_rng = 3;
+
+// Edge latency jitter in [-amplitude, amplitude] us
+// 边沿延迟抖动，范围 [-amplitude, amplitude] 微秒
+static int64_t jitter_us(int amplitude) {
+    s_rng = s_rng * 1103515245u + 12345u;
+    return (int64_t)((s_rng >> 8) % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+// Local time of the PPS edge at UTC second n, local clock TEST_PPM_FAST fast
+// 第 n 个 UTC 整秒 PPS 边沿的本地时间，本地时钟快 TEST_PPM_FAST
+static int64_t local_at_second(int n) {
+    return TEST_LOCAL_START_US + (int64_t)llround(n * 1e6 * (1.0 + TEST_PPM_FAST * 1e-6));
+}
+
+static void feed_seconds(clock_discipline_t *cd, int from, int to, int jitter) {
+    for (int n = from; n < to; n++) {
+        clock_discipline_add(cd, local_at_second(n) + jitter_us(jitter), TEST_UTC_START_US + n * 1000000LL);
+    }
+}
+
+static void test_locks_and_tracks_drift(void) {
+    clock_discipline_t cd = {0};
+    clock_discipline_init(&cd);
+    int64_t utc;
+    TEST_CHECK(!clock_discipline_to_utc(&cd, TEST_LOCAL_START_US, &utc));
+
+    feed_seconds(&cd, 0, CLOCK_DISCIPLINE_MIN_SAMPLES - 1, 5);
+    TEST_CHECK(!cd.locked);
+    feed_seconds(&cd, CLOCK_DISCIPLINE_MIN_SAMPLES - 1, 120, 5);
+    TEST_CHECK(cd.locked);
+    TEST_CHECK_NEAR(cd.drift * 1e6, -TEST_PPM_FAST, 2.0);
+    TEST_CHECK(cd.residual_rms_us < 5.0f);
+
+    // Half a second after the last edge
+    // 最后一个边沿之后半秒
+    int64_t local = (local_at_second(119) + local_at_second(120)) / 2;
+    TEST_CHECK(clock_discipline_to_utc(&cd, local, &utc));
+    TEST_CHECK_NEAR(utc - TEST_UTC_START_US, 119500000.0, 10.0);
+
+    int64_t back;
+    TEST_CHECK(clock_discipline_to_local(&cd, utc, &back));
+    TEST_CHECK_NEAR(back, local, 1.0);
+}
+
+static void test_outlier_rejected_and_step_followed(void) {
+    clock_discipline_t cd = {0};
+    clock_discipline_init(&cd);
+    feed_seconds(&cd, 0, 30, 5);
+    TEST_CHECK(cd.locked);
+
+    // One edge 2 ms late, e.g. a delayed interrupt
+    // 一个晚到 2 毫秒的边沿，例如被延迟的中断
+    TEST_CHECK(clock_discipline_add(&cd, local_at_second(30) + 2000, TEST_UTC_START_US + 30000000LL) ==
+               CLOCK_DISCIPLINE_REJECTED);
+    int64_t utc;
+    TEST_CHECK(clock_discipline_to_utc(&cd, local_at_second(30), &utc));
+    TEST_CHECK_NEAR(utc - TEST_UTC_START_US, 30000000.0, 10.0);
+    TEST_CHECK(clock_discipline_add(&cd, local_at_second(31), TEST_UTC_START_US + 31000000LL) ==
+               CLOCK_DISCIPLINE_ACCEPTED);
+
+    // The UTC label steps by one second and stays there, the fit restarts on the new mapping
+    // UTC 标签跳变一秒并保持，拟合以新的映射重新开始
+    int n = 32;
+    for (int i = 1; i <= CLOCK_DISCIPLINE_MAX_REJECTS; i++, n++) {
+        clock_discipline_result_t result =
+            clock_discipline_add(&cd, local_at_second(n), TEST_UTC_START_US + (n + 1) * 1000000LL);
+        TEST_CHECK(result == (i < CLOCK_DISCIPLINE_MAX_REJECTS ? CLOCK_DISCIPLINE_REJECTED : CLOCK_DISCIPLINE_RESET));
+    }
+    for (; n < 32 + CLOCK_DISCIPLINE_MAX_REJECTS + CLOCK_DISCIPLINE_MIN_SAMPLES; n++) {
+        clock_discipline_add(&cd, local_at_second(n), TEST_UTC_START_US + (n + 1) * 1000000LL);
+    }
+    TEST_CHECK(cd.locked);
+    TEST_CHECK(clock_discipline_to_utc(&cd, local_at_second(n - 1), &utc));
+    TEST_CHECK_NEAR(utc - TEST_UTC_START_US, n * 1000000.0, 10.0);
+}
+
+static void test_holdover_expires(void) {
+    clock_discipline_t cd = {0};
+    clock_discipline_init(&cd);
+    feed_seconds(&cd, 0, 30, 0);
+    int64_t utc;
+    int64_t last = local_at_second(29);
+    TEST_CHECK(clock_discipline_to_utc(&cd, last + CLOCK_DISCIPLINE_HOLDOVER_US, &utc));
+    TEST_CHECK(!clock_discipline_to_utc(&cd, last + CLOCK_DISCIPLINE_HOLDOVER_US + 1, &utc));
+
+    // The first sample after the holdover restarts the fit
+    // 保持时间过后的第一个样本使拟合重新开始
+    TEST_CHECK(clock_discipline_add(&cd, local_at_second(200), TEST_UTC_START_US + 200000000LL) ==
+               CLOCK_DISCIPLINE_RESET);
+    TEST_CHECK(!cd.locked);
+}
+
+int main(void) {
+    TEST_RUN(test_locks_and_tracks_drift);
+    TEST_RUN(test_outlier_rejected_and_step_followed);
+    TEST_RUN(test_holdover_expires);
+    return TEST_EXIT_CODE();
+}
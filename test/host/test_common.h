@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __TEST_COMMON_H__
+#define __TEST_COMMON_H__
+
+#include <stdio.h>
+#include <math.h>
+
+/* Minimal checks for the host tests, failed checks go to stderr and make the test binary exit non-zero */
+/* 主机测试使用的最小检查宏，失败的检查输出到 stderr，并使测试程序以非零值退出 */
+
+static int s_test_failures;
+
+#define TEST_CHECK(condition)                                                          \
+    do {                                                                               \
+        if (!(condition)) {                                                            \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            s_test_failures++;                                                         \
+        }                                                                              \
+    } while (0)
+
+#define TEST_CHECK_NEAR(actual, expected, tolerance)                                   \
+    do {                                                                               \
+        double test_actual_ = (double)(actual);                                        \
+        double test_expected_ = (double)(expected);                                    \
+        if (!(fabs(test_actual_ - test_expected_) <= (double)(tolerance))) {           \
+            fprintf(stderr, "%s:%d: %s = %.9g, expected %.9g +- %g\n", __FILE__, __LINE__, \
+                    #actual, test_actual_, test_expected_, (double)(tolerance));       \
+            s_test_failures++;                                                         \
+        }                                                                              \
+    } while (0)
+
+#define TEST_RUN(test)                                                                 \
+    do {                                                                               \
+        int test_before_ = s_test_failures;                                            \
+        test();                                                                        \
+        printf("%s %s\n", s_test_failures == test_before_ ? "PASS" : "FAIL", #test);   \
+    } while (0)
+
+#define TEST_EXIT_CODE() (s_test_failures != 0)
+
+#endif
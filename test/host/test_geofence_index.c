@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <string.h>
+
+#include "test_common.h"
+#include "geofence_index.h"
+
+/*
+ * Runs on the image tools/geofence_builder.py makes from geofence_fences.json, so the builder and the
+ * reader are checked against each other.
+ * 使用 tools/geofence_builder.py 由 geofence_fences.json 生成的镜像，从而相互校验生成器与读取端。
+ */
+
+#define METERS_PER_DEGREE   (6378137.0 * M_PI / 180.0)
+
+static uint32_t s_image[4096];
+static size_t s_image_size;
+
+// zlib CRC32, the same as esp_rom_crc32_le(0, ...) used by geofence_logic.c
+// zlib CRC32，与 geofence_logic.c 使用的 esp_rom_crc32_le(0, ...) 相同
+static uint32_t crc32_zlib(const uint8_t *data, size_t length) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+// Point d_north / d_east metres from a position, degrees * 1e7
+// 距某位置向北 d_north、向东 d_east 米的点，度 * 1e7
+static void offset_point(double lat, double lon, double d_north, double d_east, int32_t *out_lat, int32_t *out_lon) {
+    *out_lat = (int32_t)lround((lat + d_north / METERS_PER_DEGREE) * 1e7);
+    *out_lon = (int32_t)lround((lon + d_east / (METERS_PER_DEGREE * cos(lat * M_PI / 180.0))) * 1e7);
+}
+
+static geofence_position_t test_point(const geofence_index_t *index, uint16_t id, double lat, double lon,
+                                      double d_north, double d_east) {
+    int32_t lat_e7, lon_e7;
+    offset_point(lat, lon, d_north, d_east, &lat_e7, &lon_e7);
+    return geofence_index_test(index, id, lat_e7, lon_e7);
+}
+
+static bool is_candidate(const geofence_index_t *index, uint16_t id, double lat, double lon) {
+    const uint16_t *ids;
+    size_t count = geofence_index_candidates(index, (int32_t)lround(lat * 1e7), (int32_t)lround(lon * 1e7), &ids);
+    for (size_t i = 0; i < count; i++) {
+        if (ids[i] == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void test_image_opens(void) {
+    const geofence_header_t *header = (const geofence_header_t *)s_image;
+    geofence_index_t index;
+    TEST_CHECK(geofence_index_open(&index, s_image, s_image_size) == 0);
+    TEST_CHECK(header->fence_count == 3);
+    TEST_CHECK(header->total_size == s_image_size);
+    TEST_CHECK(crc32_zlib((const uint8_t *)s_image + sizeof(*header), header->total_size - sizeof(*header)) ==
+               header->crc32);
+}
+
+static void test_malformed_images_are_refused(void) {
+    static uint32_t copy[4096];
+    geofence_index_t index;
+
+    memcpy(copy, s_image, s_image_size);
+    ((geofence_header_t *)copy)->magic ^= 1;
+    TEST_CHECK(geofence_index_open(&index, copy, s_image_size) == -1);
+
+    TEST_CHECK(geofence_index_open(&index, s_image, s_image_size - 4) == -1);
+
+    // A cell entry naming a fence that does not exist
+    // 引用不存在围栏的单元条目
+    memcpy(copy, s_image, s_image_size);
+    const geofence_header_t *header = (const geofence_header_t *)copy;
+    size_t cells = (size_t)header->rows * header->cols;
+    uint16_t *entries = (uint16_t *)((uint8_t *)copy + sizeof(*header) + header->fence_count * sizeof(geofence_record_t) +
+                                     (cells + 1) * sizeof(uint32_t));
+    entries[0] = header->fence_count;
+    TEST_CHECK(geofence_index_open(&index, copy, s_image_size) == -1);
+}
+
+static void test_candidates_follow_the_grid(void) {
+    geofence_index_t index;
+    geofence_index_open(&index, s_image, s_image_size);
+    TEST_CHECK(is_candidate(&index, 0, 22.5431, 113.9510));
+    TEST_CHECK(!is_candidate(&index, 1, 22.5431, 113.9510));
+    TEST_CHECK(is_candidate(&index, 1, 22.5462, 113.9532));
+    TEST_CHECK(is_candidate(&index, 2, 22.5462, 113.9532));
+
+    // Outside the grid
+    // 网格之外
+    const uint16_t *ids;
+    TEST_CHECK(geofence_index_candidates(&index, 0, 0, &ids) == 0);
+    TEST_CHECK(geofence_index_candidates(&index, 225431000, 1140000000, &ids) == 0);
+}
+
+static void test_circle_with_hysteresis(void) {
+    geofence_index_t index;
+    geofence_index_open(&index, s_image, s_image_size);
+    // Radius 30 m, hysteresis 5 m
+    // 半径 30 米，滞回 5 米
+    TEST_CHECK(test_point(&index, 0, 22.5431, 113.9510, 0, 0) == GEOFENCE_INSIDE);
+    TEST_CHECK(test_point(&index, 0, 22.5431, 113.9510, 20, 0) == GEOFENCE_INSIDE);
+    TEST_CHECK(test_point(&index, 0, 22.5431, 113.9510, -28, 0) == GEOFENCE_BORDER);
+    TEST_CHECK(test_point(&index, 0, 22.5431, 113.9510, 32, 0) == GEOFENCE_BORDER);
+    TEST_CHECK(test_point(&index, 0, 22.5431, 113.9510, 40, 0) == GEOFENCE_OUTSIDE);
+    // East-west distances are scaled by the cosine of the latitude
+    // 东西方向距离按纬度余弦缩放
+    TEST_CHECK(test_point(&index, 0, 22.5431, 113.9510, 0, 20) == GEOFENCE_INSIDE);
+    TEST_CHECK(test_point(&index, 0, 22.5431, 113.9510, 0, -32) == GEOFENCE_BORDER);
+    TEST_CHECK(test_point(&index, 0, 22.5431, 113.9510, 0, 40) == GEOFENCE_OUTSIDE);
+    TEST_CHECK(test_point(&index, 0, 22.5431, 113.9510, 1000, 0) == GEOFENCE_OUTSIDE);
+}
+
+static void test_concave_polygon(void) {
+    geofence_index_t index;
+    geofence_index_open(&index, s_image, s_image_size);
+    // L shape, the north-east quarter is cut out, hysteresis 2 m
+    // L 形，东北四分之一被切除，滞回 2 米
+    TEST_CHECK(test_point(&index, 1, 22.5462, 113.9532, 0, 0) == GEOFENCE_INSIDE);
+    TEST_CHECK(test_point(&index, 1, 22.5468, 113.9532, 0, 0) == GEOFENCE_INSIDE);
+    TEST_CHECK(test_point(&index, 1, 22.5462, 113.9538, 0, 0) == GEOFENCE_INSIDE);
+    TEST_CHECK(test_point(&index, 1, 22.5468, 113.9538, 0, 0) == GEOFENCE_OUTSIDE);
+    TEST_CHECK(test_point(&index, 1, 22.5462, 113.9545, 0, 0) == GEOFENCE_OUTSIDE);
+    // Within 2 m of the south edge, on either side
+    // 南边缘 2 米内，两侧皆是
+    TEST_CHECK(test_point(&index, 1, 22.5460, 113.9535, 1, 0) == GEOFENCE_BORDER);
+    TEST_CHECK(test_point(&index, 1, 22.5460, 113.9535, -1, 0) == GEOFENCE_BORDER);
+    TEST_CHECK(test_point(&index, 1, 22.5460, 113.9535, -5, 0) == GEOFENCE_OUTSIDE);
+    TEST_CHECK(test_point(&index, 1, 22.5460, 113.9535, 5, 0) == GEOFENCE_INSIDE);
+    // The inner corner of the notch
+    // 缺口的内角
+    TEST_CHECK(test_point(&index, 1, 22.5465, 113.9535, 1, 1) == GEOFENCE_BORDER);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        printf("usage: %s geofence.bin\n", argv[0]);
+        return 2;
+    }
+    FILE *file = fopen(argv[1], "rb");
+    if (file == NULL) {
+        printf("cannot open %s\n", argv[1]);
+        return 2;
+    }
+    s_image_size = fread(s_image, 1, sizeof(s_image), file);
+    fclose(file);
+
+    TEST_RUN(test_image_opens);
+    TEST_RUN(test_malformed_images_are_refused);
+    TEST_RUN(test_candidates_follow_the_grid);
+    TEST_RUN(test_circle_with_hysteresis);
+    TEST_RUN(test_concave_polygon);
+    return TEST_EXIT_CODE();
+}
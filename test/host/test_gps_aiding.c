@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "test_common.h"
+#include "gps_aiding_logic.h"
+#include "gps_receiver_logic.h"
+#include "civil_time.h"
+
+/*
+ * Boot aiding and the last-fix store of gps_aiding_logic.c. esp_timer_get_time, time and
+ * settimeofday are wrapped at link time (see CMakeLists.txt), so the test owns the clocks and
+ * never touches the host's.
+ * gps_aiding_logic.c 的启动辅助与最近定位存储。esp_timer_get_time、time 与 settimeofday 在链接时被
+ * 包装（见 CMakeLists.txt），时钟由测试控制，不会修改主机时钟。
+ */
+
+#define S_TO_US(s) ((int64_t)(s) * 1000000)
+
+static int64_t s_now_us;
+static time_t s_system_time;
+static int s_settimeofday_calls;
+
+int64_t __wrap_esp_timer_get_time(void) {
+    return s_now_us;
+}
+
+time_t __wrap_time(time_t *out) {
+    if (out != NULL) {
+        *out = s_system_time;
+    }
+    return s_system_time;
+}
+
+int __wrap_settimeofday(const struct timeval *tv, const void *tz) {
+    (void)tz;
+    s_system_time = tv->tv_sec;
+    s_settimeofday_calls++;
+    return 0;
+}
+
+/* Dependencies of gps_aiding_logic.c */
+/* gps_aiding_logic.c 的依赖 */
+
+static char s_commands[8][GPS_RECEIVER_SENTENCE_MAX];
+static int s_command_count;
+
+int gps_receiver_send_command(const char *body, gps_receiver_done_cb_t done_cb, void *ctx) {
+    (void)done_cb;
+    (void)ctx;
+    if (s_command_count < 8) {
+        snprintf(s_commands[s_command_count], GPS_RECEIVER_SENTENCE_MAX, "%s", body);
+    }
+    s_command_count++;
+    return 0;
+}
+
+int64_t gps_data_to_unix_time(const GPS_Data_t *gps) {
+    int64_t days = civil_days_from_date(gps->Year + 2000, gps->Month, gps->Day);
+    return days * 86400 + gps->Hour * 3600 + gps->Minute * 60 + (int64_t)gps->Second;
+}
+
+/* Helpers */
+
+// 2025-03-14 07:47:00 UTC, the README position
+// 2025-03-14 07:47:00 UTC，README 中的位置
+static GPS_Data_t make_fix(double latitude, double longitude) {
+    GPS_Data_t gps = {0};
+    gps.Year = 25;
+    gps.Month = 3;
+    gps.Day = 14;
+    gps.Hour = 7;
+    gps.Minute = 47;
+    gps.Second = 0.5;
+    gps.Latitude = latitude;
+    gps.Longitude = longitude;
+    gps.Altitude = 47.379;
+    return gps;
+}
+
+/* Tests, in order: they share the module's state like one power cycle after another */
+/* 测试按顺序执行：它们像一次次上电一样共享模块状态 */
+
+static void test_cold_boot_injects_nothing(void) {
+    s_system_time = 0;
+    s_command_count = 0;
+    gps_aiding_inject();
+    TEST_CHECK(s_command_count == 0);
+}
+
+static void test_first_fix_sets_clock_and_stores(void) {
+    GPS_Data_t gps = make_fix(22.5788789, 113.9386252);
+    s_now_us = S_TO_US(35);
+    gps_aiding_on_fix(&gps);
+    TEST_CHECK(s_settimeofday_calls == 1);
+    TEST_CHECK(s_system_time == 1741938420);
+    TEST_CHECK(s_command_count == 0);
+
+    // The clock is set from the first fix only
+    // 仅用首次定位设置时钟
+    s_now_us += S_TO_US(1);
+    gps_aiding_on_fix(&gps);
+    TEST_CHECK(s_settimeofday_calls == 1);
+}
+
+static void test_receiver_backup_schedule(void) {
+    GPS_Data_t gps = make_fix(22.5788789, 113.9386252);
+    s_command_count = 0;
+
+    s_now_us = S_TO_US(35 + GPS_AIDING_BACKUP_FIRST_S) - 1;
+    gps_aiding_on_fix(&gps);
+    TEST_CHECK(s_command_count == 0);
+    s_now_us += 1;
+    gps_aiding_on_fix(&gps);
+    TEST_CHECK(s_command_count == 1);
+    TEST_CHECK(strcmp(s_commands[0], "PAIR511") == 0);
+
+    s_now_us += S_TO_US(GPS_AIDING_BACKUP_INTERVAL_S) - 1;
+    gps_aiding_on_fix(&gps);
+    TEST_CHECK(s_command_count == 1);
+    s_now_us += 1;
+    gps_aiding_on_fix(&gps);
+    TEST_CHECK(s_command_count == 2);
+}
+
+static void test_store_is_rate_and_distance_limited(void) {
+    // Past the save interval but only 560 m away from the stored fix: no write
+    // 超过保存间隔但距存储位置仅 560 米：不写入
+    GPS_Data_t parked = make_fix(22.5788789 + 0.005, 113.9386252);
+    s_now_us += S_TO_US(GPS_AIDING_SAVE_INTERVAL_S);
+    gps_aiding_on_fix(&parked);
+
+    // 2.2 km away: stored
+    // 相距 2.2 千米：存储
+    GPS_Data_t moved = make_fix(22.5788789 + 0.02, 113.9386252);
+    gps_aiding_on_fix(&moved);
+
+    // Another 2.2 km, but within the save interval of the last write: rate limited
+    // 又移动 2.2 千米，但距上次写入未超过保存间隔：受频率限制
+    GPS_Data_t moved_again = make_fix(22.5788789 + 0.04, 113.9386252);
+    s_now_us += S_TO_US(GPS_AIDING_SAVE_INTERVAL_S) - 1;
+    gps_aiding_on_fix(&moved_again);
+
+    // The next boot injects the clock, still running, and the stored fix
+    // 下次启动注入仍在运行的时钟与存储的定位
+    s_command_count = 0;
+    gps_aiding_inject();
+    TEST_CHECK(s_command_count == 2);
+    TEST_CHECK(strcmp(s_commands[0], "PAIR590,2025,03,14,07,47,00") == 0);
+    TEST_CHECK(strcmp(s_commands[1], "PAIR600,22.598879,113.938625,47.4,5000.0,5000.0,0.0,5000.0") == 0);
+}
+
+int main(void) {
+    TEST_RUN(test_cold_boot_injects_nothing);
+    TEST_RUN(test_first_fix_sets_clock_and_stores);
+    TEST_RUN(test_receiver_backup_schedule);
+    TEST_RUN(test_store_is_rate_and_distance_limited);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdint.h>
+
+#include "test_common.h"
+#include "gps_kalman.h"
+
+#define TEST_LAT        22.5
+#define TEST_LON        113.9
+#define METERS_PER_DEG  (6371000.0 * M_PI / 180.0)
+
+static uint64_t s_rng = 1;
+
+// Standard normal sample, fixed seed so failures repeat
+// 标准正态样本，固定种子使失败可复现
+static double gauss(void) {
+    s_rng = s_rng * 6364136223846793005ULL + 1442695040888963407ULL;
+    double u = ((s_rng >> 11) + 1.0) / 9007199254740993.0;
+    s_rng = s_rng * 6364136223846793005ULL + 1442695040888963407ULL;
+    double v = (s_rng >> 11) / 9007199254740992.0;
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static gps_kalman_measurement_t measure(double north_m, double east_m, float vel_north, float vel_east,
+                                        double noise_m) {
+    gps_kalman_measurement_t meas = {
+        .latitude = TEST_LAT + (north_m + noise_m * gauss()) / METERS_PER_DEG,
+        .longitude = TEST_LON + (east_m + noise_m * gauss()) / (METERS_PER_DEG * cos(TEST_LAT * M_PI / 180.0)),
+        .altitude = 50.0,
+        .vel_north = vel_north,
+        .vel_east = vel_east,
+        .pos_sigma_h = 2.0f,
+        .pos_sigma_v = 3.0f,
+        .vel_sigma_h = 0.3f,
+        .vel_sigma_v = 0.5f,
+    };
+    return meas;
+}
+
+static double east_error_m(const gps_kalman_state_t *state, double east_m) {
+    return (state->longitude - TEST_LON) * METERS_PER_DEG * cos(TEST_LAT * M_PI / 180.0) - east_m;
+}
+
+static void test_first_measurement_initializes(void) {
+    gps_kalman_t kf;
+    gps_kalman_init(&kf, 1.0f, 0.5f);
+    gps_kalman_state_t state;
+    TEST_CHECK(!gps_kalman_predict(&kf, 0, &state));
+
+    gps_kalman_measurement_t meas = measure(0, 0, 0, 0, 0);
+    TEST_CHECK(gps_kalman_update(&kf, &meas, 1000000) == GPS_KALMAN_RESET);
+    TEST_CHECK(gps_kalman_predict(&kf, 1000000, &state));
+    TEST_CHECK_NEAR(state.latitude, TEST_LAT, 1e-9);
+    TEST_CHECK_NEAR(state.longitude, TEST_LON, 1e-9);
+    TEST_CHECK_NEAR(state.altitude, 50.0, 1e-3);
+}
+
+static void test_constant_velocity_track_converges(void) {
+    gps_kalman_t kf;
+    gps_kalman_init(&kf, 1.0f, 0.5f);
+    const double speed = 30.0;
+    double worst_m = 0.0;
+    int rejected = 0;
+    // 60 s east at 30 m/s and 10 Hz, 1.8 km so the origin is recentred on the way
+    // 以 30 米/秒向东行驶 60 秒、10 Hz，共 1.8 公里，途中会移动原点
+    for (int i = 0; i <= 600; i++) {
+        double east = speed * i * 0.1;
+        gps_kalman_measurement_t meas = measure(0, east, 0, (float)speed, 2.0);
+        gps_kalman_result_t result = gps_kalman_update(&kf, &meas, (int64_t)i * 100000);
+        rejected += result == GPS_KALMAN_REJECTED;
+        if (i >= 50) {
+            gps_kalman_state_t state;
+            gps_kalman_predict(&kf, (int64_t)i * 100000, &state);
+            double error = fabs(east_error_m(&state, east));
+            worst_m = error > worst_m ? error : worst_m;
+        }
+    }
+    TEST_CHECK(rejected == 0);
+    TEST_CHECK(worst_m < 2.0);
+
+    // Between epochs the prediction moves on at the estimated speed
+    // 历元之间的预测按估计速度前进
+    gps_kalman_state_t state;
+    TEST_CHECK(gps_kalman_predict(&kf, 60050000, &state));
+    TEST_CHECK_NEAR(state.vel_east, speed, 0.3);
+    TEST_CHECK_NEAR(state.vel_north, 0.0, 0.3);
+    TEST_CHECK(fabs(east_error_m(&state, speed * 60.05)) < 2.0);
+    TEST_CHECK(state.horizontal_accuracy > 0.0f && state.horizontal_accuracy < 2.0f);
+}
+
+static void test_spike_is_rejected_then_trusted(void) {
+    gps_kalman_t kf;
+    gps_kalman_init(&kf, 1.0f, 0.5f);
+    int64_t t = 0;
+    for (int i = 0; i < 50; i++, t += 100000) {
+        gps_kalman_measurement_t meas = measure(0, 0, 0, 0, 1.0);
+        gps_kalman_update(&kf, &meas, t);
+    }
+
+    // One multipath spike is rejected and leaves the estimate alone
+    // 单个多径尖峰被拒绝，且不影响估计
+    gps_kalman_measurement_t spike = measure(200, 0, 0, 0, 0);
+    TEST_CHECK(gps_kalman_update(&kf, &spike, t) == GPS_KALMAN_REJECTED);
+    t += 100000;
+    gps_kalman_state_t state;
+    gps_kalman_predict(&kf, t, &state);
+    TEST_CHECK(fabs((state.latitude - TEST_LAT) * METERS_PER_DEG) < 2.0);
+
+    // A jump that persists restarts the filter on its GPS_KALMAN_MAX_REJECTS-th epoch
+    // 持续存在的跳变在第 GPS_KALMAN_MAX_REJECTS 个历元使滤波器重启
+    for (int i = 2; i <= GPS_KALMAN_MAX_REJECTS; i++, t += 100000) {
+        gps_kalman_result_t result = gps_kalman_update(&kf, &spike, t);
+        TEST_CHECK(result == (i < GPS_KALMAN_MAX_REJECTS ? GPS_KALMAN_REJECTED : GPS_KALMAN_RESET));
+    }
+    gps_kalman_predict(&kf, t, &state);
+    TEST_CHECK_NEAR((state.latitude - TEST_LAT) * METERS_PER_DEG, 200.0, 0.01);
+}
+
+static void test_gap_restarts_filter(void) {
+    gps_kalman_t kf;
+    gps_kalman_init(&kf, 1.0f, 0.5f);
+    gps_kalman_measurement_t meas = measure(0, 0, 0, 0, 0);
+    TEST_CHECK(gps_kalman_update(&kf, &meas, 0) == GPS_KALMAN_RESET);
+    TEST_CHECK(gps_kalman_update(&kf, &meas, 100000) == GPS_KALMAN_ACCEPTED);
+    int64_t after_gap_us = 100000 + (int64_t)(GPS_KALMAN_MAX_GAP_S * 1e6f) + 100000;
+    TEST_CHECK(gps_kalman_update(&kf, &meas, after_gap_us) == GPS_KALMAN_RESET);
+    // Time going backwards also restarts
+    // 时间倒退同样会重启
+    TEST_CHECK(gps_kalman_update(&kf, &meas, after_gap_us - 1000) == GPS_KALMAN_RESET);
+}
+
+int main(void) {
+    TEST_RUN(test_first_measurement_initializes);
+    TEST_RUN(test_constant_velocity_track_converges);
+    TEST_RUN(test_spike_is_rejected_then_trusted);
+    TEST_RUN(test_gap_restarts_filter);
+    return TEST_EXIT_CODE();
+}
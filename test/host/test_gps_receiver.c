@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+
+#include "test_common.h"
+#include "gps_receiver_logic.h"
+
+/*
+ * The receiver command engine against a scripted receiver: the test plays the receiver, reading what
+ * the engine writes and answering with ACK lines, and drives gps_receiver_poll() with its own clock.
+ * 以脚本模拟接收机测试命令引擎：测试扮演接收机，读取引擎写出的语句并以 ACK 语句应答，并用自己的时钟驱动
+ * gps_receiver_poll()。
+ */
+
+// Same as gps_logic.c, which test_gps_replay checks against the receiver manual
+// 与 gps_logic.c 中的实现相同，test_gps_replay 依据接收机手册对其进行检查
+int gps_build_nmea_sentence(char *out, size_t out_size, const char *body) {
+    uint8_t checksum = 0;
+    for (const char *p = body; *p != '\0'; p++) {
+        checksum ^= (uint8_t)*p;
+    }
+    int length = snprintf(out, out_size, "$%s*%02X\r\n", body, checksum);
+    return (length < 0 || (size_t)length >= out_size) ? -1 : length;
+}
+
+/* Scripted receiver */
+/* 脚本接收机 */
+
+static char s_written[8][GPS_RECEIVER_SENTENCE_MAX];
+static int s_write_count;
+
+static void receiver_write(const char *data, size_t length) {
+    if (s_write_count < 8 && length < GPS_RECEIVER_SENTENCE_MAX) {
+        memcpy(s_written[s_write_count], data, length);
+        s_written[s_write_count][length] = '\0';
+    }
+    s_write_count++;
+}
+
+static struct {
+    int calls;
+    char body[GPS_RECEIVER_SENTENCE_MAX];
+    gps_receiver_result_t result;
+    void *ctx;
+} s_done;
+
+static void command_done(const char *body, gps_receiver_result_t result, void *ctx) {
+    s_done.calls++;
+    strcpy(s_done.body, body);
+    s_done.result = result;
+    s_done.ctx = ctx;
+}
+
+static void reset(void) {
+    TEST_CHECK(gps_receiver_init(receiver_write) == 0);
+    memset(s_written, 0, sizeof(s_written));
+    s_write_count = 0;
+    memset(&s_done, 0, sizeof(s_done));
+}
+
+/* Tests */
+
+static void test_commands_go_out_one_at_a_time(void) {
+    reset();
+    TEST_CHECK(gps_receiver_send_command("PAIR050,1000", command_done, &s_done) == 0);
+    TEST_CHECK(gps_receiver_send_command("PAIR062,0,1", NULL, NULL) == 0);
+    TEST_CHECK(!gps_receiver_is_idle());
+
+    // Checksum as in the receiver manual's PAIR050 example
+    // 校验和与接收机手册中 PAIR050 示例一致
+    gps_receiver_poll(0);
+    TEST_CHECK(s_write_count == 1);
+    TEST_CHECK(strcmp(s_written[0], "$PAIR050,1000*12\r\n") == 0);
+
+    // The second command waits for the first ACK
+    // 第二条命令等待第一条的 ACK
+    gps_receiver_poll(10);
+    TEST_CHECK(s_write_count == 1);
+
+    // Other sentences and ACKs of another command are not consumed as this command's ACK
+    // 其他语句以及其他命令的 ACK 不会被当作本命令的 ACK
+    TEST_CHECK(!gps_receiver_handle_line("$GNGGA,074700.000,2234.732734,N,11356.317512,E,1,7,1.31,47.379,M,-2.657,M,,*65"));
+    TEST_CHECK(gps_receiver_handle_line("$PAIR001,062,0*3F\r\n"));
+    TEST_CHECK(s_done.calls == 0);
+
+    TEST_CHECK(gps_receiver_handle_line("$PAIR001,050,0*3E\r\n"));
+    TEST_CHECK(s_done.calls == 1);
+    TEST_CHECK(s_done.result == GPS_RECEIVER_RESULT_OK);
+    TEST_CHECK(strcmp(s_done.body, "PAIR050,1000") == 0);
+    TEST_CHECK(s_done.ctx == &s_done);
+
+    gps_receiver_poll(20);
+    TEST_CHECK(s_write_count == 2);
+    TEST_CHECK(strcmp(s_written[1], "$PAIR062,0,1*3F\r\n") == 0);
+    TEST_CHECK(gps_receiver_handle_line("$PAIR001,062,0*3F"));
+    TEST_CHECK(gps_receiver_is_idle());
+}
+
+static void test_reject_and_bad_checksum(void) {
+    reset();
+    gps_receiver_send_command("PAIR062,0,1", command_done, NULL);
+    gps_receiver_poll(0);
+
+    // A corrupted ACK is dropped, the command keeps waiting
+    // 损坏的 ACK 被丢弃，命令继续等待
+    TEST_CHECK(gps_receiver_handle_line("$PAIR001,062,4*3A"));
+    TEST_CHECK(s_done.calls == 0);
+
+    TEST_CHECK(gps_receiver_handle_line("$PAIR001,062,4*3B"));
+    TEST_CHECK(s_done.calls == 1);
+    TEST_CHECK(s_done.result == GPS_RECEIVER_RESULT_FAILED);
+
+    // PMTK commands are acknowledged with flag 3
+    // PMTK 命令以标志 3 确认
+    gps_receiver_send_command("PMTK220,100", command_done, NULL);
+    gps_receiver_poll(10);
+    TEST_CHECK(strcmp(s_written[1], "$PMTK220,100*2F\r\n") == 0);
+    TEST_CHECK(gps_receiver_handle_line("$PMTK001,220,3*30"));
+    TEST_CHECK(s_done.calls == 2);
+    TEST_CHECK(s_done.result == GPS_RECEIVER_RESULT_OK);
+}
+
+static void test_retry_processing_and_timeout(void) {
+    reset();
+    gps_receiver_send_command("PAIR062,0,1", command_done, NULL);
+    uint32_t now = 1000;
+    gps_receiver_poll(now);
+    TEST_CHECK(s_write_count == 1);
+
+    // "Processing" pushes the deadline out, no resend
+    // "处理中" 推迟截止时间，不会重发
+    now += GPS_RECEIVER_ACK_TIMEOUT_MS - 10;
+    gps_receiver_poll(now);
+    TEST_CHECK(gps_receiver_handle_line("$PAIR001,062,1*3E"));
+    now += GPS_RECEIVER_ACK_TIMEOUT_MS - 10;
+    gps_receiver_poll(now);
+    TEST_CHECK(s_write_count == 1);
+
+    // Then silence: resent GPS_RECEIVER_MAX_RETRIES times, then reported as timed out
+    // 之后无应答：重发 GPS_RECEIVER_MAX_RETRIES 次，然后报告超时
+    for (int i = 0; i < GPS_RECEIVER_MAX_RETRIES; i++) {
+        now += GPS_RECEIVER_ACK_TIMEOUT_MS;
+        gps_receiver_poll(now);
+        TEST_CHECK(s_write_count == 2 + i);
+        TEST_CHECK(s_done.calls == 0);
+    }
+    TEST_CHECK(strcmp(s_written[GPS_RECEIVER_MAX_RETRIES], s_written[0]) == 0);
+    now += GPS_RECEIVER_ACK_TIMEOUT_MS;
+    gps_receiver_poll(now);
+    TEST_CHECK(s_done.calls == 1);
+    TEST_CHECK(s_done.result == GPS_RECEIVER_RESULT_TIMEOUT);
+    TEST_CHECK(gps_receiver_is_idle());
+
+    // A late ACK after the timeout is consumed and ignored
+    // 超时后迟到的 ACK 被吞掉并忽略
+    TEST_CHECK(gps_receiver_handle_line("$PAIR001,062,0*3F"));
+    TEST_CHECK(s_done.calls == 1);
+}
+
+static void test_queue_limits(void) {
+    reset();
+    for (int i = 0; i < GPS_RECEIVER_QUEUE_SIZE; i++) {
+        TEST_CHECK(gps_receiver_send_command("PAIR062,0,1", NULL, NULL) == 0);
+    }
+    TEST_CHECK(gps_receiver_send_command("PAIR062,0,1", NULL, NULL) == -1);
+    TEST_CHECK(gps_receiver_send_command("GPGGA", NULL, NULL) == -1);
+    char too_long[GPS_RECEIVER_SENTENCE_MAX + 1];
+    memset(too_long, '1', sizeof(too_long) - 1);
+    memcpy(too_long, "PAIR", 4);
+    too_long[sizeof(too_long) - 1] = '\0';
+    reset();
+    TEST_CHECK(gps_receiver_send_command(too_long, NULL, NULL) == -1);
+}
+
+int main(void) {
+    TEST_RUN(test_commands_go_out_one_at_a_time);
+    TEST_RUN(test_reject_and_bad_checksum);
+    TEST_RUN(test_retry_processing_and_timeout);
+    TEST_RUN(test_queue_limits);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test_common.h"
+#include "gps_logic.h"
+#include "ubx_parser.h"
+#include "connect_logic.h"
+#include "command_logic.h"
+#include "gps_aiding_logic.h"
+#include "gps_time_logic.h"
+#include "time_zone_logic.h"
+#include "track_logic.h"
+#include "geofence_logic.h"
+#include "rule_logic.h"
+
+/*
+ * Replays a receiver capture through gps_logic.c: the bytes go in on the host UART in one burst per
+ * epoch, as the receiver sends them, and the test checks the published fix and the camera frame built
+ * from it. Built once per input protocol, GPS_INPUT_PROTOCOL picks the capture.
+ * 通过 gps_logic.c 回放接收机录制数据：字节按接收机的发送方式，每个历元一批从主机串口送入，
+ * 测试检查发布的定位以及由其构建的相机帧。每种输入协议各编译一次，由 GPS_INPUT_PROTOCOL 选择录制数据。
+ */
+
+// Not in gps_logic.h, the push task is its only caller
+// 未在 gps_logic.h 中声明，推送任务是唯一调用方
+void gps_push_data(const GPS_Data_t *gps);
+
+/* Stubs of the modules around gps_logic.c that are not under test */
+/* gps_logic.c 周边不在测试范围内的模块桩 */
+
+static gps_data_push_command_frame s_pushed_frame;
+static int s_pushed_frames;
+
+connect_state_t connect_logic_get_state(void) {
+    // Keeps the push task idle, the test pushes by itself
+    // 使推送任务保持空闲，由测试自行推送
+    return BLE_INIT_COMPLETE;
+}
+
+int command_logic_push_gps_data(const gps_data_push_command_frame *gps_data) {
+    s_pushed_frame = *gps_data;
+    s_pushed_frames++;
+    return 0;
+}
+
+void gps_aiding_inject(void) {}
+void gps_aiding_on_fix(const GPS_Data_t *gps) { (void)gps; }
+void track_logic_log_fix(const GPS_Data_t *gps) { (void)gps; }
+void geofence_logic_on_fix(const GPS_Data_t *gps) { (void)gps; }
+void rule_logic_set_input(rule_input_t input, int32_t value) { (void)input; (void)value; }
+
+int gps_time_logic_init(void) { return 0; }
+void gps_time_logic_on_epoch(int64_t utc_us, int64_t first_byte_us, int64_t epoch_local_us) {
+    (void)utc_us;
+    (void)first_byte_us;
+    (void)epoch_local_us;
+}
+bool gps_time_utc_to_local(int64_t utc_us, int64_t *local_us) {
+    (void)utc_us;
+    (void)local_us;
+    return false;
+}
+gps_time_source_t gps_time_local_to_utc(int64_t local_us, int64_t *utc_us) {
+    (void)local_us;
+    (void)utc_us;
+    return GPS_TIME_SOURCE_NONE;
+}
+
+void time_zone_logic_to_local(int64_t utc_s, uint32_t *year_month_day, uint32_t *hour_minute_second) {
+    // UTC+0, the camera gets the receiver's date and time unchanged
+    // UTC+0，相机收到的日期时间与接收机一致
+    civil_date_t date = civil_date_from_days(civil_floor_div(utc_s, 86400));
+    int64_t second_of_day = utc_s - civil_floor_div(utc_s, 86400) * 86400;
+    *year_month_day = (uint32_t)date.year * 10000 + date.month * 100 + date.day;
+    *hour_minute_second = (uint32_t)(second_of_day / 3600 * 10000 + second_of_day / 60 % 60 * 100 + second_of_day % 60);
+}
+
+/* Capture */
+
+static uint8_t s_capture[8192];
+static size_t s_capture_length;
+
+static bool load_capture(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    s_capture_length = fread(s_capture, 1, sizeof(s_capture), file);
+    fclose(file);
+    return s_capture_length > 0 && s_capture_length < sizeof(s_capture);
+}
+
+// Length of the next receiver burst: everything up to the end of the next epoch, which is a GGA line
+// (the receiver sends RMC first) or a NAV-PVT packet
+// 下一批接收机输出的长度：直到下一个历元结束，即 GGA 语句（接收机先发 RMC）或一包 NAV-PVT
+static size_t next_burst(const uint8_t *data, size_t length, bool *nav_pvt_end) {
+    size_t i = 0;
+    *nav_pvt_end = false;
+    while (i < length) {
+        if (i + UBX_HEADER_LENGTH <= length && data[i] == UBX_SYNC_CHAR_1 && data[i + 1] == UBX_SYNC_CHAR_2) {
+            size_t frame_end = i + UBX_HEADER_LENGTH + (data[i + 4] | data[i + 5] << 8) + UBX_CHECKSUM_LENGTH;
+            bool nav_pvt = data[i + 2] == UBX_CLASS_NAV && data[i + 3] == UBX_ID_NAV_PVT;
+            i = frame_end < length ? frame_end : length;
+            if (nav_pvt) {
+                *nav_pvt_end = true;
+                return i;
+            }
+        } else if (data[i] == '$') {
+            const uint8_t *line_end = memchr(data + i, '\n', length - i);
+            bool gga = length - i > 6 && memcmp(data + i + 3, "GGA", 3) == 0;
+            i = line_end != NULL ? (size_t)(line_end - data) + 1 : length;
+            if (gga) {
+                return i;
+            }
+        } else {
+            i++;
+        }
+    }
+    return length;
+}
+
+// Wait until a fix newer than generation is published, false after 500 ms
+// 等待比 generation 更新的定位发布，500 毫秒后返回 false
+static bool wait_for_fix(uint32_t generation, gps_fix_t *out) {
+    for (int i = 0; i < 500; i++) {
+        gps_get_latest_fix(out);
+        if (out->generation > generation) {
+            return true;
+        }
+        vTaskDelay(1);
+    }
+    return false;
+}
+
+/* Tests */
+
+#if GPS_INPUT_PROTOCOL == GPS_INPUT_PROTOCOL_UBX
+
+static void test_ubx_configuration(void) {
+    // CFG-PRT, CFG-RATE and CFG-MSG go out at init, before any receiver output
+    // 初始化时发出 CFG-PRT、CFG-RATE 与 CFG-MSG，早于任何接收机输出
+    uint8_t expected[128];
+    size_t expected_length = 0;
+    ubx_cfg_prt_uart_t prt = {
+        .port_id = UBX_CFG_PRT_UART_PORT_ID,
+        .mode = UBX_CFG_PRT_MODE_8N1,
+        .baud_rate = GPS_UART_BAUD_RATE,
+        .in_proto_mask = UBX_PROTO_MASK_UBX | UBX_PROTO_MASK_NMEA,
+        .out_proto_mask = UBX_PROTO_MASK_UBX,
+    };
+    ubx_cfg_rate_t rate = { .meas_rate = GPS_UPDATE_INTERVAL_MS, .nav_rate = 1, .time_ref = 0 };
+    ubx_cfg_msg_t msg = { .msg_class = UBX_CLASS_NAV, .msg_id = UBX_ID_NAV_PVT, .rate = 1 };
+    expected_length += ubx_build_message(UBX_CLASS_CFG, UBX_ID_CFG_PRT, &prt, sizeof(prt),
+                                         expected + expected_length, sizeof(expected) - expected_length);
+    expected_length += ubx_build_message(UBX_CLASS_CFG, UBX_ID_CFG_RATE, &rate, sizeof(rate),
+                                         expected + expected_length, sizeof(expected) - expected_length);
+    expected_length += ubx_build_message(UBX_CLASS_CFG, UBX_ID_CFG_MSG, &msg, sizeof(msg),
+                                         expected + expected_length, sizeof(expected) - expected_length);
+
+    uint8_t written[256];
+    size_t written_length = host_uart_take_written(UART_GPS_PORT, written, sizeof(written));
+    TEST_CHECK(written_length == expected_length);
+    TEST_CHECK(memcmp(written, expected, expected_length) == 0);
+}
+
+static void test_ubx_replay(void) {
+    gps_fix_t fix;
+    gps_get_latest_fix(&fix);
+    uint32_t generation = fix.generation;
+    size_t offset = 0;
+    int epochs = 0;
+    gps_fix_t first = {0};
+
+    while (offset < s_capture_length) {
+        bool nav_pvt;
+        size_t length = next_burst(s_capture + offset, s_capture_length - offset, &nav_pvt);
+        host_uart_inject(UART_GPS_PORT, s_capture + offset, length);
+        offset += length;
+        if (!nav_pvt) {
+            // NMEA still queued from before CFG-PRT is not an epoch on the UBX input
+            // CFG-PRT 之前尚在队列中的 NMEA 在 UBX 输入下不构成历元
+            vTaskDelay(50);
+            gps_get_latest_fix(&fix);
+            TEST_CHECK(fix.generation == generation);
+            continue;
+        }
+
+        TEST_CHECK(wait_for_fix(generation, &fix));
+        generation = fix.generation;
+        if (epochs++ == 0) {
+            first = fix;
+        }
+        // Keep the receiver's 10 Hz spacing so the filter sees the real motion
+        // 保持接收机 10 Hz 的间隔，使滤波器看到真实运动
+        vTaskDelay(GPS_UPDATE_INTERVAL_MS);
+    }
+    TEST_CHECK(epochs == 20);
+
+    // First epoch 07:47:00.100, the filter starts from the packet with its per-axis accuracy
+    // 第一个历元为 07:47:00.100，滤波器以数据包及其各轴精度初始化
+    TEST_CHECK(first.data.Status == 1);
+    TEST_CHECK(first.data.Year == 25 && first.data.Month == 1 && first.data.Day == 15);
+    TEST_CHECK(first.data.Hour == 7 && first.data.Minute == 47);
+    TEST_CHECK_NEAR(first.data.Second, 0.1, 1e-9);
+    TEST_CHECK(first.data.Num_Satellites == 7);
+    TEST_CHECK_NEAR(first.data.Altitude, 47.379, 1e-6);
+    TEST_CHECK_NEAR(first.data.Horizontal_Accuracy, 1800 * M_SQRT2, 1);
+    TEST_CHECK_NEAR(first.data.Vertical_Accuracy, 2600, 1);
+    TEST_CHECK_NEAR(first.data.Speed_Accuracy, ceil(35 * M_SQRT2), 1);
+
+    // Last epoch 07:47:02.000, 1.9 s along 285.57 deg at 1.67 kn
+    // 最后一个历元为 07:47:02.000，以 1.67 节沿 285.57 度行进了 1.9 秒
+    double speed = 1.67 * 0.514444;
+    double north = speed * cos(285.57 * M_PI / 180.0);
+    double east = speed * sin(285.57 * M_PI / 180.0);
+    double latitude = 22 + 34.732734 / 60 + north * 1.9 / 6378137.0 * 180.0 / M_PI;
+    double longitude = 113 + 56.317512 / 60 + east * 1.9 / (6378137.0 * cos(22.5789 * M_PI / 180.0)) * 180.0 / M_PI;
+    TEST_CHECK_NEAR(fix.data.Second, 2.0, 1e-9);
+    TEST_CHECK_NEAR(fix.data.Latitude, latitude, 2e-6);
+    TEST_CHECK_NEAR(fix.data.Longitude, longitude, 2e-6);
+    TEST_CHECK_NEAR(fix.data.Velocity_North, north, 0.1);
+    TEST_CHECK_NEAR(fix.data.Velocity_East, east, 0.1);
+    TEST_CHECK(fix.data.Horizontal_Accuracy < first.data.Horizontal_Accuracy);
+
+    // The camera frame takes the accuracies from the fix, not the NMEA defaults
+    // 相机帧的精度取自定位，而不是 NMEA 默认值
+    gps_push_data(&first.data);
+    TEST_CHECK(s_pushed_frames == 1);
+    TEST_CHECK(s_pushed_frame.year_month_day == 20250115);
+    TEST_CHECK(s_pushed_frame.hour_minute_second == 74700);
+    TEST_CHECK(s_pushed_frame.satellite_number == 7);
+    TEST_CHECK(s_pushed_frame.height == 47379);
+    TEST_CHECK(s_pushed_frame.horizontal_accuracy == first.data.Horizontal_Accuracy);
+    TEST_CHECK(s_pushed_frame.vertical_accuracy == first.data.Vertical_Accuracy);
+    TEST_CHECK(s_pushed_frame.speed_accuracy == first.data.Speed_Accuracy);
+    TEST_CHECK(s_pushed_frame.horizontal_accuracy != GPS_DEFAULT_HORIZONTAL_ACCURACY_MM);
+}
+
+#else
+
+static void test_nmea_configuration(void) {
+    // The command engine sends the first PAIR062 and holds the rest until it is acknowledged,
+    // checksums as in the receiver manual
+    // 命令引擎发送第一条 PAIR062，其余命令等待其确认，校验和与接收机手册一致
+    vTaskDelay(50);
+    char written[256] = {0};
+    host_uart_take_written(UART_GPS_PORT, written, sizeof(written) - 1);
+    TEST_CHECK(strcmp(written, "$PAIR062,0,1*3F\r\n") == 0);
+
+    // Each ACK releases the next command: the other sentence types, navigation mode and rate
+    // 每个 ACK 放行下一条命令：其他语句类型、导航模式与更新率
+    static const char *const acks[] = { "$PAIR001,062,0*3F\r\n", "$PAIR001,062,0*3F\r\n", "$PAIR001,062,0*3F\r\n",
+                                        "$PAIR001,062,0*3F\r\n", "$PAIR001,062,0*3F\r\n", "$PAIR001,062,0*3F\r\n",
+                                        "$PAIR001,080,0*33\r\n" };
+    static const char *const next[] = { "$PAIR062,1,0*3F\r\n", "$PAIR062,2,0*3C\r\n", "$PAIR062,3,0*3D\r\n",
+                                        "$PAIR062,4,1*3B\r\n", "$PAIR062,5,0*3B\r\n", "$PAIR080,0*2E\r\n",
+                                        "$PAIR050,100*22\r\n" };
+    for (size_t i = 0; i < sizeof(acks) / sizeof(acks[0]); i++) {
+        host_uart_inject(UART_GPS_PORT, acks[i], strlen(acks[i]));
+        vTaskDelay(50);
+        memset(written, 0, sizeof(written));
+        host_uart_take_written(UART_GPS_PORT, written, sizeof(written) - 1);
+        TEST_CHECK(strcmp(written, next[i]) == 0);
+    }
+    host_uart_inject(UART_GPS_PORT, "$PAIR001,050,0*3E\r\n", 19);
+}
+
+static void test_nmea_replay(void) {
+    gps_fix_t fix;
+    gps_get_latest_fix(&fix);
+    uint32_t generation = fix.generation;
+
+    bool nav_pvt;
+    size_t length = next_burst(s_capture, s_capture_length, &nav_pvt);
+    TEST_CHECK(length == s_capture_length);
+    host_uart_inject(UART_GPS_PORT, s_capture, length);
+    TEST_CHECK(wait_for_fix(generation, &fix));
+
+    // README epoch: 2234.732734 N, 11356.317512 E, 7 satellites, HDOP 1.31, 47.379 m
+    // README 中的历元：2234.732734 N，11356.317512 E，7 颗卫星，HDOP 1.31，47.379 米
+    TEST_CHECK(fix.data.Status == 1);
+    TEST_CHECK(fix.data.Year == 25 && fix.data.Month == 1 && fix.data.Day == 15);
+    TEST_CHECK(fix.data.Hour == 7 && fix.data.Minute == 47);
+    TEST_CHECK_NEAR(fix.data.Second, 0.0, 1e-9);
+    TEST_CHECK_NEAR(fix.data.Latitude, 22 + 34.732734 / 60, 1e-9);
+    TEST_CHECK_NEAR(fix.data.Longitude, 113 + 56.317512 / 60, 1e-9);
+    TEST_CHECK_NEAR(fix.data.Altitude, 47.379, 1e-6);
+    TEST_CHECK(fix.data.Num_Satellites == 7);
+    TEST_CHECK_NEAR(fix.data.Horizontal_Accuracy, 1.31 * GPS_NMEA_UERE_M * 1000 * M_SQRT2, 2);
+
+    gps_push_data(&fix.data);
+    TEST_CHECK(s_pushed_frames == 1);
+    TEST_CHECK(s_pushed_frame.year_month_day == 20250115);
+    TEST_CHECK(s_pushed_frame.hour_minute_second == 74700);
+    TEST_CHECK(s_pushed_frame.gps_latitude == 225788789);
+    TEST_CHECK(s_pushed_frame.gps_longitude == 1139386252);
+    TEST_CHECK(s_pushed_frame.height == 47379);
+    TEST_CHECK(s_pushed_frame.satellite_number == 7);
+}
+
+#endif
+
+int main(int argc, char **argv) {
+    if (argc != 2 || !load_capture(argv[1])) {
+        fprintf(stderr, "usage: %s <capture>\n", argv[0]);
+        return 2;
+    }
+
+    initSendGpsDataToCameraTask();
+
+#if GPS_INPUT_PROTOCOL == GPS_INPUT_PROTOCOL_UBX
+    TEST_RUN(test_ubx_configuration);
+    TEST_RUN(test_ubx_replay);
+#else
+    TEST_RUN(test_nmea_configuration);
+    TEST_RUN(test_nmea_replay);
+#endif
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+
+#include "test_common.h"
+#include "rule_engine.h"
+
+/* Rules fired so far, in order */
+/* 已触发的规则，按顺序记录 */
+typedef struct {
+    uint8_t index[32];
+    int64_t at_ms[32];
+    int count;
+    int64_t now_ms;
+} fired_t;
+
+static void on_fire(const rule_engine_t *engine, uint8_t index, void *context) {
+    (void)engine;
+    fired_t *fired = context;
+    if (fired->count < 32) {
+        fired->index[fired->count] = index;
+        fired->at_ms[fired->count] = fired->now_ms;
+        fired->count++;
+    }
+}
+
+static void set_input(rule_engine_t *engine, fired_t *fired, rule_input_t input, int32_t value, int64_t now_ms) {
+    fired->now_ms = now_ms;
+    rule_engine_set_input(engine, input, value, now_ms, on_fire, fired);
+}
+
+// Poll every 100 ms up to to_ms, as the rule task would wake on the deadline
+// 每 100 毫秒轮询直到 to_ms，模拟规则任务在截止时刻唤醒
+static void poll_until(rule_engine_t *engine, fired_t *fired, int64_t from_ms, int64_t to_ms) {
+    for (int64_t t = from_ms; t <= to_ms; t += 100) {
+        fired->now_ms = t;
+        rule_engine_poll(engine, t, on_fire, fired);
+    }
+}
+
+static void test_compile_examples(void) {
+    rule_engine_t engine = {0};
+    char error[48] = "";
+    TEST_CHECK(rule_engine_compile(&engine, " SPEED>20/3 START; BATTERY<10 STOP ;SPEED<2/300 MODE:2;; ", error,
+                                   sizeof(error)) == 3);
+    TEST_CHECK(engine.count == 3);
+    TEST_CHECK(engine.rules[0].input == RULE_INPUT_SPEED && engine.rules[0].op == RULE_OP_GT);
+    TEST_CHECK(engine.rules[0].threshold == 200 && engine.rules[0].hold_ms == 3000 && engine.rules[0].action == 1);
+    TEST_CHECK(engine.rules[1].input == RULE_INPUT_BATTERY && engine.rules[1].op == RULE_OP_LT);
+    TEST_CHECK(engine.rules[1].threshold == 10 && engine.rules[1].hold_ms == 0 && engine.rules[1].action == 2);
+    TEST_CHECK(engine.rules[2].threshold == 20 && engine.rules[2].hold_ms == 300000);
+    TEST_CHECK(engine.rules[2].action == 3 && engine.rules[2].action_param == 2);
+    TEST_CHECK(engine.input_rules[RULE_INPUT_SPEED] == 0x5 && engine.input_rules[RULE_INPUT_BATTERY] == 0x2);
+
+    TEST_CHECK(rule_engine_compile(&engine, "ALT>=1500.5 STOP;SATS<=3 START;RECORDING!=1 START;MODE=10 STOP", NULL,
+                                   0) == 4);
+    TEST_CHECK(engine.rules[0].op == RULE_OP_GE && engine.rules[0].threshold == 1501);
+    TEST_CHECK(engine.rules[1].op == RULE_OP_LE && engine.rules[2].op == RULE_OP_NE && engine.rules[3].op == RULE_OP_EQ);
+
+    TEST_CHECK(rule_engine_compile(&engine, "", NULL, 0) == 0);
+    TEST_CHECK(engine.count == 0);
+}
+
+static void test_syntax_errors_leave_rules_alone(void) {
+    static const char *bad[] = {
+        "FOO<1 STOP", "SPEED>>20 START", "SPEED 20 START", "SPEED>20START", "SPEED>20 JUMP",
+        "SPEED>20/-1 START", "SPEED>20 MODE", "SPEED>20 MODE:300", "SPEED>20 STOP now",
+    };
+    rule_engine_t engine = {0};
+    TEST_CHECK(rule_engine_compile(&engine, "BATTERY<10 STOP", NULL, 0) == 1);
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        char text[64];
+        char error[48] = "";
+        snprintf(text, sizeof(text), "BATTERY<5 STOP; %s", bad[i]);
+        if (rule_engine_compile(&engine, text, error, sizeof(error)) != -1 || strcmp(error, bad[i]) != 0) {
+            printf("accepted or misreported: \"%s\" -> \"%s\"\n", bad[i], error);
+            s_test_failures++;
+        }
+    }
+    TEST_CHECK(engine.count == 1 && engine.rules[0].threshold == 10);
+
+    char text[RULE_TEXT_MAX] = "";
+    for (int i = 0; i <= RULE_MAX_RULES; i++) {
+        strcat(text, "SATS<4 STOP;");
+    }
+    char error[48] = "";
+    TEST_CHECK(rule_engine_compile(&engine, text, error, sizeof(error)) == -1);
+    TEST_CHECK(strcmp(error, "too many rules") == 0);
+}
+
+static void test_rule_without_hold_fires_on_edges(void) {
+    rule_engine_t engine = {0};
+    fired_t fired = {0};
+    rule_engine_compile(&engine, "BATTERY<10 STOP", NULL, 0);
+
+    set_input(&engine, &fired, RULE_INPUT_BATTERY, 50, 0);
+    set_input(&engine, &fired, RULE_INPUT_BATTERY, 9, 1000);
+    set_input(&engine, &fired, RULE_INPUT_BATTERY, 8, 2000);
+    TEST_CHECK(fired.count == 1 && fired.at_ms[0] == 1000);
+
+    // Re-armed once the condition turned false
+    // 条件变为假后重新布防
+    set_input(&engine, &fired, RULE_INPUT_BATTERY, 60, 3000);
+    set_input(&engine, &fired, RULE_INPUT_BATTERY, 5, 4000);
+    TEST_CHECK(fired.count == 2 && fired.at_ms[1] == 4000);
+}
+
+static void test_hold_time_restarts_when_interrupted(void) {
+    rule_engine_t engine = {0};
+    fired_t fired = {0};
+    rule_engine_compile(&engine, "SPEED>20/3 START", NULL, 0);
+
+    set_input(&engine, &fired, RULE_INPUT_SPEED, 250, 0);
+    TEST_CHECK(engine.next_deadline_ms == 3000);
+    poll_until(&engine, &fired, 0, 2000);
+    set_input(&engine, &fired, RULE_INPUT_SPEED, 150, 2000);
+    set_input(&engine, &fired, RULE_INPUT_SPEED, 260, 2500);
+    poll_until(&engine, &fired, 2100, 8000);
+    TEST_CHECK(fired.count == 1 && fired.at_ms[0] == 5500);
+    TEST_CHECK(engine.next_deadline_ms == INT64_MAX);
+
+    // Still true, nothing more
+    // 条件仍为真，不再触发
+    set_input(&engine, &fired, RULE_INPUT_SPEED, 300, 9000);
+    poll_until(&engine, &fired, 9000, 20000);
+    TEST_CHECK(fired.count == 1);
+}
+
+static void test_only_rules_of_the_input_are_evaluated(void) {
+    rule_engine_t engine = {0};
+    fired_t fired = {0};
+    rule_engine_compile(&engine, "SPEED>20/3 START;BATTERY<10 STOP;SATS<4/10 STOP", NULL, 0);
+
+    set_input(&engine, &fired, RULE_INPUT_BATTERY, 80, 0);
+    uint32_t evaluations = engine.evaluations;
+    TEST_CHECK(evaluations == 1);
+    set_input(&engine, &fired, RULE_INPUT_ALTITUDE, 100, 100);
+    set_input(&engine, &fired, RULE_INPUT_BATTERY, 80, 200);
+    TEST_CHECK(engine.evaluations == evaluations);
+    set_input(&engine, &fired, RULE_INPUT_BATTERY, 79, 300);
+    TEST_CHECK(engine.evaluations == evaluations + 1);
+
+    // Two pending hold times, the earliest one drives the deadline
+    // 两个待定的保持时间，由最早的一个决定截止时刻
+    set_input(&engine, &fired, RULE_INPUT_SATELLITES, 2, 1000);
+    set_input(&engine, &fired, RULE_INPUT_SPEED, 300, 4000);
+    TEST_CHECK(engine.next_deadline_ms == 7000);
+    poll_until(&engine, &fired, 4000, 12000);
+    TEST_CHECK(fired.count == 2);
+    TEST_CHECK(fired.index[0] == 0 && fired.at_ms[0] == 7000);
+    TEST_CHECK(fired.index[1] == 2 && fired.at_ms[1] == 11000);
+}
+
+static void test_recompile_keeps_fired_rules(void) {
+    rule_engine_t engine = {0};
+    fired_t fired = {0};
+    rule_engine_compile(&engine, "BATTERY<10 STOP;RECORDING=1 MODE:2", NULL, 0);
+
+    set_input(&engine, &fired, RULE_INPUT_BATTERY, 5, 0);
+    set_input(&engine, &fired, RULE_INPUT_RECORDING, 1, 0);
+    TEST_CHECK(fired.count == 2);
+
+    // RULE ADD: the old rules move and are re-evaluated as rule_apply() does, only the new one fires
+    // RULE ADD：原有规则位置变化，并像 rule_apply() 一样重新评估，只有新规则触发
+    TEST_CHECK(rule_engine_compile(&engine, "SPEED>20 START;RECORDING=1 MODE:2;BATTERY<10 STOP;BATTERY<10 STOP",
+                                   NULL, 0) == 4);
+    TEST_CHECK(engine.fired == 0x6 && engine.active == 0x6 && engine.evaluated == 0x6);
+    set_input(&engine, &fired, RULE_INPUT_SPEED, 300, 1000);
+    set_input(&engine, &fired, RULE_INPUT_BATTERY, 5, 1000);
+    set_input(&engine, &fired, RULE_INPUT_RECORDING, 1, 1000);
+    TEST_CHECK(fired.count == 4);
+    TEST_CHECK(fired.index[2] == 0 && fired.index[3] == 3);
+
+    // A changed threshold is a new rule
+    // 阈值改变即为新规则
+    rule_engine_compile(&engine, "BATTERY<20 STOP", NULL, 0);
+    set_input(&engine, &fired, RULE_INPUT_BATTERY, 5, 2000);
+    TEST_CHECK(fired.count == 5 && fired.index[4] == 0);
+
+    // The kept rule still re-arms
+    // 保留的规则仍会重新布防
+    rule_engine_compile(&engine, "BATTERY<20 STOP", NULL, 0);
+    set_input(&engine, &fired, RULE_INPUT_BATTERY, 5, 3000);
+    set_input(&engine, &fired, RULE_INPUT_BATTERY, 50, 4000);
+    set_input(&engine, &fired, RULE_INPUT_BATTERY, 5, 5000);
+    TEST_CHECK(fired.count == 6 && fired.at_ms[5] == 5000);
+}
+
+static void test_recompile_keeps_pending_hold(void) {
+    rule_engine_t engine = {0};
+    fired_t fired = {0};
+    rule_engine_compile(&engine, "SPEED>20/3 START", NULL, 0);
+
+    set_input(&engine, &fired, RULE_INPUT_SPEED, 250, 0);
+    poll_until(&engine, &fired, 0, 1000);
+    rule_engine_compile(&engine, "BATTERY<10 STOP;SPEED>20/3 START", NULL, 0);
+    TEST_CHECK(engine.next_deadline_ms == 3000);
+    set_input(&engine, &fired, RULE_INPUT_SPEED, 250, 1000);
+    poll_until(&engine, &fired, 1100, 6000);
+    TEST_CHECK(fired.count == 1 && fired.index[0] == 1 && fired.at_ms[0] == 3000);
+
+    rule_engine_compile(&engine, "", NULL, 0);
+    TEST_CHECK(engine.active == 0 && engine.fired == 0 && engine.next_deadline_ms == INT64_MAX);
+}
+
+int main(void) {
+    TEST_RUN(test_compile_examples);
+    TEST_RUN(test_syntax_errors_leave_rules_alone);
+    TEST_RUN(test_rule_without_hold_fires_on_edges);
+    TEST_RUN(test_hold_time_restarts_when_interrupted);
+    TEST_RUN(test_only_rules_of_the_input_are_evaluated);
+    TEST_RUN(test_recompile_keeps_fired_rules);
+    TEST_RUN(test_recompile_keeps_pending_hold);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+
+#include "test_common.h"
+#include "scan_cache.h"
+
+static void make_addr(uint8_t addr[6], uint8_t last) {
+    const uint8_t base[6] = {0x60, 0x60, 0x1F, 0x00, 0x00, 0x00};
+    memcpy(addr, base, 6);
+    addr[5] = last;
+}
+
+static void test_update_smooths_rssi(void) {
+    scan_cache_t cache;
+    scan_cache_init(&cache);
+    uint8_t addr[6];
+    make_addr(addr, 1);
+
+    scan_cache_entry_t *entry = scan_cache_update(&cache, addr, "OsmoAction5Pro-ABCD", 19, -60, 100);
+    TEST_CHECK(entry != NULL && cache.count == 1);
+    TEST_CHECK(strcmp(entry->name, "OsmoAction5Pro-ABCD") == 0);
+    TEST_CHECK(scan_cache_rssi(entry) == -60 && entry->reports == 1 && entry->first_seen_ms == 100);
+
+    // A new report weighs 1/4: -60 + (-80 - -60) / 4 = -65
+    // 新报告权重 1/4：-60 + (-80 - -60) / 4 = -65
+    entry = scan_cache_update(&cache, addr, NULL, 0, -80, 200);
+    TEST_CHECK(cache.count == 1);
+    TEST_CHECK(scan_cache_rssi(entry) == -65 && entry->last_rssi == -80);
+    TEST_CHECK(entry->reports == 2 && entry->first_seen_ms == 100 && entry->last_seen_ms == 200);
+    TEST_CHECK(strcmp(entry->name, "OsmoAction5Pro-ABCD") == 0);
+    TEST_CHECK(scan_cache_find(&cache, addr) == entry);
+
+    // A name longer than the entry is cut and terminated
+    // 超过条目长度的名称被截断并结尾
+    const char long_name[] = "a-camera-name-that-is-much-longer-than-the-cache-allows";
+    make_addr(addr, 2);
+    entry = scan_cache_update(&cache, addr, long_name, sizeof(long_name) - 1, -70, 300);
+    TEST_CHECK(strlen(entry->name) == SCAN_CACHE_NAME_MAX - 1);
+}
+
+static void test_full_cache_replaces_least_recently_heard(void) {
+    scan_cache_t cache;
+    scan_cache_init(&cache);
+    uint8_t addr[6];
+    for (int i = 0; i < SCAN_CACHE_MAX_ENTRIES; i++) {
+        make_addr(addr, (uint8_t)i);
+        scan_cache_update(&cache, addr, "cam", 3, -70, 1000 + i);
+    }
+    // Camera 0 is heard again, camera 1 is now the oldest
+    // 相机 0 再次被听到，相机 1 成为最久未听到的
+    make_addr(addr, 0);
+    scan_cache_update(&cache, addr, NULL, 0, -70, 2000);
+    make_addr(addr, 100);
+    scan_cache_update(&cache, addr, "new", 3, -50, 2001);
+
+    TEST_CHECK(cache.count == SCAN_CACHE_MAX_ENTRIES);
+    make_addr(addr, 1);
+    TEST_CHECK(scan_cache_find(&cache, addr) == NULL);
+    make_addr(addr, 0);
+    TEST_CHECK(scan_cache_find(&cache, addr) != NULL);
+    make_addr(addr, 100);
+    TEST_CHECK(scan_cache_find(&cache, addr) != NULL);
+}
+
+static void test_expire_drops_old_entries(void) {
+    scan_cache_t cache;
+    scan_cache_init(&cache);
+    uint8_t addr[6];
+    for (int i = 0; i < 4; i++) {
+        make_addr(addr, (uint8_t)i);
+        scan_cache_update(&cache, addr, NULL, 0, -70, i * 30000);
+    }
+    scan_cache_expire(&cache, 90000, 60000);
+    TEST_CHECK(cache.count == 3);
+    make_addr(addr, 0);
+    TEST_CHECK(scan_cache_find(&cache, addr) == NULL);
+    make_addr(addr, 3);
+    TEST_CHECK(scan_cache_find(&cache, addr) != NULL);
+}
+
+static bool exclude_addr(const scan_cache_entry_t *entry, void *context) {
+    return memcmp(entry->addr, context, 6) == 0;
+}
+
+static void test_best_respects_window_threshold_and_exclusion(void) {
+    scan_cache_t cache;
+    scan_cache_init(&cache);
+    uint8_t addr[6];
+    make_addr(addr, 1);
+    scan_cache_update(&cache, addr, NULL, 0, -40, 1000);     // Strongest, but heard before this scan
+                                                             // 最强，但在本次扫描之前听到
+    make_addr(addr, 2);
+    scan_cache_update(&cache, addr, NULL, 0, -55, 5000);
+    make_addr(addr, 3);
+    scan_cache_update(&cache, addr, NULL, 0, -62, 5100);
+    make_addr(addr, 4);
+    scan_cache_update(&cache, addr, NULL, 0, -90, 5200);     // Below the threshold
+                                                             // 低于门限
+
+    const scan_cache_entry_t *best = scan_cache_best(&cache, 0, -80, NULL, NULL);
+    TEST_CHECK(best != NULL && best->addr[5] == 1);
+    best = scan_cache_best(&cache, 4000, -80, NULL, NULL);
+    TEST_CHECK(best != NULL && best->addr[5] == 2);
+
+    // Camera 2 is held by another link
+    // 相机 2 已被其他链路占用
+    make_addr(addr, 2);
+    best = scan_cache_best(&cache, 4000, -80, exclude_addr, addr);
+    TEST_CHECK(best != NULL && best->addr[5] == 3);
+
+    TEST_CHECK(scan_cache_best(&cache, 4000, -50, NULL, NULL) == NULL);
+    TEST_CHECK(scan_cache_best(&cache, 6000, -100, NULL, NULL) == NULL);
+}
+
+static void test_connect_early_needs_confirmation_for_new_cameras(void) {
+    scan_cache_t cache;
+    scan_cache_init(&cache);
+    uint8_t addr[6];
+
+    // A single report of a new camera, nothing else heard: wait for a second report
+    // 新相机仅一次报告且未听到其他相机：等待第二次报告
+    make_addr(addr, 1);
+    scan_cache_entry_t *entry = scan_cache_update(&cache, addr, NULL, 0, -55, 5000);
+    TEST_CHECK(!scan_cache_connect_early(&cache, entry, 4000, -80, -60, 10, NULL, NULL));
+    entry = scan_cache_update(&cache, addr, NULL, 0, -55, 5100);
+    TEST_CHECK(scan_cache_connect_early(&cache, entry, 4000, -80, -60, 10, NULL, NULL));
+
+    // A second report that pulls the smoothed RSSI under the early threshold does not connect
+    // 第二次报告将平滑 RSSI 拉到提前连接门限以下时不连接
+    make_addr(addr, 2);
+    entry = scan_cache_update(&cache, addr, NULL, 0, -58, 5000);
+    entry = scan_cache_update(&cache, addr, NULL, 0, -70, 5100);
+    TEST_CHECK(scan_cache_rssi(entry) == -61);
+    TEST_CHECK(!scan_cache_connect_early(&cache, entry, 4000, -80, -60, 10, NULL, NULL));
+}
+
+static void test_connect_early_margin_over_runner_up(void) {
+    scan_cache_t cache;
+    scan_cache_init(&cache);
+    uint8_t addr[6];
+    make_addr(addr, 1);
+    scan_cache_update(&cache, addr, NULL, 0, -40, 1000);     // Heard before this scan, not a runner-up
+                                                             // 在本次扫描之前听到，不参与次强比较
+    make_addr(addr, 2);
+    scan_cache_update(&cache, addr, NULL, 0, -66, 5000);
+
+    // -55 leads -66 by 11 dB, -58 by 8 dB only
+    // -55 领先 -66 达 11 dB，-58 仅领先 8 dB
+    make_addr(addr, 3);
+    scan_cache_entry_t *entry = scan_cache_update(&cache, addr, NULL, 0, -55, 5100);
+    TEST_CHECK(scan_cache_connect_early(&cache, entry, 4000, -80, -60, 10, NULL, NULL));
+    make_addr(addr, 4);
+    entry = scan_cache_update(&cache, addr, NULL, 0, -58, 5200);
+    TEST_CHECK(!scan_cache_connect_early(&cache, entry, 4000, -80, -60, 10, NULL, NULL));
+
+    // A runner-up held by another link does not count, the camera itself can be held too
+    // 被其他链路占用的次强相机不计入，该相机本身也可能被占用
+    make_addr(addr, 3);
+    TEST_CHECK(scan_cache_connect_early(&cache, entry, 4000, -80, -60, 10, exclude_addr, addr) == false);
+    entry = scan_cache_find(&cache, addr);
+    TEST_CHECK(!scan_cache_connect_early(&cache, entry, 4000, -80, -60, 10, exclude_addr, addr));
+}
+
+static void test_connect_early_known_camera(void) {
+    scan_cache_t cache;
+    scan_cache_init(&cache);
+    uint8_t addr[6];
+    make_addr(addr, 1);
+
+    // A known camera connects on its first report above the minimum, the flag is read on every call
+    // 已知相机在第一次高于最低门限的报告时即连接，每次调用都读取该标志
+    scan_cache_entry_t *entry = scan_cache_update(&cache, addr, NULL, 0, -75, 5000);
+    entry->known = true;
+    TEST_CHECK(scan_cache_connect_early(&cache, entry, 4000, -80, -60, 10, NULL, NULL));
+    entry->known = false;
+    TEST_CHECK(!scan_cache_connect_early(&cache, entry, 4000, -80, -60, 10, NULL, NULL));
+
+    make_addr(addr, 2);
+    entry = scan_cache_update(&cache, addr, NULL, 0, -85, 5000);
+    entry->known = true;
+    TEST_CHECK(!scan_cache_connect_early(&cache, entry, 4000, -80, -60, 10, NULL, NULL));
+}
+
+int main(void) {
+    TEST_RUN(test_update_smooths_rssi);
+    TEST_RUN(test_full_cache_replaces_least_recently_heard);
+    TEST_RUN(test_expire_drops_old_entries);
+    TEST_RUN(test_best_respects_window_threshold_and_exclusion);
+    TEST_RUN(test_connect_early_needs_confirmation_for_new_cameras);
+    TEST_RUN(test_connect_early_margin_over_runner_up);
+    TEST_RUN(test_connect_early_known_camera);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "test_common.h"
+#include "track_codec.h"
+
+#define TEST_POINTS 2000
+
+static track_point_t s_points[TEST_POINTS];
+static uint8_t s_block[16384];
+
+// A drive with stops, turns, a dropped epoch and a jump over the antimeridian
+// 一段包含停车、转弯、丢失历元和跨越反子午线跳变的行程
+static void make_track(void) {
+    uint32_t rng = 7;
+    track_point_t point = {.time_ms = 1751328000000LL, .latitude = -33868800, .longitude = 179999000, .altitude = 120};
+    int32_t vel_lat = 0, vel_lon = 0;
+    for (int i = 0; i < TEST_POINTS; i++) {
+        rng = rng * 1103515245u + 12345u;
+        if (i % 400 < 100) {
+            vel_lat = 0;
+            vel_lon = 0;
+        } else if (i % 50 == 0) {
+            vel_lat = (int32_t)(rng >> 20) % 200 - 100;
+            vel_lon = (int32_t)(rng >> 12) % 200 - 100;
+        }
+        point.time_ms += (i == 777) ? 300 : 100;
+        point.latitude += vel_lat + (int32_t)(rng >> 29) - 4;
+        point.longitude += vel_lon;
+        point.altitude += (int32_t)((rng >> 8) & 3) - 1;
+        if (point.longitude > 180000000) {
+            point.longitude -= 360000000;
+        }
+        s_points[i] = point;
+    }
+}
+
+// Field by field, track_point_t has padding
+// 逐字段比较，track_point_t 含填充字节
+static bool same_points(const track_point_t *a, const track_point_t *b, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (a[i].time_ms != b[i].time_ms || a[i].latitude != b[i].latitude || a[i].longitude != b[i].longitude ||
+            a[i].altitude != b[i].altitude) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t decode_all(const uint8_t *buffer, size_t length, track_point_t *out, size_t max_points) {
+    track_decoder_t dec;
+    track_decoder_begin(&dec, buffer, length);
+    size_t count = 0;
+    while (count < max_points && track_decoder_next(&dec, &out[count])) {
+        count++;
+    }
+    return count;
+}
+
+static void test_round_trip_is_exact(void) {
+    static track_point_t decoded[TEST_POINTS];
+    make_track();
+    track_encoder_t enc;
+    track_encoder_begin(&enc, s_block, sizeof(s_block));
+    for (int i = 0; i < TEST_POINTS; i++) {
+        TEST_CHECK(track_encoder_add(&enc, &s_points[i]));
+    }
+    TEST_CHECK(decode_all(s_block, enc.length, decoded, TEST_POINTS) == TEST_POINTS);
+    TEST_CHECK(same_points(decoded, s_points, TEST_POINTS));
+    // Far below the 20 bytes of a raw point
+    // 远小于原始点的 20 字节
+    TEST_CHECK(enc.length < TEST_POINTS * 4);
+}
+
+static void test_stationary_points_collapse_into_runs(void) {
+    track_point_t point = {.time_ms = 1000, .latitude = 22543321, .longitude = 113951234, .altitude = 350};
+    track_encoder_t enc;
+    track_encoder_begin(&enc, s_block, sizeof(s_block));
+    for (int i = 0; i < 1000; i++) {
+        TEST_CHECK(track_encoder_add(&enc, &point));
+        point.time_ms += 100;
+    }
+    // Key, one FULL record for the time step, then RUN bytes of up to 128 points
+    // 关键帧、一个记录时间步长的 FULL 记录，之后是每个最多 128 点的 RUN 字节
+    TEST_CHECK(enc.length <= TRACK_RECORD_KEY_LENGTH + 3 + 998 / 128 + 1);
+
+    track_point_t decoded[1000];
+    TEST_CHECK(decode_all(s_block, enc.length, decoded, 1000) == 1000);
+    TEST_CHECK(decoded[999].time_ms == 1000 + 999 * 100);
+    TEST_CHECK(decoded[999].latitude == point.latitude);
+}
+
+static void test_full_block_keeps_every_added_point(void) {
+    static track_point_t decoded[TEST_POINTS];
+    make_track();
+    uint8_t small[256];
+    track_encoder_t enc;
+    track_encoder_begin(&enc, small, sizeof(small));
+    size_t added = 0;
+    while (added < TEST_POINTS && track_encoder_add(&enc, &s_points[added])) {
+        added++;
+    }
+    TEST_CHECK(added > 0 && added < TEST_POINTS);
+    TEST_CHECK(enc.length <= sizeof(small));
+    TEST_CHECK(decode_all(small, enc.length, decoded, TEST_POINTS) == added);
+    TEST_CHECK(same_points(decoded, s_points, added));
+
+    // The point that did not fit starts the next block
+    // 放不下的点作为下一个块的开始
+    track_encoder_begin(&enc, small, sizeof(small));
+    TEST_CHECK(track_encoder_add(&enc, &s_points[added]));
+    TEST_CHECK(decode_all(small, enc.length, decoded, 1) == 1);
+    TEST_CHECK(same_points(decoded, &s_points[added], 1));
+}
+
+static void test_truncated_block_stops_cleanly(void) {
+    static track_point_t decoded[TEST_POINTS];
+    make_track();
+    track_encoder_t enc;
+    track_encoder_begin(&enc, s_block, sizeof(s_block));
+    for (int i = 0; i < 300; i++) {
+        track_encoder_add(&enc, &s_points[i]);
+    }
+    for (size_t cut = 0; cut < enc.length; cut += 7) {
+        size_t count = decode_all(s_block, cut, decoded, TEST_POINTS);
+        TEST_CHECK(count <= 300);
+        TEST_CHECK(same_points(decoded, s_points, count));
+    }
+    // A block that does not start with a key is rejected
+    // 不以关键帧开始的块被拒绝
+    TEST_CHECK(decode_all(s_block + 1, enc.length - 1, decoded, TEST_POINTS) == 0);
+}
+
+int main(void) {
+    TEST_RUN(test_round_trip_is_exact);
+    TEST_RUN(test_stationary_points_collapse_into_runs);
+    TEST_RUN(test_full_block_keeps_every_added_point);
+    TEST_RUN(test_truncated_block_stops_cleanly);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+
+#include "test_common.h"
+#include "ubx_parser.h"
+
+static size_t feed_all(ubx_parser_t *parser, const uint8_t *data, size_t length, int *messages) {
+    size_t last_end = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (ubx_parser_feed(parser, data[i])) {
+            (*messages)++;
+            last_end = i + 1;
+        }
+    }
+    return last_end;
+}
+
+static void test_cfg_rate_poll_matches_reference(void) {
+    // CFG-RATE poll as listed in the u-blox protocol description
+    // u-blox 协议手册中的 CFG-RATE 轮询帧
+    const uint8_t expected[] = {0xB5, 0x62, 0x06, 0x08, 0x00, 0x00, 0x0E, 0x30};
+    uint8_t frame[16];
+    size_t length = ubx_build_message(UBX_CLASS_CFG, UBX_ID_CFG_RATE, NULL, 0, frame, sizeof(frame));
+    TEST_CHECK(length == sizeof(expected));
+    TEST_CHECK(memcmp(frame, expected, sizeof(expected)) == 0);
+    TEST_CHECK(ubx_build_message(UBX_CLASS_CFG, UBX_ID_CFG_RATE, NULL, 0, frame, 7) == 0);
+}
+
+static void test_nav_pvt_round_trip(void) {
+    ubx_nav_pvt_t pvt = {0};
+    pvt.year = 2025;
+    pvt.month = 6;
+    pvt.day = 30;
+    pvt.hour = 23;
+    pvt.min = 59;
+    pvt.sec = 60;
+    pvt.nano = -1234;
+    pvt.valid = UBX_NAV_PVT_VALID_DATE | UBX_NAV_PVT_VALID_TIME;
+    pvt.fix_type = UBX_FIX_TYPE_3D;
+    pvt.flags = UBX_NAV_PVT_FLAGS_FIX_OK;
+    pvt.num_sv = 17;
+    pvt.lat = 225433210;
+    pvt.lon = -1139512345;
+    pvt.h_msl = 35120;
+    pvt.vel_n = -1500;
+    pvt.g_speed = 2100;
+
+    uint8_t stream[256];
+    size_t offset = 0;
+    // Noise and a repeated first sync char before the frame
+    // 帧前的噪声和重复的第一个同步字符
+    const uint8_t noise[] = {0x00, 0x62, 0xB5, 0x13, 0xB5, 0xB5};
+    memcpy(stream, noise, sizeof(noise));
+    offset = sizeof(noise) - 1;
+    size_t length = ubx_build_message(UBX_CLASS_NAV, UBX_ID_NAV_PVT, &pvt, sizeof(pvt), stream + offset,
+                                      sizeof(stream) - offset);
+    TEST_CHECK(length == UBX_HEADER_LENGTH + UBX_NAV_PVT_PAYLOAD_LENGTH + UBX_CHECKSUM_LENGTH);
+
+    ubx_parser_t parser;
+    ubx_parser_init(&parser);
+    int messages = 0;
+    feed_all(&parser, stream, offset + length, &messages);
+    TEST_CHECK(messages == 1);
+    TEST_CHECK(parser.checksum_errors == 0);
+
+    ubx_nav_pvt_t decoded;
+    TEST_CHECK(ubx_decode_nav_pvt(&parser, &decoded));
+    TEST_CHECK(memcmp(&decoded, &pvt, sizeof(pvt)) == 0);
+}
+
+static void test_bad_checksum_is_dropped_and_parser_recovers(void) {
+    ubx_cfg_rate_t rate = {.meas_rate = 100, .nav_rate = 1, .time_ref = 0};
+    uint8_t good[32];
+    size_t length = ubx_build_message(UBX_CLASS_CFG, UBX_ID_CFG_RATE, &rate, sizeof(rate), good, sizeof(good));
+    uint8_t bad[32];
+    memcpy(bad, good, length);
+    bad[length - 1] ^= 0xFF;
+
+    ubx_parser_t parser;
+    ubx_parser_init(&parser);
+    int messages = 0;
+    feed_all(&parser, bad, length, &messages);
+    TEST_CHECK(messages == 0);
+    TEST_CHECK(parser.checksum_errors == 1);
+
+    feed_all(&parser, good, length, &messages);
+    TEST_CHECK(messages == 1);
+    TEST_CHECK(parser.msg_class == UBX_CLASS_CFG && parser.msg_id == UBX_ID_CFG_RATE);
+    TEST_CHECK(parser.length == sizeof(rate));
+
+    // A complete message that is not NAV-PVT does not decode as one
+    // 非 NAV-PVT 的完整消息不能按 NAV-PVT 解码
+    ubx_nav_pvt_t decoded;
+    TEST_CHECK(!ubx_decode_nav_pvt(&parser, &decoded));
+}
+
+static void test_oversized_payload_is_dropped(void) {
+    const uint8_t header[] = {0xB5, 0x62, 0x01, 0x35, (UBX_MAX_PAYLOAD_LENGTH + 1) & 0xFF,
+                              (UBX_MAX_PAYLOAD_LENGTH + 1) >> 8};
+    ubx_parser_t parser;
+    ubx_parser_init(&parser);
+    int messages = 0;
+    feed_all(&parser, header, sizeof(header), &messages);
+    TEST_CHECK(parser.overflow_errors == 1);
+    TEST_CHECK(parser.state == UBX_STATE_SYNC_1);
+}
+
+int main(void) {
+    TEST_RUN(test_cfg_rate_poll_matches_reference);
+    TEST_RUN(test_nav_pvt_round_trip);
+    TEST_RUN(test_bad_checksum_is_dropped_and_parser_recovers);
+    TEST_RUN(test_oversized_payload_is_dropped);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 DJI
+# SPDX-License-Identifier: MIT
+"""
+Build a geofence image for the "geofence" partition from a JSON description.
+根据 JSON 描述生成 "geofence" 分区的地理围栏镜像。
+
+    python3 tools/geofence_builder.py fences.json -o geofence.bin
+    esptool.py write_flash 0x1D0000 geofence.bin
+
+    {
+      "cell_m": 200,
+      "fences": [
+        {"circle": [22.5431, 113.9510, 30], "enter": "start_record", "exit": "stop_record", "hysteresis_m": 5},
+        {"polygon": [[22.54, 113.95], [22.55, 113.95], [22.55, 113.96]], "enter": "switch_mode", "mode": 10}
+      ]
+    }
+
+circle is [lat, lon, radius_m], polygon a list of [lat, lon]. Actions: none, start_record, stop_record,
+switch_mode (with "mode", a camera_mode_t value). Fence ids in device logs are the list positions.
+circle 为 [纬度, 经度, 半径米]，polygon 为 [纬度, 经度] 列表。动作：none、start_record、stop_record、
+switch_mode（需配合 "mode"，即 camera_mode_t 数值）。设备日志中的围栏编号即列表中的位置。
+
+Image layout: utils/geofence/geofence_index.h
+镜像格式见 utils/geofence/geofence_index.h
+"""
+
+import argparse
+import json
+import math
+import struct
+import sys
+import zlib
+
+MAGIC = 0x4E454647
+VERSION = 1
+PARTITION_SIZE = 0x30000
+MAX_CELLS = 16384
+
+HEADER = struct.Struct("<IHHiiiiHHIIII")
+RECORD = struct.Struct("<BBBBHHiiIIIiiii")
+VERTEX = struct.Struct("<ii")
+
+SHAPE_CIRCLE = 0
+SHAPE_POLYGON = 1
+ACTIONS = {"none": 0, "start_record": 1, "stop_record": 2, "switch_mode": 3}
+
+SCALE = 1e7
+# Latitude units (1e-7 degree) per metre / 每米对应的纬度单位（1e-7 度）
+UNITS_PER_M = SCALE / (6378137.0 * math.pi / 180.0)
+
+
+def to_e7(value):
+    return int(round(value * SCALE))
+
+
+def build_fence(fence, vertices):
+    """Record fields except the vertices / 除顶点外的记录字段"""
+    hysteresis = int(round(fence.get("hysteresis_m", 5.0) * UNITS_PER_M))
+    enter = ACTIONS[fence.get("enter", "none")]
+    leave = ACTIONS[fence.get("exit", "none")]
+    param = int(fence.get("mode", 0))
+
+    if "circle" in fence:
+        lat, lon, radius_m = fence["circle"]
+        cos_lat = math.cos(math.radians(lat))
+        radius = int(round(radius_m * UNITS_PER_M))
+        reach_lat = radius + hysteresis + 1
+        reach_lon = int(math.ceil(reach_lat / cos_lat)) + 1
+        return {
+            "shape": SHAPE_CIRCLE, "enter": enter, "exit": leave, "param": param,
+            "cos": min(65535, int(round(cos_lat * 32768))), "vertex_count": 0,
+            "lat": to_e7(lat), "lon": to_e7(lon), "radius": radius, "hysteresis": hysteresis, "first_vertex": 0,
+            "box": (to_e7(lat) - reach_lat, to_e7(lon) - reach_lon, to_e7(lat) + reach_lat, to_e7(lon) + reach_lon),
+        }
+
+    points = [(to_e7(lat), to_e7(lon)) for lat, lon in fence["polygon"]]
+    if len(points) < 3 or len(points) > 65535:
+        raise ValueError("polygon needs 3 to 65535 points")
+    lats = [p[0] for p in points]
+    lons = [p[1] for p in points]
+    ref_lat = (min(lats) + max(lats)) // 2
+    ref_lon = (min(lons) + max(lons)) // 2
+    cos_lat = math.cos(math.radians(ref_lat / SCALE))
+    reach_lon = int(math.ceil(hysteresis / cos_lat)) + 1
+    first = len(vertices)
+    vertices.extend(points)
+    return {
+        "shape": SHAPE_POLYGON, "enter": enter, "exit": leave, "param": param,
+        "cos": min(65535, int(round(cos_lat * 32768))), "vertex_count": len(points),
+        "lat": ref_lat, "lon": ref_lon, "radius": 0, "hysteresis": hysteresis, "first_vertex": first,
+        "box": (min(lats) - hysteresis - 1, min(lons) - reach_lon, max(lats) + hysteresis + 1, max(lons) + reach_lon),
+    }
+
+
+def build_image(description):
+    vertices = []
+    fences = [build_fence(fence, vertices) for fence in description["fences"]]
+    if not fences or len(fences) > 65535:
+        raise ValueError("need 1 to 65535 fences")
+
+    origin_lat = min(f["box"][0] for f in fences)
+    origin_lon = min(f["box"][1] for f in fences)
+    top_lat = max(f["box"][2] for f in fences)
+    top_lon = max(f["box"][3] for f in fences)
+    mean_cos = math.cos(math.radians((origin_lat + top_lat) / 2 / SCALE))
+
+    # 网格单元过多时放大单元尺寸
+    # Grow the cells until the grid fits
+    cell_m = float(description.get("cell_m", 200.0))
+    while True:
+        cell_lat = max(1, int(round(cell_m * UNITS_PER_M)))
+        cell_lon = max(1, int(round(cell_m * UNITS_PER_M / mean_cos)))
+        rows = (top_lat - origin_lat) // cell_lat + 1
+        cols = (top_lon - origin_lon) // cell_lon + 1
+        if rows * cols <= MAX_CELLS:
+            break
+        cell_m *= 1.5
+
+    cells = [[] for _ in range(rows * cols)]
+    for fence_id, fence in enumerate(fences):
+        min_lat, min_lon, max_lat, max_lon = fence["box"]
+        for row in range((min_lat - origin_lat) // cell_lat, (max_lat - origin_lat) // cell_lat + 1):
+            for col in range((min_lon - origin_lon) // cell_lon, (max_lon - origin_lon) // cell_lon + 1):
+                cells[row * cols + col].append(fence_id)
+
+    body = bytearray()
+    for f in fences:
+        body += RECORD.pack(f["shape"], f["enter"], f["exit"], f["param"], f["cos"], f["vertex_count"],
+                            f["lat"], f["lon"], f["radius"], f["hysteresis"], f["first_vertex"], *f["box"])
+    start = 0
+    for cell in cells:
+        body += struct.pack("<I", start)
+        start += len(cell)
+    body += struct.pack("<I", start)
+    for cell in cells:
+        body += struct.pack("<%dH" % len(cell), *cell)
+    body += bytes(-len(body) % 4)
+    for lat, lon in vertices:
+        body += VERTEX.pack(lat, lon)
+
+    header = HEADER.pack(MAGIC, VERSION, len(fences), origin_lat, origin_lon, cell_lat, cell_lon, rows, cols,
+                         start, len(vertices), HEADER.size + len(body), zlib.crc32(body))
+    stats = {"fences": len(fences), "rows": rows, "cols": cols, "cell_m": cell_m, "entries": start,
+             "max_per_cell": max(len(cell) for cell in cells)}
+    return header + bytes(body), stats
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("description", help="fence description (JSON)")
+    parser.add_argument("-o", "--output", required=True, help="image file to write")
+    args = parser.parse_args()
+
+    with open(args.description) as f:
+        image, stats = build_image(json.load(f))
+    if len(image) > PARTITION_SIZE:
+        sys.exit("image is %d bytes, partition holds %d" % (len(image), PARTITION_SIZE))
+    with open(args.output, "wb") as f:
+        f.write(image)
+
+    print("%d fences, %dx%d cells of %.0f m, %d cell entries (max %d per cell), %d bytes"
+          % (stats["fences"], stats["rows"], stats["cols"], stats["cell_m"], stats["entries"],
+             stats["max_per_cell"], len(image)), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 DJI
+# SPDX-License-Identifier: MIT
+"""
+Summarise GPS push latency from a monitor log.
+从串口监视日志中汇总 GPS 推送时延。
+
+    idf.py monitor | tee gps.log
+    python3 tools/latency_report.py gps.log
+
+Reads the "GPS latency" and "GPS age histogram" lines logged by logic/gps_logic.c every
+GPS_LATENCY_LOG_INTERVAL pushes and prints per-stage averages and the age distribution.
+读取 logic/gps_logic.c 每 GPS_LATENCY_LOG_INTERVAL 次推送打印的 "GPS latency" 与 "GPS age histogram"
+日志行，输出各阶段平均时延与时延分布。
+"""
+
+import argparse
+import re
+
+STAGES = ("rx", "parse", "hold", "push", "age")
+LATENCY_LINE = re.compile(r"GPS latency n=(\d+) " + " ".join(r"%s=(\d+)" % s for s in STAGES) + r" max=(\d+) us")
+HISTOGRAM_LINE = re.compile(r"GPS age histogram (\d+)ms:((?: \d+)+)")
+
+
+def percentile(histogram, bucket_ms, fraction):
+    total = sum(histogram)
+    target = fraction * total
+    seen = 0
+    for i, count in enumerate(histogram):
+        seen += count
+        if seen >= target:
+            return (i + 1) * bucket_ms
+    return len(histogram) * bucket_ms
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("log")
+    args = parser.parse_args()
+
+    count = 0
+    sums = dict.fromkeys(STAGES, 0)
+    age_max = 0
+    histogram = None
+    bucket_ms = 10
+
+    with open(args.log, errors="replace") as f:
+        for line in f:
+            match = LATENCY_LINE.search(line)
+            if match:
+                n = int(match.group(1))
+                count += n
+                for i, stage in enumerate(STAGES):
+                    sums[stage] += n * int(match.group(i + 2))
+                age_max = max(age_max, int(match.group(len(STAGES) + 2)))
+                continue
+            match = HISTOGRAM_LINE.search(line)
+            if match:
+                bucket_ms = int(match.group(1))
+                counts = [int(v) for v in match.group(2).split()]
+                histogram = counts if histogram is None else [a + b for a, b in zip(histogram, counts)]
+
+    if count == 0 or histogram is None:
+        raise SystemExit("no GPS latency lines found")
+
+    print("pushes: %d" % count)
+    print("stage averages (ms):")
+    for stage in STAGES:
+        print("  %-6s %7.1f" % (stage, sums[stage] / count / 1000))
+    print("age max: %.1f ms" % (age_max / 1000))
+    print("age percentiles (bucket upper bound): p50 <= %d ms, p90 <= %d ms, p99 <= %d ms"
+          % tuple(percentile(histogram, bucket_ms, p) for p in (0.5, 0.9, 0.99)))
+
+    total = sum(histogram)
+    peak = max(histogram)
+    print("age distribution:")
+    for i, value in enumerate(histogram):
+        label = ">=%d" % (i * bucket_ms) if i == len(histogram) - 1 else "%d-%d" % (i * bucket_ms, (i + 1) * bucket_ms)
+        bar = "#" * (50 * value // peak if peak else 0)
+        print("  %9s ms %6.2f%% %s" % (label, 100.0 * value / total, bar))
+
+
+if __name__ == "__main__":
+    main()
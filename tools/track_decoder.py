@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 DJI
+# SPDX-License-Identifier: MIT
+"""
+Decode a dump of the "track" partition into CSV or GPX.
+将 "track" 分区的转储解码为 CSV 或 GPX。
+
+    esptool.py read_flash 0x110000 0xC0000 track.bin
+    python3 tools/track_decoder.py track.bin --format gpx > track.gpx
+
+Page and record layout: logic/track_logic.h, utils/track/track_codec.h
+页与记录格式见 logic/track_logic.h、utils/track/track_codec.h
+"""
+
+import argparse
+import datetime
+import struct
+import sys
+import zlib
+
+PAGE_SIZE = 256
+PAGE_MAGIC = 0x4B54
+PAGE_VERSION = 1
+HEADER = struct.Struct("<HIBB")
+PAYLOAD_SIZE = PAGE_SIZE - HEADER.size - 4
+COORD_SCALE = 1e6
+
+TAG_KEY = 0xE0
+KEY_LENGTH = 21
+
+
+def read_pages(dump):
+    """Valid pages sorted oldest first / 按从旧到新排序的有效页"""
+    pages = []
+    for offset in range(0, len(dump) - PAGE_SIZE + 1, PAGE_SIZE):
+        page = dump[offset:offset + PAGE_SIZE]
+        magic, sequence, length, version = HEADER.unpack_from(page)
+        if magic != PAGE_MAGIC or version != PAGE_VERSION or length > PAYLOAD_SIZE:
+            continue
+        (crc,) = struct.unpack_from("<I", page, PAGE_SIZE - 4)
+        if crc != zlib.crc32(page[:PAGE_SIZE - 4]):
+            continue
+        pages.append((sequence, page[HEADER.size:HEADER.size + length]))
+    pages.sort()
+    return pages
+
+
+def read_varint(payload, offset):
+    value = 0
+    shift = 0
+    while True:
+        byte = payload[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if byte & 0x80 == 0:
+            return (value >> 1) ^ -(value & 1), offset
+
+
+def sign_extend(value, bits):
+    return value - (1 << bits) if value & (1 << (bits - 1)) else value
+
+
+def decode_block(payload):
+    """Yield (time_ms, lat, lon, alt_dm) from one page / 从一页中输出点"""
+    last = None
+    delta = [0, 0, 0, 0]
+    offset = 0
+
+    def apply(dd):
+        nonlocal last
+        fields = [last[i] + delta[i] + dd[i] for i in range(4)]
+        for i in range(4):
+            delta[i] = fields[i] - last[i]
+        last = fields
+        return tuple(fields)
+
+    try:
+        while offset < len(payload):
+            tag = payload[offset]
+            if tag == TAG_KEY:
+                last = list(struct.unpack_from("<qiii", payload, offset + 1))
+                delta = [0, 0, 0, 0]
+                offset += KEY_LENGTH
+                yield tuple(last)
+            elif last is None:
+                return
+            elif tag & 0x80 == 0:
+                offset += 1
+                for _ in range(tag + 1):
+                    yield apply([0, 0, 0, 0])
+            elif tag & 0xC0 == 0x80:
+                small = (payload[offset] << 8) | payload[offset + 1]
+                offset += 2
+                yield apply([0, sign_extend((small >> 9) & 0x1F, 5),
+                             sign_extend((small >> 4) & 0x1F, 5), sign_extend(small & 0x0F, 4)])
+            elif tag & 0xF0 == 0xC0:
+                offset += 1
+                dd = [0, 0, 0, 0]
+                for i in range(4):
+                    if tag & (0x08 >> i):
+                        dd[i], offset = read_varint(payload, offset)
+                yield apply(dd)
+            else:
+                return
+    except (IndexError, struct.error):
+        return
+
+
+def iso_time(time_ms):
+    moment = datetime.datetime.fromtimestamp(time_ms / 1000, tz=datetime.timezone.utc)
+    return moment.strftime("%Y-%m-%dT%H:%M:%S.") + "%03dZ" % (time_ms % 1000)
+
+
+def write_csv(points, out):
+    out.write("time,latitude,longitude,altitude_m\n")
+    for time_ms, lat, lon, alt in points:
+        out.write("%s,%.6f,%.6f,%.1f\n" % (iso_time(time_ms), lat / COORD_SCALE, lon / COORD_SCALE, alt / 10))
+
+
+def write_gpx(points, out):
+    out.write('<?xml version="1.0" encoding="UTF-8"?>\n')
+    out.write('<gpx version="1.1" creator="Osmo-GPS-Controller" xmlns="http://www.topografix.com/GPX/1/1">\n')
+    out.write("<trk><trkseg>\n")
+    for time_ms, lat, lon, alt in points:
+        out.write('<trkpt lat="%.6f" lon="%.6f"><ele>%.1f</ele><time>%s</time></trkpt>\n'
+                  % (lat / COORD_SCALE, lon / COORD_SCALE, alt / 10, iso_time(time_ms)))
+    out.write("</trkseg></trk>\n</gpx>\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("dump", help="raw partition image read with esptool.py read_flash")
+    parser.add_argument("--format", choices=("csv", "gpx"), default="csv")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        dump = f.read()
+
+    pages = read_pages(dump)
+    points = [point for _, payload in pages for point in decode_block(payload)]
+    print("%d pages, %d points" % (len(pages), len(points)), file=sys.stderr)
+
+    (write_gpx if args.format == "gpx" else write_csv)(points, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
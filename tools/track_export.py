@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 DJI
+# SPDX-License-Identifier: MIT
+"""
+Pull the track log off the device over the console UART (needs pyserial).
+通过控制台串口从设备导出轨迹（需要 pyserial）。
+
+    python3 tools/track_export.py /dev/ttyUSB0 --format gpx -o track.gpx
+    python3 tools/track_export.py /dev/ttyUSB0 --format raw -o track.bin   # fastest, decode with track_decoder.py
+
+An interrupted export prints its resume position; pass it back with --resume SEQ INDEX and -a.
+导出中断时会打印续传位置，使用 --resume SEQ INDEX 和 -a 继续。
+
+Protocol: logic/export_logic.h
+"""
+
+import argparse
+import sys
+import zlib
+
+import serial
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("port")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--format", choices=("csv", "gpx", "raw"), default="csv")
+    parser.add_argument("--resume", nargs=2, type=int, metavar=("SEQ", "INDEX"))
+    parser.add_argument("-o", "--output", required=True)
+    parser.add_argument("-a", "--append", action="store_true", help="append to the output, for --resume")
+    args = parser.parse_args()
+
+    position = args.resume or (0, 0)
+    last_number = -1
+    command = "EXPORT %s" % args.format.upper()
+    if args.resume:
+        command += " %d %d" % tuple(args.resume)
+
+    with serial.Serial(args.port, args.baud, timeout=5) as port, open(args.output, "ab" if args.append else "wb") as out:
+        port.reset_input_buffer()
+        port.write((command + "\n").encode())
+        while True:
+            line = port.readline().decode(errors="replace").strip()
+            if not line:
+                sys.exit("timeout, resume with --resume %d %d -a" % position)
+            if line.startswith("#END"):
+                print("done, %s items" % line.split()[1], file=sys.stderr)
+                return
+            if line.startswith("#ERR"):
+                sys.exit("%s, resume with --resume %d %d -a" % (line, position[0], position[1]))
+            if not line.startswith("#CHUNK"):
+                continue  # log output before the export started / 导出开始前的日志
+
+            _, number, length, crc, sequence, index = line.split()
+            data = port.read(int(length))
+            if len(data) != int(length) or zlib.crc32(data) != int(crc, 16):
+                continue  # no ACK, the device resends / 不确认，设备会重发
+            if int(number) == last_number:
+                port.write(("ACK %s\n" % number).encode())
+                continue  # resend of a chunk already written / 已写入块的重发
+            out.write(data)
+            last_number = int(number)
+            position = (int(sequence), int(index))
+            port.write(("ACK %s\n" % number).encode())
+
+
+if __name__ == "__main__":
+    main()
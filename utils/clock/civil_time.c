@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#include <stddef.h>
+
+#include "civil_time.h"
+
+/**
+ * @brief Division rounding towards negative infinity
+ *        向负无穷取整的除法
+ */
+int64_t civil_floor_div(int64_t value, int64_t divisor) {
+    int64_t quotient = value / divisor;
+    return (value % divisor != 0 && ((value < 0) != (divisor < 0))) ? quotient - 1 : quotient;
+}
+
+/**
+ * @brief Civil date to day number (days_from_civil)
+ *        公历日期转换为天数（days_from_civil）
+ *
+ * @param year Full year, e.g. 2025
+ *             完整年份，例如 2025
+ * @param month 1 - 12
+ * @param day 1 - 31
+ * @return int64_t Days since 1970-01-01
+ *                 自 1970-01-01 以来的天数
+ */
+int64_t civil_days_from_date(int32_t year, uint32_t month, uint32_t day) {
+    year -= (month <= 2);
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    uint32_t yoe = (uint32_t)(year - era * 400);
+    uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (int64_t)era * 146097 + (int64_t)doe - 719468;
+}
+
+/**
+ * @brief Day number to civil date (civil_from_days)
+ *        天数转换为公历日期（civil_from_days）
+ *
+ * @param days Days since 1970-01-01
+ *             自 1970-01-01 以来的天数
+ * @return civil_date_t Civil date
+ *                      公历日期
+ */
+civil_date_t civil_date_from_days(int64_t days) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    uint32_t doe = (uint32_t)(days - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    uint32_t m = mp < 10 ? mp + 3 : mp - 9;
+
+    civil_date_t date = {
+        .year = (int32_t)((int64_t)yoe + era * 400 + (m <= 2)),
+        .month = (uint8_t)m,
+        .day = (uint8_t)(doy - (153 * mp + 2) / 5 + 1),
+    };
+    return date;
+}
+
+/**
+ * @brief Day number of the n-th Sunday of a month, n = -1 for the last one
+ *        某月第 n 个周日的天数，n = -1 表示最后一个周日
+ */
+static int64_t civil_nth_sunday(int32_t year, uint32_t month, int n) {
+    if (n < 0) {
+        // 下月第一天往前找
+        // Search backwards from the first day of the next month
+        int64_t last = civil_days_from_date(month == 12 ? year + 1 : year, month == 12 ? 1 : month + 1, 1) - 1;
+        // 1970-01-01 是周四，星期几 = (days + 4) mod 7，0 为周日
+        // 1970-01-01 was a Thursday, weekday = (days + 4) mod 7 with 0 for Sunday
+        return last - (last + 4 - civil_floor_div(last + 4, 7) * 7);
+    }
+    int64_t first = civil_days_from_date(year, month, 1);
+    int64_t weekday = first + 4 - civil_floor_div(first + 4, 7) * 7;
+    return first + (7 - weekday) % 7 + (n - 1) * 7;
+}
+
+/**
+ * @brief UTC offset in effect at a UTC time
+ *        某 UTC 时刻生效的 UTC 偏移
+ *
+ * @param rule Daylight saving rule
+ *             夏令时规则
+ * @param std_offset_s Standard (winter) offset from UTC (s)
+ *                     相对 UTC 的标准（冬令时）偏移 (秒)
+ * @param utc_s Unix time (s)
+ *              Unix 时间 (秒)
+ * @param next_change_utc_s Receives the next offset change after utc_s, INT64_MAX when none, may be NULL
+ *                          接收 utc_s 之后下一次偏移变化的时刻，没有时为 INT64_MAX，可为 NULL
+ * @return int32_t Offset from UTC (s)
+ *                 相对 UTC 的偏移 (秒)
+ */
+int32_t civil_dst_offset_s(civil_dst_rule_t rule, int32_t std_offset_s, int64_t utc_s, int64_t *next_change_utc_s) {
+    if (rule == CIVIL_DST_NONE || rule >= CIVIL_DST_RULE_COUNT) {
+        if (next_change_utc_s != NULL) {
+            *next_change_utc_s = INT64_MAX;
+        }
+        return std_offset_s;
+    }
+
+    // 以标准时间所在年份计算当年的切换时刻
+    // Transition instants are computed for the year of the standard local time
+    int32_t year = civil_date_from_days(civil_floor_div(utc_s + std_offset_s, 86400)).year;
+    int64_t start_s, end_s;
+
+    if (rule == CIVIL_DST_EU) {
+        start_s = civil_nth_sunday(year, 3, -1) * 86400 + 3600;
+        end_s = civil_nth_sunday(year, 10, -1) * 86400 + 3600;
+    } else {
+        // 本地 02:00，开始时为标准时间，结束时为夏令时
+        // 02:00 local, standard time at the start and daylight time at the end
+        start_s = civil_nth_sunday(year, 3, 2) * 86400 + 7200 - std_offset_s;
+        end_s = civil_nth_sunday(year, 11, 1) * 86400 + 7200 - (std_offset_s + 3600);
+    }
+
+    if (utc_s < start_s) {
+        if (next_change_utc_s != NULL) {
+            *next_change_utc_s = start_s;
+        }
+        return std_offset_s;
+    }
+    if (utc_s < end_s) {
+        if (next_change_utc_s != NULL) {
+            *next_change_utc_s = end_s;
+        }
+        return std_offset_s + 3600;
+    }
+    // 今年夏令时已结束，下一次切换在明年，调用者到时自然会重新计算
+    // Daylight time is over for this year; report the year end so the caller recomputes then
+    if (next_change_utc_s != NULL) {
+        *next_change_utc_s = civil_days_from_date(year + 1, 1, 1) * 86400 - std_offset_s;
+    }
+    return std_offset_s;
+}
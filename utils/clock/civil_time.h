@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __CIVIL_TIME_H__
+#define __CIVIL_TIME_H__
+
+#include <stdint.h>
+
+/*
+ * Proleptic Gregorian calendar arithmetic on day numbers (days since 1970-01-01), plus the
+ * daylight saving rules used for local time.
+ * 基于天数（自 1970-01-01 以来的天数）的公历计算，以及本地时间使用的夏令时规则。
+ */
+
+/* Daylight saving rule applied on top of the standard UTC offset */
+/* 在标准 UTC 偏移之上应用的夏令时规则 */
+typedef enum {
+    CIVIL_DST_NONE = 0,    // No daylight saving
+                           // 无夏令时
+    CIVIL_DST_EU,          // Last Sunday of March to last Sunday of October, 01:00 UTC
+                           // 三月最后一个周日至十月最后一个周日，UTC 01:00 切换
+    CIVIL_DST_US,          // Second Sunday of March to first Sunday of November, 02:00 local (rules since 2007)
+                           // 三月第二个周日至十一月第一个周日，本地 02:00 切换（2007 年起的规则）
+    CIVIL_DST_RULE_COUNT,
+} civil_dst_rule_t;
+
+typedef struct {
+    int32_t year;
+    uint8_t month;         // 1 - 12
+    uint8_t day;           // 1 - 31
+} civil_date_t;
+
+int64_t civil_days_from_date(int32_t year, uint32_t month, uint32_t day);
+
+civil_date_t civil_date_from_days(int64_t days);
+
+int64_t civil_floor_div(int64_t value, int64_t divisor);
+
+int32_t civil_dst_offset_s(civil_dst_rule_t rule, int32_t std_offset_s, int64_t utc_s, int64_t *next_change_utc_s);
+
+#endif
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "clock_discipline.h"
+
+/**
+ * @brief Reset the mapping, no samples
+ *        重置映射，清空样本
+ *
+ * @param cd Clock discipline state
+ *           时钟校准状态
+ */
+void clock_discipline_init(clock_discipline_t *cd) {
+    uint32_t accepted = cd->accepted_count, rejected = cd->reject_count, resets = cd->reset_count;
+    memset(cd, 0, sizeof(*cd));
+    cd->accepted_count = accepted;
+    cd->reject_count = rejected;
+    cd->reset_count = resets;
+}
+
+/**
+ * @brief Refit offset and drift over the sample window
+ *        在样本窗口上重新拟合偏移与漂移
+ *
+ * Fits the offset (utc - local) as a straight line over local time, centred on the newest sample.
+ * 将偏移 (utc - local) 拟合为本地时间的直线，以最新样本为中心。
+ */
+static void clock_discipline_fit(clock_discipline_t *cd) {
+    uint8_t newest = (uint8_t)((cd->head + CLOCK_DISCIPLINE_WINDOW - 1) % CLOCK_DISCIPLINE_WINDOW);
+    int64_t ref_local = cd->local_us[newest];
+    int64_t ref_offset = cd->utc_us[newest] - ref_local;
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    int n = cd->count;
+
+    for (int i = 0; i < n; i++) {
+        double x = (double)(cd->local_us[i] - ref_local);
+        double y = (double)((cd->utc_us[i] - cd->local_us[i]) - ref_offset);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+
+    double denominator = n * sxx - sx * sx;
+    double slope = (n > 1 && denominator > 0) ? (n * sxy - sx * sy) / denominator : 0.0;
+    double intercept = (sy - slope * sx) / n;
+
+    double residual2 = 0;
+    for (int i = 0; i < n; i++) {
+        double x = (double)(cd->local_us[i] - ref_local);
+        double y = (double)((cd->utc_us[i] - cd->local_us[i]) - ref_offset);
+        double r = y - (intercept + slope * x);
+        residual2 += r * r;
+    }
+
+    cd->drift = slope;
+    cd->ref_local_us = cd->base_local_us + ref_local;
+    cd->ref_utc_us = cd->base_utc_us + ref_local + ref_offset + (int64_t)llround(intercept);
+    cd->residual_rms_us = (float)sqrt(residual2 / n);
+    cd->locked = (n >= CLOCK_DISCIPLINE_MIN_SAMPLES);
+}
+
+/**
+ * @brief Add one (local, UTC) sample
+ *        添加一个 (本地时间, UTC) 样本
+ *
+ * @param cd Clock discipline state
+ *           时钟校准状态
+ * @param local_us Local monotonic time of the event (us)
+ *                 事件的本地单调时间 (微秒)
+ * @param utc_us UTC of the same event (us since 1970)
+ *               同一事件的 UTC (自 1970 年起的微秒数)
+ * @return clock_discipline_result_t Whether the sample was used
+ *                                   样本是否被使用
+ */
+clock_discipline_result_t clock_discipline_add(clock_discipline_t *cd, int64_t local_us, int64_t utc_us) {
+    clock_discipline_result_t result = CLOCK_DISCIPLINE_ACCEPTED;
+
+    if (!cd->locked && cd->count > 0) {
+        // 锁定前只检查与上一个样本的一致性（允许 100 ppm 漂移），不一致则从该样本重新开始
+        // Before lock only check consistency with the previous sample (allowing 100 ppm of drift),
+        // start again from this sample if it does not agree
+        uint8_t newest = (uint8_t)((cd->head + CLOCK_DISCIPLINE_WINDOW - 1) % CLOCK_DISCIPLINE_WINDOW);
+        int64_t dt_us = (local_us - cd->base_local_us) - cd->local_us[newest];
+        int64_t error_us = (utc_us - cd->base_utc_us - cd->utc_us[newest]) - dt_us;
+        if (llabs(error_us) > CLOCK_DISCIPLINE_GATE_US + llabs(dt_us) / 10000) {
+            result = CLOCK_DISCIPLINE_RESET;
+        }
+    } else if (cd->locked) {
+        int64_t predicted_us;
+        bool valid = clock_discipline_to_utc(cd, local_us, &predicted_us);
+        int64_t error_us = utc_us - predicted_us;
+        if (valid && llabs(error_us) > CLOCK_DISCIPLINE_GATE_US) {
+            cd->reject_count++;
+            if (++cd->consecutive_rejects < CLOCK_DISCIPLINE_MAX_REJECTS) {
+                return CLOCK_DISCIPLINE_REJECTED;
+            }
+            result = CLOCK_DISCIPLINE_RESET;
+        } else if (!valid) {
+            // 保持时间已过，旧样本不再可信
+            // Holdover expired, old samples are no longer trusted
+            result = CLOCK_DISCIPLINE_RESET;
+        }
+    }
+
+    if (result == CLOCK_DISCIPLINE_RESET) {
+        clock_discipline_init(cd);
+        cd->reset_count++;
+    }
+
+    if (cd->count == 0) {
+        cd->base_local_us = local_us;
+        cd->base_utc_us = utc_us;
+    }
+
+    cd->local_us[cd->head] = local_us - cd->base_local_us;
+    cd->utc_us[cd->head] = utc_us - cd->base_utc_us;
+    cd->head = (uint8_t)((cd->head + 1) % CLOCK_DISCIPLINE_WINDOW);
+    if (cd->count < CLOCK_DISCIPLINE_WINDOW) {
+        cd->count++;
+    }
+    cd->consecutive_rejects = 0;
+    cd->last_sample_local_us = local_us;
+    cd->accepted_count++;
+
+    clock_discipline_fit(cd);
+    return result;
+}
+
+/**
+ * @brief Convert local monotonic time to UTC
+ *        将本地单调时间转换为 UTC
+ *
+ * @param cd Clock discipline state
+ *           时钟校准状态
+ * @param local_us Local time (us)
+ *                 本地时间 (微秒)
+ * @param utc_us Output UTC (us since 1970)
+ *               输出的 UTC (自 1970 年起的微秒数)
+ * @return bool Returns false if not locked or the holdover has expired
+ *              未锁定或保持时间已过时返回 false
+ */
+bool clock_discipline_to_utc(const clock_discipline_t *cd, int64_t local_us, int64_t *utc_us) {
+    if (!cd->locked || local_us - cd->last_sample_local_us > CLOCK_DISCIPLINE_HOLDOVER_US) {
+        return false;
+    }
+    int64_t delta_us = local_us - cd->ref_local_us;
+    *utc_us = cd->ref_utc_us + delta_us + (int64_t)llround(delta_us * cd->drift);
+    return true;
+}
+
+/**
+ * @brief Convert UTC to local monotonic time
+ *        将 UTC 转换为本地单调时间
+ *
+ * @param cd Clock discipline state
+ *           时钟校准状态
+ * @param utc_us UTC (us since 1970)
+ *               UTC (自 1970 年起的微秒数)
+ * @param local_us Output local time (us)
+ *                 输出的本地时间 (微秒)
+ * @return bool Returns false if not locked or the holdover has expired
+ *              未锁定或保持时间已过时返回 false
+ */
+bool clock_discipline_to_local(const clock_discipline_t *cd, int64_t utc_us, int64_t *local_us) {
+    if (!cd->locked) {
+        return false;
+    }
+    int64_t delta_us = utc_us - cd->ref_utc_us;
+    *local_us = cd->ref_local_us + (int64_t)llround(delta_us / (1.0 + cd->drift));
+    return *local_us - cd->last_sample_local_us <= CLOCK_DISCIPLINE_HOLDOVER_US;
+}
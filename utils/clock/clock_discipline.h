@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __CLOCK_DISCIPLINE_H__
+#define __CLOCK_DISCIPLINE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Local monotonic clock to UTC mapping, disciplined by (local, UTC) pairs such as PPS edges.
+ * 由 (本地时间, UTC) 对（如 PPS 边沿）校准的本地单调时钟到 UTC 的映射。
+ *
+ * utc = ref_utc + (local - ref_local) * (1 + drift), with offset and drift fitted by least
+ * squares over the last CLOCK_DISCIPLINE_WINDOW accepted samples.
+ * utc = ref_utc + (local - ref_local) * (1 + drift)，偏移与漂移由最近 CLOCK_DISCIPLINE_WINDOW 个
+ * 已接受样本的最小二乘拟合得到。
+ */
+
+// Samples used for the fit
+// 参与拟合的样本数
+#define CLOCK_DISCIPLINE_WINDOW       16
+
+// Samples needed before the mapping is trusted
+// 映射可信所需的样本数
+#define CLOCK_DISCIPLINE_MIN_SAMPLES  4
+
+// A sample further than this from the prediction is rejected once locked (us)
+// 锁定后，与预测相差超过该值的样本被拒绝 (微秒)
+#define CLOCK_DISCIPLINE_GATE_US      500
+
+// Consecutive rejected samples before the fit is restarted, e.g. after a clock step
+// 连续拒绝多少个样本后重新开始拟合，例如时钟跳变之后
+#define CLOCK_DISCIPLINE_MAX_REJECTS  3
+
+// How long the mapping stays valid without new samples (us)
+// 没有新样本时映射保持有效的时长 (微秒)
+#define CLOCK_DISCIPLINE_HOLDOVER_US  (60 * 1000000LL)
+
+/* Result of adding one sample */
+/* 添加一个样本的结果 */
+typedef enum {
+    CLOCK_DISCIPLINE_ACCEPTED = 0,
+    CLOCK_DISCIPLINE_REJECTED,     // Outside the gate, ignored
+                                   // 超出门限，已忽略
+    CLOCK_DISCIPLINE_RESET,        // Too many rejects, fit restarted from this sample
+                                   // 拒绝过多，以该样本重新开始拟合
+} clock_discipline_result_t;
+
+typedef struct {
+    // Sample ring, stored relative to the first sample to keep doubles exact
+    // 样本环形缓冲区，相对首个样本存储，以保证 double 精度
+    int64_t base_local_us;
+    int64_t base_utc_us;
+    int64_t local_us[CLOCK_DISCIPLINE_WINDOW];
+    int64_t utc_us[CLOCK_DISCIPLINE_WINDOW];
+    uint8_t head;
+    uint8_t count;
+    uint8_t consecutive_rejects;
+
+    // Fitted mapping
+    // 拟合得到的映射
+    bool locked;
+    int64_t ref_local_us;
+    int64_t ref_utc_us;
+    double drift;               // UTC rate relative to the local clock minus one, -1e-6 = local clock 1 ppm fast
+                                // UTC 相对本地时钟的速率减一，-1e-6 表示本地时钟快 1 ppm
+    float residual_rms_us;      // RMS residual of the fit, i.e. edge jitter
+                                // 拟合残差均方根，即边沿抖动
+    int64_t last_sample_local_us;
+
+    uint32_t accepted_count;
+    uint32_t reject_count;
+    uint32_t reset_count;
+} clock_discipline_t;
+
+void clock_discipline_init(clock_discipline_t *cd);
+
+clock_discipline_result_t clock_discipline_add(clock_discipline_t *cd, int64_t local_us, int64_t utc_us);
+
+bool clock_discipline_to_utc(const clock_discipline_t *cd, int64_t local_us, int64_t *utc_us);
+
+bool clock_discipline_to_local(const clock_discipline_t *cd, int64_t utc_us, int64_t *local_us);
+
+#endif
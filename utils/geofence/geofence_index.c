@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#include <string.h>
+
+#include "geofence_index.h"
+
+/**
+ * @brief Division rounding towards negative infinity
+ *        向负无穷取整的除法
+ */
+static int64_t geofence_floor_div(int64_t value, int64_t divisor) {
+    int64_t quotient = value / divisor;
+    return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+/**
+ * @brief Check an image and set up the section pointers
+ *        校验镜像并设置各段指针
+ *
+ * Only the structure is checked here, the CRC is left to the caller.
+ * 这里只检查结构，CRC 由调用者校验。
+ *
+ * @param index Index to set up
+ *              要设置的索引
+ * @param image Image start, 4-byte aligned
+ *              镜像起始地址，需 4 字节对齐
+ * @param size Bytes available at image
+ *             image 处可用的字节数
+ * @return int Returns 0 on success, -1 if the image is malformed
+ *             成功返回 0，镜像格式错误返回 -1
+ */
+int geofence_index_open(geofence_index_t *index, const void *image, size_t size) {
+    const geofence_header_t *header = (const geofence_header_t *)image;
+    memset(index, 0, sizeof(*index));
+
+    if (size < sizeof(*header) || header->magic != GEOFENCE_MAGIC || header->version != GEOFENCE_VERSION ||
+        header->total_size > size || header->cell_lat <= 0 || header->cell_lon <= 0) {
+        return -1;
+    }
+
+    size_t cells = (size_t)header->rows * header->cols;
+    size_t fences_offset = sizeof(*header);
+    size_t cell_start_offset = fences_offset + (size_t)header->fence_count * sizeof(geofence_record_t);
+    size_t cell_entries_offset = cell_start_offset + (cells + 1) * sizeof(uint32_t);
+    size_t vertices_offset = cell_entries_offset + (((size_t)header->cell_entry_count * sizeof(uint16_t) + 3) & ~(size_t)3);
+    size_t end = vertices_offset + (size_t)header->vertex_count * sizeof(geofence_vertex_t);
+    if (end != header->total_size) {
+        return -1;
+    }
+
+    const uint8_t *base = (const uint8_t *)image;
+    const geofence_record_t *fences = (const geofence_record_t *)(base + fences_offset);
+    const uint32_t *cell_start = (const uint32_t *)(base + cell_start_offset);
+    const uint16_t *cell_entries = (const uint16_t *)(base + cell_entries_offset);
+
+    // 单元起始索引必须单调且不越界，围栏编号必须有效
+    // Cell starts must be monotonic and in range, fence ids must exist
+    if (cell_start[0] != 0 || cell_start[cells] != header->cell_entry_count) {
+        return -1;
+    }
+    for (size_t i = 0; i < cells; i++) {
+        if (cell_start[i] > cell_start[i + 1]) {
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < header->cell_entry_count; i++) {
+        if (cell_entries[i] >= header->fence_count) {
+            return -1;
+        }
+    }
+    for (uint16_t i = 0; i < header->fence_count; i++) {
+        const geofence_record_t *fence = &fences[i];
+        if (fence->shape == GEOFENCE_SHAPE_POLYGON) {
+            if (fence->vertex_count < 3 || (uint64_t)fence->first_vertex + fence->vertex_count > header->vertex_count) {
+                return -1;
+            }
+        } else if (fence->shape != GEOFENCE_SHAPE_CIRCLE) {
+            return -1;
+        }
+    }
+
+    index->header = header;
+    index->fences = fences;
+    index->cell_start = cell_start;
+    index->cell_entries = cell_entries;
+    index->vertices = (const geofence_vertex_t *)(base + vertices_offset);
+    return 0;
+}
+
+/**
+ * @brief Fences that may contain a point, those listed in its grid cell
+ *        可能包含某点的围栏，即该点所在网格单元中登记的围栏
+ *
+ * @param lat Latitude, degrees * 1e7
+ *            纬度，度 * 1e7
+ * @param lon Longitude, degrees * 1e7
+ *            经度，度 * 1e7
+ * @param ids Receives the fence ids
+ *            接收围栏编号
+ * @return size_t Number of ids, 0 outside the grid
+ *                编号数量，网格之外为 0
+ */
+size_t geofence_index_candidates(const geofence_index_t *index, int32_t lat, int32_t lon, const uint16_t **ids) {
+    const geofence_header_t *header = index->header;
+    if (header == NULL) {
+        return 0;
+    }
+
+    int64_t row = geofence_floor_div((int64_t)lat - header->origin_lat, header->cell_lat);
+    int64_t col = geofence_floor_div((int64_t)lon - header->origin_lon, header->cell_lon);
+    if (row < 0 || row >= header->rows || col < 0 || col >= header->cols) {
+        return 0;
+    }
+
+    size_t cell = (size_t)row * header->cols + (size_t)col;
+    *ids = &index->cell_entries[index->cell_start[cell]];
+    return index->cell_start[cell + 1] - index->cell_start[cell];
+}
+
+/**
+ * @brief Squared distance from a point to a segment, all relative to the fence reference
+ *        点到线段距离的平方，均相对于围栏参考点
+ */
+static double geofence_segment_distance2(int64_t px, int64_t py, int64_t ax, int64_t ay, int64_t bx, int64_t by) {
+    int64_t ex = bx - ax, ey = by - ay;
+    int64_t dx = px - ax, dy = py - ay;
+    int64_t dot = dx * ex + dy * ey;
+    int64_t length2 = ex * ex + ey * ey;
+
+    if (dot <= 0 || length2 == 0) {
+        return (double)(dx * dx + dy * dy);
+    }
+    if (dot >= length2) {
+        int64_t fx = px - bx, fy = py - by;
+        return (double)(fx * fx + fy * fy);
+    }
+    double cross = (double)(dx * ey - dy * ex);
+    return cross * cross / (double)length2;
+}
+
+/**
+ * @brief Position of a point relative to a polygon
+ *        点相对于多边形的位置
+ */
+static geofence_position_t geofence_test_polygon(const geofence_index_t *index, const geofence_record_t *fence,
+                                                 int64_t px, int64_t py) {
+    const geofence_vertex_t *vertex = &index->vertices[fence->first_vertex];
+    int64_t h = fence->hysteresis;
+    double h2 = (double)h * (double)h;
+    bool inside = false;
+
+    // 从最后一个顶点开始，使每条边 (a, b) 都被访问一次
+    // Start from the last vertex so every edge (a, b) is visited once
+    const geofence_vertex_t *last = &vertex[fence->vertex_count - 1];
+    int64_t ax = (((int64_t)last->lon - fence->lon) * fence->cos_lat_q15) >> 15;
+    int64_t ay = (int64_t)last->lat - fence->lat;
+
+    for (uint16_t i = 0; i < fence->vertex_count; i++) {
+        int64_t bx = (((int64_t)vertex[i].lon - fence->lon) * fence->cos_lat_q15) >> 15;
+        int64_t by = (int64_t)vertex[i].lat - fence->lat;
+
+        // 射线法：向 +x 方向的射线穿过该边时翻转
+        // Ray casting: toggle when the ray towards +x crosses this edge
+        if ((ay > py) != (by > py)) {
+            int64_t cross = (bx - ax) * (py - ay) - (px - ax) * (by - ay);
+            if ((by > ay) ? (cross > 0) : (cross < 0)) {
+                inside = !inside;
+            }
+        }
+
+        // 只有点落在按滞回距离扩大的边包围盒内时才计算精确距离
+        // The exact distance is only computed when the point is inside the edge box grown by the hysteresis
+        if (h > 0 &&
+            px >= (ax < bx ? ax : bx) - h && px <= (ax > bx ? ax : bx) + h &&
+            py >= (ay < by ? ay : by) - h && py <= (ay > by ? ay : by) + h &&
+            geofence_segment_distance2(px, py, ax, ay, bx, by) <= h2) {
+            return GEOFENCE_BORDER;
+        }
+
+        ax = bx;
+        ay = by;
+    }
+    return inside ? GEOFENCE_INSIDE : GEOFENCE_OUTSIDE;
+}
+
+/**
+ * @brief Position of a point relative to one fence
+ *        点相对于某个围栏的位置
+ *
+ * @param id Fence id
+ *           围栏编号
+ * @param lat Latitude, degrees * 1e7
+ *            纬度，度 * 1e7
+ * @param lon Longitude, degrees * 1e7
+ *            经度，度 * 1e7
+ * @return geofence_position_t Inside, outside, or within the hysteresis of the border
+ *                             内部、外部或在边界滞回距离内
+ */
+geofence_position_t geofence_index_test(const geofence_index_t *index, uint16_t id, int32_t lat, int32_t lon) {
+    const geofence_record_t *fence = &index->fences[id];
+
+    if (lat < fence->min_lat || lat > fence->max_lat || lon < fence->min_lon || lon > fence->max_lon) {
+        return GEOFENCE_OUTSIDE;
+    }
+
+    int64_t px = (((int64_t)lon - fence->lon) * fence->cos_lat_q15) >> 15;
+    int64_t py = (int64_t)lat - fence->lat;
+
+    if (fence->shape == GEOFENCE_SHAPE_POLYGON) {
+        return geofence_test_polygon(index, fence, px, py);
+    }
+
+    int64_t distance2 = px * px + py * py;
+    int64_t inner = (fence->radius > fence->hysteresis) ? (int64_t)fence->radius - fence->hysteresis : 0;
+    int64_t outer = (int64_t)fence->radius + fence->hysteresis;
+    if (distance2 < inner * inner) {
+        return GEOFENCE_INSIDE;
+    }
+    if (distance2 > outer * outer) {
+        return GEOFENCE_OUTSIDE;
+    }
+    return GEOFENCE_BORDER;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __GEOFENCE_INDEX_H__
+#define __GEOFENCE_INDEX_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * Read-only geofence image, built on the host by tools/geofence_builder.py and used in place
+ * (memory mapped flash). All values little endian, sections 4-byte aligned:
+ * 只读地理围栏镜像，由主机端 tools/geofence_builder.py 生成，原地使用（Flash 内存映射）。
+ * 所有值为小端，各段 4 字节对齐：
+ *
+ *   geofence_header_t
+ *   geofence_record_t  fences[fence_count]
+ *   uint32_t           cell_start[rows * cols + 1]    first entry of each grid cell
+ *                                                     每个网格单元的第一个条目
+ *   uint16_t           cell_entries[cell_entry_count] fence ids, padded to 4 bytes
+ *                                                     围栏编号，补齐到 4 字节
+ *   geofence_vertex_t  vertices[vertex_count]
+ *
+ * The area is split into a uniform grid of rows x cols cells. Each fence is listed in every cell its
+ * bounding box (grown by the hysteresis) touches, so a fix only tests the fences of its own cell and
+ * the cost per fix depends on fence density, not on the total number of fences.
+ * 区域被划分为 rows x cols 的均匀网格。每个围栏登记在其包围盒（按滞回距离扩大）覆盖的所有单元中，
+ * 因此每个定位只需测试所在单元的围栏，单次开销取决于围栏密度而非围栏总数。
+ *
+ * Distances are in units of 1e-7 degree of latitude (about 1.1 cm); longitude differences are scaled
+ * by the cosine of the fence latitude, so evaluation only needs integer arithmetic.
+ * 距离以 1e-7 纬度为单位（约 1.1 厘米）；经度差按围栏所在纬度的余弦缩放，因此判断只需整数运算。
+ */
+
+#define GEOFENCE_MAGIC          0x4E454647   // "GFEN"
+#define GEOFENCE_VERSION        1
+
+/* Fence shape */
+/* 围栏形状 */
+typedef enum {
+    GEOFENCE_SHAPE_CIRCLE = 0,
+    GEOFENCE_SHAPE_POLYGON = 1,
+} geofence_shape_t;
+
+/* Where a point is relative to a fence */
+/* 点相对于围栏的位置 */
+typedef enum {
+    GEOFENCE_OUTSIDE = 0,       // Outside, further than the hysteresis from the border
+                                // 在外部，距边界超过滞回距离
+    GEOFENCE_INSIDE,            // Inside, further than the hysteresis from the border
+                                // 在内部，距边界超过滞回距离
+    GEOFENCE_BORDER,            // Within the hysteresis of the border, state should not change
+                                // 在边界滞回距离内，状态不应改变
+} geofence_position_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t fence_count;
+    int32_t origin_lat;         // South-west corner of the grid, degrees * 1e7
+                                // 网格西南角，度 * 1e7
+    int32_t origin_lon;
+    int32_t cell_lat;           // Cell size, degrees * 1e7
+                                // 单元大小，度 * 1e7
+    int32_t cell_lon;
+    uint16_t rows;
+    uint16_t cols;
+    uint32_t cell_entry_count;
+    uint32_t vertex_count;
+    uint32_t total_size;        // Header included
+                                // 包含头部
+    uint32_t crc32;             // CRC32 of everything after the header
+                                // 头部之后所有数据的 CRC32
+} geofence_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t shape;              // geofence_shape_t
+    uint8_t enter_action;       // Action on entering, camera_action_type_t
+                                // 进入时的动作，camera_action_type_t
+    uint8_t exit_action;        // Action on leaving
+                                // 离开时的动作
+    uint8_t action_param;       // Parameter of both actions, e.g. the camera mode
+                                // 动作参数，例如相机模式
+    uint16_t cos_lat_q15;       // Cosine of the fence latitude, 32768 = 1.0
+                                // 围栏所在纬度的余弦，32768 = 1.0
+    uint16_t vertex_count;      // Polygon only
+                                // 仅多边形
+    int32_t lat;                // Circle centre, or polygon reference point, degrees * 1e7
+                                // 圆心，或多边形参考点，度 * 1e7
+    int32_t lon;
+    uint32_t radius;            // Circle only, latitude units
+                                // 仅圆形，纬度单位
+    uint32_t hysteresis;        // Latitude units
+                                // 纬度单位
+    uint32_t first_vertex;      // Polygon only, index into vertices
+                                // 仅多边形，顶点表中的索引
+    int32_t min_lat;            // Bounding box grown by the hysteresis, degrees * 1e7
+                                // 按滞回距离扩大的包围盒，度 * 1e7
+    int32_t min_lon;
+    int32_t max_lat;
+    int32_t max_lon;
+} geofence_record_t;
+
+typedef struct __attribute__((packed)) {
+    int32_t lat;                // Degrees * 1e7
+                                // 度 * 1e7
+    int32_t lon;
+} geofence_vertex_t;
+
+typedef struct {
+    const geofence_header_t *header;
+    const geofence_record_t *fences;
+    const uint32_t *cell_start;
+    const uint16_t *cell_entries;
+    const geofence_vertex_t *vertices;
+} geofence_index_t;
+
+int geofence_index_open(geofence_index_t *index, const void *image, size_t size);
+
+size_t geofence_index_candidates(const geofence_index_t *index, int32_t lat, int32_t lon, const uint16_t **ids);
+
+geofence_position_t geofence_index_test(const geofence_index_t *index, uint16_t id, int32_t lat, int32_t lon);
+
+#endif
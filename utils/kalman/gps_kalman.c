@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <string.h>
+
+#include "gps_kalman.h"
+
+#define EARTH_RADIUS_M  6378137.0
+#define DEG_TO_RAD      (M_PI / 180.0)
+
+/**
+ * @brief Update the meters-per-degree scale for the current origin
+ *        根据当前原点更新每度对应的米数
+ *
+ * @param kf Filter instance
+ *           滤波器实例
+ */
+static void update_origin_scale(gps_kalman_t *kf) {
+    kf->meters_per_deg_lat = EARTH_RADIUS_M * DEG_TO_RAD;
+    kf->meters_per_deg_lon = EARTH_RADIUS_M * DEG_TO_RAD * cos(kf->origin_lat * DEG_TO_RAD);
+}
+
+/**
+ * @brief Propagate one axis by dt with white-noise acceleration
+ *        以白噪声加速度模型将单轴状态推进 dt
+ *
+ * @param axis Axis state
+ *             单轴状态
+ * @param dt Time step (s)
+ *           时间步长 (秒)
+ * @param q Acceleration noise variance (m^2/s^4)
+ *          加速度噪声方差
+ */
+static void axis_predict(gps_kalman_axis_t *axis, float dt, float q) {
+    float dt2 = dt * dt;
+
+    axis->pos += axis->vel * dt;
+
+    // P = F P F' + Q, F = [1 dt; 0 1]
+    axis->p00 += 2.0f * dt * axis->p01 + dt2 * axis->p11 + q * dt2 * dt2 * 0.25f;
+    axis->p01 += dt * axis->p11 + q * dt2 * dt * 0.5f;
+    axis->p11 += q * dt2;
+}
+
+/**
+ * @brief Scalar position update of one axis
+ *        单轴位置标量更新
+ */
+static void axis_update_position(gps_kalman_axis_t *axis, float z, float r) {
+    float s = axis->p00 + r;
+    float k0 = axis->p00 / s;
+    float k1 = axis->p01 / s;
+    float y = z - axis->pos;
+
+    axis->pos += k0 * y;
+    axis->vel += k1 * y;
+
+    axis->p11 -= k1 * axis->p01;
+    axis->p01 *= (1.0f - k0);
+    axis->p00 *= (1.0f - k0);
+}
+
+/**
+ * @brief Scalar velocity update of one axis
+ *        单轴速度标量更新
+ */
+static void axis_update_velocity(gps_kalman_axis_t *axis, float z, float r) {
+    float s = axis->p11 + r;
+    float k0 = axis->p01 / s;
+    float k1 = axis->p11 / s;
+    float y = z - axis->vel;
+
+    axis->pos += k0 * y;
+    axis->vel += k1 * y;
+
+    axis->p00 -= k0 * axis->p01;
+    axis->p01 *= (1.0f - k1);
+    axis->p11 *= (1.0f - k1);
+}
+
+/**
+ * @brief Initialize the filter state directly from a measurement
+ *        直接使用测量值初始化滤波器状态
+ */
+static void start_from_measurement(gps_kalman_t *kf, const gps_kalman_measurement_t *meas, int64_t time_us) {
+    kf->origin_lat = meas->latitude;
+    kf->origin_lon = meas->longitude;
+    kf->origin_alt = meas->altitude;
+    update_origin_scale(kf);
+
+    const float vel[GPS_KALMAN_AXIS_COUNT] = { meas->vel_north, meas->vel_east, meas->vel_down };
+    const float pos_sigma[GPS_KALMAN_AXIS_COUNT] = { meas->pos_sigma_h, meas->pos_sigma_h, meas->pos_sigma_v };
+    const float vel_sigma[GPS_KALMAN_AXIS_COUNT] = { meas->vel_sigma_h, meas->vel_sigma_h, meas->vel_sigma_v };
+
+    for (int i = 0; i < GPS_KALMAN_AXIS_COUNT; i++) {
+        gps_kalman_axis_t *axis = &kf->axis[i];
+        // Unmeasured velocity starts at zero with a loose variance
+        // 未测量的速度从零开始，方差取较大值
+        float vs = (vel_sigma[i] > 0.0f) ? vel_sigma[i] : 10.0f;
+        float ps = (pos_sigma[i] > 0.0f) ? pos_sigma[i] : 10.0f;
+        axis->pos = 0.0f;
+        axis->vel = (vel_sigma[i] > 0.0f) ? vel[i] : 0.0f;
+        axis->p00 = ps * ps;
+        axis->p01 = 0.0f;
+        axis->p11 = vs * vs;
+    }
+
+    kf->last_time_us = time_us;
+    kf->consecutive_rejects = 0;
+    kf->initialized = true;
+    kf->reset_count++;
+}
+
+/**
+ * @brief Move the local origin onto the current estimate
+ *        将本地原点移动到当前估计位置
+ */
+static void recenter(gps_kalman_t *kf) {
+    kf->origin_lat += kf->axis[GPS_KALMAN_AXIS_NORTH].pos / kf->meters_per_deg_lat;
+    kf->origin_lon += kf->axis[GPS_KALMAN_AXIS_EAST].pos / kf->meters_per_deg_lon;
+    kf->origin_alt -= kf->axis[GPS_KALMAN_AXIS_DOWN].pos;
+    update_origin_scale(kf);
+
+    for (int i = 0; i < GPS_KALMAN_AXIS_COUNT; i++) {
+        kf->axis[i].pos = 0.0f;
+    }
+}
+
+/**
+ * @brief Initialize the filter
+ *        初始化滤波器
+ *
+ * @param kf Filter instance
+ *           滤波器实例
+ * @param accel_noise_h Horizontal acceleration noise (m/s^2), how hard the platform can manoeuvre
+ *                      水平加速度噪声 (米/秒^2)，表示载体机动能力
+ * @param accel_noise_v Vertical acceleration noise (m/s^2)
+ *                      垂直加速度噪声 (米/秒^2)
+ */
+void gps_kalman_init(gps_kalman_t *kf, float accel_noise_h, float accel_noise_v) {
+    memset(kf, 0, sizeof(*kf));
+    kf->accel_noise_h = accel_noise_h;
+    kf->accel_noise_v = accel_noise_v;
+}
+
+/**
+ * @brief Drop the current estimate, the next measurement re-initializes the filter
+ *        丢弃当前估计，下一次测量将重新初始化滤波器
+ *
+ * @param kf Filter instance
+ *           滤波器实例
+ */
+void gps_kalman_reset(gps_kalman_t *kf) {
+    kf->initialized = false;
+    kf->consecutive_rejects = 0;
+}
+
+/**
+ * @brief Fuse one receiver measurement
+ *        融合一次接收机测量
+ *
+ * The horizontal position innovation is gated on its Mahalanobis distance, so a jump that the
+ * current velocity explains is accepted while a multipath spike is rejected. After
+ * GPS_KALMAN_MAX_REJECTS consecutive rejections the filter trusts the receiver again and restarts.
+ * 水平位置新息按马氏距离进行门限判断：能被当前速度解释的位移会被接受，多径尖峰会被拒绝。
+ * 连续拒绝 GPS_KALMAN_MAX_REJECTS 次后，滤波器重新信任接收机并重启。
+ *
+ * @param kf Filter instance
+ *           滤波器实例
+ * @param meas Measurement
+ *             测量值
+ * @param time_us Measurement time (us, monotonic)
+ *                测量时间 (微秒，单调递增)
+ *
+ * @return gps_kalman_result_t Whether the measurement was accepted, rejected or restarted the filter
+ *                             测量被接受、被拒绝或使滤波器重启
+ */
+gps_kalman_result_t gps_kalman_update(gps_kalman_t *kf, const gps_kalman_measurement_t *meas, int64_t time_us) {
+    float dt = (float)(time_us - kf->last_time_us) * 1e-6f;
+
+    if (!kf->initialized || dt < 0.0f || dt > GPS_KALMAN_MAX_GAP_S) {
+        start_from_measurement(kf, meas, time_us);
+        return GPS_KALMAN_RESET;
+    }
+
+    // Predict to the measurement time on a copy, the state is only committed if the fix passes the gate
+    // 在副本上预测到测量时刻，只有通过门限后才提交状态
+    gps_kalman_axis_t axis[GPS_KALMAN_AXIS_COUNT];
+    memcpy(axis, kf->axis, sizeof(axis));
+    const float q_h = kf->accel_noise_h * kf->accel_noise_h;
+    const float q_v = kf->accel_noise_v * kf->accel_noise_v;
+    axis_predict(&axis[GPS_KALMAN_AXIS_NORTH], dt, q_h);
+    axis_predict(&axis[GPS_KALMAN_AXIS_EAST], dt, q_h);
+    axis_predict(&axis[GPS_KALMAN_AXIS_DOWN], dt, q_v);
+
+    float z_north = (float)((meas->latitude - kf->origin_lat) * kf->meters_per_deg_lat);
+    float z_east = (float)((meas->longitude - kf->origin_lon) * kf->meters_per_deg_lon);
+    float z_down = (float)(kf->origin_alt - meas->altitude);
+    float r_h = meas->pos_sigma_h * meas->pos_sigma_h;
+
+    // Innovation gate on horizontal position
+    // 水平位置新息门限
+    float y_north = z_north - axis[GPS_KALMAN_AXIS_NORTH].pos;
+    float y_east = z_east - axis[GPS_KALMAN_AXIS_EAST].pos;
+    float d2 = y_north * y_north / (axis[GPS_KALMAN_AXIS_NORTH].p00 + r_h) +
+               y_east * y_east / (axis[GPS_KALMAN_AXIS_EAST].p00 + r_h);
+    if (d2 > GPS_KALMAN_GATE_THRESHOLD) {
+        kf->reject_count++;
+        if (++kf->consecutive_rejects >= GPS_KALMAN_MAX_REJECTS) {
+            start_from_measurement(kf, meas, time_us);
+            return GPS_KALMAN_RESET;
+        }
+        return GPS_KALMAN_REJECTED;
+    }
+
+    axis_update_position(&axis[GPS_KALMAN_AXIS_NORTH], z_north, r_h);
+    axis_update_position(&axis[GPS_KALMAN_AXIS_EAST], z_east, r_h);
+    if (meas->pos_sigma_v > 0.0f) {
+        axis_update_position(&axis[GPS_KALMAN_AXIS_DOWN], z_down, meas->pos_sigma_v * meas->pos_sigma_v);
+    }
+    if (meas->vel_sigma_h > 0.0f) {
+        float r = meas->vel_sigma_h * meas->vel_sigma_h;
+        axis_update_velocity(&axis[GPS_KALMAN_AXIS_NORTH], meas->vel_north, r);
+        axis_update_velocity(&axis[GPS_KALMAN_AXIS_EAST], meas->vel_east, r);
+    }
+    if (meas->vel_sigma_v > 0.0f) {
+        axis_update_velocity(&axis[GPS_KALMAN_AXIS_DOWN], meas->vel_down, meas->vel_sigma_v * meas->vel_sigma_v);
+    }
+
+    memcpy(kf->axis, axis, sizeof(axis));
+    kf->last_time_us = time_us;
+    kf->consecutive_rejects = 0;
+    kf->update_count++;
+
+    if (fabsf(kf->axis[GPS_KALMAN_AXIS_NORTH].pos) > GPS_KALMAN_RECENTER_DISTANCE ||
+        fabsf(kf->axis[GPS_KALMAN_AXIS_EAST].pos) > GPS_KALMAN_RECENTER_DISTANCE ||
+        fabsf(kf->axis[GPS_KALMAN_AXIS_DOWN].pos) > GPS_KALMAN_RECENTER_DISTANCE) {
+        recenter(kf);
+    }
+
+    return GPS_KALMAN_ACCEPTED;
+}
+
+/**
+ * @brief Predict the state at a given time without changing the filter
+ *        在不修改滤波器的情况下预测指定时刻的状态
+ *
+ * Used for predict-only output between receiver epochs.
+ * 用于接收机历元之间的纯预测输出。
+ *
+ * @param kf Filter instance
+ *           滤波器实例
+ * @param time_us Target time (us), normally now
+ *                目标时间 (微秒)，通常为当前时间
+ * @param out Predicted state
+ *            预测状态
+ *
+ * @return bool Returns false if the filter has not been initialized
+ *              滤波器尚未初始化时返回 false
+ */
+bool gps_kalman_predict(const gps_kalman_t *kf, int64_t time_us, gps_kalman_state_t *out) {
+    if (!kf->initialized) {
+        return false;
+    }
+
+    float dt = (float)(time_us - kf->last_time_us) * 1e-6f;
+    if (dt < 0.0f) {
+        dt = 0.0f;
+    }
+
+    gps_kalman_axis_t axis[GPS_KALMAN_AXIS_COUNT];
+    memcpy(axis, kf->axis, sizeof(axis));
+    if (dt > 0.0f) {
+        const float q_h = kf->accel_noise_h * kf->accel_noise_h;
+        const float q_v = kf->accel_noise_v * kf->accel_noise_v;
+        axis_predict(&axis[GPS_KALMAN_AXIS_NORTH], dt, q_h);
+        axis_predict(&axis[GPS_KALMAN_AXIS_EAST], dt, q_h);
+        axis_predict(&axis[GPS_KALMAN_AXIS_DOWN], dt, q_v);
+    }
+
+    out->latitude = kf->origin_lat + axis[GPS_KALMAN_AXIS_NORTH].pos / kf->meters_per_deg_lat;
+    out->longitude = kf->origin_lon + axis[GPS_KALMAN_AXIS_EAST].pos / kf->meters_per_deg_lon;
+    out->altitude = kf->origin_alt - axis[GPS_KALMAN_AXIS_DOWN].pos;
+    out->vel_north = axis[GPS_KALMAN_AXIS_NORTH].vel;
+    out->vel_east = axis[GPS_KALMAN_AXIS_EAST].vel;
+    out->vel_down = axis[GPS_KALMAN_AXIS_DOWN].vel;
+    out->horizontal_accuracy = sqrtf(axis[GPS_KALMAN_AXIS_NORTH].p00 + axis[GPS_KALMAN_AXIS_EAST].p00);
+    out->vertical_accuracy = sqrtf(axis[GPS_KALMAN_AXIS_DOWN].p00);
+    out->speed_accuracy = sqrtf(axis[GPS_KALMAN_AXIS_NORTH].p11 + axis[GPS_KALMAN_AXIS_EAST].p11);
+    return true;
+}
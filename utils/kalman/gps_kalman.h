@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __GPS_KALMAN_H__
+#define __GPS_KALMAN_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Constant-velocity Kalman filter over local NED position and velocity (float32) */
+/* 基于本地 NED 坐标系位置与速度的匀速模型卡尔曼滤波器（float32） */
+
+// Squared Mahalanobis distance gate for the horizontal position innovation (chi-square, 2 DOF, 99.9%)
+// 水平位置新息的马氏距离平方门限（卡方分布，2 自由度，99.9%）
+#define GPS_KALMAN_GATE_THRESHOLD      13.8f
+
+// Consecutive rejected fixes before the filter gives up and re-initializes on the measurement
+// 连续拒绝多少次后放弃当前估计，并以测量值重新初始化
+#define GPS_KALMAN_MAX_REJECTS         5
+
+// Local origin is moved when the estimate drifts further than this (m), keeps float32 precise
+// 估计位置离原点超过该距离（米）时移动原点，以保证 float32 精度
+#define GPS_KALMAN_RECENTER_DISTANCE   1000.0f
+
+// Largest gap between updates before the state is considered stale and reset (s)
+// 两次更新最大间隔，超过后状态视为过期并重置 (秒)
+#define GPS_KALMAN_MAX_GAP_S           5.0f
+
+typedef enum {
+    GPS_KALMAN_AXIS_NORTH = 0,
+    GPS_KALMAN_AXIS_EAST,
+    GPS_KALMAN_AXIS_DOWN,
+    GPS_KALMAN_AXIS_COUNT,
+} gps_kalman_axis_index_t;
+
+/* Result of feeding one measurement */
+/* 输入一次测量的结果 */
+typedef enum {
+    GPS_KALMAN_ACCEPTED = 0,       // Measurement fused
+                                   // 测量已融合
+    GPS_KALMAN_REJECTED,           // Measurement failed the innovation gate
+                                   // 测量未通过新息门限
+    GPS_KALMAN_RESET,              // Filter (re)initialized on this measurement
+                                   // 滤波器以该测量（重新）初始化
+} gps_kalman_result_t;
+
+/* One axis: position, velocity and their 2x2 symmetric covariance */
+/* 单轴：位置、速度及其 2x2 对称协方差 */
+typedef struct {
+    float pos;    // Position relative to origin (m)
+                  // 相对原点的位置 (米)
+    float vel;    // Velocity (m/s)
+                  // 速度 (米/秒)
+    float p00;    // Position variance (m^2)
+                  // 位置方差
+    float p01;    // Position/velocity covariance
+                  // 位置/速度协方差
+    float p11;    // Velocity variance (m^2/s^2)
+                  // 速度方差
+} gps_kalman_axis_t;
+
+/* Measurement from the receiver, standard deviations <= 0 mean "not measured" */
+/* 接收机测量值，标准差 <= 0 表示"未测量" */
+typedef struct {
+    double latitude;       // Degrees, south negative
+                           // 度，南纬为负
+    double longitude;      // Degrees, west negative
+                           // 度，西经为负
+    double altitude;       // Meters
+                           // 米
+    float vel_north;       // m/s
+    float vel_east;        // m/s
+    float vel_down;        // m/s
+    float pos_sigma_h;     // Horizontal position standard deviation (m)
+                           // 水平位置标准差 (米)
+    float pos_sigma_v;     // Vertical position standard deviation (m)
+                           // 垂直位置标准差 (米)
+    float vel_sigma_h;     // Horizontal velocity standard deviation (m/s)
+                           // 水平速度标准差 (米/秒)
+    float vel_sigma_v;     // Vertical velocity standard deviation (m/s)
+                           // 垂直速度标准差 (米/秒)
+} gps_kalman_measurement_t;
+
+/* Filter output */
+/* 滤波输出 */
+typedef struct {
+    double latitude;
+    double longitude;
+    double altitude;
+    float vel_north;
+    float vel_east;
+    float vel_down;
+    float horizontal_accuracy;   // 1-sigma (m)
+    float vertical_accuracy;     // 1-sigma (m)
+    float speed_accuracy;        // 1-sigma (m/s)
+} gps_kalman_state_t;
+
+typedef struct {
+    bool initialized;
+    int64_t last_time_us;               // Time of the last update (us)
+                                        // 上次更新时间 (微秒)
+    double origin_lat;                  // Local origin
+                                        // 本地原点
+    double origin_lon;
+    double origin_alt;
+    double meters_per_deg_lat;
+    double meters_per_deg_lon;
+    float accel_noise_h;                // Horizontal acceleration noise (m/s^2)
+                                        // 水平加速度噪声
+    float accel_noise_v;                // Vertical acceleration noise (m/s^2)
+                                        // 垂直加速度噪声
+    gps_kalman_axis_t axis[GPS_KALMAN_AXIS_COUNT];
+    uint8_t consecutive_rejects;
+
+    // Statistics
+    // 统计
+    uint32_t update_count;
+    uint32_t reject_count;
+    uint32_t reset_count;
+} gps_kalman_t;
+
+void gps_kalman_init(gps_kalman_t *kf, float accel_noise_h, float accel_noise_v);
+
+void gps_kalman_reset(gps_kalman_t *kf);
+
+gps_kalman_result_t gps_kalman_update(gps_kalman_t *kf, const gps_kalman_measurement_t *meas, int64_t time_us);
+
+bool gps_kalman_predict(const gps_kalman_t *kf, int64_t time_us, gps_kalman_state_t *out);
+
+#endif
@@ -0,0 +1,384 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <math.h>
+
+#include "rule_engine.h"
+
+typedef struct {
+    const char *name;
+    int32_t scale;              // Text value to input unit
+                                // 文本数值到输入单位的倍数
+} rule_input_info_t;
+
+static const rule_input_info_t s_inputs[RULE_INPUT_COUNT] = {
+    [RULE_INPUT_SPEED] = {"SPEED", 10},
+    [RULE_INPUT_ALTITUDE] = {"ALT", 1},
+    [RULE_INPUT_SATELLITES] = {"SATS", 1},
+    [RULE_INPUT_BATTERY] = {"BATTERY", 1},
+    [RULE_INPUT_RECORDING] = {"RECORDING", 1},
+    [RULE_INPUT_CAMERA_MODE] = {"MODE", 1},
+};
+
+// Longest operators first so "<=" is not read as "<"
+// 较长的运算符在前，避免把 "<=" 识别为 "<"
+static const struct {
+    const char *text;
+    rule_op_t op;
+} s_ops[] = {
+    {"<=", RULE_OP_LE}, {">=", RULE_OP_GE}, {"!=", RULE_OP_NE},
+    {"<", RULE_OP_LT}, {">", RULE_OP_GT}, {"=", RULE_OP_EQ},
+};
+
+// Action names, values are camera_action_type_t
+// 动作名称，数值为 camera_action_type_t
+static const struct {
+    const char *name;
+    uint8_t action;
+    bool has_param;
+} s_actions[] = {
+    {"START", 1, false},
+    {"STOP", 2, false},
+    {"MODE", 3, true},
+};
+
+/**
+ * @brief Compile one rule
+ *        编译一条规则
+ *
+ * @return int Returns 0 on success, -1 on a syntax error
+ *             成功返回 0，语法错误返回 -1
+ */
+static int rule_compile_one(const char *text, rule_t *rule) {
+    const char *p = text;
+    size_t length = 0;
+    int input = -1;
+
+    while (isalpha((unsigned char)p[length])) {
+        length++;
+    }
+    for (int i = 0; i < RULE_INPUT_COUNT; i++) {
+        if (strlen(s_inputs[i].name) == length && strncmp(p, s_inputs[i].name, length) == 0) {
+            input = i;
+        }
+    }
+    if (input < 0) {
+        return -1;
+    }
+    p += length;
+
+    size_t op_count = sizeof(s_ops) / sizeof(s_ops[0]);
+    size_t op_index = op_count;
+    for (size_t i = 0; i < op_count && op_index == op_count; i++) {
+        if (strncmp(p, s_ops[i].text, strlen(s_ops[i].text)) == 0) {
+            op_index = i;
+        }
+    }
+    if (op_index == op_count) {
+        return -1;
+    }
+    p += strlen(s_ops[op_index].text);
+
+    char *end;
+    double value = strtod(p, &end);
+    if (end == p) {
+        return -1;
+    }
+    p = end;
+
+    double hold_s = 0;
+    if (*p == '/') {
+        hold_s = strtod(p + 1, &end);
+        if (end == p + 1 || hold_s < 0 || hold_s > 86400) {
+            return -1;
+        }
+        p = end;
+    }
+
+    if (!isspace((unsigned char)*p)) {
+        return -1;
+    }
+    while (isspace((unsigned char)*p)) {
+        p++;
+    }
+
+    int action = -1;
+    for (size_t i = 0; i < sizeof(s_actions) / sizeof(s_actions[0]); i++) {
+        size_t name_length = strlen(s_actions[i].name);
+        if (strncmp(p, s_actions[i].name, name_length) == 0) {
+            action = (int)i;
+            p += name_length;
+            break;
+        }
+    }
+    if (action < 0) {
+        return -1;
+    }
+
+    long param = 0;
+    if (s_actions[action].has_param) {
+        if (*p != ':') {
+            return -1;
+        }
+        param = strtol(p + 1, &end, 0);
+        if (end == p + 1 || param < 0 || param > 255) {
+            return -1;
+        }
+        p = end;
+    }
+    while (isspace((unsigned char)*p)) {
+        p++;
+    }
+    if (*p != '\0') {
+        return -1;
+    }
+
+    rule->input = (uint8_t)input;
+    rule->op = (uint8_t)s_ops[op_index].op;
+    rule->threshold = (int32_t)lround(value * s_inputs[input].scale);
+    rule->hold_ms = (uint32_t)lround(hold_s * 1000);
+    rule->action = s_actions[action].action;
+    rule->action_param = (uint8_t)param;
+    return 0;
+}
+
+/**
+ * @brief Compile a rule list, replacing the current rules
+ *        编译规则列表，替换当前规则
+ *
+ * Input values are kept. A rule identical to one in the previous list keeps its state, so a rule
+ * that already fired does not fire again; new rules start unarmed. On error the engine is left unchanged.
+ * 保留输入值。与原列表中某条规则完全相同的规则保留其状态，已触发的规则不会再次触发；新规则从未布防状态开始。
+ * 出错时引擎保持不变。
+ *
+ * @param engine Rule engine
+ *               规则引擎
+ * @param text Rules separated by ';', may be empty
+ *             以 ';' 分隔的规则，可为空
+ * @param error Receives the offending rule on error, may be NULL
+ *              出错时接收出错的规则，可为 NULL
+ * @param error_size Size of error
+ *                   error 的大小
+ * @return int Number of rules, -1 on error
+ *             规则数量，出错返回 -1
+ */
+int rule_engine_compile(rule_engine_t *engine, const char *text, char *error, size_t error_size) {
+    rule_t rules[RULE_MAX_RULES];
+    uint8_t count = 0;
+    char item[RULE_TEXT_MAX];
+
+    while (*text != '\0') {
+        const char *separator = strchr(text, ';');
+        size_t length = separator ? (size_t)(separator - text) : strlen(text);
+
+        // 去除首尾空白
+        // Trim surrounding whitespace
+        while (length > 0 && isspace((unsigned char)*text)) {
+            text++;
+            length--;
+        }
+        while (length > 0 && isspace((unsigned char)text[length - 1])) {
+            length--;
+        }
+
+        if (length > 0) {
+            if (length >= sizeof(item)) {
+                length = sizeof(item) - 1;
+            }
+            memcpy(item, text, length);
+            item[length] = '\0';
+
+            if (count >= RULE_MAX_RULES || rule_compile_one(item, &rules[count]) != 0) {
+                if (error != NULL) {
+                    snprintf(error, error_size, "%s", count >= RULE_MAX_RULES ? "too many rules" : item);
+                }
+                return -1;
+            }
+            count++;
+        }
+        text = separator ? separator + 1 : text + length;
+        if (separator == NULL) {
+            break;
+        }
+    }
+
+    // 每条新规则取用一条尚未被取用的相同旧规则的状态
+    // Each new rule takes over the state of an identical old rule not taken yet
+    uint16_t old_rules = (uint16_t)((1u << engine->count) - 1);
+    uint16_t active = 0;
+    uint16_t fired = 0;
+    uint16_t evaluated = 0;
+    int64_t since_ms[RULE_MAX_RULES] = {0};
+    int64_t next_ms = INT64_MAX;
+    for (uint8_t i = 0; i < count; i++) {
+        uint16_t bit = (uint16_t)(1 << i);
+        for (uint16_t candidates = old_rules; candidates != 0; candidates &= (uint16_t)(candidates - 1)) {
+            uint8_t old = (uint8_t)__builtin_ctz(candidates);
+            if (memcmp(&engine->rules[old], &rules[i], sizeof(rule_t)) != 0) {
+                continue;
+            }
+            old_rules &= (uint16_t)~(1 << old);
+            active |= (engine->active >> old & 1) ? bit : 0;
+            fired |= (engine->fired >> old & 1) ? bit : 0;
+            evaluated |= (engine->evaluated >> old & 1) ? bit : 0;
+            since_ms[i] = engine->since_ms[old];
+            if ((active & ~fired & bit) && since_ms[i] + rules[i].hold_ms < next_ms) {
+                next_ms = since_ms[i] + rules[i].hold_ms;
+            }
+            break;
+        }
+    }
+
+    memcpy(engine->rules, rules, sizeof(rules[0]) * count);
+    memcpy(engine->since_ms, since_ms, sizeof(since_ms[0]) * count);
+    engine->count = count;
+    memset(engine->input_rules, 0, sizeof(engine->input_rules));
+    for (uint8_t i = 0; i < count; i++) {
+        engine->input_rules[rules[i].input] |= (uint16_t)(1 << i);
+    }
+    engine->active = active;
+    engine->fired = fired;
+    engine->evaluated = evaluated;
+    engine->next_deadline_ms = next_ms;
+    return count;
+}
+
+/**
+ * @brief Evaluate one rule against the current input value
+ *        用当前输入值评估一条规则
+ */
+static void rule_evaluate(rule_engine_t *engine, uint8_t index, int64_t now_ms, rule_fire_callback_t callback, void *context) {
+    const rule_t *rule = &engine->rules[index];
+    int32_t value = engine->values[rule->input];
+    uint16_t bit = (uint16_t)(1 << index);
+    bool condition;
+
+    switch (rule->op) {
+        case RULE_OP_LT: condition = value < rule->threshold; break;
+        case RULE_OP_LE: condition = value <= rule->threshold; break;
+        case RULE_OP_GT: condition = value > rule->threshold; break;
+        case RULE_OP_GE: condition = value >= rule->threshold; break;
+        case RULE_OP_EQ: condition = value == rule->threshold; break;
+        default:         condition = value != rule->threshold; break;
+    }
+    engine->evaluations++;
+    engine->evaluated |= bit;
+
+    if (!condition) {
+        engine->active &= (uint16_t)~bit;
+        engine->fired &= (uint16_t)~bit;
+        return;
+    }
+    if (engine->active & bit) {
+        return;
+    }
+
+    engine->active |= bit;
+    engine->since_ms[index] = now_ms;
+    if (rule->hold_ms == 0) {
+        engine->fired |= bit;
+        callback(engine, index, context);
+    } else if (now_ms + rule->hold_ms < engine->next_deadline_ms) {
+        engine->next_deadline_ms = now_ms + rule->hold_ms;
+    }
+}
+
+/**
+ * @brief Update an input and evaluate the rules referencing it
+ *        更新一个输入并评估引用它的规则
+ *
+ * Nothing is evaluated when the value did not change and its rules have already seen it.
+ * 数值未变化且相关规则均已评估过时不做任何评估。
+ *
+ * @param engine Rule engine
+ *               规则引擎
+ * @param input Input to update
+ *              要更新的输入
+ * @param value New value in the input's unit
+ *              输入单位下的新数值
+ * @param now_ms Current time (ms)
+ *               当前时间 (毫秒)
+ * @param callback Called for every rule that fires
+ *                 每条触发的规则都会调用
+ * @param context Passed to callback
+ *                传给 callback
+ */
+void rule_engine_set_input(rule_engine_t *engine, rule_input_t input, int32_t value, int64_t now_ms,
+                           rule_fire_callback_t callback, void *context) {
+    uint16_t rules = engine->input_rules[input];
+    uint8_t input_bit = (uint8_t)(1 << input);
+
+    if ((engine->known_inputs & input_bit) && engine->values[input] == value && (rules & ~engine->evaluated) == 0) {
+        return;
+    }
+    engine->values[input] = value;
+    engine->known_inputs |= input_bit;
+
+    while (rules != 0) {
+        uint8_t index = (uint8_t)__builtin_ctz(rules);
+        rules &= (uint16_t)(rules - 1);
+        rule_evaluate(engine, index, now_ms, callback, context);
+    }
+}
+
+/**
+ * @brief Fire the rules whose hold time has passed
+ *        触发保持时间已到的规则
+ *
+ * Only a comparison until the earliest deadline is reached.
+ * 在最早截止时刻到达之前只做一次比较。
+ *
+ * @param engine Rule engine
+ *               规则引擎
+ * @param now_ms Current time (ms)
+ *               当前时间 (毫秒)
+ * @param callback Called for every rule that fires
+ *                 每条触发的规则都会调用
+ * @param context Passed to callback
+ *                传给 callback
+ */
+void rule_engine_poll(rule_engine_t *engine, int64_t now_ms, rule_fire_callback_t callback, void *context) {
+    if (now_ms < engine->next_deadline_ms) {
+        return;
+    }
+
+    int64_t next_ms = INT64_MAX;
+    uint16_t pending = engine->active & (uint16_t)~engine->fired;
+    while (pending != 0) {
+        uint8_t index = (uint8_t)__builtin_ctz(pending);
+        pending &= (uint16_t)(pending - 1);
+
+        int64_t deadline_ms = engine->since_ms[index] + engine->rules[index].hold_ms;
+        if (now_ms >= deadline_ms) {
+            engine->fired |= (uint16_t)(1 << index);
+            callback(engine, index, context);
+        } else if (deadline_ms < next_ms) {
+            next_ms = deadline_ms;
+        }
+    }
+    engine->next_deadline_ms = next_ms;
+}
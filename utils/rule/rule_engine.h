@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __RULE_ENGINE_H__
+#define __RULE_ENGINE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * Threshold rules compiled from a compact text form, one rule per ';':
+ * 由紧凑文本编译而成的阈值规则，规则之间以 ';' 分隔：
+ *
+ *   <input><op><value>[/<hold s>] <action>[:<param>]
+ *
+ *   SPEED>20/3 START        start recording when faster than 20 km/h for 3 s
+ *                           速度超过 20 km/h 持续 3 秒时开始录制
+ *   BATTERY<10 STOP         stop recording below 10 % battery
+ *                           电量低于 10% 时停止录制
+ *   SPEED<2/300 MODE:2      switch to timelapse when stationary for 5 min
+ *                           静止 5 分钟时切换到延时摄影
+ *
+ * Inputs: SPEED (km/h), ALT (m), SATS, BATTERY (%), RECORDING (0/1), MODE (camera_mode_t)
+ * Ops: < <= > >= = !=    Actions: START, STOP, MODE:<camera_mode_t>
+ *
+ * A rule fires once when its condition has held for the hold time and re-arms when the condition
+ * turns false. Only the rules referencing an input are evaluated when that input changes; hold
+ * times are served from a single earliest deadline.
+ * 条件持续满足保持时间后规则触发一次，条件变为假时重新布防。某输入变化时只评估引用该输入的规则；
+ * 保持时间由单个最早截止时刻驱动。
+ */
+
+#define RULE_MAX_RULES      16
+#define RULE_TEXT_MAX       512
+
+/* Rule input, values are integers in the unit listed */
+/* 规则输入，数值为所列单位的整数 */
+typedef enum {
+    RULE_INPUT_SPEED = 0,       // 0.1 km/h
+    RULE_INPUT_ALTITUDE,        // m
+    RULE_INPUT_SATELLITES,
+    RULE_INPUT_BATTERY,         // %
+    RULE_INPUT_RECORDING,       // 0 / 1
+    RULE_INPUT_CAMERA_MODE,     // camera_mode_t
+    RULE_INPUT_COUNT,
+} rule_input_t;
+
+typedef enum {
+    RULE_OP_LT = 0,
+    RULE_OP_LE,
+    RULE_OP_GT,
+    RULE_OP_GE,
+    RULE_OP_EQ,
+    RULE_OP_NE,
+} rule_op_t;
+
+/* One compiled rule */
+/* 一条编译后的规则 */
+typedef struct {
+    uint8_t input;              // rule_input_t
+    uint8_t op;                 // rule_op_t
+    uint8_t action;             // camera_action_type_t
+    uint8_t action_param;
+    int32_t threshold;          // In the input's unit
+                                // 输入的单位
+    uint32_t hold_ms;           // Condition must hold this long before firing
+                                // 条件需持续满足的时长
+} rule_t;
+
+typedef struct rule_engine rule_engine_t;
+
+/**
+ * @brief Called when a rule fires
+ *        规则触发时调用
+ */
+typedef void (*rule_fire_callback_t)(const rule_engine_t *engine, uint8_t index, void *context);
+
+struct rule_engine {
+    rule_t rules[RULE_MAX_RULES];
+    uint8_t count;
+    uint16_t input_rules[RULE_INPUT_COUNT];    // Rules referencing each input, one bit per rule
+                                               // 引用各输入的规则，每条规则一位
+    int32_t values[RULE_INPUT_COUNT];
+    uint8_t known_inputs;                      // Inputs that have a value, one bit per input
+                                               // 已有数值的输入，每个输入一位
+    uint16_t active;                           // Condition true, one bit per rule
+                                               // 条件为真，每条规则一位
+    uint16_t fired;                            // Fired since the condition became true
+                                               // 条件变为真后已触发
+    uint16_t evaluated;                        // Evaluated since the rules were compiled
+                                               // 自编译以来已评估
+    int64_t since_ms[RULE_MAX_RULES];          // When the condition became true
+                                               // 条件变为真的时刻
+    int64_t next_deadline_ms;                  // Earliest pending hold expiry, INT64_MAX if none
+                                               // 最早到期的保持时间，无则为 INT64_MAX
+    uint32_t evaluations;                      // Rule conditions evaluated
+                                               // 已评估的规则条件数
+};
+
+int rule_engine_compile(rule_engine_t *engine, const char *text, char *error, size_t error_size);
+
+void rule_engine_set_input(rule_engine_t *engine, rule_input_t input, int32_t value, int64_t now_ms,
+                           rule_fire_callback_t callback, void *context);
+
+void rule_engine_poll(rule_engine_t *engine, int64_t now_ms, rule_fire_callback_t callback, void *context);
+
+#endif
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+
+#include "scan_cache.h"
+
+/**
+ * @brief Clear the cache
+ *        清空缓存
+ */
+void scan_cache_init(scan_cache_t *cache) {
+    memset(cache, 0, sizeof(*cache));
+}
+
+/**
+ * @brief Find a camera by address
+ *        按地址查找相机
+ *
+ * @return scan_cache_entry_t* Entry, NULL if the camera is not cached
+ *                             条目，相机不在缓存中时为 NULL
+ */
+scan_cache_entry_t *scan_cache_find(scan_cache_t *cache, const uint8_t addr[6]) {
+    for (uint8_t i = 0; i < cache->count; i++) {
+        if (memcmp(cache->entries[i].addr, addr, sizeof(cache->entries[i].addr)) == 0) {
+            return &cache->entries[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Record an advertising report
+ *        记录一次广播报告
+ *
+ * A new camera takes a free entry, or the one heard least recently when the cache is full.
+ * 新相机占用空闲条目，缓存已满时替换最久未听到的条目。
+ *
+ * @param cache Cache to update
+ *              要更新的缓存
+ * @param addr Camera address
+ *             相机地址
+ * @param name Advertised name, need not be terminated
+ *             广播名称，不要求以 0 结尾
+ * @param name_length Length of the name
+ *                    名称长度
+ * @param rssi RSSI of the report
+ *             报告的 RSSI
+ * @param now_ms Time of the report
+ *               报告时刻
+ * @return scan_cache_entry_t* Entry of the camera, reports is 1 for a camera not cached before
+ *                             相机的条目，之前未缓存的相机 reports 为 1
+ */
+scan_cache_entry_t *scan_cache_update(scan_cache_t *cache, const uint8_t addr[6], const char *name, size_t name_length,
+                                      int8_t rssi, int64_t now_ms) {
+    scan_cache_entry_t *entry = scan_cache_find(cache, addr);
+    if (entry != NULL) {
+        // 指数平均，新报告权重 1/4
+        // Exponential average, a new report weighs 1/4
+        entry->rssi_x16 += ((int16_t)(rssi * 16) - entry->rssi_x16) / (1 << SCAN_CACHE_RSSI_SHIFT);
+        entry->last_rssi = rssi;
+        entry->last_seen_ms = now_ms;
+        if (entry->reports < UINT16_MAX) {
+            entry->reports++;
+        }
+        return entry;
+    }
+
+    if (cache->count < SCAN_CACHE_MAX_ENTRIES) {
+        entry = &cache->entries[cache->count++];
+    } else {
+        entry = &cache->entries[0];
+        for (uint8_t i = 1; i < cache->count; i++) {
+            if (cache->entries[i].last_seen_ms < entry->last_seen_ms) {
+                entry = &cache->entries[i];
+            }
+        }
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    memcpy(entry->addr, addr, sizeof(entry->addr));
+    if (name != NULL) {
+        size_t length = name_length < sizeof(entry->name) - 1 ? name_length : sizeof(entry->name) - 1;
+        memcpy(entry->name, name, length);
+    }
+    entry->rssi_x16 = rssi * 16;
+    entry->last_rssi = rssi;
+    entry->reports = 1;
+    entry->first_seen_ms = now_ms;
+    entry->last_seen_ms = now_ms;
+    return entry;
+}
+
+/**
+ * @brief Smoothed RSSI of a camera
+ *        相机的平滑 RSSI
+ */
+int8_t scan_cache_rssi(const scan_cache_entry_t *entry) {
+    return (int8_t)(entry->rssi_x16 / 16);
+}
+
+/**
+ * @brief Drop cameras not heard for max_age_ms
+ *        删除超过 max_age_ms 未听到的相机
+ */
+void scan_cache_expire(scan_cache_t *cache, int64_t now_ms, int64_t max_age_ms) {
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < cache->count; i++) {
+        if (now_ms - cache->entries[i].last_seen_ms <= max_age_ms) {
+            cache->entries[kept++] = cache->entries[i];
+        }
+    }
+    cache->count = kept;
+}
+
+/**
+ * @brief Strongest camera heard since a given time
+ *        指定时刻以来听到的信号最强的相机
+ *
+ * @param cache Cache to search
+ *              要查找的缓存
+ * @param since_ms Only cameras heard at or after this time
+ *                 仅考虑此时刻及之后听到的相机
+ * @param min_rssi Smoothed RSSI a camera needs at least
+ *                 相机至少需要的平滑 RSSI
+ * @param exclude Skips a camera when it returns true, may be NULL
+ *                返回 true 时跳过该相机，可为 NULL
+ * @param context Passed to exclude
+ *                传给 exclude
+ * @return const scan_cache_entry_t* Camera with the highest smoothed RSSI, NULL if none qualifies
+ *                                   平滑 RSSI 最高的相机，无符合条件者时为 NULL
+ */
+const scan_cache_entry_t *scan_cache_best(const scan_cache_t *cache, int64_t since_ms, int8_t min_rssi,
+                                          scan_cache_exclude_t exclude, void *context) {
+    const scan_cache_entry_t *best = NULL;
+    for (uint8_t i = 0; i < cache->count; i++) {
+        const scan_cache_entry_t *entry = &cache->entries[i];
+        if (entry->last_seen_ms < since_ms || scan_cache_rssi(entry) < min_rssi) {
+            continue;
+        }
+        if (exclude != NULL && exclude(entry, context)) {
+            continue;
+        }
+        if (best == NULL || entry->rssi_x16 > best->rssi_x16) {
+            best = entry;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Whether a camera that was just reported can be connected before the scan window ends
+ *        刚上报的相机能否在扫描窗口结束前连接
+ *
+ * A camera connected before is taken on any report at min_rssi or better. A new camera needs a smoothed
+ * RSSI of early_rssi, and either a second report or a lead of margin dB over the runner-up heard since
+ * since_ms, so one noisy report of a camera further away cannot win.
+ * 曾经连接过的相机在任一 min_rssi 及以上的报告时即可连接。新相机需要平滑 RSSI 达到 early_rssi，并且已有第二次
+ * 报告，或领先 since_ms 以来听到的次强相机 margin dB，避免较远相机的一次噪声报告胜出。
+ *
+ * @param cache Cache holding the camera
+ *              包含该相机的缓存
+ * @param entry Camera just reported, known set by the caller for this report
+ *              刚上报的相机，known 由调用者按本次报告设置
+ * @param since_ms Start of the scan, only cameras heard since then are runners-up
+ *                 扫描开始时刻，仅此后听到的相机参与次强比较
+ * @param min_rssi Smoothed RSSI any camera needs at least
+ *                 任何相机至少需要的平滑 RSSI
+ * @param early_rssi Smoothed RSSI a new camera needs at least
+ *                   新相机至少需要的平滑 RSSI
+ * @param margin Lead over the runner-up that stands in for a second report
+ *               可代替第二次报告的、相对次强相机的领先量
+ * @param exclude Skips a camera when it returns true, the camera itself included, may be NULL
+ *                返回 true 时跳过该相机，包括该相机本身，可为 NULL
+ * @param context Passed to exclude
+ *                传给 exclude
+ * @return bool true to connect now
+ *              true 表示立即连接
+ */
+bool scan_cache_connect_early(const scan_cache_t *cache, const scan_cache_entry_t *entry, int64_t since_ms,
+                              int8_t min_rssi, int8_t early_rssi, int8_t margin, scan_cache_exclude_t exclude,
+                              void *context) {
+    int8_t rssi = scan_cache_rssi(entry);
+    if (rssi < min_rssi || (exclude != NULL && exclude(entry, context))) {
+        return false;
+    }
+    if (entry->known) {
+        return true;
+    }
+    if (rssi < early_rssi) {
+        return false;
+    }
+    if (entry->reports >= 2) {
+        return true;
+    }
+
+    // 单次报告：需要领先本次扫描听到的次强相机，未听到其他相机时无从比较
+    // A single report: it has to lead the runner-up of this scan, with no other camera heard there is nothing to compare
+    const scan_cache_entry_t *runner_up = NULL;
+    for (uint8_t i = 0; i < cache->count; i++) {
+        const scan_cache_entry_t *other = &cache->entries[i];
+        if (other == entry || other->last_seen_ms < since_ms || (exclude != NULL && exclude(other, context))) {
+            continue;
+        }
+        if (runner_up == NULL || other->rssi_x16 > runner_up->rssi_x16) {
+            runner_up = other;
+        }
+    }
+    return runner_up != NULL && rssi - scan_cache_rssi(runner_up) >= margin;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __SCAN_CACHE_H__
+#define __SCAN_CACHE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * Cameras heard while scanning, kept across scans so a connect does not have to wait for a whole
+ * scan window to compare signal strengths. The RSSI is smoothed with an exponential average so a
+ * single strong report does not win over a camera that is steadily closer.
+ * 扫描时听到的相机，跨扫描保留，连接时无需等待整个扫描窗口来比较信号强度。RSSI 经指数平均平滑，
+ * 单次较强的报告不会胜过一直更近的相机。
+ */
+
+#define SCAN_CACHE_MAX_ENTRIES  8
+#define SCAN_CACHE_NAME_MAX     32
+
+/* Weight of a new report in the smoothed RSSI, 1 / 2^SCAN_CACHE_RSSI_SHIFT */
+/* 新报告在平滑 RSSI 中的权重，为 1 / 2^SCAN_CACHE_RSSI_SHIFT */
+#define SCAN_CACHE_RSSI_SHIFT   2
+
+typedef struct {
+    uint8_t addr[6];
+    char name[SCAN_CACHE_NAME_MAX];
+    int16_t rssi_x16;           // Smoothed RSSI, 1/16 dBm
+                                // 平滑后的 RSSI，单位 1/16 dBm
+    int8_t last_rssi;           // RSSI of the latest report
+                                // 最近一次报告的 RSSI
+    bool known;                 // Connected before, set by the caller on every report
+                                // 曾经连接过，由调用者在每次报告时设置
+    uint16_t reports;           // Reports since the entry was created
+                                // 条目创建以来的报告数
+    int64_t first_seen_ms;
+    int64_t last_seen_ms;
+} scan_cache_entry_t;
+
+typedef struct {
+    scan_cache_entry_t entries[SCAN_CACHE_MAX_ENTRIES];
+    uint8_t count;
+} scan_cache_t;
+
+/**
+ * @brief Skip a camera in scan_cache_best(), e.g. one held by another link
+ *        在 scan_cache_best() 中跳过某台相机，例如已被其他链路占用的相机
+ */
+typedef bool (*scan_cache_exclude_t)(const scan_cache_entry_t *entry, void *context);
+
+void scan_cache_init(scan_cache_t *cache);
+
+scan_cache_entry_t *scan_cache_update(scan_cache_t *cache, const uint8_t addr[6], const char *name, size_t name_length,
+                                      int8_t rssi, int64_t now_ms);
+
+scan_cache_entry_t *scan_cache_find(scan_cache_t *cache, const uint8_t addr[6]);
+
+int8_t scan_cache_rssi(const scan_cache_entry_t *entry);
+
+void scan_cache_expire(scan_cache_t *cache, int64_t now_ms, int64_t max_age_ms);
+
+const scan_cache_entry_t *scan_cache_best(const scan_cache_t *cache, int64_t since_ms, int8_t min_rssi,
+                                          scan_cache_exclude_t exclude, void *context);
+
+bool scan_cache_connect_early(const scan_cache_t *cache, const scan_cache_entry_t *entry, int64_t since_ms,
+                              int8_t min_rssi, int8_t early_rssi, int8_t margin, scan_cache_exclude_t exclude,
+                              void *context);
+
+#endif
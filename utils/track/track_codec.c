@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+
+#include "track_codec.h"
+
+#define TRACK_TAG_RUN_MASK      0x80
+#define TRACK_TAG_SMALL         0x80
+#define TRACK_TAG_SMALL_MASK    0xC0
+#define TRACK_TAG_FULL          0xC0
+#define TRACK_TAG_FULL_MASK     0xF0
+#define TRACK_TAG_KEY           0xE0
+
+#define TRACK_RUN_MAX           0x7F
+#define TRACK_NO_RUN            ((size_t)-1)
+
+#define TRACK_FIELD_COUNT       4
+
+static void point_to_fields(const track_point_t *point, int64_t fields[TRACK_FIELD_COUNT]) {
+    fields[0] = point->time_ms;
+    fields[1] = point->latitude;
+    fields[2] = point->longitude;
+    fields[3] = point->altitude;
+}
+
+static void fields_to_point(const int64_t fields[TRACK_FIELD_COUNT], track_point_t *point) {
+    point->time_ms = fields[0];
+    point->latitude = (int32_t)fields[1];
+    point->longitude = (int32_t)fields[2];
+    point->altitude = (int32_t)fields[3];
+}
+
+static void put_le(uint8_t *out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint64_t get_le(const uint8_t *in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * @brief Write a zigzag encoded varint
+ *        写入 zigzag 编码的变长整数
+ *
+ * @return size_t Number of bytes written (1 to 10)
+ *                写入的字节数（1 到 10）
+ */
+static size_t put_varint(uint8_t *out, int64_t value) {
+    uint64_t zigzag = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+    size_t length = 0;
+
+    while (zigzag >= 0x80) {
+        out[length++] = (uint8_t)(zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    out[length++] = (uint8_t)zigzag;
+    return length;
+}
+
+/**
+ * @brief Read a zigzag encoded varint
+ *        读取 zigzag 编码的变长整数
+ *
+ * @return bool Returns false if the buffer ends inside the varint
+ *              变长整数被截断时返回 false
+ */
+static bool get_varint(track_decoder_t *dec, int64_t *value) {
+    uint64_t zigzag = 0;
+
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (dec->offset >= dec->length) {
+            return false;
+        }
+        uint8_t byte = dec->buffer[dec->offset++];
+        zigzag |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Start encoding into an empty block
+ *        开始向空块编码
+ *
+ * @param enc Encoder
+ *            编码器
+ * @param buffer Block payload buffer
+ *               块数据缓冲区
+ * @param capacity Buffer size
+ *                 缓冲区大小
+ */
+void track_encoder_begin(track_encoder_t *enc, uint8_t *buffer, size_t capacity) {
+    memset(enc, 0, sizeof(*enc));
+    enc->buffer = buffer;
+    enc->capacity = capacity;
+    enc->run_index = TRACK_NO_RUN;
+}
+
+/**
+ * @brief Append one point to the block
+ *        向块中追加一个点
+ *
+ * @param enc Encoder
+ *            编码器
+ * @param point Point to append
+ *              要追加的点
+ * @return bool Returns false if the block is full, the point is not added and a new block must be started
+ *              块已满时返回 false，该点未被写入，需要开始新块
+ */
+bool track_encoder_add(track_encoder_t *enc, const track_point_t *point) {
+    int64_t fields[TRACK_FIELD_COUNT];
+    int64_t last[TRACK_FIELD_COUNT];
+    int64_t dd[TRACK_FIELD_COUNT];
+    uint8_t record[1 + TRACK_FIELD_COUNT * 10];
+    size_t record_length = 0;
+
+    point_to_fields(point, fields);
+
+    if (!enc->has_key) {
+        if (enc->capacity - enc->length < TRACK_RECORD_KEY_LENGTH) {
+            return false;
+        }
+        uint8_t *out = enc->buffer + enc->length;
+        out[0] = TRACK_TAG_KEY;
+        put_le(out + 1, (uint64_t)point->time_ms, 8);
+        put_le(out + 9, (uint32_t)point->latitude, 4);
+        put_le(out + 13, (uint32_t)point->longitude, 4);
+        put_le(out + 17, (uint32_t)point->altitude, 4);
+        enc->length += TRACK_RECORD_KEY_LENGTH;
+        enc->has_key = true;
+        enc->last = *point;
+        memset(enc->delta, 0, sizeof(enc->delta));
+        return true;
+    }
+
+    point_to_fields(&enc->last, last);
+    bool on_prediction = true;
+    for (int i = 0; i < TRACK_FIELD_COUNT; i++) {
+        dd[i] = fields[i] - (last[i] + enc->delta[i]);
+        on_prediction &= (dd[i] == 0);
+    }
+
+    if (on_prediction) {
+        // 延长当前 RUN，RUN 字节在首次使用时就已写入
+        // Extend the open RUN, its byte was written when the run started
+        if (enc->run_index != TRACK_NO_RUN && enc->buffer[enc->run_index] < TRACK_RUN_MAX) {
+            enc->buffer[enc->run_index]++;
+        } else {
+            if (enc->capacity - enc->length < 1) {
+                return false;
+            }
+            enc->run_index = enc->length;
+            enc->buffer[enc->length++] = 0;
+        }
+    } else {
+        if (dd[0] == 0 && dd[1] >= -16 && dd[1] <= 15 && dd[2] >= -16 && dd[2] <= 15 && dd[3] >= -8 && dd[3] <= 7) {
+            uint16_t small = 0x8000 | ((uint16_t)(dd[1] & 0x1F) << 9) | ((uint16_t)(dd[2] & 0x1F) << 4) | (uint16_t)(dd[3] & 0x0F);
+            record[0] = (uint8_t)(small >> 8);
+            record[1] = (uint8_t)small;
+            record_length = 2;
+        } else {
+            uint8_t flags = 0;
+            record_length = 1;
+            for (int i = 0; i < TRACK_FIELD_COUNT; i++) {
+                if (dd[i] != 0) {
+                    flags |= (uint8_t)(0x08 >> i);
+                    record_length += put_varint(record + record_length, dd[i]);
+                }
+            }
+            record[0] = TRACK_TAG_FULL | flags;
+        }
+
+        if (enc->capacity - enc->length < record_length) {
+            return false;
+        }
+        memcpy(enc->buffer + enc->length, record, record_length);
+        enc->length += record_length;
+        enc->run_index = TRACK_NO_RUN;
+    }
+
+    for (int i = 0; i < TRACK_FIELD_COUNT; i++) {
+        enc->delta[i] = fields[i] - last[i];
+    }
+    enc->last = *point;
+    return true;
+}
+
+/**
+ * @brief Start decoding a block
+ *        开始解码一个块
+ *
+ * @param dec Decoder
+ *            解码器
+ * @param buffer Block payload
+ *               块数据
+ * @param length Payload length
+ *               数据长度
+ */
+void track_decoder_begin(track_decoder_t *dec, const uint8_t *buffer, size_t length) {
+    memset(dec, 0, sizeof(*dec));
+    dec->buffer = buffer;
+    dec->length = length;
+}
+
+/**
+ * @brief Apply second differences to the prediction and emit the point
+ *        将二阶差分应用到预测值并输出点
+ */
+static void decoder_apply(track_decoder_t *dec, const int64_t dd[TRACK_FIELD_COUNT], track_point_t *out) {
+    int64_t last[TRACK_FIELD_COUNT];
+    int64_t fields[TRACK_FIELD_COUNT];
+
+    point_to_fields(&dec->last, last);
+    for (int i = 0; i < TRACK_FIELD_COUNT; i++) {
+        fields[i] = last[i] + dec->delta[i] + dd[i];
+        dec->delta[i] = fields[i] - last[i];
+    }
+    fields_to_point(fields, &dec->last);
+    *out = dec->last;
+}
+
+/**
+ * @brief Decode the next point of the block
+ *        解码块中的下一个点
+ *
+ * @param dec Decoder
+ *            解码器
+ * @param out Decoded point
+ *            解码后的点
+ * @return bool Returns false at the end of the block or on malformed data
+ *              到达块末尾或数据格式错误时返回 false
+ */
+bool track_decoder_next(track_decoder_t *dec, track_point_t *out) {
+    int64_t dd[TRACK_FIELD_COUNT] = {0};
+
+    if (dec->run_remaining > 0) {
+        dec->run_remaining--;
+        decoder_apply(dec, dd, out);
+        return true;
+    }
+
+    if (dec->offset >= dec->length) {
+        return false;
+    }
+
+    const uint8_t *in = dec->buffer + dec->offset;
+    uint8_t tag = in[0];
+
+    if (tag == TRACK_TAG_KEY) {
+        if (dec->length - dec->offset < TRACK_RECORD_KEY_LENGTH) {
+            return false;
+        }
+        dec->last.time_ms = (int64_t)get_le(in + 1, 8);
+        dec->last.latitude = (int32_t)(uint32_t)get_le(in + 9, 4);
+        dec->last.longitude = (int32_t)(uint32_t)get_le(in + 13, 4);
+        dec->last.altitude = (int32_t)(uint32_t)get_le(in + 17, 4);
+        memset(dec->delta, 0, sizeof(dec->delta));
+        dec->offset += TRACK_RECORD_KEY_LENGTH;
+        dec->has_key = true;
+        *out = dec->last;
+        return true;
+    }
+
+    if (!dec->has_key) {
+        return false;
+    }
+
+    if ((tag & TRACK_TAG_RUN_MASK) == 0) {
+        dec->offset++;
+        dec->run_remaining = tag;
+        decoder_apply(dec, dd, out);
+        return true;
+    }
+
+    if ((tag & TRACK_TAG_SMALL_MASK) == TRACK_TAG_SMALL) {
+        if (dec->length - dec->offset < 2) {
+            return false;
+        }
+        uint16_t small = ((uint16_t)in[0] << 8) | in[1];
+        // 符号扩展 5 位和 4 位字段
+        // Sign extend the 5 and 4 bit fields
+        dd[1] = (int64_t)((int8_t)(((small >> 9) & 0x1F) << 3) >> 3);
+        dd[2] = (int64_t)((int8_t)(((small >> 4) & 0x1F) << 3) >> 3);
+        dd[3] = (int64_t)((int8_t)((small & 0x0F) << 4) >> 4);
+        dec->offset += 2;
+        decoder_apply(dec, dd, out);
+        return true;
+    }
+
+    if ((tag & TRACK_TAG_FULL_MASK) == TRACK_TAG_FULL) {
+        dec->offset++;
+        for (int i = 0; i < TRACK_FIELD_COUNT; i++) {
+            if ((tag & (0x08 >> i)) && !get_varint(dec, &dd[i])) {
+                return false;
+            }
+        }
+        decoder_apply(dec, dd, out);
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __TRACK_CODEC_H__
+#define __TRACK_CODEC_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * Track point encoding, one self-contained block at a time.
+ * 轨迹点编码，每个块可独立解码。
+ *
+ * Each field is predicted as previous value + previous delta, only the second difference is stored:
+ * 每个字段按 "上一值 + 上一增量" 预测，只存储二阶差分：
+ *
+ *   0nnnnnnn                     RUN: n+1 points exactly on the prediction
+ *                                连续 n+1 个点与预测完全一致
+ *   10aaaaab bbbbcccc            SMALL: lat/lon second difference in [-16, 15], alt in [-8, 7], time on prediction
+ *                                经纬度二阶差分在 [-16, 15]，高度在 [-8, 7]，时间与预测一致
+ *   1100tnea <zigzag varints>    FULL: second difference of time/lat/lon/alt, only flagged fields present
+ *                                时间/纬度/经度/高度的二阶差分，仅包含标志位置位的字段
+ *   11100000 <time 8> <lat 4> <lon 4> <alt 4>   KEY: absolute point, little endian, starts every block
+ *                                               绝对值关键帧，小端，每个块以其开始
+ */
+
+#define TRACK_RECORD_KEY_LENGTH     21
+
+// Coordinate resolution, 1e-6 degree is about 0.11 m
+// 坐标分辨率，1e-6 度约 0.11 米
+#define TRACK_COORD_SCALE           1000000
+
+/* One track point */
+/* 一个轨迹点 */
+typedef struct {
+    int64_t time_ms;      // UTC milliseconds since 1970
+                          // 自 1970 年起的 UTC 毫秒数
+    int32_t latitude;     // Degrees * TRACK_COORD_SCALE
+                          // 度 * TRACK_COORD_SCALE
+    int32_t longitude;    // Degrees * TRACK_COORD_SCALE
+                          // 度 * TRACK_COORD_SCALE
+    int32_t altitude;     // Decimeters
+                          // 分米
+} track_point_t;
+
+typedef struct {
+    uint8_t *buffer;
+    size_t capacity;
+    size_t length;
+    bool has_key;
+    track_point_t last;
+    int64_t delta[4];      // Last delta of time/lat/lon/alt
+                           // 时间/纬度/经度/高度的上一增量
+    size_t run_index;      // Position of the open RUN byte, SIZE_MAX if none
+                           // 当前 RUN 字节的位置，无则为 SIZE_MAX
+} track_encoder_t;
+
+typedef struct {
+    const uint8_t *buffer;
+    size_t length;
+    size_t offset;
+    bool has_key;
+    track_point_t last;
+    int64_t delta[4];
+    uint8_t run_remaining;
+} track_decoder_t;
+
+void track_encoder_begin(track_encoder_t *enc, uint8_t *buffer, size_t capacity);
+
+bool track_encoder_add(track_encoder_t *enc, const track_point_t *point);
+
+void track_decoder_begin(track_decoder_t *dec, const uint8_t *buffer, size_t length);
+
+bool track_decoder_next(track_decoder_t *dec, track_point_t *out);
+
+#endif
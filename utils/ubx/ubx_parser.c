@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+
+#include "ubx_parser.h"
+
+_Static_assert(sizeof(ubx_nav_pvt_t) == UBX_NAV_PVT_PAYLOAD_LENGTH, "ubx_nav_pvt_t must match the NAV-PVT payload layout");
+
+/**
+ * @brief Compute the 8-bit Fletcher checksum used by UBX
+ *        计算 UBX 使用的 8 位 Fletcher 校验和
+ *
+ * The checksum covers CLASS, ID, LENGTH and PAYLOAD (everything between the sync chars and CK_A).
+ * 校验范围为 CLASS、ID、LENGTH 和 PAYLOAD（同步字符与 CK_A 之间的所有字节）。
+ *
+ * @param data Data to checksum
+ *             需要计算校验的数据
+ * @param length Data length
+ *               数据长度
+ * @param ck_a Output checksum byte A
+ *             输出校验字节 A
+ * @param ck_b Output checksum byte B
+ *             输出校验字节 B
+ */
+void ubx_checksum(const uint8_t *data, size_t length, uint8_t *ck_a, uint8_t *ck_b) {
+    uint8_t a = 0;
+    uint8_t b = 0;
+    for (size_t i = 0; i < length; i++) {
+        a += data[i];
+        b += a;
+    }
+    *ck_a = a;
+    *ck_b = b;
+}
+
+/**
+ * @brief Reset parser to wait for a new frame
+ *        重置解析器，等待新的帧
+ *
+ * @param parser Parser instance
+ *               解析器实例
+ */
+void ubx_parser_init(ubx_parser_t *parser) {
+    memset(parser, 0, sizeof(*parser));
+    parser->state = UBX_STATE_SYNC_1;
+}
+
+/**
+ * @brief Add one byte to the running checksum
+ *        将一个字节累加到校验和
+ */
+static inline void ubx_checksum_update(ubx_parser_t *parser, uint8_t byte) {
+    parser->ck_a += byte;
+    parser->ck_b += parser->ck_a;
+}
+
+/**
+ * @brief Feed one received byte into the parser
+ *        向解析器输入一个接收到的字节
+ *
+ * The parser scans for the sync characters, so it can be fed a stream that mixes NMEA text and UBX frames.
+ * When a frame fails its checksum or is too long, it is dropped and the parser goes back to sync search.
+ * 解析器会搜索同步字符，因此可以输入 NMEA 文本与 UBX 帧混合的数据流。
+ * 校验失败或过长的帧会被丢弃，解析器回到同步搜索状态。
+ *
+ * @param parser Parser instance
+ *               解析器实例
+ * @param byte Received byte
+ *             接收到的字节
+ *
+ * @return bool Returns true when a complete, valid message is available in parser->msg_class/msg_id/payload
+ *              当 parser->msg_class/msg_id/payload 中有一条完整且有效的消息时返回 true
+ */
+bool ubx_parser_feed(ubx_parser_t *parser, uint8_t byte) {
+    switch (parser->state) {
+        case UBX_STATE_SYNC_1:
+            if (byte == UBX_SYNC_CHAR_1) {
+                parser->state = UBX_STATE_SYNC_2;
+            }
+            break;
+
+        case UBX_STATE_SYNC_2:
+            if (byte == UBX_SYNC_CHAR_2) {
+                parser->ck_a = 0;
+                parser->ck_b = 0;
+                parser->state = UBX_STATE_CLASS;
+            } else if (byte != UBX_SYNC_CHAR_1) {
+                // 0xB5 0xB5 0x62 is still a valid start, otherwise search again
+                // 0xB5 0xB5 0x62 仍是合法起始，否则重新搜索
+                parser->state = UBX_STATE_SYNC_1;
+            }
+            break;
+
+        case UBX_STATE_CLASS:
+            parser->msg_class = byte;
+            ubx_checksum_update(parser, byte);
+            parser->state = UBX_STATE_ID;
+            break;
+
+        case UBX_STATE_ID:
+            parser->msg_id = byte;
+            ubx_checksum_update(parser, byte);
+            parser->state = UBX_STATE_LENGTH_1;
+            break;
+
+        case UBX_STATE_LENGTH_1:
+            parser->length = byte;
+            ubx_checksum_update(parser, byte);
+            parser->state = UBX_STATE_LENGTH_2;
+            break;
+
+        case UBX_STATE_LENGTH_2:
+            parser->length |= (uint16_t)byte << 8;
+            ubx_checksum_update(parser, byte);
+            if (parser->length > UBX_MAX_PAYLOAD_LENGTH) {
+                parser->overflow_errors++;
+                parser->state = UBX_STATE_SYNC_1;
+                break;
+            }
+            parser->index = 0;
+            parser->state = (parser->length == 0) ? UBX_STATE_CK_A : UBX_STATE_PAYLOAD;
+            break;
+
+        case UBX_STATE_PAYLOAD:
+            parser->payload[parser->index++] = byte;
+            ubx_checksum_update(parser, byte);
+            if (parser->index >= parser->length) {
+                parser->state = UBX_STATE_CK_A;
+            }
+            break;
+
+        case UBX_STATE_CK_A:
+            if (byte == parser->ck_a) {
+                parser->state = UBX_STATE_CK_B;
+            } else {
+                parser->checksum_errors++;
+                parser->state = UBX_STATE_SYNC_1;
+            }
+            break;
+
+        case UBX_STATE_CK_B:
+            parser->state = UBX_STATE_SYNC_1;
+            if (byte == parser->ck_b) {
+                parser->message_count++;
+                return true;
+            }
+            parser->checksum_errors++;
+            break;
+
+        default:
+            parser->state = UBX_STATE_SYNC_1;
+            break;
+    }
+    return false;
+}
+
+/**
+ * @brief Build a complete UBX frame (sync chars, header, payload and checksum)
+ *        构造完整的 UBX 帧（同步字符、帧头、载荷和校验）
+ *
+ * @param msg_class Message class
+ *                  消息类
+ * @param msg_id Message ID
+ *               消息 ID
+ * @param payload Payload data, may be NULL when payload_length is 0 (poll request)
+ *                载荷数据，payload_length 为 0 时可以为 NULL（轮询请求）
+ * @param payload_length Payload length
+ *                       载荷长度
+ * @param out Output buffer
+ *            输出缓冲区
+ * @param out_size Output buffer size
+ *                 输出缓冲区大小
+ *
+ * @return size_t Frame length on success, 0 if the buffer is too small
+ *                成功返回帧长度，缓冲区不足返回 0
+ */
+size_t ubx_build_message(uint8_t msg_class, uint8_t msg_id, const void *payload, uint16_t payload_length,
+                         uint8_t *out, size_t out_size) {
+    size_t frame_length = UBX_HEADER_LENGTH + payload_length + UBX_CHECKSUM_LENGTH;
+    if (out == NULL || out_size < frame_length || (payload == NULL && payload_length > 0)) {
+        return 0;
+    }
+
+    out[0] = UBX_SYNC_CHAR_1;
+    out[1] = UBX_SYNC_CHAR_2;
+    out[2] = msg_class;
+    out[3] = msg_id;
+    out[4] = payload_length & 0xFF;
+    out[5] = (payload_length >> 8) & 0xFF;
+    if (payload_length > 0) {
+        memcpy(&out[UBX_HEADER_LENGTH], payload, payload_length);
+    }
+
+    // Checksum starts at CLASS
+    // 校验从 CLASS 开始
+    ubx_checksum(&out[2], 4 + payload_length,
+                 &out[UBX_HEADER_LENGTH + payload_length],
+                 &out[UBX_HEADER_LENGTH + payload_length + 1]);
+    return frame_length;
+}
+
+/**
+ * @brief Decode the last complete message as NAV-PVT
+ *        将最近一条完整消息解码为 NAV-PVT
+ *
+ * @param parser Parser holding a complete message (ubx_parser_feed() returned true)
+ *               持有完整消息的解析器（ubx_parser_feed() 已返回 true）
+ * @param pvt_out Output NAV-PVT structure
+ *                输出的 NAV-PVT 结构体
+ *
+ * @return bool Returns true if the message is a NAV-PVT of the expected length
+ *              如果消息是长度正确的 NAV-PVT，返回 true
+ */
+bool ubx_decode_nav_pvt(const ubx_parser_t *parser, ubx_nav_pvt_t *pvt_out) {
+    if (parser->msg_class != UBX_CLASS_NAV || parser->msg_id != UBX_ID_NAV_PVT ||
+        parser->length < UBX_NAV_PVT_PAYLOAD_LENGTH) {
+        return false;
+    }
+    memcpy(pvt_out, parser->payload, sizeof(ubx_nav_pvt_t));
+    return true;
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2025 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __UBX_PARSER_H__
+#define __UBX_PARSER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* UBX frame layout: SYNC1 SYNC2 CLASS ID LEN(2, little endian) PAYLOAD CK_A CK_B */
+/* UBX 帧格式：SYNC1 SYNC2 CLASS ID LEN(2字节，小端) PAYLOAD CK_A CK_B */
+#define UBX_SYNC_CHAR_1             0xB5
+#define UBX_SYNC_CHAR_2             0x62
+#define UBX_HEADER_LENGTH           6
+#define UBX_CHECKSUM_LENGTH         2
+
+#define UBX_CLASS_NAV               0x01
+#define UBX_CLASS_ACK               0x05
+#define UBX_CLASS_CFG               0x06
+
+#define UBX_ID_NAV_PVT              0x07
+#define UBX_ID_ACK_NAK              0x00
+#define UBX_ID_ACK_ACK              0x01
+#define UBX_ID_CFG_PRT              0x00
+#define UBX_ID_CFG_MSG              0x01
+#define UBX_ID_CFG_RATE             0x08
+
+#define UBX_NAV_PVT_PAYLOAD_LENGTH  92
+
+// Largest payload we keep; longer messages are dropped and the parser resyncs
+// 可缓存的最大载荷长度，更长的消息会被丢弃并重新同步
+#define UBX_MAX_PAYLOAD_LENGTH      100
+
+// NAV-PVT fixType values
+// NAV-PVT 定位类型
+#define UBX_FIX_TYPE_NO_FIX         0
+#define UBX_FIX_TYPE_2D             2
+#define UBX_FIX_TYPE_3D             3
+#define UBX_FIX_TYPE_GNSS_DR        4
+
+// NAV-PVT flag bits
+// NAV-PVT 标志位
+#define UBX_NAV_PVT_VALID_DATE      0x01
+#define UBX_NAV_PVT_VALID_TIME      0x02
+#define UBX_NAV_PVT_FLAGS_FIX_OK    0x01
+
+/**
+ * @brief UBX-NAV-PVT payload (navigation position velocity time solution)
+ *        UBX-NAV-PVT 载荷（导航位置、速度、时间解）
+ *
+ * Little-endian on the wire, same as the target, so it can be copied directly.
+ * 线上为小端格式，与目标芯片一致，可直接拷贝。
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t i_tow;           // GPS time of week (ms)
+                              // GPS 周内时 (毫秒)
+    uint16_t year;            // Year (UTC)
+                              // 年 (UTC)
+    uint8_t month;            // Month (UTC)
+                              // 月 (UTC)
+    uint8_t day;              // Day (UTC)
+                              // 日 (UTC)
+    uint8_t hour;             // Hour (UTC)
+                              // 时 (UTC)
+    uint8_t min;              // Minute (UTC)
+                              // 分 (UTC)
+    uint8_t sec;              // Second (UTC)
+                              // 秒 (UTC)
+    uint8_t valid;            // Validity flags
+                              // 有效性标志
+    uint32_t t_acc;           // Time accuracy estimate (ns)
+                              // 时间精度估计 (纳秒)
+    int32_t nano;             // Fraction of second (ns), may be negative
+                              // 秒的小数部分 (纳秒)，可能为负
+    uint8_t fix_type;         // GNSS fix type
+                              // 定位类型
+    uint8_t flags;            // Fix status flags
+                              // 定位状态标志
+    uint8_t flags2;           // Additional flags
+                              // 附加标志
+    uint8_t num_sv;           // Number of satellites used in solution
+                              // 参与解算的卫星数量
+    int32_t lon;              // Longitude (1e-7 deg)
+                              // 经度 (1e-7 度)
+    int32_t lat;              // Latitude (1e-7 deg)
+                              // 纬度 (1e-7 度)
+    int32_t height;           // Height above ellipsoid (mm)
+                              // 椭球高 (毫米)
+    int32_t h_msl;            // Height above mean sea level (mm)
+                              // 海拔高度 (毫米)
+    uint32_t h_acc;           // Horizontal accuracy estimate (mm)
+                              // 水平精度估计 (毫米)
+    uint32_t v_acc;           // Vertical accuracy estimate (mm)
+                              // 垂直精度估计 (毫米)
+    int32_t vel_n;            // NED north velocity (mm/s)
+                              // 北向速度 (毫米/秒)
+    int32_t vel_e;            // NED east velocity (mm/s)
+                              // 东向速度 (毫米/秒)
+    int32_t vel_d;            // NED down velocity (mm/s)
+                              // 地向速度 (毫米/秒)
+    int32_t g_speed;          // Ground speed, 2-D (mm/s)
+                              // 地面速度 (毫米/秒)
+    int32_t head_mot;         // Heading of motion, 2-D (1e-5 deg)
+                              // 运动航向 (1e-5 度)
+    uint32_t s_acc;           // Speed accuracy estimate (mm/s)
+                              // 速度精度估计 (毫米/秒)
+    uint32_t head_acc;        // Heading accuracy estimate (1e-5 deg)
+                              // 航向精度估计 (1e-5 度)
+    uint16_t p_dop;           // Position DOP (0.01)
+                              // 位置精度因子 (0.01)
+    uint8_t flags3;           // Additional flags
+                              // 附加标志
+    uint8_t reserved1[5];     // Reserved
+                              // 保留
+    int32_t head_veh;         // Heading of vehicle (1e-5 deg)
+                              // 载体航向 (1e-5 度)
+    int16_t mag_dec;          // Magnetic declination (1e-2 deg)
+                              // 磁偏角 (1e-2 度)
+    uint16_t mag_acc;         // Magnetic declination accuracy (1e-2 deg)
+                              // 磁偏角精度 (1e-2 度)
+} ubx_nav_pvt_t;
+
+/* Receiver configuration payloads (legacy UBX-CFG messages, supported by u-blox 6/7/8 and M9 in compatibility mode) */
+/* 接收机配置载荷（传统 UBX-CFG 消息，u-blox 6/7/8 以及兼容模式下的 M9 支持） */
+#define UBX_CFG_PRT_UART_PORT_ID    1
+#define UBX_CFG_PRT_MODE_8N1        0x000008D0
+#define UBX_PROTO_MASK_UBX          0x0001
+#define UBX_PROTO_MASK_NMEA         0x0002
+
+typedef struct __attribute__((packed)) {
+    uint8_t port_id;          // Port identifier, 1 for UART1
+                              // 端口号，UART1 为 1
+    uint8_t reserved0;        // Reserved
+                              // 保留
+    uint16_t tx_ready;        // TX ready pin configuration, 0 to disable
+                              // TX ready 引脚配置，0 表示禁用
+    uint32_t mode;            // UART mode (character length, parity, stop bits)
+                              // UART 模式（数据位、校验位、停止位）
+    uint32_t baud_rate;       // Baud rate (bit/s)
+                              // 波特率 (bit/s)
+    uint16_t in_proto_mask;   // Accepted input protocols
+                              // 允许的输入协议
+    uint16_t out_proto_mask;  // Enabled output protocols
+                              // 启用的输出协议
+    uint16_t flags;           // Flags
+                              // 标志
+    uint16_t reserved1;       // Reserved
+                              // 保留
+} ubx_cfg_prt_uart_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t meas_rate;       // Measurement interval (ms)
+                              // 测量间隔 (毫秒)
+    uint16_t nav_rate;        // Measurement cycles per navigation solution
+                              // 每个导航解包含的测量周期数
+    uint16_t time_ref;        // Time reference, 0 UTC, 1 GPS
+                              // 时间参考，0 为 UTC，1 为 GPS
+} ubx_cfg_rate_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t msg_class;        // Message class
+                              // 消息类
+    uint8_t msg_id;           // Message ID
+                              // 消息 ID
+    uint8_t rate;             // Output rate on the current port, in navigation solutions
+                              // 当前端口输出频率，单位为导航解个数
+} ubx_cfg_msg_t;
+
+/* Incremental parser state */
+/* 增量解析器状态 */
+typedef enum {
+    UBX_STATE_SYNC_1 = 0,
+    UBX_STATE_SYNC_2,
+    UBX_STATE_CLASS,
+    UBX_STATE_ID,
+    UBX_STATE_LENGTH_1,
+    UBX_STATE_LENGTH_2,
+    UBX_STATE_PAYLOAD,
+    UBX_STATE_CK_A,
+    UBX_STATE_CK_B,
+} ubx_parser_state_t;
+
+typedef struct {
+    ubx_parser_state_t state;  // Current parser state
+                               // 当前解析状态
+    uint8_t msg_class;         // Class of the message being received
+                               // 正在接收的消息类
+    uint8_t msg_id;            // ID of the message being received
+                               // 正在接收的消息 ID
+    uint16_t length;           // Payload length from the header
+                               // 帧头中的载荷长度
+    uint16_t index;            // Number of payload bytes received so far
+                               // 已接收的载荷字节数
+    uint8_t ck_a;              // Running Fletcher checksum A
+                               // Fletcher 校验累加值 A
+    uint8_t ck_b;              // Running Fletcher checksum B
+                               // Fletcher 校验累加值 B
+    uint8_t payload[UBX_MAX_PAYLOAD_LENGTH];  // Payload of the last complete message
+                                              // 最近一条完整消息的载荷
+
+    uint32_t message_count;    // Messages received with a valid checksum
+                               // 校验通过的消息数量
+    uint32_t checksum_errors;  // Frames dropped due to checksum mismatch
+                               // 因校验失败丢弃的帧数量
+    uint32_t overflow_errors;  // Frames dropped because the payload was too long
+                               // 因载荷过长丢弃的帧数量
+} ubx_parser_t;
+
+void ubx_parser_init(ubx_parser_t *parser);
+
+bool ubx_parser_feed(ubx_parser_t *parser, uint8_t byte);
+
+void ubx_checksum(const uint8_t *data, size_t length, uint8_t *ck_a, uint8_t *ck_b);
+
+size_t ubx_build_message(uint8_t msg_class, uint8_t msg_id, const void *payload, uint16_t payload_length,
+                         uint8_t *out, size_t out_size);
+
+bool ubx_decode_nav_pvt(const ubx_parser_t *parser, ubx_nav_pvt_t *pvt_out);
+
+#endif